@@ -0,0 +1,76 @@
+#!/usr/bin/env bash
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU Library Public License as published by
+# the Free Software Foundation; either version 2, or (at your option)
+# any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Library Public License for more details.
+#
+source $CEPH_ROOT/qa/standalone/ceph-helpers.sh
+
+function run() {
+    local dir=$1
+    shift
+
+    export CEPH_MON="127.0.0.1:7133" # git grep '\<7133\>' : there must be only one
+    export CEPH_ARGS
+    CEPH_ARGS+="--fsid=$(uuidgen) --auth-supported=none "
+    CEPH_ARGS+="--mon-host=$CEPH_MON "
+
+    local funcs=${@:-$(set | sed -n -e 's/^\(TEST_[0-9a-z_]*\) .*/\1/p')}
+    for func in $funcs ; do
+        setup $dir || return 1
+        $func $dir || return 1
+        teardown $dir || return 1
+    done
+}
+
+# change the osdmap and the auth database while both services wait for
+# their proposal timer, so that the first one to fire proposes for both
+function propose_two_services() {
+    local dir=$1
+
+    # the commit makes the next proposals wait for paxos_propose_interval
+    ceph osd set noout || return 1
+    ceph osd unset noout &
+    local osd_pid=$!
+    ceph auth get-or-create client.coalesce mon 'allow r' &
+    local auth_pid=$!
+    wait $osd_pid || return 1
+    wait $auth_pid || return 1
+
+    ceph osd dump | grep -q 'flags.*noout' && return 1
+    ceph auth get client.coalesce || return 1
+}
+
+function TEST_propose_coalesce() {
+    local dir=$1
+
+    run_mon $dir a \
+        --paxos-propose-interval=5 \
+        --debug-mon=10 || return 1
+    propose_two_services $dir || return 1
+    grep -q 'propose_pending coalescing' $dir/mon.a.log || return 1
+}
+
+function TEST_propose_coalesce_off() {
+    local dir=$1
+
+    run_mon $dir a \
+        --paxos-propose-interval=5 \
+        --paxos-propose-coalesce=false \
+        --debug-mon=10 || return 1
+    propose_two_services $dir || return 1
+    grep -q 'propose_pending coalescing' $dir/mon.a.log && return 1
+    return 0
+}
+
+main mon-propose-coalesce "$@"
+
+# Local Variables:
+# compile-command: "cd ../.. ; make -j4 && test/mon/mon-propose-coalesce.sh"
+# End:
@@ -61,6 +61,8 @@ enum {
   P_SHRINK_BYTES,
   P_LOCK,
   P_UNLOCK,
+  P_READAHEAD,
+  P_READAHEAD_HIT,
   P_LAST,
 };
 
@@ -75,6 +77,8 @@ int SimpleRADOSStriper::config_logger(CephContext* cct, std::string_view name, s
   plb.add_u64_counter(P_SHRINK_BYTES, "shrink_bytes", "Bytes shrunk");
   plb.add_u64_counter(P_LOCK, "lock", "Number of locks");
   plb.add_u64_counter(P_UNLOCK, "unlock", "Number of unlocks");
+  plb.add_u64_counter(P_READAHEAD, "readahead", "Number of readaheads");
+  plb.add_u64_counter(P_READAHEAD_HIT, "readahead_hit", "Number of reads served from readahead");
   l->reset(plb.create_perf_counters());
   return 0;
 }
@@ -148,6 +152,8 @@ int SimpleRADOSStriper::truncate(uint64_t size)
     return -EBLOCKLISTED;
   }
 
+  readahead.clear();
+
   /* TODO: (not currently used by SQLite) handle growth + sparse */
   if (int rc = set_metadata(size, true); rc < 0) {
     return rc;
@@ -455,6 +461,10 @@ ssize_t SimpleRADOSStriper::write(const void* data, size_t len, uint64_t off)
     }
   }
 
+  if (off < readahead_off + readahead.length() && readahead_off < off + len) {
+    readahead.clear();
+  }
+
   size_t w = 0;
   while ((len-w) > 0) {
     auto ext = get_next_extent(off+w, len-w);
@@ -487,6 +497,51 @@ ssize_t SimpleRADOSStriper::read(void* data, size_t len, uint64_t off)
     return -EBLOCKLISTED;
   }
 
+  /* Only while locked: nobody else can write the database then. */
+  if (locked && readahead_max > 0) {
+    if (off >= readahead_off &&
+        off + len <= readahead_off + readahead.length()) {
+      d(10) << " readahead hit " << readahead_off << "~" << readahead.length() << dendl;
+      readahead.begin(off - readahead_off).copy(len, (char*)data);
+      last_read_end = off + len;
+      if (logger) {
+        logger->inc(P_READAHEAD_HIT);
+      }
+      return len;
+    }
+    if (off == last_read_end && len < readahead_max && off + len < size) {
+      /* sequential: read ahead up to the end of the database */
+      size_t ralen = std::min<uint64_t>(readahead_max, size - off);
+      d(10) << " readahead " << off << "~" << ralen << dendl;
+      readahead.clear();
+      if (int rc = read_extents(&readahead, ralen, off); rc < 0) {
+        readahead.clear();
+        return rc;
+      }
+      readahead_off = off;
+      last_read_end = off + len;
+      if (logger) {
+        logger->inc(P_READAHEAD);
+      }
+      size_t r = std::min<size_t>(len, readahead.length());
+      readahead.begin().copy(r, (char*)data);
+      return r;
+    }
+  }
+
+  bufferlist bl;
+  if (int rc = read_extents(&bl, len, off); rc < 0) {
+    return rc;
+  }
+  ceph_assert(bl.length() <= len);
+  bl.begin().copy(bl.length(), (char*)data);
+  last_read_end = off + len;
+
+  return bl.length();
+}
+
+int SimpleRADOSStriper::read_extents(bufferlist* out, size_t len, uint64_t off)
+{
   size_t r = 0;
   // Don't use std::vector to store bufferlists (e.g for parallelizing aio_reads),
   // as they are being moved whenever the vector resizes
@@ -503,18 +558,14 @@ ssize_t SimpleRADOSStriper::read(void* data, size_t len, uint64_t off)
     r += ext.len;
   }
 
-  r = 0;
   for (auto& [bl, aiocp] : reads) {
     if (int rc = aiocp->wait_for_complete(); rc < 0) {
       d(1) << " read failure: " << cpp_strerror(rc) << dendl;
       return rc;
     }
-    bl.begin().copy(bl.length(), ((char*)data)+r);
-    r += bl.length();
+    out->claim_append(bl);
   }
-  ceph_assert(r <= len);
-
-  return r;
+  return 0;
 }
 
 int SimpleRADOSStriper::print_lockers(std::ostream& out)
@@ -765,6 +816,7 @@ int SimpleRADOSStriper::unlock()
     return rc;
   }
   locked = false;
+  readahead.clear();
 
   d(5) << " = 0" << dendl;
   if (logger) {
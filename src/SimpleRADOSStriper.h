@@ -79,6 +79,11 @@ public:
   void set_blocklist_the_dead(bool b) {
     blocklist_the_dead = b;
   }
+  /* sequential reads are extended to this many bytes while locked */
+  void set_readahead(size_t max) {
+    readahead_max = max;
+    readahead.clear();
+  }
 
 protected:
   struct extent {
@@ -93,6 +98,7 @@ protected:
   int shrink_alloc(uint64_t a);
   int maybe_shrink_alloc();
   int wait_for_aios(bool block);
+  int read_extents(ceph::bufferlist* out, size_t len, uint64_t off);
   int recover_lock();
   extent get_next_extent(uint64_t off, size_t len) const;
   extent get_first_extent() const {
@@ -134,6 +140,10 @@ private:
   std::queue<aiocompletionptr> aios;
   int aios_failure = 0;
   std::string myaddrs;
+  size_t readahead_max = 0;
+  uint64_t readahead_off = 0;
+  ceph::bufferlist readahead;
+  uint64_t last_read_end = 0;
 };
 
 #endif /* _SIMPLERADOSSTRIPER_H */
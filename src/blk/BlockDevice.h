@@ -100,6 +100,7 @@ public:
   std::atomic_int num_running = {0};
   bool allow_eio;
   uint32_t flags = 0;               // FLAG_*
+  int io_queue = -1;                ///< device queue, picked on first io
 
   explicit IOContext(CephContext* cct, void *p, bool allow_eio = false)
     : cct(cct), priv(p), allow_eio(allow_eio)
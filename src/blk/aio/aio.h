@@ -103,6 +103,14 @@ struct io_queue_t {
   virtual int submit_batch(aio_iter begin, aio_iter end, uint16_t aios_size,
 			   void *priv, int *retries) = 0;
   virtual int get_next_completed(int timeout_ms, aio_t **paio, int max) = 0;
+
+  /// allocate a read buffer from memory pre-registered with the queue
+  ///
+  /// @return nullptr if the queue has no registered memory or it is used up
+  virtual ceph::unique_leakable_ptr<ceph::buffer::raw>
+  try_create_registered_buffer(size_t len) {
+    return nullptr;
+  }
 };
 
 struct aio_queue_t final : public io_queue_t {
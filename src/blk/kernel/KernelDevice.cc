@@ -65,7 +65,6 @@ KernelDevice::KernelDevice(CephContext* cct, aio_callback_t cb, void *cbpriv, ai
     discard_callback(d_cb),
     discard_callback_priv(d_cbpriv),
     aio_stop(false),
-    aio_thread(this),
     injecting_crash(0)
 {
   cct->_conf.add_observer(this);
@@ -74,19 +73,28 @@ KernelDevice::KernelDevice(CephContext* cct, aio_callback_t cb, void *cbpriv, ai
 
   bool use_ioring = cct->_conf.get_val<bool>("bdev_ioring");
   unsigned int iodepth = cct->_conf->bdev_aio_max_queue_depth;
-
-  if (use_ioring && ioring_queue_t::supported()) {
-    bool use_ioring_hipri = cct->_conf.get_val<bool>("bdev_ioring_hipri");
-    bool use_ioring_sqthread_poll = cct->_conf.get_val<bool>("bdev_ioring_sqthread_poll");
-    io_queue = std::make_unique<ioring_queue_t>(iodepth, use_ioring_hipri, use_ioring_sqthread_poll);
-  } else {
-    static bool once;
-    if (use_ioring && !once) {
-      derr << "WARNING: io_uring API is not supported! Fallback to libaio!"
-           << dendl;
-      once = true;
+  auto num_queues = cct->_conf.get_val<uint64_t>("bdev_aio_queues");
+
+  for (uint64_t i = 0; i < num_queues; ++i) {
+    if (use_ioring && ioring_queue_t::supported()) {
+      bool use_ioring_hipri = cct->_conf.get_val<bool>("bdev_ioring_hipri");
+      bool use_ioring_sqthread_poll = cct->_conf.get_val<bool>("bdev_ioring_sqthread_poll");
+      auto registered_buffers =
+	cct->_conf.get_val<uint64_t>("bdev_ioring_registered_buffers");
+      auto registered_buffer_size =
+	cct->_conf.get_val<Option::size_t>("bdev_ioring_registered_buffer_size");
+      io_queues.emplace_back(std::make_unique<ioring_queue_t>(
+	iodepth, use_ioring_hipri, use_ioring_sqthread_poll,
+	registered_buffers, registered_buffer_size));
+    } else {
+      static bool once;
+      if (use_ioring && !once) {
+	derr << "WARNING: io_uring API is not supported! Fallback to libaio!"
+	     << dendl;
+	once = true;
+      }
+      io_queues.emplace_back(std::make_unique<aio_queue_t>(iodepth));
     }
-    io_queue = std::make_unique<aio_queue_t>(iodepth);
   }
 }
 
@@ -510,17 +518,26 @@ int KernelDevice::_aio_start()
 {
   if (aio) {
     dout(10) << __func__ << dendl;
-    int r = io_queue->init(fd_directs);
-    if (r < 0) {
-      if (r == -EAGAIN) {
-	derr << __func__ << " io_setup(2) failed with EAGAIN; "
-	     << "try increasing /proc/sys/fs/aio-max-nr" << dendl;
-      } else {
-	derr << __func__ << " io_setup(2) failed: " << cpp_strerror(r) << dendl;
+    for (size_t i = 0; i < io_queues.size(); ++i) {
+      int r = io_queues[i]->init(fd_directs);
+      if (r < 0) {
+	if (r == -EAGAIN) {
+	  derr << __func__ << " io_setup(2) failed with EAGAIN; "
+	       << "try increasing /proc/sys/fs/aio-max-nr" << dendl;
+	} else {
+	  derr << __func__ << " io_setup(2) failed: " << cpp_strerror(r) << dendl;
+	}
+	while (i-- > 0) {
+	  io_queues[i]->shutdown();
+	}
+	return r;
       }
-      return r;
     }
-    aio_thread.create("bstore_aio");
+    for (auto& q : io_queues) {
+      aio_threads.emplace_back(
+	std::make_unique<AioCompletionThread>(this, q.get()));
+      aio_threads.back()->create("bstore_aio");
+    }
   }
   return 0;
 }
@@ -530,9 +547,14 @@ void KernelDevice::_aio_stop()
   if (aio) {
     dout(10) << __func__ << dendl;
     aio_stop = true;
-    aio_thread.join();
+    for (auto& t : aio_threads) {
+      t->join();
+    }
+    aio_threads.clear();
     aio_stop = false;
-    io_queue->shutdown();
+    for (auto& q : io_queues) {
+      q->shutdown();
+    }
   }
 }
 
@@ -610,7 +632,20 @@ static bool is_expected_ioerr(const int r)
 	  );
 }
 
-void KernelDevice::_aio_thread()
+io_queue_t *KernelDevice::_get_io_queue(IOContext *ioc)
+{
+  if (ioc->io_queue < 0) {
+    // spread submitters over the queues; a given (e.g. OSD shard) thread
+    // always lands on the same one
+    static std::atomic<unsigned> next_index{0};
+    static thread_local unsigned index =
+      next_index.fetch_add(1, std::memory_order_relaxed);
+    ioc->io_queue = index % io_queues.size();
+  }
+  return io_queues[ioc->io_queue].get();
+}
+
+void KernelDevice::_aio_thread(io_queue_t *io_queue)
 {
   dout(10) << __func__ << " start" << dendl;
   int inject_crash_count = 0;
@@ -927,8 +962,8 @@ void KernelDevice::aio_submit(IOContext *ioc)
   int r, retries = 0;
   // num of pending aios should not overflow when passed to submit_batch()
   assert(pending <= std::numeric_limits<uint16_t>::max());
-  r = io_queue->submit_batch(ioc->running_aios.begin(), e,
-			     pending, priv, &retries);
+  r = _get_io_queue(ioc)->submit_batch(ioc->running_aios.begin(), e,
+					pending, priv, &retries);
 
   if (retries)
     derr << __func__ << " retries " << retries << dendl;
@@ -1365,8 +1400,16 @@ int KernelDevice::aio_read(
     ioc->pending_aios.push_back(aio_t(ioc, fd_directs[WRITE_LIFE_NOT_SET]));
     ++ioc->num_pending;
     aio_t& aio = ioc->pending_aios.back();
-    aio.bl.push_back(
-      ceph::buffer::ptr_node::create(create_custom_aligned(len, ioc)));
+    if (auto raw = _get_io_queue(ioc)->try_create_registered_buffer(len);
+	raw) {
+      // registered buffers are a scarce resource: don't let the caller
+      // pin them in its cache
+      ioc->flags |= IOContext::FLAG_DONT_CACHE;
+      aio.bl.push_back(ceph::buffer::ptr_node::create(std::move(raw)));
+    } else {
+      aio.bl.push_back(
+        ceph::buffer::ptr_node::create(create_custom_aligned(len, ioc)));
+    }
     aio.bl.prepare_iov(&aio.iov);
     aio.preadv(off, len);
     dout(30) << aio << dendl;
@@ -48,7 +48,8 @@ private:
   std::atomic<bool> io_since_flush = {false};
   ceph::mutex flush_mutex = ceph::make_mutex("KernelDevice::flush_mutex");
 
-  std::unique_ptr<io_queue_t> io_queue;
+  /// submission/completion queues; each IOContext sticks to one of them
+  std::vector<std::unique_ptr<io_queue_t>> io_queues;
   aio_callback_t discard_callback;
   void *discard_callback_priv;
   bool aio_stop;
@@ -60,12 +61,14 @@ private:
 
   struct AioCompletionThread : public Thread {
     KernelDevice *bdev;
-    explicit AioCompletionThread(KernelDevice *b) : bdev(b) {}
+    io_queue_t *queue;
+    AioCompletionThread(KernelDevice *b, io_queue_t *q) : bdev(b), queue(q) {}
     void *entry() override {
-      bdev->_aio_thread();
+      bdev->_aio_thread(queue);
       return NULL;
     }
-  } aio_thread;
+  };
+  std::vector<std::unique_ptr<AioCompletionThread>> aio_threads;
 
   struct DiscardThread : public Thread {
     KernelDevice *bdev;
@@ -85,7 +88,8 @@ private:
   virtual int _post_open() { return 0; }  // hook for child implementations
   virtual void  _pre_close() { }  // hook for child implementations
 
-  void _aio_thread();
+  void _aio_thread(io_queue_t *queue);
+  io_queue_t *_get_io_queue(IOContext *ioc);
   void _discard_thread(uint64_t tid);
   void _queue_discard(interval_set<uint64_t> &to_release);
   bool try_discard(interval_set<uint64_t> &to_release, bool async = true) override;
@@ -7,16 +7,90 @@
 
 #include "liburing.h"
 #include <sys/epoll.h>
+#include <sys/mman.h>
+
+#include <boost/lockfree/queue.hpp>
+
+#include "include/buffer_raw.h"
 
 using std::list;
 using std::make_unique;
 
+/*
+ * A set of equally sized buffers registered with the ring once at init
+ * (IORING_REGISTER_BUFFERS), so that reads landing in them can be issued
+ * as READ_FIXED/WRITE_FIXED and skip the per-io page pinning.  The arena
+ * is reference counted by the buffers handed out, hence it may outlive
+ * the ring itself.
+ */
+struct ioring_buffer_arena {
+  char *base = nullptr;
+  const size_t slot_size;
+  const unsigned num_slots;
+  boost::lockfree::queue<unsigned> free_slots;
+
+  ioring_buffer_arena(unsigned num_slots_, size_t slot_size_)
+    : slot_size(slot_size_), num_slots(num_slots_), free_slots(num_slots_) {
+  }
+  ~ioring_buffer_arena() {
+    if (base) {
+      ::munmap(base, size());
+    }
+  }
+
+  size_t size() const {
+    return slot_size * num_slots;
+  }
+
+  int init() {
+    void *p = ::mmap(nullptr, size(), PROT_READ | PROT_WRITE,
+		     MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (p == MAP_FAILED) {
+      return -errno;
+    }
+    base = static_cast<char*>(p);
+    for (unsigned i = 0; i < num_slots; ++i) {
+      free_slots.push(i);
+    }
+    return 0;
+  }
+
+  /// return the registered buffer index covering [addr, addr+len), or -1
+  int find_slot(const void *addr, size_t len) const {
+    auto p = static_cast<const char*>(addr);
+    if (!base || p < base || p + len > base + size()) {
+      return -1;
+    }
+    size_t slot = (p - base) / slot_size;
+    if (p + len > base + (slot + 1) * slot_size) {
+      return -1;
+    }
+    return slot;
+  }
+};
+
+struct ioring_registered_raw : public ceph::buffer::raw {
+  std::shared_ptr<ioring_buffer_arena> arena;
+  const unsigned slot;
+
+  ioring_registered_raw(std::shared_ptr<ioring_buffer_arena> a,
+			unsigned s, unsigned len)
+    : ceph::buffer::raw(a->base + s * a->slot_size, len),
+      arena(std::move(a)), slot(s) {
+  }
+  ~ioring_registered_raw() override {
+    // recycle the slot instead of freeing the memory
+    arena->free_slots.push(slot);
+  }
+};
+
 struct ioring_data {
   struct io_uring io_uring;
   pthread_mutex_t cq_mutex;
   pthread_mutex_t sq_mutex;
   int epoll_fd = -1;
   std::map<int, int> fixed_fds_map;
+  std::shared_ptr<ioring_buffer_arena> arena;
 };
 
 static int ioring_get_cqe(struct ioring_data *d, unsigned int max,
@@ -57,14 +131,28 @@ static void init_sqe(struct ioring_data *d, struct io_uring_sqe *sqe,
 
   ceph_assert(fixed_fd != -1);
 
-  if (io->iocb.aio_lio_opcode == IO_CMD_PWRITEV)
-    io_uring_prep_writev(sqe, fixed_fd, &io->iov[0],
-			 io->iov.size(), io->offset);
-  else if (io->iocb.aio_lio_opcode == IO_CMD_PREADV)
-    io_uring_prep_readv(sqe, fixed_fd, &io->iov[0],
-			io->iov.size(), io->offset);
-  else
+  int buf_index = -1;
+  if (d->arena && io->iov.size() == 1) {
+    buf_index = d->arena->find_slot(io->iov[0].iov_base, io->iov[0].iov_len);
+  }
+
+  if (io->iocb.aio_lio_opcode == IO_CMD_PWRITEV) {
+    if (buf_index >= 0)
+      io_uring_prep_write_fixed(sqe, fixed_fd, io->iov[0].iov_base,
+				io->iov[0].iov_len, io->offset, buf_index);
+    else
+      io_uring_prep_writev(sqe, fixed_fd, &io->iov[0],
+			   io->iov.size(), io->offset);
+  } else if (io->iocb.aio_lio_opcode == IO_CMD_PREADV) {
+    if (buf_index >= 0)
+      io_uring_prep_read_fixed(sqe, fixed_fd, io->iov[0].iov_base,
+			       io->iov[0].iov_len, io->offset, buf_index);
+    else
+      io_uring_prep_readv(sqe, fixed_fd, &io->iov[0],
+			  io->iov.size(), io->offset);
+  } else {
     ceph_assert(0);
+  }
 
   io_uring_sqe_set_data(sqe, io);
   io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
@@ -106,11 +194,37 @@ static void build_fixed_fds_map(struct ioring_data *d,
   }
 }
 
-ioring_queue_t::ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_) :
+static int register_buffers(struct ioring_data *d,
+			    unsigned num_buffers, size_t buffer_size)
+{
+  auto arena = std::make_shared<ioring_buffer_arena>(num_buffers, buffer_size);
+  int ret = arena->init();
+  if (ret < 0)
+    return ret;
+
+  std::vector<struct iovec> iovs(num_buffers);
+  for (unsigned i = 0; i < num_buffers; ++i) {
+    iovs[i].iov_base = arena->base + i * buffer_size;
+    iovs[i].iov_len = buffer_size;
+  }
+  ret = io_uring_register_buffers(&d->io_uring, iovs.data(), iovs.size());
+  if (ret < 0)
+    return ret;
+
+  d->arena = std::move(arena);
+  return 0;
+}
+
+ioring_queue_t::ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_,
+			       unsigned registered_buffers_,
+			       size_t registered_buffer_size_) :
   d(make_unique<ioring_data>()),
   iodepth(iodepth_),
   hipri(hipri_),
-  sq_thread(sq_thread_)
+  sq_thread(sq_thread_),
+  registered_buffers(registered_buffers_),
+  registered_buffer_size(p2roundup<size_t>(registered_buffer_size_,
+					   CEPH_PAGE_SIZE))
 {
 }
 
@@ -143,6 +257,14 @@ int ioring_queue_t::init(std::vector<int> &fds)
 
   build_fixed_fds_map(d.get(), fds);
 
+  if (registered_buffers && registered_buffer_size) {
+    // not fatal: fall back to regular vectored io
+    if (register_buffers(d.get(), registered_buffers,
+			 registered_buffer_size) < 0) {
+      d->arena.reset();
+    }
+  }
+
   d->epoll_fd = epoll_create1(0);
   if (d->epoll_fd < 0) {
     ret = -errno;
@@ -170,6 +292,8 @@ close_ring_fd:
 void ioring_queue_t::shutdown()
 {
   d->fixed_fds_map.clear();
+  // buffers still referenced keep the arena memory alive
+  d->arena.reset();
   close(d->epoll_fd);
   d->epoll_fd = -1;
   io_uring_queue_exit(&d->io_uring);
@@ -209,6 +333,21 @@ get_cqe:
   return events;
 }
 
+ceph::unique_leakable_ptr<ceph::buffer::raw>
+ioring_queue_t::try_create_registered_buffer(size_t len)
+{
+  auto& arena = d->arena;
+  if (!arena || len > arena->slot_size)
+    return nullptr;
+
+  unsigned slot;
+  if (!arena->free_slots.pop(slot))
+    return nullptr;
+
+  return ceph::unique_leakable_ptr<ceph::buffer::raw>(
+    new ioring_registered_raw(arena, slot, len));
+}
+
 bool ioring_queue_t::supported()
 {
   struct io_uring ring;
@@ -224,7 +363,9 @@ bool ioring_queue_t::supported()
 
 struct ioring_data {};
 
-ioring_queue_t::ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_)
+ioring_queue_t::ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_,
+			       unsigned registered_buffers_,
+			       size_t registered_buffer_size_)
 {
   ceph_assert(0);
 }
@@ -256,6 +397,12 @@ int ioring_queue_t::get_next_completed(int timeout_ms, aio_t **paio, int max)
   ceph_assert(0);
 }
 
+ceph::unique_leakable_ptr<ceph::buffer::raw>
+ioring_queue_t::try_create_registered_buffer(size_t len)
+{
+  ceph_assert(0);
+}
+
 bool ioring_queue_t::supported()
 {
   return false;
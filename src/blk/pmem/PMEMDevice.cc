@@ -23,6 +23,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <string.h>
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 
@@ -47,6 +48,33 @@ using execution_path = dml::automatic;
 #undef dout_prefix
 #define dout_prefix *_dout << "bdev-PMEM("  << path << ") "
 
+#if !defined(HAVE_LIBDML)
+// Copy src to dst, but only persist the cache lines from the first to the
+// last that change.  BlueFS rewrites the partial tail block of a file on
+// each append, so a small RocksDB WAL write would otherwise flush the
+// whole block, of which only the new bytes differ.
+static void pmem_memcpy_persist_changed(char *dst, const char *src, size_t len)
+{
+  constexpr size_t line = 64;
+  size_t b = 0;
+  while (b < len && memcmp(dst + b, src + b, std::min(line, len - b)) == 0) {
+    b += line;
+  }
+  if (b >= len) {
+    return;
+  }
+  size_t e = len;
+  while (e > b) {
+    size_t s = std::max(b, (e - 1) / line * line);
+    if (memcmp(dst + s, src + s, e - s) != 0) {
+      break;
+    }
+    e = s;
+  }
+  pmem_memcpy_persist(dst + b, src + b, e - b);
+}
+#endif
+
 PMEMDevice::PMEMDevice(CephContext *cct, aio_callback_t cb, void *cbpriv)
   : BlockDevice(cct, cb, cbpriv),
     fd(-1), addr(0),
@@ -293,6 +321,9 @@ int PMEMDevice::write(uint64_t off, bufferlist& bl, bool buffered, int write_hin
 
   bufferlist::iterator p = bl.begin();
   uint64_t off1 = off;
+#if !defined(HAVE_LIBDML)
+  const bool changed_only = g_conf()->bdev_pmem_persist_changed_only;
+#endif
   while (len) {
     const char *data;
     uint32_t l = p.get_ptr_and_advance(len, &data);
@@ -302,7 +333,11 @@ int PMEMDevice::write(uint64_t off, bufferlist& bl, bool buffered, int write_hin
     auto result = dml::execute<execution_path>(dml::mem_move, dml::make_view(data, l), dml::make_view(addr + off1, l));
     ceph_assert(result.status == dml::status_code::ok);
 #else
-    pmem_memcpy_persist(addr + off1, data, l);
+    if (changed_only) {
+      pmem_memcpy_persist_changed(addr + off1, data, l);
+    } else {
+      pmem_memcpy_persist(addr + off1, data, l);
+    }
 #endif
     len -= l;
     off1 += l;
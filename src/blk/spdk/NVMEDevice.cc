@@ -27,6 +27,7 @@
 #include <fstream>
 #include <functional>
 #include <map>
+#include <optional>
 #include <thread>
 #include <boost/intrusive/slist.hpp>
 
@@ -36,6 +37,7 @@
 #include "include/stringify.h"
 #include "include/types.h"
 #include "include/compat.h"
+#include "common/ceph_time.h"
 #include "common/errno.h"
 #include "common/debug.h"
 #include "common/perf_counters.h"
@@ -354,6 +356,9 @@ void SharedDriverQueueData::_aio_handle(Task *t, IOContext *ioc)
   uint64_t lba_off, lba_count;
   uint32_t max_io_completion = (uint32_t)g_conf().get_val<uint64_t>("bluestore_spdk_max_io_completion");
   uint64_t io_sleep_in_us = g_conf().get_val<uint64_t>("bluestore_spdk_io_sleep");
+  auto io_spin = std::chrono::microseconds(
+    g_conf().get_val<uint64_t>("bluestore_spdk_io_spin"));
+  std::optional<ceph::mono_time> idle_since;
 
   while (ioc->num_running) {
  again:
@@ -363,7 +368,16 @@ void SharedDriverQueueData::_aio_handle(Task *t, IOContext *ioc)
       if (r < 0) {
         ceph_abort();
       } else if (r == 0) {
-        usleep(io_sleep_in_us);
+        // keep polling for a while first: waking up from even a short
+        // sleep takes longer than most NVMe IOs
+        auto now = ceph::mono_clock::now();
+        if (!idle_since) {
+          idle_since = now;
+        } else if (now - *idle_since >= io_spin) {
+          usleep(io_sleep_in_us);
+        }
+      } else {
+        idle_since.reset();
       }
     }
 
@@ -810,6 +824,8 @@ void NVMEDevice::aio_submit(IOContext *ioc)
     // Only need to push the first entry
     ioc->nvme_task_first = ioc->nvme_task_last = nullptr;
 
+    // each submitting thread (OSD shard, kv sync, ...) has a qpair of its
+    // own, and completes its IOs on it inline
     thread_local SharedDriverQueueData queue_t = SharedDriverQueueData(this, driver);
     queue_t._aio_handle(t, ioc);
   }
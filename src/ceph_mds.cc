@@ -34,6 +34,7 @@
 
 #include "msg/Messenger.h"
 
+#include "common/Throttle.h"
 #include "common/Timer.h"
 #include "common/ceph_argparse.h"
 #include "common/pick_address.h"
@@ -187,6 +188,17 @@ int main(int argc, const char **argv)
                    Messenger::Policy::lossless_peer(CEPH_FEATURE_UID));
   msgr->set_policy(entity_name_t::TYPE_CLIENT,
                    Messenger::Policy::stateful_server(0));
+  // batched client messages queue up outside of the messenger's dispatch
+  // throttle; see mds_client_dispatch_batch
+  std::unique_ptr<Throttle> client_byte_throttler;
+  if (g_conf().get_val<uint64_t>("mds_client_dispatch_batch")) {
+    uint64_t message_size =
+      g_conf().get_val<Option::size_t>("mds_client_message_size_cap");
+    client_byte_throttler.reset(
+      new Throttle(g_ceph_context, "mds_client_bytes", message_size));
+    msgr->set_policy_throttlers(entity_name_t::TYPE_CLIENT,
+                                client_byte_throttler.get(), nullptr);
+  }
 
   int r = msgr->bindv(addrs);
   if (r < 0)
@@ -53,6 +53,7 @@
 #include "mon/MonClient.h"
 
 #include "messages/MClientCaps.h"
+#include "messages/MClientCapsBatch.h"
 #include "messages/MClientLease.h"
 #include "messages/MClientQuota.h"
 #include "messages/MClientReclaim.h"
@@ -2974,6 +2975,9 @@ bool Client::ms_dispatch2(const MessageRef &m)
   case CEPH_MSG_CLIENT_CAPS:
     handle_caps(ref_cast<MClientCaps>(m));
     break;
+  case CEPH_MSG_CLIENT_CAPS_BATCH:
+    handle_caps_batch(ref_cast<MClientCapsBatch>(m));
+    break;
   case CEPH_MSG_CLIENT_LEASE:
     handle_lease(ref_cast<MClientLease>(m));
     break;
@@ -5357,9 +5361,32 @@ void Client::handle_quota(const MConstRef<MClientQuota>& m)
 
 void Client::handle_caps(const MConstRef<MClientCaps>& m)
 {
-  mds_rank_t mds = mds_rank_t(m->get_source().num());
+  std::scoped_lock cl(client_lock);
+  _handle_caps(m);
+}
+
+void Client::handle_caps_batch(const MConstRef<MClientCapsBatch>& m)
+{
+  ldout(cct, 10) << __func__ << " " << *m << " from " << m->get_source() << dendl;
 
   std::scoped_lock cl(client_lock);
+  for (auto& sub : m->msgs) {
+    if (sub->get_type() != CEPH_MSG_CLIENT_CAPS) {
+      ldout(cct, 0) << __func__ << " unexpected " << *sub << " from "
+		    << m->get_source() << dendl;
+      continue;
+    }
+    // as if it had arrived on its own
+    sub->set_connection(m->get_connection());
+    sub->set_src(m->get_source());
+    _handle_caps(ref_cast<MClientCaps>(sub));
+  }
+}
+
+void Client::_handle_caps(const MConstRef<MClientCaps>& m)
+{
+  mds_rank_t mds = mds_rank_t(m->get_source().num());
+
   auto session = _get_mds_session(mds, m->get_connection().get());
   if (!session) {
     return;
@@ -9461,10 +9488,10 @@ int Client::readdir_r_cb(dir_result_t* d,
   unsigned flags,
   bool getref)
 {
-  auto fill_readdir_cb = [](dir_result_t* dirp,
-			    MetaRequest* req,
-			    InodeRef& diri,
-			    frag_t fg) {
+  auto fill_readdir_cb = [this](dir_result_t* dirp,
+				MetaRequest* req,
+				InodeRef& diri,
+				frag_t fg) {
     filepath path;
     diri->make_nosnap_relative_path(path);
     req->set_filepath(path);
@@ -9476,6 +9503,17 @@ int Client::readdir_r_cb(dir_result_t* d,
     } else if (dirp->hash_order()) {
       req->head.args.readdir.offset_hash = dirp->offset_high();
     }
+    // the first chunk is of the mds' default size; as long as the
+    // directory keeps being read, ask for chunks twice as large each
+    // time, up to client_readdir_max_bytes, like readahead does for files
+    const uint64_t max_bytes =
+      cct->_conf.get_val<Option::size_t>("client_readdir_max_bytes");
+    if (max_bytes && dirp->chunks_fetched > 0) {
+      const unsigned shift = std::min(dirp->chunks_fetched - 1, 16u);
+      req->head.args.readdir.max_bytes =
+	std::min<uint64_t>(max_bytes, (1ull << 20) << shift);
+    }
+    dirp->chunks_fetched++;
     req->dirp = dirp;
   };
   int op = CEPH_MDS_OP_READDIR;
@@ -11448,6 +11486,27 @@ int64_t Client::_write(Fh *f, int64_t offset, uint64_t size, const char *buf,
 {
   ceph_assert(ceph_mutex_is_locked_by_me(client_lock));
 
+  // copy into fresh buffer (since our write may be resub, async)
+  bufferlist bl;
+  if (buf) {
+    if (size > 0)
+      bl.append(buf, size);
+  } else if (iov){
+    for (int i = 0; i < iovcnt; i++) {
+      if (iov[i].iov_len > 0) {
+        bl.append((const char *)iov[i].iov_base, iov[i].iov_len);
+      }
+    }
+  }
+  return _write(f, offset, std::move(bl), onfinish, do_fsync, syncdataonly);
+}
+
+int64_t Client::_write(Fh *f, int64_t offset, bufferlist&& bl,
+	                Context *onfinish, bool do_fsync, bool syncdataonly)
+{
+  ceph_assert(ceph_mutex_is_locked_by_me(client_lock));
+
+  const uint64_t size = bl.length();
   uint64_t fpos = 0;
   Inode *in = f->inode.get();
   std::unique_ptr<C_SaferCond> onuninline = nullptr;
@@ -11514,19 +11573,6 @@ int64_t Client::_write(Fh *f, int64_t offset, uint64_t size, const char *buf,
     ceph_assert(in->inline_version > 0);
   }
 
-  // copy into fresh buffer (since our write may be resub, async)
-  bufferlist bl;
-  if (buf) {
-    if (size > 0)
-      bl.append(buf, size);
-  } else if (iov){
-    for (int i = 0; i < iovcnt; i++) {
-      if (iov[i].iov_len > 0) {
-        bl.append((const char *)iov[i].iov_base, iov[i].iov_len);
-      }
-    }
-  }
-
   int want, have;
   if (f->mode & CEPH_FILE_MODE_LAZY)
     want = CEPH_CAP_FILE_BUFFER | CEPH_CAP_FILE_LAZYIO;
@@ -15945,9 +15991,16 @@ int Client::ll_write(Fh *fh, loff_t off, loff_t len, const char *data)
 
   /* We can't return bytes written larger than INT_MAX, clamp len to that */
   len = std::min(len, (loff_t)INT_MAX);
+
+  // copy the data before taking client_lock, so that other threads aren't
+  // held up by it
+  bufferlist bl;
+  if (len > 0)
+    bl.append(data, len);
+
   std::scoped_lock lock(client_lock);
 
-  int r = _write(fh, off, len, data, NULL, 0);
+  int r = _write(fh, off, std::move(bl));
   ldout(cct, 3) << "ll_write " << fh << " " << off << "~" << len << " = " << r
 		<< dendl;
   return r;
@@ -218,6 +218,7 @@ struct dir_result_t {
     offset = 0;
     ordered_count = 0;
     cache_index = 0;
+    chunks_fetched = 0;
     buffer.clear();
   }
 
@@ -234,6 +235,7 @@ struct dir_result_t {
   uint64_t release_count;
   uint64_t ordered_count;
   unsigned cache_index;
+  unsigned chunks_fetched = 0; // chunks requested from the mds since the start
   int start_shared_gen;  // dir shared_gen at start of readdir
   UserPerm perms;
 
@@ -770,6 +772,8 @@ public:
   void handle_quota(const MConstRef<MClientQuota>& m);
   void handle_snap(const MConstRef<MClientSnap>& m);
   void handle_caps(const MConstRef<MClientCaps>& m);
+  void handle_caps_batch(const MConstRef<MClientCapsBatch>& m);
+  void _handle_caps(const MConstRef<MClientCaps>& m);
   void handle_cap_import(MetaSession *session, Inode *in, const MConstRef<MClientCaps>& m);
   void handle_cap_export(MetaSession *session, Inode *in, const MConstRef<MClientCaps>& m);
   void handle_cap_trunc(MetaSession *session, Inode *in, const MConstRef<MClientCaps>& m);
@@ -1703,6 +1707,10 @@ private:
   int64_t _write(Fh *fh, int64_t offset, uint64_t size, const char *buf,
           const struct iovec *iov, int iovcnt, Context *onfinish = nullptr,
           bool do_fsync = false, bool syncdataonly = false);
+  // write data the caller has already copied, e.g. outside of client_lock
+  int64_t _write(Fh *fh, int64_t offset, bufferlist&& bl,
+          Context *onfinish = nullptr,
+          bool do_fsync = false, bool syncdataonly = false);
   int64_t _preadv_pwritev_locked(Fh *fh, const struct iovec *iov,
                                  int iovcnt, int64_t offset,
                                  bool write, bool clamp_to_int,
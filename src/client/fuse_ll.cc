@@ -1612,8 +1612,19 @@ int CephFuse::Handle::loop()
   auto fuse_multithreaded = client->cct->_conf.get_val<bool>(
     "fuse_multithreaded");
   if (fuse_multithreaded) {
+#if FUSE_VERSION >= FUSE_MAKE_VERSION(3, 0)
+    // -o clone_fd on the command line still works; the config option
+    // lets it be set centrally, like the other fuse_* options
+    if (client->cct->_conf.get_val<bool>("fuse_clone_fd"))
+      opts.clone_fd = 1;
+#endif
 #if FUSE_VERSION >= FUSE_MAKE_VERSION(3, 12)
     {
+      if (auto max_threads = client->cct->_conf.get_val<uint64_t>("fuse_max_threads");
+          max_threads > 0) {
+        opts.max_threads = max_threads;
+      }
+
       struct fuse_loop_config *conf = fuse_loop_cfg_create();
       ceph_assert(conf != nullptr);
 
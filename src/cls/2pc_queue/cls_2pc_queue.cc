@@ -217,6 +217,144 @@ static int cls_2pc_queue_reserve(cls_method_context_t hctx, bufferlist *in, buff
   return 0;
 }
 
+// make several reservations with a single read and write of the head. unlike
+// cls_2pc_queue_reserve() every reservation succeeds or fails on its own
+static int cls_2pc_queue_reserve_batch(cls_method_context_t hctx, bufferlist *in, bufferlist *out) {
+  cls_2pc_queue_reserve_batch_op batch_op;
+  try {
+    auto in_iter = in->cbegin();
+    decode(batch_op, in_iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG(1, "ERROR: cls_2pc_queue_reserve_batch: failed to decode entry: %s", err.what());
+    return -EINVAL;
+  }
+
+  if (batch_op.reservations.empty()) {
+    CLS_LOG(1, "ERROR: cls_2pc_queue_reserve_batch: no reservations in batch");
+    return -EINVAL;
+  }
+
+  // get head
+  cls_queue_head head;
+  int ret = queue_read_head(hctx, head);
+  if (ret < 0) {
+    return ret;
+  }
+
+  cls_2pc_urgent_data urgent_data;
+  try {
+    auto in_iter = head.bl_urgent_data.cbegin();
+    decode(urgent_data, in_iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG(1, "ERROR: cls_2pc_queue_reserve_batch: failed to decode entry: %s", err.what());
+    return -EINVAL;
+  }
+
+  const auto remaining_size = (head.tail.offset >= head.front.offset) ?
+    (head.queue_size - head.tail.offset) + (head.front.offset - head.max_head_size) :
+    head.front.offset - head.tail.offset;
+
+  cls_2pc_queue_reserve_batch_ret op_ret;
+  op_ret.results.reserve(batch_op.reservations.size());
+  op_ret.ids.reserve(batch_op.reservations.size());
+  const auto now = ceph::coarse_real_clock::now();
+  const auto first_id = urgent_data.last_id;
+  // indexes of the reservations added by this batch
+  std::vector<size_t> added;
+  for (const auto& res_op : batch_op.reservations) {
+    int r = 0;
+    if (res_op.size == 0 || res_op.entries == 0) {
+      CLS_LOG(1, "ERROR: cls_2pc_queue_reserve_batch: cannot reserve zero bytes or entries");
+      r = -EINVAL;
+    } else if (res_op.size + urgent_data.reserved_size + res_op.entries*QUEUE_ENTRY_OVERHEAD > remaining_size) {
+      CLS_LOG(10, "INFO: cls_2pc_queue_reserve_batch: reservations exceeded maximum capacity");
+      r = -ENOSPC;
+    } else {
+      // note that last id is incremented regardless of failures
+      // to avoid "old reservation" issues
+      ++urgent_data.last_id;
+      bool result;
+      std::tie(std::ignore, result) = urgent_data.reservations.emplace(std::piecewise_construct,
+          std::forward_as_tuple(urgent_data.last_id),
+          std::forward_as_tuple(res_op.size, now, res_op.entries));
+      if (!result) {
+        CLS_LOG(1, "ERROR: cls_2pc_queue_reserve_batch: reservation id conflict after rollover: %u", urgent_data.last_id);
+        r = -EAGAIN;
+      } else {
+        urgent_data.reserved_size += res_op.size + res_op.entries*QUEUE_ENTRY_OVERHEAD;
+        added.push_back(op_ret.results.size());
+      }
+    }
+    op_ret.results.push_back(r);
+    op_ret.ids.push_back(r == 0 ? urgent_data.last_id : cls_2pc_reservation::NO_ID);
+  }
+
+  if (urgent_data.last_id == first_id) {
+    // nothing changed
+    encode(op_ret, *out);
+    return 0;
+  }
+
+  head.bl_urgent_data.clear();
+  encode(urgent_data, head.bl_urgent_data);
+
+  if (head.max_urgent_data_size < head.bl_urgent_data.length() && !added.empty()) {
+    CLS_LOG(10, "INFO: cls_2pc_queue_reserve_batch: urgent data size: %u exceeded maximum: %lu using xattrs", head.bl_urgent_data.length(), head.max_urgent_data_size);
+    // move the reservations of this batch to xattrs
+    bufferlist bl_xattrs;
+    ret = cls_cxx_getxattr(hctx, CLS_QUEUE_URGENT_DATA_XATTR_NAME, &bl_xattrs);
+    if (ret < 0 && (ret != -ENOENT && ret != -ENODATA)) {
+      CLS_LOG(1, "ERROR: cls_2pc_queue_reserve_batch: failed to read xattrs with: %d", ret);
+      return ret;
+    }
+    cls_2pc_reservations xattr_reservations;
+    if (ret >= 0) {
+      // xattrs exist
+      auto iter = bl_xattrs.cbegin();
+      try {
+        decode(xattr_reservations, iter);
+      } catch (ceph::buffer::error& err) {
+        CLS_LOG(1, "ERROR: cls_2pc_queue_reserve_batch: failed to decode xattrs urgent data map");
+        return -EINVAL;
+      }
+    }
+    for (const auto i : added) {
+      auto node = urgent_data.reservations.extract(op_ret.ids[i]);
+      if (!xattr_reservations.insert(std::move(node)).inserted) {
+        // an old reservation that was never committed or aborted is in the map
+        // caller should try again assuming other IDs are ok
+        CLS_LOG(1, "ERROR: cls_2pc_queue_reserve_batch: reservation id conflict inside xattrs after rollover: %u", op_ret.ids[i]);
+        const auto& res_op = batch_op.reservations[i];
+        urgent_data.reserved_size -= res_op.size + res_op.entries*QUEUE_ENTRY_OVERHEAD;
+        op_ret.results[i] = -EAGAIN;
+        op_ret.ids[i] = cls_2pc_reservation::NO_ID;
+      }
+    }
+    bl_xattrs.clear();
+    encode(xattr_reservations, bl_xattrs);
+    ret = cls_cxx_setxattr(hctx, CLS_QUEUE_URGENT_DATA_XATTR_NAME, &bl_xattrs);
+    if (ret < 0) {
+      CLS_LOG(1, "ERROR: cls_2pc_queue_reserve_batch: failed to write xattrs with: %d", ret);
+      return ret;
+    }
+    // indicate that spillover happened
+    urgent_data.has_xattrs = true;
+    head.bl_urgent_data.clear();
+    encode(urgent_data, head.bl_urgent_data);
+  }
+
+  ret = queue_write_head(hctx, head);
+  if (ret < 0) {
+    return ret;
+  }
+
+  CLS_LOG(20, "INFO: cls_2pc_queue_reserve_batch: reservations: %lu current reservations: %lu (bytes)",
+      batch_op.reservations.size(), urgent_data.reserved_size);
+
+  encode(op_ret, *out);
+  return 0;
+}
+
 static int cls_2pc_queue_commit(cls_method_context_t hctx, bufferlist *in, bufferlist *out) {
   cls_2pc_queue_commit_op commit_op;
   try {
@@ -654,6 +792,7 @@ CLS_INIT(2pc_queue)
   cls_method_handle_t h_2pc_queue_get_capacity;
   cls_method_handle_t h_2pc_queue_get_topic_stats;
   cls_method_handle_t h_2pc_queue_reserve;
+  cls_method_handle_t h_2pc_queue_reserve_batch;
   cls_method_handle_t h_2pc_queue_commit;
   cls_method_handle_t h_2pc_queue_abort;
   cls_method_handle_t h_2pc_queue_list_reservations;
@@ -667,6 +806,7 @@ CLS_INIT(2pc_queue)
   cls_register_cxx_method(h_class, TPC_QUEUE_GET_CAPACITY, CLS_METHOD_RD, cls_2pc_queue_get_capacity, &h_2pc_queue_get_capacity);
   cls_register_cxx_method(h_class, TPC_QUEUE_GET_TOPIC_STATS, CLS_METHOD_RD, cls_2pc_queue_get_topic_stats, &h_2pc_queue_get_topic_stats);
   cls_register_cxx_method(h_class, TPC_QUEUE_RESERVE, CLS_METHOD_RD | CLS_METHOD_WR, cls_2pc_queue_reserve, &h_2pc_queue_reserve);
+  cls_register_cxx_method(h_class, TPC_QUEUE_RESERVE_BATCH, CLS_METHOD_RD | CLS_METHOD_WR, cls_2pc_queue_reserve_batch, &h_2pc_queue_reserve_batch);
   cls_register_cxx_method(h_class, TPC_QUEUE_COMMIT, CLS_METHOD_RD | CLS_METHOD_WR, cls_2pc_queue_commit, &h_2pc_queue_commit);
   cls_register_cxx_method(h_class, TPC_QUEUE_ABORT, CLS_METHOD_RD | CLS_METHOD_WR, cls_2pc_queue_abort, &h_2pc_queue_abort);
   cls_register_cxx_method(h_class, TPC_QUEUE_LIST_RESERVATIONS, CLS_METHOD_RD, cls_2pc_queue_list_reservations, &h_2pc_queue_list_reservations);
@@ -128,6 +128,38 @@ void cls_2pc_queue_reserve(ObjectWriteOperation& op, uint64_t res_size,
   op.exec(TPC_QUEUE_CLASS, TPC_QUEUE_RESERVE, in, obl, prval);
 }
 
+void cls_2pc_queue_reserve_batch(ObjectWriteOperation& op, const std::vector<uint64_t>& res_sizes,
+    uint32_t entries, bufferlist* obl, int* prval) {
+  bufferlist in;
+  cls_2pc_queue_reserve_batch_op batch_op;
+  batch_op.reservations.reserve(res_sizes.size());
+  for (const auto res_size : res_sizes) {
+    auto& reserve_op = batch_op.reservations.emplace_back();
+    reserve_op.size = res_size;
+    reserve_op.entries = entries;
+  }
+  encode(batch_op, in);
+  op.exec(TPC_QUEUE_CLASS, TPC_QUEUE_RESERVE_BATCH, in, obl, prval);
+}
+
+int cls_2pc_queue_reserve_batch_result(const bufferlist& bl, std::vector<int>& results,
+    std::vector<cls_2pc_reservation::id_t>& res_ids) {
+  cls_2pc_queue_reserve_batch_ret op_ret;
+  auto iter = bl.cbegin();
+  try {
+    decode(op_ret, iter);
+  } catch (buffer::error& err) {
+    return -EIO;
+  }
+  if (op_ret.results.size() != op_ret.ids.size()) {
+    return -EIO;
+  }
+  results.assign(op_ret.results.begin(), op_ret.results.end());
+  res_ids = std::move(op_ret.ids);
+
+  return 0;
+}
+
 void cls_2pc_queue_commit(ObjectWriteOperation& op, std::vector<bufferlist> bl_data_vec, 
         cls_2pc_reservation::id_t res_id) {
   bufferlist in;
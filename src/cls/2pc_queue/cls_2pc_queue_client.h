@@ -56,6 +56,18 @@ void cls_2pc_queue_reserve(librados::ObjectWriteOperation& op, uint64_t res_size
 
 int cls_2pc_queue_reserve_result(const bufferlist& bl, cls_2pc_reservation::id_t& res_id);
 
+// optionally async method for making several reservations on the queue (in bytes) in one operation
+// each reservation is made for the given number of expected entries, and succeeds or fails on its own
+// make sure that librados::OPERATION_RETURNVEC is passed to the executing function
+// after answer is received, call cls_2pc_queue_reserve_batch_result() to parse the results
+void cls_2pc_queue_reserve_batch(librados::ObjectWriteOperation& op, const std::vector<uint64_t>& res_sizes,
+    uint32_t entries, bufferlist* obl, int* prval);
+
+// results holds 0 or a negative error code for every reservation, in the order of res_sizes
+// and res_ids holds the matching reservation ids (NO_ID on error)
+int cls_2pc_queue_reserve_batch_result(const bufferlist& bl, std::vector<int>& results,
+    std::vector<cls_2pc_reservation::id_t>& res_ids);
+
 // commit data using a reservation done beforehand
 // res_id must be allocated using cls_2pc_queue_reserve, and could be either committed or aborted once
 // the size of bl_data_vec must be equal or smaller to the size reserved for the res_id
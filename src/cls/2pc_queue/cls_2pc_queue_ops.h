@@ -66,6 +66,71 @@ struct cls_2pc_queue_reserve_ret {
 };
 WRITE_CLASS_ENCODER(cls_2pc_queue_reserve_ret)
 
+struct cls_2pc_queue_reserve_batch_op {
+  std::vector<cls_2pc_queue_reserve_op> reservations;
+
+  void encode(ceph::buffer::list& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(reservations, bl);
+    ENCODE_FINISH(bl);
+  }
+
+  void decode(ceph::buffer::list::const_iterator& bl) {
+    DECODE_START(1, bl);
+    decode(reservations, bl);
+    DECODE_FINISH(bl);
+  }
+
+  void dump(ceph::Formatter *f) const {
+    encode_json("reservations", reservations, f);
+  }
+
+  static void generate_test_instances(std::list<cls_2pc_queue_reserve_batch_op*>& ls) {
+    ls.push_back(new cls_2pc_queue_reserve_batch_op);
+    ls.push_back(new cls_2pc_queue_reserve_batch_op);
+    ls.back()->reservations.resize(2);
+    ls.back()->reservations[0].size = 123;
+    ls.back()->reservations[0].entries = 1;
+    ls.back()->reservations[1].size = 456;
+    ls.back()->reservations[1].entries = 2;
+  }
+};
+WRITE_CLASS_ENCODER(cls_2pc_queue_reserve_batch_op)
+
+struct cls_2pc_queue_reserve_batch_ret {
+  // per reservation of the batch: 0 or a negative error code, and the
+  // allocated id (NO_ID on error)
+  std::vector<int32_t> results;
+  std::vector<cls_2pc_reservation::id_t> ids;
+
+  void encode(ceph::buffer::list& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(results, bl);
+    encode(ids, bl);
+    ENCODE_FINISH(bl);
+  }
+
+  void decode(ceph::buffer::list::const_iterator& bl) {
+    DECODE_START(1, bl);
+    decode(results, bl);
+    decode(ids, bl);
+    DECODE_FINISH(bl);
+  }
+
+  void dump(ceph::Formatter *f) const {
+    encode_json("results", results, f);
+    encode_json("ids", ids, f);
+  }
+
+  static void generate_test_instances(std::list<cls_2pc_queue_reserve_batch_ret*>& ls) {
+    ls.push_back(new cls_2pc_queue_reserve_batch_ret);
+    ls.push_back(new cls_2pc_queue_reserve_batch_ret);
+    ls.back()->results = {0, -ENOSPC};
+    ls.back()->ids = {123, cls_2pc_reservation::NO_ID};
+  }
+};
+WRITE_CLASS_ENCODER(cls_2pc_queue_reserve_batch_ret)
+
 struct cls_2pc_queue_commit_op {
   cls_2pc_reservation::id_t id; // reservation to commit
   std::vector<ceph::buffer::list> bl_data_vec; // the data to enqueue
@@ -149,7 +149,8 @@ static void bi_log_index_key(cls_method_context_t hctx, string& key, string& id,
 static int log_index_operation(cls_method_context_t hctx, const cls_rgw_obj_key& obj_key,
                                RGWModifyOp op, const string& tag, real_time timestamp,
                                const rgw_bucket_entry_ver& ver, RGWPendingState state, uint64_t index_ver,
-                               string& max_marker, uint16_t bilog_flags, string *owner, string *owner_display_name, rgw_zone_set *zones_trace)
+                               string& max_marker, uint16_t bilog_flags, string *owner, string *owner_display_name, rgw_zone_set *zones_trace,
+                               std::map<std::string, bufferlist> *batch = nullptr)
 {
   bufferlist bl;
 
@@ -182,6 +183,10 @@ static int log_index_operation(cls_method_context_t hctx, const cls_rgw_obj_key&
   if (entry.id > max_marker)
     max_marker = entry.id;
 
+  if (batch) {
+    (*batch)[key] = std::move(bl);
+    return 0;
+  }
   return cls_cxx_map_set_val(hctx, key, &bl);
 }
 
@@ -783,29 +788,12 @@ static std::string modify_op_str(uint8_t op) {
   return modify_op_str((RGWModifyOp) op);
 }
 
-int rgw_bucket_prepare_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+// applies one prepare op, for rgw_bucket_prepare_op() and
+// rgw_bucket_prepare_ops()
+static int prepare_one(cls_method_context_t hctx,
+		       const rgw_cls_obj_prepare_op& op,
+		       const bool bitx_inst)
 {
-  const ConfigProxy& conf = cls_get_config(hctx);
-  const object_info_t& oi = cls_get_object_info(hctx);
-
-  // bucket index transaction instrumentation
-  const bool bitx_inst =
-    conf->rgw_bucket_index_transaction_instrumentation;
-
-  CLS_LOG_BITX(bitx_inst, 10, "ENTERING %s for object oid=%s key=%s",
-	       __func__, oi.soid.oid.name.c_str(), oi.soid.get_key().c_str());
-
-  // decode request
-  rgw_cls_obj_prepare_op op;
-  auto iter = in->cbegin();
-  try {
-    decode(op, iter);
-  } catch (ceph::buffer::error& err) {
-    CLS_LOG_BITX(bitx_inst, 1,
-		 "ERROR: %s: failed to decode request", __func__);
-    return -EINVAL;
-  }
-
   if (op.tag.empty()) {
     CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: tag is empty", __func__);
     return -EINVAL;
@@ -863,6 +851,37 @@ int rgw_bucket_prepare_op(cls_method_context_t hctx, bufferlist *in, bufferlist
     return rc;
   }
 
+  return 0;
+}
+
+int rgw_bucket_prepare_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+{
+  const ConfigProxy& conf = cls_get_config(hctx);
+  const object_info_t& oi = cls_get_object_info(hctx);
+
+  // bucket index transaction instrumentation
+  const bool bitx_inst =
+    conf->rgw_bucket_index_transaction_instrumentation;
+
+  CLS_LOG_BITX(bitx_inst, 10, "ENTERING %s for object oid=%s key=%s",
+	       __func__, oi.soid.oid.name.c_str(), oi.soid.get_key().c_str());
+
+  // decode request
+  rgw_cls_obj_prepare_op op;
+  auto iter = in->cbegin();
+  try {
+    decode(op, iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG_BITX(bitx_inst, 1,
+		 "ERROR: %s: failed to decode request", __func__);
+    return -EINVAL;
+  }
+
+  int rc = prepare_one(hctx, op, bitx_inst);
+  if (rc < 0) {
+    return rc;
+  }
+
   CLS_LOG_BITX(bitx_inst, 10, "EXITING %s, returning 0", __func__);
   return 0;
 } // rgw_bucket_prepare_op
@@ -986,28 +1005,14 @@ static int complete_remove_obj(cls_method_context_t hctx,
   return ret;
 }
 
-int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+// applies one complete op to the header, for rgw_bucket_complete_op() and
+// rgw_bucket_complete_ops(); bilog entries go to *bilog if given
+static int complete_one(cls_method_context_t hctx,
+			rgw_bucket_dir_header& header,
+			rgw_cls_obj_complete_op& op,
+			const bool bitx_inst,
+			std::map<std::string, bufferlist> *bilog = nullptr)
 {
-  const ConfigProxy& conf = cls_get_config(hctx);
-  const object_info_t& oi = cls_get_object_info(hctx);
-
-  // bucket index transaction instrumentation
-  const bool bitx_inst =
-    conf->rgw_bucket_index_transaction_instrumentation;
-
-  CLS_LOG_BITX(bitx_inst, 10, "ENTERING %s for object oid=%s key=%s",
-	       __func__, oi.soid.oid.name.c_str(), oi.soid.get_key().c_str());
-
-  // decode request
-  rgw_cls_obj_complete_op op;
-  auto iter = in->cbegin();
-  try {
-    decode(op, iter);
-  } catch (ceph::buffer::error& err) {
-    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to decode request", __func__);
-    return -EINVAL;
-  }
-
   CLS_LOG_BITX(bitx_inst, 1,
 	       "INFO: %s: request: op=%s name=%s ver=%lu:%llu tag=%s",
 	       __func__,
@@ -1015,19 +1020,11 @@ int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist
 	       (unsigned long)op.ver.pool, (unsigned long long)op.ver.epoch,
 	       op.tag.c_str());
 
-  rgw_bucket_dir_header header;
-  int rc = read_bucket_header(hctx, &header);
-  if (rc < 0) {
-    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to read header, rc=%d",
-		 __func__, rc);
-    return -EINVAL;
-  }
-
   rgw_bucket_dir_entry entry;
   bool ondisk = true;
 
   std::string idx;
-  rc = read_key_entry(hctx, op.key, &idx, &entry);
+  int rc = read_key_entry(hctx, op.key, &idx, &entry);
   if (rc == -ENOENT) {
     entry.key = op.key;
     entry.ver = op.ver;
@@ -1184,7 +1181,7 @@ int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist
     rc = log_index_operation(hctx, op.key, op.op, op.tag, entry.meta.mtime,
 			     entry.ver, CLS_RGW_STATE_COMPLETE, header.ver,
 			     header.max_marker, op.bilog_flags, NULL, NULL,
-			     &op.zones_trace);
+			     &op.zones_trace, bilog);
     if (rc < 0) {
       CLS_LOG_BITX(bitx_inst, 0,
 		   "ERROR: %s: log_index_operation failed with rc=%d",
@@ -1209,6 +1206,44 @@ int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist
     }
   } // remove loop
 
+  return 0;
+}
+
+int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+{
+  const ConfigProxy& conf = cls_get_config(hctx);
+  const object_info_t& oi = cls_get_object_info(hctx);
+
+  // bucket index transaction instrumentation
+  const bool bitx_inst =
+    conf->rgw_bucket_index_transaction_instrumentation;
+
+  CLS_LOG_BITX(bitx_inst, 10, "ENTERING %s for object oid=%s key=%s",
+	       __func__, oi.soid.oid.name.c_str(), oi.soid.get_key().c_str());
+
+  // decode request
+  rgw_cls_obj_complete_op op;
+  auto iter = in->cbegin();
+  try {
+    decode(op, iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to decode request", __func__);
+    return -EINVAL;
+  }
+
+  rgw_bucket_dir_header header;
+  int rc = read_bucket_header(hctx, &header);
+  if (rc < 0) {
+    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to read header, rc=%d",
+		 __func__, rc);
+    return -EINVAL;
+  }
+
+  rc = complete_one(hctx, header, op, bitx_inst);
+  if (rc < 0) {
+    return rc;
+  }
+
   CLS_LOG_BITX(bitx_inst, 20,
 	       "INFO: %s: writing bucket header", __func__);
   rc = write_bucket_header(hctx, &header);
@@ -1223,6 +1258,140 @@ int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist
   return rc;
 } // rgw_bucket_complete_op
 
+// The ops of a batch all read the index before any of their writes
+// land, so no two of them may touch the same entry.
+static bool add_batch_key(std::set<std::string>& keys,
+			  const cls_rgw_obj_key& key)
+{
+  std::string k = key.name;
+  k.push_back('\0');
+  k.append(key.instance.empty() ? "null" : key.instance);
+  return keys.insert(std::move(k)).second;
+}
+
+static int rgw_bucket_prepare_ops(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+{
+  const ConfigProxy& conf = cls_get_config(hctx);
+  const object_info_t& oi = cls_get_object_info(hctx);
+
+  // bucket index transaction instrumentation
+  const bool bitx_inst =
+    conf->rgw_bucket_index_transaction_instrumentation;
+
+  CLS_LOG_BITX(bitx_inst, 10, "ENTERING %s for object oid=%s key=%s",
+	       __func__, oi.soid.oid.name.c_str(), oi.soid.get_key().c_str());
+
+  rgw_cls_obj_prepare_ops_op op;
+  auto iter = in->cbegin();
+  try {
+    decode(op, iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to decode request", __func__);
+    return -EINVAL;
+  }
+
+  std::set<std::string> keys;
+  for (const auto& o : op.ops) {
+    if (!add_batch_key(keys, o.key)) {
+      CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: key=%s is in the batch twice",
+		   __func__, o.key.to_string().c_str());
+      return -EINVAL;
+    }
+  }
+
+  for (const auto& o : op.ops) {
+    int rc = prepare_one(hctx, o, bitx_inst);
+    if (rc < 0) {
+      return rc;
+    }
+  }
+
+  CLS_LOG_BITX(bitx_inst, 10, "EXITING %s: %d ops, returning 0",
+	       __func__, (int)op.ops.size());
+  return 0;
+} // rgw_bucket_prepare_ops
+
+static int rgw_bucket_complete_ops(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+{
+  const ConfigProxy& conf = cls_get_config(hctx);
+  const object_info_t& oi = cls_get_object_info(hctx);
+
+  // bucket index transaction instrumentation
+  const bool bitx_inst =
+    conf->rgw_bucket_index_transaction_instrumentation;
+
+  CLS_LOG_BITX(bitx_inst, 10, "ENTERING %s for object oid=%s key=%s",
+	       __func__, oi.soid.oid.name.c_str(), oi.soid.get_key().c_str());
+
+  rgw_cls_obj_complete_ops_op op;
+  auto iter = in->cbegin();
+  try {
+    decode(op, iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to decode request", __func__);
+    return -EINVAL;
+  }
+
+  std::set<std::string> keys;
+  for (const auto& o : op.ops) {
+    bool unique = add_batch_key(keys, o.key);
+    for (const auto& remove_key : o.remove_objs) {
+      unique = unique && add_batch_key(keys, remove_key);
+    }
+    if (!unique) {
+      CLS_LOG_BITX(bitx_inst, 1,
+		   "ERROR: %s: an entry of key=%s is in the batch twice",
+		   __func__, o.key.to_string().c_str());
+      return -EINVAL;
+    }
+  }
+
+  rgw_bucket_dir_header header;
+  int rc = read_bucket_header(hctx, &header);
+  if (rc < 0) {
+    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to read header, rc=%d",
+		 __func__, rc);
+    return -EINVAL;
+  }
+
+  std::map<std::string, bufferlist> bilog;
+  for (size_t i = 0; i < op.ops.size(); ++i) {
+    if (i > 0) {
+      // as if each op had written the header, which keeps the index_ver
+      // of every entry, and so every bilog key, distinct
+      header.ver++;
+    }
+    rc = complete_one(hctx, header, op.ops[i], bitx_inst, &bilog);
+    if (rc < 0) {
+      return rc;
+    }
+  }
+
+  if (!bilog.empty()) {
+    rc = cls_cxx_map_set_vals(hctx, &bilog);
+    if (rc < 0) {
+      CLS_LOG_BITX(bitx_inst, 0,
+		   "ERROR: %s: failed to write %d bilog entries ret=%d",
+		   __func__, (int)bilog.size(), rc);
+      return rc;
+    }
+  }
+
+  CLS_LOG_BITX(bitx_inst, 20,
+	       "INFO: %s: writing bucket header", __func__);
+  rc = write_bucket_header(hctx, &header);
+  if (rc < 0) {
+    CLS_LOG_BITX(bitx_inst, 0,
+		 "ERROR: %s: failed to write bucket header ret=%d",
+		 __func__, rc);
+  }
+
+  CLS_LOG_BITX(bitx_inst, 10,
+	       "EXITING %s: %d ops, returning %d", __func__,
+	       (int)op.ops.size(), rc);
+  return rc;
+} // rgw_bucket_complete_ops
+
 template <class T>
 static int write_entry(cls_method_context_t hctx, T& entry, const string& key)
 {
@@ -2235,12 +2404,14 @@ int rgw_dir_suggest_changes(cls_method_context_t hctx,
        CEPH_RGW_DEFAULT_TAG_TIMEOUT)));
   CLS_LOG_BITX(bitx_inst, 10, "INFO: %s: tag_timeout=%ld", __func__, tag_timeout.count());
 
+  // decode all suggestions up front, so that the index entries they
+  // refer to can be fetched with one batched omap lookup
+  std::vector<std::pair<__u8, rgw_bucket_dir_entry>> changes;
+  std::set<std::string> change_keys;
   auto in_iter = in->cbegin();
-
   while (!in_iter.end()) {
     __u8 op;
     rgw_bucket_dir_entry cur_change;
-    rgw_bucket_dir_entry cur_disk;
     try {
       decode(op, in_iter);
       decode(cur_change, in_iter);
@@ -2249,7 +2420,23 @@ int rgw_dir_suggest_changes(cls_method_context_t hctx,
 		   "ERROR: %s: failed to decode request", __func__);
       return -EINVAL;
     }
+    string key;
+    encode_obj_index_key(cur_change.key, &key);
+    change_keys.insert(std::move(key));
+    changes.emplace_back(op, std::move(cur_change));
+  }
 
+  std::map<std::string, bufferlist> disk_entries;
+  rc = cls_cxx_map_get_vals_by_keys(hctx, change_keys, &disk_entries);
+  if (rc < 0) {
+    CLS_LOG_BITX(bitx_inst, 20,
+		 "ERROR: %s: accessing map, %d keys, error=%d", __func__,
+		 (int)change_keys.size(), rc);
+    return -EINVAL;
+  }
+
+  for (auto& [op, cur_change] : changes) {
+    rgw_bucket_dir_entry cur_disk;
     bufferlist cur_disk_bl;
     // check if the log op flag is set and strip it from the op
     bool log_op = (op & CEPH_RGW_DIR_SUGGEST_LOG_OP) != 0;
@@ -2264,20 +2451,16 @@ int rgw_dir_suggest_changes(cls_method_context_t hctx,
     CLS_LOG_BITX(bitx_inst, 20,
 		 "INFO: %s: setting map entry at key=%s",
 		 __func__, escape_str(cur_change_key).c_str());
-    int ret = cls_cxx_map_get_val(hctx, cur_change_key, &cur_disk_bl);
-    if (ret < 0 && ret != -ENOENT) {
-      CLS_LOG_BITX(bitx_inst, 20,
-		   "ERROR: %s: accessing map, key=%s error=%d", __func__,
-		   escape_str(cur_change_key).c_str(), ret);
-      return -EINVAL;
-    }
-
-    if (ret == -ENOENT) {
+    int ret;
+    auto disk_iter = disk_entries.find(cur_change_key);
+    if (disk_iter == disk_entries.end()) {
       CLS_LOG_BITX(bitx_inst, 20,
 		   "WARNING: %s: accessing map, key not found key=%s, continuing",
 		   __func__, escape_str(cur_change_key).c_str());
       continue;
     }
+    // copy rather than move: a key may be suggested more than once
+    cur_disk_bl = disk_iter->second;
 
     if (cur_disk_bl.length()) {
       auto cur_disk_iter = cur_disk_bl.cbegin();
@@ -2397,7 +2580,7 @@ int rgw_dir_suggest_changes(cls_method_context_t hctx,
         break;
       } // switch(op)
     } // if (cur_disk.pending_map.empty())
-  } // while (!in_iter.end())
+  } // for (changes)
 
   if (header_changed) {
     CLS_LOG_BITX(bitx_inst, 10, "INFO: %s: bucket header changed, writing", __func__);
@@ -3150,6 +3333,118 @@ int rgw_bucket_check_index(cls_method_context_t hctx, bufferlist *in, bufferlist
 }
 
 
+static void prefix_stats_account(const rgw_cls_bucket_prefix_stats_op& op,
+				 const rgw_bucket_dir_entry& entry,
+				 rgw_cls_bucket_prefix_stats_ret& op_ret)
+{
+  const std::string& name = entry.key.name;
+  if (name.size() > 1 && name[0] == '_' && name[1] != '_') {
+    // namespaced (e.g., multipart) entry, not an object of the bucket
+    return;
+  }
+
+  std::string group = op.prefix;
+  if (!op.delimiter.empty()) {
+    const auto pos = name.find(op.delimiter, op.prefix.size());
+    if (pos != std::string::npos) {
+      group = name.substr(0, pos + op.delimiter.size());
+    }
+  }
+
+  rgw_bucket_category_stats& stats = op_ret.stats[group];
+  stats.num_entries++;
+  stats.total_size += entry.meta.accounted_size;
+  stats.total_size_rounded += cls_rgw_get_rounded_size(entry.meta.accounted_size);
+  stats.actual_size += entry.meta.size;
+}
+
+/* Aggregates the stats of the objects whose names begin with a
+ * prefix, counting them as check_index() does, by walking the plain
+ * entries and then the instance entries of the range. A call scans
+ * at most op.max_entries index entries and returns a marker to resume
+ * with, so that large ranges are aggregated over several calls
+ * without returning the entries themselves.
+ */
+static int rgw_bucket_prefix_stats(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+{
+  CLS_LOG(10, "entered %s", __func__);
+  rgw_cls_bucket_prefix_stats_op op;
+  auto iter = in->cbegin();
+  try {
+    decode(op, iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG(0, "ERROR: %s: failed to decode request", __func__);
+    return -EINVAL;
+  }
+
+  constexpr uint32_t MAX_PREFIX_STATS_ENTRIES = 10000;
+  const uint32_t max = std::clamp(op.max_entries, 1u, MAX_PREFIX_STATS_ENTRIES);
+
+  rgw_cls_bucket_prefix_stats_ret op_ret;
+  op_ret.instances = op.instances;
+  std::string start_after = op.marker;
+  uint32_t count = 0;
+  bool more = true;
+
+  while (count < max) {
+    std::string filter = op.prefix;
+    if (op_ret.instances) {
+      filter = BI_PREFIX_CHAR;
+      filter.append(bucket_index_prefixes[BI_BUCKET_OBJ_INSTANCE_INDEX]);
+      filter.append(op.prefix);
+    }
+
+    std::map<std::string, bufferlist> vals;
+    int ret = cls_cxx_map_get_vals(hctx, start_after, filter, max - count,
+				   &vals, &more);
+    if (ret < 0) {
+      CLS_LOG(0, "ERROR: %s: cls_cxx_map_get_vals returned ret=%d", __func__, ret);
+      return ret;
+    }
+
+    for (const auto& [key, val] : vals) {
+      if (!op_ret.instances && !bi_is_plain_entry(key)) {
+	// skip over the special entries to the non-ascii plain entries
+	start_after = BI_PREFIX_END;
+	more = true;
+	break;
+      }
+
+      rgw_bucket_dir_entry entry;
+      auto biter = val.cbegin();
+      try {
+	decode(entry, biter);
+      } catch (ceph::buffer::error& err) {
+	CLS_LOG(1, "ERROR: %s: failed to decode entry, key=%s", __func__,
+		escape_str(key).c_str());
+	return -EIO;
+      }
+
+      if (entry.exists && (op_ret.instances || entry.flags == 0)) {
+	prefix_stats_account(op, entry, op_ret);
+      }
+      start_after = key;
+      ++count;
+    }
+
+    if (!more) {
+      if (op_ret.instances) {
+	break;
+      }
+      // plain entries are done, continue with the instance entries
+      op_ret.instances = true;
+      start_after.clear();
+      more = true;
+    }
+  }
+
+  op_ret.marker = std::move(start_after);
+  op_ret.is_truncated = more;
+  encode(op_ret, *out);
+
+  return 0;
+}
+
 /* Lists all the entries that appear in a bucket index listing.
  *
  * It may not be obvious why this function calls three other "segment"
@@ -4664,10 +4959,13 @@ CLS_INIT(rgw)
   cls_method_handle_t h_rgw_bucket_set_tag_timeout;
   cls_method_handle_t h_rgw_bucket_list;
   cls_method_handle_t h_rgw_bucket_check_index;
+  cls_method_handle_t h_rgw_bucket_prefix_stats;
   cls_method_handle_t h_rgw_bucket_rebuild_index;
   cls_method_handle_t h_rgw_bucket_update_stats;
   cls_method_handle_t h_rgw_bucket_prepare_op;
   cls_method_handle_t h_rgw_bucket_complete_op;
+  cls_method_handle_t h_rgw_bucket_prepare_ops;
+  cls_method_handle_t h_rgw_bucket_complete_ops;
   cls_method_handle_t h_rgw_bucket_link_olh;
   cls_method_handle_t h_rgw_bucket_unlink_instance_op;
   cls_method_handle_t h_rgw_bucket_read_olh_log;
@@ -4717,10 +5015,13 @@ CLS_INIT(rgw)
   cls_register_cxx_method(h_class, RGW_BUCKET_SET_TAG_TIMEOUT, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_set_tag_timeout, &h_rgw_bucket_set_tag_timeout);
   cls_register_cxx_method(h_class, RGW_BUCKET_LIST, CLS_METHOD_RD, rgw_bucket_list, &h_rgw_bucket_list);
   cls_register_cxx_method(h_class, RGW_BUCKET_CHECK_INDEX, CLS_METHOD_RD, rgw_bucket_check_index, &h_rgw_bucket_check_index);
+  cls_register_cxx_method(h_class, RGW_BUCKET_PREFIX_STATS, CLS_METHOD_RD, rgw_bucket_prefix_stats, &h_rgw_bucket_prefix_stats);
   cls_register_cxx_method(h_class, RGW_BUCKET_REBUILD_INDEX, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_rebuild_index, &h_rgw_bucket_rebuild_index);
   cls_register_cxx_method(h_class, RGW_BUCKET_UPDATE_STATS, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_update_stats, &h_rgw_bucket_update_stats);
   cls_register_cxx_method(h_class, RGW_BUCKET_PREPARE_OP, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_prepare_op, &h_rgw_bucket_prepare_op);
   cls_register_cxx_method(h_class, RGW_BUCKET_COMPLETE_OP, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_complete_op, &h_rgw_bucket_complete_op);
+  cls_register_cxx_method(h_class, RGW_BUCKET_PREPARE_OPS, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_prepare_ops, &h_rgw_bucket_prepare_ops);
+  cls_register_cxx_method(h_class, RGW_BUCKET_COMPLETE_OPS, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_complete_ops, &h_rgw_bucket_complete_ops);
   cls_register_cxx_method(h_class, RGW_BUCKET_LINK_OLH, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_link_olh, &h_rgw_bucket_link_olh);
   cls_register_cxx_method(h_class, RGW_BUCKET_UNLINK_INSTANCE, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_unlink_instance, &h_rgw_bucket_unlink_instance_op);
   cls_register_cxx_method(h_class, RGW_BUCKET_READ_OLH_LOG, CLS_METHOD_RD, rgw_bucket_read_olh_log, &h_rgw_bucket_read_olh_log);
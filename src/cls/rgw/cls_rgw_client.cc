@@ -309,6 +309,26 @@ void cls_rgw_bucket_complete_op(ObjectWriteOperation& o, RGWModifyOp op, const s
   o.exec(RGW_CLASS, RGW_BUCKET_COMPLETE_OP, in);
 }
 
+void cls_rgw_bucket_prepare_ops(ObjectWriteOperation& o,
+                                const vector<rgw_cls_obj_prepare_op>& ops)
+{
+  rgw_cls_obj_prepare_ops_op call;
+  call.ops = ops;
+  bufferlist in;
+  encode(call, in);
+  o.exec(RGW_CLASS, RGW_BUCKET_PREPARE_OPS, in);
+}
+
+void cls_rgw_bucket_complete_ops(ObjectWriteOperation& o,
+                                 const vector<rgw_cls_obj_complete_op>& ops)
+{
+  rgw_cls_obj_complete_ops_op call;
+  call.ops = ops;
+  bufferlist in;
+  encode(call, in);
+  o.exec(RGW_CLASS, RGW_BUCKET_COMPLETE_OPS, in);
+}
+
 void cls_rgw_bucket_list_op(librados::ObjectReadOperation& op,
                             const cls_rgw_obj_key& start_obj,
                             const std::string& filter_prefix,
@@ -496,6 +516,62 @@ int cls_rgw_bi_list(librados::IoCtx& io_ctx, const std::string& oid,
   return 0;
 }
 
+int cls_rgw_bucket_prefix_stats(librados::IoCtx& io_ctx, const std::string& oid,
+                                const std::string& prefix, const std::string& delimiter,
+                                uint32_t max_entries,
+                                std::map<std::string, rgw_bucket_category_stats> *stats)
+{
+  rgw_cls_bucket_prefix_stats_op call;
+  call.prefix = prefix;
+  call.delimiter = delimiter;
+  call.max_entries = max_entries;
+
+  bool is_truncated = true;
+  while (is_truncated) {
+    bufferlist in, out;
+    encode(call, in);
+    int r = io_ctx.exec(oid, RGW_CLASS, RGW_BUCKET_PREFIX_STATS, in, out);
+    if (r < 0)
+      return r;
+
+    rgw_cls_bucket_prefix_stats_ret op_ret;
+    auto iter = out.cbegin();
+    try {
+      decode(op_ret, iter);
+    } catch (ceph::buffer::error& err) {
+      return -EIO;
+    }
+
+    for (const auto& [group, s] : op_ret.stats) {
+      auto& total = (*stats)[group];
+      total.num_entries += s.num_entries;
+      total.total_size += s.total_size;
+      total.total_size_rounded += s.total_size_rounded;
+      total.actual_size += s.actual_size;
+    }
+
+    call.marker = std::move(op_ret.marker);
+    call.instances = op_ret.instances;
+    is_truncated = op_ret.is_truncated;
+  }
+
+  return 0;
+}
+
+void cls_rgw_bi_list(librados::ObjectReadOperation& op,
+                     const std::string& name_filter, const std::string& marker,
+                     uint32_t max, rgw_cls_bi_list_ret *pdata, int *ret)
+{
+  bufferlist in;
+  rgw_cls_bi_list_op call;
+  call.name_filter = name_filter;
+  call.marker = marker;
+  call.max = max;
+  encode(call, in);
+  op.exec(RGW_CLASS, RGW_BI_LIST, in,
+          new ClsBucketIndexOpCtx<rgw_cls_bi_list_ret>(pdata, ret));
+}
+
 int cls_rgw_bucket_link_olh(librados::IoCtx& io_ctx, const string& oid,
                             const cls_rgw_obj_key& key, const bufferlist& olh_tag,
                             bool delete_marker, const string& op_tag, const rgw_bucket_dir_entry_meta *meta,
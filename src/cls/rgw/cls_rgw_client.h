@@ -360,6 +360,14 @@ void cls_rgw_bucket_complete_op(librados::ObjectWriteOperation& o, RGWModifyOp o
                                 uint16_t bilog_op, const rgw_zone_set *zones_trace,
 				const std::string& obj_locator = ""); // ignored if it's the empty string
 
+/// many prepare or complete ops on one index shard in a single call, see
+/// rgw_cls_obj_prepare_ops_op; callers fall back to the single-op calls
+/// on -EOPNOTSUPP (older OSDs) or to find out which op failed
+void cls_rgw_bucket_prepare_ops(librados::ObjectWriteOperation& o,
+                                const std::vector<rgw_cls_obj_prepare_op>& ops);
+void cls_rgw_bucket_complete_ops(librados::ObjectWriteOperation& o,
+                                 const std::vector<rgw_cls_obj_complete_op>& ops);
+
 void cls_rgw_remove_obj(librados::ObjectWriteOperation& o, std::list<std::string>& keep_attr_prefixes);
 void cls_rgw_obj_store_pg_ver(librados::ObjectWriteOperation& o, const std::string& attr);
 void cls_rgw_obj_check_attrs_prefix(librados::ObjectOperation& o, const std::string& prefix, bool fail_if_exist);
@@ -373,6 +381,17 @@ void cls_rgw_bi_put(librados::ObjectWriteOperation& op, const std::string oid, c
 int cls_rgw_bi_list(librados::IoCtx& io_ctx, const std::string& oid,
                    const std::string& name, const std::string& marker, uint32_t max,
                    std::list<rgw_cls_bi_entry> *entries, bool *is_truncated);
+void cls_rgw_bi_list(librados::ObjectReadOperation& op,
+                     const std::string& name, const std::string& marker,
+                     uint32_t max, rgw_cls_bi_list_ret *pdata, int *ret);
+
+/* adds the stats of the objects under prefix in one index shard to
+ * *stats, grouped by the next delimiter; max_entries bounds the index
+ * entries scanned per call */
+int cls_rgw_bucket_prefix_stats(librados::IoCtx& io_ctx, const std::string& oid,
+                                const std::string& prefix, const std::string& delimiter,
+                                uint32_t max_entries,
+                                std::map<std::string, rgw_bucket_category_stats> *stats);
 
 
 void cls_rgw_bucket_link_olh(librados::ObjectWriteOperation& op,
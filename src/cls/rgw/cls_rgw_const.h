@@ -17,10 +17,13 @@ constexpr int RGWBIAdvanceAndRetryError = -EFBIG;
 #define RGW_BUCKET_SET_TAG_TIMEOUT "bucket_set_tag_timeout"
 #define RGW_BUCKET_LIST "bucket_list"
 #define RGW_BUCKET_CHECK_INDEX "bucket_check_index"
+#define RGW_BUCKET_PREFIX_STATS "bucket_prefix_stats"
 #define RGW_BUCKET_REBUILD_INDEX "bucket_rebuild_index"
 #define RGW_BUCKET_UPDATE_STATS "bucket_update_stats"
 #define RGW_BUCKET_PREPARE_OP "bucket_prepare_op"
 #define RGW_BUCKET_COMPLETE_OP "bucket_complete_op"
+#define RGW_BUCKET_PREPARE_OPS "bucket_prepare_ops"
+#define RGW_BUCKET_COMPLETE_OPS "bucket_complete_ops"
 #define RGW_BUCKET_LINK_OLH "bucket_link_olh"
 #define RGW_BUCKET_UNLINK_INSTANCE "bucket_unlink_instance"
 #define RGW_BUCKET_READ_OLH_LOG "bucket_read_olh_log"
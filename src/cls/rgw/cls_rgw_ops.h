@@ -164,6 +164,49 @@ struct rgw_cls_obj_complete_op
 };
 WRITE_CLASS_ENCODER(rgw_cls_obj_complete_op)
 
+/// prepare ops for many entries of one index shard, applied in one
+/// transaction: all of them or, if one fails, none
+struct rgw_cls_obj_prepare_ops_op
+{
+  std::vector<rgw_cls_obj_prepare_op> ops;
+
+  void encode(ceph::buffer::list &bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(ops, bl);
+    ENCODE_FINISH(bl);
+  }
+  void decode(ceph::buffer::list::const_iterator &bl) {
+    DECODE_START(1, bl);
+    decode(ops, bl);
+    DECODE_FINISH(bl);
+  }
+  void dump(ceph::Formatter *f) const;
+  static void generate_test_instances(std::list<rgw_cls_obj_prepare_ops_op*>& o);
+};
+WRITE_CLASS_ENCODER(rgw_cls_obj_prepare_ops_op)
+
+/// complete ops for many entries of one index shard, applied in one
+/// transaction with their bilog entries: all of them or, if one fails,
+/// none
+struct rgw_cls_obj_complete_ops_op
+{
+  std::vector<rgw_cls_obj_complete_op> ops;
+
+  void encode(ceph::buffer::list &bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(ops, bl);
+    ENCODE_FINISH(bl);
+  }
+  void decode(ceph::buffer::list::const_iterator &bl) {
+    DECODE_START(1, bl);
+    decode(ops, bl);
+    DECODE_FINISH(bl);
+  }
+  void dump(ceph::Formatter *f) const;
+  static void generate_test_instances(std::list<rgw_cls_obj_complete_ops_op*>& o);
+};
+WRITE_CLASS_ENCODER(rgw_cls_obj_complete_ops_op)
+
 struct rgw_cls_link_olh_op {
   cls_rgw_obj_key key;
   std::string olh_tag;
@@ -831,6 +874,108 @@ struct rgw_cls_bi_list_ret {
 };
 WRITE_CLASS_ENCODER(rgw_cls_bi_list_ret)
 
+/* aggregate the stats of the objects under a prefix, grouped by the
+ * next delimiter (if any); objects directly under the prefix are
+ * accounted under the prefix itself */
+struct rgw_cls_bucket_prefix_stats_op {
+  std::string prefix;
+  std::string delimiter;
+  std::string marker; // index key to resume after
+  bool instances{false}; // resume in the instance entries
+  uint32_t max_entries{0}; // index entries to scan
+
+  void encode(ceph::buffer::list& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(prefix, bl);
+    encode(delimiter, bl);
+    encode(marker, bl);
+    encode(instances, bl);
+    encode(max_entries, bl);
+    ENCODE_FINISH(bl);
+  }
+
+  void decode(ceph::buffer::list::const_iterator& bl) {
+    DECODE_START(1, bl);
+    decode(prefix, bl);
+    decode(delimiter, bl);
+    decode(marker, bl);
+    decode(instances, bl);
+    decode(max_entries, bl);
+    DECODE_FINISH(bl);
+  }
+
+  void dump(ceph::Formatter *f) const {
+    f->dump_string("prefix", prefix);
+    f->dump_string("delimiter", delimiter);
+    f->dump_string("marker", marker);
+    f->dump_bool("instances", instances);
+    f->dump_unsigned("max_entries", max_entries);
+  }
+
+  static void generate_test_instances(std::list<rgw_cls_bucket_prefix_stats_op*>& o) {
+    o.push_back(new rgw_cls_bucket_prefix_stats_op);
+    o.push_back(new rgw_cls_bucket_prefix_stats_op);
+    o.back()->prefix = "photos/";
+    o.back()->delimiter = "/";
+    o.back()->marker = "photos/2024/img.jpg";
+    o.back()->instances = true;
+    o.back()->max_entries = 1000;
+  }
+};
+WRITE_CLASS_ENCODER(rgw_cls_bucket_prefix_stats_op)
+
+struct rgw_cls_bucket_prefix_stats_ret {
+  std::map<std::string, rgw_bucket_category_stats> stats;
+  std::string marker;
+  bool instances{false};
+  bool is_truncated{false};
+
+  void encode(ceph::buffer::list& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(stats, bl);
+    encode(marker, bl);
+    encode(instances, bl);
+    encode(is_truncated, bl);
+    ENCODE_FINISH(bl);
+  }
+
+  void decode(ceph::buffer::list::const_iterator& bl) {
+    DECODE_START(1, bl);
+    decode(stats, bl);
+    decode(marker, bl);
+    decode(instances, bl);
+    decode(is_truncated, bl);
+    DECODE_FINISH(bl);
+  }
+
+  void dump(ceph::Formatter *f) const {
+    f->open_array_section("stats");
+    for (const auto& [prefix, s] : stats) {
+      f->open_object_section("entry");
+      f->dump_string("prefix", prefix);
+      s.dump(f);
+      f->close_section();
+    }
+    f->close_section();
+    f->dump_string("marker", marker);
+    f->dump_bool("instances", instances);
+    f->dump_bool("is_truncated", is_truncated);
+  }
+
+  static void generate_test_instances(std::list<rgw_cls_bucket_prefix_stats_ret*>& o) {
+    o.push_back(new rgw_cls_bucket_prefix_stats_ret);
+    o.push_back(new rgw_cls_bucket_prefix_stats_ret);
+    auto& s = o.back()->stats["photos/2024/"];
+    s.num_entries = 2;
+    s.total_size = 1024;
+    s.total_size_rounded = 8192;
+    s.actual_size = 1024;
+    o.back()->marker = "photos/2024/img.jpg";
+    o.back()->is_truncated = true;
+  }
+};
+WRITE_CLASS_ENCODER(rgw_cls_bucket_prefix_stats_ret)
+
 struct rgw_cls_usage_log_read_op {
   uint64_t start_epoch;
   uint64_t end_epoch;
@@ -4,9 +4,12 @@
 #ifndef CEPH_OS_BLUESTORE_CHECKSUMMER
 #define CEPH_OS_BLUESTORE_CHECKSUMMER
 
+#include <vector>
+
 #include "include/buffer.h"
 #include "include/byteorder.h"
 #include "include/ceph_assert.h"
+#include "include/crc32c.h"
 
 #include "xxHash/xxhash.h"
 
@@ -90,6 +93,14 @@ public:
       ) {
       return p.crc32c(len, init_value);
     }
+    static init_value_t calc(
+      state_t state,
+      init_value_t init_value,
+      size_t len,
+      const char *data
+      ) {
+      return ceph_crc32c(init_value, (const unsigned char*)data, len);
+    }
   };
 
   struct crc32c_16 {
@@ -111,6 +122,14 @@ public:
       ) {
       return p.crc32c(len, init_value) & 0xffff;
     }
+    static init_value_t calc(
+      state_t state,
+      init_value_t init_value,
+      size_t len,
+      const char *data
+      ) {
+      return ceph_crc32c(init_value, (const unsigned char*)data, len) & 0xffff;
+    }
   };
 
   struct crc32c_8 {
@@ -132,6 +151,14 @@ public:
       ) {
       return p.crc32c(len, init_value) & 0xff;
     }
+    static init_value_t calc(
+      state_t state,
+      init_value_t init_value,
+      size_t len,
+      const char *data
+      ) {
+      return ceph_crc32c(init_value, (const unsigned char*)data, len) & 0xff;
+    }
   };
 
   struct xxhash32 {
@@ -161,6 +188,14 @@ public:
       }
       return XXH32_digest(state);
     }
+    static init_value_t calc(
+      state_t state,
+      init_value_t init_value,
+      size_t len,
+      const char *data
+      ) {
+      return XXH32(data, len, init_value);
+    }
   };
 
   struct xxhash64 {
@@ -190,6 +225,14 @@ public:
       }
       return XXH64_digest(state);
     }
+    static init_value_t calc(
+      state_t state,
+      init_value_t init_value,
+      size_t len,
+      const char *data
+      ) {
+      return XXH64(data, len, init_value);
+    }
   };
 
   template<class Alg>
@@ -246,28 +289,116 @@ public:
     ceph::buffer::list::const_iterator p = bl.begin();
     ceph_assert(bl.length() >= length);
 
-    typename Alg::state_t state;
-    Alg::init(&state);
+    // a single buffer (the usual result of a device read) is hashed in
+    // place, without an iterator walk or a hash state reset per block
+    const char *data = nullptr;
+    if (bl.get_num_buffers() == 1) {
+      data = bl.front().c_str();
+    }
+
+    typename Alg::state_t state{};
+    if (!data) {
+      Alg::init(&state);
+    }
 
     const typename Alg::value_t *pv =
       reinterpret_cast<const typename Alg::value_t*>(csum_data.c_str());
     pv += offset / csum_block_size;
     size_t pos = offset;
+    int r = -1;  // no errors
     while (length > 0) {
-      typename Alg::init_value_t v = Alg::calc(state, -1, csum_block_size, p);
+      typename Alg::init_value_t v = data ?
+	Alg::calc(state, -1, csum_block_size, data + (pos - offset)) :
+	Alg::calc(state, -1, csum_block_size, p);
       if (*pv != v) {
 	if (bad_csum) {
 	  *bad_csum = v;
 	}
-	Alg::fini(&state);
-	return pos;
+	r = pos;
+	break;
       }
       ++pv;
       pos += csum_block_size;
       length -= csum_block_size;
     }
-    Alg::fini(&state);
-    return -1;  // no errors
+    if (!data) {
+      Alg::fini(&state);
+    }
+    return r;
+  }
+
+  static int verify(
+    int csum_type,
+    size_t csum_block_size,
+    size_t offset,
+    size_t length,
+    const ceph::buffer::list &bl,
+    const ceph::buffer::ptr& csum_data,
+    int *bad_off,
+    uint64_t *bad_csum=0
+    ) {
+    switch (csum_type) {
+    case CSUM_NONE:
+      *bad_off = -1;
+      break;
+    case CSUM_XXHASH32:
+      *bad_off = verify<xxhash32>(
+	csum_block_size, offset, length, bl, csum_data, bad_csum);
+      break;
+    case CSUM_XXHASH64:
+      *bad_off = verify<xxhash64>(
+	csum_block_size, offset, length, bl, csum_data, bad_csum);
+      break;
+    case CSUM_CRC32C:
+      *bad_off = verify<crc32c>(
+	csum_block_size, offset, length, bl, csum_data, bad_csum);
+      break;
+    case CSUM_CRC32C_16:
+      *bad_off = verify<crc32c_16>(
+	csum_block_size, offset, length, bl, csum_data, bad_csum);
+      break;
+    case CSUM_CRC32C_8:
+      *bad_off = verify<crc32c_8>(
+	csum_block_size, offset, length, bl, csum_data, bad_csum);
+      break;
+    default:
+      return -EOPNOTSUPP;
+    }
+    return *bad_off >= 0 ? -1 : 0;
+  }
+
+  /// one independently checksummed range of a batch
+  struct verify_item_t {
+    int csum_type;
+    size_t csum_block_size;
+    size_t offset;                        ///< offset of bl in the csum'ed data
+    const ceph::buffer::list *bl;
+    const ceph::buffer::ptr *csum_data;
+  };
+
+  /**
+   * verify a batch of independent ranges, e.g. all blobs touched by a read
+   *
+   * @return 0 if every range matches, -1 on the first mismatch (with
+   * *bad_item, *bad_off and *bad_csum describing it), or -EOPNOTSUPP for
+   * an unknown csum type.
+   */
+  static int verify_batch(
+    const std::vector<verify_item_t>& items,
+    size_t *bad_item,
+    int *bad_off,
+    uint64_t *bad_csum=0
+    ) {
+    for (size_t i = 0; i < items.size(); ++i) {
+      const auto& it = items[i];
+      int r = verify(it.csum_type, it.csum_block_size, it.offset,
+		     it.bl->length(), *it.bl, *it.csum_data, bad_off, bad_csum);
+      if (r < 0) {
+	*bad_item = i;
+	return r;
+      }
+    }
+    return 0;
   }
 };
 
@@ -71,6 +71,31 @@ void FastCDC::_setup(int target, int size_window_bits)
   }
 }
 
+// Roll the fingerprint over a contiguous span until it matches mask,
+// returning how many bytes were consumed (len if there was no match).
+//
+// This is the hot loop.  The state lives in locals rather than behind
+// the caller's references: fp and pos are both 64-bit integers, so the
+// compiler would otherwise have to assume they alias and go through
+// memory for every byte.  The gear hash is a serial dependency chain,
+// one shift+xor per byte, so this is as fast as the scalar code gets
+// without changing where the cut points fall.
+static inline size_t _scan_span(
+  const unsigned char *p, size_t len,
+  uint64_t& fp, uint64_t mask, const uint64_t *table)
+{
+  uint64_t f = fp;
+  size_t i = 0;
+  for (; i < len; ++i) {
+    if ((f & mask) == mask) {
+      break;
+    }
+    f = (f << 1) ^ table[p[i]];
+  }
+  fp = f;
+  return i;
+}
+
 static inline bool _scan(
   // these are our cursor/postion...
   bufferlist::buffers_t::const_iterator *p,
@@ -86,15 +111,13 @@ static inline bool _scan(
       *pp = (*p)->c_str();
       *pe = *pp + (*p)->length();
     }
-    const char *te = std::min(*pe, *pp + max - pos);
-    for (; *pp < te; ++(*pp), ++pos) {
-      if ((fp & mask) == mask) {
-	return false;
-      }
-      fp = (fp << 1) ^ table[*(unsigned char*)*pp];
-    }
-    if (pos >= max) {
-      return true;
+    size_t n = std::min<size_t>(*pe - *pp, max - pos);
+    size_t did = _scan_span(reinterpret_cast<const unsigned char*>(*pp), n,
+			    fp, mask, table);
+    *pp += did;
+    pos += did;
+    if (did < n) {
+      return false;
     }
   }
   return true;
@@ -146,10 +169,15 @@ void FastCDC::calc_chunks(
 	pp = p->c_str();
 	pe = pp + p->length();
       }
-      const char *te = std::min(pe, pp + (max - pos));
-      for (; pp < te; ++pp, ++pos) {
-	fp = (fp << 1) ^ table[*(unsigned char*)pp];
+      size_t n = std::min<size_t>(pe - pp, max - pos);
+      auto u = reinterpret_cast<const unsigned char*>(pp);
+      uint64_t f = fp;
+      for (size_t i = 0; i < n; ++i) {
+	f = (f << 1) ^ table[u[i]];
       }
+      fp = f;
+      pp += n;
+      pos += n;
     }
     ceph_assert(pos < len);
 
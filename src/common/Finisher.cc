@@ -100,3 +100,59 @@ void *Finisher::finisher_thread_entry()
   return 0;
 }
 
+ShardedFinisher::ShardedFinisher(CephContext *cct, const std::string& name,
+				 const std::string& tn, unsigned num_shards)
+{
+  if (num_shards <= 1) {
+    shards.emplace_back(std::make_unique<Finisher>(cct, name, tn));
+    return;
+  }
+  for (unsigned i = 0; i < num_shards; ++i) {
+    auto si = std::to_string(i);
+    shards.emplace_back(
+      std::make_unique<Finisher>(cct, name + "-" + si, tn + si));
+  }
+}
+
+void ShardedFinisher::start()
+{
+  for (auto& f : shards) {
+    f->start();
+  }
+}
+
+void ShardedFinisher::stop()
+{
+  for (auto& f : shards) {
+    f->stop();
+  }
+}
+
+void ShardedFinisher::wait_for_empty()
+{
+  // a context may queue more work on another shard; repeat until a full
+  // pass finds every shard idle
+  bool again;
+  do {
+    again = false;
+    for (auto& f : shards) {
+      f->wait_for_empty();
+    }
+    for (auto& f : shards) {
+      if (!f->is_empty()) {
+	again = true;
+	break;
+      }
+    }
+  } while (again);
+}
+
+bool ShardedFinisher::is_empty()
+{
+  for (auto& f : shards) {
+    if (!f->is_empty()) {
+      return false;
+    }
+  }
+  return true;
+}
@@ -169,6 +169,52 @@ class Finisher {
   }
 };
 
+/** @brief Finisher running on several threads.
+ * Each thread is a Finisher of its own.  Contexts queued with the same
+ * key complete on the same thread, in the order they were queued,
+ * e.g. keyed by sequencer.  Contexts without ordering constraints are
+ * spread round-robin.  With a single shard this behaves exactly like a
+ * Finisher of the given name.
+ */
+class ShardedFinisher {
+  std::vector<std::unique_ptr<Finisher>> shards;
+  std::atomic<unsigned> next_shard = {0};
+
+  Finisher& shard_of(uint64_t key) {
+    // keys are often pointers; mix the bits before picking the shard
+    return *shards[((key * 0x9e3779b97f4a7c15ull) >> 32) % shards.size()];
+  }
+  Finisher& any_shard() {
+    return *shards[next_shard++ % shards.size()];
+  }
+
+ public:
+  ShardedFinisher(CephContext *cct, const std::string& name,
+		  const std::string& tn, unsigned num_shards);
+
+  /// Complete c after everything queued before with the same key.
+  void queue(uint64_t key, Context *c, int r = 0) {
+    shard_of(key).queue(c, r);
+  }
+  template <typename C>
+  void queue(uint64_t key, C& ls) {
+    shard_of(key).queue(ls);
+  }
+  /// Complete c with no ordering against other contexts.
+  void queue(Context *c, int r = 0) {
+    any_shard().queue(c, r);
+  }
+
+  unsigned get_num_shards() const {
+    return shards.size();
+  }
+
+  void start();
+  void stop();
+  void wait_for_empty();
+  bool is_empty();
+};
+
 /// Context that is completed asynchronously on the supplied finisher.
 class C_OnFinisher : public Context {
   Context *con;
@@ -1,6 +1,8 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
 // vim: ts=8 sw=2 smarttab
 
+#include <cmath>
+
 #include "include/scope_guard.h"
 
 #include "common/Throttle.h"
@@ -97,8 +99,10 @@ bool Throttle::_wait(int64_t c, std::unique_lock<std::mutex>& l)
   if (_should_wait(c) || !conds.empty()) { // always wait behind other waiters.
     {
       auto cv = conds.emplace(conds.end());
+      ++num_waiters;
       auto w = make_scope_guard([this, cv]() {
 	  conds.erase(cv);
+	  --num_waiters;
 	});
       waited = true;
       ldout(cct, 2) << "_wait waiting..." << dendl;
@@ -119,6 +123,23 @@ bool Throttle::_wait(int64_t c, std::unique_lock<std::mutex>& l)
   return waited;
 }
 
+bool Throttle::_get_fast(int64_t c)
+{
+  // a waiter bumps num_waiters before it checks count, and put() drops
+  // count before it checks num_waiters, so with both seq_cst either the
+  // waiter sees the slots come back or put() sees the waiter.
+  if (num_waiters > 0) {
+    return false;
+  }
+  int64_t cur = count;
+  while (!_should_wait(c, cur)) {
+    if (count.compare_exchange_weak(cur, cur + c)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool Throttle::wait(int64_t m)
 {
   if (0 == max && 0 == m) {
@@ -163,7 +184,9 @@ bool Throttle::get(int64_t c, int64_t m)
     logger->inc(l_throttle_get_started);
   }
   bool waited = false;
-  {
+  if ((m == 0 || m == max) && _get_fast(c)) {
+    // got it without the lock
+  } else {
     std::unique_lock l(lock);
     if (m) {
       ceph_assert(m > 0);
@@ -192,7 +215,10 @@ bool Throttle::get_or_fail(int64_t c)
 
   assert (c >= 0);
   bool result = false;
-  {
+  if (_get_fast(c)) {
+    ldout(cct, 10) << "get_or_fail " << c << " success" << dendl;
+    result = true;
+  } else {
     std::lock_guard l(lock);
     if (_should_wait(c) || !conds.empty()) {
       ldout(cct, 10) << "get_or_fail " << c << " failed" << dendl;
@@ -228,17 +254,13 @@ int64_t Throttle::put(int64_t c)
   ceph_assert(c >= 0);
   ldout(cct, 10) << "put " << c << " (" << count.load() << " -> "
 		 << (count.load()-c) << ")" << dendl;
-  int64_t new_count;
-  {
+  int64_t new_count = count.fetch_sub(c) - c;
+  // if count goes negative, we failed somewhere!
+  ceph_assert(new_count >= 0);
+  if (c && num_waiters > 0) {
     std::lock_guard l(lock);
-    new_count = count;
-    if (c) {
-      if (!conds.empty())
-	conds.front().notify_one();
-      // if count goes negative, we failed somewhere!
-      ceph_assert(count >= c);
-      new_count = count -= c;
-    }
+    if (!conds.empty())
+      conds.front().notify_one();
   }
   if (logger) {
     logger->inc(l_throttle_put);
@@ -407,10 +429,40 @@ bool BackoffThrottle::set_params(
     s1 = 0;
   }
 
+  _update_fast_limits();
   _kick_waiters();
   return true;
 }
 
+void BackoffThrottle::_update_fast_limits()
+{
+  // lock must be held.
+  if (max == 0) {
+    fast_delay_limit = UINT64_MAX;
+    fast_max = UINT64_MAX;
+  } else {
+    // current < ceil(l * max) iff current / max < l, i.e. no delay
+    fast_delay_limit = std::ceil(low_threshold * max);
+    fast_max = max;
+  }
+}
+
+bool BackoffThrottle::_get_fast(uint64_t c)
+{
+  // see Throttle::_get_fast() for why this does not lose wakeups
+  if (num_waiters > 0) {
+    return false;
+  }
+  uint64_t cur = current;
+  while (cur < fast_delay_limit &&
+	 (cur == 0 || cur + c <= fast_max)) {
+    if (current.compare_exchange_weak(cur, cur + c)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 ceph::timespan BackoffThrottle::_get_delay(uint64_t c) const
 {
   if (max == 0)
@@ -430,14 +482,21 @@ ceph::timespan BackoffThrottle::_get_delay(uint64_t c) const
 
 ceph::timespan BackoffThrottle::get(uint64_t c)
 {
-  locker l(lock);
-  auto delay = _get_delay(c);
-
   if (logger) {
     logger->inc(l_backoff_throttle_get);
     logger->inc(l_backoff_throttle_get_sum, c);
   }
 
+  if (_get_fast(c)) {
+    if (logger) {
+      logger->set(l_backoff_throttle_val, current);
+    }
+    return ceph::make_timespan(0);
+  }
+
+  locker l(lock);
+  auto delay = _get_delay(c);
+
   // fast path
   if (delay.count() == 0 &&
       waiters.empty() &&
@@ -481,7 +540,7 @@ ceph::timespan BackoffThrottle::get(uint64_t c)
       delay -= elapsed;
     }
   }
-  waiters.pop_front();
+  _pop_waiter();
   _kick_waiters();
 
   current += c;
@@ -498,37 +557,37 @@ ceph::timespan BackoffThrottle::get(uint64_t c)
 
 uint64_t BackoffThrottle::put(uint64_t c)
 {
-  locker l(lock);
-  ceph_assert(current >= c);
-  current -= c;
-  _kick_waiters();
+  const uint64_t old = current.fetch_sub(c);
+  ceph_assert(old >= c);
+  if (num_waiters > 0) {
+    locker l(lock);
+    _kick_waiters();
+  }
 
   if (logger) {
     logger->inc(l_backoff_throttle_put);
     logger->inc(l_backoff_throttle_put_sum, c);
-    logger->set(l_backoff_throttle_val, current);
+    logger->set(l_backoff_throttle_val, old - c);
   }
 
-  return current;
+  return old - c;
 }
 
 uint64_t BackoffThrottle::take(uint64_t c)
 {
-  locker l(lock);
-  current += c;
+  const uint64_t now = current += c;
 
   if (logger) {
     logger->inc(l_backoff_throttle_take);
     logger->inc(l_backoff_throttle_take_sum, c);
-    logger->set(l_backoff_throttle_val, current);
+    logger->set(l_backoff_throttle_val, now);
   }
 
-  return current;
+  return now;
 }
 
 uint64_t BackoffThrottle::get_current()
 {
-  locker l(lock);
   return current;
 }
 
@@ -28,6 +28,9 @@
  * This class defines the maximum number of slots currently taken away. The
  * excessive requests for more of them are delayed, until some slots are put
  * back, so @p get_current() drops below the limit after fulfills the requests.
+ *
+ * While nobody waits and the request fits, get() and put() only update the
+ * count atomically; the lock is taken to wait and to wake the waiters.
  */
 class Throttle final : public ThrottleInterface {
   CephContext *cct;
@@ -36,6 +39,8 @@ class Throttle final : public ThrottleInterface {
   std::atomic<int64_t> count = { 0 }, max = { 0 };
   std::mutex lock;
   std::list<std::condition_variable> conds;
+  /// conds.size(), readable without the lock
+  std::atomic<unsigned> num_waiters = { 0 };
   const bool use_perf;
 
 public:
@@ -44,14 +49,18 @@ public:
 
 private:
   void _reset_max(int64_t m);
-  bool _should_wait(int64_t c) const {
+  bool _should_wait(int64_t c, int64_t cur) const {
     int64_t m = max;
-    int64_t cur = count;
     return
       m &&
       ((c <= m && cur + c > m) || // normally stay under max
        (c >= m && cur > m));     // except for large c
   }
+  bool _should_wait(int64_t c) const {
+    return _should_wait(c, count);
+  }
+  /// take c slots without the lock if nobody waits and c fits
+  bool _get_fast(int64_t c);
 
   bool _wait(int64_t c, std::unique_lock<std::mutex>& l);
 
@@ -174,8 +183,13 @@ class BackoffThrottle {
     unsigned next = next_cond++;
     if (next_cond == conds.size())
       next_cond = 0;
+    ++num_waiters;
     return waiters.insert(waiters.end(), &(conds[next]));
   }
+  void _pop_waiter() {
+    waiters.pop_front();
+    --num_waiters;
+  }
 
   void _kick_waiters() {
     if (!waiters.empty())
@@ -196,9 +210,17 @@ class BackoffThrottle {
 
   /// max
   uint64_t max = 0;
-  uint64_t current = 0;
+  std::atomic<uint64_t> current = 0;
+
+  /// waiters.size(), readable without the lock
+  std::atomic<unsigned> num_waiters = 0;
+  /// get() does not wait nor delay below these, see _update_fast_limits()
+  std::atomic<uint64_t> fast_delay_limit = UINT64_MAX;
+  std::atomic<uint64_t> fast_max = UINT64_MAX;
 
   ceph::timespan _get_delay(uint64_t c) const;
+  void _update_fast_limits();
+  bool _get_fast(uint64_t c);
 
 public:
   /**
@@ -40,6 +40,7 @@ CommonSafeTimer<Mutex>::CommonSafeTimer(CephContext *cct_, Mutex &l, bool safe_c
   : cct(cct_), lock(l),
     safe_callbacks(safe_callbacks),
     thread(NULL),
+    epoch(clock_t::now()),
     stopping(false)
 {
 }
@@ -83,29 +84,20 @@ void CommonSafeTimer<Mutex>::timer_thread()
   while (!stopping) {
     auto now = clock_t::now();
 
-    while (!schedule.empty()) {
-      auto p = schedule.begin();
-
-      // is the future now?
-      #if defined(_WIN32)
-      if (p->first - now > std::chrono::milliseconds(1)) {
-        // std::condition_variable::wait_for uses SleepConditionVariableSRW
-        // on Windows, which has millisecond precision. Deltas <1ms will
-        // lead to busy loops, which should be avoided. This situation is
-        // quite common since "wait_for" often returns ~1ms earlier than
-        // requested.
-        break;
-      }
-      #else // !_WIN32
-      if (p->first > now) {
-        break;
-      }
-      #endif
-
-      ldout(cct, 20) << "timer_thread going to execute and remove the top of a schedule sized " << schedule.size() << dendl;
-      Context *callback = p->second;
+    #if defined(_WIN32)
+    // std::condition_variable::wait_for uses SleepConditionVariableSRW
+    // on Windows, which has millisecond precision. Deltas <1ms will
+    // lead to busy loops, which should be avoided. This situation is
+    // quite common since "wait_for" often returns ~1ms earlier than
+    // requested.
+    now += std::chrono::milliseconds(1);
+    #endif
+    schedule.advance(ticks_until(now));
+
+    while (event_t *e = schedule.pop_expired()) {
+      ldout(cct, 20) << "timer_thread going to execute and remove the top of a schedule sized " << events.size() << dendl;
+      Context *callback = e->callback;
       events.erase(callback);
-      schedule.erase(p);
       ldout(cct,10) << "timer_thread executing " << callback << dendl;
       
       if (!safe_callbacks) {
@@ -121,14 +113,16 @@ void CommonSafeTimer<Mutex>::timer_thread()
     if (!safe_callbacks && stopping)
       break;
 
-    if (schedule.empty()) {
+    if (events.empty()) {
       ldout(cct, 20) << "timer_thread going to sleep with an empty schedule" << dendl;
+      wakeup = clock_t::time_point::max();
       cond.wait(l);
     } else {
-      ldout(cct, 20) << "timer_thread going to sleep with a schedule size " << schedule.size() << dendl;
-      auto when = schedule.begin()->first;
-      cond.wait_until(l, when);
+      ldout(cct, 20) << "timer_thread going to sleep with a schedule size " << events.size() << dendl;
+      wakeup = time_of(schedule.next_tick());
+      cond.wait_until(l, wakeup);
     }
+    wakeup = clock_t::time_point::min();
     ldout(cct,20) << "timer_thread awake" << dendl;
   }
   ldout(cct,10) << "timer_thread exiting" << dendl;
@@ -159,18 +153,19 @@ Context* CommonSafeTimer<Mutex>::add_event_at(CommonSafeTimer<Mutex>::clock_t::t
     delete callback;
     return nullptr;
   }
-  scheduled_map_t::value_type s_val(when, callback);
-  scheduled_map_t::iterator i = schedule.insert(s_val);
-
-  event_lookup_map_t::value_type e_val(callback, i);
-  pair < event_lookup_map_t::iterator, bool > rval(events.insert(e_val));
+  auto [i, inserted] = events.try_emplace(callback);
 
   /* If you hit this, you tried to insert the same Context* twice. */
-  ceph_assert(rval.second);
+  ceph_assert(inserted);
+
+  i->second.callback = callback;
+  i->second.when = when;
+  const uint64_t t = tick_of(when);
+  schedule.add(i->second, t);
 
-  /* If the event we have just inserted comes before everything else, we need to
-   * adjust our timeout. */
-  if (i == schedule.begin())
+  /* If the event we have just inserted comes before the timer thread
+   * would wake up, we need to adjust its timeout. */
+  if (time_of(t) < wakeup)
     cond.notify_all();
   return callback;
 }
@@ -199,10 +194,10 @@ bool CommonSafeTimer<Mutex>::cancel_event(Context *callback)
     return false;
   }
 
-  ldout(cct,10) << "cancel_event " << p->second->first << " -> " << callback << dendl;
+  ldout(cct,10) << "cancel_event " << p->second.when << " -> " << callback << dendl;
   delete p->first;
 
-  schedule.erase(p->second);
+  // takes the event off the schedule as well
   events.erase(p);
   return true;
 }
@@ -215,9 +210,8 @@ void CommonSafeTimer<Mutex>::cancel_all_events()
 
   while (!events.empty()) {
     auto p = events.begin();
-    ldout(cct,10) << " cancelled " << p->second->first << " -> " << p->first << dendl;
+    ldout(cct,10) << " cancelled " << p->second.when << " -> " << p->first << dendl;
     delete p->first;
-    schedule.erase(p->second);
     events.erase(p);
   }
 }
@@ -229,10 +223,8 @@ void CommonSafeTimer<Mutex>::dump(const char *caller) const
     caller = "";
   ldout(cct,10) << "dump " << caller << dendl;
 
-  for (scheduled_map_t::const_iterator s = schedule.begin();
-       s != schedule.end();
-       ++s)
-    ldout(cct,10) << " " << s->first << "->" << s->second << dendl;
+  for (auto& [callback, e] : events)
+    ldout(cct,10) << " " << e.when << "->" << callback << dendl;
 }
 
 template class CommonSafeTimer<ceph::mutex>;
@@ -15,11 +15,12 @@
 #ifndef CEPH_TIMER_H
 #define CEPH_TIMER_H
 
-#include <map>
+#include <unordered_map>
 #include "include/common_fwd.h"
 #include "ceph_time.h"
 #include "ceph_mutex.h"
 #include "fair_mutex.h"
+#include "timer_wheel.h"
 #include <condition_variable>
 
 class Context;
@@ -41,12 +42,32 @@ class CommonSafeTimer
   void _shutdown();
 
   using clock_t = ceph::mono_clock;
-  using scheduled_map_t = std::multimap<clock_t::time_point, Context*>;
-  scheduled_map_t schedule;
-  using event_lookup_map_t = std::map<Context*, scheduled_map_t::iterator>;
+  struct event_t : ceph::timer_wheel_hook {
+    Context *callback = nullptr;
+    clock_t::time_point when;
+  };
+  /// events expire on the first tick at or after their time
+  static constexpr auto tick = std::chrono::milliseconds(1);
+  const clock_t::time_point epoch;  ///< tick 0 of the schedule
+  ceph::timer_wheel<event_t> schedule;
+  using event_lookup_map_t = std::unordered_map<Context*, event_t>;
   event_lookup_map_t events;
+  /// when the timer thread is due to wake up, min() while it is running
+  clock_t::time_point wakeup = clock_t::time_point::min();
   bool stopping;
 
+  uint64_t tick_of(clock_t::time_point t) const {
+    return t <= epoch ? 0 :
+      std::chrono::ceil<std::chrono::milliseconds>(t - epoch).count();
+  }
+  uint64_t ticks_until(clock_t::time_point t) const {
+    return t <= epoch ? 0 :
+      std::chrono::floor<std::chrono::milliseconds>(t - epoch).count();
+  }
+  clock_t::time_point time_of(uint64_t t) const {
+    return epoch + t * tick;
+  }
+
   void dump(const char *caller = 0) const;
 
 public:
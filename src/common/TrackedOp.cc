@@ -32,6 +32,49 @@ static ostream& _prefix(std::ostream* _dout)
   return *_dout << "-- op tracker -- ";
 }
 
+namespace {
+struct op_stage_desc_t {
+  std::string_view event;  ///< event name, or its prefix
+  const char *counter;
+  const char *description;
+};
+
+const op_stage_desc_t op_stages[OP_STAGE_MAX] = {
+  {"header_read", "header_read_latency",
+   "Time from op initiation to the message header being read"},
+  {"throttled", "throttled_latency",
+   "Time from op initiation to the message passing the throttles"},
+  {"all_read", "all_read_latency",
+   "Time from op initiation to the whole message being read"},
+  {"dispatched", "dispatched_latency",
+   "Time from op initiation to the message being dispatched"},
+  {"queued_for_pg", "queued_for_pg_latency",
+   "Time from op initiation to the op being queued for its PG"},
+  {"reached_pg", "reached_pg_latency",
+   "Time from op initiation to the op being dequeued by its PG"},
+  {"started", "started_latency",
+   "Time from op initiation to the op being started"},
+  {"waiting for subops", "sub_op_sent_latency",
+   "Time from op initiation to the sub ops being sent"},
+  {"commit_sent", "commit_sent_latency",
+   "Time from op initiation to the commit being sent"},
+  {"done", "done_latency",
+   "Time from op initiation to the op being done"},
+};
+}
+
+void TrackedOp::_mark_stage(std::string_view event, utime_t stamp)
+{
+  for (unsigned i = 0; i < OP_STAGE_MAX; ++i) {
+    if (event.starts_with(op_stages[i].event)) {
+      // keep the first occurrence of each stage
+      uint64_t expected = 0;
+      (*stage_stamps)[i].compare_exchange_strong(expected, stamp.to_nsec());
+      return;
+    }
+  }
+}
+
 void OpHistoryServiceThread::break_thread() {
   queue_spinlock.lock();
   _external_queue.clear();
@@ -172,6 +215,9 @@ OpTracker::OpTracker(CephContext *cct_, bool tracking, uint32_t num_shards):
 }
 
 OpTracker::~OpTracker() {
+  if (stage_logger) {
+    cct->get_perfcounters_collection()->remove(stage_logger.get());
+  }
   while (!sharded_in_flight_list.empty()) {
     ShardedTrackingData* sdata = sharded_in_flight_list.back();
     ceph_assert(NULL != sdata);
@@ -311,6 +357,61 @@ void OpTracker::unregister_inflight_op(TrackedOp* const i)
   }
 }
 
+void OpTracker::set_sample_rate(uint32_t every_n)
+{
+  if (every_n) {
+    // only daemons that sample get the "optracker" counters
+    std::unique_lock l{lock};
+    if (!stage_logger) {
+      PerfCountersBuilder b(cct, "optracker",
+                            l_optracker_first, l_optracker_last);
+      b.add_u64_counter(l_optracker_sampled_ops, "sampled_ops",
+                        "Number of completed ops whose stages were timed");
+      for (unsigned i = 0; i < OP_STAGE_MAX; ++i) {
+        b.add_time_avg(l_optracker_stage_lat_first + i, op_stages[i].counter,
+                       op_stages[i].description);
+      }
+      PerfHistogramCommon::axis_config_d lat_axis{
+        "Latency (nsec)",
+        PerfHistogramCommon::SCALE_LOG2,
+        0,
+        10000,  ///< 10usec
+        32,
+      };
+      PerfHistogramCommon::axis_config_d stage_axis{
+        "Stage",
+        PerfHistogramCommon::SCALE_LINEAR,
+        0,
+        1,
+        OP_STAGE_MAX + 1,  ///< the first bucket is for values below 0
+      };
+      b.add_u64_counter_histogram(
+        l_optracker_stage_lat_hist, "stage_latency_histogram",
+        lat_axis, stage_axis,
+        "Histogram of the time from op initiation to each stage of sampled ops");
+      stage_logger.reset(b.create_perf_counters());
+      cct->get_perfcounters_collection()->add(stage_logger.get());
+    }
+  }
+  sample_rate = every_n;
+}
+
+void OpTracker::record_sampled_op(const TrackedOp& op)
+{
+  const uint64_t start = op.get_initiated().to_nsec();
+  stage_logger->inc(l_optracker_sampled_ops);
+  for (unsigned i = 0; i < OP_STAGE_MAX; ++i) {
+    uint64_t stamp = (*op.stage_stamps)[i].load(std::memory_order_relaxed);
+    if (!stamp) {
+      continue;
+    }
+    // messenger stamps may predate the initiation of the op
+    uint64_t lat = stamp > start ? stamp - start : 0;
+    stage_logger->tinc(l_optracker_stage_lat_first + i, ceph::timespan(lat));
+    stage_logger->hinc(l_optracker_stage_lat_hist, lat, i);
+  }
+}
+
 void OpTracker::record_history_op(TrackedOpRef&& i)
 {
   std::shared_lock l{lock};
@@ -484,6 +585,8 @@ void OpTracker::get_age_ms_histogram(pow2_hist_t *h)
 
 void TrackedOp::mark_event(std::string_view event, utime_t stamp)
 {
+  if (stage_stamps)
+    _mark_stage(event, stamp);
   if (!state)
     return;
 
@@ -14,6 +14,7 @@
 #ifndef TRACKEDREQUEST_H_
 #define TRACKEDREQUEST_H_
 
+#include <array>
 #include <atomic>
 #include "common/StackStringStream.h"
 #include "common/ceph_mutex.h"
@@ -118,6 +119,30 @@ public:
 };
 
 struct ShardedTrackingData;
+
+/// stages timed for sampled ops, see OpTracker::set_sample_rate()
+enum op_stage_t {
+  OP_STAGE_HEADER_READ = 0,
+  OP_STAGE_THROTTLED,
+  OP_STAGE_ALL_READ,
+  OP_STAGE_DISPATCHED,
+  OP_STAGE_QUEUED_FOR_PG,
+  OP_STAGE_REACHED_PG,
+  OP_STAGE_STARTED,
+  OP_STAGE_SUB_OP_SENT,
+  OP_STAGE_COMMIT_SENT,
+  OP_STAGE_DONE,
+  OP_STAGE_MAX
+};
+
+enum {
+  l_optracker_first = 1100,
+  l_optracker_sampled_ops,
+  l_optracker_stage_lat_first,
+  l_optracker_stage_lat_last = l_optracker_stage_lat_first + OP_STAGE_MAX - 1,
+  l_optracker_stage_lat_hist,
+  l_optracker_last,
+};
 class OpTracker {
   friend class OpHistory;
   std::atomic<int64_t> seq = { 0 };
@@ -127,6 +152,8 @@ class OpTracker {
   float complaint_time;
   int log_threshold;
   std::atomic<bool> tracking_enabled;
+  std::atomic<uint32_t> sample_rate = {0};
+  std::unique_ptr<PerfCounters> stage_logger;
   ceph::shared_mutex lock = ceph::make_shared_mutex("OpTracker::lock");
 
 public:
@@ -151,6 +178,25 @@ public:
   void set_tracking(bool enable) {
     tracking_enabled = enable;
   }
+  /**
+   * time the stages of one op out of every_n (0 disables sampling)
+   *
+   * Sampled ops only keep a timestamp per stage, no event strings, and
+   * are accounted in the "optracker" perf counters when they complete.
+   * The counters are registered the first time sampling is enabled.
+   * This works whether or not tracking is enabled.
+   */
+  void set_sample_rate(uint32_t every_n);
+  bool should_sample() {
+    auto n = sample_rate.load(std::memory_order_relaxed);
+    if (!n) {
+      return false;
+    }
+    // per thread, so that the hot path does not share a counter
+    static thread_local uint32_t count = 0;
+    return ++count % n == 0;
+  }
+  void record_sampled_op(const TrackedOp& op);
   static void default_dumper(const TrackedOp& op, Formatter* f);
   bool dump_ops_in_flight(ceph::Formatter *f, bool print_only_blocked = false, std::set<std::string> filters = {""}, bool count_only = false, dumper lambda = default_dumper);
   bool dump_historic_ops(ceph::Formatter *f, bool by_duration = false, std::set<std::string> filters = {""});
@@ -214,7 +260,10 @@ public:
     };
     typename R::Ref retval(new R(params, this));
     retval->tracking_start();
-    if (is_tracking()) {
+    if (should_sample()) {
+      retval->start_sampling();
+    }
+    if (is_tracking() || retval->is_sampled()) {
       retval->mark_event("header_read", params->get_recv_stamp());
       retval->mark_event("throttled", params->get_throttle_stamp());
       retval->mark_event("all_read", params->get_recv_complete_stamp());
@@ -259,6 +308,12 @@ protected:
   OpTracker *tracker;          ///< the tracker we are associated with
   std::atomic_int nref = {0};  ///< ref count
 
+  /// nsec timestamps of the first event of each stage, for sampled ops
+  using stage_stamps_t = std::array<std::atomic<uint64_t>, OP_STAGE_MAX>;
+  std::unique_ptr<stage_stamps_t> stage_stamps;
+
+  void _mark_stage(std::string_view event, utime_t stamp);
+
   utime_t initiated_at;
 
   struct Event {
@@ -335,6 +390,11 @@ public:
   again:
     auto nref_snap = nref.load();
     if (nref_snap == 1) {
+      if (stage_stamps) {
+	_mark_stage("done", ceph_clock_now());
+	tracker->record_sampled_op(*this);
+	stage_stamps.reset();
+      }
       switch (state.load()) {
       case STATE_UNTRACKED:
 	_unregistered();
@@ -426,6 +486,13 @@ public:
 
   void dump(utime_t now, ceph::Formatter *f, OpTracker::dumper lambda) const;
 
+  bool is_sampled() const {
+    return (bool)stage_stamps;
+  }
+  void start_sampling() {
+    stage_stamps.reset(new stage_stamps_t{});
+  }
+
   void tracking_start() {
     if (tracker->register_inflight_op(this)) {
       events.emplace_back(initiated_at, "initiated");
@@ -186,6 +186,10 @@ public:
   Reference operator[](uint64_t offset);
   ConstReference operator[](uint64_t offset) const;
 
+  // bulk access: one element per byte, a byte of packed data at a time
+  void get_elements(uint64_t offset, uint64_t length, uint8_t *elements) const;
+  void set_elements(uint64_t offset, uint64_t length, const uint8_t *elements);
+
   void encode_header(bufferlist& bl) const;
   void decode_header(bufferlist::const_iterator& it);
   uint64_t get_header_length() const;
@@ -605,6 +609,92 @@ typename BitVector<_b>::ConstReference BitVector<_b>::operator[](uint64_t offset
   return ConstReference(std::move(data_iterator), shift);
 }
 
+template <uint8_t _b>
+void BitVector<_b>::get_elements(uint64_t offset, uint64_t length,
+                                 uint8_t *elements) const {
+  ceph_assert(offset + length <= m_size);
+  if (length == 0) {
+    return;
+  }
+
+  uint64_t index;
+  uint64_t shift;
+  compute_index(offset, &index, &shift);
+
+  uint64_t skip = offset % ELEMENTS_PER_BLOCK;
+  uint64_t byte_length = (skip + length + ELEMENTS_PER_BLOCK - 1) /
+                         ELEMENTS_PER_BLOCK;
+  auto it = m_data.begin(index);
+  while (byte_length > 0) {
+    const char *p;
+    size_t n = it.get_ptr_and_advance(byte_length, &p);
+    byte_length -= n;
+    for (size_t i = 0; i < n; ++i) {
+      uint8_t packed_value = p[i];
+      if (skip == 0 && length >= ELEMENTS_PER_BLOCK) {
+        for (uint32_t j = 0; j < ELEMENTS_PER_BLOCK; ++j) {
+          elements[j] = (packed_value >> ((ELEMENTS_PER_BLOCK - 1 - j) * _b)) &
+                        MASK;
+        }
+        elements += ELEMENTS_PER_BLOCK;
+        length -= ELEMENTS_PER_BLOCK;
+        continue;
+      }
+      for (uint32_t j = skip; j < ELEMENTS_PER_BLOCK && length > 0; ++j) {
+        *elements++ = (packed_value >> ((ELEMENTS_PER_BLOCK - 1 - j) * _b)) &
+                      MASK;
+        --length;
+      }
+      skip = 0;
+    }
+  }
+  ceph_assert(length == 0);
+}
+
+template <uint8_t _b>
+void BitVector<_b>::set_elements(uint64_t offset, uint64_t length,
+                                 const uint8_t *elements) {
+  ceph_assert(offset + length <= m_size);
+  if (length == 0) {
+    return;
+  }
+
+  uint64_t index;
+  uint64_t shift;
+  compute_index(offset, &index, &shift);
+
+  uint64_t skip = offset % ELEMENTS_PER_BLOCK;
+  uint64_t byte_length = (skip + length + ELEMENTS_PER_BLOCK - 1) /
+                         ELEMENTS_PER_BLOCK;
+  std::vector<char> packed(byte_length);
+  // preserve the neighbouring elements sharing the first and last byte
+  packed.front() = m_data[index];
+  packed.back() = m_data[index + byte_length - 1];
+
+  for (auto& packed_value : packed) {
+    if (skip == 0 && length >= ELEMENTS_PER_BLOCK) {
+      uint8_t v = 0;
+      for (uint32_t j = 0; j < ELEMENTS_PER_BLOCK; ++j) {
+        v |= (elements[j] & MASK) << ((ELEMENTS_PER_BLOCK - 1 - j) * _b);
+      }
+      packed_value = v;
+      elements += ELEMENTS_PER_BLOCK;
+      length -= ELEMENTS_PER_BLOCK;
+      continue;
+    }
+    for (uint32_t j = skip; j < ELEMENTS_PER_BLOCK && length > 0; ++j) {
+      uint8_t element_shift = (ELEMENTS_PER_BLOCK - 1 - j) * _b;
+      packed_value = (packed_value & ~(MASK << element_shift)) |
+                     ((*elements++ & MASK) << element_shift);
+      --length;
+    }
+    skip = 0;
+  }
+
+  bufferlist::iterator it(m_data.begin(index));
+  it.copy_in(byte_length, packed.data(), true);
+}
+
 template <uint8_t _b>
 typename BitVector<_b>::Reference& BitVector<_b>::Reference::operator=(uint8_t v) {
   uint8_t mask = MASK << this->m_shift;
@@ -2200,6 +2200,80 @@ bool buffer::ptr_node::dispose_if_hypercombined(
   }
 }
 
+namespace {
+// free list of ptr_node storage, threaded through the first word of each
+// cached node.  It is bounded so that a thread releasing a huge list does
+// not pin that memory forever.
+struct ptr_node_cache_t {
+  static constexpr unsigned max_cached = 256;
+  void* head = nullptr;
+  unsigned count = 0;
+
+  ptr_node_cache_t();
+  ~ptr_node_cache_t();
+};
+
+// trivially destructible so that it stays usable while (and after) the
+// thread_local cache is destroyed: lists released by later destructors
+// on this thread then go straight back to the heap.
+enum class ptr_node_cache_state_t : uint8_t { unused, alive, dead };
+thread_local ptr_node_cache_state_t ptr_node_cache_state =
+  ptr_node_cache_state_t::unused;
+
+ptr_node_cache_t::ptr_node_cache_t()
+{
+  ptr_node_cache_state = ptr_node_cache_state_t::alive;
+}
+
+ptr_node_cache_t::~ptr_node_cache_t()
+{
+  ptr_node_cache_state = ptr_node_cache_state_t::dead;
+  while (head) {
+    void* next = *static_cast<void**>(head);
+    ::operator delete(head);
+    head = next;
+  }
+}
+
+ptr_node_cache_t* get_ptr_node_cache()
+{
+#if defined(__SANITIZE_ADDRESS__) || defined(CEPH_BUFFER_NO_NODE_CACHE)
+  // let the sanitizer see every use-after-free of a node
+  return nullptr;
+#else
+  if (ptr_node_cache_state == ptr_node_cache_state_t::dead) {
+    return nullptr;
+  }
+  static thread_local ptr_node_cache_t cache;
+  return &cache;
+#endif
+}
+} // anonymous namespace
+
+void* buffer::ptr_node::operator new(std::size_t size)
+{
+  ceph_assert(size == sizeof(ptr_node));
+  if (auto cache = get_ptr_node_cache(); cache && cache->head) {
+    void* p = cache->head;
+    cache->head = *static_cast<void**>(p);
+    --cache->count;
+    return p;
+  }
+  return ::operator new(size);
+}
+
+void buffer::ptr_node::operator delete(void* p, std::size_t size) noexcept
+{
+  if (auto cache = get_ptr_node_cache();
+      cache && cache->count < ptr_node_cache_t::max_cached) {
+    *static_cast<void**>(p) = cache->head;
+    cache->head = p;
+    ++cache->count;
+    return;
+  }
+  ::operator delete(p);
+}
+
 std::unique_ptr<buffer::ptr_node, buffer::ptr_node::disposer>
 buffer::ptr_node::create_hypercombined(ceph::unique_leakable_ptr<buffer::raw> r)
 {
@@ -157,6 +157,12 @@ public:
       this,
       "get mempool stats");
     ceph_assert(r == 0);
+    r = cct->get_admin_socket()->register_command(
+      "dump_mempool_samples name=pprof,type=CephBool,req=false",
+      this,
+      "get stats of sampled mempool allocations (see mempool_sample_rate), "
+      "or with --pprof a heap profile of the live ones");
+    ceph_assert(r == 0);
   }
   ~MempoolObs() override {
     cct->_conf.remove_observer(this);
@@ -167,6 +173,7 @@ public:
   const char** get_tracked_conf_keys() const override {
     static const char *KEYS[] = {
       "mempool_debug",
+      "mempool_sample_rate",
       NULL
     };
     return KEYS;
@@ -178,6 +185,10 @@ public:
     if (changed.count("mempool_debug")) {
       mempool::set_debug_mode(cct->_conf->mempool_debug);
     }
+    if (changed.count("mempool_sample_rate")) {
+      mempool::set_sample_rate(
+	conf.get_val<Option::size_t>("mempool_sample_rate"));
+    }
   }
 
   // AdminSocketHook
@@ -192,6 +203,16 @@ public:
       f->close_section();
       return 0;
     }
+    if (command == "dump_mempool_samples") {
+      if (ceph::common::cmd_getval_or<bool>(cmdmap, "pprof", false)) {
+	std::ostringstream ss;
+	mempool::dump_samples_pprof(ss);
+	out.append(ss.str());
+      } else {
+	mempool::dump_samples(f);
+      }
+      return 0;
+    }
     return -ENOSYS;
   }
 };
@@ -283,6 +304,7 @@ public:
       "log_file",
       "log_max_new",
       "log_max_recent",
+      "log_max_recent_per_thread",
       "log_to_file",
       "log_to_syslog",
       "err_to_syslog",
@@ -342,6 +364,11 @@ public:
       log->set_max_recent(conf->log_max_recent);
     }
 
+    if (changed.count("log_max_recent_per_thread")) {
+      log->set_max_recent_per_thread(
+	conf.get_val<uint64_t>("log_max_recent_per_thread"));
+    }
+
     // graylog
     if (changed.count("log_to_graylog") || changed.count("err_to_graylog")) {
       int l = conf->log_to_graylog ? 99 : (conf->err_to_graylog ? -1 : -2);
@@ -550,6 +577,13 @@ int CephContext::_do_command(
   else if (command == "counter schema") {
     _perf_counters_collection->dump_formatted(f, true, true);
   }
+  else if (command == "counter stream") {
+    std::string subscriber;
+    int64_t seq = 0;
+    cmd_getval(cmdmap, "subscriber", subscriber);
+    cmd_getval(cmdmap, "seq", seq);
+    _perf_counters_collection->encode_stream(subscriber, seq, *out);
+  }
   else if (command == "perf histogram dump") {
     std::string logger;
     std::string counter;
@@ -758,6 +792,7 @@ CephContext::CephContext(uint32_t module_type_,
   _admin_socket->register_command("perf schema", _admin_hook, "dump non-labeled counters schemas");
   _admin_socket->register_command("counter dump", _admin_hook, "dump all labeled and non-labeled counters and their values");
   _admin_socket->register_command("counter schema", _admin_hook, "dump all labeled and non-labeled counters schemas");
+  _admin_socket->register_command("counter stream name=subscriber,type=CephString name=seq,type=CephInt,req=false", _admin_hook, "binary schema and values of all counters, then only the changed values for the subscriber that passes the seq of the last reply");
   _admin_socket->register_command("perf histogram schema", _admin_hook, "dump perf histogram schema");
   _admin_socket->register_command("perf reset name=var,type=CephString", _admin_hook, "perf reset <name>: perf reset all or one perfcounter name");
   _admin_socket->register_command("config show", _admin_hook, "dump current config settings");
@@ -200,6 +200,8 @@ public:
   int get_val(const ConfigValues& values, const std::string_view key, char **buf, int len) const;
   int get_val(const ConfigValues& values, const std::string_view key, std::string *val) const;
   template<typename T> const T get_val(const ConfigValues& values, const std::string_view key) const;
+  Option::value_t get_val_generic(const ConfigValues& values,
+				  const std::string_view key) const;
   template<typename T, typename Callback, typename...Args>
   auto with_val(const ConfigValues& values, const std::string_view key,
 		Callback&& cb, Args&&... args) const ->
@@ -248,8 +250,6 @@ private:
   void validate_schema();
   void validate_default_settings();
 
-  Option::value_t get_val_generic(const ConfigValues& values,
-				  const std::string_view key) const;
   int _get_val_cstr(const ConfigValues& values,
 		    const std::string& key, char **buf, int len) const;
   Option::value_t _get_val(const ConfigValues& values,
@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <type_traits>
 #include "common/config.h"
 #include "common/config_obs.h"
@@ -12,6 +14,8 @@
 // the legacy settings with arrow operator, and the new-style config with its
 // member methods.
 namespace ceph::common {
+class ConfigSnapshot;
+
 class ConfigProxy {
   /**
    * The current values of all settings described by the schema
@@ -27,9 +31,19 @@ class ConfigProxy {
    * hold this lock when calling configuration observers.  */
   mutable ceph::mutex lock = ceph::make_mutex("ConfigProxy::lock");
   ceph::condition_variable cond;
+  /// built by the first snapshot() after values change, protected by lock
+  mutable std::shared_ptr<const ConfigSnapshot> snap;
+  /// changes whenever snap is dropped
+  std::atomic<uint64_t> snap_version{++last_snap_version};
+  static inline std::atomic<uint64_t> last_snap_version{0};
 
   using rev_obs_map_t = ObsMgr::rev_obs_map;
 
+  void _invalidate_snapshot() {
+    snap.reset();
+    snap_version.store(++last_snap_version, std::memory_order_release);
+  }
+
   void _call_observers(rev_obs_map_t& rev_obs) {
     ceph_assert(!ceph::mutex_debugging || !ceph_mutex_is_locked_by_me(lock));
     for (auto& [obs, keys] : rev_obs) {
@@ -88,6 +102,7 @@ public:
     std::lock_guard l{lock};
 #endif
     values = val;
+    _invalidate_snapshot();
   }
   int get_val(const std::string_view key, char** buf, int len) const {
     std::lock_guard l{lock};
@@ -97,6 +112,10 @@ public:
     std::lock_guard l{lock};
     return config.get_val(values, key, val);
   }
+  /// the current values of all options known at build time, read without
+  /// locking; see common/config_snapshot.h.  The reference is good until
+  /// the calling thread calls snapshot() again.
+  const ConfigSnapshot& snapshot() const;
   template<typename T>
   const T get_val(const std::string_view key) const {
     std::lock_guard l{lock};
@@ -166,6 +185,7 @@ public:
       if (config.finalize_reexpand_meta(values, obs_mgr)) {
         _gather_changes(values.changed, &rev_obs, nullptr);
       }
+      _invalidate_snapshot();
     }
 
     _call_observers(rev_obs);
@@ -216,6 +236,7 @@ public:
   }
   int rm_val(const std::string_view key) {
     std::lock_guard l{lock};
+    _invalidate_snapshot();
     return config.rm_val(values, key);
   }
   // Expand all metavariables. Make any pending observer callbacks.
@@ -229,6 +250,7 @@ public:
         // meta expands could have modified anything.  Copy it all out again.
         _gather_changes(values.changed, &rev_obs, oss);
       }
+      _invalidate_snapshot();
     }
 
     _call_observers(rev_obs);
@@ -236,14 +258,17 @@ public:
   int set_val(const std::string_view key, const std::string& s,
               std::stringstream* err_ss=nullptr) {
     std::lock_guard l{lock};
+    _invalidate_snapshot();
     return config.set_val(values, obs_mgr, key, s, err_ss);
   }
   void set_val_default(const std::string_view key, const std::string& val) {
     std::lock_guard l{lock};
+    _invalidate_snapshot();
     config.set_val_default(values, obs_mgr, key, val);
   }
   void set_val_or_die(const std::string_view key, const std::string& val) {
     std::lock_guard l{lock};
+    _invalidate_snapshot();
     config.set_val_or_die(values, obs_mgr, key, val);
   }
   int set_mon_vals(CephContext *cct,
@@ -256,6 +281,7 @@ public:
       std::lock_guard locker(lock);
       ret = config.set_mon_vals(cct, values, obs_mgr, kv, config_cb);
       _gather_changes(values.changed, &rev_obs, nullptr);
+      _invalidate_snapshot();
     }
 
     _call_observers(rev_obs);
@@ -268,6 +294,7 @@ public:
       std::lock_guard locker(lock);
       ret = config.injectargs(values, obs_mgr, s, oss);
       _gather_changes(values.changed, &rev_obs, oss);
+      _invalidate_snapshot();
     }
     _call_observers(rev_obs);
     return ret;
@@ -275,15 +302,18 @@ public:
   void parse_env(unsigned entity_type,
 		 const char *env_var = "CEPH_ARGS") {
     std::lock_guard l{lock};
+    _invalidate_snapshot();
     config.parse_env(entity_type, values, obs_mgr, env_var);
   }
   int parse_argv(std::vector<const char*>& args, int level=CONF_CMDLINE) {
     std::lock_guard l{lock};
+    _invalidate_snapshot();
     return config.parse_argv(values, obs_mgr, args, level);
   }
   int parse_config_files(const char *conf_files,
 			 std::ostream *warnings, int flags) {
     std::lock_guard l{lock};
+    _invalidate_snapshot();
     return config.parse_config_files(values, obs_mgr,
 				     conf_files, warnings, flags);
   }
@@ -0,0 +1,23 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "common/config_snapshot.h"
+
+namespace ceph::common {
+
+const char* const ConfigSnapshot::names[option_id::max] = {
+#define OPTION(name, type) #name,
+#include "common/options/option_ids.h"
+#undef OPTION
+};
+
+ConfigSnapshot::ConfigSnapshot(const md_config_t& config,
+			       const ConfigValues& conf_values)
+{
+  values.reserve(option_id::max);
+  for (auto name : names) {
+    values.push_back(config.get_val_generic(conf_values, name));
+  }
+}
+
+} // namespace ceph::common
@@ -0,0 +1,92 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "common/config_proxy.h"
+#include "common/options.h"
+
+namespace ceph::common {
+
+/// compile time ids of the options described by common/options/*.yaml.in
+namespace option_id {
+enum id_t : unsigned {
+#define OPTION(name, type) name,
+#include "common/options/option_ids.h"
+#undef OPTION
+  max
+};
+}
+
+template<Option::type_t> struct option_value;
+template<> struct option_value<Option::TYPE_UINT> { using type = uint64_t; };
+template<> struct option_value<Option::TYPE_INT> { using type = int64_t; };
+template<> struct option_value<Option::TYPE_STR> { using type = std::string; };
+template<> struct option_value<Option::TYPE_FLOAT> { using type = double; };
+template<> struct option_value<Option::TYPE_BOOL> { using type = bool; };
+template<> struct option_value<Option::TYPE_ADDR> { using type = entity_addr_t; };
+template<> struct option_value<Option::TYPE_ADDRVEC> { using type = entity_addrvec_t; };
+template<> struct option_value<Option::TYPE_UUID> { using type = uuid_d; };
+template<> struct option_value<Option::TYPE_SIZE> { using type = Option::size_t; };
+template<> struct option_value<Option::TYPE_SECS> { using type = std::chrono::seconds; };
+template<> struct option_value<Option::TYPE_MILLISECS> { using type = std::chrono::milliseconds; };
+
+/**
+ * An immutable copy of the value of every option, indexed by option_id.
+ *
+ * Get one with ConfigProxy::snapshot():
+ *
+ *   using namespace ceph::common;
+ *   auto& conf = cct->_conf.snapshot();
+ *   if (conf.get<option_id::osd_repop_batch>()) ...
+ *
+ * Reading a value neither locks nor looks up the key, and the type of the
+ * value is checked at compile time.  Options that are not known at build
+ * time, like the debug_* levels and mgr module options, are not there.
+ */
+class ConfigSnapshot {
+  std::vector<Option::value_t> values;
+
+public:
+  static constexpr Option::type_t types[] = {
+#define OPTION(name, type) Option::type,
+#include "common/options/option_ids.h"
+#undef OPTION
+  };
+  static const char* const names[option_id::max];
+
+  template<option_id::id_t Id>
+  using value_type = typename option_value<types[Id]>::type;
+
+  ConfigSnapshot(const md_config_t& config, const ConfigValues& conf_values);
+
+  template<option_id::id_t Id>
+  const value_type<Id>& get() const {
+    return std::get<value_type<Id>>(values[Id]);
+  }
+};
+
+inline const ConfigSnapshot& ConfigProxy::snapshot() const
+{
+  // the snapshot last seen by this thread; versions are unique across
+  // all ConfigProxy instances, so a match means it is still current
+  struct cached_t {
+    uint64_t version = 0;
+    std::shared_ptr<const ConfigSnapshot> snap;
+  };
+  static thread_local cached_t cached;
+  if (cached.version != snap_version.load(std::memory_order_acquire)) {
+    std::lock_guard l{lock};
+    if (!snap) {
+      snap = std::make_shared<const ConfigSnapshot>(config, values);
+    }
+    cached.version = snap_version.load(std::memory_order_relaxed);
+    cached.snap = snap;
+  }
+  return *cached.snap;
+}
+
+} // namespace ceph::common
@@ -241,3 +241,10 @@ uint32_t ceph_crc32c_zeros(uint32_t crc, unsigned len)
     crc = ceph_crc32c(crc, nullptr, remainder);
   return crc;
 }
+
+uint32_t ceph_crc32c_combine(uint32_t crc_a, uint32_t crc_b, unsigned length_b)
+{
+  // crc32c is linear: crc(v, B) == crc(0, B) ^ crc(v, 0*len(B)), and
+  // crc(crc_a, B) is the crc of A followed by B.
+  return ceph_crc32c_zeros(crc_a, length_b) ^ crc_b;
+}
@@ -12,8 +12,15 @@
  *
  */
 
+#include <execinfo.h>
+
+#include <cmath>
+#include <fstream>
+#include <random>
+
 #include "include/mempool.h"
 #include "include/demangle.h"
+#include "common/ceph_time.h"
 
 #if defined(_GNU_SOURCE) && defined(WITH_SEASTAR) && !defined(WITH_ALIEN)
 #else
@@ -162,3 +169,196 @@ void mempool::pool_t::dump(ceph::Formatter *f, stats_t *ptotal) const
     f->close_section();
   }
 }
+
+// --------------------------------------------------------------
+// allocation sampling
+
+std::atomic<size_t> mempool::sample_rate = {0};
+std::atomic<size_t> mempool::live_samples = {0};
+
+namespace {
+
+constexpr int max_sample_depth = 32;
+// we keep at most this many live samples, older ones are never dropped
+// but new ones are ignored
+constexpr size_t max_live_samples = 1 << 16;
+
+struct sample_t {
+  mempool::pool_index_t pool;
+  size_t bytes;
+  ceph::mono_time when;
+  int depth;
+  void *stack[max_sample_depth];
+};
+
+struct pool_sample_stats_t {
+  uint64_t sampled = 0;       ///< samples taken
+  uint64_t sampled_bytes = 0;
+  uint64_t freed = 0;         ///< samples freed since
+  ceph::timespan lifetime = ceph::timespan::zero(); ///< total of the freed
+};
+
+struct sampler_t {
+  std::mutex lock;
+  std::unordered_map<void*, sample_t> live;
+  pool_sample_stats_t stats[mempool::num_pools];
+};
+
+sampler_t& get_sampler()
+{
+  static sampler_t sampler;
+  return sampler;
+}
+
+// bytes left until the next sample of this thread
+thread_local ssize_t sample_bytes_left = -1;
+
+ssize_t next_sample_interval(size_t rate)
+{
+  // exponentially distributed, so that sampling is unbiased by the
+  // allocation pattern and pprof can scale the samples back up
+  static thread_local std::minstd_rand rng{std::random_device{}()};
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  double v = -std::log(1.0 - u(rng)) * rate;
+  return v < 1 ? 1 : (ssize_t)v;
+}
+
+} // anonymous namespace
+
+void mempool::set_sample_rate(size_t bytes)
+{
+  sample_rate = bytes;
+  if (!bytes) {
+    // stop new samples; the live ones are forgotten as they are freed,
+    // but their stats are dropped now
+    auto& sampler = get_sampler();
+    std::lock_guard l(sampler.lock);
+    for (auto& s : sampler.stats) {
+      s = pool_sample_stats_t{};
+    }
+  }
+}
+
+bool mempool::sample_countdown(size_t bytes)
+{
+  if (sample_bytes_left < 0) {
+    sample_bytes_left = next_sample_interval(sample_rate);
+  }
+  sample_bytes_left -= bytes;
+  if (sample_bytes_left >= 0) {
+    return false;
+  }
+  sample_bytes_left = next_sample_interval(sample_rate);
+  return true;
+}
+
+void mempool::record_sample(pool_index_t ix, void *p, size_t bytes)
+{
+  sample_t s;
+  s.pool = ix;
+  s.bytes = bytes;
+  s.when = ceph::mono_clock::now();
+  s.depth = ::backtrace(s.stack, max_sample_depth);
+  auto& sampler = get_sampler();
+  std::lock_guard l(sampler.lock);
+  if (sampler.live.size() >= max_live_samples) {
+    return;
+  }
+  if (sampler.live.insert_or_assign(p, s).second) {
+    ++live_samples;
+  }
+  auto& st = sampler.stats[ix];
+  st.sampled++;
+  st.sampled_bytes += bytes;
+}
+
+void mempool::forget_sample(pool_index_t, void *p)
+{
+  auto& sampler = get_sampler();
+  std::lock_guard l(sampler.lock);
+  auto i = sampler.live.find(p);
+  if (i == sampler.live.end()) {
+    return;
+  }
+  auto& st = sampler.stats[i->second.pool];
+  st.freed++;
+  st.lifetime += ceph::mono_clock::now() - i->second.when;
+  sampler.live.erase(i);
+  --live_samples;
+}
+
+void mempool::dump_samples(ceph::Formatter *f)
+{
+  auto& sampler = get_sampler();
+  std::lock_guard l(sampler.lock);
+  uint64_t live_count[num_pools] = {};
+  uint64_t live_bytes[num_pools] = {};
+  for (auto& [p, s] : sampler.live) {
+    live_count[s.pool]++;
+    live_bytes[s.pool] += s.bytes;
+  }
+  f->open_object_section("mempool_samples");
+  f->dump_unsigned("sample_rate", sample_rate);
+  f->open_object_section("by_pool");
+  for (size_t i = 0; i < num_pools; ++i) {
+    auto& st = sampler.stats[i];
+    if (!st.sampled && !live_count[i]) {
+      continue;
+    }
+    f->open_object_section(get_pool_name((pool_index_t)i));
+    f->dump_unsigned("sampled", st.sampled);
+    f->dump_unsigned("sampled_bytes", st.sampled_bytes);
+    f->dump_unsigned("freed", st.freed);
+    f->dump_float("avg_lifetime",
+		  st.freed ? ceph::to_seconds<double>(st.lifetime) / st.freed : 0);
+    f->dump_unsigned("live", live_count[i]);
+    f->dump_unsigned("live_bytes", live_bytes[i]);
+    f->close_section();
+  }
+  f->close_section();
+  f->close_section();
+}
+
+void mempool::dump_samples_pprof(std::ostream& out)
+{
+  struct site_t {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+  };
+  std::map<std::vector<void*>, site_t> sites;
+  site_t total;
+  {
+    auto& sampler = get_sampler();
+    std::lock_guard l(sampler.lock);
+    for (auto& [p, s] : sampler.live) {
+      // skip the frame of record_sample() itself
+      constexpr int skip = 1;
+      std::vector<void*> stack;
+      if (s.depth > skip) {
+	stack.assign(s.stack + skip, s.stack + s.depth);
+      }
+      auto& site = sites[stack];
+      site.count++;
+      site.bytes += s.bytes;
+      total.count++;
+      total.bytes += s.bytes;
+    }
+  }
+
+  // https://github.com/google/pprof/blob/main/profile/legacy_profile.go
+  out << "heap profile: " << total.count << ": " << total.bytes
+      << " [" << total.count << ": " << total.bytes << "] @ heap_v2/"
+      << sample_rate << "\n";
+  for (auto& [stack, site] : sites) {
+    out << site.count << ": " << site.bytes
+	<< " [" << site.count << ": " << site.bytes << "] @";
+    for (auto pc : stack) {
+      out << " " << pc;
+    }
+    out << "\n";
+  }
+  out << "\nMAPPED_LIBRARIES:\n";
+  if (std::ifstream maps("/proc/self/maps"); maps) {
+    out << maps.rdbuf();
+  }
+}
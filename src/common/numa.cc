@@ -156,7 +156,6 @@ static int easy_readdir(const std::string& dir, std::set<std::string> *out)
   return 0;
 }
 
-#ifdef HAVE_DPDK
 static std::string get_task_comm(pid_t tid)
 {
   static const char* comm_fmt = "/proc/self/task/%d/comm";
@@ -182,7 +181,6 @@ static std::string get_task_comm(pid_t tid)
   }
   return name;
 }
-#endif
 
 int set_cpu_affinity_all_threads(size_t cpu_set_size, cpu_set_t *cpu_set)
 {
@@ -224,6 +222,33 @@ int set_cpu_affinity_all_threads(size_t cpu_set_size, cpu_set_t *cpu_set)
   return 0;
 }
 
+int set_cpu_affinity_named_threads(const std::string& name_prefix,
+				   size_t cpu_set_size, cpu_set_t *cpu_set)
+{
+  std::set<std::string> ls;
+  std::string path = "/proc/"s + stringify(getpid()) + "/task";
+  int r = easy_readdir(path, &ls);
+  if (r < 0) {
+    return r;
+  }
+  int count = 0;
+  for (auto& i : ls) {
+    pid_t tid = atoll(i.c_str());
+    if (!tid) {
+      continue;
+    }
+    if (get_task_comm(tid).compare(0, name_prefix.size(), name_prefix)) {
+      continue;
+    }
+    r = sched_setaffinity(tid, cpu_set_size, cpu_set);
+    if (r < 0) {
+      return -errno;
+    }
+    ++count;
+  }
+  return count;
+}
+
 #else
 int parse_cpu_set_list(const char *s,
 		       size_t *cpu_set_size,
@@ -257,4 +282,10 @@ int set_cpu_affinity_all_threads(size_t cpu_set_size,
   return -ENOTSUP;
 }
 
+int set_cpu_affinity_named_threads(const std::string& name_prefix,
+				   size_t cpu_set_size, cpu_set_t *cpu_set)
+{
+  return -ENOTSUP;
+}
+
 #endif
@@ -7,6 +7,7 @@
 #include <sched.h>
 #include <ostream>
 #include <set>
+#include <string>
 
 int parse_cpu_set_list(const char *s,
 		       size_t *cpu_set_size,
@@ -22,3 +23,9 @@ int get_numa_node_cpu_set(int node,
 
 int set_cpu_affinity_all_threads(size_t cpu_set_size,
 				 cpu_set_t *cpu_set);
+
+/// set the affinity of the threads whose name starts with name_prefix,
+/// returns the number of threads or a negative error code
+int set_cpu_affinity_named_threads(const std::string& name_prefix,
+				   size_t cpu_set_size,
+				   cpu_set_t *cpu_set);
@@ -21,6 +21,10 @@
 #include "common/Clock.h"
 #include "obj_bencher.h"
 
+#include <bit>
+#include <cmath>
+#include <thread>
+
 using std::ostream;
 using std::cerr;
 using std::cout;
@@ -98,6 +102,73 @@ ostream& ObjBencher::out(ostream& os)
   return out(os, cur_time);
 }
 
+void bench_latency_histogram::add(std::chrono::duration<double> lat)
+{
+  const double us = std::max(lat.count(), 0.0) * 1e6;
+  uint64_t v = std::min<double>(us, double((1ull << (max_shift + sub_bits)) - 1));
+  size_t idx = v;
+  if (v >= (1u << sub_bits)) {
+    const unsigned e = std::bit_width(v) - 1 - sub_bits;
+    idx = (size_t(e) << sub_bits) + (v >> e);
+  }
+  ++counts[idx];
+  ++total;
+}
+
+double bench_latency_histogram::percentile(double q) const
+{
+  if (!total) {
+    return 0;
+  }
+  const uint64_t rank = std::max<uint64_t>(std::ceil(q * total), 1);
+  uint64_t seen = 0;
+  size_t idx = 0;
+  for (; idx < counts.size(); ++idx) {
+    seen += counts[idx];
+    if (seen >= rank) {
+      break;
+    }
+  }
+  // report the top of the bucket, so we never understate a tail
+  uint64_t v = idx;
+  if (idx >= (2u << sub_bits)) {
+    const unsigned e = (idx >> sub_bits) - 1;
+    v = ((idx - (size_t(e) << sub_bits)) << e) + (1ull << e) - 1;
+  }
+  return v / 1e6;
+}
+
+void bench_latency_histogram::clear()
+{
+  std::fill(counts.begin(), counts.end(), 0);
+  total = 0;
+}
+
+void ObjBencher::record_latency(std::chrono::duration<double> lat)
+{
+  data.latency_hist.add(lat);
+  data.interval_hist.add(lat);
+}
+
+void ObjBencher::dump_latency_percentiles()
+{
+  static constexpr std::pair<const char*, double> ps[] = {
+    {"50", 0.5}, {"90", 0.9}, {"99", 0.99}, {"99.9", 0.999}, {"99.99", 0.9999}};
+  if (!formatter) {
+    for (auto& [name, q] : ps) {
+      out(cout) << "p" << name << " latency(s):"
+		<< std::string(std::max<int>(1, 11 - strlen(name)), ' ')
+		<< data.latency_hist.percentile(q) << std::endl;
+    }
+  } else {
+    formatter->open_object_section("latency_percentiles");
+    for (auto& [name, q] : ps) {
+      formatter->dump_format(name, "%f", data.latency_hist.percentile(q));
+    }
+    formatter->close_section();
+  }
+}
+
 void *ObjBencher::status_printer(void *_bencher) {
   ObjBencher *bencher = static_cast<ObjBencher *>(_bencher);
   bench_data& data = bencher->data;
@@ -202,6 +273,9 @@ void *ObjBencher::status_printer(void *_bencher) {
         formatter->dump_format("cur_bw", "%f", bandwidth);
         formatter->dump_format("last_lat", "%f", (double)data.cur_latency.count());
         formatter->dump_format("avg_lat", "%f", data.avg_latency);
+        formatter->dump_format("p50_lat", "%f", data.interval_hist.percentile(0.5));
+        formatter->dump_format("p99_lat", "%f", data.interval_hist.percentile(0.99));
+        formatter->dump_format("p999_lat", "%f", data.interval_hist.percentile(0.999));
       }
     }
     else {
@@ -225,8 +299,12 @@ void *ObjBencher::status_printer(void *_bencher) {
         formatter->dump_format("cur_bw", "%f", 0);
         formatter->dump_format("last_lat", "%f", 0);
         formatter->dump_format("avg_lat", "%f", data.avg_latency);
+        formatter->dump_format("p50_lat", "%f", 0);
+        formatter->dump_format("p99_lat", "%f", 0);
+        formatter->dump_format("p999_lat", "%f", 0);
       }
     }
+    data.interval_hist.clear();
     if (formatter) {
       formatter->close_section(); // data
       formatter->flush(*outstream);
@@ -295,6 +373,8 @@ int ObjBencher::aio_bench(
   data.max_latency = 0;
   data.avg_latency = 0;
   data.latency_diff_sum = 0;
+  data.latency_hist.clear();
+  data.interval_hist.clear();
   data.object_contents = contentsChars;
   lock.unlock();
 
@@ -363,6 +443,37 @@ void _aio_cb(void *cb, void *arg) {
   lc->lock->unlock();
 }
 
+// one per slot, so that the latency of an op ends when it completes, not
+// when the bench loop gets around to reaping it
+struct slot_cond {
+  lock_cond *lc;
+  bool done = false;
+  mono_time completed;
+};
+
+void _aio_slot_cb(void *cb, void *arg) {
+  auto sc = static_cast<slot_cond*>(arg);
+  std::lock_guard l{*sc->lc->lock};
+  sc->done = true;
+  sc->completed = mono_clock::now();
+  sc->lc->cond.notify_all();
+}
+
+mono_time ObjBencher::wait_for_next_op()
+{
+  if (target_ops <= 0) {
+    return mono_clock::now();
+  }
+  const mono_time due = next_op_time;
+  double gap = 1.0 / target_ops;
+  if (poisson_arrivals) {
+    gap = std::exponential_distribution<double>{target_ops}(arrival_rng);
+  }
+  next_op_time += ceph::make_timespan(gap);
+  std::this_thread::sleep_until(due);
+  return due;
+}
+
 int ObjBencher::fetch_bench_metadata(const std::string& metadata_file,
 				     uint64_t *op_size, uint64_t* object_size,
 				     int* num_ops, int* num_objects, int* prevPid) {
@@ -433,6 +544,7 @@ int ObjBencher::write_bench(int secondsToRun,
   lock_cond lc(&lock);
   double total_latency = 0;
   std::vector<mono_time> start_times(concurrentios);
+  std::vector<slot_cond> slots(concurrentios, slot_cond{&lc});
   mono_time stopTime;
   std::chrono::duration<double> timePassed;
 
@@ -457,10 +569,12 @@ int ObjBencher::write_bench(int secondsToRun,
   std::unique_lock locker{lock};
   data.finished = 0;
   data.start_time = mono_clock::now();
+  next_op_time = data.start_time;
   locker.unlock();
   for (int i = 0; i<concurrentios; ++i) {
-    start_times[i] = mono_clock::now();
-    r = create_completion(i, _aio_cb, (void *)&lc);
+    start_times[i] = wait_for_next_op();
+    slots[i].done = false;
+    r = create_completion(i, _aio_slot_cb, &slots[i]);
     if (r < 0)
       goto ERR;
     r = aio_write(name[i], i, *contents[i], data.op_size,
@@ -487,7 +601,7 @@ int ObjBencher::write_bench(int secondsToRun,
     while (1) {
       int old_slot = slot;
       do {
-        if (completion_is_done(slot)) {
+        if (slots[slot].done) {
             found = true;
             break;
         }
@@ -509,7 +623,8 @@ int ObjBencher::write_bench(int secondsToRun,
       locker.unlock();
       goto ERR;
     }
-    data.cur_latency = mono_clock::now() - start_times[slot];
+    data.cur_latency = slots[slot].completed - start_times[slot];
+    record_latency(data.cur_latency);
     total_latency += data.cur_latency.count();
     if( data.cur_latency.count() > data.max_latency)
       data.max_latency = data.cur_latency.count();
@@ -545,8 +660,9 @@ int ObjBencher::write_bench(int secondsToRun,
     // we wrote to buffer, going around internal crc cache, so invalidate it now.
     newContents->invalidate_crc();
 
-    start_times[slot] = mono_clock::now();
-    r = create_completion(slot, _aio_cb, &lc);
+    start_times[slot] = wait_for_next_op();
+    slots[slot].done = false;
+    r = create_completion(slot, _aio_slot_cb, &slots[slot]);
     if (r < 0)
       goto ERR;
     r = aio_write(newName, slot, *newContents, data.op_size,
@@ -609,6 +725,7 @@ int ObjBencher::write_bench(int secondsToRun,
        << "Stddev Latency(s):      " << latency_stddev << std::endl
        << "Max latency(s):         " << data.max_latency << std::endl
        << "Min latency(s):         " << data.min_latency << std::endl;
+    dump_latency_percentiles();
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_writes_made", "%d", data.finished);
@@ -626,6 +743,7 @@ int ObjBencher::write_bench(int secondsToRun,
     formatter->dump_format("stddev_latency", "%f", latency_stddev);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    dump_latency_percentiles();
   }
   //write object size/number data for read benchmarks
   encode(data.object_size, b_write);
@@ -665,6 +783,7 @@ int ObjBencher::seq_read_bench(
   double total_latency = 0;
   int r = 0;
   std::vector<mono_time> start_times(concurrentios);
+  std::vector<slot_cond> slots(concurrentios, slot_cond{&lc});
   mono_clock::duration time_to_run = std::chrono::seconds(seconds_to_run);
   std::chrono::duration<double> timePassed;
   sanitize_object_contents(&data, data.op_size); //clean it up once; subsequent
@@ -687,6 +806,7 @@ int ObjBencher::seq_read_bench(
   std::unique_lock locker{lock};
   data.finished = 0;
   data.start_time = mono_clock::now();
+  next_op_time = data.start_time;
   locker.unlock();
 
   pthread_t print_thread;
@@ -697,8 +817,9 @@ int ObjBencher::seq_read_bench(
   //start initial reads
   for (int i = 0; i < concurrentios; ++i) {
     index[i] = i;
-    start_times[i] = mono_clock::now();
-    create_completion(i, _aio_cb, (void *)&lc);
+    start_times[i] = wait_for_next_op();
+    slots[i].done = false;
+    create_completion(i, _aio_slot_cb, &slots[i]);
     r = aio_read(name[i], i, contents[i].get(), data.op_size,
 		 data.op_size * (i % reads_per_object));
     if (r < 0) {
@@ -722,7 +843,7 @@ int ObjBencher::seq_read_bench(
     bool found = false;
     while (1) {
       do {
-        if (completion_is_done(slot)) {
+        if (slots[slot].done) {
           found = true;
           break;
         }
@@ -737,8 +858,8 @@ int ObjBencher::seq_read_bench(
       lc.cond.wait(locker);
     }
 
-    // calculate latency here, so memcmp doesn't inflate it
-    data.cur_latency = mono_clock::now() - start_times[slot];
+    data.cur_latency = slots[slot].completed - start_times[slot];
+    record_latency(data.cur_latency);
 
     cur_contents = contents[slot].get();
     int current_index = index[slot];
@@ -786,8 +907,9 @@ int ObjBencher::seq_read_bench(
       continue;
 
     //start new read and check data if requested
-    start_times[slot] = mono_clock::now();
-    create_completion(slot, _aio_cb, (void *)&lc);
+    start_times[slot] = wait_for_next_op();
+    slots[slot].done = false;
+    create_completion(slot, _aio_slot_cb, &slots[slot]);
     r = aio_read(newName, slot, contents[slot].get(), data.op_size,
 		 data.op_size * (data.started % reads_per_object));
     if (r < 0) {
@@ -831,6 +953,7 @@ int ObjBencher::seq_read_bench(
        << "Average Latency(s):   " << data.avg_latency << std::endl
        << "Max latency(s):       " << data.max_latency << std::endl
        << "Min latency(s):       " << data.min_latency << std::endl;
+    dump_latency_percentiles();
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_reads_made", "%d", data.finished);
@@ -844,6 +967,7 @@ int ObjBencher::seq_read_bench(
     formatter->dump_format("average_latency", "%f", data.avg_latency);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    dump_latency_percentiles();
   }
 
   completions_done();
@@ -875,6 +999,7 @@ int ObjBencher::rand_read_bench(
   int r = 0;
   double total_latency = 0;
   std::vector<mono_time> start_times(concurrentios);
+  std::vector<slot_cond> slots(concurrentios, slot_cond{&lc});
   mono_clock::duration time_to_run = std::chrono::seconds(seconds_to_run);
   std::chrono::duration<double> timePassed;
   sanitize_object_contents(&data, data.op_size); //clean it up once; subsequent
@@ -899,6 +1024,7 @@ int ObjBencher::rand_read_bench(
   unique_lock locker{lock};
   data.finished = 0;
   data.start_time = mono_clock::now();
+  next_op_time = data.start_time;
   locker.unlock();
 
   pthread_t print_thread;
@@ -909,8 +1035,9 @@ int ObjBencher::rand_read_bench(
   //start initial reads
   for (int i = 0; i < concurrentios; ++i) {
     index[i] = i;
-    start_times[i] = mono_clock::now();
-    create_completion(i, _aio_cb, (void *)&lc);
+    start_times[i] = wait_for_next_op();
+    slots[i].done = false;
+    create_completion(i, _aio_slot_cb, &slots[i]);
     r = aio_read(name[i], i, contents[i].get(), data.op_size,
 		 data.op_size * (i % reads_per_object));
     if (r < 0) {
@@ -935,7 +1062,7 @@ int ObjBencher::rand_read_bench(
     bool found = false;
     while (1) {
       do {
-        if (completion_is_done(slot)) {
+        if (slots[slot].done) {
           found = true;
           break;
         }
@@ -950,8 +1077,8 @@ int ObjBencher::rand_read_bench(
       lc.cond.wait(locker);
     }
 
-    // calculate latency here, so memcmp doesn't inflate it
-    data.cur_latency = mono_clock::now() - start_times[slot];
+    data.cur_latency = slots[slot].completed - start_times[slot];
+    record_latency(data.cur_latency);
 
     locker.unlock();
 
@@ -999,8 +1126,9 @@ int ObjBencher::rand_read_bench(
     // invalidate internal crc cache
     cur_contents->invalidate_crc();
 
-    start_times[slot] = mono_clock::now();
-    create_completion(slot, _aio_cb, (void *)&lc);
+    start_times[slot] = wait_for_next_op();
+    slots[slot].done = false;
+    create_completion(slot, _aio_slot_cb, &slots[slot]);
     r = aio_read(newName, slot, contents[slot].get(), data.op_size,
 		 data.op_size * (rand_id % reads_per_object));
     if (r < 0) {
@@ -1044,6 +1172,7 @@ int ObjBencher::rand_read_bench(
        << "Average Latency(s):   " << data.avg_latency << std::endl
        << "Max latency(s):       " << data.max_latency << std::endl
        << "Min latency(s):       " << data.min_latency << std::endl;
+    dump_latency_percentiles();
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_reads_made", "%d", data.finished);
@@ -1057,6 +1186,7 @@ int ObjBencher::rand_read_bench(
     formatter->dump_format("average_latency", "%f", data.avg_latency);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    dump_latency_percentiles();
   }
   completions_done();
 
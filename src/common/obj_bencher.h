@@ -19,6 +19,8 @@
 #include "common/Formatter.h"
 #include "ceph_time.h"
 #include <cfloat>
+#include <random>
+#include <vector>
 
 using ceph::mono_clock;
 
@@ -35,6 +37,21 @@ struct bench_interval_data {
   double iops_diff_sum = 0;
 };
 
+/// latencies in microseconds, in log-linear buckets of 1/64 of a power of
+/// two like an HDR histogram, so a percentile is within 1.6% of the truth
+struct bench_latency_histogram {
+  static constexpr unsigned sub_bits = 6;
+  static constexpr unsigned max_shift = 40;
+  std::vector<uint64_t> counts =
+    std::vector<uint64_t>((max_shift + 2) << sub_bits);
+  uint64_t total = 0;
+
+  void add(std::chrono::duration<double> lat);
+  /// the latency, in seconds, that a fraction q of the samples do not exceed
+  double percentile(double q) const;
+  void clear();
+};
+
 struct bench_data {
   bool done; //is the benchmark is done
   uint64_t object_size; //the size of the objects
@@ -50,6 +67,8 @@ struct bench_data {
   struct bench_interval_data idata; // data that is updated by time intervals and not by events
   double latency_diff_sum;
   std::chrono::duration<double> cur_latency; //latency of last completed transaction - in seconds by default
+  bench_latency_histogram latency_hist; // all completed ops
+  bench_latency_histogram interval_hist; // ops completed since the last status line
   mono_time start_time; //start time for benchmark - use the monotonic clock as we'll measure the passage of time
   char *object_contents; //pointer to the contents written to each object
 };
@@ -65,6 +84,11 @@ class ObjBencher {
   bool show_time;
   Formatter *formatter = NULL;
   std::ostream *outstream = NULL;
+  /// open loop mode: ops/s to start regardless of completions, or 0
+  double target_ops = 0;
+  bool poisson_arrivals = false;
+  mono_time next_op_time;
+  std::mt19937_64 arrival_rng{std::random_device{}()};
 public:
   CephContext *cct;
 protected:
@@ -106,6 +130,11 @@ protected:
 
   std::ostream& out(std::ostream& os);
   std::ostream& out(std::ostream& os, utime_t& t);
+
+  void record_latency(std::chrono::duration<double> lat);
+  void dump_latency_percentiles();
+  /// in open loop mode, wait for the time the next op is scheduled at
+  mono_time wait_for_next_op();
 public:
   explicit ObjBencher(CephContext *cct_) : show_time(false), cct(cct_), data() {}
   virtual ~ObjBencher() {}
@@ -124,6 +153,13 @@ public:
   void set_outstream(std::ostream& os) {
     outstream = &os;
   }
+  /// start ops at a fixed rate, with constant or exponentially distributed
+  /// gaps, instead of as soon as others complete; latencies are then
+  /// measured from the time an op was due, not from when it was sent
+  void set_target_ops(double ops, bool poisson) {
+    target_ops = ops;
+    poisson_arrivals = poisson;
+  }
   int clean_up_slow(const std::string& prefix, int concurrentios);
 };
 
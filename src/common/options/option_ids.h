@@ -0,0 +1,13 @@
+#include "global_option_ids.h"
+#include "cephfs-mirror_option_ids.h"
+#include "crimson_option_ids.h"
+#include "mgr_option_ids.h"
+#include "mds_option_ids.h"
+#include "mds-client_option_ids.h"
+#include "mon_option_ids.h"
+#include "osd_option_ids.h"
+#include "rbd_option_ids.h"
+#include "rbd-mirror_option_ids.h"
+#include "immutable-object-cache_option_ids.h"
+#include "ceph-exporter_option_ids.h"
+#include "rgw_option_ids.h"
@@ -192,6 +192,12 @@ def type_to_h(t):
     return f'OPT_{t.upper()}'
 
 
+def yaml_to_id(opt):
+    name = opt['name']
+    typ = opt['type'].strip()
+    return f'OPTION({name}, TYPE_{typ.upper()})'
+
+
 def yaml_to_h(opt):
     if opt.get('with_legacy', False):
         name = opt['name']
@@ -263,6 +269,10 @@ def translate(opts):
                       file=sys.stderr)
                 return 1
         cc_file.write(epilogue.replace("}}", "}"))
+    if opts.ids:
+        with open(opts.ids, 'w') as ids_file:
+            for option in options:
+                ids_file.write(yaml_to_id(option) + '\n')
 
 
 def readable_size(value, typ):
@@ -345,6 +355,8 @@ def main():
     parser.add_argument('--legacy', dest='legacy',
                         default='legacy_options',
                         help='the path to the generated legacy .h file')
+    parser.add_argument('--ids', dest='ids',
+                        help='the path to the generated option ids .h file')
     parser.add_argument('--indent', type=int,
                         default=4,
                         help='the number of spaces added before each line')
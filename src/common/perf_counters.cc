@@ -15,6 +15,7 @@
 
 #include "common/perf_counters.h"
 #include "common/perf_counters_key.h"
+#include "common/perf_counters_stream.h"
 #include "common/dout.h"
 #include "common/valgrind.h"
 #include "include/common_fwd.h"
@@ -46,6 +47,7 @@ void PerfCountersCollectionImpl::add(PerfCounters *l)
   }
 
   m_loggers.insert(l);
+  ++generation;
 
   for (unsigned int i = 0; i < l->m_data.size(); ++i) {
     PerfCounters::perf_counter_data_any_d &data = l->m_data[i];
@@ -73,6 +75,7 @@ void PerfCountersCollectionImpl::remove(PerfCounters *l)
   perf_counters_set_t::iterator i = m_loggers.find(l);
   ceph_assert(i != m_loggers.end());
   m_loggers.erase(i);
+  ++generation;
 }
 
 void PerfCountersCollectionImpl::clear()
@@ -85,6 +88,7 @@ void PerfCountersCollectionImpl::clear()
   }
 
   by_path.clear();
+  ++generation;
 }
 
 bool PerfCountersCollectionImpl::reset(const std::string &name)
@@ -173,6 +177,62 @@ void PerfCountersCollectionImpl::with_counters(std::function<void(
   fn(by_path);
 }
 
+void PerfCountersCollectionImpl::encode_stream(const std::string &subscriber,
+                                               uint64_t seq,
+                                               ceph::buffer::list &out)
+{
+  // a few collectors per host at most; forget them all rather than grow
+  static constexpr size_t max_streams = 16;
+  if (streams.size() >= max_streams && !streams.count(subscriber)) {
+    streams.clear();
+  }
+  auto& state = streams[subscriber];
+  ceph::perf_counters::stream_reply_t reply;
+  reply.full = seq == 0 || seq != state.seq || state.generation != generation;
+  reply.seq = state.seq + 1;
+
+  std::vector<uint64_t> values;
+  values.reserve(state.values.size());
+  for (auto l : m_loggers) {
+    ceph::perf_counters::stream_logger_t *logger = nullptr;
+    if (reply.full) {
+      logger = &reply.schema.emplace_back();
+      logger->key = l->get_name();
+    }
+    for (auto& d : l->m_data) {
+      if (d.type & PERFCOUNTER_HISTOGRAM) {
+        continue;
+      }
+      if (logger) {
+        auto& c = logger->counters.emplace_back();
+        c.name = d.name;
+        c.description = d.description ? d.description : "";
+        c.nick = d.nick ? d.nick : "";
+        c.type = d.type;
+        c.unit = d.unit;
+        c.prio = l->get_adjusted_priority(d.prio);
+      }
+      if (d.type & PERFCOUNTER_LONGRUNAVG) {
+        auto [sum, count] = d.read_avg();
+        values.push_back(sum);
+        values.push_back(count);
+      } else {
+        values.push_back(d.read_u64());
+      }
+    }
+  }
+
+  for (uint32_t slot = 0; slot < values.size(); ++slot) {
+    if (reply.full || values[slot] != state.values[slot]) {
+      reply.values.emplace_back(slot, values[slot]);
+    }
+  }
+  state.seq = reply.seq;
+  state.generation = generation;
+  state.values = std::move(values);
+  encode(reply, out);
+}
+
 // ---------------------------
 
 PerfCounters::~PerfCounters()
@@ -191,13 +251,7 @@ void PerfCounters::inc(int idx, uint64_t amt)
   perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_U64))
     return;
-  if (data.type & PERFCOUNTER_LONGRUNAVG) {
-    data.avgcount++;
-    data.u64 += amt;
-    data.avgcount2++;
-  } else {
-    data.u64 += amt;
-  }
+  data.add(amt, data.type & PERFCOUNTER_LONGRUNAVG);
 }
 
 void PerfCounters::dec(int idx, uint64_t amt)
@@ -213,7 +267,8 @@ void PerfCounters::dec(int idx, uint64_t amt)
   ceph_assert(!(data.type & PERFCOUNTER_LONGRUNAVG));
   if (!(data.type & PERFCOUNTER_U64))
     return;
-  data.u64 -= amt;
+  // wraps around in the slot, the sum over all slots is still right
+  data.add(-amt, false);
 }
 
 void PerfCounters::set(int idx, uint64_t amt)
@@ -233,10 +288,10 @@ void PerfCounters::set(int idx, uint64_t amt)
                              "perf counter atomic");
   if (data.type & PERFCOUNTER_LONGRUNAVG) {
     data.avgcount++;
-    data.u64 = amt;
+    data.store(amt);
     data.avgcount2++;
   } else {
-    data.u64 = amt;
+    data.store(amt);
   }
 }
 
@@ -252,7 +307,7 @@ uint64_t PerfCounters::get(int idx) const
   const perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_U64))
     return 0;
-  return data.u64;
+  return data.read_u64();
 }
 
 void PerfCounters::tinc(int idx, utime_t amt)
@@ -267,13 +322,7 @@ void PerfCounters::tinc(int idx, utime_t amt)
   perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_TIME))
     return;
-  if (data.type & PERFCOUNTER_LONGRUNAVG) {
-    data.avgcount++;
-    data.u64 += amt.to_nsec();
-    data.avgcount2++;
-  } else {
-    data.u64 += amt.to_nsec();
-  }
+  data.add(amt.to_nsec(), data.type & PERFCOUNTER_LONGRUNAVG);
 }
 
 void PerfCounters::tinc(int idx, ceph::timespan amt)
@@ -288,13 +337,7 @@ void PerfCounters::tinc(int idx, ceph::timespan amt)
   perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_TIME))
     return;
-  if (data.type & PERFCOUNTER_LONGRUNAVG) {
-    data.avgcount++;
-    data.u64 += amt.count();
-    data.avgcount2++;
-  } else {
-    data.u64 += amt.count();
-  }
+  data.add(amt.count(), data.type & PERFCOUNTER_LONGRUNAVG);
 }
 
 void PerfCounters::tset(int idx, utime_t amt)
@@ -309,7 +352,7 @@ void PerfCounters::tset(int idx, utime_t amt)
   perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_TIME))
     return;
-  data.u64 = amt.to_nsec();
+  data.store(amt.to_nsec());
   if (data.type & PERFCOUNTER_LONGRUNAVG)
     ceph_abort();
 }
@@ -326,7 +369,7 @@ utime_t PerfCounters::tget(int idx) const
   const perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_TIME))
     return utime_t();
-  uint64_t v = data.u64;
+  uint64_t v = data.read_u64();
   return utime_t(v / 1000000000ull, v % 1000000000ull);
 }
 
@@ -493,7 +536,7 @@ void PerfCounters::dump_formatted_generic(Formatter *f, bool schema,
         d->histogram->dump_formatted(f);
         f->close_section();
       } else {
-	uint64_t v = d->u64;
+	uint64_t v = d->read_u64();
 	if (d->type & PERFCOUNTER_U64) {
 	  f->dump_unsigned(d->name, v);
 	} else if (d->type & PERFCOUNTER_TIME) {
@@ -616,6 +659,12 @@ void PerfCountersBuilder::add_impl(
   data.type = (enum perfcounter_type_d)ty;
   data.unit = (enum unit_t) unit;
   data.histogram = std::move(histogram);
+  if (sharded_default && !data.histogram &&
+      (data.type & (PERFCOUNTER_COUNTER | PERFCOUNTER_LONGRUNAVG))) {
+    data.shards.reset(
+      new PerfCounters::perf_counter_data_any_d::shard_d[
+	PerfCounters::perf_counter_data_any_d::num_shards]);
+  }
 }
 
 PerfCounters *PerfCountersBuilder::create_perf_counters()
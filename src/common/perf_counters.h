@@ -113,6 +113,14 @@ public:
     prio_default = prio_;
   }
 
+  // counters and averages added after this call keep one slot per
+  // thread, summed up when read.  Use it for counters updated by every
+  // op on every worker thread; it costs a few KiB per counter.
+  void set_sharded_default(bool sharded_)
+  {
+    sharded_default = sharded_;
+  }
+
   PerfCounters* create_perf_counters();
 private:
   PerfCountersBuilder(const PerfCountersBuilder &rhs);
@@ -124,6 +132,7 @@ private:
   PerfCounters *m_perf_counters;
 
   int prio_default = 0;
+  bool sharded_default = false;
 };
 
 /*
@@ -163,22 +172,33 @@ public:
 	 type(PERFCOUNTER_NONE),
 	 unit(UNIT_NONE)
     {}
+    // the copy is a plain (unsharded) snapshot of the current values
     perf_counter_data_any_d(const perf_counter_data_any_d& other)
       : name(other.name),
         description(other.description),
         nick(other.nick),
 	 type(other.type),
 	 unit(other.unit),
-	 u64(other.u64.load()) {
-      auto a = other.read_avg();
-      u64 = a.first;
-      avgcount = a.second;
-      avgcount2 = a.second;
+	 u64(other.read_u64()) {
+      if (type & PERFCOUNTER_LONGRUNAVG) {
+	auto a = other.read_avg();
+	u64 = a.first;
+	avgcount = a.second;
+	avgcount2 = a.second;
+      }
       if (other.histogram) {
         histogram.reset(new PerfHistogram<>(*other.histogram));
       }
     }
 
+    /// per-thread slots of a sharded counter, one cache line each
+    struct alignas(64) shard_d {
+      std::atomic<uint64_t> u64 = { 0 };
+      std::atomic<uint64_t> avgcount = { 0 };
+      std::atomic<uint64_t> avgcount2 = { 0 };
+    };
+    static constexpr unsigned num_shards = 32;
+
     const char *name;
     const char *description;
     const char *nick;
@@ -189,6 +209,46 @@ public:
     std::atomic<uint64_t> avgcount = { 0 };
     std::atomic<uint64_t> avgcount2 = { 0 };
     std::unique_ptr<PerfHistogram<>> histogram;
+    /// non-null if updates go to per-thread slots instead of u64 et al.
+    std::unique_ptr<shard_d[]> shards;
+
+    static unsigned thread_index() {
+      static std::atomic<unsigned> next_index{0};
+      static thread_local unsigned index =
+	next_index.fetch_add(1, std::memory_order_relaxed);
+      return index;
+    }
+
+    // add amt as one sample; a sharded counter updates the slot of the
+    // calling thread, whose cache line is (mostly) not shared
+    void add(uint64_t amt, bool avg) {
+      if (shards) {
+	shard_d& s = shards[thread_index() % num_shards];
+	if (avg) {
+	  s.avgcount++;
+	  s.u64 += amt;
+	  s.avgcount2++;
+	} else {
+	  s.u64 += amt;
+	}
+      } else if (avg) {
+	avgcount++;
+	u64 += amt;
+	avgcount2++;
+      } else {
+	u64 += amt;
+      }
+    }
+
+    // overwrite the value; the slots of a sharded counter are folded away
+    void store(uint64_t amt) {
+      u64 = amt;
+      if (shards) {
+	for (unsigned i = 0; i < num_shards; ++i) {
+	  shards[i].u64 = 0;
+	}
+      }
+    }
 
     void reset()
     {
@@ -196,21 +256,51 @@ public:
 	    u64 = 0;
 	    avgcount = 0;
 	    avgcount2 = 0;
+	    if (shards) {
+	      for (unsigned i = 0; i < num_shards; ++i) {
+		shards[i].u64 = 0;
+		shards[i].avgcount = 0;
+		shards[i].avgcount2 = 0;
+	      }
+	    }
       }
       if (histogram) {
         histogram->reset();
       }
     }
 
+    uint64_t read_u64() const {
+      uint64_t v = u64;
+      if (shards) {
+	for (unsigned i = 0; i < num_shards; ++i) {
+	  v += shards[i].u64;
+	}
+      }
+      return v;
+    }
+
     // read <sum, count> safely by making sure the post- and pre-count
     // are identical; in other words the whole loop needs to be run
-    // without any intervening calls to inc, set, or tinc.
+    // without any intervening calls to inc, set, or tinc.  A sharded
+    // counter is read slot by slot, each of them consistently.
     std::pair<uint64_t,uint64_t> read_avg() const {
       uint64_t sum, count;
       do {
 	count = avgcount2;
 	sum = u64;
       } while (avgcount != count);
+      if (shards) {
+	for (unsigned i = 0; i < num_shards; ++i) {
+	  const shard_d& s = shards[i];
+	  uint64_t ssum, scount;
+	  do {
+	    scount = s.avgcount2;
+	    ssum = s.u64;
+	  } while (s.avgcount != scount);
+	  sum += ssum;
+	  count += scount;
+	}
+      }
       return { sum, count };
     }
   };
@@ -350,6 +440,11 @@ public:
 
   void with_counters(std::function<void(const CounterMap &)>) const;
 
+  /// reply to "counter stream" from subscriber, which last applied seq;
+  /// see perf_counters_stream.h
+  void encode_stream(const std::string &subscriber, uint64_t seq,
+                     ceph::buffer::list &out);
+
 private:
   void dump_formatted_generic(ceph::Formatter *f, bool schema, bool histograms,
                               bool dump_labeled,
@@ -359,6 +454,15 @@ private:
   perf_counters_set_t m_loggers;
 
   CounterMap by_path; 
+
+  /// bumped whenever m_loggers changes, which moves the stream slots
+  uint64_t generation = 0;
+  struct stream_state_t {
+    uint64_t seq = 0;
+    uint64_t generation = 0;
+    std::vector<uint64_t> values;  ///< as last sent
+  };
+  std::map<std::string, stream_state_t> streams;
 };
 
 
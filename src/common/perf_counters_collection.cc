@@ -53,6 +53,13 @@ void PerfCountersCollection::with_counters(std::function<void(const PerfCounters
   std::lock_guard lck(m_lock);
   perf_impl.with_counters(fn);
 }
+void PerfCountersCollection::encode_stream(const std::string &subscriber,
+                                           uint64_t seq,
+                                           ceph::buffer::list &out)
+{
+  std::lock_guard lck(m_lock);
+  perf_impl.encode_stream(subscriber, seq, out);
+}
 void PerfCountersDeleter::operator()(PerfCounters* p) noexcept
 {
   if (cct)
@@ -28,6 +28,8 @@ public:
                                  const std::string &counter = "");
 
   void with_counters(std::function<void(const PerfCountersCollectionImpl::CounterMap &)>) const;
+  void encode_stream(const std::string &subscriber, uint64_t seq,
+                     ceph::buffer::list &out);
 
   friend class PerfCountersCollectionTest;
 };
@@ -0,0 +1,133 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "include/encoding.h"
+
+/**
+ * The binary "counter stream" admin socket command, for the collectors
+ * (ceph-exporter) that poll every daemon of a host.
+ *
+ * The first reply to a subscriber carries the schema of every labeled
+ * and unlabeled counter, and all their values.  The replies after it,
+ * for as long as the subscriber passes the seq of the last reply it
+ * applied and the daemon's counters stay the same, carry only the values
+ * that changed.  Values are addressed by slot: every non-histogram
+ * counter of the schema in order, with two slots (sum and count) for
+ * the long running averages.
+ */
+namespace ceph::perf_counters {
+
+struct stream_counter_t {
+  std::string name;
+  std::string description;
+  std::string nick;
+  uint8_t type = 0;   ///< perfcounter_type_d bits
+  uint8_t unit = 0;   ///< unit_t
+  int32_t prio = 0;   ///< adjusted priority
+
+  void encode(ceph::buffer::list& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(name, bl);
+    encode(description, bl);
+    encode(nick, bl);
+    encode(type, bl);
+    encode(unit, bl);
+    encode(prio, bl);
+    ENCODE_FINISH(bl);
+  }
+  void decode(ceph::buffer::list::const_iterator& p) {
+    DECODE_START(1, p);
+    decode(name, p);
+    decode(description, p);
+    decode(nick, p);
+    decode(type, p);
+    decode(unit, p);
+    decode(prio, p);
+    DECODE_FINISH(p);
+  }
+};
+WRITE_CLASS_ENCODER(stream_counter_t)
+
+struct stream_logger_t {
+  std::string key;   ///< the logger name with its labels, see key_create()
+  std::vector<stream_counter_t> counters;
+
+  void encode(ceph::buffer::list& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(key, bl);
+    encode(counters, bl);
+    ENCODE_FINISH(bl);
+  }
+  void decode(ceph::buffer::list::const_iterator& p) {
+    DECODE_START(1, p);
+    decode(key, p);
+    decode(counters, p);
+    DECODE_FINISH(p);
+  }
+};
+WRITE_CLASS_ENCODER(stream_logger_t)
+
+struct stream_reply_t {
+  uint64_t seq = 0;   ///< pass it with the next request
+  bool full = false;  ///< schema is set, and values has every slot
+  std::vector<stream_logger_t> schema;
+  std::vector<std::pair<uint32_t, uint64_t>> values;  ///< slot, value
+
+  void encode(ceph::buffer::list& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(seq, bl);
+    encode(full, bl);
+    encode(schema, bl);
+    encode(values, bl);
+    ENCODE_FINISH(bl);
+  }
+  void decode(ceph::buffer::list::const_iterator& p) {
+    DECODE_START(1, p);
+    decode(seq, p);
+    decode(full, p);
+    decode(schema, p);
+    decode(values, p);
+    DECODE_FINISH(p);
+  }
+};
+WRITE_CLASS_ENCODER(stream_reply_t)
+
+/// the subscriber's copy of a daemon's counters
+class StreamReader {
+public:
+  uint64_t seq = 0;
+  std::vector<stream_logger_t> schema;
+  std::vector<uint64_t> values;  ///< by slot
+
+  /// false if reply is a delta we cannot apply; start over with seq 0
+  bool apply(const stream_reply_t& reply) {
+    if (reply.full) {
+      schema = reply.schema;
+      values.assign(reply.values.size(), 0);
+    } else if (reply.seq != seq + 1) {
+      return false;
+    }
+    for (auto& [slot, value] : reply.values) {
+      if (slot >= values.size()) {
+	return false;
+      }
+      values[slot] = value;
+    }
+    seq = reply.seq;
+    return true;
+  }
+  void clear() {
+    seq = 0;
+    schema.clear();
+    values.clear();
+  }
+};
+
+} // namespace ceph::perf_counters
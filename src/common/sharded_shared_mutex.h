@@ -0,0 +1,131 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <string>
+
+#include "common/ceph_mutex.h"
+
+// A reader-mostly shared mutex
+// ============================
+//
+// ceph::sharded_shared_mutex satisfies the SharedMutex concept, but
+// splits its state across a number of cache-line aligned shards.  A
+// reader only touches the shard assigned to its thread, so readers on
+// different cores never bounce a common cache line.  A writer takes
+// every shard, in order, which makes exclusive locking proportionally
+// more expensive: use this for locks that are taken shared on a hot
+// path and exclusively only on rare events (e.g. map changes).
+//
+// A shared lock must be released by the thread that acquired it.
+//
+// The lockdep-enabled (CEPH_DEBUG_MUTEX) and crimson builds fall back
+// to a plain ceph::shared_mutex so that the usual lock checking keeps
+// working.
+
+#if defined(WITH_SEASTAR) && !defined(WITH_ALIEN)
+
+namespace ceph {
+  using sharded_shared_mutex = shared_mutex;
+
+  inline sharded_shared_mutex make_sharded_shared_mutex(const std::string&,
+							 unsigned) {
+    return {};
+  }
+}
+
+#elif defined(CEPH_DEBUG_MUTEX)
+
+namespace ceph {
+  using sharded_shared_mutex = shared_mutex;
+
+  // the shard count is ignored; lockdep wants a single named lock
+  inline sharded_shared_mutex make_sharded_shared_mutex(
+    const std::string& name, unsigned) {
+    return make_shared_mutex(name);
+  }
+}
+
+#else
+
+#include <atomic>
+#include <memory>
+
+namespace ceph {
+
+class sharded_shared_mutex {
+  // one cache line (64 bytes on the platforms we care about) per shard
+  struct alignas(64) shard_t {
+    shared_mutex lock;
+  };
+
+  unsigned num_shards;
+  std::unique_ptr<shard_t[]> shards;
+
+  static unsigned thread_index() {
+    static std::atomic<unsigned> next_index{0};
+    static thread_local unsigned index =
+      next_index.fetch_add(1, std::memory_order_relaxed);
+    return index;
+  }
+
+  shard_t& my_shard() {
+    return shards[thread_index() % num_shards];
+  }
+
+public:
+  explicit sharded_shared_mutex(unsigned n = 1)
+    : num_shards(n ? n : 1),
+      shards(new shard_t[num_shards]) {}
+  sharded_shared_mutex(const sharded_shared_mutex&) = delete;
+  sharded_shared_mutex& operator=(const sharded_shared_mutex&) = delete;
+
+  unsigned get_num_shards() const {
+    return num_shards;
+  }
+
+  // exclusive
+  void lock() {
+    for (unsigned i = 0; i < num_shards; ++i) {
+      shards[i].lock.lock();
+    }
+  }
+  bool try_lock() {
+    for (unsigned i = 0; i < num_shards; ++i) {
+      if (!shards[i].lock.try_lock()) {
+	while (i-- > 0) {
+	  shards[i].lock.unlock();
+	}
+	return false;
+      }
+    }
+    return true;
+  }
+  void unlock() {
+    for (unsigned i = num_shards; i-- > 0; ) {
+      shards[i].lock.unlock();
+    }
+  }
+
+  // shared
+  void lock_shared() {
+    my_shard().lock.lock_shared();
+  }
+  bool try_lock_shared() {
+    return my_shard().lock.try_lock_shared();
+  }
+  void unlock_shared() {
+    my_shard().lock.unlock_shared();
+  }
+};
+
+// the name is for the lockdep variant only
+inline sharded_shared_mutex make_sharded_shared_mutex(const std::string&,
+						      unsigned n) {
+  return sharded_shared_mutex(n);
+}
+
+}
+
+#endif
@@ -0,0 +1,211 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+#include <boost/intrusive/list.hpp>
+
+namespace ceph {
+
+/// Hook for entries of a timer_wheel.  Destroying an entry, or calling
+/// cancel() on it, takes it off the wheel.
+class timer_wheel_hook
+  : public boost::intrusive::list_base_hook<
+      boost::intrusive::link_mode<boost::intrusive::auto_unlink>> {
+  template <typename> friend class timer_wheel;
+  uint64_t expires = 0;
+public:
+  uint64_t get_expires() const {
+    return expires;
+  }
+  bool is_scheduled() const {
+    return is_linked();
+  }
+  void cancel() {
+    unlink();
+  }
+};
+
+/**
+ * Hierarchical timing wheel (Varghese & Lauck).
+ *
+ * Time is counted in ticks.  Level 0 has 256 slots of one tick each, and
+ * each of the four levels above has 64 slots spanning a whole turn of
+ * the level below: 2^32 ticks in total.  Entries further out are parked
+ * in the last slot of the top level until it comes up.
+ *
+ * Adding and cancelling an entry are O(1).  Advancing moves the entries
+ * of a slot one or more levels down when the slot comes up, at most four
+ * times per entry, and skips over empty slots using per level occupancy
+ * bitmaps.  The bitmaps may be stale after a cancel; a stale slot only
+ * costs a spurious stop in advance() and an early next_tick().
+ *
+ * T must derive from timer_wheel_hook.  The wheel does not own the
+ * entries, and is not thread safe.
+ */
+template <typename T>
+class timer_wheel {
+  static constexpr unsigned levels = 5;
+  static constexpr unsigned bits0 = 8;
+  static constexpr unsigned bitsn = 6;
+  static constexpr unsigned slots0 = 1u << bits0;
+  static constexpr unsigned slotsn = 1u << bitsn;
+
+  using list_t = boost::intrusive::list<
+    T, boost::intrusive::constant_time_size<false>>;
+
+  uint64_t now;  ///< last tick we advanced to
+  list_t wheel0[slots0];
+  list_t wheeln[levels - 1][slotsn];
+  uint64_t occ0[slots0 / 64] = {};
+  uint64_t occn[levels - 1] = {};
+  list_t expired;
+
+  static constexpr unsigned shift_of(unsigned level) {
+    return level ? bits0 + bitsn * (level - 1) : 0;
+  }
+
+  /// distance from start to the first set bit among the n slots that
+  /// follow it (circularly), or -1
+  template <size_t W>
+  static int find_next(const uint64_t (&occ)[W], unsigned start, unsigned n) {
+    unsigned pos = start;
+    unsigned d = 0;
+    while (d < n) {
+      const unsigned b = pos & 63;
+      const unsigned chunk = std::min(64 - b, n - d);
+      uint64_t bits = occ[pos >> 6] >> b;
+      if (chunk < 64) {
+	bits &= (uint64_t(1) << chunk) - 1;
+      }
+      if (bits) {
+	return d + std::countr_zero(bits);
+      }
+      d += chunk;
+      pos = (pos + chunk) % (W * 64);
+    }
+    return -1;
+  }
+
+  void place(T& e) {
+    const uint64_t x = e.expires;
+    if (x <= now) {
+      expired.push_back(e);
+      return;
+    }
+    if (x - now < slots0) {
+      const unsigned i = x & (slots0 - 1);
+      wheel0[i].push_back(e);
+      occ0[i >> 6] |= uint64_t(1) << (i & 63);
+      return;
+    }
+    for (unsigned l = 1; l < levels; ++l) {
+      uint64_t xs = x >> shift_of(l);
+      const uint64_t ns = now >> shift_of(l);
+      // xs - ns is at least 1 here, otherwise a lower level would do
+      if (xs - ns < slotsn || l == levels - 1) {
+	xs = std::min(xs, ns + slotsn - 1);
+	const unsigned i = xs & (slotsn - 1);
+	wheeln[l - 1][i].push_back(e);
+	occn[l - 1] |= uint64_t(1) << i;
+	return;
+      }
+    }
+  }
+
+  void cascade(unsigned level, unsigned i) {
+    occn[level - 1] &= ~(uint64_t(1) << i);
+    list_t l;
+    l.splice(l.end(), wheeln[level - 1][i]);
+    while (!l.empty()) {
+      T& e = l.front();
+      l.pop_front();
+      place(e);
+    }
+  }
+
+  /// the first tick after now where a slot holds entries (or did)
+  uint64_t next_busy_tick() const {
+    uint64_t best = std::numeric_limits<uint64_t>::max();
+    if (int d = find_next(occ0, (now + 1) & (slots0 - 1), slots0 - 1);
+	d >= 0) {
+      best = now + 1 + d;
+    }
+    for (unsigned l = 1; l < levels; ++l) {
+      const uint64_t ns = now >> shift_of(l);
+      const uint64_t occ[1] = {occn[l - 1]};
+      if (int d = find_next(occ, (ns + 1) & (slotsn - 1), slotsn - 1);
+	  d >= 0) {
+	best = std::min(best, (ns + 1 + d) << shift_of(l));
+      }
+    }
+    return best;
+  }
+
+  void process(uint64_t t) {
+    for (unsigned l = levels - 1; l >= 1; --l) {
+      if ((t & ((uint64_t(1) << shift_of(l)) - 1)) == 0) {
+	cascade(l, (t >> shift_of(l)) & (slotsn - 1));
+      }
+    }
+    const unsigned i = t & (slots0 - 1);
+    occ0[i >> 6] &= ~(uint64_t(1) << (i & 63));
+    expired.splice(expired.end(), wheel0[i]);
+  }
+
+public:
+  explicit timer_wheel(uint64_t start = 0) : now(start) {}
+  timer_wheel(const timer_wheel&) = delete;
+  timer_wheel& operator=(const timer_wheel&) = delete;
+
+  uint64_t get_now() const {
+    return now;
+  }
+
+  /// schedule e, which must not be scheduled yet, at tick expires; an
+  /// entry that is already due goes straight to the expired list
+  void add(T& e, uint64_t expires) {
+    e.expires = expires;
+    place(e);
+  }
+
+  /// move every entry due at or before tick `to` to the expired list,
+  /// in expiry order
+  void advance(uint64_t to) {
+    while (now < to) {
+      const uint64_t t = next_busy_tick();
+      if (t > to) {
+	now = to;
+	break;
+      }
+      now = t;
+      process(t);
+    }
+  }
+
+  /// first entry off the expired list, or nullptr
+  T* pop_expired() {
+    if (expired.empty()) {
+      return nullptr;
+    }
+    T& e = expired.front();
+    expired.pop_front();
+    return &e;
+  }
+
+  /// a lower bound of the tick at which the next entry expires; now if
+  /// some have expired already, max() if there are none
+  uint64_t next_tick() const {
+    if (!expired.empty()) {
+      return now;
+    }
+    return next_busy_tick();
+  }
+};
+
+} // namespace ceph
@@ -19,6 +19,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 #include "include/ceph_assert.h"    // boost clobbers this
 #include "include/common_fwd.h"
 #include "include/buffer.h"
@@ -88,6 +89,20 @@ public:
   // alignment with decode methods
   virtual int decompress(ceph::bufferlist::const_iterator &p, size_t compressed_len, ceph::bufferlist &out, std::optional<int32_t> compressor_message) = 0;
 
+  /// a new compressor of this type primed with the given dictionary, or
+  /// nullptr if the type does not support dictionaries.  Both ends must
+  /// use the same dictionary.
+  virtual CompressorRef with_dictionary(const ceph::bufferlist &dict) {
+    return nullptr;
+  }
+
+  /// a dictionary of at most max_size bytes for data like the samples,
+  /// for with_dictionary(); -EOPNOTSUPP if the type has no dictionaries
+  virtual int train_dictionary(const std::vector<ceph::bufferlist> &samples,
+			       size_t max_size, ceph::bufferlist *dict) {
+    return -EOPNOTSUPP;
+  }
+
   static CompressorRef create(CephContext *cct, const std::string &type);
   static CompressorRef create(CephContext *cct, int alg);
 
@@ -147,9 +147,9 @@ int QatAccel::compress(const bufferlist &in, bufferlist &out, std::optional<int3
   auto session = cached_session_t{this, std::move(s)}; // returns to the session pool on destruction
   compressor_message = ZLIB_DEFAULT_WIN_SIZE;
   int begin = 1;
-  for (auto &i : in.buffers()) {
-    const unsigned char* c_in = (unsigned char*) i.c_str();
-    unsigned int len = i.length();
+  auto compress_chunk = [&](bufferlist& chunk) {
+    const unsigned char* c_in = (unsigned char*) chunk.c_str();
+    unsigned int len = chunk.length();
     unsigned int out_len = qzMaxCompressedLength(len, session.get()) + begin;
 
     bufferptr ptr = buffer::create_small_page_aligned(out_len);
@@ -164,8 +164,23 @@ int QatAccel::compress(const bufferlist &in, bufferlist &out, std::optional<int3
       begin = 0;
     }
     out.append(ptr, 0, out_len);
-
+    chunk.clear();
+    return 0;
+  };
+
+  // every qzCompress() is a round trip to the device: coalesce the small
+  // buffers (e.g. the pieces of an encoded message) into requests of up to
+  // a hardware buffer, instead of submitting each of them on its own
+  bufferlist chunk;
+  for (auto &i : in.buffers()) {
+    if (chunk.length() && chunk.length() + i.length() > QZ_HW_BUFF_SZ) {
+      if (compress_chunk(chunk) < 0)
+        return -1;
+    }
+    chunk.append(i);
   }
+  if (chunk.length() && compress_chunk(chunk) < 0)
+    return -1;
 
   return 0;
 }
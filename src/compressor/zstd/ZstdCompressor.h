@@ -17,6 +17,7 @@
 
 #define ZSTD_STATIC_LINKING_ONLY
 #include "zstd/lib/zstd.h"
+#include "zstd/lib/zdict.h"
 
 #include "include/buffer.h"
 #include "include/encoding.h"
@@ -29,6 +30,10 @@ class ZstdCompressor : public Compressor {
   int compress(const ceph::buffer::list &src, ceph::buffer::list &dst, std::optional<int32_t> &compressor_message) override {
     ZSTD_CStream *s = ZSTD_createCStream();
     ZSTD_initCStream_srcSize(s, cct->_conf->compressor_zstd_level, src.length());
+    if (cdict) {
+      // the level is the one the dictionary was digested with
+      ZSTD_CCtx_refCDict(s, cdict.get());
+    }
     auto p = src.begin();
     size_t left = src.length();
 
@@ -84,6 +89,9 @@ class ZstdCompressor : public Compressor {
     outbuf.pos = 0;
     ZSTD_DStream *s = ZSTD_createDStream();
     ZSTD_initDStream(s);
+    if (ddict) {
+      ZSTD_DCtx_refDDict(s, ddict.get());
+    }
     while (compressed_len > 0) {
       if (p.end()) {
 	return -1;
@@ -92,7 +100,12 @@ class ZstdCompressor : public Compressor {
       inbuf.pos = 0;
       inbuf.size = p.get_ptr_and_advance(compressed_len,
 					 (const char**)&inbuf.src);
-      ZSTD_decompressStream(s, &outbuf, &inbuf);
+      size_t r = ZSTD_decompressStream(s, &outbuf, &inbuf);
+      if (ZSTD_isError(r)) {
+	// e.g. a frame compressed with a dictionary we were not given
+	ZSTD_freeDStream(s);
+	return -EINVAL;
+      }
       compressed_len -= inbuf.size;
     }
     ZSTD_freeDStream(s);
@@ -100,8 +113,43 @@ class ZstdCompressor : public Compressor {
     dst.append(dstptr, 0, outbuf.pos);
     return 0;
   }
+
+  CompressorRef with_dictionary(const ceph::buffer::list &dict) override {
+    ceph::buffer::list flat(dict);
+    auto c = std::make_shared<ZstdCompressor>(cct);
+    c->cdict.reset(ZSTD_createCDict(flat.c_str(), flat.length(),
+				    cct->_conf->compressor_zstd_level),
+		   ZSTD_freeCDict);
+    c->ddict.reset(ZSTD_createDDict(flat.c_str(), flat.length()),
+		   ZSTD_freeDDict);
+    if (!c->cdict || !c->ddict) {
+      return nullptr;
+    }
+    return c;
+  }
+
+  int train_dictionary(const std::vector<ceph::buffer::list> &samples,
+		       size_t max_size, ceph::buffer::list *dict) override {
+    ceph::buffer::list flat;
+    std::vector<size_t> sizes;
+    for (auto& s : samples) {
+      flat.append(s);
+      sizes.push_back(s.length());
+    }
+    ceph::buffer::ptr out(max_size);
+    size_t r = ZDICT_trainFromBuffer(out.c_str(), out.length(),
+				     flat.c_str(), sizes.data(), sizes.size());
+    if (ZDICT_isError(r)) {
+      return -EINVAL;
+    }
+    dict->append(out, 0, r);
+    return 0;
+  }
  private:
   CephContext *const cct;
+  // digested dictionaries, read-only and shared by all streams
+  std::shared_ptr<ZSTD_CDict> cdict;
+  std::shared_ptr<ZSTD_DDict> ddict;
 };
 
 #endif
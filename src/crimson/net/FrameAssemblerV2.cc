@@ -234,15 +234,15 @@ seastar::future<> FrameAssemblerV2::close_shutdown_socket()
 
 template <bool may_cross_core>
 seastar::future<ceph::bufferptr>
-FrameAssemblerV2::read_exactly(std::size_t bytes)
+FrameAssemblerV2::read_exactly(std::size_t bytes, std::size_t alignment)
 {
   assert(seastar::this_shard_id() == sid);
   assert(has_socket());
   if constexpr (may_cross_core) {
     assert(conn.get_messenger_shard_id() == sid);
     return seastar::smp::submit_to(
-        socket->get_shard_id(), [this, bytes] {
-      return socket->read_exactly(bytes);
+        socket->get_shard_id(), [this, bytes, alignment] {
+      return socket->read_exactly(bytes, alignment);
     }).then([this](auto bptr) {
       if (record_io) {
         rxbuf.append(bptr);
@@ -251,11 +251,11 @@ FrameAssemblerV2::read_exactly(std::size_t bytes)
     });
   } else {
     assert(socket->get_shard_id() == sid);
-    return socket->read_exactly(bytes);
+    return socket->read_exactly(bytes, alignment);
   }
 }
-template seastar::future<ceph::bufferptr> FrameAssemblerV2::read_exactly<true>(std::size_t);
-template seastar::future<ceph::bufferptr> FrameAssemblerV2::read_exactly<false>(std::size_t);
+template seastar::future<ceph::bufferptr> FrameAssemblerV2::read_exactly<true>(std::size_t, std::size_t);
+template seastar::future<ceph::bufferptr> FrameAssemblerV2::read_exactly<false>(std::size_t, std::size_t);
 
 template <bool may_cross_core>
 seastar::future<ceph::bufferlist>
@@ -389,16 +389,17 @@ FrameAssemblerV2::read_frame_payload()
       return rx_frame_asm.get_num_segments() == rx_segments_data.size();
     },
     [this] {
-      // TODO: create aligned and contiguous buffer from socket
       const size_t seg_idx = rx_segments_data.size();
-      if (uint16_t alignment = rx_frame_asm.get_segment_align(seg_idx);
-          alignment != segment_t::DEFAULT_ALIGNMENT) {
-        logger().trace("{} cannot allocate {} aligned buffer at segment desc index {}",
-                       conn, alignment, rx_segments_data.size());
+      // segments asking for more than the default alignment (i.e. the
+      // data segment) are received into a contiguous and aligned buffer,
+      // so that the store can adopt them without copying
+      std::size_t alignment = 0;
+      if (uint16_t align = rx_frame_asm.get_segment_align(seg_idx);
+          align != segment_t::DEFAULT_ALIGNMENT) {
+        alignment = align;
       }
       uint32_t onwire_len = rx_frame_asm.get_segment_onwire_len(seg_idx);
-      // TODO: create aligned and contiguous buffer from socket
-      return read_exactly<may_cross_core>(onwire_len
+      return read_exactly<may_cross_core>(onwire_len, alignment
       ).then([this](auto bptr) {
         logger().trace("{} RECV({}) frame segment[{}]",
                        conn, bptr.length(), rx_segments_data.size());
@@ -100,7 +100,8 @@ public:
    */
 
   template <bool may_cross_core = true>
-  seastar::future<ceph::bufferptr> read_exactly(std::size_t bytes);
+  seastar::future<ceph::bufferptr> read_exactly(
+      std::size_t bytes, std::size_t alignment = 0);
 
   template <bool may_cross_core = true>
   seastar::future<ceph::bufferlist> read(std::size_t bytes);
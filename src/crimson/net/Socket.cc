@@ -148,19 +148,28 @@ Socket::read(size_t bytes)
 }
 
 seastar::future<bufferptr>
-Socket::read_exactly(size_t bytes) {
+Socket::read_exactly(size_t bytes, size_t alignment) {
   assert(seastar::this_shard_id() == sid);
 #ifdef UNIT_TESTS_BUILT
-  return try_trap_pre(next_trap_read).then([bytes, this] {
+  return try_trap_pre(next_trap_read).then([bytes, alignment, this] {
 #endif
     if (bytes == 0) {
       return seastar::make_ready_future<bufferptr>();
     }
-    return in.read_exactly(bytes).then([bytes](auto buf) {
-      bufferptr ptr(buffer::create(buf.share()));
-      if (ptr.length() < bytes) {
+    return in.read_exactly(bytes).then([bytes, alignment](auto buf) {
+      if (buf.size() < bytes) {
         throw std::system_error(make_error_code(error::read_eof));
       }
+      bufferptr ptr;
+      if (alignment &&
+          reinterpret_cast<uintptr_t>(buf.get()) % alignment != 0) {
+        // copy once here so that the consumer (e.g. the store) can
+        // adopt the buffer as is instead of copying it again
+        ptr = buffer::create_aligned(bytes, alignment);
+        ptr.copy_in(0, bytes, buf.get());
+      } else {
+        ptr = bufferptr(buffer::create(buf.share()));
+      }
       inject_failure();
       return inject_delay(
       ).then([ptr = std::move(ptr)]() mutable {
@@ -72,7 +72,9 @@ public:
   /// read the requested number of bytes into a bufferlist
   seastar::future<bufferlist> read(size_t bytes);
 
-  seastar::future<bufferptr> read_exactly(size_t bytes);
+  /// read exactly the requested number of bytes, into a buffer aligned
+  /// to alignment if it's not 0
+  seastar::future<bufferptr> read_exactly(size_t bytes, size_t alignment = 0);
 
   seastar::future<> write(bufferlist);
 
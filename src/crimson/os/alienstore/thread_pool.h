@@ -8,6 +8,7 @@
 #include <type_traits>
 #include <boost/lockfree/queue.hpp>
 #include <boost/optional.hpp>
+#include <seastar/core/alien.hh>
 #include <seastar/core/future.hh>
 #include <seastar/core/gate.hh>
 #include <seastar/core/reactor.hh>
@@ -37,7 +38,9 @@ struct Task final : WorkItem {
   using futurator_t = seastar::futurize<T>;
 public:
   explicit Task(Func&& f)
-    : func(std::move(f))
+    : func(std::move(f)),
+      alien(seastar::engine().alien()),
+      shard(seastar::this_shard_id())
   {}
   void process() override {
     try {
@@ -50,10 +53,16 @@ public:
     } catch (...) {
       state.set_exception(std::current_exception());
     }
-    on_done.write_side().signal(1);
+    // the completion is queued to the reactor, which drains all of its
+    // pending alien messages at once when polling, instead of waking up
+    // on an eventfd for every single task. this task must not be touched
+    // once the message is queued.
+    seastar::alien::run_on(alien, shard, [this]() noexcept {
+      on_done.set_value();
+    });
   }
   typename futurator_t::type get_future() {
-    return on_done.wait().then([this](size_t) {
+    return on_done.get_future().then([this] {
       if (state.failed()) {
         return futurator_t::make_exception_future(state.get_exception());
       } else {
@@ -64,7 +73,9 @@ public:
 private:
   Func func;
   seastar::future_state<future_stored_type_t> state;
-  seastar::readable_eventfd on_done;
+  seastar::alien::instance& alien;
+  const unsigned shard;
+  seastar::promise<> on_done;
 };
 
 struct SubmitQueue {
@@ -119,8 +130,8 @@ public:
    *                 multiple of the number of cores.
    * @param n_threads the number of threads in this thread pool.
    * @param cpu the CPU core to which this thread pool is assigned
-   * @note each @c Task has its own crimson::thread::Condition, which possesses
-   * an fd, so we should keep the size of queue under a reasonable limit.
+   * @note each @c Task completes by queueing an alien message to the
+   * reactor that submitted it.
    */
   ThreadPool(size_t n_threads, size_t queue_sz, const std::optional<seastar::resource::cpuset>& cpus);
   ~ThreadPool();
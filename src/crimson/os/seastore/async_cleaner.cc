@@ -946,6 +946,10 @@ void SegmentCleaner::register_metrics()
 		     sm::description("rewritten bytes due to reclaim")),
     sm::make_counter("reclaimed_segment_bytes", stats.reclaimed_segment_bytes,
 		     sm::description("rewritten bytes due to reclaim")),
+    sm::make_counter("reclaim_cold_promoted_bytes",
+		     stats.reclaim_cold_promoted_bytes,
+		     sm::description("reclaimed bytes older than their segment, "
+				     "rewritten to a colder generation")),
     sm::make_counter("closed_journal_used_bytes", stats.closed_journal_used_bytes,
 		     sm::description("used bytes when close a journal segment")),
     sm::make_counter("closed_journal_total_bytes", stats.closed_journal_total_bytes,
@@ -1159,8 +1163,27 @@ SegmentCleaner::do_reclaim_space(
             [this, modify_time, &t, &reclaimed](auto ext)
           {
             reclaimed += ext->get_length();
+            // The segment modify_time is the average of its extents, keep
+            // the extent's own modify_time if it is known so that the age
+            // of the rewritten segment stays accurate for cost-benefit.
+            //
+            // An extent older than its peers is colder than the segment
+            // average, let it skip a generation so that it doesn't get
+            // mixed with data that is likely to be overwritten again.
+            auto ext_time = ext->get_modify_time();
+            auto target_gen = reclaim_state->target_generation;
+            if (ext_time == NULL_TIME) {
+              ext_time = modify_time;
+            } else if (ext_time < modify_time &&
+                       target_gen >= MIN_REWRITE_GENERATION &&
+                       target_gen + 1 < MIN_COLD_GENERATION) {
+              // don't cross into the cold tier, leave it to the eviction
+              // policy of the EPM
+              ++target_gen;
+              stats.reclaim_cold_promoted_bytes += ext->get_length();
+            }
             return extent_callback->rewrite_extent(
-                t, ext, reclaim_state->target_generation, modify_time);
+                t, ext, target_gen, ext_time);
           });
         });
       }).si_then([this, &t] {
@@ -1546,6 +1569,25 @@ void SegmentCleaner::mark_space_free(
         space_tracker->get_usage(seg_addr.get_segment_id()));
 }
 
+std::chrono::microseconds SegmentCleaner::get_clean_pace_delay() const
+{
+  assert(background_callback->is_ready());
+  if (config.max_clean_pace_delay.count() == 0) {
+    return std::chrono::microseconds(0);
+  }
+  auto aratio = get_projected_available_ratio();
+  if (aratio <= config.available_ratio_hard_limit) {
+    return std::chrono::microseconds(0);
+  }
+  // linearly shrink the delay as the available space drops from
+  // available_ratio_gc_max towards available_ratio_hard_limit
+  double pressure = (config.available_ratio_gc_max - aratio) /
+    (config.available_ratio_gc_max - config.available_ratio_hard_limit);
+  pressure = std::clamp(pressure, 0.0, 1.0);
+  return std::chrono::microseconds(static_cast<int64_t>(
+    config.max_clean_pace_delay.count() * (1 - pressure)));
+}
+
 segment_id_t SegmentCleaner::get_next_reclaim_segment() const
 {
   LOG_PREFIX(SegmentCleaner::get_next_reclaim_segment);
@@ -1170,6 +1170,11 @@ public:
 
   virtual std::size_t get_reclaim_size_per_cycle() const = 0;
 
+  // the delay to insert before the next clean_space() cycle so that
+  // background cleaning doesn't compete with client IOs while space
+  // pressure is still low, zero if it should proceed immediately.
+  virtual std::chrono::microseconds get_clean_pace_delay() const = 0;
+
 #ifdef UNIT_TESTS_BUILT
   virtual void prefill_fragmented_devices() {}
 #endif
@@ -1205,10 +1210,14 @@ public:
     double reclaim_ratio_gc_threshold = 0;
     /// Number of bytes to reclaim per cycle
     std::size_t reclaim_bytes_per_cycle = 0;
+    /// Maximum delay between reclaim cycles at available_ratio_gc_max,
+    /// shrinking linearly to 0 at available_ratio_hard_limit.
+    std::chrono::microseconds max_clean_pace_delay{0};
 
     void validate() const {
       ceph_assert(available_ratio_gc_max > available_ratio_hard_limit);
       ceph_assert(reclaim_bytes_per_cycle > 0);
+      ceph_assert(max_clean_pace_delay.count() >= 0);
     }
 
     static config_t get_default() {
@@ -1216,7 +1225,9 @@ public:
         .15,  // available_ratio_gc_max
         .1,   // available_ratio_hard_limit
         .1,   // reclaim_ratio_gc_threshold
-        1<<20 // reclaim_bytes_per_cycle
+        1<<20, // reclaim_bytes_per_cycle
+        std::chrono::microseconds(crimson::common::get_conf<uint64_t>(
+          "seastore_cleaner_max_pace_delay_us")) // max_clean_pace_delay
       };
     }
 
@@ -1225,7 +1236,8 @@ public:
         .99,  // available_ratio_gc_max
         .2,   // available_ratio_hard_limit
         .6,   // reclaim_ratio_gc_threshold
-        1<<20 // reclaim_bytes_per_cycle
+        1<<20, // reclaim_bytes_per_cycle
+        std::chrono::microseconds(0) // max_clean_pace_delay
       };
     }
   };
@@ -1366,6 +1378,8 @@ public:
     return config.reclaim_bytes_per_cycle;
   }
 
+  std::chrono::microseconds get_clean_pace_delay() const final;
+
   // Testing interfaces
 
   bool check_usage() final;
@@ -1599,6 +1613,7 @@ private:
     uint64_t reclaiming_bytes = 0;
     uint64_t reclaimed_bytes = 0;
     uint64_t reclaimed_segment_bytes = 0;
+    uint64_t reclaim_cold_promoted_bytes = 0;
 
     seastar::metrics::histogram segment_util;
   } stats;
@@ -1695,6 +1710,10 @@ public:
     return 0;
   }
 
+  std::chrono::microseconds get_clean_pace_delay() const final {
+    return std::chrono::microseconds(0);
+  }
+
 #ifdef UNIT_TESTS_BUILT
   void prefill_fragmented_devices() final {
     LOG_PREFIX(RBMCleaner::prefill_fragmented_devices);
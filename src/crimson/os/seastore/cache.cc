@@ -6,6 +6,7 @@
 #include <sstream>
 #include <string_view>
 
+#include <seastar/core/memory.hh>
 #include <seastar/core/metrics.hh>
 
 #include "crimson/os/seastore/logging.h"
@@ -37,11 +38,22 @@ std::ostream &operator<<(std::ostream &out, const backref_entry_t &ent) {
 	     << "}";
 }
 
+static size_t get_lru_capacity()
+{
+  auto ratio = crimson::common::get_conf<double>(
+    "seastore_cache_lru_memory_ratio");
+  if (ratio > 0) {
+    // a share of the memory of this shard
+    return seastar::memory::stats().total_memory() * ratio;
+  }
+  return crimson::common::get_conf<Option::size_t>(
+    "seastore_cache_lru_size");
+}
+
 Cache::Cache(
   ExtentPlacementManager &epm)
   : epm(epm),
-    lru(crimson::common::get_conf<Option::size_t>(
-	  "seastore_cache_lru_size"))
+    lru(get_lru_capacity())
 {
   LOG_PREFIX(Cache::Cache);
   INFO("created, lru_size={}", lru.get_capacity());
@@ -221,6 +233,25 @@ void Cache::register_metrics()
       }
     );
   }
+  for (auto& [ext, ext_label] : labels_by_ext) {
+    metrics.add_group(
+      "cache",
+      {
+        sm::make_counter(
+          "cache_access_by_extent",
+          get_by_ext(stats.cache_query_by_ext, ext).access,
+          sm::description("total number of cache accesses by extent type"),
+          {ext_label}
+        ),
+        sm::make_counter(
+          "cache_hit_by_extent",
+          get_by_ext(stats.cache_query_by_ext, ext).hit,
+          sm::description("total number of cache hits by extent type"),
+          {ext_label}
+        ),
+      }
+    );
+  }
 
   {
     /*
@@ -522,6 +553,34 @@ void Cache::register_metrics()
 	},
 	sm::description("total extents pinned by the lru")
       ),
+      sm::make_counter(
+	"cache_lru_probation_bytes",
+	[this] {
+	  return lru.get_current_contents_bytes(LRU::PROBATION);
+	},
+	sm::description("total bytes of object data on the lru probation list")
+      ),
+      sm::make_counter(
+	"cache_lru_data_bytes",
+	[this] {
+	  return lru.get_current_contents_bytes(LRU::DATA);
+	},
+	sm::description("total bytes of reused object data pinned by the lru")
+      ),
+      sm::make_counter(
+	"cache_lru_metadata_bytes",
+	[this] {
+	  return lru.get_current_contents_bytes(LRU::METADATA);
+	},
+	sm::description("total bytes of metadata leaf extents pinned by the lru")
+      ),
+      sm::make_counter(
+	"cache_lru_internal_bytes",
+	[this] {
+	  return lru.get_current_contents_bytes(LRU::INTERNAL);
+	},
+	sm::description("total bytes of tree internal nodes pinned by the lru")
+      ),
     }
   );
 
@@ -327,7 +327,7 @@ public:
     SUBDEBUGT(seastore_cache, "{} {} is present in cache -- {}",
               t, type, offset, *ret);
     t.add_to_read_set(ret);
-    touch_extent(*ret);
+    touch_extent(*ret, nullptr, t.get_trans_id());
     return ret->wait_io().then([ret] {
       return get_extent_if_cached_iertr::make_ready_future<
         CachedExtentRef>(ret);
@@ -371,7 +371,7 @@ public:
         });
       } else {
 	assert(!ret->is_mutable());
-	touch_extent(*ret);
+	touch_extent(*ret, nullptr, t.get_trans_id());
         SUBDEBUGT(seastore_cache, "{} {}~{} is present on t without been \
           fully loaded, reading ... {}", t, T::TYPE, offset, length, *ret);
         auto bp = alloc_cache_buf(ret->get_length());
@@ -384,7 +384,7 @@ public:
                 t, T::TYPE, offset, length);
       auto f = [&t, this](CachedExtent &ext) {
         t.add_to_read_set(CachedExtentRef(&ext));
-        touch_extent(ext);
+        touch_extent(ext, nullptr, t.get_trans_id());
       };
       auto metric_key = std::make_pair(t.get_src(), T::TYPE);
       return trans_intr::make_interruptible(
@@ -421,7 +421,7 @@ public:
 	      t, T::TYPE, offset, length);
     auto f = [&t, this](CachedExtent &ext) {
       t.add_to_read_set(CachedExtentRef(&ext));
-      touch_extent(ext);
+      touch_extent(ext, nullptr, t.get_trans_id());
     };
     auto metric_key = std::make_pair(t.get_src(), T::TYPE);
     return trans_intr::make_interruptible(
@@ -475,14 +475,14 @@ public:
     if (!p_extent->is_pending_in_trans(t.get_trans_id())) {
       t.add_to_read_set(p_extent);
       if (!p_extent->is_mutation_pending()) {
-	touch_extent(*p_extent);
+	touch_extent(*p_extent, nullptr, t.get_trans_id());
       }
     }
     // user should not see RETIRED_PLACEHOLDER extents
     ceph_assert(p_extent->get_type() != extent_types_t::RETIRED_PLACEHOLDER);
     if (!p_extent->is_fully_loaded()) {
       assert(!p_extent->is_mutable());
-      touch_extent(*p_extent);
+      touch_extent(*p_extent, nullptr, t.get_trans_id());
       LOG_PREFIX(Cache::get_extent_viewable_by_trans);
       SUBDEBUG(seastore_cache,
         "{} {}~{} is present without been fully loaded, reading ... -- {}",
@@ -679,7 +679,7 @@ private:
         });
       } else {
 	assert(!ret->is_mutable());
-	touch_extent(*ret);
+	touch_extent(*ret, nullptr, t.get_trans_id());
         SUBDEBUGT(seastore_cache, "{} {}~{} {} is present on t without been \
                   fully loaded, reading ...", t, type, offset, length, laddr);
         auto bp = alloc_cache_buf(ret->get_length());
@@ -692,7 +692,7 @@ private:
                 t, type, offset, length, laddr);
       auto f = [&t, this](CachedExtent &ext) {
 	t.add_to_read_set(CachedExtentRef(&ext));
-	touch_extent(ext);
+	touch_extent(ext, nullptr, t.get_trans_id());
       };
       auto src = t.get_src();
       return trans_intr::make_interruptible(
@@ -726,7 +726,7 @@ private:
 	      t, type, offset, length, laddr);
     auto f = [&t, this](CachedExtent &ext) {
       t.add_to_read_set(CachedExtentRef(&ext));
-      touch_extent(ext);
+      touch_extent(ext, nullptr, t.get_trans_id());
     };
     auto src = t.get_src();
     return trans_intr::make_interruptible(
@@ -1316,7 +1316,8 @@ private:
   /// Update lru for access to ref
   void touch_extent(
       CachedExtent &ext,
-      const Transaction::src_t* p_src=nullptr)
+      const Transaction::src_t* p_src=nullptr,
+      transaction_id_t tid=TRANS_ID_NULL)
   {
     if (p_src &&
 	is_background_transaction(*p_src) &&
@@ -1324,7 +1325,7 @@ private:
       return;
     }
     if (ext.is_stable_clean() && !ext.is_placeholder()) {
-      lru.move_to_top(ext);
+      lru.move_to_top(ext, tid);
     }
   }
 
@@ -1384,30 +1385,76 @@ private:
    * lru
    *
    * holds references to recently used extents
+   *
+   * Extents are kept on one of several lists by type, and evicted from
+   * the least valuable list first:
+   *  - PROBATION: object data touched by a single transaction so far, so
+   *    that a large sequential read only cycles this list.  It is
+   *    evicted first while it holds more than 1/8 of the capacity;
+   *  - DATA: object data touched again by another transaction;
+   *  - METADATA: onode, collection and leaf nodes of the lba, backref
+   *    and omap trees;
+   *  - INTERNAL: the inner nodes of those trees, evicted last since each
+   *    of them maps a large part of the tree below it.
    */
   class LRU {
+  public:
+    enum list_t : uint8_t {
+      PROBATION = 0,
+      DATA,
+      METADATA,
+      INTERNAL,
+      NUM_LISTS,
+    };
+
+  private:
     // max size (bytes)
     const size_t capacity = 0;
 
     // current size (bytes)
     size_t contents = 0;
 
-    CachedExtent::list lru;
+    std::array<CachedExtent::list, NUM_LISTS> lists;
+    std::array<size_t, NUM_LISTS> list_contents = {};
+
+    static list_t get_list(extent_types_t type, bool reused) {
+      switch (type) {
+      case extent_types_t::LADDR_INTERNAL:
+      case extent_types_t::BACKREF_INTERNAL:
+      case extent_types_t::OMAP_INNER:
+	return INTERNAL;
+      case extent_types_t::OBJECT_DATA_BLOCK:
+	return reused ? DATA : PROBATION;
+      default:
+	return METADATA;
+      }
+    }
 
     void trim_to_capacity() {
       while (contents > capacity) {
-	assert(lru.size() > 0);
-	remove_from_lru(lru.front());
+	unsigned victim = PROBATION;
+	if (list_contents[PROBATION] <= capacity / 8) {
+	  victim = DATA;
+	  while (lists[victim].empty()) {
+	    // PROBATION once more if that is all there is
+	    victim = (victim + 1) % NUM_LISTS;
+	  }
+	}
+	assert(lists[victim].size() > 0);
+	remove_from_lru(lists[victim].front());
       }
     }
 
-    void add_to_lru(CachedExtent &extent) {
+    void add_to_lru(CachedExtent &extent, bool reused) {
       assert(extent.is_stable_clean() && !extent.is_placeholder());
       
       if (!extent.primary_ref_list_hook.is_linked()) {
+	auto l = get_list(extent.get_type(), reused);
+	extent.lru_list = l;
 	contents += extent.get_length();
+	list_contents[l] += extent.get_length();
 	intrusive_ptr_add_ref(&extent);
-	lru.push_back(extent);
+	lists[l].push_back(extent);
       }
       trim_to_capacity();
     }
@@ -1423,38 +1470,67 @@ private:
       return contents;
     }
 
+    size_t get_current_contents_bytes(list_t l) const {
+      return list_contents[l];
+    }
+
     size_t get_current_contents_extents() const {
-      return lru.size();
+      size_t n = 0;
+      for (auto& l : lists) {
+	n += l.size();
+      }
+      return n;
     }
 
     void remove_from_lru(CachedExtent &extent) {
       assert(extent.is_stable_clean() && !extent.is_placeholder());
 
       if (extent.primary_ref_list_hook.is_linked()) {
-	lru.erase(lru.s_iterator_to(extent));
+	auto& l = lists[extent.lru_list];
+	l.erase(l.s_iterator_to(extent));
 	assert(contents >= extent.get_length());
+	assert(list_contents[extent.lru_list] >= extent.get_length());
 	contents -= extent.get_length();
+	list_contents[extent.lru_list] -= extent.get_length();
 	intrusive_ptr_release(&extent);
       }
     }
 
-    void move_to_top(CachedExtent &extent) {
+    void move_to_top(CachedExtent &extent, transaction_id_t tid) {
       assert(extent.is_stable_clean() && !extent.is_placeholder());
 
+      bool reused = false;
       if (extent.primary_ref_list_hook.is_linked()) {
-	lru.erase(lru.s_iterator_to(extent));
+	if (extent.lru_list == PROBATION) {
+	  // only a touch by another transaction moves it out of probation
+	  if (extent.lru_tid == TRANS_ID_NULL) {
+	    extent.lru_tid = tid;
+	  } else if (tid != TRANS_ID_NULL && tid != extent.lru_tid) {
+	    reused = true;
+	  }
+	} else {
+	  reused = true;
+	}
+	auto& l = lists[extent.lru_list];
+	l.erase(l.s_iterator_to(extent));
 	intrusive_ptr_release(&extent);
 	assert(contents >= extent.get_length());
+	assert(list_contents[extent.lru_list] >= extent.get_length());
 	contents -= extent.get_length();
+	list_contents[extent.lru_list] -= extent.get_length();
+      } else {
+	extent.lru_tid = tid;
       }
-      add_to_lru(extent);
+      add_to_lru(extent, reused);
     }
 
     void clear() {
       LOG_PREFIX(Cache::LRU::clear);
-      for (auto iter = lru.begin(); iter != lru.end();) {
-	SUBDEBUG(seastore_cache, "clearing {}", *iter);
-	remove_from_lru(*(iter++));
+      for (auto& l : lists) {
+	for (auto iter = l.begin(); iter != l.end();) {
+	  SUBDEBUG(seastore_cache, "clearing {}", *iter);
+	  remove_from_lru(*(iter++));
+	}
       }
     }
 
@@ -1524,6 +1600,7 @@ private:
     counter_by_src_t<commit_trans_efforts_t> committed_efforts_by_src;
     counter_by_src_t<invalid_trans_efforts_t> invalidated_efforts_by_src;
     counter_by_src_t<query_counters_t> cache_query_by_src;
+    counter_by_extent_t<query_counters_t> cache_query_by_ext;
     success_read_trans_efforts_t success_read_efforts;
     uint64_t dirty_bytes = 0;
 
@@ -1682,9 +1759,12 @@ private:
       paddr_t offset,
       const src_ext_t* p_metric_key) {
     query_counters_t* p_counters = nullptr;
+    query_counters_t* p_ext_counters = nullptr;
     if (p_metric_key) {
       p_counters = &get_by_src(stats.cache_query_by_src, p_metric_key->first);
       ++p_counters->access;
+      p_ext_counters = &get_by_ext(stats.cache_query_by_ext, p_metric_key->second);
+      ++p_ext_counters->access;
     }
     if (auto iter = extents.find_offset(offset);
         iter != extents.end()) {
@@ -1692,6 +1772,7 @@ private:
           // retired_placeholder is not really cached yet
           iter->get_type() != extent_types_t::RETIRED_PLACEHOLDER) {
         ++p_counters->hit;
+        ++p_ext_counters->hit;
       }
       return CachedExtentRef(&*iter);
     } else {
@@ -680,6 +680,11 @@ private:
     CachedExtent,
     primary_ref_list_member_options>;
 
+  /// Cache::LRU list the extent is on, valid while it is linked there
+  uint8_t lru_list = 0;
+  /// transaction that put the extent on the Cache::LRU probation list
+  transaction_id_t lru_tid = TRANS_ID_NULL;
+
   /**
    * dirty_from_or_retired_at
    *
@@ -179,6 +179,70 @@ SegmentedOolWriter::alloc_write_ool_extents(
   });
 }
 
+void ExtentPlacementManager::add_segmented_writers(
+    SegmentCleaner &cleaner,
+    rewrite_gen_t min_gen,
+    rewrite_gen_t end_gen,
+    std::size_t reserved_open_segments)
+{
+  LOG_PREFIX(ExtentPlacementManager::add_segmented_writers);
+  assert(min_gen < end_gen);
+  std::size_t max_open = 0;
+  for (auto *sm : cleaner.get_segment_manager_group()->get_segment_managers()) {
+    auto sm_max_open = sm->get_max_open_segments();
+    if (sm_max_open && (max_open == 0 || sm_max_open < max_open)) {
+      max_open = sm_max_open;
+    }
+  }
+
+  // By default, every generation writes DATA and METADATA extents into
+  // their own segments. If the devices cannot keep that many segments
+  // open (e.g. the open zone limits of zoned devices), let both
+  // categories share the segments of a generation first, then merge the
+  // coldest generations.
+  std::size_t num_gens = end_gen - min_gen;
+  bool share_md = false;
+  if (max_open) {
+    if (max_open <= reserved_open_segments) {
+      ERROR("open segment limit {} too low, {} reserved",
+            max_open, reserved_open_segments);
+      ceph_abort("not enough open segments");
+    }
+    auto avail = max_open - reserved_open_segments;
+    if (avail < 2 * num_gens) {
+      share_md = true;
+      num_gens = std::min(num_gens, avail);
+    }
+    INFO("generations [{}, {}) with max {} open segments, "
+         "{} reserved, {} writers, share_md={}",
+         rewrite_gen_printer_t{min_gen}, rewrite_gen_printer_t{end_gen},
+         max_open, reserved_open_segments, num_gens, share_md);
+  }
+
+  for (rewrite_gen_t gen = min_gen; gen < end_gen; ++gen) {
+    auto idx = generation_to_writer(gen);
+    if (gen < min_gen + num_gens) {
+      writer_refs.emplace_back(std::make_unique<SegmentedOolWriter>(
+            data_category_t::DATA, gen, cleaner,
+            *ool_segment_seq_allocator));
+      data_writers_by_gen[idx] = writer_refs.back().get();
+    } else {
+      data_writers_by_gen[idx] = data_writers_by_gen[idx - 1];
+    }
+  }
+  for (rewrite_gen_t gen = min_gen; gen < end_gen; ++gen) {
+    auto idx = generation_to_writer(gen);
+    if (share_md) {
+      md_writers_by_gen[idx] = data_writers_by_gen[idx];
+    } else {
+      writer_refs.emplace_back(std::make_unique<SegmentedOolWriter>(
+            data_category_t::METADATA, gen, cleaner,
+            *ool_segment_seq_allocator));
+      md_writers_by_gen[idx] = writer_refs.back().get();
+    }
+  }
+}
+
 void ExtentPlacementManager::init(
     JournalTrimmerImplRef &&trimmer,
     AsyncCleanerRef &&cleaner,
@@ -197,20 +261,10 @@ void ExtentPlacementManager::init(
     auto num_writers = generation_to_writer(dynamic_max_rewrite_generation + 1);
 
     data_writers_by_gen.resize(num_writers, nullptr);
-    for (rewrite_gen_t gen = OOL_GENERATION; gen < MIN_COLD_GENERATION; ++gen) {
-      writer_refs.emplace_back(std::make_unique<SegmentedOolWriter>(
-	    data_category_t::DATA, gen, *segment_cleaner,
-            *ool_segment_seq_allocator));
-      data_writers_by_gen[generation_to_writer(gen)] = writer_refs.back().get();
-    }
-
     md_writers_by_gen.resize(num_writers, {});
-    for (rewrite_gen_t gen = OOL_GENERATION; gen < MIN_COLD_GENERATION; ++gen) {
-      writer_refs.emplace_back(std::make_unique<SegmentedOolWriter>(
-	    data_category_t::METADATA, gen, *segment_cleaner,
-            *ool_segment_seq_allocator));
-      md_writers_by_gen[generation_to_writer(gen)] = writer_refs.back().get();
-    }
+    // the journal keeps a segment open in the main tier
+    add_segmented_writers(*segment_cleaner, OOL_GENERATION,
+                          MIN_COLD_GENERATION, 1);
 
     for (auto *device : segment_cleaner->get_segment_manager_group()
 				       ->get_segment_managers()) {
@@ -234,18 +288,8 @@ void ExtentPlacementManager::init(
   }
 
   if (cold_segment_cleaner) {
-    for (rewrite_gen_t gen = MIN_COLD_GENERATION; gen < REWRITE_GENERATIONS; ++gen) {
-      writer_refs.emplace_back(std::make_unique<SegmentedOolWriter>(
-            data_category_t::DATA, gen, *cold_segment_cleaner,
-            *ool_segment_seq_allocator));
-      data_writers_by_gen[generation_to_writer(gen)] = writer_refs.back().get();
-    }
-    for (rewrite_gen_t gen = MIN_COLD_GENERATION; gen < REWRITE_GENERATIONS; ++gen) {
-      writer_refs.emplace_back(std::make_unique<SegmentedOolWriter>(
-            data_category_t::METADATA, gen, *cold_segment_cleaner,
-            *ool_segment_seq_allocator));
-      md_writers_by_gen[generation_to_writer(gen)] = writer_refs.back().get();
-    }
+    add_segmented_writers(*cold_segment_cleaner, MIN_COLD_GENERATION,
+                          REWRITE_GENERATIONS, 0);
     for (auto *device : cold_segment_cleaner->get_segment_manager_group()
                                             ->get_segment_managers()) {
       add_device(device);
@@ -431,18 +475,9 @@ ExtentPlacementManager::open_for_write()
   LOG_PREFIX(ExtentPlacementManager::open_for_write);
   INFO("started with {} devices", num_devices);
   ceph_assert(primary_device != nullptr);
-  return crimson::do_for_each(data_writers_by_gen, [](auto &writer) {
-    if (writer) {
-      return writer->open();
-    }
-    return open_ertr::now();
-  }).safe_then([this] {
-    return crimson::do_for_each(md_writers_by_gen, [](auto &writer) {
-      if (writer) {
-	return writer->open();
-      }
-      return open_ertr::now();
-    });
+  // writers may be shared by generations and categories
+  return crimson::do_for_each(writer_refs, [](auto &writer) {
+    return writer->open();
   });
 }
 
@@ -534,18 +569,8 @@ ExtentPlacementManager::close()
 {
   LOG_PREFIX(ExtentPlacementManager::close);
   INFO("started");
-  return crimson::do_for_each(data_writers_by_gen, [](auto &writer) {
-    if (writer) {
-      return writer->close();
-    }
-    return close_ertr::now();
-  }).safe_then([this] {
-    return crimson::do_for_each(md_writers_by_gen, [](auto &writer) {
-      if (writer) {
-	return writer->close();
-      }
-      return close_ertr::now();
-    });
+  return crimson::do_for_each(writer_refs, [](auto &writer) {
+    return writer->close();
   });
 }
 
@@ -680,6 +705,10 @@ ExtentPlacementManager::BackgroundProcess::reserve_projected_usage(
     stats.io_blocked_sum += stats.io_blocking_num;
 
     blocking_io = seastar::promise<>();
+    // don't keep the blocked IO waiting for a paced cycle
+    if (pace_timer.armed()) {
+      do_wake_background();
+    }
     return blocking_io->get_future(
     ).then([this, usage, FNAME] {
       return seastar::repeat([this, usage, FNAME] {
@@ -736,9 +765,24 @@ ExtentPlacementManager::BackgroundProcess::run()
     }
     return seastar::futurize_invoke([this] {
       if (background_should_run()) {
+        if (!clean_paced) {
+          auto delay = get_clean_pace_delay();
+          if (delay.count() > 0) {
+            log_state("run(pace)");
+            ++stats.clean_paced_count;
+            clean_paced = true;
+            ceph_assert(!blocking_background);
+            blocking_background = seastar::promise<>();
+            pace_timer.set_callback([this] { do_wake_background(); });
+            pace_timer.arm(delay);
+            return blocking_background->get_future();
+          }
+        }
+        clean_paced = false;
         log_state("run(background)");
         return do_background_cycle();
       } else {
+        clean_paced = false;
         log_state("run(block)");
         ceph_assert(!blocking_background);
         blocking_background = seastar::promise<>();
@@ -973,7 +1017,9 @@ void ExtentPlacementManager::BackgroundProcess::register_metrics()
     sm::make_counter("io_blocked_count_clean", stats.io_blocked_count_clean,
                      sm::description("IOs that are blocked by cleaning")),
     sm::make_counter("io_blocked_sum", stats.io_blocked_sum,
-                     sm::description("the sum of blocking IOs"))
+                     sm::description("the sum of blocking IOs")),
+    sm::make_counter("clean_paced_count", stats.clean_paced_count,
+                     sm::description("cleaning cycles delayed to smooth IO latency"))
   });
 }
 
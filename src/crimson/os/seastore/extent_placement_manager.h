@@ -5,6 +5,7 @@
 
 #include <seastar/core/gate.hh>
 #include <seastar/core/lowres_clock.hh>
+#include <seastar/core/timer.hh>
 
 #include "crimson/os/seastore/async_cleaner.h"
 #include "crimson/os/seastore/cached_extent.h"
@@ -597,6 +598,14 @@ private:
     return gen;
   }
 
+  // create the writers of generations [min_gen, end_gen) to the cleaner,
+  // within the open segment limit of its devices
+  void add_segmented_writers(
+    SegmentCleaner &cleaner,
+    rewrite_gen_t min_gen,
+    rewrite_gen_t end_gen,
+    std::size_t reserved_open_segments);
+
   void add_device(Device *device) {
     auto device_id = device->get_device_id();
     ceph_assert(devices_by_id[device_id] == nullptr);
@@ -838,7 +847,7 @@ private:
     }
 
     void maybe_wake_background() final {
-      if (!is_running()) {
+      if (!is_running() || pace_timer.armed()) {
         return;
       }
       if (background_should_run()) {
@@ -876,12 +885,36 @@ private:
     seastar::future<> run();
 
     void do_wake_background() {
+      pace_timer.cancel();
       if (blocking_background) {
 	blocking_background->set_value();
 	blocking_background = std::nullopt;
       }
     }
 
+    // The cleaners may ask to pace reclaiming while space pressure is low
+    // so that client IOs see a smooth latency, see
+    // AsyncCleaner::get_clean_pace_delay().  No pacing while trimming or
+    // when IOs are or are about to be blocked.
+    std::chrono::microseconds get_clean_pace_delay() const {
+      std::chrono::microseconds delay(0);
+      if (trimmer->should_trim() ||
+          should_block_io() ||
+          blocking_io ||
+          main_cleaner_should_fast_evict()) {
+        return delay;
+      }
+      bool clean_main = main_cleaner->should_clean_space();
+      if (clean_main) {
+        delay = main_cleaner->get_clean_pace_delay();
+      }
+      if (cold_cleaner_should_run()) {
+        auto cold_delay = cold_cleaner->get_clean_pace_delay();
+        delay = clean_main ? std::min(delay, cold_delay) : cold_delay;
+      }
+      return delay;
+    }
+
     // background_should_run() should be atomic with do_background_cycle()
     // to make sure the condition is consistent.
     bool background_should_run() {
@@ -1046,6 +1079,7 @@ private:
       uint64_t io_blocked_count_trim = 0;
       uint64_t io_blocked_count_clean = 0;
       uint64_t io_blocked_sum = 0;
+      uint64_t clean_paced_count = 0;
     } stats;
     seastar::metrics::metric_group metrics;
 
@@ -1061,6 +1095,9 @@ private:
     std::optional<seastar::future<>> process_join;
     std::optional<seastar::promise<>> blocking_background;
     std::optional<seastar::promise<>> blocking_io;
+    seastar::timer<seastar::lowres_clock> pace_timer;
+    // the last background cycle has been paced, proceed with the next one
+    bool clean_paced = false;
     bool is_running_until_halt = false;
     state_t state = state_t::STOP;
     eviction_state_t eviction_state;
@@ -6,6 +6,7 @@
 #include <fmt/format.h>
 #include <fmt/os.h>
 
+#include "crimson/common/config_proxy.h"
 #include "crimson/os/seastore/logging.h"
 #include "crimson/os/seastore/async_cleaner.h"
 
@@ -129,14 +130,16 @@ RecordSubmitter::RecordSubmitter(
   JournalAllocator& ja)
   : io_depth_limit{io_depth},
     preferred_fullness{preferred_fullness},
+    adaptive{crimson::common::get_conf<bool>(
+      "seastore_journal_batch_adaptive")},
     journal_allocator{ja},
     batches(new RecordBatch[io_depth + 1])
 {
   LOG_PREFIX(RecordSubmitter);
   INFO("{} io_depth_limit={}, batch_capacity={}, batch_flush_size={}, "
-       "preferred_fullness={}",
+       "preferred_fullness={}, adaptive={}",
        get_name(), io_depth, batch_capacity,
-       batch_flush_size, preferred_fullness);
+       batch_flush_size, preferred_fullness, adaptive);
   ceph_assert(io_depth > 0);
   ceph_assert(batch_capacity > 0);
   ceph_assert(preferred_fullness >= 0 &&
@@ -287,7 +290,7 @@ RecordSubmitter::submit(
   auto eval = p_current_batch->evaluate_submit(
       record.size, journal_allocator.get_block_size());
   bool needs_flush = (
-      state == state_t::IDLE ||
+      should_flush_early() ||
       eval.submit_size.get_fullness() > preferred_fullness ||
       // RecordBatch::needs_flush()
       eval.is_full ||
@@ -312,7 +315,10 @@ RecordSubmitter::submit(
     DEBUG("{} fast submit {}, committed_to={}, outstanding_io={} ...",
           get_name(), sizes, get_committed_to(), num_outstanding_io);
     return journal_allocator.write(std::move(to_write)
-    ).safe_then([mdlength = sizes.get_mdlength()](auto write_result) {
+    ).safe_then([this, mdlength = sizes.get_mdlength(),
+                 depth = num_outstanding_io,
+                 start = clock_t::now()](auto write_result) {
+      account_write(depth, 1, start);
       return record_locator_t{
         write_result.start_seq.offset.add_offset(mdlength),
         write_result
@@ -373,6 +379,8 @@ RecordSubmitter::open(bool is_mkfs)
     DEBUG("{} register metrics", get_name());
     stats = {};
     last_stats = {};
+    batch_records_hist = {};
+    write_latency_hist = {};
     namespace sm = seastar::metrics;
     std::vector<sm::label_instance> label_instances;
     label_instances.push_back(sm::label_instance("submitter", get_name()));
@@ -415,6 +423,24 @@ RecordSubmitter::open(bool is_mkfs)
           sm::description("bytes of data when write record groups"),
           label_instances
         ),
+        sm::make_histogram(
+          "io_records",
+          [this] { return batch_records_hist.get(); },
+          sm::description("number of records written per io"),
+          label_instances
+        ),
+        sm::make_histogram(
+          "io_latency_us",
+          [this] { return write_latency_hist.get(); },
+          sm::description("latency of journal writes in microseconds"),
+          label_instances
+        ),
+        sm::make_gauge(
+          "flush_depth",
+          [this] { return flush_depth; },
+          sm::description("io depth below which batches are flushed right away"),
+          label_instances
+        ),
       }
     );
     return ret;
@@ -473,7 +499,7 @@ void RecordSubmitter::decrement_io_with_flush()
 
   auto needs_flush = (
       !p_current_batch->is_empty() && (
-        state == state_t::IDLE ||
+        should_flush_early() ||
         p_current_batch->get_submit_size().get_fullness() > preferred_fullness ||
         p_current_batch->needs_flush()
       ));
@@ -502,6 +528,45 @@ void RecordSubmitter::account_submission(
   }
 }
 
+void RecordSubmitter::account_write(
+  std::size_t depth,
+  std::size_t num_records,
+  clock_t::time_point start)
+{
+  LOG_PREFIX(RecordSubmitter::account_write);
+  auto lat = std::chrono::duration_cast<std::chrono::microseconds>(
+    clock_t::now() - start).count();
+  batch_records_hist.add(num_records);
+  write_latency_hist.add(lat);
+  if (!adaptive) {
+    return;
+  }
+
+  constexpr double alpha = 1.0 / 16;
+  auto update = [alpha, lat](double& avg) {
+    avg = avg == 0 ? lat : avg + alpha * (lat - avg);
+  };
+  if (depth == 1) {
+    update(base_latency_us);
+  }
+  update(latency_us);
+  if (base_latency_us == 0 || depth < flush_depth) {
+    return;
+  }
+  // go deeper while the device keeps up, back off once writes queue up
+  auto prv_flush_depth = flush_depth;
+  if (latency_us < base_latency_us * 1.5 && flush_depth < io_depth_limit) {
+    ++flush_depth;
+  } else if (latency_us > base_latency_us * 2 && flush_depth > 1) {
+    --flush_depth;
+  }
+  if (flush_depth != prv_flush_depth) {
+    DEBUG("{} flush_depth {} -> {}, latency {}us, base {}us",
+          get_name(), prv_flush_depth, flush_depth,
+          latency_us, base_latency_us);
+  }
+}
+
 void RecordSubmitter::finish_submit_batch(
   RecordBatch* p_batch,
   maybe_result_t maybe_result)
@@ -534,9 +599,12 @@ void RecordSubmitter::flush_current_batch()
   DEBUG("{} {} records, {}, committed_to={}, outstanding_io={} ...",
         get_name(), num, sizes, get_committed_to(), num_outstanding_io);
   std::ignore = journal_allocator.write(std::move(to_write)
-  ).safe_then([this, p_batch, FNAME, num, sizes](auto write_result) {
+  ).safe_then([this, p_batch, FNAME, num, sizes,
+               depth = num_outstanding_io,
+               start = clock_t::now()](auto write_result) {
     TRACE("{} {} records, {}, write done with {}",
           get_name(), num, sizes, write_result);
+    account_write(depth, num, start);
     finish_submit_batch(p_batch, write_result);
   }).handle_error(
     crimson::ct_error::all_same_way([this, p_batch, FNAME, num, sizes](auto e) {
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>
 #include <optional>
 #include <seastar/core/circular_buffer.hh>
 #include <seastar/core/metrics.hh>
@@ -201,6 +203,44 @@ private:
   std::optional<seastar::shared_promise<maybe_promise_result_t> > io_promise;
 };
 
+/**
+ * log2_histogram_t
+ *
+ * Samples counted in power-of-two buckets, exported as a seastar
+ * histogram.
+ */
+struct log2_histogram_t {
+  static constexpr std::size_t NUM_BUCKETS = 24;
+
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  std::array<uint64_t, NUM_BUCKETS> buckets = {};
+
+  void add(uint64_t v) {
+    ++count;
+    sum += v;
+    std::size_t i = 0;
+    while (i < NUM_BUCKETS - 1 && (1ull << i) < v) {
+      ++i;
+    }
+    ++buckets[i];
+  }
+
+  seastar::metrics::histogram get() const {
+    seastar::metrics::histogram h;
+    h.sample_count = count;
+    h.sample_sum = sum;
+    h.buckets.resize(NUM_BUCKETS);
+    uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < NUM_BUCKETS; ++i) {
+      cumulative += buckets[i];
+      h.buckets[i].count = cumulative;
+      h.buckets[i].upper_bound = 1ull << i;
+    }
+    return h;
+  }
+};
+
 /**
  * RecordSubmitter
  *
@@ -212,6 +252,9 @@ private:
  * - batch_flush_size: the bytes threshold to force flush a RecordBatch to
  *   control the maximum latency;
  * - preferred_fullness: the fullness threshold to flush a RecordBatch;
+ * - adaptive: whether to adapt flush_depth, the io depth below which a
+ *   RecordBatch is flushed without waiting for outstanding writes, to the
+ *   write latency observed (otherwise it is 1, i.e. only when idle).
  */
 class RecordSubmitter {
   enum class state_t {
@@ -310,11 +353,29 @@ private:
 
   void flush_current_batch();
 
+  using clock_t = std::chrono::steady_clock;
+  // account a finished write of num_records submitted at io depth
+  void account_write(std::size_t depth, std::size_t num_records,
+                     clock_t::time_point start);
+
+  // whether to flush without waiting for outstanding writes to finish
+  bool should_flush_early() const {
+    return num_outstanding_io < flush_depth;
+  }
+
   state_t state = state_t::IDLE;
   std::size_t num_outstanding_io = 0;
   std::size_t io_depth_limit;
   double preferred_fullness;
 
+  const bool adaptive;
+  std::size_t flush_depth = 1;
+  // moving averages of the write latency (us), at io depth 1 and overall
+  double base_latency_us = 0;
+  double latency_us = 0;
+  log2_histogram_t batch_records_hist;
+  log2_histogram_t write_latency_hist;
+
   JournalAllocator& journal_allocator;
   // committed_to may be in a previous journal segment
   journal_seq_t committed_to = JOURNAL_SEQ_NULL;
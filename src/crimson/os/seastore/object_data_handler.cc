@@ -543,7 +543,18 @@ ObjectDataHandler::write_ret do_insertions(
                 extent->get_laddr(),
                 off);
             }
-            iter.copy(extent->get_length(), extent->get_bptr().c_str());
+            // adopt the buffer if it is contiguous and aligned (see the
+            // aligned data segments of crimson/net), copy it otherwise
+            auto cur = iter.get_current_ptr();
+            if (cur.length() >= extent->get_length() &&
+                is_aligned(reinterpret_cast<uintptr_t>(cur.c_str()),
+                           CEPH_PAGE_SIZE)) {
+              extent->adopt_bptr(
+                ceph::bufferptr(cur, 0, extent->get_length()));
+              iter += extent->get_length();
+            } else {
+              iter.copy(extent->get_length(), extent->get_bptr().c_str());
+            }
             off += extent->get_length();
             left -= extent->get_length();
           }
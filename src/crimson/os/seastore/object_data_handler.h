@@ -144,6 +144,15 @@ struct ObjectDataBlock : crimson::os::seastore::LogicalCachedExtent {
     delta.clear();
   }
 
+  /// use bp, e.g. as received from the messenger, as the content of this
+  /// fresh extent instead of copying it
+  void adopt_bptr(ceph::bufferptr &&bp) {
+    assert(is_initial_pending());
+    assert(bp.length() == get_length());
+    assert(cached_overwrites.is_empty());
+    set_bptr(std::move(bp));
+  }
+
   bufferptr &get_bptr() override {
     if (cached_overwrites.is_empty()) {
       return CachedExtent::get_bptr();
@@ -3,8 +3,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <string_view>
 
 #include "include/byteorder.h"
 #include "include/denc.h"
@@ -84,6 +86,27 @@ static void copy_from_local(
           to_src->get_node_key_ptr() - from_src->get_node_key_ptr());
 }
 
+/**
+ * get_shortest_separator
+ *
+ * Returns the shortest prefix of upper that is greater than lower, so
+ * that lower < separator <= upper.  Used as the pivot of split leaf
+ * nodes: keys sharing long prefixes (bucket index, object maps...) only
+ * need to be kept up to the first differing byte in the inner nodes,
+ * which increases their fanout.
+ *
+ * precondition: lower < upper
+ */
+inline std::string get_shortest_separator(
+  std::string_view lower,
+  std::string_view upper) {
+  assert(lower < upper);
+  auto [lmis, umis] = std::mismatch(
+    lower.begin(), lower.end(), upper.begin(), upper.end());
+  assert(umis != upper.end());
+  return std::string(upper.begin(), umis + 1);
+}
+
 struct delta_inner_t {
   enum class op_t : uint_fast8_t {
     INSERT,
@@ -450,6 +473,12 @@ public:
 	get_node_key().key_len);
     }
 
+    std::string_view get_key_view() const {
+      return std::string_view(
+	get_node_val_ptr(),
+	get_node_key().key_len);
+    }
+
     laddr_t get_val() const {
       return get_node_key().laddr;
     }
@@ -565,7 +594,7 @@ public:
                                str,
                                [this](uint16_t i, std::string_view str) {
                                  const_iterator iter(this, i);
-                                 return iter->get_key() < str;
+                                 return iter->get_key_view() < str;
                                });
     return const_iterator(this, *it);
   }
@@ -581,7 +610,7 @@ public:
                                str,
                                [this](std::string_view str, uint16_t i) {
                                  const_iterator iter(this, i);
-                                 return str < iter->get_key();
+                                 return str < iter->get_key_view();
                                });
     return const_iterator(this, *it);
   }
@@ -592,11 +621,9 @@ public:
   }
 
   const_iterator find_string_key(std::string_view str) const {
-    auto ret = iter_begin();
-    for (; ret != iter_end(); ++ret) {
-     std::string s = ret->get_key();
-      if (s == str)
-        break;
+    auto ret = string_lower_bound(str);
+    if (ret != iter_end() && ret->get_key_view() != str) {
+      return iter_end();
     }
     return ret;
   }
@@ -1062,6 +1089,12 @@ public:
 	get_node_key().key_len);
     }
 
+    std::string_view get_key_view() const {
+      return std::string_view(
+	get_node_val_ptr(),
+	get_node_key().key_len);
+    }
+
     std::string get_str_val() const {
       auto node_key = get_node_key();
       return std::string(
@@ -1158,7 +1191,7 @@ public:
     while (start != end) {
       unsigned mid = (start + end) / 2;
       const_iterator iter(this, mid);
-      std::string s = iter->get_key();
+      auto s = iter->get_key_view();
       if (s < str) {
         start = ++mid;
       } else if (s > str) {
@@ -1176,11 +1209,9 @@ public:
   }
 
   const_iterator string_upper_bound(std::string_view str) const {
-    auto ret = iter_begin();
-    for (; ret != iter_end(); ++ret) {
-      std::string s = ret->get_key();
-      if (s > str)
-        break;
+    auto ret = string_lower_bound(str);
+    if (ret != iter_end() && ret->get_key_view() == str) {
+      ++ret;
     }
     return ret;
   }
@@ -1191,11 +1222,9 @@ public:
   }
 
   const_iterator find_string_key(std::string_view str) const {
-    auto ret = iter_begin();
-    for (; ret != iter_end(); ++ret) {
-      std::string s = ret->get_key();
-      if (s == str)
-        break;
+    auto ret = string_lower_bound(str);
+    if (ret != iter_end() && ret->get_key_view() != str) {
+      return iter_end();
     }
     return ret;
   }
@@ -1320,7 +1349,11 @@ public:
     left.set_meta(lmeta);
     right.set_meta(rmeta);
 
-    return piviter->get_key();
+    if (piviter == iter_begin()) {
+      return piviter->get_key();
+    }
+    return get_shortest_separator(
+      (piviter - 1)->get_key_view(), piviter->get_key_view());
   }
 
   /**
@@ -1388,9 +1421,14 @@ public:
       }
     }
 
-    auto replacement_pivot = pivot_idx >= left.get_size() ?
-      right.iter_idx(pivot_idx - left.get_size())->get_key() :
-      left.iter_idx(pivot_idx)->get_key();
+    auto key_at = [&left, &right](uint32_t idx) {
+      return idx >= left.get_size() ?
+        right.iter_idx(idx - left.get_size())->get_key_view() :
+        left.iter_idx(idx)->get_key_view();
+    };
+    auto replacement_pivot = pivot_idx == 0 ?
+      std::string(key_at(pivot_idx)) :
+      get_shortest_separator(key_at(pivot_idx - 1), key_at(pivot_idx));
 
     if (pivot_size < left_size) {
       copy_from_foreign(
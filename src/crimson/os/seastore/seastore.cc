@@ -554,14 +554,34 @@ seastar::future<store_statfs_t> SeaStore::stat() const
   DEBUG("");
   return shard_stores.map_reduce0(
     [](const SeaStore::Shard &local_store) {
-      return local_store.stat();
+      return std::vector<store_statfs_t>{local_store.stat()};
     },
-    store_statfs_t(),
-    [](auto &&ss, auto &&ret) {
-      ss.add(ret);
-      return std::move(ss);
+    std::vector<store_statfs_t>(),
+    [](auto &&shard_stats, auto &&ret) {
+      shard_stats.insert(shard_stats.end(), ret.begin(), ret.end());
+      return std::move(shard_stats);
+    }
+  ).then([FNAME](std::vector<store_statfs_t> shard_stats) {
+    store_statfs_t ss;
+    double min_available_ratio = 1;
+    for (auto &shard_ss : shard_stats) {
+      ss.add(shard_ss);
+      if (shard_ss.total) {
+        min_available_ratio = std::min(
+          min_available_ratio,
+          (double)shard_ss.available / shard_ss.total);
+      }
+    }
+    // Each shard allocates from its own partition of the devices and
+    // the objects of a PG cannot move to another shard, so the store is
+    // full once its fullest shard is. Report the available space as
+    // seen from that shard so that the OSD full ratios hold per shard.
+    auto available = static_cast<uint64_t>(ss.total * min_available_ratio);
+    if (available < ss.available) {
+      DEBUG("available {} of the shards, {} from the fullest shard",
+            ss.available, available);
+      ss.available = available;
     }
-  ).then([](store_statfs_t ss) {
     return seastar::make_ready_future<store_statfs_t>(std::move(ss));
   });
 }
@@ -195,6 +195,15 @@ public:
     return ((device_segment_id_t)(get_available_size() / get_segment_size()));
   }
 
+  /*
+   * Maximum number of segments the local shard may keep open for write
+   * at the same time, 0 if unlimited.  Zoned devices bound the number of
+   * open and active zones.
+   */
+  virtual std::size_t get_max_open_segments() const {
+    return 0;
+  }
+
   virtual ~SegmentManager() {}
 
   static seastar::future<SegmentManagerRef>
@@ -5,6 +5,9 @@
 #include <string.h>
 #include <linux/blkzoned.h>
 
+#include <filesystem>
+#include <fstream>
+
 #include <fmt/format.h>
 #include "crimson/os/seastore/segment_manager/zbd.h"
 #include "crimson/common/config_proxy.h"
@@ -409,6 +412,52 @@ ZBDSegmentManager::mount_ret ZBDSegmentManager::mount()
   });
 }
 
+// read a zone limit of the block device from sysfs, 0 if unknown or
+// unlimited
+static size_t read_zone_limit(
+  const std::string &path,
+  const char *name)
+{
+  std::error_code ec;
+  auto dev = std::filesystem::canonical(path, ec);
+  if (ec) {
+    return 0;
+  }
+  std::ifstream f(fmt::format("/sys/block/{}/queue/{}",
+			      dev.filename().string(), name));
+  size_t limit = 0;
+  if (!(f >> limit)) {
+    return 0;
+  }
+  return limit;
+}
+
+void ZBDSegmentManager::init_zone_limits()
+{
+  LOG_PREFIX(ZBDSegmentManager::init_zone_limits);
+  size_t limit = crimson::common::get_conf<uint64_t>(
+    "seastore_zbd_max_open_zones");
+  if (limit == 0) {
+    // a zone being written is both open and active, honor the lower one
+    auto max_open = read_zone_limit(device_path, "max_open_zones");
+    auto max_active = read_zone_limit(device_path, "max_active_zones");
+    if (max_open && max_active) {
+      limit = std::min(max_open, max_active);
+    } else {
+      limit = std::max(max_open, max_active);
+    }
+  }
+  // every shard writes its own segments, split the zones evenly
+  max_open_segments = limit / seastar::smp::count;
+  if (limit && max_open_segments == 0) {
+    ERROR("{} open zones cannot be shared by {} shards",
+	  limit, seastar::smp::count);
+    ceph_abort("not enough open zones");
+  }
+  INFO("device {} open zone limit {}, per shard {}",
+       device_path, limit, max_open_segments);
+}
+
 ZBDSegmentManager::mount_ret ZBDSegmentManager::shard_mount()
 {
   return open_device(
@@ -420,6 +469,7 @@ ZBDSegmentManager::mount_ret ZBDSegmentManager::shard_mount()
   }).safe_then([=, this](auto meta){
     shard_info = meta.shard_infos[seastar::this_shard_id()];
     metadata = meta;
+    init_zone_limits();
     return mount_ertr::now();
   });
 }
@@ -599,6 +649,12 @@ ZBDSegmentManager::open_ertr::future<SegmentRef> ZBDSegmentManager::open(
   segment_id_t id)
 {
   LOG_PREFIX(ZBDSegmentManager::open);
+  if (max_open_segments && open_segments >= max_open_segments) {
+    // exceeding the limit fails the write with an IO error from the device
+    ERROR("segment {}, already {} open segments, limit {}",
+	  id, open_segments, max_open_segments);
+    return crimson::ct_error::input_output_error::make();
+  }
   return seastar::do_with(
     blk_zone_range{},
     [=, this](auto &range) {
@@ -614,6 +670,8 @@ ZBDSegmentManager::open_ertr::future<SegmentRef> ZBDSegmentManager::open(
     }
   ).safe_then([=, this] {
     DEBUG("segment {}, open successful", id);
+    ++open_segments;
+    ++stats.opened_segments;
     return open_ertr::future<SegmentRef>(
       open_ertr::ready_future_marker{},
       SegmentRef(new ZBDSegment(*this, id))
@@ -688,8 +746,13 @@ Segment::close_ertr::future<> ZBDSegmentManager::segment_close(
 	zone_op::FINISH
       );
     }
-  ).safe_then([=] {
+  ).safe_then([=, this] {
     DEBUG("zone finish successful");
+    assert(open_segments > 0);
+    --open_segments;
+    ++stats.closed_segments;
+    stats.closed_segments_unused_bytes +=
+      metadata.segment_capacity - write_pointer;
     return Segment::close_ertr::now();
   });
 }
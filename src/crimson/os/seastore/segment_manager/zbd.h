@@ -177,6 +177,10 @@ namespace crimson::os::seastore::segment_manager::zbd {
 
     magic_t get_magic() const final;
 
+    std::size_t get_max_open_segments() const final {
+      return max_open_segments;
+    }
+
     Segment::write_ertr::future<> segment_write(
     paddr_t addr,
     ceph::bufferlist bl,
@@ -189,6 +193,9 @@ namespace crimson::os::seastore::segment_manager::zbd {
     zbd_sm_metadata_t metadata;
     seastar::file device;
     uint32_t nr_zones;
+    // per-shard share of the device open/active zone limits, 0 if unlimited
+    std::size_t max_open_segments = 0;
+    std::size_t open_segments = 0;
     struct effort_t {
       uint64_t num = 0;
       uint64_t bytes = 0;
@@ -233,6 +240,8 @@ namespace crimson::os::seastore::segment_manager::zbd {
 
     mount_ret shard_mount();
 
+    void init_zone_limits();
+
     seastar::sharded<ZBDSegmentManager> shard_devices;
   };
 
@@ -12,6 +12,27 @@ using std::make_pair;
 
 namespace crimson::osd {
 
+core_id_t PGShardMapping::choose_core(int64_t pool) const
+{
+  ceph_assert_always(core_to_num_pgs.size() > 0);
+  auto pool_iter = pool_core_to_num_pgs.find(pool);
+  auto pool_pgs_on = [&](core_id_t core) -> unsigned {
+    if (pool_iter == pool_core_to_num_pgs.end()) {
+      return 0;
+    }
+    auto iter = pool_iter->second.find(core);
+    return iter == pool_iter->second.end() ? 0 : iter->second;
+  };
+  return std::min_element(
+    core_to_num_pgs.begin(),
+    core_to_num_pgs.end(),
+    [&](const auto &left, const auto &right) {
+      return std::make_pair(pool_pgs_on(left.first), left.second) <
+             std::make_pair(pool_pgs_on(right.first), right.second);
+    }
+  )->first;
+}
+
 seastar::future<core_id_t> PGShardMapping::get_or_create_pg_mapping(
   spg_t pgid,
   core_id_t core_expected)
@@ -58,21 +79,13 @@ seastar::future<core_id_t> PGShardMapping::get_or_create_pg_mapping(
         // this pgid isn't mapped within primary_mapping,
         // add the mapping and ajust core_to_num_pgs
         ceph_assert_always(primary_mapping.core_to_num_pgs.size() > 0);
-        std::map<core_id_t, unsigned>::iterator count_iter;
         if (core_expected == NULL_CORE) {
-          count_iter = std::min_element(
-            primary_mapping.core_to_num_pgs.begin(),
-            primary_mapping.core_to_num_pgs.end(),
-            [](const auto &left, const auto &right) {
-              return left.second < right.second;
-            }
-          );
-          core_to_update = count_iter->first;
-        } else { // core_expected != NULL_CORE
-          count_iter = primary_mapping.core_to_num_pgs.find(core_to_update);
+          core_to_update = primary_mapping.choose_core(pgid.pool());
         }
+        auto count_iter = primary_mapping.core_to_num_pgs.find(core_to_update);
         ceph_assert_always(primary_mapping.core_to_num_pgs.end() != count_iter);
         ++(count_iter->second);
+        ++primary_mapping.pool_core_to_num_pgs[pgid.pool()][core_to_update];
         auto [insert_iter, inserted] =
           primary_mapping.pg_to_core.emplace(pgid, core_to_update);
         assert(inserted);
@@ -140,6 +153,17 @@ seastar::future<> PGShardMapping::remove_pg_mapping(spg_t pgid) {
     assert(count_iter != primary_mapping.core_to_num_pgs.end());
     assert(count_iter->second > 0);
     --(count_iter->second);
+    auto pool_iter = primary_mapping.pool_core_to_num_pgs.find(pgid.pool());
+    assert(pool_iter != primary_mapping.pool_core_to_num_pgs.end());
+    auto pool_count_iter = pool_iter->second.find(find_iter->second);
+    assert(pool_count_iter != pool_iter->second.end());
+    assert(pool_count_iter->second > 0);
+    if (--(pool_count_iter->second) == 0) {
+      pool_iter->second.erase(pool_count_iter);
+      if (pool_iter->second.empty()) {
+        primary_mapping.pool_core_to_num_pgs.erase(pool_iter);
+      }
+    }
     primary_mapping.pg_to_core.erase(find_iter);
     DEBUG("pg {} mapping erased (primary)", pgid);
     return primary_mapping.container().invoke_on_others(
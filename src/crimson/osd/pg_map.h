@@ -24,6 +24,11 @@ class PG;
  * Maintains a mapping from spg_t to the core containing that PG.  Internally, each
  * core has a local copy of the mapping to enable core-local lookups.  Updates
  * are proxied to core 0, and the back out to all other cores -- see get_or_create_pg_mapping.
+ *
+ * New PGs go to the core with the fewest PGs of the same pool, then with the
+ * fewest PGs overall, so that the PGs of a busy pool are spread over all the
+ * cores rather than piling up on the cores that happened to be the least
+ * loaded when the pool was created.
  */
 class PGShardMapping : public seastar::peering_sharded_service<PGShardMapping> {
 public:
@@ -60,8 +65,12 @@ public:
   }
 
 private:
+  core_id_t choose_core(int64_t pool) const;
+
   // only in shard 0
   std::map<core_id_t, unsigned> core_to_num_pgs;
+  // only in shard 0, omitting the cores without any PG of the pool
+  std::map<int64_t, std::map<core_id_t, unsigned>> pool_core_to_num_pgs;
   // per-shard, updated by shard 0
   std::map<spg_t, core_id_t> pg_to_core;
 };
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <cstdlib>
 #include <iostream>
+#include <thread>
 
 #include <boost/lexical_cast.hpp>
 #include <boost/icl/interval_map.hpp>
@@ -18,6 +19,7 @@
 #include "common/ceph_context.h"
 #include "include/ceph_features.h"
 #include "common/debug.h"
+#include "common/ceph_time.h"
 
 #define dout_subsys ceph_subsys_crush
 #undef dout_prefix
@@ -689,6 +691,93 @@ int CrushTester::test(CephContext* cct)
   return 0;
 }
 
+int CrushTester::bench(CephContext* cct, const std::vector<int>& threads)
+{
+  if (min_rule < 0 || max_rule < 0) {
+    min_rule = 0;
+    max_rule = crush.get_max_rules() - 1;
+  }
+  if (min_x < 0 || max_x < 0) {
+    min_x = 0;
+    max_x = 1023;
+  }
+  if (min_rep < 0 && max_rep < 0) {
+    cerr << "must specify --num-rep or both --min-rep and --max-rep" << std::endl;
+    return -EINVAL;
+  }
+
+  vector<__u32> weight;
+  for (int o = 0; o < crush.get_max_devices(); o++) {
+    if (device_weight.count(o)) {
+      weight.push_back(device_weight[o]);
+    } else if (crush.check_item_present(o)) {
+      weight.push_back(0x10000);
+    } else {
+      weight.push_back(0);
+    }
+  }
+  adjust_weights(weight);
+
+  // the OSD maps with the weight-set of the pool, if there is one
+  const uint64_t choose_args_index =
+    pool_id != -1 ? pool_id : CrushWrapper::DEFAULT_CHOOSE_ARGS;
+  const int num_x = max_x - min_x + 1;
+
+  cout << "rule\tnumrep\tthreads\tmappings/s\tper thread\tp50 ns\tp99 ns"
+       << "\tp99.9 ns\tmax ns" << std::endl;
+  for (int r = min_rule; r < crush.get_max_rules() && r <= max_rule; r++) {
+    if (!crush.rule_exists(r)) {
+      continue;
+    }
+    for (int nr = min_rep; nr <= max_rep; nr++) {
+      for (int nthreads : threads) {
+	vector<vector<uint32_t>> lat(nthreads);
+	vector<std::thread> workers;
+	auto start = ceph::mono_clock::now();
+	for (int t = 0; t < nthreads; ++t) {
+	  workers.emplace_back([&, t] {
+	    auto& l = lat[t];
+	    l.reserve(num_x / nthreads + 1);
+	    vector<int> out;
+	    for (int x = min_x + t; x <= max_x; x += nthreads) {
+	      int real_x = x;
+	      if (pool_id != -1) {
+		real_x = crush_hash32_2(CRUSH_HASH_RJENKINS1, x,
+					(uint32_t)pool_id);
+	      }
+	      auto s = ceph::mono_clock::now();
+	      crush.do_rule(r, real_x, out, nr, weight, choose_args_index);
+	      l.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			    ceph::mono_clock::now() - s).count());
+	    }
+	  });
+	}
+	for (auto& w : workers) {
+	  w.join();
+	}
+	double elapsed = std::chrono::duration<double>(
+	  ceph::mono_clock::now() - start).count();
+
+	vector<uint32_t> all;
+	all.reserve(num_x);
+	for (auto& l : lat) {
+	  all.insert(all.end(), l.begin(), l.end());
+	}
+	std::sort(all.begin(), all.end());
+	auto at = [&all](double q) {
+	  return all[std::min<size_t>(q * all.size(), all.size() - 1)];
+	};
+	double rate = elapsed > 0 ? num_x / elapsed : 0;
+	cout << r << "\t" << nr << "\t" << nthreads << "\t"
+	     << (uint64_t)rate << "\t" << (uint64_t)(rate / nthreads) << "\t"
+	     << at(0.5) << "\t" << at(0.99) << "\t" << at(0.999) << "\t"
+	     << all.back() << std::endl;
+      }
+    }
+  }
+  return 0;
+}
+
 int CrushTester::compare(CrushWrapper& crush2)
 {
   if (min_rule < 0 || max_rule < 0) {
@@ -350,6 +350,12 @@ public:
   bool check_name_maps(unsigned max_id = 0) const;
   int test(CephContext* cct);
   int test_with_fork(CephContext* cct, int timeout);
+  /**
+   * time the mappings test() would compute, once for each of the given
+   * thread counts, and print the rate and latency percentiles of each
+   * rule and numrep
+   */
+  int bench(CephContext* cct, const std::vector<int>& threads);
 
   int compare(CrushWrapper& other);
 };
@@ -120,6 +120,27 @@ __u32 crush_hash32_3(int type, __u32 a, __u32 b, __u32 c)
 	}
 }
 
+/*
+ * hash (a, b[i], c) for n values of b.  the loop body is branch free
+ * integer arithmetic, so compilers can vectorize it.
+ */
+void crush_hash32_3_batch(int type, __u32 a, const __s32 *b, __u32 c,
+			  __u32 *out, unsigned int n)
+{
+	unsigned int i;
+
+	switch (type) {
+	case CRUSH_HASH_RJENKINS1:
+		for (i = 0; i < n; i++)
+			out[i] = crush_hash32_rjenkins1_3(a, b[i], c);
+		break;
+	default:
+		for (i = 0; i < n; i++)
+			out[i] = 0;
+		break;
+	}
+}
+
 __u32 crush_hash32_4(int type, __u32 a, __u32 b, __u32 c, __u32 d)
 {
 	switch (type) {
@@ -16,6 +16,8 @@ extern const char *crush_hash_name(int type);
 extern __u32 crush_hash32(int type, __u32 a);
 extern __u32 crush_hash32_2(int type, __u32 a, __u32 b);
 extern __u32 crush_hash32_3(int type, __u32 a, __u32 b, __u32 c);
+extern void crush_hash32_3_batch(int type, __u32 a, const __s32 *b, __u32 c,
+				 __u32 *out, unsigned int n);
 extern __u32 crush_hash32_4(int type, __u32 a, __u32 b, __u32 c, __u32 d);
 extern __u32 crush_hash32_5(int type, __u32 a, __u32 b, __u32 c, __u32 d,
 			    __u32 e);
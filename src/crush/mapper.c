@@ -312,10 +312,9 @@ static inline __s32 *get_choose_arg_ids(const struct crush_bucket_straw2 *bucket
  * for reference, see the exponential distribution example at:  
  * https://en.wikipedia.org/wiki/Inverse_transform_sampling#Examples
  */
-static inline __s64 generate_exponential_distribution(int type, int x, int y, int z, 
+static inline __s64 generate_exponential_distribution(unsigned int u,
                                                       int weight)
 {
-	unsigned int u = crush_hash32_3(type, x, y, z);
 	u &= 0xffff;
 
 	/*
@@ -339,25 +338,42 @@ static inline __s64 generate_exponential_distribution(int type, int x, int y, in
 	return div64_s64(ln, weight);
 }
 
+/*
+ * straw2 draws are computed a block of items at a time: first the
+ * hashes for the whole block (see crush_hash32_3_batch), then the
+ * logarithms and the weighted draws.  keeping each pass a tight loop
+ * over arrays lets the compiler vectorize the hash, which dominates the
+ * cost for wide buckets.  the result is identical to drawing item by
+ * item.
+ */
+#define CRUSH_STRAW2_BLOCK 16
+
 static int bucket_straw2_choose(const struct crush_bucket_straw2 *bucket,
 				int x, int r, const struct crush_choose_arg *arg,
                                 int position)
 {
-	unsigned int i, high = 0;
+	unsigned int i, j, n, high = 0;
 	__s64 draw, high_draw = 0;
+	__u32 u[CRUSH_STRAW2_BLOCK];
         __u32 *weights = get_choose_arg_weights(bucket, arg, position);
         __s32 *ids = get_choose_arg_ids(bucket, arg);
-	for (i = 0; i < bucket->h.size; i++) {
-                dprintk("weight 0x%x item %d\n", weights[i], ids[i]);
-		if (weights[i]) {
-			draw = generate_exponential_distribution(bucket->h.hash, x, ids[i], r, weights[i]);
-		} else {
-			draw = S64_MIN;
-		}
+	for (i = 0; i < bucket->h.size; i += n) {
+		n = MIN(bucket->h.size - i, CRUSH_STRAW2_BLOCK);
+		crush_hash32_3_batch(bucket->h.hash, x, &ids[i], r, u, n);
+		for (j = 0; j < n; j++) {
+			dprintk("weight 0x%x item %d\n", weights[i + j],
+				ids[i + j]);
+			if (weights[i + j]) {
+				draw = generate_exponential_distribution(
+					u[j], weights[i + j]);
+			} else {
+				draw = S64_MIN;
+			}
 
-		if (i == 0 || draw > high_draw) {
-			high = i;
-			high_draw = draw;
+			if (i + j == 0 || draw > high_draw) {
+				high = i + j;
+				high_draw = draw;
+			}
 		}
 	}
 
@@ -2050,3 +2066,37 @@ int crush_do_rule(const struct crush_map *map,
 			choose_args);
 	}
 }
+
+/**
+ * crush_do_rule_batch - map several inputs through the same rule
+ * @map: the crush_map
+ * @ruleno: the rule id
+ * @xs: hash inputs
+ * @nx: number of hash inputs
+ * @results: nx * result_max result vector
+ * @result_max: maximum result size for each input
+ * @result_lens: nx result sizes
+ * @weight: weight vector (for map leaves)
+ * @weight_max: size of weight vector
+ * @cwin: workspace initialized by crush_init_workspace
+ * @choose_args: weights and ids for each known bucket
+ *
+ * The workspace is reused for every input, so that callers mapping a
+ * whole pool only pay for its initialization once.  The mapping of
+ * xs[i] is stored in results[i * result_max, (i + 1) * result_max[.
+ */
+void crush_do_rule_batch(const struct crush_map *map,
+			 int ruleno, const int *xs, int nx,
+			 int *results, int result_max, int *result_lens,
+			 const __u32 *weight, int weight_max,
+			 void *cwin, const struct crush_choose_arg *choose_args)
+{
+	int i;
+
+	for (i = 0; i < nx; i++) {
+		result_lens[i] = crush_do_rule(map, ruleno, xs[i],
+					       results + i * result_max,
+					       result_max, weight, weight_max,
+					       cwin, choose_args);
+	}
+}
@@ -94,6 +94,20 @@ extern int crush_do_rule(const struct crush_map *map,
 			 const __u32 *weights, int weight_max,
 			 void *cwin, const struct crush_choose_arg *choose_args);
 
+/** @ingroup API
+ *
+ * Map each of the __nx__ inputs in __xs__ like crush_do_rule() does,
+ * reusing the same workspace __cwin__. The results for __xs[i]__ are
+ * stored at __results + i * result_max__ and their number in
+ * __result_lens[i]__.
+ */
+extern void crush_do_rule_batch(const struct crush_map *map,
+				int ruleno, const int *xs, int nx,
+				int *results, int result_max, int *result_lens,
+				const __u32 *weights, int weight_max,
+				void *cwin,
+				const struct crush_choose_arg *choose_args);
+
 /* Returns enough workspace for any crush rule within map to generate
    result_max outputs. The caller can then allocate this much on its own,
    either on the stack, in a per-thread long-lived buffer, or however it likes.*/
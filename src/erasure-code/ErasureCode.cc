@@ -164,7 +164,34 @@ int ErasureCode::minimum_to_decode_with_cost(const set<int> &want_to_read,
        i != available.end();
        ++i)
     available_chunks.insert(i->first);
-  return _minimum_to_decode(want_to_read, available_chunks, minimum);
+  if (includes(available_chunks.begin(), available_chunks.end(),
+	       want_to_read.begin(), want_to_read.end()))
+    return _minimum_to_decode(want_to_read, available_chunks, minimum);
+
+  // Offer the chunks cheapest first and keep the decodable set of the
+  // lowest total cost. Since every chunk read has a cost, this weighs
+  // reading fewer chunks (e.g. an LRC local group) against reading
+  // cheaper ones.
+  vector<pair<int, int>> by_cost;
+  for (auto &&i : available)
+    by_cost.push_back(make_pair(i.second, i.first));
+  sort(by_cost.begin(), by_cost.end());
+  set<int> offered;
+  int best_cost = -1;
+  for (auto &&i : by_cost) {
+    offered.insert(i.second);
+    set<int> candidate;
+    if (_minimum_to_decode(want_to_read, offered, &candidate) != 0)
+      continue;
+    int cost = 0;
+    for (auto &&c : candidate)
+      cost += available.at(c);
+    if (best_cost < 0 || cost < best_cost) {
+      best_cost = cost;
+      minimum->swap(candidate);
+    }
+  }
+  return best_cost < 0 ? -EIO : 0;
 }
 
 int ErasureCode::encode_prepare(const bufferlist &raw,
@@ -222,6 +249,92 @@ int ErasureCode::encode(const set<int> &want_to_encode,
   return 0;
 }
 
+int ErasureCode::encode_stripes(const set<int> &want_to_encode,
+                                const bufferlist &in,
+                                unsigned int stripe_width,
+                                map<int, bufferlist> *encoded)
+{
+  ceph_assert(encoded);
+  ceph_assert(encoded->empty());
+  ceph_assert(stripe_width > 0);
+  ceph_assert(in.length() % stripe_width == 0);
+  if (in.length() == 0)
+    return 0;
+
+  const unsigned int k = get_data_chunk_count();
+  const unsigned int m = get_chunk_count() - k;
+  const unsigned blocksize = get_chunk_size(stripe_width);
+  const unsigned stripes = in.length() / stripe_width;
+
+  // Raw pointers bypass the chunk mapping and padding handled by
+  // encode_prepare(); leave those cases to the per stripe path.
+  bool direct = chunk_mapping.empty() && blocksize * k == stripe_width;
+  std::vector<char*> data(k), coding(m);
+  std::vector<bufferptr> parity(m), scratch(k);
+  if (direct) {
+    for (unsigned i = 0; i < m; i++) {
+      parity[i] = buffer::create_aligned(blocksize * stripes, SIMD_ALIGN);
+    }
+  }
+
+  auto p = in.begin();
+  for (unsigned s = 0; direct && s < stripes; s++) {
+    for (unsigned i = 0; i < k; i++) {
+      bufferlist &chunk = (*encoded)[i];
+      bufferlist fragment;
+      p.copy(blocksize, fragment);  // shallow
+      if (fragment.get_num_buffers() == 1 &&
+          fragment.is_aligned(SIMD_ALIGN)) {
+        data[i] = fragment.c_str();
+        chunk.claim_append(fragment);
+      } else {
+        if (!scratch[i].have_raw()) {
+          scratch[i] = buffer::create_aligned(blocksize * stripes, SIMD_ALIGN);
+        }
+        data[i] = scratch[i].c_str() + s * blocksize;
+        fragment.begin().copy(blocksize, data[i]);
+        chunk.append(scratch[i], s * blocksize, blocksize);
+      }
+    }
+    for (unsigned i = 0; i < m; i++) {
+      coding[i] = parity[i].c_str() + s * blocksize;
+    }
+    int r = encode_stripe(want_to_encode, data.data(), coding.data(),
+                          blocksize);
+    if (r == -EOPNOTSUPP && s == 0) {
+      encoded->clear();
+      direct = false;
+    } else if (r) {
+      return r;
+    }
+  }
+
+  if (direct) {
+    for (unsigned i = 0; i < m; i++) {
+      (*encoded)[k + i].push_back(std::move(parity[i]));
+    }
+  } else {
+    for (unsigned s = 0; s < stripes; s++) {
+      map<int, bufferlist> stripe_encoded;
+      bufferlist stripe;
+      stripe.substr_of(in, s * stripe_width, stripe_width);
+      int r = encode(want_to_encode, stripe, &stripe_encoded);
+      if (r)
+        return r;
+      for (auto &[shard, chunk] : stripe_encoded) {
+        (*encoded)[shard].claim_append(chunk);
+      }
+    }
+    return 0;
+  }
+
+  for (unsigned int i = 0; i < k + m; i++) {
+    if (want_to_encode.count(i) == 0)
+      encoded->erase(i);
+  }
+  return 0;
+}
+
 int ErasureCode::_decode(const set<int> &want_to_read,
 			 const map<int, bufferlist> &chunks,
 			 map<int, bufferlist> *decoded)
@@ -81,6 +81,26 @@ namespace ceph {
                        const bufferlist &in,
                        std::map<int, bufferlist> *encoded) override;
 
+    int encode_stripes(const std::set<int> &want_to_encode,
+                       const bufferlist &in,
+                       unsigned int stripe_width,
+                       std::map<int, bufferlist> *encoded) override;
+
+    /**
+     * Encode a single stripe given as **data** and **coding** chunk
+     * pointers, each **blocksize** bytes long and SIMD_ALIGN aligned.
+     * Plugins able to work on raw pointers override this to let
+     * encode_stripes() avoid building per-stripe bufferlists.
+     *
+     * @return **0** on success, **-EOPNOTSUPP** if not implemented.
+     */
+    virtual int encode_stripe(const std::set<int> &want_to_encode,
+                              char **data,
+                              char **coding,
+                              unsigned int blocksize) {
+      return -EOPNOTSUPP;
+    }
+
     int decode(const std::set<int> &want_to_read,
                 const std::map<int, bufferlist> &chunks,
                 std::map<int, bufferlist> *decoded, int chunk_size) override;
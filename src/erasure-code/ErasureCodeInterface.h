@@ -370,6 +370,36 @@ namespace ceph {
     virtual int encode_chunks(const std::set<int> &want_to_encode,
                               std::map<int, bufferlist> *encoded) = 0;
 
+    /**
+     * Encode a sequence of stripes of **stripe_width** bytes each,
+     * read from **in**, and store the chunks listed in
+     * **want_to_encode** in **encoded**.
+     *
+     * The **encoded** map must be a pointer to an empty map. On
+     * success, each chunk in **encoded** holds the corresponding
+     * chunk of every stripe, back to back: the result is the same as
+     * calling **encode** once per stripe and concatenating the
+     * chunks.
+     *
+     * **in** may be made of any number of fragments. Data chunks
+     * that are found contiguous and suitably aligned in **in** are
+     * encoded in place and referenced by **encoded**; only the
+     * others are copied. The coding chunks of all stripes are
+     * written to a single buffer per chunk.
+     *
+     * Returns 0 on success.
+     *
+     * @param [in] want_to_encode chunk indexes to be encoded
+     * @param [in] in data to be encoded, a multiple of stripe_width
+     * @param [in] stripe_width size of a stripe in bytes
+     * @param [out] encoded map chunk indexes to chunk data
+     * @return **0** on success or a negative errno on error.
+     */
+    virtual int encode_stripes(const std::set<int> &want_to_encode,
+                               const bufferlist &in,
+                               unsigned int stripe_width,
+                               std::map<int, bufferlist> *encoded) = 0;
+
     /**
      * Decode the **chunks** and store at least **want_to_read**
      * chunks in **decoded**.
@@ -90,6 +90,15 @@ int ErasureCodeIsa::encode_chunks(const set<int> &want_to_encode,
   return 0;
 }
 
+int ErasureCodeIsa::encode_stripe(const set<int> &want_to_encode,
+                                  char **data,
+                                  char **coding,
+                                  unsigned int blocksize)
+{
+  isa_encode(data, coding, blocksize);
+  return 0;
+}
+
 int ErasureCodeIsa::decode_chunks(const set<int> &want_to_read,
                                   const map<int, bufferlist> &chunks,
                                   map<int, bufferlist> *decoded)
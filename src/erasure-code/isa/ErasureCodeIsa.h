@@ -76,6 +76,11 @@ public:
   int encode_chunks(const std::set<int> &want_to_encode,
                     std::map<int, ceph::buffer::list> *encoded) override;
 
+  int encode_stripe(const std::set<int> &want_to_encode,
+                    char **data,
+                    char **coding,
+                    unsigned int blocksize) override;
+
   int decode_chunks(const std::set<int> &want_to_read,
                             const std::map<int, ceph::buffer::list> &chunks,
                             std::map<int, ceph::buffer::list> *decoded) override;
@@ -112,6 +112,15 @@ int ErasureCodeJerasure::encode_chunks(const set<int> &want_to_encode,
   return 0;
 }
 
+int ErasureCodeJerasure::encode_stripe(const set<int> &want_to_encode,
+				       char **data,
+				       char **coding,
+				       unsigned int blocksize)
+{
+  jerasure_encode(data, coding, blocksize);
+  return 0;
+}
+
 int ErasureCodeJerasure::decode_chunks(const set<int> &want_to_read,
 				       const map<int, bufferlist> &chunks,
 				       map<int, bufferlist> *decoded)
@@ -271,6 +280,9 @@ int ErasureCodeJerasureCauchy::jerasure_decode(int *erasures,
 					       char **coding,
 					       int blocksize)
 {
+  if (schedule_cache)
+    return jerasure_schedule_decode_cache(k, m, w, schedule_cache,
+					  erasures, data, coding, blocksize, packetsize);
   return jerasure_schedule_decode_lazy(k, m, w, bitmatrix,
 				       erasures, data, coding, blocksize, packetsize, 1);
 }
@@ -305,6 +317,10 @@ void ErasureCodeJerasureCauchy::prepare_schedule(int *matrix)
 {
   bitmatrix = jerasure_matrix_to_bitmatrix(k, m, w, matrix);
   schedule = jerasure_smart_bitmatrix_to_schedule(k, m, w, bitmatrix);
+  // generating a decoding schedule costs more than running it on a
+  // small chunk; jerasure can only precompute them all when m == 2
+  if (m == 2)
+    schedule_cache = jerasure_generate_schedule_cache(k, m, w, bitmatrix, 1);
 }
 
 ErasureCodeJerasureCauchy::~ErasureCodeJerasureCauchy() 
@@ -313,6 +329,8 @@ ErasureCodeJerasureCauchy::~ErasureCodeJerasureCauchy()
     free(bitmatrix);
   if (schedule)
     jerasure_free_schedule(schedule);
+  if (schedule_cache)
+    jerasure_free_schedule_cache(k, m, schedule_cache);
 }
 
 // 
@@ -344,6 +362,8 @@ ErasureCodeJerasureLiberation::~ErasureCodeJerasureLiberation()
     free(bitmatrix);
   if (schedule)
     jerasure_free_schedule(schedule);
+  if (schedule_cache)
+    jerasure_free_schedule_cache(k, m, schedule_cache);
 }
 
 void ErasureCodeJerasureLiberation::jerasure_encode(char **data,
@@ -359,6 +379,9 @@ int ErasureCodeJerasureLiberation::jerasure_decode(int *erasures,
                                                     char **coding,
                                                     int blocksize)
 {
+  if (schedule_cache)
+    return jerasure_schedule_decode_cache(k, m, w, schedule_cache, erasures,
+					  data, coding, blocksize, packetsize);
   return jerasure_schedule_decode_lazy(k, m, w, bitmatrix, erasures, data,
 				       coding, blocksize, packetsize, 1);
 }
@@ -450,7 +473,16 @@ int ErasureCodeJerasureLiberation::parse(ErasureCodeProfile &profile,
 void ErasureCodeJerasureLiberation::prepare()
 {
   bitmatrix = liberation_coding_bitmatrix(k, w);
+  prepare_schedule();
+}
+
+void ErasureCodeJerasureLiberation::prepare_schedule()
+{
   schedule = jerasure_smart_bitmatrix_to_schedule(k, m, w, bitmatrix);
+  // precompute the decoding schedule of every erasure pattern, rather
+  // than building one on each decode
+  if (m == 2)
+    schedule_cache = jerasure_generate_schedule_cache(k, m, w, bitmatrix, 1);
 }
 
 // 
@@ -474,7 +506,7 @@ bool ErasureCodeJerasureBlaumRoth::check_w(ostream *ss) const
 void ErasureCodeJerasureBlaumRoth::prepare()
 {
   bitmatrix = blaum_roth_coding_bitmatrix(k, w);
-  schedule = jerasure_smart_bitmatrix_to_schedule(k, m, w, bitmatrix);
+  prepare_schedule();
 }
 
 // 
@@ -511,5 +543,5 @@ int ErasureCodeJerasureLiber8tion::parse(ErasureCodeProfile &profile,
 void ErasureCodeJerasureLiber8tion::prepare()
 {
   bitmatrix = liber8tion_coding_bitmatrix(k);
-  schedule = jerasure_smart_bitmatrix_to_schedule(k, m, w, bitmatrix);
+  prepare_schedule();
 }
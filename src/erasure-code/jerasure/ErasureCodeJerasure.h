@@ -59,6 +59,11 @@ public:
   int encode_chunks(const std::set<int> &want_to_encode,
 		    std::map<int, ceph::buffer::list> *encoded) override;
 
+  int encode_stripe(const std::set<int> &want_to_encode,
+		    char **data,
+		    char **coding,
+		    unsigned int blocksize) override;
+
   int decode_chunks(const std::set<int> &want_to_read,
 		    const std::map<int, ceph::buffer::list> &chunks,
 		    std::map<int, ceph::buffer::list> *decoded) override;
@@ -144,12 +149,14 @@ class ErasureCodeJerasureCauchy : public ErasureCodeJerasure {
 public:
   int *bitmatrix;
   int **schedule;
+  int ***schedule_cache;  ///< decoding schedule per erasures, if m == 2
   int packetsize;
 
   explicit ErasureCodeJerasureCauchy(const char *technique) :
     ErasureCodeJerasure(technique),
     bitmatrix(0),
     schedule(0),
+    schedule_cache(0),
     packetsize(0)
   {
     DEFAULT_K = "7";
@@ -193,12 +200,14 @@ class ErasureCodeJerasureLiberation : public ErasureCodeJerasure {
 public:
   int *bitmatrix;
   int **schedule;
+  int ***schedule_cache;  ///< decoding schedule per erasures
   int packetsize;
 
   explicit ErasureCodeJerasureLiberation(const char *technique = "liberation") :
     ErasureCodeJerasure(technique),
     bitmatrix(0),
     schedule(0),
+    schedule_cache(0),
     packetsize(0)
   {
     DEFAULT_K = "2";
@@ -222,6 +231,8 @@ public:
   virtual int revert_to_default(ceph::ErasureCodeProfile& profile,
 				std::ostream *ss);
   void prepare() override;
+protected:
+  void prepare_schedule();
 private:
   int parse(ceph::ErasureCodeProfile& profile, std::ostream *ss) override;
 };
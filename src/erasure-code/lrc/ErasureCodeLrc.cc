@@ -728,8 +728,10 @@ int ErasureCodeLrc::_minimum_to_decode(const set<int> &want_to_read,
     }
   }
 
-  derr << __func__ << " not enough chunks in " << available_chunks
-       << " to read " << want_to_read << dendl;
+  // not an error on its own: minimum_to_decode_with_cost() probes
+  // subsets of the available chunks
+  dout(10) << __func__ << " not enough chunks in " << available_chunks
+	   << " to read " << want_to_read << dendl;
   return -EIO;
 }
 
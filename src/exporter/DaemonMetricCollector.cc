@@ -16,6 +16,7 @@
 #include "common/debug.h"
 #include "common/hostname.h"
 #include "common/perf_counters.h"
+#include "common/perf_counters_key.h"
 #include "common/split.h"
 #include "global/global_context.h"
 #include "global/global_init.h"
@@ -173,22 +174,32 @@ void DaemonMetricCollector::dump_asok_metrics(bool sort_metrics, int64_t counter
         continue;
       } 
     }
-    std::string counter_dump_response = dump_response.size() > 0 ? dump_response :
-      asok_request(sock_client, "counter dump", daemon_name);
-    if (counter_dump_response.size() == 0) {
+    // daemons that cannot stream their counters get the json commands
+    bool streamed = dump_response.empty() &&
+      g_conf().get_val<bool>("exporter_counter_stream") &&
+      stream_asok_metrics(sock_client, prio_limit, daemon_name);
+    std::string counter_dump_response;
+    std::string counter_schema_response;
+    if (!streamed) {
+      counter_dump_response = dump_response.size() > 0 ? dump_response :
+        asok_request(sock_client, "counter dump", daemon_name);
+      if (counter_dump_response.size() == 0) {
         failures++;
         continue;
-    }
-    std::string counter_schema_response = schema_response.size() > 0 ? schema_response :
+      }
+      counter_schema_response = schema_response.size() > 0 ? schema_response :
         asok_request(sock_client, "counter schema", daemon_name);
-    if (counter_schema_response.size() == 0) {
-      failures++;
-      continue;
+      if (counter_schema_response.size() == 0) {
+        failures++;
+        continue;
+      }
     }
 
     try {
-      parse_asok_metrics(counter_dump_response, counter_schema_response,
-                         prio_limit, daemon_name);
+      if (!streamed) {
+        parse_asok_metrics(counter_dump_response, counter_schema_response,
+                           prio_limit, daemon_name);
+      }
 
       std::string config_show = !config_show_response ? "" :
         asok_request(sock_client, "config show", daemon_name);
@@ -239,6 +250,103 @@ void DaemonMetricCollector::dump_asok_metrics(bool sort_metrics, int64_t counter
   metrics = builder->dump();
 }
 
+bool DaemonMetricCollector::stream_asok_metrics(AdminSocketClient &asok,
+                                               int64_t prio_limit,
+                                               const std::string &daemon_name) {
+  auto &reader = streams[daemon_name];
+  // a delta we cannot apply means we missed a reply: start over once
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    std::string request = "{\"prefix\": \"counter stream\", \"subscriber\": \"" +
+      g_conf()->name.to_str() + "\", \"seq\": " + std::to_string(reader.seq) + "}";
+    std::string response;
+    std::string err = asok.do_request(request, &response);
+    if (err.length() > 0 || response.empty() ||
+        response.substr(0, 5) == "ERROR") {
+      dout(10) << "counter stream failed for daemon " << daemon_name
+               << ", falling back to counter dump" << dendl;
+      streams.erase(daemon_name);
+      return false;
+    }
+    ceph::perf_counters::stream_reply_t reply;
+    try {
+      ceph::bufferlist bl;
+      bl.append(response);
+      auto p = bl.cbegin();
+      decode(reply, p);
+    } catch (const ceph::buffer::error &e) {
+      dout(1) << "failed to decode counter stream of " << daemon_name << ": "
+              << e.what() << dendl;
+      streams.erase(daemon_name);
+      return false;
+    }
+    if (reader.apply(reply)) {
+      dump_stream_metrics(reader, prio_limit, daemon_name);
+      return true;
+    }
+    reader.clear();
+  }
+  streams.erase(daemon_name);
+  return false;
+}
+
+void DaemonMetricCollector::dump_stream_metrics(
+    const ceph::perf_counters::StreamReader &reader, int64_t prio_limit,
+    const std::string &daemon_name) {
+  auto extra_labels = get_extra_labels(daemon_name);
+  if (extra_labels.empty()) {
+    dout(1) << "Unable to parse instance_id from daemon_name: "
+            << daemon_name << dendl;
+    return;
+  }
+  size_t slot = 0;
+  for (auto &logger : reader.schema) {
+    std::string perf_group{ceph::perf_counters::key_name(logger.key)};
+    labels_t logger_labels = extra_labels;
+    for (auto [label, value] : ceph::perf_counters::key_labels(logger.key)) {
+      if (!label.empty()) {
+        logger_labels[std::string{label}] = quote(std::string{value});
+      }
+    }
+    for (auto &c : logger.counters) {
+      bool avg = c.type & PERFCOUNTER_LONGRUNAVG;
+      size_t at = slot;
+      slot += avg ? 2 : 1;
+      if (c.prio < prio_limit) {
+        continue;
+      }
+      std::string counter_name = perf_group + "_" + c.name;
+      promethize(counter_name);
+      labels_t labels = logger_labels;
+      auto multisite_labels_and_name = add_fixed_name_metrics(counter_name);
+      if (!multisite_labels_and_name.first.empty()) {
+        labels.insert(multisite_labels_and_name.first.begin(),
+                      multisite_labels_and_name.first.end());
+        counter_name = multisite_labels_and_name.second;
+      }
+      std::string metric_type =
+          c.type & PERFCOUNTER_COUNTER ? "counter" : "gauge";
+      auto add_value = [&](uint64_t v, const std::string &name,
+                           const std::string &description,
+                           const std::string &mtype) {
+        if (c.type & PERFCOUNTER_TIME) {
+          add_metric(builder, v / 1000000000.0, name, description, mtype,
+                     labels);
+        } else {
+          add_metric(builder, v, name, description, mtype, labels);
+        }
+      };
+      if (avg) {
+        add_metric(builder, reader.values[at + 1], counter_name + "_count",
+                   c.description + " Count", "counter", labels);
+        add_value(reader.values[at], counter_name + "_sum",
+                  c.description + " Total", metric_type);
+      } else {
+        add_value(reader.values[at], counter_name, c.description, metric_type);
+      }
+    }
+  }
+}
+
 std::vector<std::string> read_proc_stat_file(std::string path) {
   std::string stat = read_file_to_string(path);
   std::vector<std::string> strings;
@@ -429,6 +537,7 @@ void DaemonMetricCollector::update_sockets() {
       }
     }
   }
+  std::erase_if(streams, [this](auto &s) { return !clients.count(s.first); });
 }
 
 void OrderedMetricsBuilder::add(std::string value, std::string name,
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common/admin_socket_client.h"
+#include "common/perf_counters_stream.h"
 #include <map>
 #include <string>
 #include <vector>
@@ -40,6 +41,8 @@ public:
                          std::string &schema_response,
                          bool config_show_response);
   std::map<std::string, AdminSocketClient> clients;
+  /// our copy of the counters of the daemons that can stream them
+  std::map<std::string, ceph::perf_counters::StreamReader> streams;
   std::string metrics;
   std::pair<labels_t, std::string> add_fixed_name_metrics(std::string metric_name);
 
@@ -55,6 +58,10 @@ private:
   void parse_asok_metrics(std::string &counter_dump_response,
                           std::string &counter_schema_response,
                           int64_t prio_limit, const std::string &daemon_name);
+  bool stream_asok_metrics(AdminSocketClient &asok, int64_t prio_limit,
+                           const std::string &daemon_name);
+  void dump_stream_metrics(const ceph::perf_counters::StreamReader &reader,
+                           int64_t prio_limit, const std::string &daemon_name);
   void get_process_metrics(std::vector<std::pair<std::string, int>> daemon_pids);
   std::string asok_request(AdminSocketClient &asok, std::string command, std::string daemon_name);
 };
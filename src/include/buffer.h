@@ -387,6 +387,11 @@ struct error_code;
 
     static ptr_node* copy_hypercombined(const ptr_node& copy_this);
 
+    // every segment of a list owns a ptr_node; recycle them through a
+    // small per-thread free list instead of going to the heap each time.
+    static void* operator new(std::size_t size);
+    static void operator delete(void* p, std::size_t size) noexcept;
+
   private:
     friend list;
 
@@ -30,6 +30,20 @@ extern ceph_crc32c_func_t ceph_choose_crc32(void);
  */
 uint32_t ceph_crc32c_zeros(uint32_t crc, unsigned length);
 
+/**
+ * combine the crc32c of two adjacent buffers
+ *
+ * Given crc_a = crc32c(crc, A) and crc_b = crc32c(0, B), returns
+ * crc32c(crc, A + B) without touching the data again.  This lets large
+ * buffers be checksummed as independent chunks (e.g. by several threads)
+ * and merged afterwards.
+ *
+ * @param crc_a crc of the first buffer, with the desired initial value
+ * @param crc_b crc of the second buffer, computed with initial value 0
+ * @param length_b length of the second buffer
+ */
+uint32_t ceph_crc32c_combine(uint32_t crc_a, uint32_t crc_b, unsigned length_b);
+
 /**
  * calculate crc32c
  *
@@ -330,6 +330,32 @@ struct denc_traits<T> {
 };
 
 
+// -----------------------------------------------------------------------
+// memcpy safe types
+//
+// A type is memcpy safe if its in-memory representation is exactly its
+// encoding: it is trivially copyable, has no padding, and its denc
+// encodes each of its members, in order, as a memcpy safe type.  A
+// contiguous container of such a type is encoded and decoded with a
+// single memcpy instead of element by element.
+//
+// Any other class can opt in by specializing denc_memcpy_safe.  Do not do
+// so for a type whose DENC uses DENC_START, varints or features.
+template<typename T>
+struct denc_memcpy_safe : std::false_type {};
+
+template<typename T>
+requires _denc::is_any_of<_denc::underlying_type_t<T>,
+		          ceph_le64, ceph_le32, ceph_le16, uint8_t
+#ifndef _CHAR_IS_SIGNED
+		          , int8_t
+#endif
+			  >
+struct denc_memcpy_safe<T> : std::true_type {};
+
+template<typename T>
+inline constexpr bool denc_memcpy_safe_v = denc_memcpy_safe<T>::value;
+
 // -----------------------------------------------------------------------
 // integer types
 
@@ -404,6 +430,16 @@ struct denc_traits<T>
   }
 };
 
+// native integers are stored as their wire type on little-endian hosts;
+// bool is not, since a decoded byte may be neither 0 nor 1.
+template<typename T>
+requires (!std::is_void_v<_denc::ExtType_t<T>> &&
+	  !std::is_same_v<T, bool> &&
+	  std::endian::native == std::endian::little)
+struct denc_memcpy_safe<T> : std::true_type {
+  static_assert(sizeof(T) == sizeof(_denc::ExtType_t<T>));
+};
+
 // varint
 //
 // high bit of each byte indicates another byte follows.
@@ -915,6 +951,40 @@ struct denc_traits<
 };
 
 namespace _denc {
+  // the elements of a contiguous container C, moved with a single memcpy
+  template<typename C>
+  struct memcpy_nohead {
+    using T = typename C::value_type;
+
+    static void encode(const C& s, ceph::buffer::list::contiguous_appender& p) {
+      if (const size_t len = s.size() * sizeof(T); len > 0) {
+	memcpy(p.get_pos_add(len), s.data(), len);
+      }
+    }
+    static void decode(size_t num, C& s, ceph::buffer::ptr::const_iterator& p) {
+      const size_t len = num * sizeof(T);
+      // bounds check before a bogus count has us allocate
+      const char* src = p.get_pos_add(len);
+      s.clear();
+      s.resize(num);
+      if (len > 0) {
+	memcpy(reinterpret_cast<char*>(s.data()), src, len);
+      }
+    }
+    static void decode(size_t num, C& s,
+		       ceph::buffer::list::const_iterator& p) {
+      const size_t len = num * sizeof(T);
+      if (len > p.get_remaining()) {
+	throw ceph::buffer::end_of_buffer();
+      }
+      s.clear();
+      s.resize(num);
+      if (len > 0) {
+	p.copy(len, reinterpret_cast<char*>(s.data()));
+      }
+    }
+  };
+
   template<template<class...> class C, typename Details, typename ...Ts>
   struct container_base {
   private:
@@ -928,11 +998,15 @@ namespace _denc {
     static constexpr bool featured = traits::featured;
     static constexpr bool bounded = false;
     static constexpr bool need_contiguous = traits::need_contiguous;
+    static constexpr bool memcpy_safe = Details::contiguous &&
+      denc_memcpy_safe_v<T>;
 
     template<typename U=T>
     static void bound_encode(const container& s, size_t& p, uint64_t f = 0) {
       p += sizeof(uint32_t);
-      if constexpr (traits::bounded) {
+      if constexpr (memcpy_safe) {
+        p += sizeof(T) * s.size();
+      } else if constexpr (traits::bounded) {
 #if _GLIBCXX_USE_CXX11_ABI
         // intensionally not calling container's empty() method to not prohibit
         // compiler from optimizing the check if it and the ::size() operate on
@@ -992,6 +1066,10 @@ namespace _denc {
     // nohead
     static void encode_nohead(const container& s, ceph::buffer::list::contiguous_appender& p,
 			      uint64_t f = 0) {
+      if constexpr (memcpy_safe) {
+        memcpy_nohead<container>::encode(s, p);
+        return;
+      }
       for (const T& e : s) {
         if constexpr (traits::featured) {
           denc(e, p, f);
@@ -1003,6 +1081,10 @@ namespace _denc {
     static void decode_nohead(size_t num, container& s,
 			      ceph::buffer::ptr::const_iterator& p,
 			      uint64_t f=0) {
+      if constexpr (memcpy_safe) {
+        memcpy_nohead<container>::decode(num, s, p);
+        return;
+      }
       s.clear();
       Details::reserve(s, num);
       while (num--) {
@@ -1015,6 +1097,10 @@ namespace _denc {
     static std::enable_if_t<!!sizeof(U) && !need_contiguous>
     decode_nohead(size_t num, container& s,
 		  ceph::buffer::list::const_iterator& p) {
+      if constexpr (memcpy_safe) {
+        memcpy_nohead<container>::decode(num, s, p);
+        return;
+      }
       s.clear();
       Details::reserve(s, num);
       while (num--) {
@@ -1047,6 +1133,7 @@ namespace _denc {
   template<typename Container>
   struct container_details_base {
     using T = typename Container::value_type;
+    static constexpr bool contiguous = false;
     static void reserve(Container& c, size_t s) {
       if constexpr (container_has_reserve_v<Container>) {
         c.reserve(s);
@@ -1061,6 +1148,11 @@ namespace _denc {
       c.emplace_back(std::forward<Args>(args)...);
     }
   };
+
+  template<typename Container>
+  struct vector_details : public pushback_details<Container> {
+    static constexpr bool contiguous = true;
+  };
 }
 
 template<typename T, typename ...Ts>
@@ -1076,7 +1168,7 @@ struct denc_traits<
   std::vector<T, Ts...>,
   typename std::enable_if_t<denc_traits<T>::supported>>
   : public _denc::container_base<std::vector,
-				 _denc::pushback_details<std::vector<T, Ts...>>,
+				 _denc::vector_details<std::vector<T, Ts...>>,
 				 T, Ts...> {};
 
 template<typename T, std::size_t N, typename ...Ts>
@@ -1092,11 +1184,14 @@ public:
   static constexpr bool featured = traits::featured;
   static constexpr bool bounded = false;
   static constexpr bool need_contiguous = traits::need_contiguous;
+  static constexpr bool memcpy_safe = denc_memcpy_safe_v<T>;
 
   template<typename U=T>
   static void bound_encode(const container& s, size_t& p, uint64_t f = 0) {
     p += sizeof(uint32_t);
-    if constexpr (traits::bounded) {
+    if constexpr (memcpy_safe) {
+      p += sizeof(T) * s.size();
+    } else if constexpr (traits::bounded) {
       if (!s.empty()) {
 	const auto elem_num = s.size();
 	size_t elem_size = 0;
@@ -1146,6 +1241,10 @@ public:
   // nohead
   static void encode_nohead(const container& s, ceph::buffer::list::contiguous_appender& p,
 			    uint64_t f = 0) {
+    if constexpr (memcpy_safe) {
+      _denc::memcpy_nohead<container>::encode(s, p);
+      return;
+    }
     for (const T& e : s) {
       if constexpr (traits::featured) {
         denc(e, p, f);
@@ -1157,6 +1256,10 @@ public:
   static void decode_nohead(size_t num, container& s,
 			    ceph::buffer::ptr::const_iterator& p,
 			    uint64_t f=0) {
+    if constexpr (memcpy_safe) {
+      _denc::memcpy_nohead<container>::decode(num, s, p);
+      return;
+    }
     s.clear();
     s.reserve(num);
     while (num--) {
@@ -1169,6 +1272,10 @@ public:
   static std::enable_if_t<!!sizeof(U) && !need_contiguous>
   decode_nohead(size_t num, container& s,
 		ceph::buffer::list::const_iterator& p) {
+    if constexpr (memcpy_safe) {
+      _denc::memcpy_nohead<container>::decode(num, s, p);
+      return;
+    }
     s.clear();
     s.reserve(num);
     while (num--) {
@@ -15,7 +15,9 @@
 #ifndef _CEPH_INCLUDE_MEMPOOL_H
 #define _CEPH_INCLUDE_MEMPOOL_H
 
+#include <atomic>
 #include <cstddef>
+#include <iosfwd>
 #include <map>
 #include <unordered_map>
 #include <set>
@@ -320,6 +322,42 @@ public:
 
 void dump(ceph::Formatter *f);
 
+// --------------------------------------------------------------
+// allocation sampling
+//
+// When a sample rate is set, about one allocation per sample_rate bytes
+// allocated through a pool_allocator has its call stack recorded, and
+// kept until it is freed.  This shows which code paths hold on to pool
+// memory, and how long sampled allocations live, at a cost of a thread
+// local countdown per allocation.
+
+extern std::atomic<size_t> sample_rate;    ///< 0 if sampling is off
+extern std::atomic<size_t> live_samples;   ///< sampled and not yet freed
+
+void set_sample_rate(size_t bytes);
+/// count bytes down towards the next sample; true if this one is it
+bool sample_countdown(size_t bytes);
+void record_sample(pool_index_t ix, void *p, size_t bytes);
+void forget_sample(pool_index_t ix, void *p);
+
+/// per pool statistics of the samples
+void dump_samples(ceph::Formatter *f);
+/// live samples as a legacy text heap profile, readable by pprof
+void dump_samples_pprof(std::ostream& out);
+
+inline void maybe_record_sample(pool_index_t ix, void *p, size_t bytes) {
+  if (sample_rate.load(std::memory_order_relaxed) &&
+      sample_countdown(bytes)) [[unlikely]] {
+    record_sample(ix, p, bytes);
+  }
+}
+
+inline void maybe_forget_sample(pool_index_t ix, void *p) {
+  if (live_samples.load(std::memory_order_relaxed)) [[unlikely]] {
+    forget_sample(ix, p);
+  }
+}
+
 
 // STL allocator for use with containers.  All actual state
 // is stored in the static pool_allocator_base_t, which saves us from
@@ -373,6 +411,7 @@ public:
 #endif
     }
     T* r = reinterpret_cast<T*>(new char[total]);
+    maybe_record_sample(pool_ix, r, total);
     return r;
   }
 
@@ -389,6 +428,7 @@ public:
       type->items -= n;
 #endif
     }
+    maybe_forget_sample(pool_ix, p);
     delete[] reinterpret_cast<char*>(p);
   }
 
@@ -410,6 +450,7 @@ public:
     if (rc)
       throw std::bad_alloc();
     T* r = reinterpret_cast<T*>(ptr);
+    maybe_record_sample(pool_ix, r, total);
     return r;
   }
 
@@ -426,6 +467,7 @@ public:
       type->items -= n;
 #endif
     }
+    maybe_forget_sample(pool_ix, p);
     aligned_free(p);
   }
 
@@ -20,11 +20,14 @@
 #include <cstddef>
 #include <memory>
 #include <optional>
+#include <span>
 #include <tuple>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
 #include <variant>
+#include <vector>
 
 #include <fmt/format.h>
 #include <fmt/ostream.h>
@@ -1406,6 +1409,44 @@ public:
       }, consigned);
   }
 
+  /// One error_code per op of a batch, in the order of the ops
+  using BatchSig = void(boost::system::error_code,
+			std::vector<boost::system::error_code>);
+  using BatchComp = boost::asio::any_completion_handler<BatchSig>;
+
+  /// Execute each op on its object of ioc, submitting them all to the
+  /// Objecter at once. The ops are moved from. The error code of the
+  /// completion is that of the first op that failed, if any.
+  template<boost::asio::completion_token_for<BatchSig> CompletionToken>
+  auto execute(IOContext ioc, std::span<std::pair<Object, ReadOp>> ops,
+	       CompletionToken&& token) {
+    auto consigned = boost::asio::consign(
+      std::forward<CompletionToken>(token), boost::asio::make_work_guard(
+	boost::asio::get_associated_executor(token, get_executor())));
+    return boost::asio::async_initiate<decltype(consigned), BatchSig>(
+      [ioc = std::move(ioc),
+       ops = std::vector(std::make_move_iterator(ops.begin()),
+			 std::make_move_iterator(ops.end())),
+       this](auto&& handler) mutable {
+	execute_(std::move(ioc), std::move(ops), std::move(handler));
+      }, consigned);
+  }
+
+  template<boost::asio::completion_token_for<BatchSig> CompletionToken>
+  auto execute(IOContext ioc, std::span<std::pair<Object, WriteOp>> ops,
+	       CompletionToken&& token) {
+    auto consigned = boost::asio::consign(
+      std::forward<CompletionToken>(token), boost::asio::make_work_guard(
+	boost::asio::get_associated_executor(token, get_executor())));
+    return boost::asio::async_initiate<decltype(consigned), BatchSig>(
+      [ioc = std::move(ioc),
+       ops = std::vector(std::make_move_iterator(ops.begin()),
+			 std::make_move_iterator(ops.end())),
+       this](auto&& handler) mutable {
+	execute_(std::move(ioc), std::move(ops), std::move(handler));
+      }, consigned);
+  }
+
   boost::uuids::uuid get_fsid() const noexcept;
 
   using LookupPoolSig = void(boost::system::error_code,
@@ -1813,6 +1854,11 @@ private:
 		Op::Completion c, uint64_t* objver,
 		const blkin_trace_info* trace_info);
 
+  void execute_(IOContext ioc, std::vector<std::pair<Object, ReadOp>> ops,
+		BatchComp c);
+  void execute_(IOContext ioc, std::vector<std::pair<Object, WriteOp>> ops,
+		BatchComp c);
+
   void lookup_pool_(std::string name, LookupPoolComp c);
   void list_pools_(LSPoolsComp c);
   void create_pool_snap_(int64_t pool, std::string snap_name,
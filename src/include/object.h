@@ -147,6 +147,9 @@ struct denc_traits<snapid_t> {
   }
 };
 
+template<>
+struct denc_memcpy_safe<snapid_t> : denc_memcpy_safe<uint64_t> {};
+
 inline std::ostream& operator<<(std::ostream& out, const snapid_t& s) {
   if (s == CEPH_NOSNAP)
     return out << "head";
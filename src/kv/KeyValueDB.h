@@ -189,6 +189,27 @@ public:
 		  ceph::buffer::list *value) {
     return get(prefix, std::string(key, keylen), value);
   }
+  /// Retrieve a batch of keys from the same prefix.
+  ///
+  /// On return (*values)[i] holds the value of keys[i], if it exists.
+  /// Returns the number of keys found.  Backends that can batch point
+  /// lookups (block cache and filter probes, IO) override this.
+  virtual int get_multi(
+    const std::string &prefix,                 ///< [in] prefix or CF name
+    const std::vector<std::string> &keys,      ///< [in] keys to retrieve
+    std::vector<std::optional<ceph::buffer::list>> *values) { ///< [out] values
+    values->clear();
+    values->resize(keys.size());
+    int found = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      ceph::buffer::list bl;
+      if (get(prefix, keys[i], &bl) >= 0) {
+	(*values)[i] = std::move(bl);
+	++found;
+      }
+    }
+    return found;
+  }
 
   // This superclass is used both by kv iterators *and* by the ObjectMap
   // omap iterator.  The class hierarchies are unfortunately tied together
@@ -331,6 +352,8 @@ protected:
 public:
   typedef uint32_t IteratorOpts;
   static const uint32_t ITERATOR_NOCACHE = 1;
+  /// the iterator walks a range of keys sequentially, prefer readahead
+  static const uint32_t ITERATOR_SCAN = 2;
 
   struct IteratorBounds {
     std::optional<std::string> lower_bound;
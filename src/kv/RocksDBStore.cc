@@ -1860,40 +1860,66 @@ int RocksDBStore::get(
     const std::set<string> &keys,
     std::map<string, bufferlist> *out)
 {
-  rocksdb::PinnableSlice value;
+  std::vector<string> kv(keys.begin(), keys.end());
+  std::vector<std::optional<bufferlist>> values;
+  get_multi(prefix, kv, &values);
+  for (size_t i = 0; i < kv.size(); ++i) {
+    if (values[i]) {
+      (*out)[kv[i]].claim_append(*values[i]);
+    }
+  }
+  return 0;
+}
+
+int RocksDBStore::get_multi(
+    const string &prefix,
+    const std::vector<string> &keys,
+    std::vector<std::optional<bufferlist>> *values)
+{
   utime_t start = ceph_clock_now();
+  const size_t n = keys.size();
+  values->clear();
+  values->resize(n);
+  if (n == 0) {
+    return 0;
+  }
+  // a sharded prefix may hash keys to different column families, so
+  // pass a handle per key and let MultiGet group them
+  std::vector<rocksdb::ColumnFamilyHandle*> cfs(n);
+  std::vector<rocksdb::Slice> slices;
+  slices.reserve(n);
+  std::vector<string> combined;
   if (cf_handles.count(prefix) > 0) {
-    for (auto& key : keys) {
-      auto cf_handle = get_cf_handle(prefix, key);
-      auto status = db->Get(rocksdb::ReadOptions(),
-			    cf_handle,
-			    rocksdb::Slice(key),
-			    &value);
-      if (status.ok()) {
-	(*out)[key].append(value.data(), value.size());
-      } else if (status.IsIOError()) {
-	ceph_abort_msg(status.getState());
-      }
-      value.Reset();
+    for (size_t i = 0; i < n; ++i) {
+      cfs[i] = get_cf_handle(prefix, keys[i]);
+      slices.emplace_back(keys[i]);
     }
   } else {
-    for (auto& key : keys) {
-      string k = combine_strings(prefix, key);
-      auto status = db->Get(rocksdb::ReadOptions(),
-			    default_cf,
-			    rocksdb::Slice(k),
-			    &value);
-      if (status.ok()) {
-	(*out)[key].append(value.data(), value.size());
-      } else if (status.IsIOError()) {
-	ceph_abort_msg(status.getState());
-      }
-      value.Reset();
+    // reserved up front: slices point into these strings
+    combined.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+      cfs[i] = default_cf;
+      combined.push_back(combine_strings(prefix, keys[i]));
+      slices.emplace_back(combined.back());
+    }
+  }
+  std::vector<rocksdb::PinnableSlice> pinned(n);
+  std::vector<rocksdb::Status> statuses(n);
+  db->MultiGet(rocksdb::ReadOptions(), n, cfs.data(), slices.data(),
+	       pinned.data(), statuses.data());
+  int found = 0;
+  for (size_t i = 0; i < n; ++i) {
+    if (statuses[i].ok()) {
+      (*values)[i].emplace();
+      (*values)[i]->append(pinned[i].data(), pinned[i].size());
+      ++found;
+    } else if (statuses[i].IsIOError()) {
+      ceph_abort_msg(statuses[i].getState());
     }
   }
   utime_t lat = ceph_clock_now() - start;
   logger->tinc(l_rocksdb_get_latency, lat);
-  return 0;
+  return found;
 }
 
 int RocksDBStore::get(
@@ -2272,12 +2298,13 @@ public:
   explicit CFIteratorImpl(const RocksDBStore* db,
                           const std::string& p,
                           rocksdb::ColumnFamilyHandle* cf,
-                          KeyValueDB::IteratorBounds bounds_)
+                          KeyValueDB::IteratorBounds bounds_,
+                          KeyValueDB::IteratorOpts opts = 0)
     : prefix(p), bounds(std::move(bounds_)),
       iterate_lower_bound(make_slice(bounds.lower_bound)),
       iterate_upper_bound(make_slice(bounds.upper_bound))
       {
-      auto options = rocksdb::ReadOptions();
+      auto options = db->get_iterator_options(opts);
       if (db->cct->_conf->osd_rocksdb_iterator_bounds_enabled) {
         if (bounds.lower_bound) {
           options.iterate_lower_bound = &iterate_lower_bound;
@@ -2827,13 +2854,14 @@ public:
   explicit ShardMergeIteratorImpl(const RocksDBStore* db,
 				  const std::string& prefix,
 				  const std::vector<rocksdb::ColumnFamilyHandle*>& shards,
-                  KeyValueDB::IteratorBounds bounds_)
+                  KeyValueDB::IteratorBounds bounds_,
+                  KeyValueDB::IteratorOpts opts = 0)
     : db(db), keyless(db->comparator), prefix(prefix), bounds(std::move(bounds_)),
       iterate_lower_bound(make_slice(bounds.lower_bound)),
       iterate_upper_bound(make_slice(bounds.upper_bound))
   {
     iters.reserve(shards.size());
-    auto options = rocksdb::ReadOptions();
+    auto options = db->get_iterator_options(opts);
     if (db->cct->_conf->osd_rocksdb_iterator_bounds_enabled) {
       if (bounds.lower_bound) {
         options.iterate_lower_bound = &iterate_lower_bound;
@@ -3014,6 +3042,29 @@ public:
   }
 };
 
+rocksdb::ReadOptions RocksDBStore::get_iterator_options(IteratorOpts opts) const
+{
+  rocksdb::ReadOptions options;
+  if (opts & ITERATOR_NOCACHE) {
+    options.fill_cache = false;
+  }
+  if (opts & ITERATOR_SCAN) {
+    // with readahead_size 0 rocksdb reads ahead on its own once it sees
+    // sequential block reads, doubling the size up to
+    // max_auto_readahead_size; a fixed size only pays off on slow devices
+    options.readahead_size =
+      cct->_conf.get_val<Option::size_t>("rocksdb_iterator_scan_readahead");
+#if (ROCKSDB_MAJOR >= 7)
+    // keep the grown readahead when the scan moves on to the next sst
+    options.adaptive_readahead = true;
+#endif
+#if (ROCKSDB_MAJOR >= 8 || (ROCKSDB_MAJOR == 7 && ROCKSDB_MINOR >= 3))
+    options.async_io = cct->_conf.get_val<bool>("rocksdb_iterator_scan_async_io");
+#endif
+  }
+  return options;
+}
+
 KeyValueDB::Iterator RocksDBStore::get_iterator(const std::string& prefix, IteratorOpts opts, IteratorBounds bounds)
 {
   auto cf_it = cf_handles.find(prefix);
@@ -3029,13 +3080,15 @@ KeyValueDB::Iterator RocksDBStore::get_iterator(const std::string& prefix, Itera
               this,
               prefix,
               cf,
-              std::move(bounds));
+              std::move(bounds),
+              opts);
     } else {
       return std::make_shared<ShardMergeIteratorImpl>(
         this,
         prefix,
         cf_it->second.handles,
-        std::move(bounds));
+        std::move(bounds),
+        opts);
     }
   } else {
     // use wholespace engine if no cfs are configured
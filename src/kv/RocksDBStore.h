@@ -352,6 +352,10 @@ public:
     const char *key,
     size_t keylen,
     ceph::bufferlist *out) override;
+  int get_multi(
+    const std::string &prefix,
+    const std::vector<std::string> &keys,
+    std::vector<std::optional<ceph::bufferlist>> *values) override;
 
 
   class RocksDBWholeSpaceIteratorImpl :
@@ -363,9 +367,7 @@ public:
                                            rocksdb::ColumnFamilyHandle* cf,
                                            const KeyValueDB::IteratorOpts opts)
       {
-        rocksdb::ReadOptions options = rocksdb::ReadOptions();
-        if (opts & ITERATOR_NOCACHE)
-          options.fill_cache=false;
+        rocksdb::ReadOptions options = db->get_iterator_options(opts);
         dbiter = db->db->NewIterator(options, cf);
     }
     ~RocksDBWholeSpaceIteratorImpl() override;
@@ -391,6 +393,8 @@ public:
 
   Iterator get_iterator(const std::string& prefix, IteratorOpts opts = 0, IteratorBounds = IteratorBounds()) override;
 private:
+  /// read options for a new iterator
+  rocksdb::ReadOptions get_iterator_options(IteratorOpts opts) const;
   /// this iterator spans single cf
   WholeSpaceIterator new_shard_iterator(rocksdb::ColumnFamilyHandle* cf);
   Iterator new_shard_iterator(rocksdb::ColumnFamilyHandle* cf,
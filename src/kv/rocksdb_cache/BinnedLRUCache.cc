@@ -112,6 +112,7 @@ BinnedLRUCacheShard::BinnedLRUCacheShard(CephContext *c, size_t capacity, bool s
       usage_(0),
       lru_usage_(0),
       age_bins(1) {
+  scan_resistant_ = cct->_conf.get_val<bool>("rocksdb_cache_scan_resistant");
   shift_bins();
   // Make empty circular linked list
   lru_.next = &lru_;
@@ -221,7 +222,20 @@ void BinnedLRUCacheShard::LRU_Insert(BinnedLRUHandle* e) {
   ceph_assert(e->prev == nullptr);
   e->age_bin = age_bins.front();
 
-  if (high_pri_pool_ratio_ > 0 && e->IsHighPri()) {
+  if (e->InProbation() && !e->HasHit() && !e->IsHighPri()) {
+    // Not seen before and not hit since: insert "e" to the tail of LRU
+    // list, and count it as old, so that it goes first.
+    e->age_bin = age_bins.back();
+    e->next = lru_.next;
+    e->prev = &lru_;
+    e->prev->next = e;
+    e->next->prev = e;
+    e->SetInHighPriPool(false);
+    if (lru_low_pri_ == &lru_) {
+      lru_low_pri_ = e;
+    }
+    *(e->age_bin) += e->charge;
+  } else if (high_pri_pool_ratio_ > 0 && e->IsHighPri()) {
     // Inset "e" to head of LRU list.
     e->next = &lru_;
     e->prev = lru_.prev;
@@ -281,6 +295,22 @@ void BinnedLRUCacheShard::EvictFromLRU(size_t charge,
     Unref(old);
     usage_ -= old->charge;
     deleted->push_back(old);
+    if (scan_resistant_) {
+      Ghost_Add(old->hash);
+    }
+  }
+}
+
+void BinnedLRUCacheShard::Ghost_Add(uint32_t hash) {
+  // about as many as the entries the cache holds
+  size_t max = std::max<size_t>(
+    1024, capacity_ / std::max<uint64_t>(cct->_conf->rocksdb_block_size, 1));
+  while (ghost_fifo_.size() >= max) {
+    ghost_.erase(ghost_fifo_.front());
+    ghost_fifo_.pop_front();
+  }
+  if (ghost_.insert(hash).second) {
+    ghost_fifo_.push_back(hash);
   }
 }
 
@@ -402,6 +432,16 @@ rocksdb::Status BinnedLRUCacheShard::Insert(const rocksdb::Slice& key, uint32_t
     // is freed or the lru list is empty
     EvictFromLRU(charge, &last_reference_list);
 
+    if (scan_resistant_ && priority != rocksdb::Cache::Priority::HIGH) {
+      // only what was evicted recently, i.e. is being read again, is
+      // admitted at the head of the LRU list
+      if (auto g = ghost_.find(hash); g != ghost_.end()) {
+        ghost_.erase(g);
+      } else {
+        e->SetProbation();
+      }
+    }
+
     if (usage_ - lru_usage_ + charge > capacity_ &&
         (strict_capacity_limit_ || handle == nullptr)) {
       if (handle == nullptr) {
@@ -10,8 +10,10 @@
 #ifndef ROCKSDB_BINNED_LRU_CACHE
 #define ROCKSDB_BINNED_LRU_CACHE
 
+#include <deque>
 #include <string>
 #include <mutex>
+#include <unordered_set>
 #include <boost/circular_buffer.hpp>
 
 #include "ShardedCache.h"
@@ -71,6 +73,8 @@ struct BinnedLRUHandle {
   //   in_cache:    whether this entry is referenced by the hash table.
   //   is_high_pri: whether this entry is high priority entry.
   //   in_high_pri_pool: whether this entry is in high-pri pool.
+  //   has_hit:     whether this entry was looked up since inserted.
+  //   probation:   whether this entry was not recently evicted when inserted.
   char flags;
 
   uint32_t hash;     // Hash of key(); used for fast sharding and comparisons
@@ -91,6 +95,7 @@ struct BinnedLRUHandle {
   bool IsHighPri() { return flags & 2; }
   bool InHighPriPool() { return flags & 4; }
   bool HasHit() { return flags & 8; }
+  bool InProbation() { return flags & 16; }
 
   void SetInCache(bool in_cache) {
     if (in_cache) {
@@ -118,6 +123,8 @@ struct BinnedLRUHandle {
 
   void SetHit() { flags |= 8; }
 
+  void SetProbation() { flags |= 16; }
+
   void Free() {
     ceph_assert((refs == 1 && InCache()) || (refs == 0 && !InCache()));
     if (deleter) {
@@ -263,6 +270,10 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
   // holding the mutex_
   void EvictFromLRU(size_t charge, ceph::autovector<BinnedLRUHandle*>* deleted);
 
+  // Remember the hash of an evicted entry, for admission of the next
+  // insert of the same key.  Needs mutex_.
+  void Ghost_Add(uint32_t hash);
+
   // Initialized before use.
   size_t capacity_;
 
@@ -287,6 +298,11 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
   // Pointer to head of low-pri pool in LRU list.
   BinnedLRUHandle* lru_low_pri_;
 
+  // Whether entries that were not evicted recently are inserted at the
+  // tail of the LRU list, and so evicted first unless they are hit again.
+  // This keeps blocks read once by a scan from pushing out the others.
+  bool scan_resistant_;
+
   // ------------^^^^^^^^^^^^^-----------
   // Not frequently modified data members
   // ------------------------------------
@@ -313,6 +329,10 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
 
   // Circular buffer of byte counters for age binning
   boost::circular_buffer<std::shared_ptr<uint64_t>> age_bins;
+
+  // Hashes of recently evicted entries, oldest first in ghost_fifo_
+  std::unordered_set<uint32_t> ghost_;
+  std::deque<uint32_t> ghost_fifo_;
 };
 
 class BinnedLRUCache : public ShardedCache {
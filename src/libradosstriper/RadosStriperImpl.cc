@@ -542,8 +542,9 @@ int libradosstriper::RadosStriperImpl::write(const std::string& soid,
   // open the object. This will create it if needed, retrieve its layout
   // and size and take a shared lock on it
   ceph_file_layout layout;
+  uint64_t size = len+off;
   std::string lockCookie;
-  int rc = createAndOpenStripedObject(soid, &layout, len+off, &lockCookie, true);
+  int rc = openStripedObjectForWrite(soid, &layout, &size, &lockCookie, true);
   if (rc) return rc;
   return write_in_open_object(soid, layout, lockCookie, bl, len, off);
 }
@@ -598,8 +599,9 @@ int libradosstriper::RadosStriperImpl::aio_write(const std::string& soid,
 						 uint64_t off)
 {
   ceph_file_layout layout;
+  uint64_t size = len+off;
   std::string lockCookie;
-  int rc = createAndOpenStripedObject(soid, &layout, len+off, &lockCookie, true);
+  int rc = openStripedObjectForWrite(soid, &layout, &size, &lockCookie, true);
   if (rc) return rc;
   return aio_write_in_open_object(soid, c, layout, lockCookie, bl, len, off);
 }
@@ -1371,13 +1373,29 @@ int libradosstriper::RadosStriperImpl::openStripedObjectForWrite(const std::stri
 {
   // take a lock the first rados object, if it exists
   // check and lock must be atomic and are thus done within a single operation
-  librados::ObjectWriteOperation op;
-  op.assert_exists();
   *lockCookie = getUUID();
   utime_t dur = utime_t();
-  rados::cls::lock::lock(&op, RADOS_LOCK_NAME, ClsLockType::SHARED, *lockCookie, "Tag", "", dur, 0);
   std::string firstObjOid = getObjectId(soid, 0);
-  int rc = m_ioCtx.operate(firstObjOid, &op);
+  // an absolute size does not depend on the current one, so growing the
+  // object to it goes in the same operation : a write extending an
+  // existing object then costs one round trip here instead of two
+  int rc = -ECANCELED;
+  bool sizeSet = false;
+  if (isFileSizeAbsolute) {
+    librados::ObjectWriteOperation op;
+    op.assert_exists();
+    rados::cls::lock::lock(&op, RADOS_LOCK_NAME, ClsLockType::SHARED, *lockCookie, "Tag", "", dur, 0);
+    setSizeIfGreater(op, *size);
+    rc = m_ioCtx.operate(firstObjOid, &op);
+    // -ECANCELED : the object is already that big
+    sizeSet = (rc == 0 || rc == -ECANCELED);
+  }
+  if (rc == -ECANCELED) {
+    librados::ObjectWriteOperation op;
+    op.assert_exists();
+    rados::cls::lock::lock(&op, RADOS_LOCK_NAME, ClsLockType::SHARED, *lockCookie, "Tag", "", dur, 0);
+    rc = m_ioCtx.operate(firstObjOid, &op);
+  }
   if (rc) {
     if (rc == -ENOENT) {
       // object does not exist, delegate to createEmptyStripedObject
@@ -1399,16 +1417,16 @@ int libradosstriper::RadosStriperImpl::openStripedObjectForWrite(const std::stri
 		   << soid << " : rc = " << rc << dendl;
     return rc;
   }
+  if (sizeSet) {
+    // return current size
+    *size = curSize;
+    return 0;
+  }
   // atomically update object size, only if smaller than current one
   if (!isFileSizeAbsolute)
     *size += curSize;
   librados::ObjectWriteOperation writeOp;
-  writeOp.cmpxattr(XATTR_SIZE, LIBRADOS_CMPXATTR_OP_GT, *size);
-  std::ostringstream oss;
-  oss << *size;
-  bufferlist bl;
-  bl.append(oss.str());
-  writeOp.setxattr(XATTR_SIZE, bl);
+  setSizeIfGreater(writeOp, *size);
   rc = m_ioCtx.operate(firstObjOid, &writeOp);
   // return current size
   *size = curSize;
@@ -1424,6 +1442,17 @@ int libradosstriper::RadosStriperImpl::openStripedObjectForWrite(const std::stri
   return rc;
 }
 
+void libradosstriper::RadosStriperImpl::setSizeIfGreater(librados::ObjectWriteOperation& op,
+							 uint64_t size)
+{
+  op.cmpxattr(XATTR_SIZE, LIBRADOS_CMPXATTR_OP_GT, size);
+  std::ostringstream oss;
+  oss << size;
+  bufferlist bl;
+  bl.append(oss.str());
+  op.setxattr(XATTR_SIZE, bl);
+}
+
 int libradosstriper::RadosStriperImpl::createAndOpenStripedObject(const std::string& soid,
 								  ceph_file_layout *layout,
 								  uint64_t size,
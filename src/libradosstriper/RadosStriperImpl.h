@@ -194,7 +194,8 @@ struct RadosStriperImpl {
    * calling createOrOpenStripedObject.
    * @param layout this is filled with the layout of the file
    * @param size new size of the file (together with isFileSizeAbsolute)
-   * In case of success, this is filled with the size of the file before the opening
+   * In case of success, this is filled with the size of the file before the opening,
+   * or after it if isFileSizeAbsolute is true
    * @param isFileSizeAbsolute if false, this means that the given size should
    * be added to the current file size (append mode)
    * @return 0 if everything is ok and the lock was taken. -errcode otherwise
@@ -205,6 +206,11 @@ struct RadosStriperImpl {
 				uint64_t *size,
 				std::string *lockCookie,
 				bool isFileSizeAbsolute);
+  /**
+   * adds to op the setting of the size xattr to size, which fails the
+   * whole op with -ECANCELED if the size is already greater or equal
+   */
+  void setSizeIfGreater(librados::ObjectWriteOperation& op, uint64_t size);
   /**
    * creates an empty striped object with the given size and opens it calling
    * openStripedObjectForWrite, which implies taking a shared lock on it
@@ -841,6 +841,7 @@ librados::IoCtx duplicate_io_ctx(librados::IoCtx& io_ctx) {
 
     bool skip_partial_discard = true;
     ASSIGN_OPTION(non_blocking_aio, bool);
+    ASSIGN_OPTION(io_run_to_completion, bool);
     ASSIGN_OPTION(cache, bool);
     ASSIGN_OPTION(sparse_read_threshold_bytes, Option::size_t);
     ASSIGN_OPTION(clone_copy_on_read, bool);
@@ -923,6 +924,18 @@ librados::IoCtx duplicate_io_ctx(librados::IoCtx& io_ctx) {
       config.get_val<uint64_t>("rbd_qos_write_bps_limit"),
       config.get_val<uint64_t>("rbd_qos_write_bps_burst"),
       config.get_val<uint64_t>("rbd_qos_write_bps_burst_seconds"));
+    io_image_dispatcher->apply_qos_limit(
+      io::IMAGE_DISPATCH_FLAG_QOS_POOL_IOPS_THROTTLE,
+      config.get_val<uint64_t>("rbd_qos_pool_iops_limit"), 0, 1);
+    io_image_dispatcher->apply_qos_limit(
+      io::IMAGE_DISPATCH_FLAG_QOS_POOL_BPS_THROTTLE,
+      config.get_val<uint64_t>("rbd_qos_pool_bps_limit"), 0, 1);
+    io_image_dispatcher->apply_qos_limit(
+      io::IMAGE_DISPATCH_FLAG_QOS_NAMESPACE_IOPS_THROTTLE,
+      config.get_val<uint64_t>("rbd_qos_namespace_iops_limit"), 0, 1);
+    io_image_dispatcher->apply_qos_limit(
+      io::IMAGE_DISPATCH_FLAG_QOS_NAMESPACE_BPS_THROTTLE,
+      config.get_val<uint64_t>("rbd_qos_namespace_bps_limit"), 0, 1);
     io_image_dispatcher->apply_qos_exclude_ops(
       librbd::io::rbd_io_operations_from_string(
         config.get_val<std::string>("rbd_qos_exclude_ops"), nullptr));
@@ -213,6 +213,7 @@ namespace librbd {
 
     /// Cached latency-sensitive configuration settings
     bool non_blocking_aio;
+    bool io_run_to_completion;
     bool cache;
     uint64_t sparse_read_threshold_bytes;
     uint64_t readahead_max_bytes = 0;
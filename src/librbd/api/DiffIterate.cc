@@ -33,6 +33,7 @@ namespace api {
 namespace {
 
 constexpr uint32_t LOCK_INTERVAL_SECONDS = 5;
+constexpr uint64_t OBJECT_RUNS_CHUNK_SIZE = 1 << 16;
 
 struct DiffContext {
   DiffIterate<>::Callback callback;
@@ -368,6 +369,11 @@ int DiffIterate<I>::execute() {
   ldout(cct, 5) << "diff_iterate from " << from_snap_id << " to "
                 << end_snap_id << " size from " << from_size
                 << " to " << end_size << dendl;
+  if (fast_diff_enabled && parent_diff.empty() &&
+      m_image_ctx.layout.stripe_count == 1) {
+    return execute_object_runs(start_object_no, object_diff_state);
+  }
+
   DiffContext diff_context(m_image_ctx, m_callback, m_callback_arg,
                            m_whole_object, m_include_parent, from_snap_id,
                            end_snap_id);
@@ -454,6 +460,75 @@ int DiffIterate<I>::execute() {
   return 0;
 }
 
+template <typename I>
+int DiffIterate<I>::execute_object_runs(uint64_t start_object_no,
+                                        const BitVector<2>& object_diff_state) {
+  // without striping, each object maps to a single image extent: walk
+  // the diff state in bulk instead of mapping the image range period by
+  // period.  Like the generic path, report every updated object with a
+  // callback of its own.
+  CephContext* cct = m_image_ctx.cct;
+  uint64_t object_size = m_image_ctx.layout.object_size;
+  uint64_t data_offset = m_image_ctx.get_data_offset();
+  uint64_t raw_start = m_offset + data_offset;
+  uint64_t raw_end = m_offset + m_length + data_offset;
+
+  auto report_run = [&](uint64_t diff_offset, uint64_t count,
+                        uint8_t diff_state) {
+    if (diff_state != object_map::DIFF_STATE_HOLE_UPDATED &&
+        diff_state != object_map::DIFF_STATE_DATA_UPDATED) {
+      return 0;
+    }
+    for (uint64_t object_no = start_object_no + diff_offset;
+         object_no < start_object_no + diff_offset + count; ++object_no) {
+      uint64_t start = std::max(object_no * object_size, raw_start);
+      uint64_t end = std::min((object_no + 1) * object_size, raw_end);
+      ldout(cct, 20) << "object "
+                     << util::data_object_name(&m_image_ctx, object_no)
+                     << ": diff_state=" << (int)diff_state << dendl;
+      int r = m_callback(start - data_offset, end - start,
+                         diff_state == object_map::DIFF_STATE_DATA_UPDATED,
+                         m_callback_arg);
+      if (r < 0) {
+        return r;
+      }
+    }
+    return 0;
+  };
+
+  std::vector<uint8_t> diff_states;
+  uint64_t run_offset = 0;
+  uint64_t run_count = 0;
+  uint8_t run_state = object_map::DIFF_STATE_HOLE;
+  for (uint64_t offset = 0; offset < object_diff_state.size();
+       offset += diff_states.size()) {
+    diff_states.resize(std::min(OBJECT_RUNS_CHUNK_SIZE,
+                                object_diff_state.size() - offset));
+    object_diff_state.get_elements(offset, diff_states.size(),
+                                   diff_states.data());
+    for (uint64_t i = 0; i < diff_states.size(); ++i) {
+      if (run_count > 0 && diff_states[i] == run_state) {
+        ++run_count;
+        continue;
+      }
+      int r = report_run(run_offset, run_count, run_state);
+      if (r < 0) {
+        return r;
+      }
+      run_offset = offset + i;
+      run_count = 1;
+      run_state = diff_states[i];
+    }
+  }
+  if (run_count > 0) {
+    int r = report_run(run_offset, run_count, run_state);
+    if (r < 0) {
+      return r;
+    }
+  }
+  return 0;
+}
+
 } // namespace api
 } // namespace librbd
 
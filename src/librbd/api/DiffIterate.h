@@ -55,6 +55,8 @@ private:
   std::pair<uint64_t, uint64_t> calc_object_diff_range();
 
   int execute();
+  int execute_object_runs(uint64_t start_object_no,
+                          const BitVector<2>& object_diff_state);
 };
 
 } // namespace api
@@ -2,6 +2,8 @@
 // vim: ts=8 sw=2 smarttab
 
 #include "common/errno.h"
+#include "common/safe_io.h"
+#include "include/compat.h"
 #include "include/neorados/RADOS.hpp"
 #include "librbd/ImageCtx.h"
 #include "librbd/Utils.h"
@@ -31,6 +33,8 @@ template <typename I>
 ParentCacheObjectDispatch<I>::ParentCacheObjectDispatch(
     I* image_ctx, plugin::Api<I>& plugin_api)
   : m_image_ctx(image_ctx), m_plugin_api(plugin_api),
+    m_open_files(image_ctx->config.template get_val<uint64_t>(
+      "rbd_parent_cache_max_open_files")),
     m_lock(ceph::make_mutex(
       "librbd::cache::ParentCacheObjectDispatch::lock", true, false)) {
   ceph_assert(m_image_ctx->data_ctx.is_valid());
@@ -39,6 +43,11 @@ ParentCacheObjectDispatch<I>::ParentCacheObjectDispatch(
   m_cache_client = new CacheClient(controller_path.c_str(), m_image_ctx->cct);
 }
 
+template <typename I>
+ParentCacheObjectDispatch<I>::CacheFile::~CacheFile() {
+  VOID_TEMP_FAILURE_RETRY(::close(fd));
+}
+
 template <typename I>
 ParentCacheObjectDispatch<I>::~ParentCacheObjectDispatch() {
   delete m_cache_client;
@@ -244,14 +253,29 @@ int ParentCacheObjectDispatch<I>::read_object(
   auto *cct = m_image_ctx->cct;
   ldout(cct, 20) << "file path: " << file_path << dendl;
 
-  std::string error;
-  int ret = read_data->pread_file(file_path.c_str(), offset, length, &error);
-  if (ret < 0) {
-    ldout(cct, 5) << "read from file return error: " << error
+  CacheFileRef file;
+  if (!m_open_files.lookup(file_path, &file)) {
+    int fd = TEMP_FAILURE_RETRY(::open(file_path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fd < 0) {
+      int r = -errno;
+      ldout(cct, 5) << "failed to open cache file " << file_path << ": "
+                    << cpp_strerror(r) << dendl;
+      return r;
+    }
+    file = std::make_shared<CacheFile>(fd);
+    m_open_files.add(file_path, file);
+  }
+
+  ceph::bufferptr bp(length);
+  ssize_t r = safe_pread(file->fd, bp.c_str(), length, offset);
+  if (r < 0) {
+    ldout(cct, 5) << "read from file return error: " << cpp_strerror(r)
                   << "file path= " << file_path
                   << dendl;
-    return ret;
+    return r;
   }
+  bp.set_length(r);
+  read_data->push_back(std::move(bp));
   return read_data->length();
 }
 
@@ -6,6 +6,7 @@
 
 #include "librbd/io/ObjectDispatchInterface.h"
 #include "common/ceph_mutex.h"
+#include "common/simple_cache.hpp"
 #include "librbd/cache/TypeTraits.h"
 #include "tools/immutable_object_cache/CacheClient.h"
 #include "tools/immutable_object_cache/Types.h"
@@ -145,8 +146,18 @@ private:
   int handle_register_client(bool reg);
   void create_cache_session(Context* on_finish, bool is_reconnect);
 
+  /* An open cache file.  Promoted files are immutable, and the data of
+   * an evicted (unlinked) one is still valid, so they can stay open. */
+  struct CacheFile {
+    int fd;
+    explicit CacheFile(int fd) : fd(fd) {}
+    ~CacheFile();
+  };
+  using CacheFileRef = std::shared_ptr<CacheFile>;
+
   ImageCtxT* m_image_ctx;
   plugin::Api<ImageCtxT>& m_plugin_api;
+  SimpleLRU<std::string, CacheFileRef> m_open_files;
 
   ceph::mutex m_lock;
   CacheClient *m_cache_client = nullptr;
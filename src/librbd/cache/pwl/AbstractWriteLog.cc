@@ -74,6 +74,10 @@ AbstractWriteLog<I>::AbstractWriteLog(
                  &m_thread_pool)
 {
   CephContext *cct = m_image_ctx.cct;
+  m_flush_ops_limit = image_ctx.config.template get_val<uint64_t>(
+    "rbd_persistent_cache_writeback_max_ops");
+  m_flush_bytes_limit = image_ctx.config.template get_val<Option::size_t>(
+    "rbd_persistent_cache_writeback_max_bytes");
   m_plugin_api.get_image_timer_instance(cct, &m_timer, &m_timer_lock);
 }
 
@@ -1643,8 +1647,8 @@ bool AbstractWriteLog<I>::can_flush_entry(std::shared_ptr<GenericLogEntry> log_e
   }
 
   return (log_entry->can_writeback() &&
-         (m_flush_ops_in_flight <= IN_FLIGHT_FLUSH_WRITE_LIMIT) &&
-         (m_flush_bytes_in_flight <= IN_FLIGHT_FLUSH_BYTES_LIMIT));
+         ((uint64_t)m_flush_ops_in_flight <= m_flush_ops_limit) &&
+         ((uint64_t)m_flush_bytes_in_flight <= m_flush_bytes_limit));
 }
 
 template <typename I>
@@ -1658,7 +1662,12 @@ void AbstractWriteLog<I>::detain_flush_guard_request(std::shared_ptr<GenericLogE
   } else {
     extent = log_entry->ram_entry.block_extent();
   }
+  detain_flush_guard_request(extent, guarded_ctx);
+}
 
+template <typename I>
+void AbstractWriteLog<I>::detain_flush_guard_request(const BlockExtent &extent,
+						     GuardedRequestFunctionContext *guarded_ctx) {
   auto req = GuardedRequest(extent, guarded_ctx, false);
   BlockGuardCell *cell = nullptr;
 
@@ -1713,7 +1722,11 @@ Context* AbstractWriteLog<I>::construct_flush_entry(std::shared_ptr<GenericLogEn
 	BlockGuardCell *detained_cell = nullptr;
 
 	std::lock_guard locker{m_flush_guard_lock};
-	m_flush_guard.release(log_entry->m_cell, &block_reqs);
+	/* Entries flushed as part of a merged write share the cell of the
+	 * first one */
+	if (log_entry->m_cell) {
+	  m_flush_guard.release(log_entry->m_cell, &block_reqs);
+	}
 
 	for (auto &req : block_reqs) {
 	  m_flush_guard.detain(req.block_extent, &req, &detained_cell);
@@ -1750,7 +1763,7 @@ void AbstractWriteLog<I>::process_writeback_dirty_entries() {
 
     std::shared_lock entry_reader_locker(m_entry_reader_lock);
     std::lock_guard locker(m_lock);
-    while (flushed < IN_FLIGHT_FLUSH_WRITE_LIMIT) {
+    while ((uint64_t)flushed < m_flush_ops_limit) {
       if (m_shutting_down) {
         ldout(cct, 5) << "Flush during shutdown suppressed" << dendl;
         /* Do flush complete only when all flush ops are finished */
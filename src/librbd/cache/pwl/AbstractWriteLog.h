@@ -205,6 +205,9 @@ private:
 
   int m_flush_ops_in_flight = 0;
   int m_flush_bytes_in_flight = 0;
+  /* Writeback concurrency limits (rbd_persistent_cache_writeback_max_*) */
+  uint64_t m_flush_ops_limit;
+  uint64_t m_flush_bytes_limit;
   uint64_t m_lowest_flushing_sync_gen = 0;
 
   /* Writes that have left the block guard, but are waiting for resources */
@@ -348,6 +351,8 @@ protected:
       const std::shared_ptr<pwl::GenericLogEntry> log_entry, bool invalidating);
   void detain_flush_guard_request(std::shared_ptr<GenericLogEntry> log_entry,
                                   GuardedRequestFunctionContext *guarded_ctx);
+  void detain_flush_guard_request(const BlockExtent &extent,
+                                  GuardedRequestFunctionContext *guarded_ctx);
   void process_writeback_dirty_entries();
   bool can_retire_entry(const std::shared_ptr<pwl::GenericLogEntry> log_entry);
 
@@ -166,8 +166,6 @@ namespace pwl {
 
 class ImageExtentBuf;
 
-const int IN_FLIGHT_FLUSH_WRITE_LIMIT = 64;
-const int IN_FLIGHT_FLUSH_BYTES_LIMIT = (1 * 1024 * 1024);
 
 /* Limit work between sync points */
 const uint64_t MAX_WRITES_PER_SYNC_POINT = 256;
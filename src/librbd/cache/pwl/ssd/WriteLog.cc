@@ -55,7 +55,9 @@ WriteLog<I>::WriteLog(
     cache::ImageWritebackInterface& image_writeback,
     plugin::Api<I>& plugin_api)
   : AbstractWriteLog<I>(image_ctx, cache_state, create_builder(),
-                        image_writeback, plugin_api)
+                        image_writeback, plugin_api),
+    m_writeback_merge_bytes(image_ctx.config.template get_val<Option::size_t>(
+      "rbd_persistent_cache_writeback_merge_bytes"))
 {
 }
 
@@ -598,47 +600,125 @@ void WriteLog<I>::construct_flush_entries(pwl::GenericLogEntries entries_to_flus
         int i = 0;
 	GuardedRequestFunctionContext *guarded_ctx = nullptr;
 
+	/* Plain writes that are contiguous in the image are merged into one
+	 * image write. They were all found flushable together, so they could
+	 * have been in flight at the same time anyway. */
+	pwl::GenericLogEntries merged;
+	bufferlist merged_bl;
+	auto flush_merged = [&]() {
+	  if (merged.size() > 1) {
+	    flush_merged_entries(std::move(merged), std::move(merged_bl));
+	  } else if (merged.size() == 1) {
+	    flush_entry_bl(merged.front(), std::move(merged_bl));
+	  }
+	  merged.clear();
+	  merged_bl.clear();
+	};
+
 	for (auto &log_entry : entries_to_flush) {
 	  if (log_entry->is_write_entry()) {
 	    bufferlist captured_entry_bl;
 	    captured_entry_bl.claim_append(*read_bls[i]);
 	    delete read_bls[i++];
 
-	    guarded_ctx = new GuardedRequestFunctionContext([this, log_entry, captured_entry_bl]
-              (GuardedRequestFunctionContext &guard_ctx) {
-                log_entry->m_cell = guard_ctx.cell;
-                Context *ctx = this->construct_flush_entry(log_entry, false);
-
-	        m_image_ctx.op_work_queue->queue(new LambdaContext(
-	          [this, log_entry, entry_bl=std::move(captured_entry_bl), ctx](int r) {
-		    auto captured_entry_bl = std::move(entry_bl);
-		    ldout(m_image_ctx.cct, 15) << "flushing:" << log_entry
-			                       << " " << *log_entry << dendl;
-		    log_entry->writeback_bl(this->m_image_writeback, ctx,
-                                            std::move(captured_entry_bl));
-	          }), 0);
-	      });
-	  } else {
-	    guarded_ctx = new GuardedRequestFunctionContext([this, log_entry]
-              (GuardedRequestFunctionContext &guard_ctx) {
-                log_entry->m_cell = guard_ctx.cell;
-                Context *ctx = this->construct_flush_entry(log_entry, false);
-	        m_image_ctx.op_work_queue->queue(new LambdaContext(
-		  [this, log_entry, ctx](int r) {
-		    ldout(m_image_ctx.cct, 15) << "flushing:" << log_entry
-                                               << " " << *log_entry << dendl;
-		    log_entry->writeback(this->m_image_writeback, ctx);
-		  }), 0);
-            });
+	    if (log_entry->is_writesame_entry() || !m_writeback_merge_bytes) {
+	      flush_merged();
+	      flush_entry_bl(log_entry, std::move(captured_entry_bl));
+	      continue;
+	    }
+	    if (!merged.empty() &&
+	        (merged.back()->ram_entry.image_offset_bytes +
+	           merged.back()->ram_entry.write_bytes !=
+	         log_entry->ram_entry.image_offset_bytes ||
+	         merged_bl.length() + captured_entry_bl.length() >
+	           m_writeback_merge_bytes)) {
+	      flush_merged();
+	    }
+	    merged.push_back(log_entry);
+	    merged_bl.claim_append(captured_entry_bl);
+	    continue;
 	  }
+	  flush_merged();
+	  guarded_ctx = new GuardedRequestFunctionContext([this, log_entry]
+            (GuardedRequestFunctionContext &guard_ctx) {
+              log_entry->m_cell = guard_ctx.cell;
+              Context *ctx = this->construct_flush_entry(log_entry, false);
+	      m_image_ctx.op_work_queue->queue(new LambdaContext(
+		[this, log_entry, ctx](int r) {
+		  ldout(m_image_ctx.cct, 15) << "flushing:" << log_entry
+                                             << " " << *log_entry << dendl;
+		  log_entry->writeback(this->m_image_writeback, ctx);
+		}), 0);
+          });
           this->detain_flush_guard_request(log_entry, guarded_ctx);
 	}
+	flush_merged();
       });
 
     aio_read_data_blocks(write_entries, read_bls, ctx);
   }
 }
 
+template <typename I>
+void WriteLog<I>::flush_entry_bl(std::shared_ptr<GenericLogEntry> log_entry,
+                                 bufferlist &&entry_bl) {
+  GuardedRequestFunctionContext *guarded_ctx =
+    new GuardedRequestFunctionContext([this, log_entry, entry_bl]
+      (GuardedRequestFunctionContext &guard_ctx) {
+        log_entry->m_cell = guard_ctx.cell;
+        Context *ctx = this->construct_flush_entry(log_entry, false);
+
+        m_image_ctx.op_work_queue->queue(new LambdaContext(
+          [this, log_entry, entry_bl, ctx](int r) mutable {
+            ldout(m_image_ctx.cct, 15) << "flushing:" << log_entry
+                                       << " " << *log_entry << dendl;
+            log_entry->writeback_bl(this->m_image_writeback, ctx,
+                                    std::move(entry_bl));
+          }), 0);
+      });
+  this->detain_flush_guard_request(log_entry, guarded_ctx);
+}
+
+template <typename I>
+void WriteLog<I>::flush_merged_entries(pwl::GenericLogEntries &&log_entries,
+                                       bufferlist &&merged_bl) {
+  uint64_t offset = log_entries.front()->ram_entry.image_offset_bytes;
+  uint64_t length = merged_bl.length();
+  ldout(m_image_ctx.cct, 20) << "merging " << log_entries.size()
+                             << " entries into " << offset << "~" << length
+                             << dendl;
+
+  /* A single cell covers the whole extent, so no entry of the group holds
+   * its part while waiting for another. It belongs to the first entry,
+   * and is released when the whole group is written back. */
+  GuardedRequestFunctionContext *guarded_ctx =
+    new GuardedRequestFunctionContext([this, log_entries, merged_bl, offset]
+      (GuardedRequestFunctionContext &guard_ctx) {
+        log_entries.front()->m_cell = guard_ctx.cell;
+        std::vector<Context*> entry_ctxs;
+        for (auto &log_entry : log_entries) {
+          entry_ctxs.push_back(this->construct_flush_entry(log_entry, false));
+        }
+        Context *ctx = new LambdaContext([entry_ctxs](int r) {
+            for (auto entry_ctx : entry_ctxs) {
+              entry_ctx->complete(r);
+            }
+          });
+
+        m_image_ctx.op_work_queue->queue(new LambdaContext(
+          [this, n=log_entries.size(), merged_bl, offset, ctx](int r) mutable {
+            ldout(m_image_ctx.cct, 15) << "flushing " << n
+                                       << " merged entries at " << offset
+                                       << "~" << merged_bl.length() << dendl;
+            uint64_t length = merged_bl.length();
+            this->m_image_writeback.aio_write({{offset, length}},
+                                              std::move(merged_bl), 0, ctx);
+          }), 0);
+      });
+  this->detain_flush_guard_request(
+    pwl::block_extent(io::Extent(offset, length)), guarded_ctx);
+}
+
 template <typename I>
 void WriteLog<I>::process_work() {
   CephContext *cct = m_image_ctx.cct;
@@ -72,6 +72,9 @@ protected:
   void release_ram(std::shared_ptr<GenericLogEntry> log_entry) override;
 
 private:
+  /* Largest image write that adjacent dirty entries are merged into */
+  const uint64_t m_writeback_merge_bytes;
+
  class AioTransContext {
    public:
      Context *on_finish;
@@ -125,6 +128,10 @@ private:
   void construct_flush_entries(pwl::GenericLogEntries entires_to_flush,
 				DeferredContexts &post_unlock,
 				bool has_write_entry) override;
+  void flush_entry_bl(std::shared_ptr<GenericLogEntry> log_entry,
+                      bufferlist &&entry_bl);
+  void flush_merged_entries(pwl::GenericLogEntries &&log_entries,
+                            bufferlist &&merged_bl);
   void append_ops(GenericLogOperations &ops, Context *ctx,
                   uint64_t* new_first_free_entry);
   void write_log_entries(GenericLogEntriesVector log_entries,
@@ -150,12 +150,16 @@ void ImageCopyRequest<I>::send_object_copies() {
   bool complete;
   {
     std::lock_guard locker{m_lock};
-    auto max_ops = m_src_image_ctx->config.template get_val<uint64_t>(
+    m_max_ops = m_src_image_ctx->config.template get_val<uint64_t>(
       "rbd_concurrent_management_ops");
+    m_max_ops_limit = std::max(
+      m_max_ops, m_src_image_ctx->config.template get_val<uint64_t>(
+        "rbd_deep_copy_max_concurrent_ops"));
+    m_adaptive_ops = (m_max_ops_limit > m_max_ops);
 
     // attempt to schedule at least 'max_ops' initial requests where
     // some objects might be skipped if fast-diff notes no change
-    for (uint64_t i = 0; i < max_ops; i++) {
+    for (uint64_t i = 0; i < m_max_ops; i++) {
       send_next_object_copy();
     }
 
@@ -181,9 +185,10 @@ void ImageCopyRequest<I>::send_next_object_copy() {
   }
 
   uint64_t ono = m_object_no++;
+  auto start_time = ceph::mono_clock::now();
   Context *ctx = new LambdaContext(
-    [this, ono](int r) {
-      handle_object_copy(ono, r);
+    [this, ono, start_time](int r) {
+      handle_object_copy(ono, start_time, r);
     });
 
   ldout(m_cct, 20) << "object_num=" << ono << dendl;
@@ -211,6 +216,9 @@ void ImageCopyRequest<I>::send_next_object_copy() {
 
     if (object_diff_state == object_map::DIFF_STATE_HOLE) {
       ldout(m_cct, 20) << "skipping non-existent object " << ono << dendl;
+      ctx = new LambdaContext([this, ono](int r) {
+          handle_object_copy(ono, {}, r);
+        });
       create_async_context_callback(*m_src_image_ctx, ctx)->complete(0);
       return;
     }
@@ -232,7 +240,8 @@ void ImageCopyRequest<I>::send_next_object_copy() {
 }
 
 template <typename I>
-void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
+void ImageCopyRequest<I>::handle_object_copy(
+    uint64_t object_no, ceph::mono_clock::time_point start_time, int r) {
   ldout(m_cct, 20) << "object_no=" << object_no << ", r=" << r << dendl;
 
   bool complete;
@@ -241,6 +250,10 @@ void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
     ceph_assert(m_current_ops > 0);
     --m_current_ops;
 
+    if (r >= 0 && start_time != ceph::mono_clock::time_point()) {
+      update_max_ops(ceph::mono_clock::now() - start_time);
+    }
+
     if (r < 0 && r != -ENOENT) {
       lderr(m_cct) << "object copy failed: " << cpp_strerror(r) << dendl;
       if (m_ret_val == 0) {
@@ -263,7 +276,10 @@ void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
       }
     }
 
-    send_next_object_copy();
+    while (m_current_ops < m_max_ops && m_ret_val == 0 &&
+           m_object_no < m_end_object_no) {
+      send_next_object_copy();
+    }
     complete = (m_current_ops == 0) && !m_updating_progress;
   }
 
@@ -272,6 +288,44 @@ void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
   }
 }
 
+template <typename I>
+void ImageCopyRequest<I>::update_max_ops(ceph::timespan latency) {
+  ceph_assert(ceph_mutex_is_locked(m_lock));
+
+  if (!m_adaptive_ops) {
+    return;
+  }
+
+  m_window_latency += latency;
+  if (++m_window_ops < m_max_ops) {
+    return;
+  }
+
+  auto mean_latency = m_window_latency / m_window_ops;
+  m_window_ops = 0;
+  m_window_latency = ceph::timespan::zero();
+
+  if (m_min_latency == ceph::timespan::zero() ||
+      mean_latency < m_min_latency) {
+    m_min_latency = mean_latency;
+  }
+
+  // additive increase while the latency stays close to the best one
+  // observed, multiplicative decrease once requests start to queue up
+  auto max_ops = m_max_ops;
+  if (mean_latency > 2 * m_min_latency) {
+    m_max_ops = std::max<uint64_t>(1, m_max_ops * 3 / 4);
+  } else if (m_max_ops < m_max_ops_limit) {
+    ++m_max_ops;
+  }
+
+  if (max_ops != m_max_ops) {
+    ldout(m_cct, 10) << "mean_latency=" << mean_latency << ", "
+                     << "min_latency=" << m_min_latency << ", "
+                     << "max_ops=" << max_ops << "->" << m_max_ops << dendl;
+  }
+}
+
 template <typename I>
 void ImageCopyRequest<I>::finish(int r) {
   ldout(m_cct, 20) << "r=" << r << dendl;
@@ -8,6 +8,7 @@
 #include "include/rados/librados.hpp"
 #include "common/bit_vector.hpp"
 #include "common/ceph_mutex.h"
+#include "common/ceph_time.h"
 #include "common/RefCountedObj.h"
 #include "librbd/Types.h"
 #include "librbd/deep_copy/Types.h"
@@ -95,6 +96,16 @@ private:
   uint64_t m_object_no = 0;
   uint64_t m_end_object_no = 0;
   uint64_t m_current_ops = 0;
+
+  // adaptive concurrency: the limit is adjusted once per window of
+  // m_max_ops object copies based on their mean latency
+  bool m_adaptive_ops = false;
+  uint64_t m_max_ops = 0;
+  uint64_t m_max_ops_limit = 0;
+  uint64_t m_window_ops = 0;
+  ceph::timespan m_window_latency = ceph::timespan::zero();
+  ceph::timespan m_min_latency = ceph::timespan::zero();
+
   std::priority_queue<
     uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> m_copied_objects;
   bool m_updating_progress = false;
@@ -110,7 +121,9 @@ private:
 
   void send_object_copies();
   void send_next_object_copy();
-  void handle_object_copy(uint64_t object_no, int r);
+  void handle_object_copy(uint64_t object_no,
+                          ceph::mono_clock::time_point start_time, int r);
+  void update_max_ops(ceph::timespan latency);
 
   void finish(int r);
 };
@@ -1658,6 +1658,10 @@ int validate_pool(IoCtx &io_ctx, CephContext *cct) {
                    << dendl;
     int i = 0;
     while (i < numcomp && ictx->event_socket_completions.pop(comps[i])) {
+      if (comps[i]->deferred_callback) {
+        // run-to-completion mode: invoke the callback on this thread
+        comps[i]->complete_deferred_callback();
+      }
       ++i;
     }
 
@@ -255,6 +255,16 @@ ssize_t AioCompletion::get_return_value() {
 void AioCompletion::complete_external_callback() {
   get();
 
+  if (ictx->io_run_to_completion && event_notify &&
+      ictx->event_socket.is_valid()) {
+    // the callback will be invoked by the thread that polls for this
+    // completion instead of hopping to the api strand
+    deferred_callback = true;
+    ictx->event_socket_completions.push(this);
+    ictx->event_socket.notify();
+    return;
+  }
+
   // ensure librbd external users never experience concurrent callbacks
   // from multiple librbd-internal threads.
   boost::asio::dispatch(ictx->asio_engine->get_api_strand(), [this]() {
@@ -265,6 +275,15 @@ void AioCompletion::complete_external_callback() {
     });
 }
 
+void AioCompletion::complete_deferred_callback() {
+  ceph_assert(deferred_callback);
+  deferred_callback = false;
+
+  complete_cb(rbd_comp, complete_arg);
+  notify_callbacks_complete();
+  put();
+}
+
 void AioCompletion::complete_event_socket() {
   if (ictx != nullptr && event_notify && ictx->event_socket.is_valid()) {
     ictx->event_socket_completions.push(this);
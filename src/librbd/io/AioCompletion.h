@@ -71,6 +71,7 @@ struct AioCompletion {
   bool event_notify = false;
   bool was_armed = false;
   bool external_callback = false;
+  bool deferred_callback = false;
 
   Context* image_dispatcher_ctx = nullptr;
 
@@ -177,6 +178,8 @@ struct AioCompletion {
     return complete_arg;
   }
 
+  void complete_deferred_callback();
+
 private:
   void queue_complete();
   void complete_external_callback();
@@ -6,6 +6,7 @@
 #include "librbd/AsioEngine.h"
 #include "librbd/ImageCtx.h"
 #include "librbd/io/FlushTracker.h"
+#include <map>
 #include <utility>
 
 #define dout_subsys ceph_subsys_rbd
@@ -45,6 +46,61 @@ static const std::pair<uint64_t, const char*> throttle_flags[] = {
   {IMAGE_DISPATCH_FLAG_QOS_WRITE_BPS_THROTTLE,  "rbd_qos_write_bps_throttle"  }
 };
 
+static const std::pair<uint64_t, const char*> shared_throttle_flags[] = {
+  {IMAGE_DISPATCH_FLAG_QOS_POOL_IOPS_THROTTLE,  "rbd_qos_pool_iops_throttle"  },
+  {IMAGE_DISPATCH_FLAG_QOS_POOL_BPS_THROTTLE,   "rbd_qos_pool_bps_throttle"   },
+  {IMAGE_DISPATCH_FLAG_QOS_NAMESPACE_IOPS_THROTTLE,
+    "rbd_qos_namespace_iops_throttle"},
+  {IMAGE_DISPATCH_FLAG_QOS_NAMESPACE_BPS_THROTTLE,
+    "rbd_qos_namespace_bps_throttle"}
+};
+
+bool is_shared_throttle_flag(uint64_t flag) {
+  for (auto [shared_flag, name] : shared_throttle_flags) {
+    if (flag == shared_flag) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// token buckets shared by all images of a pool (or pool namespace) that
+// are open within the same CephContext and configured with the same limit
+struct SharedThrottles {
+  ceph::mutex lock = ceph::make_mutex("librbd::io::SharedThrottles::lock");
+  std::map<std::string, std::weak_ptr<TokenBucketThrottle>> throttles;
+
+  explicit SharedThrottles(CephContext*) {
+  }
+
+  std::shared_ptr<TokenBucketThrottle> get(
+      CephContext* cct, const std::string& scope, uint64_t limit,
+      SafeTimer* timer, ceph::mutex* timer_lock) {
+    // the limit is part of the key, so that an image applying its config
+    // never changes the rate of a bucket that others are configured for
+    auto name = scope + "." + std::to_string(limit);
+    std::lock_guard locker{lock};
+    auto& weak_throttle = throttles[name];
+    auto throttle = weak_throttle.lock();
+    if (!throttle) {
+      throttle = std::make_shared<TokenBucketThrottle>(
+        cct, name, 0, 0, timer, timer_lock);
+      throttle->set_limit(limit, 0, 1);
+      weak_throttle = throttle;
+    }
+
+    // prune the entries of closed pools / namespaces
+    for (auto it = throttles.begin(); it != throttles.end(); ) {
+      if (it->second.expired()) {
+        it = throttles.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    return throttle;
+  }
+};
+
 } // anonymous namespace
 
 template <typename I>
@@ -59,15 +115,44 @@ QosImageDispatch<I>::QosImageDispatch(I* image_ctx)
   for (auto [flag, name] : throttle_flags) {
     m_throttles.emplace_back(
       flag,
-      new TokenBucketThrottle(cct, name, 0, 0, timer, timer_lock));
+      std::make_shared<TokenBucketThrottle>(cct, name, 0, 0, timer,
+                                            timer_lock));
+  }
+
+  for (auto [flag, name] : shared_throttle_flags) {
+    m_throttles.emplace_back(flag, get_shared_throttle(flag, 0));
   }
 }
 
 template <typename I>
-QosImageDispatch<I>::~QosImageDispatch() {
-  for (auto t : m_throttles) {
-    delete t.second;
+std::shared_ptr<TokenBucketThrottle> QosImageDispatch<I>::get_shared_throttle(
+    uint64_t flag, uint64_t limit) {
+  auto cct = m_image_ctx->cct;
+  SafeTimer *timer;
+  ceph::mutex *timer_lock;
+  ImageCtx::get_timer_instance(cct, &timer, &timer_lock);
+
+  auto shared_throttles = &cct->template lookup_or_create_singleton_object<
+    SharedThrottles>("librbd::io::qos_shared_throttles", false, cct);
+  auto pool_id = std::to_string(m_image_ctx->md_ctx.get_id());
+  std::string scope;
+  for (auto [shared_flag, name] : shared_throttle_flags) {
+    if (flag == shared_flag) {
+      scope = name;
+      break;
+    }
   }
+  if ((flag & (IMAGE_DISPATCH_FLAG_QOS_NAMESPACE_IOPS_THROTTLE |
+               IMAGE_DISPATCH_FLAG_QOS_NAMESPACE_BPS_THROTTLE)) != 0) {
+    scope += "." + pool_id + "/" + m_image_ctx->md_ctx.get_namespace();
+  } else {
+    scope += "." + pool_id;
+  }
+  return shared_throttles->get(cct, scope, limit, timer, timer_lock);
+}
+
+template <typename I>
+QosImageDispatch<I>::~QosImageDispatch() {
 }
 
 template <typename I>
@@ -78,8 +163,9 @@ void QosImageDispatch<I>::shut_down(Context* on_finish) {
 
 template <typename I>
 void QosImageDispatch<I>::apply_qos_schedule_tick_min(uint64_t tick) {
-  for (auto pair : m_throttles) {
-    pair.second->set_schedule_tick_min(tick);
+  m_qos_schedule_tick_min = tick;
+  for (auto& pair : m_throttles) {
+    std::atomic_load(&pair.second)->set_schedule_tick_min(tick);
   }
 }
 
@@ -88,11 +174,27 @@ void QosImageDispatch<I>::apply_qos_limit(uint64_t flag, uint64_t limit,
                                           uint64_t burst, uint64_t burst_seconds) {
   auto cct = m_image_ctx->cct;
   TokenBucketThrottle *throttle = nullptr;
-  for (auto pair : m_throttles) {
-    if (flag == pair.first) {
-      throttle = pair.second;
-      break;
+  for (auto& pair : m_throttles) {
+    if (flag != pair.first) {
+      continue;
+    }
+    if (is_shared_throttle_flag(flag)) {
+      // move over to the bucket of the images with the same limit, I/Os
+      // already waiting in the old one are released at its rate
+      auto shared_throttle = get_shared_throttle(flag, limit);
+      if (m_qos_schedule_tick_min) {
+        shared_throttle->set_schedule_tick_min(m_qos_schedule_tick_min);
+      }
+      std::atomic_store(&pair.second, shared_throttle);
+      if (limit) {
+        m_qos_enabled_flag |= flag;
+      } else {
+        m_qos_enabled_flag &= ~flag;
+      }
+      return;
     }
+    throttle = pair.second.get();
+    break;
   }
   ceph_assert(throttle != nullptr);
 
@@ -290,11 +392,13 @@ bool QosImageDispatch<I>::needs_throttle(
   *dispatch_result = DISPATCH_RESULT_CONTINUE;
 
   auto qos_enabled_flag = m_qos_enabled_flag;
-  for (auto [flag, throttle] : m_throttles) {
+  for (auto& [flag, throttle_ref] : m_throttles) {
     if ((qos_enabled_flag & flag) == 0) {
       all_qos_flags_set = set_throttle_flag(image_dispatch_flags, flag);
       continue;
     }
+    // the pool and namespace throttles can be swapped by apply_qos_limit()
+    auto throttle = std::atomic_load(&throttle_ref);
 
     auto tokens = calculate_tokens(read_op, extent_length, flag);
     if (tokens > 0 &&
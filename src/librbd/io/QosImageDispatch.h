@@ -109,14 +109,21 @@ public:
 private:
   ImageCtxT* m_image_ctx;
 
-  std::list<std::pair<uint64_t, TokenBucketThrottle*> > m_throttles;
+  // per-image throttles followed by the pool and namespace throttles
+  // shared with the other images open in the same client
+  std::list<std::pair<uint64_t, std::shared_ptr<TokenBucketThrottle>>>
+    m_throttles;
   uint64_t m_qos_enabled_flag = 0;
   uint64_t m_qos_exclude_ops = 0;
+  uint64_t m_qos_schedule_tick_min = 0;
 
   std::unique_ptr<FlushTracker<ImageCtxT>> m_flush_tracker;
 
   void handle_finished(int r, uint64_t tid);
 
+  std::shared_ptr<TokenBucketThrottle> get_shared_throttle(uint64_t flag,
+                                                           uint64_t limit);
+
   bool set_throttle_flag(std::atomic<uint32_t>* image_dispatch_flags,
                          uint32_t flag);
   bool needs_throttle(bool read_op, const Extents& image_extents, uint64_t tid,
@@ -5,7 +5,9 @@
 #include "common/dout.h"
 #include "common/Cond.h"
 #include "librbd/AsioEngine.h"
+#include "librbd/ExclusiveLock.h"
 #include "librbd/ImageCtx.h"
+#include "librbd/ImageState.h"
 #include "librbd/Utils.h"
 #include "librbd/io/AioCompletion.h"
 #include "librbd/io/FlushTracker.h"
@@ -127,6 +129,18 @@ void QueueImageDispatch<I>::handle_finished(int r, uint64_t tid) {
   m_flush_tracker->finish_io(tid);
 }
 
+template <typename I>
+bool QueueImageDispatch<I>::can_run_to_completion() const {
+  if (m_queued_ops > 0 || m_image_ctx->cache ||
+      m_image_ctx->state->is_refresh_required()) {
+    return false;
+  }
+
+  std::shared_lock owner_locker{m_image_ctx->owner_lock};
+  return (m_image_ctx->exclusive_lock == nullptr ||
+          m_image_ctx->exclusive_lock->is_lock_owner());
+}
+
 template <typename I>
 bool QueueImageDispatch<I>::enqueue(
     bool read_op, uint64_t tid, DispatchResult* dispatch_result,
@@ -135,6 +149,21 @@ bool QueueImageDispatch<I>::enqueue(
     return false;
   }
 
+  if (m_image_ctx->io_run_to_completion) {
+    if (can_run_to_completion()) {
+      // no lower layer will block: continue dispatching in caller's thread
+      ldout(m_image_ctx->cct, 20) << "run-to-completion: tid=" << tid << dendl;
+      return false;
+    }
+
+    // track queued ops so that later ops cannot overtake them
+    ++m_queued_ops;
+    on_dispatched = new LambdaContext([this, on_dispatched](int r) {
+        --m_queued_ops;
+        on_dispatched->complete(r);
+      });
+  }
+
   if (!read_op) {
     m_flush_tracker->start_io(tid);
     *on_finish = new LambdaContext([this, tid, on_finish=*on_finish](int r) {
@@ -11,6 +11,7 @@
 #include "common/Throttle.h"
 #include "librbd/io/ReadResult.h"
 #include "librbd/io/Types.h"
+#include <atomic>
 #include <list>
 #include <set>
 
@@ -95,8 +96,12 @@ private:
 
   FlushTracker<ImageCtxT>* m_flush_tracker;
 
+  std::atomic<uint64_t> m_queued_ops = {0};
+
   void handle_finished(int r, uint64_t tid);
 
+  bool can_run_to_completion() const;
+
   bool enqueue(bool read_op, uint64_t tid, DispatchResult* dispatch_result,
                Context** on_finish, Context* on_dispatched);
 
@@ -184,7 +184,9 @@ SimpleSchedulerObjectDispatch<I>::SimpleSchedulerObjectDispatch(
     m_lock(ceph::make_mutex(librbd::util::unique_lock_name(
       "librbd::io::SimpleSchedulerObjectDispatch::lock", this))),
     m_max_delay(image_ctx->config.template get_val<uint64_t>(
-      "rbd_io_scheduler_simple_max_delay")) {
+      "rbd_io_scheduler_simple_max_delay")),
+    m_merge_reads(image_ctx->config.template get_val<bool>(
+      "rbd_io_scheduler_simple_merge_reads")) {
   CephContext *cct = m_image_ctx->cct;
   ldout(cct, 5) << "ictx=" << image_ctx << dendl;
 
@@ -237,6 +239,10 @@ bool SimpleSchedulerObjectDispatch<I>::read(
     }
   }
 
+  if (m_merge_reads) {
+    return try_hold_read(object_no, extents, io_context, op_flags, read_flags,
+                         version, dispatch_result, on_finish, on_dispatched);
+  }
   return false;
 }
 
@@ -559,6 +565,151 @@ void SimpleSchedulerObjectDispatch<I>::schedule_dispatch_delayed_requests() {
   m_timer->add_event_at(object_requests->get_dispatch_time(), m_timer_task);
 }
 
+template <typename I>
+bool SimpleSchedulerObjectDispatch<I>::try_hold_read(
+    uint64_t object_no, ReadExtents* extents, IOContext io_context,
+    int op_flags, int read_flags, uint64_t* version,
+    DispatchResult* dispatch_result, Context** on_finish,
+    Context* on_dispatched) {
+  ceph_assert(ceph_mutex_is_locked(m_lock));
+  auto cct = m_image_ctx->cct;
+
+  if (version != nullptr) {
+    return false;
+  }
+
+  auto [it, inserted] = m_object_reads.try_emplace(object_no);
+  if (inserted) {
+    // first read of the object: reads arriving while it is in flight
+    // will be held back and merged
+    *on_finish = new LambdaContext(
+      [this, object_no, on_finish=*on_finish](int r) {
+        handle_read_finished(object_no);
+        on_finish->complete(r);
+      });
+    return false;
+  }
+
+  auto& object_reads = it->second;
+  if (object_reads.held_reads.empty()) {
+    object_reads.io_context = io_context;
+    object_reads.op_flags = op_flags;
+    object_reads.read_flags = read_flags;
+  } else if (*object_reads.io_context != *io_context ||
+             object_reads.op_flags != op_flags ||
+             object_reads.read_flags != read_flags) {
+    return false;
+  }
+
+  ldout(cct, 20) << "holding read " << data_object_name(m_image_ctx, object_no)
+                 << " " << extents << dendl;
+  object_reads.held_reads.push_back({extents, on_dispatched});
+  *dispatch_result = DISPATCH_RESULT_COMPLETE;
+  return true;
+}
+
+template <typename I>
+void SimpleSchedulerObjectDispatch<I>::handle_read_finished(
+    uint64_t object_no) {
+  auto cct = m_image_ctx->cct;
+
+  std::unique_lock locker{m_lock};
+  auto it = m_object_reads.find(object_no);
+  ceph_assert(it != m_object_reads.end());
+
+  auto& object_reads = it->second;
+  if (object_reads.held_reads.empty()) {
+    m_object_reads.erase(it);
+    return;
+  }
+
+  std::list<HeldRead> held_reads;
+  held_reads.swap(object_reads.held_reads);
+  auto io_context = std::move(object_reads.io_context);
+  auto op_flags = object_reads.op_flags;
+  auto read_flags = object_reads.read_flags;
+  locker.unlock();
+
+  interval_set<uint64_t> extents;
+  for (auto& held_read : held_reads) {
+    for (auto& extent : *held_read.extents) {
+      extents.union_insert(extent.offset, extent.length);
+    }
+  }
+
+  auto merged_extents = new ReadExtents();
+  merged_extents->reserve(extents.num_intervals());
+  for (auto [offset, length] : extents) {
+    merged_extents->emplace_back(offset, length);
+  }
+
+  ldout(cct, 20) << "merged " << held_reads.size() << " reads of "
+                 << data_object_name(m_image_ctx, object_no) << " into "
+                 << *merged_extents << dendl;
+
+  // the object remains in m_object_reads until the merged read finished
+  auto ctx = new LambdaContext(
+    [this, object_no, merged_extents,
+     held_reads=std::move(held_reads)](int r) mutable {
+      handle_merged_read(object_no, merged_extents, std::move(held_reads), r);
+    });
+  auto req = ObjectDispatchSpec::create_read(
+    m_image_ctx, OBJECT_DISPATCH_LAYER_SCHEDULER, object_no, merged_extents,
+    io_context, op_flags, read_flags, {}, nullptr, ctx);
+  req->send();
+}
+
+template <typename I>
+void SimpleSchedulerObjectDispatch<I>::handle_merged_read(
+    uint64_t object_no, ReadExtents* merged_extents,
+    std::list<HeldRead>&& held_reads, int r) {
+  auto cct = m_image_ctx->cct;
+  ldout(cct, 20) << data_object_name(m_image_ctx, object_no) << " r=" << r
+                 << dendl;
+
+  if (r >= 0) {
+    // scatter the merged results back to the held reads as sparse results
+    for (auto& held_read : held_reads) {
+      for (auto& extent : *held_read.extents) {
+        auto merged_extent = std::find_if(
+          merged_extents->begin(), merged_extents->end(),
+          [&extent](const ReadExtent& merged_extent) {
+            return (merged_extent.offset <= extent.offset &&
+                    extent.offset + extent.length <=
+                      merged_extent.offset + merged_extent.length);
+          });
+        ceph_assert(merged_extent != merged_extents->end());
+
+        Extents extent_map = merged_extent->extent_map;
+        if (extent_map.empty() && merged_extent->bl.length() > 0) {
+          extent_map.emplace_back(merged_extent->offset,
+                                  merged_extent->bl.length());
+        }
+
+        uint64_t bl_off = 0;
+        for (auto [offset, length] : extent_map) {
+          auto start = std::max(offset, extent.offset);
+          auto end = std::min(offset + length, extent.offset + extent.length);
+          if (start < end) {
+            ceph::bufferlist bl;
+            bl.substr_of(merged_extent->bl, bl_off + (start - offset),
+                         end - start);
+            extent.bl.claim_append(bl);
+            extent.extent_map.emplace_back(start, end - start);
+          }
+          bl_off += length;
+        }
+      }
+    }
+  }
+  delete merged_extents;
+
+  handle_read_finished(object_no);
+  for (auto& held_read : held_reads) {
+    held_read.on_dispatched->complete(r);
+  }
+}
+
 } // namespace io
 } // namespace librbd
 
@@ -189,6 +189,19 @@ private:
   typedef std::shared_ptr<ObjectRequests> ObjectRequestsRef;
   typedef std::map<uint64_t, ObjectRequestsRef> Requests;
 
+  struct HeldRead {
+    ReadExtents* extents;
+    Context* on_dispatched;
+  };
+
+  // reads held back while another read of the object is in flight
+  struct ObjectReads {
+    IOContext io_context;
+    int op_flags = 0;
+    int read_flags = 0;
+    std::list<HeldRead> held_reads;
+  };
+
   ImageCtxT *m_image_ctx;
 
   FlushTracker<ImageCtxT>* m_flush_tracker;
@@ -204,6 +217,9 @@ private:
   Context *m_timer_task = nullptr;
   std::unique_ptr<LatencyStats> m_latency_stats;
 
+  bool m_merge_reads;
+  std::map<uint64_t, ObjectReads> m_object_reads; ///< objects with reads in flight
+
   bool try_delay_write(uint64_t object_no, uint64_t object_off,
                        ceph::bufferlist&& data, IOContext io_context,
                        int op_flags, int object_dispatch_flags,
@@ -217,6 +233,14 @@ private:
                                   Context** on_finish);
 
   void schedule_dispatch_delayed_requests();
+
+  bool try_hold_read(uint64_t object_no, ReadExtents* extents,
+                     IOContext io_context, int op_flags, int read_flags,
+                     uint64_t* version, DispatchResult* dispatch_result,
+                     Context** on_finish, Context* on_dispatched);
+  void handle_read_finished(uint64_t object_no);
+  void handle_merged_read(uint64_t object_no, ReadExtents* merged_extents,
+                          std::list<HeldRead>&& held_reads, int r);
 };
 
 } // namespace io
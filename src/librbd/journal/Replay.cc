@@ -28,6 +28,38 @@ static const uint64_t IN_FLIGHT_IO_HIGH_WATER_MARK(64);
 
 static NoOpProgressContext no_op_progress_callback;
 
+struct AioModifyExtentVisitor : public boost::static_visitor<bool> {
+  io::Extent *image_extent;
+
+  AioModifyExtentVisitor(io::Extent *image_extent)
+    : image_extent(image_extent) {
+  }
+
+  template <typename Event>
+  inline bool operator()(const Event &event) const {
+    return false;
+  }
+
+  inline bool operator()(const AioDiscardEvent &event) const {
+    return get_extent(event);
+  }
+  inline bool operator()(const AioWriteEvent &event) const {
+    return get_extent(event);
+  }
+  inline bool operator()(const AioWriteSameEvent &event) const {
+    return get_extent(event);
+  }
+  inline bool operator()(const AioCompareAndWriteEvent &event) const {
+    return get_extent(event);
+  }
+
+  template <typename Event>
+  inline bool get_extent(const Event &event) const {
+    *image_extent = {event.offset, event.length};
+    return true;
+  }
+};
+
 template <typename I, typename E>
 struct ExecuteOp : public Context {
   I &image_ctx;
@@ -175,7 +207,9 @@ struct C_RefreshIfRequired : public Context {
 
 template <typename I>
 Replay<I>::Replay(I &image_ctx)
-  : m_image_ctx(image_ctx) {
+  : m_image_ctx(image_ctx),
+    m_parallel_replay(image_ctx.config.template get_val<bool>(
+      "rbd_journal_parallel_replay")) {
 }
 
 template <typename I>
@@ -218,10 +252,43 @@ void Replay<I>::process(const EventEntry &event_entry,
     return;
   }
 
+  if (m_parallel_replay) {
+    std::lock_guard locker{m_lock};
+    if (is_event_blocked(event_entry)) {
+      // the next event is only processed once this one is ready
+      ldout(cct, 20) << ": waiting for in-flight AIO: "
+                     << m_in_flight_extents << dendl;
+      ceph_assert(!m_blocked_event);
+      m_blocked_event = BlockedEvent{event_entry, on_ready, on_safe};
+      return;
+    }
+  }
+
   boost::apply_visitor(EventVisitor(this, on_ready, on_safe),
                        event_entry.event);
 }
 
+template <typename I>
+bool Replay<I>::is_event_blocked(const EventEntry &event_entry) const {
+  ceph_assert(ceph_mutex_is_locked(m_lock));
+
+  io::Extent image_extent;
+  if (boost::apply_visitor(AioModifyExtentVisitor(&image_extent),
+                           event_entry.event)) {
+    // AIO modify events can be replayed concurrently as long as they
+    // don't overlap
+    return (image_extent.second > 0 &&
+            m_in_flight_extents.intersects(image_extent.first,
+                                           image_extent.second));
+  } else if (boost::get<AioFlushEvent>(&event_entry.event) != nullptr) {
+    // flushes are ordered after all previously issued AIO
+    return false;
+  }
+
+  // all other events must observe a consistent image
+  return !m_in_flight_extents.empty();
+}
+
 template <typename I>
 void Replay<I>::shut_down(bool cancel_ops, Context *on_finish) {
   CephContext *cct = m_image_ctx.cct;
@@ -347,6 +414,7 @@ void Replay<I>::handle_event(const journal::AioDiscardEvent &event,
   bool flush_required;
   auto aio_comp = create_aio_modify_completion(on_ready, on_safe,
                                                io::AIO_TYPE_DISCARD,
+                                               {event.offset, event.length},
                                                &flush_required,
                                                {});
   if (aio_comp == nullptr) {
@@ -382,6 +450,7 @@ void Replay<I>::handle_event(const journal::AioWriteEvent &event,
   bool flush_required;
   auto aio_comp = create_aio_modify_completion(on_ready, on_safe,
                                                io::AIO_TYPE_WRITE,
+                                               {event.offset, event.length},
                                                &flush_required,
                                                {});
   if (aio_comp == nullptr) {
@@ -436,6 +505,7 @@ void Replay<I>::handle_event(const journal::AioWriteSameEvent &event,
   bool flush_required;
   auto aio_comp = create_aio_modify_completion(on_ready, on_safe,
                                                io::AIO_TYPE_WRITESAME,
+                                               {event.offset, event.length},
                                                &flush_required,
                                                {});
   if (aio_comp == nullptr) {
@@ -472,6 +542,7 @@ void Replay<I>::handle_event(const journal::AioWriteSameEvent &event,
   bool flush_required;
   auto aio_comp = create_aio_modify_completion(on_ready, on_safe,
                                                io::AIO_TYPE_COMPARE_AND_WRITE,
+                                               {event.offset, event.length},
                                                &flush_required,
                                                {-EILSEQ});
 
@@ -889,12 +960,27 @@ void Replay<I>::handle_event(const journal::UnknownEvent &event,
 
 template <typename I>
 void Replay<I>::handle_aio_modify_complete(Context *on_ready, Context *on_safe,
+                                           const io::Extent &image_extent,
                                            int r, std::set<int> &filters) {
   std::lock_guard locker{m_lock};
   CephContext *cct = m_image_ctx.cct;
   ldout(cct, 20) << ": on_ready=" << on_ready << ", "
                  << "on_safe=" << on_safe << ", r=" << r << dendl;
 
+  if (m_parallel_replay && image_extent.second > 0) {
+    m_in_flight_extents.erase(image_extent.first, image_extent.second);
+    if (m_blocked_event && !is_event_blocked(m_blocked_event->event_entry)) {
+      ldout(cct, 20) << ": resuming blocked event" << dendl;
+      auto blocked_event = std::move(*m_blocked_event);
+      m_blocked_event.reset();
+      m_image_ctx.op_work_queue->queue(new LambdaContext(
+        [this, blocked_event=std::move(blocked_event)](int) {
+          process(blocked_event.event_entry, blocked_event.on_ready,
+                  blocked_event.on_safe);
+        }), 0);
+    }
+  }
+
   if (on_ready != nullptr) {
     on_ready->complete(0);
   }
@@ -1074,6 +1160,7 @@ io::AioCompletion *
 Replay<I>::create_aio_modify_completion(Context *on_ready,
                                         Context *on_safe,
                                         io::aio_type_t aio_type,
+                                        const io::Extent &image_extent,
                                         bool *flush_required,
                                         std::set<int> &&filters) {
   std::lock_guard locker{m_lock};
@@ -1113,11 +1200,24 @@ Replay<I>::create_aio_modify_completion(Context *on_ready,
     std::swap(m_on_aio_ready, on_ready);
   }
 
+  io::Extent in_flight_extent;
+  if (m_parallel_replay && image_extent.second > 0) {
+    // non-overlapping AIO keeps replaying concurrently: the next event
+    // can be processed as soon as this one has been issued
+    m_in_flight_extents.insert(image_extent.first, image_extent.second);
+    in_flight_extent = image_extent;
+    if (on_ready != nullptr) {
+      on_ready->complete(0);
+      on_ready = nullptr;
+    }
+  }
+
   // when the modification is ACKed by librbd, we can process the next
   // event. when flushed, the completion of the next flush will fire the
   // on_safe callback
   auto aio_comp = io::AioCompletion::create_and_start<Context>(
-    new C_AioModifyComplete(this, on_ready, on_safe, std::move(filters)),
+    new C_AioModifyComplete(this, on_ready, on_safe, in_flight_extent,
+                            std::move(filters)),
     util::get_image_ctx(&m_image_ctx), aio_type);
   return aio_comp;
 }
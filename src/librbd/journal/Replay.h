@@ -8,10 +8,12 @@
 #include "include/buffer_fwd.h"
 #include "include/Context.h"
 #include "common/ceph_mutex.h"
+#include "include/interval_set.h"
 #include "librbd/io/Types.h"
 #include "librbd/journal/Types.h"
 #include <boost/variant.hpp>
 #include <list>
+#include <optional>
 #include <unordered_set>
 #include <unordered_map>
 
@@ -77,14 +79,17 @@ private:
     Replay *replay;
     Context *on_ready;
     Context *on_safe;
+    io::Extent image_extent;
     std::set<int> filters;
     C_AioModifyComplete(Replay *replay, Context *on_ready,
-                        Context *on_safe, std::set<int> &&filters)
+                        Context *on_safe, const io::Extent &image_extent,
+                        std::set<int> &&filters)
       : replay(replay), on_ready(on_ready), on_safe(on_safe),
-        filters(std::move(filters)) {
+        image_extent(image_extent), filters(std::move(filters)) {
     }
     void finish(int r) override {
-      replay->handle_aio_modify_complete(on_ready, on_safe, r, filters);
+      replay->handle_aio_modify_complete(on_ready, on_safe, image_extent, r,
+                                         filters);
     }
   };
 
@@ -102,6 +107,12 @@ private:
     }
   };
 
+  struct BlockedEvent {
+    EventEntry event_entry;
+    Context *on_ready;
+    Context *on_safe;
+  };
+
   struct EventVisitor : public boost::static_visitor<void> {
     Replay *replay;
     Context *on_ready;
@@ -133,6 +144,14 @@ private:
   Context *m_flush_ctx = nullptr;
   Context *m_on_aio_ready = nullptr;
 
+  // parallel replay: image extents of the AIO modify events in flight
+  // and the event waiting for overlapping AIO to complete
+  bool m_parallel_replay;
+  interval_set<uint64_t> m_in_flight_extents;
+  std::optional<BlockedEvent> m_blocked_event;
+
+  bool is_event_blocked(const EventEntry &event_entry) const;
+
   void handle_event(const AioDiscardEvent &event, Context *on_ready,
                     Context *on_safe);
   void handle_event(const AioWriteEvent &event, Context *on_ready,
@@ -177,6 +196,7 @@ private:
                     Context *on_safe);
 
   void handle_aio_modify_complete(Context *on_ready, Context *on_safe,
+                                  const io::Extent &image_extent,
                                   int r, std::set<int> &filters);
   void handle_aio_flush_complete(Context *on_flush_safe, Contexts &on_safe_ctxs,
                                  int r);
@@ -188,6 +208,7 @@ private:
   io::AioCompletion *create_aio_modify_completion(Context *on_ready,
                                                   Context *on_safe,
                                                   io::aio_type_t aio_type,
+                                                  const io::Extent &image_extent,
                                                   bool *flush_required,
                                                   std::set<int> &&filters);
   io::AioCompletion *create_aio_flush_completion(Context *on_safe);
@@ -9,6 +9,7 @@
 #include "librbd/Utils.h"
 #include "osdc/Striper.h"
 #include <string>
+#include <vector>
 
 #define dout_subsys ceph_subsys_rbd
 #undef dout_prefix
@@ -20,6 +21,14 @@ namespace object_map {
 
 using util::create_rados_callback;
 
+namespace {
+
+// number of object states processed at once (multiple of 4 to keep
+// chunks byte-aligned in the packed diff state)
+constexpr uint64_t DIFF_CHUNK_SIZE = 1 << 16;
+
+} // anonymous namespace
+
 template <typename I>
 DiffRequest<I>::DiffRequest(I* image_ctx,
                             uint64_t snap_id_start, uint64_t snap_id_end,
@@ -80,6 +89,77 @@ int DiffRequest<I>::prepare_for_object_map() {
   return 0;
 }
 
+template <typename I>
+uint8_t DiffRequest<I>::get_overlap_diff_state(
+    uint8_t prev_object_diff_state, uint8_t object_map_state) const {
+  switch (prev_object_diff_state) {
+  case DIFF_STATE_HOLE:
+    if (object_map_state != OBJECT_NONEXISTENT) {
+      // stay in HOLE on intermediate snapshots for diff-iterate
+      if (!is_diff_iterate() || m_current_snap_id == m_snap_id_end) {
+        return DIFF_STATE_DATA_UPDATED;
+      }
+    }
+    break;
+  case DIFF_STATE_DATA:
+    if (object_map_state == OBJECT_NONEXISTENT) {
+      return DIFF_STATE_HOLE_UPDATED;
+    } else if (object_map_state != OBJECT_EXISTS_CLEAN) {
+      return DIFF_STATE_DATA_UPDATED;
+    }
+    break;
+  case DIFF_STATE_HOLE_UPDATED:
+    if (object_map_state != OBJECT_NONEXISTENT) {
+      return DIFF_STATE_DATA_UPDATED;
+    }
+    break;
+  case DIFF_STATE_DATA_UPDATED:
+    if (object_map_state == OBJECT_NONEXISTENT) {
+      return DIFF_STATE_HOLE_UPDATED;
+    }
+    break;
+  default:
+    ceph_abort();
+  }
+  return prev_object_diff_state;
+}
+
+template <typename I>
+uint8_t DiffRequest<I>::get_resize_diff_state(uint8_t object_map_state) const {
+  if (object_map_state == OBJECT_NONEXISTENT) {
+    return DIFF_STATE_HOLE;
+  } else if (m_current_snap_id != m_snap_id_start) {
+    // diffing against the beginning of time or image was grown
+    // (implicit) starting state is HOLE, this is the first object
+    // map after
+    if (is_diff_iterate()) {
+      // for diff-iterate, if the object is discarded prior to or
+      // in the end version, result should be HOLE
+      // since DATA_UPDATED can transition only to HOLE_UPDATED,
+      // stay in HOLE on intermediate snapshots -- another way to
+      // put this is that when starting with a hole, intermediate
+      // snapshots can be ignored as the result depends only on the
+      // end version
+      if (m_current_snap_id == m_snap_id_end) {
+        return DIFF_STATE_DATA_UPDATED;
+      } else {
+        return DIFF_STATE_HOLE;
+      }
+    } else {
+      // for deep-copy, if the object is discarded prior to or
+      // in the end version, result should be HOLE_UPDATED
+      return DIFF_STATE_DATA_UPDATED;
+    }
+  } else {
+    // diffing against a snapshot, this is its object map
+    if (object_map_state != OBJECT_PENDING) {
+      return DIFF_STATE_DATA;
+    } else {
+      return DIFF_STATE_DATA_UPDATED;
+    }
+  }
+}
+
 template <typename I>
 int DiffRequest<I>::process_object_map(const BitVector<2>& object_map) {
   auto cct = m_image_ctx->cct;
@@ -114,96 +194,75 @@ int DiffRequest<I>::process_object_map(const BitVector<2>& object_map) {
     end_object_no = m_object_diff_state->size();
   }
 
+  // the next diff state of an object only depends on its previous diff
+  // state and its state in this object map: compute all transitions
+  // once and apply them a chunk of (unpacked) states at a time
+  uint8_t overlap_diff_states[4][4];
+  for (uint8_t prev_object_diff_state = 0; prev_object_diff_state < 4;
+       ++prev_object_diff_state) {
+    for (uint8_t object_map_state = 0; object_map_state < 4;
+         ++object_map_state) {
+      overlap_diff_states[prev_object_diff_state][object_map_state] =
+        get_overlap_diff_state(prev_object_diff_state, object_map_state);
+    }
+  }
+  uint8_t resize_diff_states[4];
+  for (uint8_t object_map_state = 0; object_map_state < 4;
+       ++object_map_state) {
+    resize_diff_states[object_map_state] =
+      get_resize_diff_state(object_map_state);
+  }
+
   uint64_t overlap = std::min(m_object_diff_state->size(),
                               prev_object_diff_state_size);
-  auto it = object_map.begin() + start_object_no;
-  auto diff_it = m_object_diff_state->begin();
+  uint64_t overlap_end_object_no = start_object_no + overlap;
+  ceph_assert(end_object_no == overlap_end_object_no ||
+              end_object_no <= num_objs);
+
+  std::vector<uint8_t> object_map_states;
+  std::vector<uint8_t> object_diff_states;
   uint64_t ono = start_object_no;
-  for (; ono < start_object_no + overlap; ++diff_it, ++ono) {
-    uint8_t object_map_state = (ono < num_objs ? *it++ : OBJECT_NONEXISTENT);
-    uint8_t prev_object_diff_state = *diff_it;
-    switch (prev_object_diff_state) {
-    case DIFF_STATE_HOLE:
-      if (object_map_state != OBJECT_NONEXISTENT) {
-        // stay in HOLE on intermediate snapshots for diff-iterate
-        if (!is_diff_iterate() || m_current_snap_id == m_snap_id_end) {
-          *diff_it = DIFF_STATE_DATA_UPDATED;
-        }
-      }
-      break;
-    case DIFF_STATE_DATA:
-      if (object_map_state == OBJECT_NONEXISTENT) {
-        *diff_it = DIFF_STATE_HOLE_UPDATED;
-      } else if (object_map_state != OBJECT_EXISTS_CLEAN) {
-        *diff_it = DIFF_STATE_DATA_UPDATED;
-      }
-      break;
-    case DIFF_STATE_HOLE_UPDATED:
-      if (object_map_state != OBJECT_NONEXISTENT) {
-        *diff_it = DIFF_STATE_DATA_UPDATED;
-      }
-      break;
-    case DIFF_STATE_DATA_UPDATED:
-      if (object_map_state == OBJECT_NONEXISTENT) {
-        *diff_it = DIFF_STATE_HOLE_UPDATED;
-      }
-      break;
-    default:
-      ceph_abort();
+  while (ono < end_object_no) {
+    uint64_t count = std::min(DIFF_CHUNK_SIZE, end_object_no - ono);
+    uint64_t diff_offset = ono - start_object_no;
+
+    // objects beyond the end of this version are non-existent
+    object_map_states.assign(count, OBJECT_NONEXISTENT);
+    if (ono < num_objs) {
+      object_map.get_elements(ono, std::min(count, num_objs - ono),
+                              object_map_states.data());
     }
+    object_diff_states.resize(count);
+    m_object_diff_state->get_elements(diff_offset, count,
+                                      object_diff_states.data());
+
+    uint64_t overlap_count = (ono < overlap_end_object_no ?
+      std::min(count, overlap_end_object_no - ono) : 0);
+    for (uint64_t i = 0; i < overlap_count; ++i) {
+      uint8_t prev_object_diff_state = object_diff_states[i];
+      object_diff_states[i] =
+        overlap_diff_states[prev_object_diff_state][object_map_states[i]];
+
+      ldout(cct, 20) << "object state: " << ono + i << " "
+                     << static_cast<uint32_t>(prev_object_diff_state)
+                     << "->" << static_cast<uint32_t>(object_diff_states[i])
+                     << " (" << static_cast<uint32_t>(object_map_states[i])
+                     << ")" << dendl;
+    }
+    for (uint64_t i = overlap_count; i < count; ++i) {
+      object_diff_states[i] = resize_diff_states[object_map_states[i]];
 
-    ldout(cct, 20) << "object state: " << ono << " "
-                   << static_cast<uint32_t>(prev_object_diff_state)
-                   << "->" << static_cast<uint32_t>(*diff_it) << " ("
-                   << static_cast<uint32_t>(object_map_state) << ")"
-                   << dendl;
-  }
-  ldout(cct, 20) << "computed overlap diffs" << dendl;
-
-  ceph_assert(diff_it == m_object_diff_state->end() ||
-              end_object_no <= num_objs);
-  for (; ono < end_object_no; ++it, ++diff_it, ++ono) {
-    uint8_t object_map_state = *it;
-    if (object_map_state == OBJECT_NONEXISTENT) {
-      *diff_it = DIFF_STATE_HOLE;
-    } else if (m_current_snap_id != m_snap_id_start) {
-      // diffing against the beginning of time or image was grown
-      // (implicit) starting state is HOLE, this is the first object
-      // map after
-      if (is_diff_iterate()) {
-        // for diff-iterate, if the object is discarded prior to or
-        // in the end version, result should be HOLE
-        // since DATA_UPDATED can transition only to HOLE_UPDATED,
-        // stay in HOLE on intermediate snapshots -- another way to
-        // put this is that when starting with a hole, intermediate
-        // snapshots can be ignored as the result depends only on the
-        // end version
-        if (m_current_snap_id == m_snap_id_end) {
-          *diff_it = DIFF_STATE_DATA_UPDATED;
-        } else {
-          *diff_it = DIFF_STATE_HOLE;
-        }
-      } else {
-        // for deep-copy, if the object is discarded prior to or
-        // in the end version, result should be HOLE_UPDATED
-        *diff_it = DIFF_STATE_DATA_UPDATED;
-      }
-    } else {
-      // diffing against a snapshot, this is its object map
-      if (object_map_state != OBJECT_PENDING) {
-        *diff_it = DIFF_STATE_DATA;
-      } else {
-        *diff_it = DIFF_STATE_DATA_UPDATED;
-      }
+      ldout(cct, 20) << "object state: " << ono + i << " "
+                     << "->" << static_cast<uint32_t>(object_diff_states[i])
+                     << " (" << static_cast<uint32_t>(object_map_states[i])
+                     << ")" << dendl;
     }
 
-    ldout(cct, 20) << "object state: " << ono << " "
-                   << "->" << static_cast<uint32_t>(*diff_it) << " ("
-                   << static_cast<uint32_t>(*it) << ")" << dendl;
+    m_object_diff_state->set_elements(diff_offset, count,
+                                      object_diff_states.data());
+    ono += count;
   }
-  ldout(cct, 20) << "computed resize diffs" << dendl;
-
-  ceph_assert(diff_it == m_object_diff_state->end());
+  ldout(cct, 20) << "computed diffs" << dendl;
   return 0;
 }
 
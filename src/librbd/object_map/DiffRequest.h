@@ -73,6 +73,9 @@ private:
   bool is_diff_iterate() const;
 
   int prepare_for_object_map();
+  uint8_t get_overlap_diff_state(uint8_t prev_object_diff_state,
+                                 uint8_t object_map_state) const;
+  uint8_t get_resize_diff_state(uint8_t object_map_state) const;
   int process_object_map(const BitVector<2>& object_map);
 
   void load_object_map(std::shared_lock<ceph::shared_mutex>* image_locker);
@@ -39,6 +39,8 @@ namespace logging {
 
 static OnExitManager exit_callbacks;
 
+static std::atomic<uint64_t> next_log_id = {1};
+
 static void log_on_exit(void *p)
 {
   Log *l = *(Log **)p;
@@ -50,7 +52,8 @@ static void log_on_exit(void *p)
 Log::Log(const SubsystemMap *s)
   : m_indirect_this(nullptr),
     m_subs(s),
-    m_recent(DEFAULT_MAX_RECENT)
+    m_recent(DEFAULT_MAX_RECENT),
+    m_id(next_log_id++)
 {
   m_log_buf.reserve(MAX_LOG_BUF);
   _configure_stderr();
@@ -138,6 +141,11 @@ void Log::set_max_recent(std::size_t n)
   m_recent.set_capacity(n);
 }
 
+void Log::set_max_recent_per_thread(std::size_t n)
+{
+  m_max_recent_per_thread = n;
+}
+
 void Log::set_log_file(std::string_view fn)
 {
   std::scoped_lock lock(m_flush_mutex);
@@ -247,14 +255,78 @@ void Log::stop_journald_logger()
   m_journald.reset();
 }
 
-void Log::submit_entry(Entry&& e)
+Log::ThreadRing& Log::_get_thread_ring()
 {
-  std::unique_lock lock(m_queue_mutex);
-  m_queue_mutex_holder = pthread_self();
+  struct cached_ring_t {
+    uint64_t log_id = 0;
+    std::shared_ptr<ThreadRing> ring;
+    ~cached_ring_t() {
+      if (ring) {
+	// the Log may be gone already; the lock lives as long as the ring
+	std::scoped_lock lock(ring->lock);
+	ring->orphaned = true;
+      }
+    }
+  };
+  static thread_local cached_ring_t cached;
+  if (cached.log_id == m_id) {
+    return *cached.ring;
+  }
 
+  std::scoped_lock lock(m_rings_mutex);
+  const pthread_t self = pthread_self();
+  std::shared_ptr<ThreadRing> found;
+  for (auto& ring : m_rings) {
+    std::scoped_lock ring_lock(ring->lock);
+    if (!ring->orphaned && pthread_equal(ring->owner, self)) {
+      found = ring;
+      break;
+    }
+    if (!found && ring->orphaned) {
+      found = ring;
+    }
+  }
+  if (found) {
+    // entries of a previous owner stay: they carry their own m_thread
+    std::scoped_lock ring_lock(found->lock);
+    found->owner = self;
+    found->orphaned = false;
+  } else {
+    found = std::make_shared<ThreadRing>();
+    found->owner = self;
+    m_rings.push_back(found);
+  }
+  if (cached.ring) {
+    std::scoped_lock ring_lock(cached.ring->lock);
+    cached.ring->orphaned = true;
+  }
+  cached.log_id = m_id;
+  cached.ring = std::move(found);
+  return *cached.ring;
+}
+
+void Log::submit_entry(Entry&& e)
+{
   if (unlikely(m_inject_segv))
     *(volatile int *)(0) = 0xdead;
 
+  if (auto max = m_max_recent_per_thread.load(std::memory_order_relaxed);
+      max && m_subs->get_log_level(e.m_subsys) < e.m_prio) {
+    // nothing would write this entry out but a crash dump: keep it in
+    // the calling thread's ring, without waking up the flusher or
+    // contending on the queue
+    auto& ring = _get_thread_ring();
+    std::scoped_lock lock(ring.lock);
+    if (ring.entries.capacity() != max) {
+      ring.entries.set_capacity(max);
+    }
+    ring.entries.push_back(ConcreteEntry(e));
+    return;
+  }
+
+  std::unique_lock lock(m_queue_mutex);
+  m_queue_mutex_holder = pthread_self();
+
   // wait for flush to catch up
   while (is_started() &&
 	 m_new.size() > m_max_new) {
@@ -498,6 +570,23 @@ void Log::dump_recent()
     EntryVector t;
     t.insert(t.end(), std::make_move_iterator(m_recent.begin()), std::make_move_iterator(m_recent.end()));
     m_recent.clear();
+    bool merged = false;
+    {
+      std::scoped_lock lock(m_rings_mutex);
+      for (auto& ring : m_rings) {
+	std::scoped_lock ring_lock(ring->lock);
+	merged = merged || !ring->entries.empty();
+	t.insert(t.end(),
+		 std::make_move_iterator(ring->entries.begin()),
+		 std::make_move_iterator(ring->entries.end()));
+	ring->entries.clear();
+      }
+    }
+    if (merged) {
+      std::stable_sort(t.begin(), t.end(), [](const auto& l, const auto& r) {
+	return l.m_stamp < r.m_stamp;
+      });
+    }
     for (const auto& e : t) {
       recent_pthread_ids.emplace(e.m_thread);
     }
@@ -526,6 +615,8 @@ void Log::dump_recent()
   }
 
   _log_message(fmt::format("  max_recent {:9}", m_recent.capacity()), true);
+  _log_message(fmt::format("  max_recent_per_thread {:9}",
+			   m_max_recent_per_thread.load()), true);
   _log_message(fmt::format("  max_new    {:9}", m_max_new), true);
   _log_message(fmt::format("  log_file {}", m_log_file), true);
 
@@ -6,6 +6,7 @@
 
 #include <boost/circular_buffer.hpp>
 
+#include <atomic>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
@@ -42,6 +43,7 @@ public:
   void set_coarse_timestamps(bool coarse);
   void set_max_new(std::size_t n);
   void set_max_recent(std::size_t n);
+  void set_max_recent_per_thread(std::size_t n);
   void set_log_file(std::string_view fn);
   void reopen_log_file();
   void chown_log_file(uid_t uid, gid_t gid);
@@ -87,6 +89,14 @@ protected:
 private:
   using EntryRing = boost::circular_buffer<ConcreteEntry>;
 
+  /// entries only kept in memory for a crash dump, recorded by one thread
+  struct ThreadRing {
+    std::mutex lock;
+    EntryRing entries;
+    pthread_t owner;
+    bool orphaned = false;  ///< owner exited, ring may be handed over
+  };
+
   static const std::size_t DEFAULT_MAX_NEW = 100;
   static const std::size_t DEFAULT_MAX_RECENT = 10000;
 
@@ -134,8 +144,16 @@ private:
 
   bool m_inject_segv = false;
 
+  /// capacity of the per-thread rings; 0 to queue every entry
+  std::atomic<std::size_t> m_max_recent_per_thread = 0;
+  const uint64_t m_id;  ///< tells apart Logs in the per-thread ring cache
+  std::mutex m_rings_mutex;  ///< protects m_rings and ThreadRing::owner
+  std::vector<std::shared_ptr<ThreadRing>> m_rings;
+
   void *entry() override;
 
+  ThreadRing& _get_thread_ring();
+
   void _log_safe_write(std::string_view sv);
   void _flush_logbuf();
   void _log_message(std::string_view s, bool crash);
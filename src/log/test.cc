@@ -14,6 +14,9 @@
 
 #include <limits.h>
 
+#include <algorithm>
+#include <thread>
+
 using namespace std;
 using namespace ceph::logging;
 
@@ -357,6 +360,55 @@ TEST(Log, LargeFromSmallLog)
   log.stop();
 }
 
+class RecordingLog : public Log {
+public:
+  using Log::Log;
+  std::vector<std::string> flushed, dumped;
+protected:
+  void _flush(EntryVector& q, bool crash) override {
+    for (auto& e : q) {
+      (crash ? dumped : flushed).emplace_back(e.strv());
+    }
+    Log::_flush(q, crash);
+  }
+};
+
+TEST(Log, PerThreadRecent)
+{
+  SubsystemMap subs;
+  subs.set_log_level(1, 1);
+  subs.set_gather_level(1, 10);
+  RecordingLog log(&subs);
+  log.set_max_recent_per_thread(10);
+  log.start();
+  auto submit = [&log](int l, std::string_view what, int i) {
+    MutableEntry e(l, 1);
+    e.get_ostream() << what << " " << i;
+    log.submit_entry(std::move(e));
+  };
+  for (int i = 0; i < 20; i++) {
+    submit(1, "written", i);
+    submit(5, "main", i);
+  }
+  std::thread t([&submit] {
+    for (int i = 0; i < 20; i++) {
+      submit(5, "thread", i);
+    }
+  });
+  t.join();
+  log.flush();
+  // only the entries at the log level went through the queue
+  ASSERT_EQ(20u, log.flushed.size());
+  log.dump_recent();
+  // ...the rings kept the 10 latest memory-only entries of each thread
+  ASSERT_EQ(40u, log.dumped.size());
+  ASSERT_EQ(10, std::count_if(log.dumped.begin(), log.dumped.end(),
+                              [](auto& s) { return s.starts_with("thread"); }));
+  ASSERT_EQ("main 19", log.dumped[29]);
+  ASSERT_EQ("thread 19", log.dumped.back());
+  log.stop();
+}
+
 // Make sure nothing bad happens when we switch
 
 TEST(Log, TimeSwitch)
@@ -16,6 +16,7 @@
 #include "common/errno.h"
 
 #include <string>
+#include <unordered_map>
 
 #include "CInode.h"
 #include "CDir.h"
@@ -1560,15 +1561,78 @@ void InodeStoreBase::encode_xattrs(bufferlist &bl) const {
     encode((__u32)0, bl);
 }
 
+namespace {
+struct xattr_intern_table_t {
+  ceph::mutex lock = ceph::make_mutex("InodeStoreBase::xattr_intern_table");
+  // hash of the map -> maps with that hash; entries of maps that are no
+  // longer referenced are swept out as the table grows
+  std::unordered_multimap<uint64_t,
+                          std::weak_ptr<const InodeStoreBase::mempool_xattr_map>> maps;
+  size_t sweep_at = 1024;
+};
+xattr_intern_table_t xattr_intern_table;
+
+uint64_t hash_xattrs(const InodeStoreBase::mempool_xattr_map& xattrs)
+{
+  uint64_t h = xattrs.size();
+  auto mix = [&h](std::string_view s) {
+    h ^= std::hash<std::string_view>{}(s) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+  };
+  for (const auto& [k, v] : xattrs) {
+    mix(k);
+    mix(std::string_view(v.c_str(), v.length()));
+  }
+  return h;
+}
+
+bool xattrs_equal(const InodeStoreBase::mempool_xattr_map& a,
+                  const InodeStoreBase::mempool_xattr_map& b)
+{
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+    [](const auto& x, const auto& y) {
+      return x.first == y.first &&
+             x.second.length() == y.second.length() &&
+             (x.second.length() == 0 ||
+              memcmp(x.second.c_str(), y.second.c_str(), x.second.length()) == 0);
+    });
+}
+} // anonymous namespace
+
+InodeStoreBase::xattr_map_const_ptr
+InodeStoreBase::intern_xattrs(mempool_xattr_map&& xattrs)
+{
+  if (xattrs.empty()) {
+    return xattr_map_const_ptr();
+  }
+
+  auto& table = xattr_intern_table;
+  const uint64_t h = hash_xattrs(xattrs);
+  std::lock_guard l(table.lock);
+  auto [first, last] = table.maps.equal_range(h);
+  for (auto it = first; it != last; ) {
+    if (auto shared = it->second.lock(); !shared) {
+      it = table.maps.erase(it);
+    } else if (xattrs_equal(*shared, xattrs)) {
+      return shared;
+    } else {
+      ++it;
+    }
+  }
+
+  if (table.maps.size() >= table.sweep_at) {
+    std::erase_if(table.maps, [](const auto& e) { return e.second.expired(); });
+    table.sweep_at = std::max<size_t>(1024, table.maps.size() * 2);
+  }
+  xattr_map_const_ptr ptr = allocate_xattr_map(std::move(xattrs));
+  table.maps.emplace(h, ptr);
+  return ptr;
+}
+
 void InodeStoreBase::decode_xattrs(bufferlist::const_iterator &p) {
   using ceph::decode;
   mempool_xattr_map tmp;
   decode_noshare(tmp, p);
-  if (tmp.empty()) {
-    reset_xattrs(xattr_map_ptr());
-  } else {
-    reset_xattrs(allocate_xattr_map(std::move(tmp)));
-  }
+  reset_xattrs(intern_xattrs(std::move(tmp)));
 }
 
 void InodeStoreBase::encode_old_inodes(bufferlist &bl, uint64_t features) const {
@@ -4728,8 +4792,11 @@ void CInode::validate_disk_state(CInode::validated_data *results,
       const int64_t pool = in->get_backtrace_pool();
       object_t oid = CInode::get_object_name(in->ino(), frag_t(), "");
 
+      const int priority = g_conf().get_val<uint64_t>("mds_scrub_op_priority");
+
       ObjectOperation fetch;
       fetch.getxattr("parent", bt, bt_r);
+      fetch.priority = priority;
       in->mdcache->mds->objecter->read(oid, object_locator_t(pool), fetch, CEPH_NOSNAP,
 				       NULL, 0, fin);
       if (in->mdcache->mds->logger) {
@@ -4743,6 +4810,7 @@ void CInode::validate_disk_state(CInode::validated_data *results,
         bufferlist tag_bl;
         encode(tag, tag_bl);
         scrub_tag.setxattr("scrub_tag", tag_bl);
+        scrub_tag.priority = priority;
         SnapContext snapc;
         in->mdcache->mds->objecter->mutate(oid, object_locator_t(pool), scrub_tag, snapc,
 					   ceph::real_clock::now(),
@@ -137,6 +137,11 @@ public:
     xattrs = std::move(ptr);
   }
 
+  /* Return a shared, immutable copy of the given xattrs.  Inodes with the
+   * same xattrs (e.g. the same ACL or security label) get the same map, so
+   * the cache holds a single copy of it.  Returns null for no xattrs. */
+  static xattr_map_const_ptr intern_xattrs(mempool_xattr_map&& xattrs);
+
   void reset_old_inodes(old_inode_map_const_ptr&& ptr) {
     old_inodes = std::move(ptr);
   }
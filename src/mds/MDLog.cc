@@ -51,6 +51,7 @@ MDLog::MDLog(MDSRank* m)
 {
   debug_subtrees = g_conf().get_val<bool>("mds_debug_subtrees");
   event_large_threshold = g_conf().get_val<uint64_t>("mds_log_event_large_threshold");
+  submit_batch = g_conf().get_val<uint64_t>("mds_log_submit_batch");
   events_per_segment = g_conf().get_val<uint64_t>("mds_log_events_per_segment");
   pause = g_conf().get_val<bool>("mds_log_pause");
   major_segment_event_ratio = g_conf().get_val<uint64_t>("mds_log_major_segment_event_ratio");
@@ -396,6 +397,7 @@ void MDLog::_submit_thread()
 
   std::unique_lock locker{submit_mutex};
 
+  std::vector<PendingEvent> batch;
   while (!mds->is_daemon_stopping()) {
     if (pause) {
       submit_cond.wait(locker);
@@ -413,73 +415,87 @@ void MDLog::_submit_thread()
       continue;
     }
 
+    // take everything queued (up to the batch limit), so that the events
+    // submitted while we were busy are encoded and appended together,
+    // with a single flush of the journaler for the whole batch
     int64_t features = mdsmap_up_features;
-    PendingEvent data = it->second.front();
-    it->second.pop_front();
+    const uint64_t max_batch = submit_batch.load();
+    while (!it->second.empty() && batch.size() < max_batch) {
+      batch.push_back(it->second.front());
+      it->second.pop_front();
+    }
 
     locker.unlock();
 
-    if (data.le) {
-      LogEvent *le = data.le;
-      LogSegment *ls = le->_segment;
-      // encode it, with event type
-      bufferlist bl;
-      le->encode_with_header(bl, features);
-
-      uint64_t write_pos = journaler->get_write_pos();
-
-      le->set_start_off(write_pos);
-      if (dynamic_cast<SegmentBoundary*>(le)) {
-	ls->offset = write_pos;
-      }
-
-      if (bl.length() >= event_large_threshold.load()) {
-        dout(5) << "large event detected!" << dendl;
-        logger->inc(l_mdl_evlrg);
-      }
-
-      dout(5) << "_submit_thread " << write_pos << "~" << bl.length()
-	      << " : " << *le << dendl;
-
-      // journal it.
-      const uint64_t new_write_pos = journaler->append_entry(bl);  // bl is destroyed.
-      ls->end = new_write_pos;
-
-      MDSLogContextBase *fin;
-      if (data.fin) {
-	fin = dynamic_cast<MDSLogContextBase*>(data.fin);
-	ceph_assert(fin);
-	fin->set_write_pos(new_write_pos);
+    bool do_flush = false;
+    uint64_t appended = 0;
+    for (auto& data : batch) {
+      if (data.le) {
+	LogEvent *le = data.le;
+	LogSegment *ls = le->_segment;
+	// encode it, with event type
+	bufferlist bl;
+	le->encode_with_header(bl, features);
+
+	uint64_t write_pos = journaler->get_write_pos();
+
+	le->set_start_off(write_pos);
+	if (dynamic_cast<SegmentBoundary*>(le)) {
+	  ls->offset = write_pos;
+	}
+
+	if (bl.length() >= event_large_threshold.load()) {
+	  dout(5) << "large event detected!" << dendl;
+	  logger->inc(l_mdl_evlrg);
+	}
+
+	dout(5) << "_submit_thread " << write_pos << "~" << bl.length()
+		<< " : " << *le << dendl;
+
+	// journal it.
+	const uint64_t new_write_pos = journaler->append_entry(bl);  // bl is destroyed.
+	ls->end = new_write_pos;
+
+	MDSLogContextBase *fin;
+	if (data.fin) {
+	  fin = dynamic_cast<MDSLogContextBase*>(data.fin);
+	  ceph_assert(fin);
+	  fin->set_write_pos(new_write_pos);
+	} else {
+	  fin = new C_MDL_Flushed(this, new_write_pos);
+	}
+
+	journaler->wait_for_flush(fin);
+
+	if (logger)
+	  logger->set(l_mdl_wrpos, ls->end);
+
+	delete le;
+	appended++;
       } else {
-	fin = new C_MDL_Flushed(this, new_write_pos);
+	if (data.fin) {
+	  Context* fin = dynamic_cast<Context*>(data.fin);
+	  ceph_assert(fin);
+	  C_MDL_Flushed *fin2 = new C_MDL_Flushed(this, fin);
+	  fin2->set_write_pos(journaler->get_write_pos());
+	  journaler->wait_for_flush(fin2);
+	}
       }
-
-      journaler->wait_for_flush(fin);
-
-      if (data.flush)
-	journaler->flush();
-
-      if (logger)
-	logger->set(l_mdl_wrpos, ls->end);
-
-      delete le;
-    } else {
-      if (data.fin) {
-	Context* fin = dynamic_cast<Context*>(data.fin);
-	ceph_assert(fin);
-	C_MDL_Flushed *fin2 = new C_MDL_Flushed(this, fin);
-	fin2->set_write_pos(journaler->get_write_pos());
-	journaler->wait_for_flush(fin2);
-      }
-      if (data.flush)
-	journaler->flush();
+      do_flush |= data.flush;
     }
+    batch.clear();
+
+    // a flush requested anywhere in the batch covers everything appended
+    // before it; deferring it to the end of the batch only adds the
+    // events after it to the same write
+    if (do_flush)
+      journaler->flush();
 
     locker.lock();
-    if (data.flush)
+    if (do_flush)
       unflushed = 0;
-    else if (data.le)
-      unflushed++;
+    else
+      unflushed += appended;
   }
 }
 
@@ -1587,6 +1603,9 @@ void MDLog::handle_conf_change(const std::set<std::string>& changed, const MDSMa
   if (changed.count("mds_log_event_large_threshold")) {
     event_large_threshold = g_conf().get_val<uint64_t>("mds_log_event_large_threshold");
   }
+  if (changed.count("mds_log_submit_batch")) {
+    submit_batch = g_conf().get_val<uint64_t>("mds_log_submit_batch");
+  }
   if (changed.count("mds_log_events_per_segment")) {
     events_per_segment = g_conf().get_val<uint64_t>("mds_log_events_per_segment");
   }
@@ -293,6 +293,7 @@ private:
 
   bool debug_subtrees;
   std::atomic_uint64_t event_large_threshold; // accessed by submit thread
+  std::atomic_uint64_t submit_batch; // accessed by submit thread
   uint64_t events_per_segment;
   uint64_t major_segment_event_ratio;
   int64_t max_events;
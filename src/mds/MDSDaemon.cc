@@ -20,6 +20,7 @@
 
 #include "common/Clock.h"
 #include "common/HeartbeatMap.h"
+#include "common/Thread.h"
 #include "common/Timer.h"
 #include "common/ceph_argparse.h"
 #include "common/config.h"
@@ -77,7 +78,8 @@ MDSDaemon::MDSDaemon(std::string_view n, Messenger *m, MonClient *mc,
   ioctx(ioctx),
   mgrc(m->cct, m, &mc->monmap),
   log_client(m->cct, messenger, &mc->monmap, LogClient::NO_FLAGS),
-  starttime(mono_clock::now())
+  starttime(mono_clock::now()),
+  client_dispatch_batch(m->cct->_conf.get_val<uint64_t>("mds_client_dispatch_batch"))
 {
   orig_argc = 0;
   orig_argv = NULL;
@@ -103,6 +105,11 @@ MDSDaemon::MDSDaemon(std::string_view n, Messenger *m, MonClient *mc,
 }
 
 MDSDaemon::~MDSDaemon() {
+  stop_client_dispatch();
+  if (client_dispatch_thread.joinable()) {
+    client_dispatch_thread.join();
+  }
+
   std::lock_guard lock(mds_lock);
 
   delete mds_rank;
@@ -576,6 +583,10 @@ int MDSDaemon::init()
 
   // Ensure beacons are processed ahead of most other dispatchers.
   messenger->add_dispatcher_head(&beacon, Dispatcher::PRIORITY_HIGH);
+  if (client_dispatch_batch > 0) {
+    client_dispatch_thread = make_named_thread("mds_client_disp",
+      &MDSDaemon::client_dispatch_entry, this);
+  }
   // order last as MDSDaemon::ms_dispatch2 first acquires the mds_lock
   messenger->add_dispatcher_head(this, Dispatcher::PRIORITY_LOW);
 
@@ -890,6 +901,7 @@ void MDSDaemon::suicide()
   }
 
   clean_up_admin_socket();
+  stop_client_dispatch();
 
   // Notify the Monitors (MDSMonitor) that we're dying, so that it doesn't have
   // to wait for us to go laggy. Only do this if we're actually in the MDSMap,
@@ -984,6 +996,72 @@ bool MDSDaemon::ms_dispatch2(const ref_t<Message> &m)
 {
   dout(25) << __func__ << ": processing " << m << dendl;
   std::lock_guard l(mds_lock);
+  return _dispatch(m);
+}
+
+bool MDSDaemon::ms_can_fast_dispatch2(const cref_t<Message> &m) const
+{
+  // everything from a client goes through the client queue, so that the
+  // messages of a session are still handled in the order they arrived.
+  // outgoing messages have our own name as their source.
+  return client_dispatch_batch > 0 && m->get_source().is_client();
+}
+
+void MDSDaemon::ms_fast_dispatch2(const ref_t<Message> &m)
+{
+  std::lock_guard l(client_queue_lock);
+  if (client_queue_stop) {
+    dout(10) << " stopping, discarding " << *m << dendl;
+    return;
+  }
+  client_queue.push_back(m);
+  if (client_queue.size() == 1) {
+    client_queue_cond.notify_one();
+  }
+}
+
+void MDSDaemon::client_dispatch_entry()
+{
+  std::vector<ref_t<Message>> batch;
+  batch.reserve(client_dispatch_batch);
+
+  std::unique_lock ql(client_queue_lock);
+  while (!client_queue_stop) {
+    if (client_queue.empty()) {
+      client_queue_cond.wait(ql);
+      continue;
+    }
+    while (!client_queue.empty() && batch.size() < client_dispatch_batch) {
+      batch.push_back(std::move(client_queue.front()));
+      client_queue.pop_front();
+    }
+    ql.unlock();
+    {
+      std::lock_guard l(mds_lock);
+      for (auto& m : batch) {
+        dout(25) << __func__ << ": processing " << m << dendl;
+        if (!_dispatch(m)) {
+          dout(10) << __func__ << ": unhandled " << *m << dendl;
+        }
+      }
+    }
+    // drop the messages outside of mds_lock
+    batch.clear();
+    ql.lock();
+  }
+  client_queue.clear();
+}
+
+void MDSDaemon::stop_client_dispatch()
+{
+  std::lock_guard l(client_queue_lock);
+  client_queue_stop = true;
+  client_queue_cond.notify_all();
+}
+
+bool MDSDaemon::_dispatch(const ref_t<Message> &m)
+{
+  ceph_assert(ceph_mutex_is_locked_by_me(mds_lock));
   if (stopping) {
     return false;
   }
@@ -15,7 +15,9 @@
 #ifndef CEPH_MDS_H
 #define CEPH_MDS_H
 
+#include <deque>
 #include <string_view>
+#include <thread>
 
 #include "messages/MCommand.h"
 #include "messages/MCommandReply.h"
@@ -156,6 +158,28 @@ class MDSDaemon : public Dispatcher {
   bool parse_caps(const AuthCapsInfo&, MDSAuthCaps&);
 
   mono_time starttime = mono_clock::zero();
+
+  /* Client messages are queued by the messenger threads and dispatched
+   * in batches of up to client_dispatch_batch, so that a burst of client
+   * requests takes mds_lock once per batch instead of once per message.
+   */
+  bool ms_can_fast_dispatch_any() const override {
+    return client_dispatch_batch > 0;
+  }
+  bool ms_can_fast_dispatch2(const cref_t<Message> &m) const override;
+  void ms_fast_dispatch2(const ref_t<Message> &m) override;
+
+  // with mds_lock held
+  bool _dispatch(const ref_t<Message> &m);
+  void client_dispatch_entry();
+  void stop_client_dispatch();
+
+  const uint64_t client_dispatch_batch;
+  ceph::mutex client_queue_lock = ceph::make_mutex("MDSDaemon::client_queue_lock");
+  ceph::condition_variable client_queue_cond;
+  std::deque<ref_t<Message>> client_queue;
+  bool client_queue_stop = false;
+  std::thread client_dispatch_thread;
 };
 
 #endif
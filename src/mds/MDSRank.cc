@@ -20,6 +20,7 @@
 #include "common/async/blocked_completion.h"
 #include "common/cmdparse.h"
 
+#include "messages/MClientCapsBatch.h"
 #include "messages/MClientRequestForward.h"
 #include "messages/MMDSLoadTargets.h"
 #include "messages/MMDSTableRequest.h"
@@ -556,6 +557,8 @@ MDSRank::MDSRank(
 
   _heartbeat_reset_grace = g_conf().get_val<uint64_t>("mds_heartbeat_reset_grace");
   heartbeat_grace = g_conf().get_val<double>("mds_heartbeat_grace");
+  caps_batch_window = g_conf().get_val<double>("mds_client_caps_batch_window");
+  caps_batch_max = g_conf().get_val<uint64_t>("mds_client_caps_batch_max");
   op_tracker.set_complaint_and_threshold(cct->_conf->mds_op_complaint_time,
                                          cct->_conf->mds_op_log_threshold);
   op_tracker.set_history_size_and_duration(cct->_conf->mds_op_history_size,
@@ -1554,6 +1557,27 @@ void MDSRank::send_message_client_counted(const ref_t<Message>& m, Session* sess
   version_t seq = session->inc_push_seq();
   dout(10) << "send_message_client_counted " << session->info.inst.name << " seq "
 	   << seq << " " << *m << dendl;
+  if (m->get_type() == CEPH_MSG_CLIENT_CAPS &&
+      caps_batch_window > 0 &&
+      session->get_connection() &&
+      session->info.has_feature(CEPHFS_FEATURE_CAPS_BATCH)) {
+    // coalesce with other cap messages to this client
+    session->caps_out_batch.push_back(m);
+    if (session->caps_out_batch.size() >= caps_batch_max) {
+      flush_client_caps_batch(session);
+    } else if (session->caps_out_batch.size() == 1) {
+      caps_batch_clients.insert(session->get_client());
+      if (!caps_batch_timer) {
+	caps_batch_timer = new LambdaContext([this](int) {
+	  caps_batch_timer = nullptr;
+	  flush_client_caps_batches();
+	});
+	timer.add_event_after(caps_batch_window, caps_batch_timer);
+      }
+    }
+    return;
+  }
+  flush_client_caps_batch(session);
   if (session->get_connection()) {
     session->get_connection()->send_message2(m);
   } else {
@@ -1561,9 +1585,45 @@ void MDSRank::send_message_client_counted(const ref_t<Message>& m, Session* sess
   }
 }
 
+void MDSRank::flush_client_caps_batch(Session* session)
+{
+  auto& batch = session->caps_out_batch;
+  if (batch.empty()) {
+    return;
+  }
+  caps_batch_clients.erase(session->get_client());
+  std::vector<ref_t<Message>> msgs;
+  msgs.swap(batch);
+  if (!session->get_connection()) {
+    // connection went away; the session will be reconnected or killed
+    return;
+  }
+  if (msgs.size() == 1) {
+    session->get_connection()->send_message2(std::move(msgs.front()));
+  } else {
+    dout(20) << __func__ << " " << session->info.inst.name << " "
+	     << msgs.size() << " cap messages" << dendl;
+    session->get_connection()->send_message2(
+      make_message<MClientCapsBatch>(std::move(msgs)));
+  }
+}
+
+void MDSRank::flush_client_caps_batches()
+{
+  auto clients = std::move(caps_batch_clients);
+  caps_batch_clients.clear();
+  for (auto& client : clients) {
+    Session *session = sessionmap.get_session(entity_name_t::CLIENT(client.v));
+    if (session) {
+      flush_client_caps_batch(session);
+    }
+  }
+}
+
 void MDSRank::send_message_client(const ref_t<Message>& m, Session* session)
 {
   dout(10) << "send_message_client " << session->info.inst << " " << *m << dendl;
+  flush_client_caps_batch(session);
   if (session->get_connection()) {
     session->get_connection()->send_message2(m);
   } else {
@@ -4070,6 +4130,8 @@ const char** MDSRankDispatcher::get_tracked_conf_keys() const
     "mds_cache_trim_decay_rate",
     "mds_cap_acquisition_throttle_retry_request_time",
     "mds_cap_revoke_eviction_timeout",
+    "mds_client_caps_batch_max",
+    "mds_client_caps_batch_window",
     "mds_debug_subtrees",
     "mds_dir_max_entries",
     "mds_dump_cache_threshold_file",
@@ -4098,6 +4160,7 @@ const char** MDSRankDispatcher::get_tracked_conf_keys() const
     "mds_log_pause",
     "mds_log_skip_corrupt_events",
     "mds_log_skip_unbounded_events",
+    "mds_log_submit_batch",
     "mds_max_caps_per_client",
     "mds_max_export_size",
     "mds_max_purge_files",
@@ -4135,6 +4198,12 @@ void MDSRankDispatcher::handle_conf_change(const ConfigProxy& conf, const std::s
   if (changed.count("mds_heartbeat_grace")) {
     heartbeat_grace = conf.get_val<double>("mds_heartbeat_grace");
   }
+  if (changed.count("mds_client_caps_batch_window")) {
+    caps_batch_window = conf.get_val<double>("mds_client_caps_batch_window");
+  }
+  if (changed.count("mds_client_caps_batch_max")) {
+    caps_batch_max = conf.get_val<uint64_t>("mds_client_caps_batch_max");
+  }
   if (changed.count("mds_op_complaint_time") || changed.count("mds_op_log_threshold")) {
     op_tracker.set_complaint_and_threshold(conf->mds_op_complaint_time, conf->mds_op_log_threshold);
   }
@@ -321,6 +321,8 @@ class MDSRank {
     void send_message_client_counted(const ref_t<Message>& m, Session* session);
     void send_message_client_counted(const ref_t<Message>& m, const ConnectionRef& connection);
     void send_message_client(const ref_t<Message>& m, Session* session);
+    // send the cap messages coalesced for the session, if any
+    void flush_client_caps_batch(Session* session);
     void send_message(const ref_t<Message>& m, const ConnectionRef& c);
 
     void wait_for_bootstrapped_peer(mds_rank_t who, MDSContext *c) {
@@ -615,6 +617,13 @@ class MDSRank {
     double heartbeat_grace;
     int _heartbeat_reset_grace;
 
+    // cap messages to clients are coalesced for caps_batch_window seconds
+    double caps_batch_window;
+    uint64_t caps_batch_max;
+    std::set<client_t> caps_batch_clients; ///< clients with queued cap messages
+    Context *caps_batch_timer = nullptr;
+    void flush_client_caps_batches();
+
     std::map<mds_rank_t, version_t> peer_mdsmap_epoch;
 
     ceph_tid_t last_tid = 0;    // for mds-initiated requests (e.g. stray rename)
@@ -1091,31 +1091,69 @@ void OpenFileTable::_prefetch_dirfrags()
     }
   }
 
-  MDSGatherBuilder gather(g_ceph_context);
-  int num_opening_dirfrags = 0;
   for (const auto& dir : fetch_queue) {
+    dirfrag_prefetch_queue.push_back(dir->dirfrag());
+  }
+  dout(10) << __func__ << " " << dirfrag_prefetch_queue.size()
+	   << " dirfrags to fetch" << dendl;
+  _fetch_queued_dirfrags();
+}
+
+class C_OFT_DirfragFetched : public MDSContext {
+  OpenFileTable *oft;
+  MDSRank *get_mds() override { return oft->mds; }
+public:
+  explicit C_OFT_DirfragFetched(OpenFileTable *t) : oft(t) {}
+  void finish(int r) override {
+    oft->_dirfrag_fetched(r);
+  }
+};
+
+void OpenFileTable::_fetch_queued_dirfrags()
+{
+  ceph_assert(prefetch_state == DIRFRAGS);
+  // a fetch may complete right away; the outermost call keeps going
+  if (fetching_queued_dirfrags)
+    return;
+  fetching_queued_dirfrags = true;
+
+  MDCache *mdcache = mds->mdcache;
+  const uint64_t max_inflight =
+    g_conf().get_val<uint64_t>("mds_oft_prefetch_dirfrags_max_inflight");
+  int num_started = 0;
+  while (!dirfrag_prefetch_queue.empty() &&
+	 (max_inflight == 0 || num_fetching_dirfrags < max_inflight)) {
+    dirfrag_t df = dirfrag_prefetch_queue.front();
+    dirfrag_prefetch_queue.pop_front();
+
+    // the dirfrag may have been fetched or trimmed since it was queued
+    CDir *dir = mdcache->get_dirfrag(df);
+    if (!dir || !dir->is_auth() || dir->is_complete())
+      continue;
+
     if (dir->state_test(CDir::STATE_REJOINUNDEF))
       ceph_assert(dir->get_inode()->dirfragtree.is_leaf(dir->get_frag()));
-    dir->fetch(gather.new_sub());
+    num_fetching_dirfrags++;
+    dir->fetch(new C_OFT_DirfragFetched(this));
 
-    if (!(++num_opening_dirfrags % mds->heartbeat_reset_grace()))
+    if (!(++num_started % mds->heartbeat_reset_grace()))
       mds->heartbeat_reset();
   }
 
-  auto finish_func = [this](int r) {
+  fetching_queued_dirfrags = false;
+  if (dirfrag_prefetch_queue.empty() && num_fetching_dirfrags == 0) {
     prefetch_state = FILE_INODES;
     _prefetch_inodes();
-  };
-  if (gather.has_subs()) {
-    gather.set_finisher(
-	new MDSInternalContextWrapper(mds,
-	  new LambdaContext(std::move(finish_func))));
-    gather.activate();
-  } else {
-    finish_func(0);
   }
 }
 
+void OpenFileTable::_dirfrag_fetched(int r)
+{
+  ceph_assert(num_fetching_dirfrags > 0);
+  num_fetching_dirfrags--;
+  _fetch_queued_dirfrags();
+}
+
 void OpenFileTable::_prefetch_inodes()
 {
   dout(10) << __func__ << " state " << prefetch_state << dendl;
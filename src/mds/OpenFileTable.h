@@ -69,6 +69,7 @@ protected:
   friend class C_IO_OFT_Save;
   friend class C_IO_OFT_Journal;
   friend class C_OFT_OpenInoFinish;
+  friend class C_OFT_DirfragFetched;
 
   uint64_t MAX_ITEMS_PER_OBJ = g_conf().get_val<uint64_t>("osd_deep_scrub_large_omap_object_key_threshold");
   static const unsigned MAX_OBJECTS = 1024; // (1024 * osd_deep_scrub_large_omap_object_key_threshold) items at most
@@ -104,6 +105,8 @@ protected:
   void _open_ino_finish(inodeno_t ino, int r);
   void _prefetch_inodes();
   void _prefetch_dirfrags();
+  void _fetch_queued_dirfrags();
+  void _dirfrag_fetched(int r);
 
   void _get_ancestors(const Anchor& parent,
 		      std::vector<inode_backpointer_t>& ancestors,
@@ -143,6 +146,11 @@ protected:
   };
   unsigned prefetch_state = 0;
   unsigned num_opening_inodes = 0;
+  // dirfrags left to prefetch, fetched mds_oft_prefetch_dirfrags_max_inflight
+  // at a time
+  std::deque<dirfrag_t> dirfrag_prefetch_queue;
+  unsigned num_fetching_dirfrags = 0;
+  bool fetching_queued_dirfrags = false;
   MDSContext::vec waiting_for_prefetch;
 
   std::map<uint64_t, std::vector<inodeno_t> > logseg_destroyed_inos;
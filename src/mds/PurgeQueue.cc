@@ -378,7 +378,11 @@ uint32_t PurgeQueue::_calculate_ops(const PurgeItem &item) const
     const uint64_t num = (item.size > 0) ?
       Striper::get_num_objects(item.layout, item.size) : 1;
 
-    ops_required = num;
+    // Filer::purge_range never has more than filer_max_purge_ops removes
+    // of a range in flight, so don't hold more of the op budget than that
+    // for a large file: it would only keep other files waiting.
+    ops_required = std::min<uint64_t>(
+      num, std::max<uint64_t>(1, cct->_conf->filer_max_purge_ops));
 
     // Account for deletions for old pools
     if (item.action != PurgeItem::TRUNCATE_FILE) {
@@ -434,11 +438,36 @@ void PurgeQueue::_go_readonly(int r)
   finish_contexts(g_ceph_context, waiting_for_recovery, r);
 }
 
+class C_IO_PurgeItem_Commit : public Context {
+public:
+  C_IO_PurgeItem_Commit(PurgeQueue *pq, PurgeQueue::commit_batch_t&& batch)
+    : purge_queue(pq), batch(std::move(batch)) {
+  }
+
+  void finish(int r) override {
+    for (auto& [expire_to, ops_vec] : batch) {
+      purge_queue->_commit_ops(r, ops_vec, expire_to);
+    }
+  }
+
+private:
+  PurgeQueue *purge_queue;
+  PurgeQueue::commit_batch_t batch;
+};
+
 bool PurgeQueue::_consume()
 {
   ceph_assert(ceph_mutex_is_locked_by_me(lock));
 
   bool could_consume = false;
+  // the ops of all the items read in this pass go to the finisher together
+  commit_batch_t batch;
+  auto submit_batch = [&]() {
+    if (!batch.empty()) {
+      finisher.queue(new C_IO_PurgeItem_Commit(this, std::move(batch)));
+      batch.clear();
+    }
+  };
   while(_can_consume()) {
 
     if (delayed_flush) {
@@ -452,6 +481,7 @@ bool PurgeQueue::_consume()
     if (int r = journaler.get_error()) {
       derr << "Error " << r << " recovering write_pos" << dendl;
       _go_readonly(r);
+      submit_batch();
       return could_consume;
     }
 
@@ -470,6 +500,7 @@ bool PurgeQueue::_consume()
         }));
       }
 
+      submit_batch();
       return could_consume;
     }
 
@@ -490,30 +521,15 @@ bool PurgeQueue::_consume()
       _go_readonly(CEPHFS_EIO);
     }
     dout(20) << " executing item (" << item.ino << ")" << dendl;
-    _execute_item(item, journaler.get_read_pos());
+    _execute_item(item, journaler.get_read_pos(), &batch);
   }
+  submit_batch();
 
   dout(10) << " cannot consume right now" << dendl;
 
   return could_consume;
 }
 
-class C_IO_PurgeItem_Commit : public Context {
-public:
-  C_IO_PurgeItem_Commit(PurgeQueue *pq, std::vector<PurgeItemCommitOp> ops, uint64_t expire_to)
-    : purge_queue(pq), ops_vec(std::move(ops)), expire_to(expire_to) {
-  }
-
-  void finish(int r) override {
-    purge_queue->_commit_ops(r, ops_vec, expire_to);
-  }
-
-private:
-  PurgeQueue *purge_queue;
-  std::vector<PurgeItemCommitOp> ops_vec;
-  uint64_t expire_to;
-};
-
 void PurgeQueue::_commit_ops(int r, const std::vector<PurgeItemCommitOp>& ops_vec, uint64_t expire_to)
 {
   if (r < 0) {
@@ -593,16 +609,17 @@ void PurgeQueue::_commit_ops(int r, const std::vector<PurgeItemCommitOp>& ops_ve
 
 void PurgeQueue::_execute_item(
     const PurgeItem &item,
-    uint64_t expire_to)
+    uint64_t expire_to,
+    commit_batch_t *batch)
 {
   ceph_assert(ceph_mutex_is_locked_by_me(lock));
 
-  in_flight[expire_to] = item;
+  auto ops = _calculate_ops(item);
+  in_flight[expire_to] = {item, ops};
   logger->set(l_pq_executing, in_flight.size());
   files_high_water = std::max<uint64_t>(files_high_water,
                               in_flight.size());
   logger->set(l_pq_executing_high_water, files_high_water);
-  auto ops = _calculate_ops(item);
   ops_in_flight += ops;
   logger->set(l_pq_executing_ops, ops_in_flight);
   ops_high_water = std::max(ops_high_water, ops_in_flight);
@@ -610,7 +627,7 @@ void PurgeQueue::_execute_item(
 
   std::vector<PurgeItemCommitOp> ops_vec;
   auto submit_ops = [&]() {
-    finisher.queue(new C_IO_PurgeItem_Commit(this, std::move(ops_vec), expire_to));
+    batch->emplace_back(expire_to, std::move(ops_vec));
   };
 
   if (item.action == PurgeItem::PURGE_FILE) {
@@ -712,13 +729,13 @@ void PurgeQueue::_execute_item_complete(
     pending_expire.insert(expire_to);
   }
 
-  auto executed_ops = _calculate_ops(iter->second);
+  auto executed_ops = iter->second.second;
   ops_in_flight -= executed_ops;
   logger->set(l_pq_executing_ops, ops_in_flight);
   ops_high_water = std::max(ops_high_water, ops_in_flight);
   logger->set(l_pq_executing_ops_high_water, ops_high_water);
 
-  dout(10) << "completed item for ino " << iter->second.ino << dendl;
+  dout(10) << "completed item for ino " << iter->second.first.ino << dendl;
 
   in_flight.erase(iter);
   logger->set(l_pq_executing, in_flight.size());
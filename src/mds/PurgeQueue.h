@@ -154,6 +154,9 @@ public:
   // to the queue (there is no callback for when it is executed)
   void push(const PurgeItem &pi, Context *completion);
 
+  // journaler offset an item expires to -> ops that purge it
+  using commit_batch_t = std::vector<std::pair<uint64_t, std::vector<PurgeItemCommitOp>>>;
+
   void _commit_ops(int r, const std::vector<PurgeItemCommitOp>& ops_vec, uint64_t expire_to);
 
   // If the on-disk queue is empty and we are not currently processing
@@ -194,7 +197,8 @@ private:
    */
   bool _consume();
 
-  void _execute_item(const PurgeItem &item, uint64_t expire_to);
+  void _execute_item(const PurgeItem &item, uint64_t expire_to,
+                     commit_batch_t *batch);
   void _execute_item_complete(uint64_t expire_to);
 
   void _go_readonly(int r);
@@ -218,8 +222,8 @@ private:
 
   Context *on_error;
 
-  // Map of Journaler offset to PurgeItem
-  std::map<uint64_t, PurgeItem> in_flight;
+  // Map of Journaler offset to PurgeItem, and the ops it was charged
+  std::map<uint64_t, std::pair<PurgeItem, uint32_t>> in_flight;
 
   std::set<uint64_t> pending_expire;
 
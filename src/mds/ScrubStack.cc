@@ -216,6 +216,11 @@ void ScrubStack::kick_off_scrubs()
     assert(state == STATE_RUNNING || state == STATE_IDLE);
     set_state(STATE_RUNNING);
 
+    if (!take_rate_token()) {
+      dout(20) << __func__ << " rate limited" << dendl;
+      return;
+    }
+
     if (CInode *in = dynamic_cast<CInode*>(*it)) {
       dout(20) << __func__ << " examining " << *in << dendl;
       ++it;
@@ -259,6 +264,37 @@ void ScrubStack::kick_off_scrubs()
   }
 }
 
+bool ScrubStack::take_rate_token()
+{
+  double rate = g_conf().get_val<double>("mds_scrub_max_ops_per_sec");
+  if (rate <= 0) {
+    return true;
+  }
+
+  // allow bursts of up to one second worth of operations
+  auto now = ceph::mono_clock::now();
+  if (rate_stamp == ceph::mono_time()) {
+    rate_tokens = 1;
+  } else {
+    double elapsed = std::chrono::duration<double>(now - rate_stamp).count();
+    rate_tokens = std::min(std::max(rate, 1.0), rate_tokens + elapsed * rate);
+  }
+  rate_stamp = now;
+
+  if (rate_tokens >= 1) {
+    rate_tokens -= 1;
+    return true;
+  }
+  if (!rate_timer) {
+    rate_timer = new LambdaContext([this](int) {
+      rate_timer = nullptr;
+      kick_off_scrubs();
+    });
+    mdcache->mds->timer.add_event_after((1 - rate_tokens) / rate, rate_timer);
+  }
+  return false;
+}
+
 bool ScrubStack::validate_inode_auth(CInode *in)
 {
   if (in->is_auth()) {
@@ -167,6 +167,13 @@ private:
    */
   void kick_off_scrubs();
 
+  /**
+   * Take a token from the rate limiter (mds_scrub_max_ops_per_sec).
+   * If there is none, schedule kick_off_scrubs() for when one is
+   * available and return false.
+   */
+  bool take_rate_token();
+
   /**
    * Move the inode/dirfrag that can't be scrubbed immediately
    * from scrub queue to waiting list.
@@ -271,6 +278,11 @@ private:
   State state = STATE_IDLE;
   bool clear_stack = false;
 
+  // rate limiter state
+  double rate_tokens = 0;
+  ceph::mono_time rate_stamp;
+  Context *rate_timer = nullptr;
+
   // list of pending context completions for asynchronous scrub
   // control operations.
   std::vector<Context *> control_ctxs;
@@ -3598,10 +3598,10 @@ CInode* Server::prepare_new_inode(const MDRequestRef& mdr, CDir *dir, inodeno_t
     auto p = req->get_data().cbegin();
 
     // xattrs on new inode?
-    auto _xattrs = CInode::allocate_xattr_map();
-    decode_noshare(*_xattrs, p);
-    dout(10) << "prepare_new_inode setting xattrs " << *_xattrs << dendl;
-    in->reset_xattrs(std::move(_xattrs));
+    CInode::mempool_xattr_map _xattrs;
+    decode_noshare(_xattrs, p);
+    dout(10) << "prepare_new_inode setting xattrs " << _xattrs << dendl;
+    in->reset_xattrs(CInode::intern_xattrs(std::move(_xattrs)));
   }
 
   if (!mds->mdsmap->get_inline_data_enabled() ||
@@ -410,6 +410,7 @@ public:
     info.clear_meta();
 
     cap_push_seq = 0;
+    caps_out_batch.clear();
     last_cap_renew = clock::zero();
   }
 
@@ -420,6 +421,7 @@ public:
   xlist<Session*>::item item_session_list;
 
   std::list<ceph::ref_t<Message>> preopen_out_queue;  ///< messages for client, queued before they connect
+  std::vector<ceph::ref_t<Message>> caps_out_batch;   ///< cap messages for client, queued for coalescing
 
   /* This is mutable to allow get_request_count to be const. elist does not
    * support const iterators yet.
@@ -49,7 +49,8 @@ namespace ceph {
 #define CEPHFS_FEATURE_NEW_SNAPREALM_INFO   19
 #define CEPHFS_FEATURE_HAS_OWNER_UIDGID     20
 #define CEPHFS_FEATURE_MDS_AUTH_CAPS_CHECK  21
-#define CEPHFS_FEATURE_MAX                  21
+#define CEPHFS_FEATURE_CAPS_BATCH           22
+#define CEPHFS_FEATURE_MAX                  22
 
 #define CEPHFS_FEATURES_ALL {		\
   0, 1, 2, 3, 4,			\
@@ -71,7 +72,8 @@ namespace ceph {
   CEPHFS_FEATURE_32BITS_RETRY_FWD,      \
   CEPHFS_FEATURE_NEW_SNAPREALM_INFO,    \
   CEPHFS_FEATURE_HAS_OWNER_UIDGID,      \
-  CEPHFS_FEATURE_MDS_AUTH_CAPS_CHECK    \
+  CEPHFS_FEATURE_MDS_AUTH_CAPS_CHECK,   \
+  CEPHFS_FEATURE_CAPS_BATCH             \
 }
 
 #define CEPHFS_METRIC_FEATURES_ALL {		\
@@ -498,8 +498,7 @@ void EMetaBlob::fullbit::decode(bufferlist::const_iterator &bl) {
   {
     CInode::mempool_xattr_map tmp;
     decode_noshare(tmp, bl);
-    if (!tmp.empty())
-      xattrs = CInode::allocate_xattr_map(std::move(tmp));
+    xattrs = CInode::intern_xattrs(std::move(tmp));
   }
   if (inode->is_symlink())
     decode(symlink, bl);
@@ -0,0 +1,65 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <vector>
+
+#include "msg/Message.h"
+
+/*
+ * MClientCapsBatch - cap messages (MClientCaps) for any number of inodes,
+ * coalesced by the MDS into a single message to the same client session.
+ *
+ * Only sent to clients advertising CEPHFS_FEATURE_CAPS_BATCH.  The client
+ * unpacks the batch and handles each message, in order, as if it had
+ * arrived on its own.
+ */
+class MClientCapsBatch final : public SafeMessage {
+private:
+  static constexpr int HEAD_VERSION = 1;
+  static constexpr int COMPAT_VERSION = 1;
+
+public:
+  std::vector<MessageRef> msgs;
+
+protected:
+  MClientCapsBatch()
+    : SafeMessage{CEPH_MSG_CLIENT_CAPS_BATCH, HEAD_VERSION, COMPAT_VERSION} {}
+  explicit MClientCapsBatch(std::vector<MessageRef>&& m)
+    : SafeMessage{CEPH_MSG_CLIENT_CAPS_BATCH, HEAD_VERSION, COMPAT_VERSION},
+      msgs(std::move(m)) {}
+  ~MClientCapsBatch() final {}
+
+public:
+  std::string_view get_type_name() const override { return "client_caps_batch"; }
+  void print(std::ostream& out) const override {
+    out << "client_caps_batch(" << msgs.size() << " msgs)";
+  }
+
+  void encode_payload(uint64_t features) override {
+    using ceph::encode;
+    encode((uint32_t)msgs.size(), payload);
+    for (auto& m : msgs) {
+      encode_message(m.get(), features, payload);
+    }
+  }
+  void decode_payload() override {
+    using ceph::decode;
+    auto p = payload.cbegin();
+    uint32_t n;
+    decode(n, p);
+    msgs.clear();
+    msgs.reserve(n);
+    for (uint32_t i = 0; i < n; ++i) {
+      Message *m = decode_message(nullptr, 0, p);
+      if (!m) {
+	throw ceph::buffer::malformed_input("bad message in client_caps_batch");
+      }
+      msgs.emplace_back(m, false);
+    }
+  }
+private:
+  template<class T, typename... Args>
+  friend boost::intrusive_ptr<T> ceph::make_message(Args&&... args);
+};
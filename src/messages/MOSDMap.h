@@ -162,6 +162,11 @@ public:
     }
   }
 
+  uint64_t get_encoding_key(uint64_t features) const override {
+    // the maps are only reencoded when these differ
+    return OSDMap::get_significant_features(features);
+  }
+
   std::string_view get_type_name() const override { return "osdmap"; }
   void print(std::ostream& out) const override {
     out << "osd_map(" << get_first() << ".." << get_last();
@@ -30,7 +30,9 @@
 
 #include "DaemonKey.h"
 #include "DaemonServer.h"
+#include "PerfCounterSnapshot.h"
 #include "mgr/MgrContext.h"
+#include "PyColumns.h"
 #include "PyFormatter.h"
 // For ::mgr_store_prefix
 #include "PyModule.h"
@@ -419,6 +421,56 @@ PyObject *ActivePyModules::get_python(const std::string &what)
       no_gil.acquire_gil();
       pg_map.dump_pg_stats(&f, false);
     });
+  } else if (what == "pg_stats_columns") {
+    // built without the GIL, and without a python object per PG
+    PyColumns cols;
+    without_gil_t no_gil;
+    cluster_state.with_pgmap([&](const PGMap &pg_map) {
+      for (const auto& [pgid, st] : pg_map.pg_stat) {
+	cols.int_col("pool").push_back(pgid.pool());
+	cols.int_col("ps").push_back(pgid.ps());
+	cols.int_col("state").push_back(st.state);
+	cols.int_col("reported_epoch").push_back(st.reported_epoch);
+	cols.int_col("up_primary").push_back(st.up_primary);
+	cols.int_col("acting_primary").push_back(st.acting_primary);
+	cols.int_col("log_size").push_back(st.log_size);
+	cols.int_col("ondisk_log_size").push_back(st.ondisk_log_size);
+	const auto& sum = st.stats.sum;
+	cols.int_col("num_bytes").push_back(sum.num_bytes);
+	cols.int_col("num_objects").push_back(sum.num_objects);
+	cols.int_col("num_objects_degraded").push_back(sum.num_objects_degraded);
+	cols.int_col("num_objects_misplaced").push_back(sum.num_objects_misplaced);
+	cols.int_col("num_objects_unfound").push_back(sum.num_objects_unfound);
+	cols.int_col("num_omap_bytes").push_back(sum.num_omap_bytes);
+	cols.int_col("num_omap_keys").push_back(sum.num_omap_keys);
+	cols.int_col("num_read").push_back(sum.num_rd);
+	cols.int_col("num_read_kb").push_back(sum.num_rd_kb);
+	cols.int_col("num_write").push_back(sum.num_wr);
+	cols.int_col("num_write_kb").push_back(sum.num_wr_kb);
+      }
+    });
+    no_gil.acquire_gil();
+    return cols.get();
+  } else if (what == "osd_stats_columns") {
+    PyColumns cols;
+    without_gil_t no_gil;
+    cluster_state.with_pgmap([&](const PGMap &pg_map) {
+      for (const auto& [osd, st] : pg_map.osd_stat) {
+	cols.int_col("osd").push_back(osd);
+	cols.int_col("total").push_back(st.statfs.total);
+	cols.int_col("available").push_back(st.statfs.available);
+	cols.int_col("used_raw").push_back(st.statfs.get_used_raw());
+	cols.int_col("num_pgs").push_back(st.num_pgs);
+	cols.int_col("snap_trim_queue_len").push_back(st.snap_trim_queue_len);
+	cols.int_col("num_shards_repaired").push_back(st.num_shards_repaired);
+	cols.int_col("apply_latency_ns").push_back(
+	  st.os_perf_stat.os_apply_latency_ns);
+	cols.int_col("commit_latency_ns").push_back(
+	  st.os_perf_stat.os_commit_latency_ns);
+      }
+    });
+    no_gil.acquire_gil();
+    return cols.get();
   } else if (what == "pool_stats") {
     without_gil_t no_gil;
     cluster_state.with_pgmap([&](const PGMap &pg_map) {
@@ -984,6 +1036,48 @@ PyObject* ActivePyModules::get_perf_schema_python(
   return f.get();
 }
 
+PyObject* ActivePyModules::get_unlabeled_perf_counters_python(
+  int prio_limit,
+  const std::set<std::string> &services)
+{
+  without_gil_t no_gil;
+  PerfCounterSnapshot snap;
+  snap.take(daemon_state, prio_limit, services);
+  no_gil.acquire_gil();
+  PyFormatter f;
+  snap.dump(&f);
+  return f.get();
+}
+
+PyObject* ActivePyModules::get_perf_counters_prometheus(
+  int prio_limit,
+  const std::set<std::string> &services,
+  bool by_host)
+{
+  std::string key = stringify(prio_limit) + (by_host ? " host" : "");
+  for (auto& s : services) {
+    key += " " + s;
+  }
+  std::string text;
+  {
+    without_gil_t no_gil;
+    // daemons report every mgr_stats_period, no need to render more often
+    std::lock_guard l(perf_text_lock);
+    auto now = ceph::coarse_mono_clock::now();
+    auto period = std::chrono::seconds(
+      g_conf().get_val<int64_t>("mgr_stats_period"));
+    if (key != perf_text_key || now - perf_text_stamp >= period) {
+      PerfCounterSnapshot snap;
+      snap.take(daemon_state, prio_limit, services);
+      perf_text = snap.render_prometheus(by_host);
+      perf_text_key = key;
+      perf_text_stamp = now;
+    }
+    text = perf_text;
+  }
+  return PyUnicode_FromStringAndSize(text.data(), text.size());
+}
+
 PyObject* ActivePyModules::get_rocksdb_version()
 {
   std::string version = std::to_string(ROCKSDB_MAJOR) + "." +
@@ -67,6 +67,13 @@ private:
 
   mutable ceph::mutex lock = ceph::make_mutex("ActivePyModules::lock");
 
+  // the last perf counters rendered for prometheus, reused until newer
+  // reports may have come in
+  ceph::mutex perf_text_lock = ceph::make_mutex("ActivePyModules::perf_text");
+  std::string perf_text_key;
+  ceph::coarse_mono_time perf_text_stamp;
+  std::string perf_text;
+
 public:
   ActivePyModules(
     PyModuleConfig &module_config,
@@ -101,6 +108,17 @@ public:
   PyObject *get_perf_schema_python(
      const std::string &svc_type,
      const std::string &svc_id);
+  /// the schema and latest value of the counters of prio_limit or more
+  /// of every daemon of the services, in one dict
+  PyObject *get_unlabeled_perf_counters_python(
+    int prio_limit,
+    const std::set<std::string> &services);
+  /// the same counters in the prometheus text format, with per host
+  /// sums if by_host
+  PyObject *get_perf_counters_prometheus(
+    int prio_limit,
+    const std::set<std::string> &services,
+    bool by_host);
   PyObject *get_rocksdb_version();
   PyObject *get_context();
   PyObject *get_osdmap();
@@ -663,6 +663,61 @@ get_latest_counter(BaseMgrModule *self, PyObject *args)
       svc_name, svc_id, counter_path);
 }
 
+// parse the (int priority, list of service types) arguments of the
+// whole-cluster perf counter getters
+static bool
+parse_perf_counter_args(PyObject *args, const char *format, int *prio_limit,
+			std::set<std::string> *services, int *flag)
+{
+  PyObject *services_list = nullptr;
+  bool ok = flag ?
+    PyArg_ParseTuple(args, format, prio_limit, &services_list, flag) :
+    PyArg_ParseTuple(args, format, prio_limit, &services_list);
+  if (!ok) {
+    return false;
+  }
+  if (!PyList_Check(services_list)) {
+    PyErr_SetString(PyExc_TypeError, "services must be a list");
+    return false;
+  }
+  for (int i = 0; i < PyList_Size(services_list); ++i) {
+    PyObject *svc = PyList_GET_ITEM(services_list, i);
+    if (!PyUnicode_Check(svc)) {
+      PyErr_SetString(PyExc_TypeError, "services must be strings");
+      return false;
+    }
+    services->insert(PyUnicode_AsUTF8(svc));
+  }
+  return true;
+}
+
+static PyObject*
+get_unlabeled_perf_counters(BaseMgrModule *self, PyObject *args)
+{
+  int prio_limit = 0;
+  std::set<std::string> services;
+  if (!parse_perf_counter_args(args, "iO:get_unlabeled_perf_counters",
+			       &prio_limit, &services, nullptr)) {
+    return nullptr;
+  }
+  return self->py_modules->get_unlabeled_perf_counters_python(
+      prio_limit, services);
+}
+
+static PyObject*
+get_perf_counters_prometheus(BaseMgrModule *self, PyObject *args)
+{
+  int prio_limit = 0;
+  int by_host = 0;
+  std::set<std::string> services;
+  if (!parse_perf_counter_args(args, "iOp:get_perf_counters_prometheus",
+			       &prio_limit, &services, &by_host)) {
+    return nullptr;
+  }
+  return self->py_modules->get_perf_counters_prometheus(
+      prio_limit, services, by_host);
+}
+
 static PyObject*
 get_perf_schema(BaseMgrModule *self, PyObject *args)
 {
@@ -1483,6 +1538,12 @@ PyMethodDef BaseMgrModule_methods[] = {
   {"_ceph_get_perf_schema", (PyCFunction)get_perf_schema, METH_VARARGS,
     "Get the performance counter schema"},
 
+  {"_ceph_get_unlabeled_perf_counters", (PyCFunction)get_unlabeled_perf_counters,
+    METH_VARARGS, "Get the schema and latest value of every perf counter"},
+
+  {"_ceph_get_perf_counters_prometheus", (PyCFunction)get_perf_counters_prometheus,
+    METH_VARARGS, "Get every perf counter in the prometheus text format"},
+
   {"_ceph_get_rocksdb_version", (PyCFunction)ceph_get_rocksdb_version, METH_NOARGS,
     "Get the current RocksDB version number"},
 
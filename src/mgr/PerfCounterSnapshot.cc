@@ -0,0 +1,213 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "PerfCounterSnapshot.h"
+
+#include <map>
+#include <regex>
+
+#include <boost/algorithm/string/replace.hpp>
+#include <fmt/format.h>
+
+#include "common/Formatter.h"
+
+void PerfCounterSnapshot::take(DaemonStateIndex& index, int prio_limit,
+			       const std::set<std::string>& services)
+{
+  index.with_daemons_by_server(
+    [&](const std::map<std::string, DaemonStateCollection>& by_server) {
+      for (const auto& [hostname, states] : by_server) {
+	for (const auto& [key, state] : states) {
+	  if (!services.count(key.type)) {
+	    continue;
+	  }
+	  auto& d = daemons.emplace_back();
+	  d.name = ceph::to_string(key);
+	  d.hostname = hostname;
+	  std::lock_guard l(state->lock);
+	  auto& pc = state->perf_counters;
+	  d.counters.reserve(pc.instances.size());
+	  for (const auto& [path, instance] : pc.instances) {
+	    auto t = pc.types.find(path);
+	    if (t == pc.types.end() || t->second.priority < prio_limit) {
+	      continue;
+	    }
+	    counter_t c{&t->second, 0, 0};
+	    if (t->second.type & PERFCOUNTER_LONGRUNAVG) {
+	      if (!instance.get_data_avg().empty()) {
+		c.value = instance.get_latest_data_avg().s;
+		c.count = instance.get_latest_data_avg().c;
+	      }
+	    } else if (!instance.get_data().empty()) {
+	      c.value = instance.get_latest_data().v;
+	    }
+	    d.counters.push_back(c);
+	  }
+	}
+      }
+    });
+}
+
+void PerfCounterSnapshot::dump(ceph::Formatter *f) const
+{
+  for (const auto& d : daemons) {
+    f->open_object_section(d.name);
+    for (const auto& c : d.counters) {
+      const auto& t = *c.type;
+      f->open_object_section(t.path);
+      f->dump_string("description", t.description);
+      if (!t.nick.empty()) {
+	f->dump_string("nick", t.nick);
+      }
+      f->dump_unsigned("type", t.type);
+      f->dump_unsigned("priority", t.priority);
+      f->dump_unsigned("units", t.unit);
+      f->dump_unsigned("value", c.value);
+      if (t.type & PERFCOUNTER_LONGRUNAVG) {
+	f->dump_unsigned("count", c.count);
+      }
+      f->close_section();
+    }
+    f->close_section();
+  }
+}
+
+namespace {
+
+// Must be kept in sync with promethize() in src/exporter/util.cc
+std::string promethize(std::string name)
+{
+  if (name.back() == '-') {
+    name.back() = '_';
+    name += "minus";
+  }
+  std::replace_if(name.begin(), name.end(), [](char ch) {
+    return ch == '.' || ch == '/' || ch == ' ' || ch == '-';
+  }, '_');
+  boost::replace_all(name, "::", "_");
+  boost::replace_all(name, "+", "_plus");
+  return "ceph_" + name;
+}
+
+std::string escape_label(const std::string& v)
+{
+  std::string out;
+  for (char ch : v) {
+    if (ch == '\\' || ch == '"') {
+      out += '\\';
+      out += ch;
+    } else if (ch == '\n') {
+      out += "\\n";
+    } else {
+      out += ch;
+    }
+  }
+  return out;
+}
+
+// the metric type the prometheus module gives a counter type, or none
+// for histograms
+const char *metric_type(uint8_t type)
+{
+  switch (type & ~(PERFCOUNTER_TIME | PERFCOUNTER_U64)) {
+  case 0:
+    return "gauge";
+  case PERFCOUNTER_LONGRUNAVG:
+  case PERFCOUNTER_COUNTER:
+    return "counter";
+  default:
+    return nullptr;
+  }
+}
+
+// the name and labels the prometheus module gives a counter, see
+// MgrModule._perfpath_to_path_labels()
+std::pair<std::string, std::string> path_labels(const std::string& daemon,
+						const std::string& path)
+{
+  static const std::regex rbd_mirror_image(
+    R"(^rbd_mirror_image_([^/]+)/(?:(?:([^/]+)/)?)(.*)\.(replay(?:_bytes|_latency)?)$)");
+  if (daemon.compare(0, 4, "rgw.") == 0) {
+    return {path, "instance_id=\"" + escape_label(daemon.substr(4)) + "\""};
+  }
+  std::string labels = "ceph_daemon=\"" + escape_label(daemon) + "\"";
+  std::smatch m;
+  if (daemon.compare(0, 11, "rbd-mirror.") == 0 &&
+      std::regex_match(path, m, rbd_mirror_image)) {
+    labels += fmt::format(",pool=\"{}\",namespace=\"{}\",image=\"{}\"",
+			  escape_label(m[1]), escape_label(m[2]),
+			  escape_label(m[3]));
+    return {"rbd_mirror_image_" + m[4].str(), labels};
+  }
+  return {path, labels};
+}
+
+struct family_t {
+  const char *type;
+  std::string help;
+  std::vector<std::pair<std::string, double>> samples;
+  std::map<std::string, double> by_host;
+};
+
+}
+
+std::string PerfCounterSnapshot::render_prometheus(bool by_host) const
+{
+  std::map<std::string, family_t> families;
+  auto add = [&](const std::string& name, const char *type,
+		 const std::string& help, const std::string& labels,
+		 const std::string& hostname, double v) {
+    auto& f = families[name];
+    if (!f.type) {
+      f.type = type;
+      f.help = help;
+    }
+    f.samples.emplace_back(labels, v);
+    if (by_host) {
+      f.by_host[hostname] += v;
+    }
+  };
+
+  for (const auto& d : daemons) {
+    for (const auto& c : d.counters) {
+      const auto& t = *c.type;
+      const char *type = metric_type(t.type);
+      if (!type) {
+	continue;
+      }
+      auto [path, labels] = path_labels(d.name, t.path);
+      auto name = promethize(path);
+      double v = c.value;
+      if (t.type & PERFCOUNTER_TIME) {
+	v /= 1000000000.0;
+      }
+      if (t.type & PERFCOUNTER_LONGRUNAVG) {
+	add(name + "_sum", type, t.description + " Total", labels,
+	    d.hostname, v);
+	add(name + "_count", "counter", t.description + " Count", labels,
+	    d.hostname, c.count);
+      } else {
+	add(name, type, t.description, labels, d.hostname, v);
+      }
+    }
+  }
+
+  std::string out;
+  auto it = std::back_inserter(out);
+  for (const auto& [name, f] : families) {
+    fmt::format_to(it, "\n# HELP {} {}\n# TYPE {} {}\n",
+		   name, f.help, name, f.type);
+    for (const auto& [labels, v] : f.samples) {
+      fmt::format_to(it, "{}{{{}}} {}\n", name, labels, v);
+    }
+    if (by_host) {
+      fmt::format_to(it, "\n# HELP {}_by_host {} (sum over the host)\n"
+		     "# TYPE {}_by_host {}\n", name, f.help, name, f.type);
+      for (const auto& [hostname, v] : f.by_host) {
+	fmt::format_to(it, "{}_by_host{{hostname=\"{}\"}} {}\n",
+		       name, escape_label(hostname), v);
+      }
+    }
+  }
+  return out;
+}
@@ -0,0 +1,47 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "DaemonState.h"
+
+namespace ceph {
+  class Formatter;
+}
+
+/**
+ * The latest value of the perf counters of a set of daemons, taken
+ * without the GIL in one pass over the DaemonStateIndex, so that modules
+ * get all of them through one call instead of one call per counter.
+ *
+ * Either dumped in the layout of MgrModule.get_unlabeled_perf_counters(),
+ * or rendered in the Prometheus text format, optionally with the sum of
+ * each counter over the daemons of every host.
+ */
+class PerfCounterSnapshot {
+public:
+  struct counter_t {
+    const PerfCounterType *type;  ///< types are never forgotten
+    uint64_t value;
+    uint64_t count;               ///< LONGRUNAVG only
+  };
+  struct daemon_t {
+    std::string name;       ///< as in "osd.12"
+    std::string hostname;
+    std::vector<counter_t> counters;
+  };
+
+  std::vector<daemon_t> daemons;
+
+  /// the counters of priority at least prio_limit of the daemons of
+  /// the given service types, on a known host
+  void take(DaemonStateIndex& index, int prio_limit,
+	    const std::set<std::string>& services);
+
+  void dump(ceph::Formatter *f) const;
+  std::string render_prometheus(bool by_host) const;
+};
@@ -0,0 +1,78 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+// Python.h comes first because otherwise it clobbers ceph's assert
+#include <Python.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Per-PG or per-OSD stats as one array per field, for the modules that
+ * look at a few fields of every PG or OSD.
+ *
+ * The columns are filled in C++, without the GIL if need be, and handed
+ * to python as typed memoryviews ('q' or 'd') over a single bytes object
+ * each, which python can index, sum or give to numpy.frombuffer() without
+ * a python object per value.
+ */
+class PyColumns {
+  std::map<std::string, std::vector<int64_t>> ints;
+  std::map<std::string, std::vector<double>> doubles;
+
+  template <typename T>
+  static PyObject *to_view(const std::vector<T>& v, const char *format) {
+    PyObject *bytes = PyBytes_FromStringAndSize(
+      reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+    if (!bytes) {
+      return nullptr;
+    }
+    PyObject *raw = PyMemoryView_FromObject(bytes);
+    Py_DECREF(bytes);
+    if (!raw) {
+      return nullptr;
+    }
+    PyObject *view = PyObject_CallMethod(raw, "cast", "s", format);
+    Py_DECREF(raw);
+    return view;
+  }
+
+public:
+  /// the column name, created empty on first use
+  std::vector<int64_t>& int_col(const std::string& name) {
+    return ints[name];
+  }
+  std::vector<double>& double_col(const std::string& name) {
+    return doubles[name];
+  }
+
+  /// a dict of column name to memoryview; needs the GIL
+  PyObject *get() const {
+    PyObject *dict = PyDict_New();
+    auto add = [dict](const std::string& name, PyObject *view) {
+      if (!view) {
+	return false;
+      }
+      PyDict_SetItemString(dict, name.c_str(), view);
+      Py_DECREF(view);
+      return true;
+    };
+    for (auto& [name, v] : ints) {
+      if (!add(name, to_view(v, "q"))) {
+	Py_DECREF(dict);
+	return nullptr;
+      }
+    }
+    for (auto& [name, v] : doubles) {
+      if (!add(name, to_view(v, "d"))) {
+	Py_DECREF(dict);
+	return nullptr;
+      }
+    }
+    return dict;
+  }
+};
@@ -9,6 +9,7 @@
 #include "include/stringify.h"
 
 #include "PyOSDMap.h"
+#include "PyColumns.h"
 #include "PyFormatter.h"
 #include "Gil.h"
 
@@ -340,6 +341,64 @@ static PyObject *osdmap_build_simple(PyObject *cls, PyObject *args, PyObject *kw
   return construct_with_capsule("mgr_module", "OSDMap", reinterpret_cast<void*>(osdmap));
 }
 
+// the parts of the map the modules look at most, without dumping all of it
+
+static PyObject *osdmap_get_pools(BasePyOSDMap *self, PyObject *obj)
+{
+  PyFormatter f;
+  f.open_array_section("pools");
+  for (const auto& [pid, pool] : self->osdmap->get_pools()) {
+    self->osdmap->dump_pool(g_ceph_context, pid, pool, &f);
+  }
+  f.close_section();
+  return f.get();
+}
+
+static PyObject *osdmap_get_erasure_code_profiles(BasePyOSDMap *self,
+						  PyObject *obj)
+{
+  PyFormatter f;
+  OSDMap::dump_erasure_code_profiles(
+    self->osdmap->get_erasure_code_profiles(), &f);
+  return f.get();
+}
+
+static PyObject *osdmap_get_require_osd_release(BasePyOSDMap *self,
+						PyObject *obj)
+{
+  auto name = to_string(self->osdmap->require_osd_release);
+  return PyUnicode_FromStringAndSize(name.data(), name.size());
+}
+
+static PyObject *osdmap_get_osd_columns(BasePyOSDMap *self, PyObject *obj)
+{
+  const OSDMap *m = self->osdmap;
+  PyColumns cols;
+  auto& osd = cols.int_col("osd");
+  auto& up = cols.int_col("up");
+  auto& in = cols.int_col("in");
+  auto& up_from = cols.int_col("up_from");
+  auto& up_thru = cols.int_col("up_thru");
+  auto& down_at = cols.int_col("down_at");
+  auto& weight = cols.double_col("weight");
+  auto& primary_affinity = cols.double_col("primary_affinity");
+  for (int i = 0; i < m->get_max_osd(); ++i) {
+    if (!m->exists(i)) {
+      continue;
+    }
+    osd.push_back(i);
+    up.push_back(m->is_up(i));
+    in.push_back(m->is_in(i));
+    const auto& info = m->get_info(i);
+    up_from.push_back(info.up_from);
+    up_thru.push_back(info.up_thru);
+    down_at.push_back(info.down_at);
+    weight.push_back(m->get_weightf(i));
+    primary_affinity.push_back(m->get_primary_affinityf(i));
+  }
+  return cols.get();
+}
+
 PyMethodDef BasePyOSDMap_methods[] = {
   {"_get_epoch", (PyCFunction)osdmap_get_epoch, METH_NOARGS, "Get OSDMap epoch"},
   {"_get_crush_version", (PyCFunction)osdmap_get_crush_version, METH_NOARGS,
@@ -364,6 +423,14 @@ PyMethodDef BasePyOSDMap_methods[] = {
    "Get raw space to logical space ratio"},
   {"_build_simple", (PyCFunction)osdmap_build_simple, METH_VARARGS | METH_CLASS,
    "Create a simple OSDMap"},
+  {"_get_pools", (PyCFunction)osdmap_get_pools, METH_NOARGS,
+   "Get the pools, as dumped in the map"},
+  {"_get_erasure_code_profiles", (PyCFunction)osdmap_get_erasure_code_profiles,
+   METH_NOARGS, "Get the erasure code profiles"},
+  {"_get_require_osd_release", (PyCFunction)osdmap_get_require_osd_release,
+   METH_NOARGS, "Get the require_osd_release"},
+  {"_get_osd_columns", (PyCFunction)osdmap_get_osd_columns, METH_NOARGS,
+   "Get the state of every OSD, one array per field"},
   {NULL, NULL, 0, NULL}
 };
 
@@ -134,6 +134,26 @@ void ConfigMap::dump(Formatter *f) const
   f->close_section();
 }
 
+vector<std::string> ConfigMap::get_entity_sections(const EntityName& name) const
+{
+  // name prefix components are .-separated,
+  // e.g. client.a.b.c -> [client.a, client.a.b, client.a.b.c]
+  vector<std::string> r;
+  vector<std::string> name_bits;
+  boost::split(name_bits, name.to_str(), [](char c){ return c == '.'; });
+  std::string tname;
+  for (unsigned p = 0; p < name_bits.size(); ++p) {
+    if (p) {
+      tname += '.';
+    }
+    tname += name_bits[p];
+    if (by_id.count(tname)) {
+      r.push_back(tname);
+    }
+  }
+  return r;
+}
+
 std::map<std::string,std::string,std::less<>>
 ConfigMap::generate_entity_map(
   const EntityName& name,
@@ -150,18 +170,8 @@ ConfigMap::generate_entity_map(
   if (p != by_type.end()) {
     sections.emplace_back(name.get_type_name(), &p->second);
   }
-  vector<std::string> name_bits;
-  boost::split(name_bits, name.to_str(), [](char c){ return c == '.'; });
-  std::string tname;
-  for (unsigned p = 0; p < name_bits.size(); ++p) {
-    if (p) {
-      tname += '.';
-    }
-    tname += name_bits[p];
-    auto q = by_id.find(tname);
-    if (q != by_id.end()) {
-      sections.push_back(make_pair(tname, &q->second));
-    }
+  for (auto& tname : get_entity_sections(name)) {
+    sections.push_back(make_pair(tname, &by_id.find(tname)->second));
   }
   std::map<std::string,std::string,std::less<>> out;
   MaskedOption *prev = nullptr;
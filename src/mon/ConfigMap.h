@@ -134,6 +134,8 @@ struct ConfigMap {
   }
   void dump(ceph::Formatter *f) const;
 
+  /// the by_id sections that apply to name, least specific first
+  std::vector<std::string> get_entity_sections(const EntityName& name) const;
   std::map<std::string,std::string,std::less<>> generate_entity_map(
     const EntityName& name,
     const std::map<std::string,std::string>& crush_location,
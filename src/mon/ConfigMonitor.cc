@@ -782,6 +782,7 @@ void ConfigMonitor::load_config()
 
   config_map.clear();
   current.clear();
+  entity_config_cache.clear();
 
   unsigned num = 0;
   KeyValueDB::Iterator it = mon.store->get_iterator(KV_PREFIX);
@@ -894,11 +895,27 @@ bool ConfigMonitor::refresh_config(MonSession *s)
 
   dout(20) << __func__ << " " << s->entity_name << " crush " << crush_location
 	   << " device_class " << device_class << dendl;
-  auto out = config_map.generate_entity_map(
-    s->entity_name,
-    crush_location,
-    osdmap.crush.get(),
-    device_class);
+  if (entity_config_cache_epoch != osdmap.get_epoch()) {
+    // mask precision depends on the crush map
+    entity_config_cache.clear();
+    entity_config_cache_epoch = osdmap.get_epoch();
+  }
+  entity_config_key_t key{
+    s->entity_name.get_type_name(),
+    config_map.get_entity_sections(s->entity_name),
+    std::move(crush_location),
+    std::move(device_class)};
+  auto q = entity_config_cache.find(key);
+  if (q == entity_config_cache.end()) {
+    q = entity_config_cache.emplace(
+      key,
+      config_map.generate_entity_map(
+	s->entity_name,
+	std::get<2>(key),
+	osdmap.crush.get(),
+	std::get<3>(key))).first;
+  }
+  const auto& out = q->second;
 
   if (out == s->last_config && s->any_config) {
     dout(20) << __func__ << " no change, " << out << dendl;
@@ -907,7 +924,7 @@ bool ConfigMonitor::refresh_config(MonSession *s)
   // removing this to hide sensitive data going into logs
   // leaving this for debugging purposes
  //  dout(20) << __func__ << " " << out << dendl;
-  s->last_config = std::move(out);
+  s->last_config = out;
   s->any_config = true;
   return true;
 }
@@ -20,6 +20,18 @@ class ConfigMonitor : public PaxosService
 
   std::map<std::string,ceph::buffer::list> current;
 
+  /// generated entity maps, keyed by what they depend on: entity type,
+  /// matching by_id sections, crush location and device class.  valid
+  /// for the current config_map and entity_config_cache_epoch.
+  using entity_config_key_t = std::tuple<
+    std::string,
+    std::vector<std::string>,
+    std::map<std::string,std::string>,
+    std::string>;
+  std::map<entity_config_key_t,
+	   std::map<std::string,std::string,std::less<>>> entity_config_cache;
+  epoch_t entity_config_cache_epoch = 0;
+
   void encode_pending_to_kvmon();
 
 public:
@@ -510,6 +510,9 @@ void LogMonitor::create_pending()
 {
   pending_log.clear();
   pending_keys.clear();
+  pending_repeats.clear();
+  pending_per_channel.clear();
+  pending_dropped.clear();
   dout(10) << "create_pending v " << (get_last_committed() + 1) << dendl;
 }
 
@@ -531,6 +534,20 @@ void LogMonitor::encode_pending(MonitorDBStore::TransactionRef t)
   bufferlist bl;
   dout(10) << __func__ << " v" << version << dendl;
 
+  for (auto& [key, repeat] : pending_repeats) {
+    if (repeat.second) {
+      repeat.first->second.msg +=
+	fmt::format(" (repeated {} more times)", repeat.second);
+    }
+  }
+  for (auto& [channel, dropped] : pending_dropped) {
+    dout(1) << __func__ << " dropped " << dropped << " " << channel
+	    << " entries over mon_log_max_pending_per_channel" << dendl;
+    mon.clog->warn() << "dropped " << dropped << " cluster log entries on "
+		     << "channel " << channel
+		     << " (mon_log_max_pending_per_channel)";
+  }
+
   if (mon.monmap->min_mon_release < ceph_release_t::quincy) {
     // legacy encoding for pre-quincy quorum
     __u8 struct_v = 1;
@@ -742,14 +759,34 @@ bool LogMonitor::prepare_log(MonOpRequestRef op)
     return false;
   }
 
+  const bool collapse = g_conf().get_val<bool>("mon_log_collapse_repeats");
+  const uint64_t budget =
+    g_conf().get_val<uint64_t>("mon_log_max_pending_per_channel");
   for (auto p = m->entries.begin();
        p != m->entries.end();
        ++p) {
     dout(10) << " logging " << *p << dendl;
-    if (!summary.contains(p->key()) &&
-	!pending_keys.count(p->key())) {
-      pending_keys.insert(p->key());
-      pending_log.insert(pair<utime_t,LogEntry>(p->stamp, *p));
+    if (summary.contains(p->key()) ||
+	pending_keys.count(p->key())) {
+      continue;
+    }
+    pending_keys.insert(p->key());
+    auto repeat_key = std::make_tuple(p->channel, p->prio, p->msg);
+    if (collapse) {
+      auto r = pending_repeats.find(repeat_key);
+      if (r != pending_repeats.end()) {
+	++r->second.second;
+	continue;
+      }
+    }
+    if (budget && pending_per_channel[p->channel] >= budget) {
+      ++pending_dropped[p->channel];
+      continue;
+    }
+    ++pending_per_channel[p->channel];
+    auto i = pending_log.insert(pair<utime_t,LogEntry>(p->stamp, *p));
+    if (collapse) {
+      pending_repeats.emplace(std::move(repeat_key), std::make_pair(i, 0));
     }
   }
   wait_for_commit(op, new C_Log(this, op));
@@ -45,6 +45,12 @@ class LogMonitor : public PaxosService,
 private:
   std::multimap<utime_t,LogEntry> pending_log;
   unordered_set<LogEntryKey> pending_keys;
+  /// pending entries by (channel, prio, msg), and how often they repeated
+  std::map<std::tuple<std::string, clog_type, std::string>,
+	   std::pair<std::multimap<utime_t,LogEntry>::iterator, uint64_t>>
+    pending_repeats;
+  std::map<std::string, uint64_t> pending_per_channel;
+  std::map<std::string, uint64_t> pending_dropped;
 
   LogSummary summary;
 
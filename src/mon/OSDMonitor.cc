@@ -788,6 +788,7 @@ void OSDMonitor::update_from_paxos(bool *need_bootstrap)
     dout(7) << __func__ << " loading latest full map e" << latest_full << dendl;
     osdmap = OSDMap();
     osdmap.decode(latest_bl);
+    last_applied_inc.reset();
   }
 
   bufferlist bl;
@@ -909,6 +910,7 @@ void OSDMonitor::update_from_paxos(bool *need_bootstrap)
 	osd_epochs.erase(osd);
       }
     }
+    last_applied_inc = std::move(inc);
   }
 
   if (t) {
@@ -1071,8 +1073,15 @@ void OSDMonitor::start_mapping()
   }
   if (!osdmap.get_pools().empty()) {
     auto fin = new C_UpdateCreatingPGs(this, osdmap.get_epoch());
-    mapping_job = mapping.start_update(osdmap, mapper,
-				       g_conf()->mon_osd_mapping_pgs_per_chunk);
+    if (last_applied_inc &&
+	last_applied_inc->epoch == osdmap.get_epoch() &&
+	g_conf().get_val<bool>("mon_osd_mapping_incremental")) {
+      mapping_job = mapping.start_update(osdmap, *last_applied_inc, mapper,
+					 g_conf()->mon_osd_mapping_pgs_per_chunk);
+    } else {
+      mapping_job = mapping.start_update(osdmap, mapper,
+					 g_conf()->mon_osd_mapping_pgs_per_chunk);
+    }
     dout(10) << __func__ << " started mapping job " << mapping_job.get()
 	     << " at " << fin->start << dendl;
     mapping_job->set_finish_event(fin);
@@ -1446,37 +1455,51 @@ void OSDMonitor::maybe_prime_pg_temp()
     }
   } else {
     dout(10) << __func__ << " " << osds.size() << " interesting osds" << dendl;
-    utime_t stop = ceph_clock_now();
-    stop += g_conf()->mon_osd_prime_pg_temp_max_time;
-    const int chunk = 1000;
-    int n = chunk;
+    // only the pgs mapped to the interesting osds can change
     std::unordered_set<pg_t> did_pgs;
+    vector<pg_t> pgs;
     for (auto osd : osds) {
-      auto& pgs = mapping.get_osd_acting_pgs(osd);
-      dout(20) << __func__ << " osd." << osd << " " << pgs << dendl;
-      for (auto pgid : pgs) {
-	if (!did_pgs.insert(pgid).second) {
-	  continue;
-	}
-	prime_pg_temp(next, pgid);
-	if (--n <= 0) {
-	  n = chunk;
-	  if (ceph_clock_now() > stop) {
-	    dout(10) << __func__ << " consumed more than "
-		     << g_conf()->mon_osd_prime_pg_temp_max_time
-		     << " seconds, stopping"
-		     << dendl;
-	    return;
-	  }
+      auto& osd_pgs = mapping.get_osd_acting_pgs(osd);
+      dout(20) << __func__ << " osd." << osd << " " << osd_pgs << dendl;
+      for (auto pgid : osd_pgs) {
+	if (did_pgs.insert(pgid).second) {
+	  pgs.push_back(pgid);
 	}
       }
     }
+    if (pgs.empty()) {
+      return;
+    }
+    PrimeTempJob job(next, this);
+    mapper.queue(&job, g_conf()->mon_osd_mapping_pgs_per_chunk, pgs);
+    if (job.wait_for(g_conf()->mon_osd_prime_pg_temp_max_time)) {
+      dout(10) << __func__ << " done " << pgs.size() << " pgs in "
+	       << job.get_duration() << dendl;
+    } else {
+      dout(10) << __func__ << " consumed more than "
+	       << g_conf()->mon_osd_prime_pg_temp_max_time
+	       << " seconds, stopping" << dendl;
+      job.abort();
+    }
+  }
+}
+
+void OSDMonitor::add_primed_pg_temps(primed_pg_temps_t&& primed)
+{
+  if (primed.empty()) {
+    return;
+  }
+  std::lock_guard l(prime_pg_temp_lock);
+  for (auto& [pgid, acting] : primed) {
+    // do not touch a mapping if a change is pending
+    pending_inc.new_pg_temp.emplace(pgid, std::move(acting));
   }
 }
 
 void OSDMonitor::prime_pg_temp(
   const OSDMap& next,
-  pg_t pgid)
+  pg_t pgid,
+  primed_pg_temps_t *primed)
 {
   // TODO: remove this creating_pgs direct access?
   if (creating_pgs.pgs.count(pgid)) {
@@ -1513,13 +1536,9 @@ void OSDMonitor::prime_pg_temp(
 	   << " -> " << next_up << "/" << next_acting
 	   << ", priming " << acting
 	   << dendl;
-  {
-    std::lock_guard l(prime_pg_temp_lock);
-    // do not touch a mapping if a change is pending
-    pending_inc.new_pg_temp.emplace(
-      pgid,
-      mempool::osdmap::vector<int>(acting.begin(), acting.end()));
-  }
+  primed->emplace_back(
+    pgid,
+    mempool::osdmap::vector<int>(acting.begin(), acting.end()));
 }
 
 /**
@@ -2205,7 +2224,18 @@ void OSDMonitor::share_map_with_random_osd()
     return;
   }
 
-  MonSession *s = mon.session_map.get_random_osd_session(&osdmap);
+  MonSession *s = nullptr;
+  if (g_conf().get_val<uint64_t>("osd_map_fanout")) {
+    // start at the root of the osd fan-out tree if it is connected to us;
+    // otherwise whoever we pick passes the map on to the root
+    vector<int> order;
+    osdmap.get_fanout_order(&order);
+    s = mon.session_map.get_osd_session(osdmap.get_fanout_root(order),
+					osdmap);
+  }
+  if (!s) {
+    s = mon.session_map.get_random_osd_session(&osdmap);
+  }
   if (!s) {
     dout(10) << __func__ << " no up osd on our session map" << dendl;
     return;
@@ -5405,7 +5435,8 @@ namespace {
     CSUM_TYPE, CSUM_MAX_BLOCK, CSUM_MIN_BLOCK, FINGERPRINT_ALGORITHM,
     PG_AUTOSCALE_MODE, PG_NUM_MIN, TARGET_SIZE_BYTES, TARGET_SIZE_RATIO,
     PG_AUTOSCALE_BIAS, DEDUP_TIER, DEDUP_CHUNK_ALGORITHM, 
-    DEDUP_CDC_CHUNK_SIZE, POOL_EIO, BULK, PG_NUM_MAX, READ_RATIO };
+    DEDUP_CDC_CHUNK_SIZE, POOL_EIO, BULK, PG_NUM_MAX, READ_RATIO,
+    CACHE_PRIORITY };
 
   std::set<osd_pool_get_choices>
     subtract_second_from_first(const std::set<osd_pool_get_choices>& first,
@@ -6156,7 +6187,8 @@ bool OSDMonitor::preprocess_command(MonOpRequestRef op)
       {"dedup_chunk_algorithm", DEDUP_CHUNK_ALGORITHM},
       {"dedup_cdc_chunk_size", DEDUP_CDC_CHUNK_SIZE},
       {"bulk", BULK},
-      {"read_ratio", READ_RATIO}
+      {"read_ratio", READ_RATIO},
+      {"cache_priority", CACHE_PRIORITY}
     };
 
     typedef std::set<osd_pool_get_choices> choices_set_t;
@@ -6403,6 +6435,7 @@ bool OSDMonitor::preprocess_command(MonOpRequestRef op)
 	  case DEDUP_CHUNK_ALGORITHM:
 	  case DEDUP_CDC_CHUNK_SIZE:
           case READ_RATIO:
+          case CACHE_PRIORITY:
             pool_opts_t::key_t key = pool_opts_t::get_opt_desc(i->first).key;
             if (p->opts.is_set(key)) {
               if(*it == CSUM_TYPE) {
@@ -6567,6 +6600,7 @@ bool OSDMonitor::preprocess_command(MonOpRequestRef op)
 	  case DEDUP_CHUNK_ALGORITHM:
 	  case DEDUP_CDC_CHUNK_SIZE:
           case READ_RATIO:
+          case CACHE_PRIORITY:
 	    for (i = ALL_CHOICES.begin(); i != ALL_CHOICES.end(); ++i) {
 	      if (i->second == *it)
 		break;
@@ -8985,6 +9019,15 @@ int OSDMonitor::prepare_command_pool_set(const cmdmap_t& cmdmap,
         ss << "read_ratio must be between 0 and 100";
         return -ERANGE;
       }
+    } else if (var == "cache_priority") {
+      if (interr.length()) {
+        ss << "error parsing int value '" << val << "': " << interr;
+        return -EINVAL;
+      }
+      if (n < 0 || n > 10) {
+        ss << "cache_priority must be between 0 and 10";
+        return -ERANGE;
+      }
     }
 
     pool_opts_t::opt_desc_t desc = pool_opts_t::get_opt_desc(var);
@@ -14584,7 +14627,7 @@ int OSDMonitor::_prepare_remove_pool(
     }
   }
   // remove any pg_upmap mappings for this pool
-  for (auto& p : osdmap.pg_upmap) {
+  for (auto& p : *osdmap.pg_upmap) {
     if (p.first.pool() == pool) {
       dout(10) << __func__ << " " << pool
                << " removing obsolete pg_upmap "
@@ -14607,7 +14650,7 @@ int OSDMonitor::_prepare_remove_pool(
     }
   }
   // remove any pg_upmap_items mappings for this pool
-  for (auto& p : osdmap.pg_upmap_items) {
+  for (auto& p : *osdmap.pg_upmap_items) {
     if (p.first.pool() == pool) {
       dout(10) << __func__ << " " << pool
                << " removing obsolete pg_upmap_items " << p.first
@@ -370,25 +370,41 @@ private:
 
   ceph::mutex prime_pg_temp_lock =
     ceph::make_mutex("OSDMonitor::prime_pg_temp_lock");
+  using primed_pg_temps_t =
+    std::vector<std::pair<pg_t, mempool::osdmap::vector<int>>>;
   struct PrimeTempJob : public ParallelPGMapper::Job {
     OSDMonitor *osdmon;
     PrimeTempJob(const OSDMap& om, OSDMonitor *m)
       : ParallelPGMapper::Job(&om), osdmon(m) {}
     void process(int64_t pool, unsigned ps_begin, unsigned ps_end) override {
+      primed_pg_temps_t primed;
       for (unsigned ps = ps_begin; ps < ps_end; ++ps) {
 	pg_t pgid(ps, pool);
-	osdmon->prime_pg_temp(*osdmap, pgid);
+	osdmon->prime_pg_temp(*osdmap, pgid, &primed);
       }
+      osdmon->add_primed_pg_temps(std::move(primed));
+    }
+    void process(const std::vector<pg_t>& pgs) override {
+      primed_pg_temps_t primed;
+      for (auto pgid : pgs) {
+	osdmon->prime_pg_temp(*osdmap, pgid, &primed);
+      }
+      osdmon->add_primed_pg_temps(std::move(primed));
     }
-    void process(const std::vector<pg_t>& pgs) override {}
     void complete() override {}
   };
   void maybe_prime_pg_temp();
-  void prime_pg_temp(const OSDMap& next, pg_t pgid);
+  /// compute the pg_temp to prime for pgid, if any, into *primed
+  void prime_pg_temp(const OSDMap& next, pg_t pgid,
+		     primed_pg_temps_t *primed);
+  /// add a batch of primed pg_temps to pending_inc
+  void add_primed_pg_temps(primed_pg_temps_t&& primed);
 
   ParallelPGMapper mapper;                        ///< for background pg work
   OSDMapMapping mapping;                          ///< pg <-> osd mappings
   std::unique_ptr<ParallelPGMapper::Job> mapping_job;  ///< background mapping job
+  /// last incremental applied by update_from_paxos, for incremental remapping
+  std::optional<OSDMap::Incremental> last_applied_inc;
   void start_mapping();
 
   void update_logger();
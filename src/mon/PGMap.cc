@@ -1136,7 +1136,12 @@ void PGMap::apply_incremental(CephContext *cct, const Incremental& inc)
     pool_stat_t &pool_sum_ref = pg_pool_sum[update_pool];
     if (pg_stat_iter == pg_stat.end()) {
       pg_stat.insert(make_pair(update_pg, update_stat));
+      purged_snaps_dirty.insert(update_pool);
     } else {
+      if ((pg_stat_iter->second.state == 0) != (update_stat.state == 0) ||
+	  pg_stat_iter->second.purged_snaps != update_stat.purged_snaps) {
+	purged_snaps_dirty.insert(update_pool);
+      }
       stat_pg_sub(update_pg, pg_stat_iter->second);
       pool_sum_ref.sub(pg_stat_iter->second);
       pg_stat_iter->second = update_stat;
@@ -1198,6 +1203,7 @@ void PGMap::apply_incremental(CephContext *cct, const Incremental& inc)
       }
 
       pg_stat.erase(s);
+      purged_snaps_dirty.insert(removed_pg.pool());
       if (pool_erased) {
         deleted_pools.insert(removed_pg.pool());
       }
@@ -1266,6 +1272,7 @@ void PGMap::calc_stats()
   pg_pool_sum.clear();
   num_pg_by_pool.clear();
   pg_by_osd.clear();
+  purged_snaps.clear();
   pg_sum = pool_stat_t();
   osd_sum = osd_stat_t();
   osd_sum_by_class.clear();
@@ -1279,6 +1286,7 @@ void PGMap::calc_stats()
     auto pg = p->first;
     stat_pg_add(pg, p->second);
     pg_pool_sum[pg.pool()].add(p->second);
+    purged_snaps_dirty.insert(pg.pool());
   }
   for (auto p = pool_statfs.begin();
        p != pool_statfs.end();
@@ -1429,9 +1437,19 @@ bool PGMap::stat_pg_sub(const pg_t &pgid, const pg_stat_t &s,
 
 void PGMap::calc_purged_snaps()
 {
-  purged_snaps.clear();
+  // only pools with a pg whose purged_snaps (or unknown state) changed
+  // since the last call need another pass
+  if (purged_snaps_dirty.empty()) {
+    return;
+  }
+  for (auto pool : purged_snaps_dirty) {
+    purged_snaps.erase(pool);
+  }
   set<int64_t> unknown;
   for (auto& i : pg_stat) {
+    if (!purged_snaps_dirty.count(i.first.pool())) {
+      continue;
+    }
     if (i.second.state == 0) {
       unknown.insert(i.first.pool());
       purged_snaps.erase(i.first.pool());
@@ -1447,6 +1465,7 @@ void PGMap::calc_purged_snaps()
       j->second.intersection_of(i.second.purged_snaps);
     }
   }
+  purged_snaps_dirty.clear();
 }
 
 void PGMap::calc_osd_sum_by_class(const OSDMap& osdmap)
@@ -318,6 +318,8 @@ public:
   mempool::pgmap::unordered_map<int,int> blocked_by_sum;
   mempool::pgmap::list<std::pair<pool_stat_t, utime_t> > pg_sum_deltas;
   mempool::pgmap::unordered_map<int64_t,mempool::pgmap::unordered_map<uint64_t,int32_t>> num_pg_by_pool_state;
+  /// pools whose purged_snaps must be recomputed by calc_purged_snaps()
+  mempool::pgmap::set<int64_t> purged_snaps_dirty;
 
   utime_t stamp;
 
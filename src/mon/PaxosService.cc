@@ -16,6 +16,7 @@
 #include "common/Clock.h"
 #include "common/config.h"
 #include "include/stringify.h"
+#include "common/strtol.h"
 #include "include/ceph_assert.h"
 #include "mon/MonOpRequest.h"
 
@@ -256,6 +257,22 @@ void PaxosService::propose_pending()
     }
   };
   paxos.queue_pending_finisher(new C_Committed(this));
+
+  if (g_conf().get_val<bool>("paxos_propose_coalesce") &&
+      !paxos.is_plugged()) {
+    // other services that are only waiting for their proposal timer
+    // ride along in this round rather than starting one of their own
+    paxos.plug();
+    for (auto& svc : mon.paxos_service) {
+      if (svc.get() != this && svc->proposal_timer && svc->have_pending &&
+	  svc->is_active()) {
+	dout(10) << __func__ << " coalescing " << svc->get_service_name()
+		 << dendl;
+	svc->propose_pending();
+      }
+    }
+    paxos.unplug();
+  }
   paxos.trigger_propose();
 }
 
@@ -448,12 +465,35 @@ void PaxosService::trim(MonitorDBStore::TransactionRef t,
   for (version_t v = from; v < to; ++v) {
     dout(20) << __func__ << " " << v << dendl;
     t->erase(get_service_name(), v);
+  }
 
-    string full_key = mon.store->combine_strings("full", v);
-    if (mon.store->exists(get_service_name(), full_key)) {
-      dout(20) << __func__ << " " << full_key << dendl;
-      t->erase(get_service_name(), full_key);
+  // full versions are only stashed every so often; find the ones to
+  // trim by scanning for them rather than probing the store for every
+  // trimmed version.  keys are not zero-padded, so only versions with
+  // the same number of digits sort contiguously: scan one such window
+  // at a time.
+  auto it = mon.store->get_iterator(get_service_name());
+  for (version_t lo = from; lo < to; ) {
+    version_t next_digit = 1;
+    while (next_digit <= lo) {
+      next_digit *= 10;
+    }
+    const version_t hi = std::min(to, next_digit);
+    const string lo_key = mon.store->combine_strings(full_prefix_name, lo);
+    const string hi_key = mon.store->combine_strings(full_prefix_name, hi - 1);
+    for (it->lower_bound(lo_key);
+	 it->valid() && it->key() <= hi_key;
+	 it->next()) {
+      string err;
+      version_t v = strict_strtoll(
+	it->key().substr(full_prefix_name.size() + 1), 10, &err);
+      if (!err.empty() || v < lo || v >= hi) {
+	continue;  // a longer version sorting in between
+      }
+      dout(20) << __func__ << " " << it->key() << dendl;
+      t->erase(get_service_name(), it->key());
     }
+    lo = hi;
   }
   if (g_conf()->mon_compact_on_trim) {
     dout(20) << " compacting prefix " << get_service_name() << dendl;
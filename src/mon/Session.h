@@ -211,6 +211,19 @@ struct MonSessionMap {
     }
   }
 
+  /// a session with the given up osd, or nullptr
+  MonSession *get_osd_session(int osd, const OSDMap& osdmap) {
+    if (!osdmap.is_up(osd)) {
+      return nullptr;
+    }
+    for (auto [p, end] = by_osd.equal_range(osd); p != end; ++p) {
+      if (osdmap.get_addrs(osd) == p->second->con->get_peer_addrs()) {
+	return p->second;
+      }
+    }
+    return nullptr;
+  }
+
   MonSession *get_random_osd_session(OSDMap *osdmap) {
     // ok, this isn't actually random, but close enough.
     if (by_osd.empty())
@@ -55,8 +55,14 @@ public:
   bool is_loopback = false;
   bool failed = false; // true if we are a lossy connection that has failed.
 
+  // destination buffers for replies, keyed by tid.  The reading side
+  // marks the entry it is currently filling in rx_buffer_claimed; a
+  // revoke_rx_buffer() of that entry sets rx_buffer_revoked and leaves it
+  // to the reader to stop using the buffers.
   int rx_buffers_version = 0;
   std::map<ceph_tid_t,std::pair<ceph::buffer::list, int>> rx_buffers;
+  ceph_tid_t rx_buffer_claimed = 0;
+  bool rx_buffer_revoked = false;
 
   // authentication state
   // FIXME make these private after ms_handle_authorizer is removed
@@ -207,19 +213,59 @@ public:
     return CEPH_CON_MODE_CRC;
   }
 
+  /**
+   * Register the buffers the data payload of the reply to tid should
+   * be read into.  Only honoured by messengers that can read the
+   * message header ahead of its data (msgr2 in crc mode); others keep
+   * allocating their own buffers.  The caller must not read bl before
+   * the reply is in, or before revoke_rx_buffer(tid).
+   */
   void post_rx_buffer(ceph_tid_t tid, ceph::buffer::list& bl) {
-#if 0
     std::lock_guard l{lock};
     ++rx_buffers_version;
-    rx_buffers[tid] = pair<bufferlist,int>(bl, rx_buffers_version);
-#endif
+    rx_buffers[tid] = std::pair<ceph::buffer::list,int>(bl, rx_buffers_version);
   }
 
+  /**
+   * Forget the buffers posted for tid.  Does not block: if the reader is
+   * filling them, it stops at the next buffer boundary and copies what it
+   * read so far out of them, so that the message it delivers does not
+   * refer to them.  A ptr read under way still completes into its memory.
+   */
   void revoke_rx_buffer(ceph_tid_t tid) {
-#if 0
     std::lock_guard l{lock};
     rx_buffers.erase(tid);
-#endif
+    if (rx_buffer_claimed == tid) {
+      rx_buffer_revoked = true;
+    }
+  }
+
+  /// messenger side: take the buffers posted for tid, if any
+  bool claim_rx_buffer(ceph_tid_t tid, ceph::buffer::list& bl) {
+    std::lock_guard l{lock};
+    auto p = rx_buffers.find(tid);
+    if (p == rx_buffers.end()) {
+      return false;
+    }
+    ceph_assert(rx_buffer_claimed == 0);
+    rx_buffer_claimed = tid;
+    rx_buffer_revoked = false;
+    bl = p->second.first;
+    return true;
+  }
+
+  /// messenger side: whether the claimed buffers were revoked meanwhile
+  bool is_rx_buffer_revoked() const {
+    std::lock_guard l{lock};
+    return rx_buffer_revoked;
+  }
+
+  /// messenger side: done writing into the claimed buffers, returns
+  /// whether they were revoked meanwhile
+  bool release_rx_buffer() {
+    std::lock_guard l{lock};
+    rx_buffer_claimed = 0;
+    return std::exchange(rx_buffer_revoked, false);
   }
 
   utime_t get_last_keepalive() const {
@@ -89,6 +89,7 @@
 #include "messages/MOSDPGTrim.h"
 #include "messages/MOSDPGLease.h"
 #include "messages/MOSDPGLeaseAck.h"
+#include "messages/MOSDRepOpBatch.h"
 #include "messages/MOSDScrub2.h"
 #include "messages/MOSDScrubReserve.h"
 #include "messages/MOSDRepScrub.h"
@@ -124,6 +125,7 @@
 #include "messages/MClientReclaim.h"
 #include "messages/MClientReclaimReply.h"
 #include "messages/MClientCaps.h"
+#include "messages/MClientCapsBatch.h"
 #include "messages/MClientCapRelease.h"
 #include "messages/MClientLease.h"
 #include "messages/MClientSnap.h"
@@ -232,7 +234,25 @@ void Message::encode(uint64_t features, int crcflags, bool skip_header_crc)
   // encode and copy out of *m
   if (empty_payload()) {
     ceph_assert(middle.length() == 0);
-    encode_payload(features);
+    if (encode_cache) {
+      std::lock_guard l(encode_cache->lock);
+      auto [p, inserted] =
+	encode_cache->entries.try_emplace(get_encoding_key(features));
+      if (inserted) {
+	encode_payload(features);
+	p->second.payload = payload;
+	p->second.middle = middle;
+	p->second.version = header.version;
+	p->second.compat_version = header.compat_version;
+      } else {
+	payload = p->second.payload;
+	middle = p->second.middle;
+	header.version = p->second.version;
+	header.compat_version = p->second.compat_version;
+      }
+    } else {
+      encode_payload(features);
+    }
 
     if (byte_throttler) {
       byte_throttler->take(payload.length() + middle.length());
@@ -594,6 +614,9 @@ Message *decode_message(CephContext *cct,
   case MSG_OSD_PG_LEASE_ACK:
     m = make_message<MOSDPGLeaseAck>();
     break;
+  case MSG_OSD_REPOP_BATCH:
+    m = make_message<MOSDRepOpBatch>();
+    break;
 
   case MSG_OSD_SCRUB2:
     m = make_message<MOSDScrub2>();
@@ -695,6 +718,9 @@ Message *decode_message(CephContext *cct,
   case CEPH_MSG_CLIENT_CAPS:
     m = make_message<MClientCaps>();
     break;
+  case CEPH_MSG_CLIENT_CAPS_BATCH:
+    m = make_message<MClientCapsBatch>();
+    break;
   case CEPH_MSG_CLIENT_CAPRELEASE:
     m = make_message<MClientCapRelease>();
     break;
@@ -17,6 +17,8 @@
 
 #include <concepts>
 #include <cstdlib>
+#include <map>
+#include <memory>
 #include <ostream>
 #include <string_view>
 
@@ -147,6 +149,7 @@
 
 #define MSG_OSD_PG_LEASE        133
 #define MSG_OSD_PG_LEASE_ACK    134
+#define MSG_OSD_REPOP_BATCH     136
 
 // *** MDS ***
 
@@ -244,6 +247,32 @@
 
 // ======================================================
 
+/*
+ * Payload encodings shared by messages with identical contents.
+ *
+ * A sender handing the same message to many peers attaches one cache
+ * to each copy.  The first copy encoded for a given feature set (as
+ * reduced by Message::get_encoding_key()) fills the cache; the others
+ * share its refcounted bufferlists instead of encoding again.
+ */
+class MessageEncodeCache {
+  struct entry_t {
+    ceph::buffer::list payload;
+    ceph::buffer::list middle;
+    __u16 version = 0;
+    __u16 compat_version = 0;
+  };
+  ceph::mutex lock = ceph::make_mutex("MessageEncodeCache::lock");
+  std::map<uint64_t, entry_t> entries;
+  friend class Message;
+public:
+  size_t size() {
+    std::lock_guard l(lock);
+    return entries.size();
+  }
+};
+using MessageEncodeCacheRef = std::shared_ptr<MessageEncodeCache>;
+
 // abstract Message class
 
 class Message : public RefCountedObject {
@@ -277,6 +306,8 @@ protected:
 
   uint32_t magic = 0;
 
+  MessageEncodeCacheRef encode_cache;
+
   boost::intrusive::list_member_hook<> dispatch_q;
 
 public:
@@ -447,6 +478,11 @@ public:
 
   const ceph::buffer::list& get_data() const { return data; }
   ceph::buffer::list& get_data() { return data; }
+
+  /// share payload encodings with other messages attached to c
+  void set_encode_cache(MessageEncodeCacheRef c) {
+    encode_cache = std::move(c);
+  }
   void claim_data(ceph::buffer::list& bl) {
     if (byte_throttler)
       byte_throttler->put(data.length());
@@ -535,6 +571,10 @@ public:
   // virtual bits
   virtual void decode_payload() = 0;
   virtual void encode_payload(uint64_t features) = 0;
+  /// the part of features that encode_payload() depends on
+  virtual uint64_t get_encoding_key(uint64_t features) const {
+    return features;
+  }
   virtual std::string_view get_type_name() const = 0;
   virtual void print(std::ostream& out) const {
     out << get_type_name() << " magic: " << magic;
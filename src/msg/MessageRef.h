@@ -37,6 +37,7 @@ class MBackfillReserve;
 class MCacheExpire;
 class MClientCapRelease;
 class MClientCaps;
+class MClientCapsBatch;
 class MClientLease;
 class MClientQuota;
 class MClientReclaim;
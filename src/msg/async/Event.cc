@@ -151,6 +151,20 @@ int EventCenter::init(int nevent, unsigned center_id, const std::string &type)
   file_events.resize(nevent);
   this->nevent = nevent;
 
+  // dpdk polls anyway
+  if (const auto poll_us = cct->_conf->ms_async_busy_poll_us;
+      poll_us > 0 && type != "dpdk" &&
+      (cct->_conf->ms_async_busy_poll_workers == 0 ||
+       center_id < cct->_conf->ms_async_busy_poll_workers)) {
+    busy_poll_window = std::chrono::microseconds(poll_us);
+    busy_poll_budget = std::chrono::duration_cast<ceph::timespan>(
+      std::chrono::seconds(1) * cct->_conf->ms_async_busy_poll_budget);
+    busy_poll_period_start = ceph::mono_clock::now();
+    ldout(cct, 1) << __func__ << " busy polling for " << poll_us
+		  << "us after activity, budget " << busy_poll_budget
+		  << " per second" << dendl;
+  }
+
   if (!driver->need_wakeup())
     return 0;
 
@@ -389,6 +403,18 @@ int EventCenter::process_time_events()
   return processed;
 }
 
+bool EventCenter::busy_poll_allowed(ceph::mono_time now)
+{
+  if (now >= busy_poll_until) {
+    return false;
+  }
+  if (now - busy_poll_period_start >= std::chrono::seconds(1)) {
+    busy_poll_period_start = now;
+    busy_poll_spent = ceph::timespan::zero();
+  }
+  return busy_poll_spent < busy_poll_budget;
+}
+
 int EventCenter::process_events(unsigned timeout_microseconds,  ceph::timespan *working_dur)
 {
   struct timeval tv;
@@ -412,7 +438,13 @@ int EventCenter::process_events(unsigned timeout_microseconds,  ceph::timespan *
   }
 
   bool blocking = pollers.empty() && !external_num_events.load();
-  if (!blocking)
+  bool busy_polling = false;
+  ceph::mono_time poll_start;
+  if (blocking && busy_poll_window != ceph::timespan::zero()) {
+    poll_start = ceph::mono_clock::now();
+    busy_polling = busy_poll_allowed(poll_start);
+  }
+  if (!blocking || busy_polling)
     timeout_microseconds = 0;
   tv.tv_sec = timeout_microseconds / 1000000;
   tv.tv_usec = timeout_microseconds % 1000000;
@@ -421,6 +453,13 @@ int EventCenter::process_events(unsigned timeout_microseconds,  ceph::timespan *
   std::vector<FiredFileEvent> fired_events;
   numevents = driver->event_wait(fired_events, &tv);
   auto working_start = ceph::mono_clock::now();
+  if (busy_poll_window != ceph::timespan::zero()) {
+    if (numevents > 0) {
+      busy_poll_until = working_start + busy_poll_window;
+    } else if (busy_polling) {
+      busy_poll_spent += working_start - poll_start;
+    }
+  }
   for (int event_id = 0; event_id < numevents; event_id++) {
     int rfired = 0;
     FileEvent *event;
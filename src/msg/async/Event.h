@@ -180,7 +180,15 @@ class EventCenter {
   unsigned center_id;
   AssociatedCenters *global_centers = nullptr;
 
+  // adaptive busy polling, see ms_async_busy_poll_us
+  ceph::timespan busy_poll_window = ceph::timespan::zero(); ///< 0: disabled
+  ceph::timespan busy_poll_budget = ceph::timespan::zero(); ///< per period
+  ceph::mono_time busy_poll_until;        ///< poll until, if within budget
+  ceph::mono_time busy_poll_period_start;
+  ceph::timespan busy_poll_spent = ceph::timespan::zero(); ///< idle spinning
+
   int process_time_events();
+  bool busy_poll_allowed(ceph::mono_time now);
   FileEvent *_get_file_event(int fd) {
     ceph_assert(fd < nevent);
     return &file_events[fd];
@@ -21,6 +21,10 @@
 #include <errno.h>
 
 #include <algorithm>
+#include <deque>
+#if defined(__linux__)
+#include <linux/errqueue.h>
+#endif
 
 #include "PosixStack.h"
 
@@ -37,16 +41,71 @@
 #undef dout_prefix
 #define dout_prefix *_dout << "PosixStack "
 
+#if defined(__linux__) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#define CEPH_POSIX_ZEROCOPY
+#endif
+
 class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   ceph::NetHandler &handler;
   int _fd;
   entity_addr_t sa;
   bool connected;
 
+  // MSG_ZEROCOPY: the kernel keeps referencing the pages of a zero-copy
+  // send until it reports the send complete on the socket's error
+  // queue, so the sent buffers are held until then.
+  struct zerocopy_sent_t {
+    uint32_t seq;            ///< last zero-copy sendmsg() of this batch
+    ceph::buffer::list bl;
+    bool done = false;
+  };
+  uint64_t zerocopy_min;     ///< 0: zero-copy sends disabled
+  uint32_t zerocopy_next = 0; ///< seq the kernel gives the next one
+  std::deque<zerocopy_sent_t> zerocopy_pending;
+
+#ifdef CEPH_POSIX_ZEROCOPY
+  void reap_zerocopy() {
+    while (!zerocopy_pending.empty()) {
+      char control[128];
+      struct msghdr msg;
+      // FIPS zeroization audit 20191115: this memset is not security related.
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_control = control;
+      msg.msg_controllen = sizeof(control);
+      if (::recvmsg(_fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+        break;  // EAGAIN: no more completions for now
+      }
+      for (auto cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+        if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) &&
+            !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)) {
+          continue;
+        }
+        auto ee = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cm));
+        if (ee->ee_errno != 0 || ee->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+          continue;
+        }
+        // sends [ee_info, ee_data] completed; seqs wrap around
+        for (auto& p : zerocopy_pending) {
+          if ((int32_t)(p.seq - ee->ee_info) >= 0 &&
+              (int32_t)(ee->ee_data - p.seq) >= 0) {
+            p.done = true;
+          }
+        }
+      }
+      while (!zerocopy_pending.empty() && zerocopy_pending.front().done) {
+        zerocopy_pending.pop_front();
+      }
+    }
+  }
+#else
+  void reap_zerocopy() {}
+#endif
+
  public:
   explicit PosixConnectedSocketImpl(ceph::NetHandler &h, const entity_addr_t &sa,
 				    int f, bool connected)
-      : handler(h), _fd(f), sa(sa), connected(connected) {}
+      : handler(h), _fd(f), sa(sa), connected(connected),
+        zerocopy_min(h.set_zerocopy(f)) {}
 
   int is_connected() override {
     if (connected)
@@ -64,6 +123,8 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   }
 
   ssize_t read(char *buf, size_t len) override {
+    // completions raise EPOLLERR, which wakes the read handler
+    reap_zerocopy();
     #ifdef _WIN32
     ssize_t r = ::recv(_fd, buf, len, 0);
     #else
@@ -77,13 +138,20 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   // return the sent length
   // < 0 means error occurred
   #ifndef _WIN32
-  static ssize_t do_sendmsg(int fd, struct msghdr &msg, unsigned len, bool more)
+  //
+  // each call that sends something with MSG_ZEROCOPY in flags bumps
+  // *zerocopy_calls
+  static ssize_t do_sendmsg(int fd, struct msghdr &msg, unsigned len, bool more,
+                            int flags = 0, uint32_t *zerocopy_calls = nullptr)
   {
     size_t sent = 0;
     while (1) {
       MSGR_SIGPIPE_STOPPER;
       ssize_t r;
-      r = ::sendmsg(fd, &msg, MSG_NOSIGNAL | (more ? MSG_MORE : 0));
+      r = ::sendmsg(fd, &msg, MSG_NOSIGNAL | (more ? MSG_MORE : 0) | flags);
+      if (r > 0 && zerocopy_calls) {
+        ++*zerocopy_calls;
+      }
       if (r < 0) {
         int err = ceph_sock_errno();
         if (err == EINTR) {
@@ -114,7 +182,9 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   }
 
   ssize_t send(ceph::buffer::list &bl, bool more) override {
+    reap_zerocopy();
     size_t sent_bytes = 0;
+    uint32_t zerocopy_calls = 0;
     auto pb = std::cbegin(bl.buffers());
     uint64_t left_pbrs = bl.get_num_buffers();
     while (left_pbrs) {
@@ -133,9 +203,24 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
 	msglen += pb->length();
 	++pb;
       }
-      ssize_t r = do_sendmsg(_fd, msg, msglen, left_pbrs || more);
-      if (r < 0)
+      ssize_t r;
+#ifdef CEPH_POSIX_ZEROCOPY
+      if (zerocopy_min && msglen >= zerocopy_min) {
+        r = do_sendmsg(_fd, msg, msglen, left_pbrs || more,
+                       MSG_ZEROCOPY, &zerocopy_calls);
+      } else
+#endif
+      {
+        r = do_sendmsg(_fd, msg, msglen, left_pbrs || more);
+      }
+      if (r < 0) {
+        if (zerocopy_calls) {
+          // hold what went out zero-copy until the socket is gone
+          zerocopy_next += zerocopy_calls;
+          zerocopy_pending.push_back({zerocopy_next - 1, bl});
+        }
         return r;
+      }
 
       // "r" is the remaining length
       sent_bytes += r;
@@ -144,7 +229,12 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
       // only "r" == 0 continue
     }
 
-    if (sent_bytes) {
+    if (zerocopy_calls) {
+      ceph::buffer::list sent;
+      bl.splice(0, sent_bytes, &sent);
+      zerocopy_next += zerocopy_calls;
+      zerocopy_pending.push_back({zerocopy_next - 1, std::move(sent)});
+    } else if (sent_bytes) {
       ceph::buffer::list swapped;
       if (sent_bytes < bl.length()) {
         bl.splice(sent_bytes, bl.length()-sent_bytes, &swapped);
@@ -266,6 +266,7 @@ void ProtocolV2::reset_recv_state() {
   // clean read and write callbacks
   connection->pendingReadLen.reset();
   connection->writeCallback.reset();
+  release_rx_data_buffer();
 
   next_tag = static_cast<Tag>(0);
 
@@ -559,6 +560,12 @@ ssize_t ProtocolV2::write_message(Message *m, bool more) {
                  << " src=" << entity_name_t(messenger->get_myname())
                  << " off=" << header2.data_off
                  << dendl;
+  if (hold_for_coalescing(more)) {
+    ldout(cct, 20) << __func__ << " holding " << connection->outgoing_bl.length()
+                   << " bytes to coalesce with queued messages" << dendl;
+    m->put();
+    return 0;
+  }
   ssize_t total_send_size = connection->outgoing_bl.length();
   ssize_t rc = connection->_try_send(more);
   if (rc < 0) {
@@ -585,6 +592,13 @@ ssize_t ProtocolV2::write_message(Message *m, bool more) {
   return rc;
 }
 
+bool ProtocolV2::hold_for_coalescing(bool more) const {
+  // more messages are queued: gather their frames in outgoing_bl and
+  // send them together, up to ms_async_send_coalesce_bytes
+  const uint64_t limit = cct->_conf->ms_async_send_coalesce_bytes;
+  return more && limit && connection->outgoing_bl.length() < limit;
+}
+
 template <class F>
 bool ProtocolV2::append_frame(F& frame) {
   ceph::bufferlist bl;
@@ -659,7 +673,7 @@ void ProtocolV2::write_event() {
     auto start = ceph::mono_clock::now();
     bool more;
     do {
-      if (connection->is_queued()) {
+      if (connection->is_queued() && !hold_for_coalescing(!out_queue.empty())) {
 	if (r = connection->_try_send(); r!= 0) {
 	  // either fails to send or not all queued buffer is sent
 	  break;
@@ -1189,6 +1203,10 @@ CtPtr ProtocolV2::read_frame_segment() {
     return _handle_read_frame_segment();
   }
 
+  if (claim_rx_data_buffer(onwire_len)) {
+    return read_frame_segment_rxbuf();
+  }
+
   rx_buffer_t rx_buffer;
   uint16_t align = rx_frame_asm.get_segment_align(seg_idx);
   try {
@@ -1219,6 +1237,100 @@ CtPtr ProtocolV2::handle_read_frame_segment(rx_buffer_t &&rx_buffer, int r) {
   return _handle_read_frame_segment();
 }
 
+bool ProtocolV2::claim_rx_data_buffer(uint32_t onwire_len) {
+  // The tid is only known once the header segment is in, and the
+  // posted buffer must be able to take the wire bytes as they are:
+  // neither encrypted nor compressed.
+  const size_t seg_idx = rx_segments_data.size() - 1;
+  if (next_tag != Tag::MESSAGE ||
+      seg_idx != SegmentIndex::Msg::DATA ||
+      session_stream_handlers.rx ||
+      rx_frame_asm.is_compressed() ||
+      rx_segments_data[SegmentIndex::Msg::HEADER].length() <
+        sizeof(ceph_msg_header2)) {
+    return false;
+  }
+
+  // the header crc has not been checked yet, but a corrupt tid only
+  // selects the wrong buffer for a frame that is going to fault anyway
+  ceph_msg_header2 header;
+  rx_segments_data[SegmentIndex::Msg::HEADER].begin().copy(
+    sizeof(header), reinterpret_cast<char*>(&header));
+
+  ceph::bufferlist bl;
+  if (!connection->claim_rx_buffer(header.tid, bl)) {
+    return false;
+  }
+  if (bl.length() < onwire_len) {
+    ldout(cct, 20) << __func__ << " rx buffer for tid " << header.tid
+                   << " too short (" << bl.length() << " < " << onwire_len
+                   << ")" << dendl;
+    connection->release_rx_buffer();
+    return false;
+  }
+  ldout(cct, 20) << __func__ << " reading " << onwire_len
+                 << " bytes into rx buffer for tid " << header.tid << dendl;
+  rx_data_dest.substr_of(bl, 0, onwire_len);
+  rx_data_claimed = true;
+  return true;
+}
+
+void ProtocolV2::release_rx_data_buffer() {
+  if (rx_data_claimed) {
+    rx_data_dest.clear();
+    rx_data_claimed = false;
+    if (connection->release_rx_buffer() && !rx_segments_data.empty() &&
+        rx_segments_data.back().length() > 0) {
+      // revoked while we were reading into it: the owner may reuse the
+      // memory, so stop referring to it
+      auto& seg = rx_segments_data.back();
+      ldout(cct, 10) << __func__ << " rx buffer revoked, copying out "
+                     << seg.length() << " bytes" << dendl;
+      ceph::bufferptr copy(seg.length());
+      seg.begin().copy(seg.length(), copy.c_str());
+      seg.clear();
+      seg.push_back(std::move(copy));
+    }
+  }
+}
+
+CtPtr ProtocolV2::read_frame_segment_rxbuf() {
+  ceph_assert(rx_data_claimed);
+  ceph_assert(rx_data_dest.length() > 0);
+  rx_buffer_t rx_buffer;
+  if (connection->is_rx_buffer_revoked()) {
+    // read the rest of the segment into a buffer of our own
+    rx_buffer = ceph::buffer::ptr_node::create(
+      ceph::buffer::create(rx_data_dest.length()));
+    rx_data_dest.clear();
+  } else {
+    // read straight into the next posted ptr; the node shares its raw
+    auto& bp = rx_data_dest.front();
+    rx_buffer = ceph::buffer::ptr_node::create(bp);
+    rx_data_dest.splice(0, bp.length());
+  }
+  return READ_RXBUF(std::move(rx_buffer), handle_read_frame_segment_rxbuf);
+}
+
+CtPtr ProtocolV2::handle_read_frame_segment_rxbuf(rx_buffer_t &&rx_buffer,
+                                                  int r) {
+  ldout(cct, 20) << __func__ << " r=" << r << dendl;
+
+  if (r < 0) {
+    ldout(cct, 1) << __func__ << " read frame segment failed r=" << r << " ("
+                  << cpp_strerror(r) << ")" << dendl;
+    release_rx_data_buffer();
+    return _fault();
+  }
+
+  rx_segments_data.back().push_back(std::move(rx_buffer));
+  if (rx_data_dest.length() > 0) {
+    return read_frame_segment_rxbuf();
+  }
+  release_rx_data_buffer();
+  return _handle_read_frame_segment();
+}
+
 CtPtr ProtocolV2::_handle_read_frame_segment() {
   if (rx_segments_data.size() == rx_frame_asm.get_num_segments()) {
     // OK, all segments planned to read are read. Can go with epilogue.
@@ -2166,7 +2278,21 @@ CtPtr ProtocolV2::handle_compression_done(ceph::bufferlist &payload) {
   ldout(cct, 10) << __func__ << " CompressionDoneFrame(is_compress=" << response.is_compress()
 		 << ", method=" << response.method() << ")" << dendl;
 
-  comp_meta.con_method = static_cast<Compressor::CompressionAlgorithm>(response.method());
+  if (CompressorRegistry::is_dict_method(response.method())) {
+    // we offered it, but the dictionary may have changed since
+    comp_meta.con_dict =
+      messenger->comp_registry.get_dict_compressor(response.method());
+    if (!comp_meta.con_dict) {
+      ldout(cct, 1) << __func__ << " peer picked dictionary method 0x"
+		    << std::hex << response.method() << std::dec
+		    << " that we no longer have" << dendl;
+      return _fault();
+    }
+    comp_meta.con_dict_method = response.method();
+    comp_meta.con_method = Compressor::COMP_ALG_ZSTD;
+  } else {
+    comp_meta.con_method = static_cast<Compressor::CompressionAlgorithm>(response.method());
+  }
   if (comp_meta.is_compress() != response.is_compress()) {
     comp_meta.con_mode = Compressor::COMP_NONE;
   }
@@ -3009,9 +3135,12 @@ CtPtr ProtocolV2::handle_compression_request(ceph::bufferlist &payload) {
   if (Compressor::CompressionMode mode = messenger->comp_registry.get_mode(
         peer_type, auth_meta->is_mode_secure());
       mode != Compressor::COMP_NONE && request.is_compress()) {
-    comp_meta.con_method = messenger->comp_registry.pick_method(peer_type, request.preferred_methods());
+    comp_meta.con_method = messenger->comp_registry.pick_method(
+      peer_type, request.preferred_methods(),
+      &comp_meta.con_dict_method, &comp_meta.con_dict);
     ldout(cct, 10) << __func__ << " Compressor(pick_method=" 
                    << Compressor::get_comp_alg_name(comp_meta.get_method())
+                   << (comp_meta.con_dict ? " with dictionary" : "")
                    << ")" << dendl;
     if (comp_meta.con_method != Compressor::COMP_ALG_NONE) {
       comp_meta.con_mode = mode;
@@ -3020,7 +3149,7 @@ CtPtr ProtocolV2::handle_compression_request(ceph::bufferlist &payload) {
     comp_meta.con_method = Compressor::COMP_ALG_NONE;
   }
   
-  auto response = CompressionDoneFrame::Encode(comp_meta.is_compress(), comp_meta.get_method());
+  auto response = CompressionDoneFrame::Encode(comp_meta.is_compress(), comp_meta.get_wire_method());
 
   INTERCEPT(20);
   return WRITE(response, "compression done", finish_compression);
@@ -108,6 +108,9 @@ private:
   ceph::bufferlist rx_preamble;
   ceph::bufferlist rx_epilogue;
   ceph::msgr::v2::segment_bls_t rx_segments_data;
+  // remainder of the posted rx buffer the data segment is landing in
+  ceph::bufferlist rx_data_dest;
+  bool rx_data_claimed = false;
   ceph::msgr::v2::Tag next_tag;
   utime_t backoff;  // backoff time
   utime_t recv_stamp;
@@ -151,6 +154,7 @@ private:
   void prepare_send_message(uint64_t features, Message *m);
   out_queue_entry_t _get_next_outgoing();
   ssize_t write_message(Message *m, bool more);
+  bool hold_for_coalescing(bool more) const;
   void handle_message_ack(uint64_t seq);
   void reset_compression();
 
@@ -168,6 +172,7 @@ private:
   CONTINUATION_DECL(ProtocolV2, finish_auth);
   READ_BPTR_HANDLER_CONTINUATION_DECL(ProtocolV2, handle_read_frame_preamble_main);
   READ_BPTR_HANDLER_CONTINUATION_DECL(ProtocolV2, handle_read_frame_segment);
+  READ_BPTR_HANDLER_CONTINUATION_DECL(ProtocolV2, handle_read_frame_segment_rxbuf);
   READ_BPTR_HANDLER_CONTINUATION_DECL(ProtocolV2, handle_read_frame_epilogue_main);
   CONTINUATION_DECL(ProtocolV2, throttle_message);
   CONTINUATION_DECL(ProtocolV2, throttle_bytes);
@@ -181,6 +186,11 @@ private:
   Ct<ProtocolV2> *handle_read_frame_preamble_main(rx_buffer_t &&buffer, int r);
   Ct<ProtocolV2> *read_frame_segment();
   Ct<ProtocolV2> *handle_read_frame_segment(rx_buffer_t &&rx_buffer, int r);
+  bool claim_rx_data_buffer(uint32_t onwire_len);
+  void release_rx_data_buffer();
+  Ct<ProtocolV2> *read_frame_segment_rxbuf();
+  Ct<ProtocolV2> *handle_read_frame_segment_rxbuf(rx_buffer_t &&rx_buffer,
+                                                  int r);
   Ct<ProtocolV2> *_handle_read_frame_segment();
   Ct<ProtocolV2> *handle_read_frame_epilogue_main(rx_buffer_t &&buffer, int r);
   Ct<ProtocolV2> *_handle_read_frame_epilogue_main();
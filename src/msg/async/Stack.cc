@@ -43,6 +43,10 @@ std::function<void ()> NetworkStack::add_thread(Worker* w)
       ldout(cct, 10) << __func__ << " starting" << dendl;
       w->initialize();
       w->init_done();
+      // sample how busy this worker is for get_worker()
+      const ceph::timespan LoadInterval = std::chrono::seconds(1);
+      auto load_start = ceph::mono_clock::now();
+      ceph::timespan load_busy = ceph::timespan::zero();
       while (!w->done) {
         ldout(cct, 30) << __func__ << " calling event process" << dendl;
 
@@ -54,6 +58,17 @@ std::function<void ()> NetworkStack::add_thread(Worker* w)
           // TODO do something?
         }
         w->perf_logger->tinc(l_msgr_running_total_time, dur);
+
+        load_busy += dur;
+        auto now = ceph::mono_clock::now();
+        if (auto elapsed = now - load_start; elapsed >= LoadInterval) {
+          unsigned permille = std::min<uint64_t>(
+            1000, 1000 * load_busy.count() / elapsed.count());
+          // smooth over the last few intervals
+          w->busy_permille = (w->busy_permille + permille) / 2;
+          load_start = now;
+          load_busy = ceph::timespan::zero();
+        }
       }
       w->reset();
       w->destroy();
@@ -134,15 +149,21 @@ Worker* NetworkStack::get_worker()
   ldout(cct, 30) << __func__ << dendl;
 
    // start with some reasonably large number
-  unsigned min_load = std::numeric_limits<int>::max();
+  uint64_t min_load = std::numeric_limits<uint64_t>::max();
   Worker* current_best = nullptr;
+  const bool by_load = cct->_conf->ms_async_balance_by_load;
 
   pool_spin.lock();
-  // find worker with least references
+  // find worker with least references, or, when balancing by load,
+  // least references weighted by how busy the worker has been: a fully
+  // busy worker counts its connections twice.
   // tempting case is returning on references == 0, but in reality
   // this will happen so rarely that there's no need for special case.
   for (Worker* worker : workers) {
-    unsigned worker_load = worker->references.load();
+    uint64_t worker_load = worker->references.load();
+    if (by_load) {
+      worker_load = (worker_load + 1) * (1000 + worker->busy_permille.load());
+    }
     if (worker_load < min_load) {
       current_best = worker;
       min_load = worker_load;
@@ -239,6 +239,8 @@ class Worker {
   unsigned id;
 
   std::atomic_uint references;
+  /// share of recent wall time spent processing events, in 1/1000ths
+  std::atomic_uint busy_permille{0};
   EventCenter center;
 
   Worker(const Worker&) = delete;
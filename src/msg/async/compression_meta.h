@@ -8,6 +8,8 @@ struct CompConnectionMeta {
     TOPNSPC::Compressor::COMP_NONE;  // negotiated mode
   TOPNSPC::Compressor::CompressionAlgorithm con_method =
     TOPNSPC::Compressor::COMP_ALG_NONE; // negotiated method
+  uint32_t con_dict_method = 0;         // wire method, if a dictionary is used
+  TOPNSPC::CompressorRef con_dict;      // compressor primed with it
 
   bool is_compress() const {
     return con_mode != TOPNSPC::Compressor::COMP_NONE;
@@ -18,4 +20,7 @@ struct CompConnectionMeta {
   TOPNSPC::Compressor::CompressionMode get_mode() const {
     return con_mode;
   }
+  uint32_t get_wire_method() const {
+    return con_dict_method ? con_dict_method : con_method;
+  }
 };
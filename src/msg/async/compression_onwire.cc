@@ -15,7 +15,8 @@ rxtx_t rxtx_t::create_handler_pair(
     std::uint64_t compress_min_size)
 {
   if (comp_meta.is_compress()) {
-     CompressorRef compressor = Compressor::create(ctx, comp_meta.get_method());
+    CompressorRef compressor = comp_meta.con_dict ?
+      comp_meta.con_dict : Compressor::create(ctx, comp_meta.get_method());
     if (compressor) {
       return {std::make_unique<RxHandler>(ctx, compressor),
 	      std::make_unique<TxHandler>(ctx, compressor,
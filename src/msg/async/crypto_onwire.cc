@@ -19,6 +19,20 @@ static constexpr const std::size_t AESGCM_IV_LEN{12};
 static constexpr const std::size_t AESGCM_TAG_LEN{16};
 static constexpr const std::size_t AESGCM_BLOCK_LEN{16};
 
+// plaintext buffers shorter than this are gathered into runs of up to
+// AESGCM_COALESCE_MAX bytes and encrypted in place with a single
+// EVP_EncryptUpdate() call: short or misaligned updates miss the
+// stitched AES-GCM code paths and fall back to a much slower per-block
+// (or per-byte) loop.
+static constexpr const std::size_t AESGCM_COALESCE_LEN{512};
+static constexpr const std::size_t AESGCM_COALESCE_MAX{16384};
+
+// frames shorter than this are sealed back to back into shared buffers
+// of this size, so a burst of small frames (acks, heartbeats, rep op
+// replies) costs one allocation rather than one per frame.  kept small
+// as every secure connection pins the partly used buffer.
+static constexpr const std::size_t AESGCM_TX_BATCH_LEN{8192};
+
 struct nonce_t {
   ceph_le32 fixed;
   ceph_le64 counter;
@@ -38,7 +52,9 @@ using key_t = std::array<std::uint8_t, AESGCM_KEY_LEN>;
 class AES128GCM_OnWireTxHandler : public ceph::crypto::onwire::TxHandler {
   CephContext* const cct;
   std::unique_ptr<EVP_CIPHER_CTX, decltype(&::EVP_CIPHER_CTX_free)> ectx;
-  ceph::bufferlist buffer;
+  ceph::bufferptr out;     ///< ciphertext, shared by consecutive frames
+  unsigned frame_off = 0;  ///< offset of the current frame in out
+  unsigned frame_left = 0; ///< bytes of the current frame still to write
   nonce_t nonce, initial_nonce;
   bool used_initial_nonce;
   bool new_nonce_format;  // 64-bit counter?
@@ -93,8 +109,15 @@ void AES128GCM_OnWireTxHandler::reset_tx_handler(const uint32_t* first,
     throw std::runtime_error("EVP_EncryptInit_ex failed");
   }
 
-  ceph_assert(buffer.get_append_buffer_unused_tail_length() == 0);
-  buffer.reserve(std::accumulate(first, last, AESGCM_TAG_LEN));
+  ceph_assert(frame_left == 0);
+  const unsigned frame_len = std::accumulate(first, last, AESGCM_TAG_LEN);
+  if (out.unused_tail_length() < frame_len) {
+    out = ceph::buffer::create_small_page_aligned(
+      std::max<unsigned>(frame_len, AESGCM_TX_BATCH_LEN));
+    out.set_length(0);
+  }
+  frame_off = out.length();
+  frame_left = frame_len;
 
   if (!new_nonce_format) {
     // msgr2.0: 32-bit counter followed by 64-bit fixed field,
@@ -108,39 +131,65 @@ void AES128GCM_OnWireTxHandler::reset_tx_handler(const uint32_t* first,
 void AES128GCM_OnWireTxHandler::authenticated_encrypt_update(
   const ceph::bufferlist& plaintext)
 {
-  ceph_assert(buffer.get_append_buffer_unused_tail_length() >=
-              plaintext.length());
-  auto filler = buffer.append_hole(plaintext.length());
+  ceph_assert(frame_left >= plaintext.length() + AESGCM_TAG_LEN);
+  char* dst = out.end_c_str();
 
-  for (const auto& plainbuf : plaintext.buffers()) {
+  auto encrypt = [this](char* out, const char* in, unsigned len) {
     int update_len = 0;
 
     if(1 != EVP_EncryptUpdate(ectx.get(),
-	reinterpret_cast<unsigned char*>(filler.c_str()),
+	reinterpret_cast<unsigned char*>(out),
 	&update_len,
-	reinterpret_cast<const unsigned char*>(plainbuf.c_str()),
-	plainbuf.length())) {
+	reinterpret_cast<const unsigned char*>(in),
+	len)) {
       throw std::runtime_error("EVP_EncryptUpdate failed");
     }
     ceph_assert_always(update_len >= 0);
-    ceph_assert(static_cast<unsigned>(update_len) == plainbuf.length());
-    filler.advance(update_len);
+    ceph_assert(static_cast<unsigned>(update_len) == len);
+  };
+
+  // run of short buffers already copied into the output, not yet
+  // encrypted
+  char* run = dst;
+  unsigned run_len = 0;
+  for (const auto& plainbuf : plaintext.buffers()) {
+    if (plainbuf.length() < AESGCM_COALESCE_LEN) {
+      memcpy(dst, plainbuf.c_str(), plainbuf.length());
+      dst += plainbuf.length();
+      run_len += plainbuf.length();
+      if (run_len < AESGCM_COALESCE_MAX) {
+	continue;
+      }
+      encrypt(run, run, run_len);
+    } else {
+      if (run_len > 0) {
+	encrypt(run, run, run_len);
+      }
+      encrypt(dst, plainbuf.c_str(), plainbuf.length());
+      dst += plainbuf.length();
+    }
+    run = dst;
+    run_len = 0;
+  }
+  if (run_len > 0) {
+    encrypt(run, run, run_len);
   }
+  out.set_length(out.length() + plaintext.length());
+  frame_left -= plaintext.length();
 
   ldout(cct, 15) << __func__
 		 << " plaintext.length()=" << plaintext.length()
-		 << " buffer.length()=" << buffer.length()
+		 << " frame length=" << out.length() - frame_off
 		 << dendl;
 }
 
 ceph::bufferlist AES128GCM_OnWireTxHandler::authenticated_encrypt_final()
 {
   int final_len = 0;
-  ceph_assert(buffer.get_append_buffer_unused_tail_length() ==
-              AESGCM_BLOCK_LEN);
-  auto filler = buffer.append_hole(AESGCM_BLOCK_LEN);
+  ceph_assert(frame_left == AESGCM_BLOCK_LEN);
+  char* tag = out.end_c_str();
   if(1 != EVP_EncryptFinal_ex(ectx.get(),
-	reinterpret_cast<unsigned char*>(filler.c_str()),
+	reinterpret_cast<unsigned char*>(tag),
 	&final_len)) {
     throw std::runtime_error("EVP_EncryptFinal_ex failed");
   }
@@ -149,15 +198,19 @@ ceph::bufferlist AES128GCM_OnWireTxHandler::authenticated_encrypt_final()
   static_assert(AESGCM_BLOCK_LEN == AESGCM_TAG_LEN);
   if(1 != EVP_CIPHER_CTX_ctrl(ectx.get(),
 	EVP_CTRL_GCM_GET_TAG, AESGCM_TAG_LEN,
-	filler.c_str())) {
+	tag)) {
     throw std::runtime_error("EVP_CIPHER_CTX_ctrl failed");
   }
+  out.set_length(out.length() + AESGCM_TAG_LEN);
+  frame_left = 0;
 
+  ceph::bufferlist frame;
+  frame.append(ceph::bufferptr(out, frame_off, out.length() - frame_off));
   ldout(cct, 15) << __func__
-		 << " buffer.length()=" << buffer.length()
+		 << " frame.length()=" << frame.length()
 		 << " final_len=" << final_len
 		 << dendl;
-  return std::move(buffer);
+  return frame;
 }
 
 // RX PART
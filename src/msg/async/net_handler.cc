@@ -114,6 +114,17 @@ int NetHandler::set_socket_options(int sd, bool nodelay, int size)
     }
   }
 
+#ifdef SO_BUSY_POLL
+  if (int busy_poll = cct->_conf->ms_async_busy_poll_us; busy_poll > 0) {
+    r = ::setsockopt(sd, SOL_SOCKET, SO_BUSY_POLL, (SOCKOPT_VAL_TYPE)&busy_poll, sizeof(busy_poll));
+    if (r < 0) {
+      r = ceph_sock_errno();
+      ldout(cct, 5) << "couldn't set SO_BUSY_POLL to " << busy_poll << ": " << cpp_strerror(r) << dendl;
+      r = 0;  // best effort
+    }
+  }
+#endif
+
   // block ESIGPIPE
 #ifdef CEPH_USE_SO_NOSIGPIPE
   int val = 1;
@@ -126,6 +137,26 @@ int NetHandler::set_socket_options(int sd, bool nodelay, int size)
   return -r;
 }
 
+uint64_t NetHandler::set_zerocopy(int sd)
+{
+  uint64_t min_bytes = cct->_conf->ms_tcp_zerocopy_min_bytes;
+  if (!min_bytes) {
+    return 0;
+  }
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+  int flag = 1;
+  int r = ::setsockopt(sd, SOL_SOCKET, SO_ZEROCOPY, (SOCKOPT_VAL_TYPE)&flag, sizeof(flag));
+  if (r < 0) {
+    r = ceph_sock_errno();
+    ldout(cct, 5) << "couldn't set SO_ZEROCOPY: " << cpp_strerror(r) << dendl;
+    return 0;
+  }
+  return min_bytes;
+#else
+  return 0;
+#endif
+}
+
 void NetHandler::set_priority(int sd, int prio, int domain)
 {
 #ifdef SO_PRIORITY
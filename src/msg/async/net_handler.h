@@ -28,6 +28,9 @@ namespace ceph {
     explicit NetHandler(CephContext *c): cct(c) {}
     int set_nonblock(int sd);
     int set_socket_options(int sd, bool nodelay, int size);
+    /// enable MSG_ZEROCOPY on sd if configured; return the min send size
+    /// to use it for, or 0 if disabled or not supported
+    uint64_t set_zerocopy(int sd);
     int connect(const entity_addr_t &addr, const entity_addr_t& bind_addr);
     
     /**
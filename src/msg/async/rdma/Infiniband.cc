@@ -746,6 +746,61 @@ void Infiniband::MemoryManager::Chunk::reset_write_chunk()
 {
   offset = 0;
   bound = bytes;
+  zerocopy.reset();
+  zerocopy_buf = nullptr;
+}
+
+void Infiniband::MemoryManager::Chunk::set_zerocopy(RegistrationRef reg,
+                                                   const char* buf,
+                                                   uint32_t len)
+{
+  ceph_assert(len <= bytes);
+  zerocopy = std::move(reg);
+  zerocopy_buf = buf;
+  offset = len;
+}
+
+Infiniband::MemoryManager::Registration::~Registration()
+{
+  int r = ibv_dereg_mr(mr);
+  ceph_assert(r == 0);
+}
+
+Infiniband::MemoryManager::RegistrationRef
+Infiniband::MemoryManager::RegistrationCache::get(ibv_pd* pd,
+                                                  const ceph::bufferptr& bp,
+                                                  uint64_t max_bytes)
+{
+  const char* start = bp.raw_c_str();
+  std::lock_guard l{lock};
+  if (auto p = entries.find(start); p != entries.end()) {
+    lru.splice(lru.begin(), lru, p->second.lru_pos);
+    return p->second.reg;
+  }
+  // send only: the adapter just reads the pages
+  ibv_mr* mr = ibv_reg_mr(pd, const_cast<char*>(start), bp.raw_length(), 0);
+  if (!mr) {
+    return nullptr;
+  }
+  auto reg = std::make_shared<Registration>(bp, mr);
+  lru.push_front(start);
+  entries.emplace(start, entry_t{reg, lru.begin()});
+  bytes += bp.raw_length();
+  while (bytes > max_bytes && lru.size() > 1) {
+    auto p = entries.find(lru.back());
+    bytes -= p->second.reg->bp.raw_length();
+    entries.erase(p);
+    lru.pop_back();
+  }
+  return reg;
+}
+
+void Infiniband::MemoryManager::RegistrationCache::clear()
+{
+  std::lock_guard l{lock};
+  entries.clear();
+  lru.clear();
+  bytes = 0;
 }
 
 Infiniband::MemoryManager::Cluster::Cluster(MemoryManager& m, uint32_t s)
@@ -943,6 +998,13 @@ Infiniband::MemoryManager::~MemoryManager()
 {
   if (send)
     delete send;
+  reg_cache.clear();
+}
+
+Infiniband::MemoryManager::RegistrationRef
+Infiniband::MemoryManager::get_registration(const ceph::bufferptr& bp)
+{
+  return reg_cache.get(pd->pd, bp, cct->_conf->ms_async_rdma_reg_cache_size);
 }
 
 void* Infiniband::MemoryManager::huge_pages_malloc(size_t size)
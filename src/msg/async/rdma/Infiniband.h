@@ -26,9 +26,13 @@
 
 #include <atomic>
 #include <functional>
+#include <list>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "include/buffer.h"
 #include "include/common_fwd.h"
 #include "include/int_types.h"
 #include "include/page.h"
@@ -205,6 +209,40 @@ class Infiniband {
   class QueuePair;
   class MemoryManager {
    public:
+    /// a buffer registered for sending from in place; holds a
+    /// reference on the buffer so that the registered pages cannot be
+    /// freed and reused while registered
+    struct Registration {
+      ceph::bufferptr bp;
+      ibv_mr* mr;
+      Registration(const ceph::bufferptr& bp, ibv_mr* mr) : bp(bp), mr(mr) {}
+      ~Registration();
+    };
+    using RegistrationRef = std::shared_ptr<Registration>;
+
+    /**
+     * LRU of registrations of buffers posted without copying.
+     *
+     * Registering memory is expensive, so registrations are kept for
+     * reuse up to max_bytes of registered buffers.  An evicted
+     * registration is only deregistered once no posted send uses it.
+     */
+    class RegistrationCache {
+      struct entry_t {
+        RegistrationRef reg;
+        std::list<const char*>::iterator lru_pos;
+      };
+      ceph::mutex lock = ceph::make_mutex("RegistrationCache::lock");
+      std::map<const char*, entry_t> entries;  ///< by raw buffer start
+      std::list<const char*> lru;              ///< most recent first
+      uint64_t bytes = 0;
+     public:
+      /// register the whole raw buffer bp lives in, or nullptr on failure
+      RegistrationRef get(ibv_pd* pd, const ceph::bufferptr& bp,
+                          uint64_t max_bytes);
+      void clear();
+    };
+
     class Chunk {
      public:
       Chunk(ibv_mr* m, uint32_t bytes, char* buffer, uint32_t offset = 0, uint32_t bound = 0, uint32_t lkey = 0, QueuePair* qp = nullptr);
@@ -222,8 +260,14 @@ class Infiniband {
       void set_qp(QueuePair *qp) { this->qp = qp; }
       void clear_qp() { set_qp(nullptr); }
       QueuePair* get_qp() { return qp; }
+      /// tx: send offset bytes straight from buf in reg
+      void set_zerocopy(RegistrationRef reg, const char* buf, uint32_t len);
 
      public:
+      // tx only: when set, the send is posted from zerocopy_buf in
+      // this registered buffer rather than from the chunk's own memory
+      RegistrationRef zerocopy;
+      const char* zerocopy_buf = nullptr;
       ibv_mr* mr;
       QueuePair *qp;
       uint32_t lkey;
@@ -356,6 +400,7 @@ class Infiniband {
     uint32_t get_tx_buffer_size() const {
       return send->buffer_size;
     }
+    RegistrationRef get_registration(const ceph::bufferptr& bp);
 
     Chunk *get_rx_buffer() {
        std::lock_guard l{rxbuf_pool.lock};
@@ -380,6 +425,7 @@ class Infiniband {
     Cluster* send = nullptr;// SEND
     Device *device;
     ProtectionDomain *pd;
+    RegistrationCache reg_cache;
     MemPoolContext rxbuf_pool_ctx;
     mem_pool     rxbuf_pool;
 
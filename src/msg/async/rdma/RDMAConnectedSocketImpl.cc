@@ -404,6 +404,31 @@ size_t RDMAConnectedSocketImpl::tx_copy_chunk(std::vector<Chunk*> &tx_buffers,
   return write_len;
 }
 
+size_t RDMAConnectedSocketImpl::tx_zerocopy(std::vector<Chunk*> &tx_buffers,
+    const ceph::bufferptr& bp,
+    const Infiniband::MemoryManager::RegistrationRef& reg)
+{
+  // a send may not exceed the peer's receive buffers, which are as
+  // large as our tx chunks, and the chunk pool bounds the sends in
+  // flight: so post bp in chunk sized pieces, each taking a chunk
+  // that lends it the work request but not its memory
+  auto chunk_idx = tx_buffers.size();
+  if (0 == worker->get_reged_mem(this, tx_buffers, bp.length())) {
+    ldout(cct, 1) << __func__ << " no enough buffers in worker " << worker << dendl;
+    worker->perf_logger->inc(l_msgr_rdma_tx_no_mem);
+    return 0;
+  }
+
+  const size_t max_len = ib->get_memory_manager()->get_tx_buffer_size();
+  size_t posted = 0;
+  for (; chunk_idx < tx_buffers.size(); ++chunk_idx) {
+    size_t len = std::min(max_len, bp.length() - posted);
+    tx_buffers[chunk_idx]->set_zerocopy(reg, bp.c_str() + posted, len);
+    posted += len;
+  }
+  return posted;
+}
+
 ssize_t RDMAConnectedSocketImpl::submit(bool more)
 {
   if (error)
@@ -419,8 +444,26 @@ ssize_t RDMAConnectedSocketImpl::submit(bool more)
   auto it = std::cbegin(pending_bl.buffers());
   auto copy_start = it;
   size_t total_copied = 0, wait_copy_len = 0;
+  const uint64_t zerocopy_min = cct->_conf->ms_async_rdma_zerocopy_min;
+  Infiniband::MemoryManager::RegistrationRef reg;
   while (it != pending_bl.buffers().end()) {
-    if (ib->is_tx_buffer(it->raw_c_str())) {
+    if (zerocopy_min && it->length() >= zerocopy_min &&
+        !ib->is_tx_buffer(it->raw_c_str()) &&
+        (reg = ib->get_memory_manager()->get_registration(*it))) {
+      if (wait_copy_len) {
+        size_t copied = tx_copy_chunk(tx_buffers, wait_copy_len, copy_start, it);
+        total_copied += copied;
+        if (copied < wait_copy_len)
+          goto sending;
+        wait_copy_len = 0;
+      }
+      ceph_assert(copy_start == it);
+      size_t posted = tx_zerocopy(tx_buffers, *it, reg);
+      total_copied += posted;
+      if (posted < it->length())
+        goto sending;
+      ++copy_start;
+    } else if (ib->is_tx_buffer(it->raw_c_str())) {
       if (wait_copy_len) {
         size_t copied = tx_copy_chunk(tx_buffers, wait_copy_len, copy_start, it);
         total_copied += copied;
@@ -480,9 +523,14 @@ int RDMAConnectedSocketImpl::post_work_request(std::vector<Chunk*> &tx_buffers)
   memset(isge, 0, sizeof(isge));
  
   while (current_buffer != tx_buffers.end()) {
-    isge[current_sge].addr = reinterpret_cast<uint64_t>((*current_buffer)->buffer);
+    if ((*current_buffer)->zerocopy) {
+      isge[current_sge].addr = reinterpret_cast<uint64_t>((*current_buffer)->zerocopy_buf);
+      isge[current_sge].lkey = (*current_buffer)->zerocopy->mr->lkey;
+    } else {
+      isge[current_sge].addr = reinterpret_cast<uint64_t>((*current_buffer)->buffer);
+      isge[current_sge].lkey = (*current_buffer)->mr->lkey;
+    }
     isge[current_sge].length = (*current_buffer)->get_offset();
-    isge[current_sge].lkey = (*current_buffer)->mr->lkey;
     ldout(cct, 25) << __func__ << " sending buffer: " << *current_buffer << " length: " << isge[current_sge].length  << dendl;
 
     iswr[current_swr].wr_id = reinterpret_cast<uint64_t>(*current_buffer);
@@ -203,6 +203,9 @@ class RDMAConnectedSocketImpl : public ConnectedSocketImpl {
   size_t tx_copy_chunk(std::vector<Chunk*> &tx_buffers, size_t req_copy_len,
       decltype(std::cbegin(pending_bl.buffers()))& start,
       const decltype(std::cbegin(pending_bl.buffers()))& end);
+  size_t tx_zerocopy(std::vector<Chunk*> &tx_buffers,
+      const ceph::bufferptr& bp,
+      const Infiniband::MemoryManager::RegistrationRef& reg);
 
  public:
   RDMAConnectedSocketImpl(CephContext *cct, std::shared_ptr<Infiniband>& ib,
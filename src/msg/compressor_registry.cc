@@ -3,6 +3,7 @@
 
 #include "compressor_registry.h"
 #include "common/dout.h"
+#include "include/crc32c.h"
 
 #define dout_subsys ceph_subsys_ms
 #undef dout_prefix
@@ -26,6 +27,7 @@ const char** CompressorRegistry::get_tracked_conf_keys() const
     "ms_osd_compression_algorithm",
     "ms_osd_compress_min_size",
     "ms_compress_secure",
+    "ms_osd_compression_dictionary",
     nullptr
   };
   return keys;
@@ -62,6 +64,50 @@ std::vector<uint32_t> CompressorRegistry::_parse_method_list(const std::string&
   return methods;
 }
 
+void CompressorRegistry::_load_dictionary(const std::string& path)
+{
+  ceph::bufferlist bl;
+  std::string err;
+  if (int r = bl.read_file(path.c_str(), &err); r < 0) {
+    lderr(cct) << __func__ << " unable to read compression dictionary "
+	       << path << ": " << err << dendl;
+    return;
+  }
+  auto zstd = Compressor::create(cct, Compressor::COMP_ALG_ZSTD);
+  auto dict = zstd ? zstd->with_dictionary(bl) : nullptr;
+  if (!dict || bl.length() == 0) {
+    lderr(cct) << __func__ << " unable to use " << path
+	       << " as a zstd dictionary" << dendl;
+    return;
+  }
+  ms_osd_compression_dict = dict;
+  ms_osd_compression_dict_method =
+    DICT_METHOD_FLAG |
+    ((ceph_crc32c(0, (const unsigned char*)bl.c_str(), bl.length()) << 8) &
+     ~DICT_METHOD_FLAG) |
+    Compressor::COMP_ALG_ZSTD;
+  ldout(cct, 1) << __func__ << " loaded " << bl.length()
+		<< " byte dictionary " << path << " as method 0x" << std::hex
+		<< ms_osd_compression_dict_method << std::dec << dendl;
+}
+
+std::vector<uint32_t> CompressorRegistry::_with_dict_method(
+  const std::vector<uint32_t>& methods) const
+{
+  if (!ms_osd_compression_dict_method) {
+    return methods;
+  }
+  std::vector<uint32_t> out;
+  out.reserve(methods.size() + 1);
+  for (auto m : methods) {
+    if (m == Compressor::COMP_ALG_ZSTD) {
+      out.push_back(ms_osd_compression_dict_method);
+    }
+    out.push_back(m);
+  }
+  return out;
+}
+
 void CompressorRegistry::_refresh_config()
 {
   auto c_mode = Compressor::get_comp_mode_type(cct->_conf.get_val<std::string>("ms_osd_compress_mode"));
@@ -80,6 +126,16 @@ void CompressorRegistry::_refresh_config()
 
   ms_compress_secure = cct->_conf.get_val<bool>("ms_compress_secure");
 
+  if (auto path = cct->_conf.get_val<std::string>("ms_osd_compression_dictionary");
+      path != ms_osd_compression_dict_path) {
+    ms_osd_compression_dict_path = path;
+    ms_osd_compression_dict.reset();
+    ms_osd_compression_dict_method = 0;
+    if (!path.empty()) {
+      _load_dictionary(path);
+    }
+  }
+
   ldout(cct,10) << __func__ << " ms_osd_compression_mode " << ms_osd_compress_mode
     << " ms_osd_compression_methods " << ms_osd_compression_methods
     << " ms_osd_compress_above_min_size " << ms_osd_compress_min_size
@@ -89,9 +145,18 @@ void CompressorRegistry::_refresh_config()
 
 Compressor::CompressionAlgorithm
 CompressorRegistry::pick_method(uint32_t peer_type,
-                                const std::vector<uint32_t>& preferred_methods)
+                                const std::vector<uint32_t>& preferred_methods,
+                                uint32_t *dict_method,
+                                CompressorRef *dict)
 {
-  std::vector<uint32_t> allowed_methods = get_methods(peer_type);
+  std::scoped_lock l(lock);
+  std::vector<uint32_t> allowed_methods;
+  if (peer_type == CEPH_ENTITY_TYPE_OSD) {
+    // only offer the dictionary to callers that can take it
+    allowed_methods = (dict_method && dict) ?
+      _with_dict_method(ms_osd_compression_methods) :
+      ms_osd_compression_methods;
+  }
   auto preferred = std::find_first_of(preferred_methods.begin(),
                                       preferred_methods.end(),
                                       allowed_methods.begin(),
@@ -101,6 +166,10 @@ CompressorRegistry::pick_method(uint32_t peer_type,
                  << preferred_methods
                  << " and our " << allowed_methods << dendl;
     return Compressor::COMP_ALG_NONE;
+  } else if (is_dict_method(*preferred)) {
+    *dict_method = *preferred;
+    *dict = ms_osd_compression_dict;
+    return Compressor::COMP_ALG_ZSTD;
   } else {
     return static_cast<Compressor::CompressionAlgorithm>(*preferred);
   }
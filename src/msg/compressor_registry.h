@@ -25,8 +25,33 @@ public:
   void handle_conf_change(const ConfigProxy& conf,
                           const std::set<std::string>& changed) override;
 
+  /// wire methods with this bit set stand for zstd primed with the
+  /// dictionary whose checksum makes up the other bits.  Peers that do
+  /// not know them skip them.
+  static constexpr uint32_t DICT_METHOD_FLAG = 0x80000000u;
+  static bool is_dict_method(uint32_t method) {
+    return method & DICT_METHOD_FLAG;
+  }
+
+  /**
+   * pick the first of the peer's preferred methods that we allow
+   *
+   * If that is our dictionary method, COMP_ALG_ZSTD is returned and the
+   * wire method and the primed compressor go to *dict_method and *dict.
+   */
   TOPNSPC::Compressor::CompressionAlgorithm pick_method(uint32_t peer_type,
-					       const std::vector<uint32_t>& preferred_methods);
+					       const std::vector<uint32_t>& preferred_methods,
+					       uint32_t *dict_method = nullptr,
+					       TOPNSPC::CompressorRef *dict = nullptr);
+
+  /// our compressor for a dictionary wire method, nullptr if we have none
+  TOPNSPC::CompressorRef get_dict_compressor(uint32_t dict_method) const {
+    std::scoped_lock l(lock);
+    if (dict_method && dict_method == ms_osd_compression_dict_method) {
+      return ms_osd_compression_dict;
+    }
+    return nullptr;
+  }
 
   TOPNSPC::Compressor::CompressionMode get_mode(uint32_t peer_type, bool is_secure);
 
@@ -34,7 +59,7 @@ public:
     std::scoped_lock l(lock);
     switch (peer_type) {
       case CEPH_ENTITY_TYPE_OSD:
-        return ms_osd_compression_methods;
+        return _with_dict_method(ms_osd_compression_methods);
       default:
         return {};
     }
@@ -63,7 +88,14 @@ private:
   bool ms_compress_secure;
   std::uint64_t ms_osd_compress_min_size;
   std::vector<uint32_t> ms_osd_compression_methods;
+  std::string ms_osd_compression_dict_path;
+  TOPNSPC::CompressorRef ms_osd_compression_dict;
+  uint32_t ms_osd_compression_dict_method = 0;
 
   void _refresh_config();
   std::vector<uint32_t> _parse_method_list(const std::string& s);
+  void _load_dictionary(const std::string& path);
+  /// methods with our dictionary method offered just ahead of zstd
+  std::vector<uint32_t> _with_dict_method(
+    const std::vector<uint32_t>& methods) const;
 };
@@ -14,6 +14,7 @@
 
 #define BOOST_BIND_NO_PLACEHOLDERS
 
+#include <atomic>
 #include <optional>
 #include <string_view>
 
@@ -959,6 +960,87 @@ void RADOS::execute_(Object o, IOContext _ioc, WriteOp _op,
   trace.event("submitted");
 }
 
+namespace {
+// Gathers the results of the ops of a batch, and completes it with the
+// last of them
+struct BatchState {
+  std::vector<bs::error_code> ecs;
+  std::atomic<std::size_t> pending;
+  RADOS::BatchComp c;
+
+  BatchState(std::size_t n, RADOS::BatchComp c)
+    : ecs(n), pending(n), c(std::move(c)) {}
+
+  static Objecter::Op::OpComp op_comp(std::shared_ptr<BatchState> s,
+				      std::size_t i) {
+    return [s = std::move(s), i](bs::error_code ec) mutable {
+      s->ecs[i] = ec;
+      s->put();
+    };
+  }
+
+  void put() {
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+    bs::error_code ec;
+    for (const auto& e : ecs) {
+      if (e) {
+	ec = e;
+	break;
+      }
+    }
+    asio::dispatch(asio::append(std::move(c), ec, std::move(ecs)));
+  }
+};
+}
+
+void RADOS::execute_(IOContext _ioc,
+		     std::vector<std::pair<Object, ReadOp>> ops,
+		     BatchComp c) {
+  auto ioc = reinterpret_cast<const IOContextImpl*>(&_ioc.impl);
+  // one ref for the loop, so that we complete after it at the earliest
+  auto state = std::make_shared<BatchState>(ops.size() + 1, std::move(c));
+  std::vector<Objecter::Op*> todo;
+  todo.reserve(ops.size());
+  for (std::size_t i = 0; i < ops.size(); ++i) {
+    auto oid = reinterpret_cast<const object_t*>(&ops[i].first.impl);
+    auto op = reinterpret_cast<OpImpl*>(&ops[i].second.impl);
+    if (op->op.size() == 0) {
+      state->put();
+      continue;
+    }
+    todo.push_back(impl->objecter->prepare_read_op(
+      *oid, ioc->oloc, std::move(op->op), ioc->snap_seq, nullptr,
+      op->op.flags | ioc->extra_op_flags, BatchState::op_comp(state, i)));
+  }
+  impl->objecter->op_submit(todo);
+  state->put();
+}
+
+void RADOS::execute_(IOContext _ioc,
+		     std::vector<std::pair<Object, WriteOp>> ops,
+		     BatchComp c) {
+  auto ioc = reinterpret_cast<const IOContextImpl*>(&_ioc.impl);
+  auto state = std::make_shared<BatchState>(ops.size() + 1, std::move(c));
+  std::vector<Objecter::Op*> todo;
+  todo.reserve(ops.size());
+  auto now = ceph::real_clock::now();
+  for (std::size_t i = 0; i < ops.size(); ++i) {
+    auto oid = reinterpret_cast<const object_t*>(&ops[i].first.impl);
+    auto op = reinterpret_cast<OpImpl*>(&ops[i].second.impl);
+    if (op->op.size() == 0) {
+      state->put();
+      continue;
+    }
+    todo.push_back(impl->objecter->prepare_mutate_op(
+      *oid, ioc->oloc, std::move(op->op), ioc->snapc, op->mtime.value_or(now),
+      op->op.flags | ioc->extra_op_flags, BatchState::op_comp(state, i)));
+  }
+  impl->objecter->op_submit(todo);
+  state->put();
+}
+
 boost::uuids::uuid RADOS::get_fsid() const noexcept {
   return impl->monclient.get_fsid().uuid;
 }
@@ -491,6 +491,36 @@ public:
      ceph::buffer::list& bl,
      uint32_t op_flags = 0) = 0;
 
+  /**
+   * scrub_read -- read a byte range of data for deep scrub
+   *
+   * Like read(), but only returns the crc32c of the data.  Stores that
+   * verify their own checksums on read may derive the result from those
+   * instead of hashing the data again.
+   *
+   * @param cid collection for object
+   * @param oid oid of object
+   * @param offset location offset of first byte to be read
+   * @param len number of bytes to be read
+   * @param crc [in,out] crc32c seed, updated with the data read
+   * @param op_flags is CEPH_OSD_OP_FLAG_*
+   * @returns number of bytes read on success, or negative error code on failure.
+   */
+  virtual int scrub_read(
+    CollectionHandle &c,
+    const ghobject_t& oid,
+    uint64_t offset,
+    size_t len,
+    uint32_t *crc,
+    uint32_t op_flags = 0) {
+    ceph::buffer::list bl;
+    int r = read(c, oid, offset, len, bl, op_flags);
+    if (r > 0) {
+      *crc = bl.crc32c(*crc);
+    }
+    return r;
+  }
+
   /**
    * fiemap -- get extent std::map of data of an object
    *
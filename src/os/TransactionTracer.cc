@@ -0,0 +1,391 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "TransactionTracer.h"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "common/debug.h"
+#include "common/errno.h"
+#include "common/Formatter.h"
+
+#define dout_context cct
+#define dout_subsys ceph_subsys_osd
+#undef dout_prefix
+#define dout_prefix *_dout << "txn_tracer "
+
+using ceph::bufferlist;
+using ceph::decode;
+using ceph::encode;
+
+// stop buffering and write out every 4MB of events
+static constexpr uint64_t flush_bytes = 4 << 20;
+
+void TransactionTracer::event_t::encode(bufferlist& bl) const
+{
+  ENCODE_START(1, 1, bl);
+  encode(type, bl);
+  encode(stamp_ns, bl);
+  encode(cid, bl);
+  encode(oid, bl);
+  encode(off, bl);
+  encode(len, bl);
+  encode(elided, bl);
+  encode(txn, bl);
+  ENCODE_FINISH(bl);
+}
+
+void TransactionTracer::event_t::decode(bufferlist::const_iterator& p)
+{
+  DECODE_START(1, p);
+  decode(type, p);
+  decode(stamp_ns, p);
+  decode(cid, p);
+  decode(oid, p);
+  decode(off, p);
+  decode(len, p);
+  decode(elided, p);
+  decode(txn, p);
+  DECODE_FINISH(p);
+}
+
+TransactionTracer::Transaction TransactionTracer::event_t::restore() const
+{
+  Transaction t;
+  auto p = txn.cbegin();
+  t.decode(p);
+  if (elided.empty()) {
+    return t;
+  }
+  Transaction out;
+  bool ok = rebuild(t, out, [this](uint32_t i, uint32_t op) {
+    return op == Transaction::OP_ZERO &&
+      std::binary_search(elided.begin(), elided.end(), i);
+  });
+  // we only elide transactions we could rebuild in the first place
+  ceph_assert(ok);
+  return out;
+}
+
+int TransactionTracer::decode_header(bufferlist::const_iterator& p)
+{
+  std::string m;
+  try {
+    decode(m, p);
+  } catch (ceph::buffer::error&) {
+    return -EINVAL;
+  }
+  return m == magic ? 0 : -EINVAL;
+}
+
+bool TransactionTracer::rebuild(
+  Transaction& in, Transaction& out,
+  const std::function<bool(uint32_t, uint32_t)>& swap)
+{
+  out.set_fadvise_flags(in.get_fadvise_flags());
+  auto i = in.begin();
+  for (uint32_t n = 0; i.have_op(); ++n) {
+    auto op = i.decode_op();
+    switch (op->op) {
+    case Transaction::OP_NOP:
+      out.nop();
+      break;
+    case Transaction::OP_CREATE:
+      out.create(i.get_cid(op->cid), i.get_oid(op->oid));
+      break;
+    case Transaction::OP_TOUCH:
+      out.touch(i.get_cid(op->cid), i.get_oid(op->oid));
+      break;
+    case Transaction::OP_WRITE:
+      {
+	bufferlist bl;
+	i.decode_bl(bl);
+	if (swap(n, op->op)) {
+	  out.zero(i.get_cid(op->cid), i.get_oid(op->oid), op->off, op->len);
+	} else {
+	  out.write(i.get_cid(op->cid), i.get_oid(op->oid), op->off, op->len,
+		    bl);
+	}
+      }
+      break;
+    case Transaction::OP_ZERO:
+      if (swap(n, op->op)) {
+	bufferlist bl;
+	bl.append_zero(op->len);
+	out.write(i.get_cid(op->cid), i.get_oid(op->oid), op->off, op->len,
+		  bl);
+      } else {
+	out.zero(i.get_cid(op->cid), i.get_oid(op->oid), op->off, op->len);
+      }
+      break;
+    case Transaction::OP_TRUNCATE:
+      out.truncate(i.get_cid(op->cid), i.get_oid(op->oid), op->off);
+      break;
+    case Transaction::OP_REMOVE:
+      out.remove(i.get_cid(op->cid), i.get_oid(op->oid));
+      break;
+    case Transaction::OP_SETATTR:
+      {
+	std::string name = i.decode_string();
+	bufferlist bl;
+	i.decode_bl(bl);
+	out.setattr(i.get_cid(op->cid), i.get_oid(op->oid), name, bl);
+      }
+      break;
+    case Transaction::OP_SETATTRS:
+      {
+	std::map<std::string, bufferlist> aset;
+	i.decode_attrset(aset);
+	out.setattrs(i.get_cid(op->cid), i.get_oid(op->oid),
+		     std::map<std::string, bufferlist, std::less<>>(
+		       aset.begin(), aset.end()));
+      }
+      break;
+    case Transaction::OP_RMATTR:
+      out.rmattr(i.get_cid(op->cid), i.get_oid(op->oid), i.decode_string());
+      break;
+    case Transaction::OP_RMATTRS:
+      out.rmattrs(i.get_cid(op->cid), i.get_oid(op->oid));
+      break;
+    case Transaction::OP_CLONE:
+      out.clone(i.get_cid(op->cid), i.get_oid(op->oid),
+		i.get_oid(op->dest_oid));
+      break;
+    case Transaction::OP_CLONERANGE2:
+      out.clone_range(i.get_cid(op->cid), i.get_oid(op->oid),
+		      i.get_oid(op->dest_oid), op->off, op->len, op->dest_off);
+      break;
+    case Transaction::OP_MKCOLL:
+      out.create_collection(i.get_cid(op->cid), op->split_bits);
+      break;
+    case Transaction::OP_COLL_HINT:
+      {
+	bufferlist hint;
+	i.decode_bl(hint);
+	out.collection_hint(i.get_cid(op->cid), op->hint, hint);
+      }
+      break;
+    case Transaction::OP_RMCOLL:
+      out.remove_collection(i.get_cid(op->cid));
+      break;
+    case Transaction::OP_COLL_SET_BITS:
+      out.collection_set_bits(i.get_cid(op->cid), op->split_bits);
+      break;
+    case Transaction::OP_COLL_MOVE_RENAME:
+      out.collection_move_rename(i.get_cid(op->cid), i.get_oid(op->oid),
+				 i.get_cid(op->dest_cid),
+				 i.get_oid(op->dest_oid));
+      break;
+    case Transaction::OP_TRY_RENAME:
+      out.try_rename(i.get_cid(op->cid), i.get_oid(op->oid),
+		     i.get_oid(op->dest_oid));
+      break;
+    case Transaction::OP_OMAP_CLEAR:
+      out.omap_clear(i.get_cid(op->cid), i.get_oid(op->oid));
+      break;
+    case Transaction::OP_OMAP_SETKEYS:
+      {
+	bufferlist bl;
+	i.decode_attrset_bl(&bl);
+	out.omap_setkeys(i.get_cid(op->cid), i.get_oid(op->oid), bl);
+      }
+      break;
+    case Transaction::OP_OMAP_RMKEYS:
+      {
+	bufferlist bl;
+	i.decode_keyset_bl(&bl);
+	out.omap_rmkeys(i.get_cid(op->cid), i.get_oid(op->oid), bl);
+      }
+      break;
+    case Transaction::OP_OMAP_RMKEYRANGE:
+      {
+	std::string first = i.decode_string();
+	std::string last = i.decode_string();
+	out.omap_rmkeyrange(i.get_cid(op->cid), i.get_oid(op->oid),
+			    first, last);
+      }
+      break;
+    case Transaction::OP_OMAP_SETHEADER:
+      {
+	bufferlist bl;
+	i.decode_bl(bl);
+	out.omap_setheader(i.get_cid(op->cid), i.get_oid(op->oid), bl);
+      }
+      break;
+    case Transaction::OP_SPLIT_COLLECTION2:
+      out.split_collection(i.get_cid(op->cid), op->split_bits, op->split_rem,
+			   i.get_cid(op->dest_cid));
+      break;
+    case Transaction::OP_MERGE_COLLECTION:
+      out.merge_collection(i.get_cid(op->cid), i.get_cid(op->dest_cid),
+			   op->split_bits);
+      break;
+    case Transaction::OP_SETALLOCHINT:
+      out.set_alloc_hint(i.get_cid(op->cid), i.get_oid(op->oid),
+			 op->expected_object_size, op->expected_write_size,
+			 op->hint);
+      break;
+    default:
+      // legacy ops the OSD no longer sends
+      return false;
+    }
+  }
+  return true;
+}
+
+TransactionTracer::~TransactionTracer()
+{
+  stop();
+}
+
+int TransactionTracer::start(const std::string& p, uint32_t s, bool elide,
+			     uint64_t max, std::ostream& ss)
+{
+  std::lock_guard l{lock};
+  if (fd >= 0) {
+    ss << "already tracing to " << path;
+    return -EBUSY;
+  }
+  int r = ::open(p.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (r < 0) {
+    r = -errno;
+    ss << "failed to open " << p << ": " << cpp_strerror(r);
+    return r;
+  }
+  fd = r;
+  path = p;
+  sample = std::max<uint32_t>(s, 1);
+  elide_data = elide;
+  max_bytes = max;
+  start_time = ceph::mono_clock::now();
+  written = 0;
+  events = 0;
+  pending.clear();
+  encode(std::string(magic), pending);
+  active = true;
+  dout(1) << "tracing to " << path << " sample 1/" << sample
+	  << (elide_data ? ", data elided" : "") << dendl;
+  return 0;
+}
+
+void TransactionTracer::stop()
+{
+  std::lock_guard l{lock};
+  _close();
+}
+
+void TransactionTracer::_close()
+{
+  if (fd < 0) {
+    return;
+  }
+  active = false;
+  _flush();
+  ::close(fd);
+  fd = -1;
+  dout(1) << "traced " << events << " events, " << written << " bytes to "
+	  << path << dendl;
+}
+
+void TransactionTracer::_flush()
+{
+  if (pending.length()) {
+    written += pending.length();
+    int r = pending.write_fd(fd);
+    pending.clear();
+    if (r < 0) {
+      derr << "failed to write " << path << ": " << cpp_strerror(r)
+	   << ", stopping" << dendl;
+      active = false;
+    }
+  }
+}
+
+void TransactionTracer::dump(ceph::Formatter *f) const
+{
+  std::lock_guard l{lock};
+  f->dump_bool("active", fd >= 0);
+  if (fd >= 0) {
+    f->dump_string("path", path);
+    f->dump_unsigned("sample", sample);
+    f->dump_bool("elide_data", elide_data);
+    f->dump_unsigned("max_bytes", max_bytes);
+    f->dump_unsigned("events", events);
+    f->dump_unsigned("bytes", written + pending.length());
+  }
+}
+
+bool TransactionTracer::sampled(const coll_t& cid) const
+{
+  return sample == 1 ||
+    std::hash<std::string>{}(cid.to_str()) % sample == 0;
+}
+
+void TransactionTracer::_append(event_t& e)
+{
+  e.stamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    ceph::mono_clock::now() - start_time).count();
+  encode(e, pending);
+  ++events;
+  if (max_bytes && written + pending.length() >= max_bytes) {
+    _close();
+  } else if (pending.length() >= flush_bytes) {
+    _flush();
+  }
+}
+
+void TransactionTracer::_trace_transactions(const coll_t& cid,
+					    std::vector<Transaction>& tls)
+{
+  if (!sampled(cid)) {
+    return;
+  }
+  std::lock_guard l{lock};
+  if (fd < 0) {
+    return;
+  }
+  for (auto& t : tls) {
+    event_t e;
+    e.type = event_t::TRANSACTION;
+    e.cid = cid;
+    Transaction elided;
+    if (elide_data &&
+	rebuild(t, elided, [&e](uint32_t i, uint32_t op) {
+	  if (op == Transaction::OP_WRITE) {
+	    e.elided.push_back(i);
+	    return true;
+	  }
+	  return false;
+	})) {
+      elided.encode(e.txn);
+    } else {
+      e.elided.clear();
+      t.encode(e.txn);
+    }
+    _append(e);
+    if (fd < 0) {
+      break;
+    }
+  }
+}
+
+void TransactionTracer::_trace_read(const coll_t& cid, const ghobject_t& oid,
+				    uint64_t off, uint64_t len)
+{
+  if (!sampled(cid)) {
+    return;
+  }
+  std::lock_guard l{lock};
+  if (fd < 0) {
+    return;
+  }
+  event_t e;
+  e.type = event_t::READ;
+  e.cid = cid;
+  e.oid = oid;
+  e.off = off;
+  e.len = len;
+  _append(e);
+}
@@ -0,0 +1,109 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "common/ceph_mutex.h"
+#include "include/encoding.h"
+#include "os/Transaction.h"
+#include "osd/osd_types.h"
+
+/**
+ * Records the transactions and reads an OSD issues to its ObjectStore,
+ * so that they can be replayed against a test store later.
+ *
+ * The trace is a header followed by encoded events.  PGs are sampled as a
+ * whole, so that the trace of every PG it has is consistent.  With data
+ * elided, writes are recorded as zeros of the same extent, and turned
+ * back into writes (of zeros) by restore().
+ *
+ * When not tracing, the hooks cost a relaxed atomic load.
+ */
+class TransactionTracer {
+public:
+  using Transaction = ceph::os::Transaction;
+
+  struct event_t {
+    enum : uint8_t {
+      TRANSACTION = 1,
+      READ = 2,
+    };
+    uint8_t type = 0;
+    uint64_t stamp_ns = 0;  ///< since the start of the trace
+    coll_t cid;
+    ghobject_t oid;         ///< READ only
+    uint64_t off = 0;       ///< READ only
+    uint64_t len = 0;       ///< READ only
+    std::vector<uint32_t> elided;  ///< ops that were writes
+    ceph::buffer::list txn;        ///< encoded Transaction
+
+    void encode(ceph::buffer::list& bl) const;
+    void decode(ceph::buffer::list::const_iterator& p);
+
+    /// the transaction as the OSD queued it, with elided data as zeros
+    Transaction restore() const;
+  };
+
+  static constexpr const char *magic = "ceph transaction trace v1";
+  /// check the header, leave p at the first event
+  static int decode_header(ceph::buffer::list::const_iterator& p);
+
+  explicit TransactionTracer(CephContext *cct) : cct(cct) {}
+  ~TransactionTracer();
+
+  /// trace to path one in every sample PGs, at most max_bytes of it
+  int start(const std::string& path, uint32_t sample, bool elide_data,
+	    uint64_t max_bytes, std::ostream& ss);
+  void stop();
+  void dump(ceph::Formatter *f) const;
+
+  bool is_active() const {
+    return active.load(std::memory_order_relaxed);
+  }
+  void trace_transactions(const coll_t& cid, std::vector<Transaction>& tls) {
+    if (is_active()) {
+      _trace_transactions(cid, tls);
+    }
+  }
+  void trace_read(const coll_t& cid, const ghobject_t& oid,
+		  uint64_t off, uint64_t len) {
+    if (is_active()) {
+      _trace_read(cid, oid, off, len);
+    }
+  }
+
+  /// copy the ops of in to out; the ops for which swap(index, op) is
+  /// true go from writes to zeros of the same extent, or the reverse.
+  /// false if in holds an op we cannot copy
+  static bool rebuild(Transaction& in, Transaction& out,
+		      const std::function<bool(uint32_t, uint32_t)>& swap);
+
+private:
+  CephContext *cct;
+  std::atomic<bool> active{false};
+
+  mutable ceph::mutex lock = ceph::make_mutex("TransactionTracer::lock");
+  std::string path;
+  int fd = -1;
+  uint32_t sample = 1;
+  bool elide_data = false;
+  uint64_t max_bytes = 0;
+  ceph::mono_time start_time;
+  ceph::buffer::list pending;
+  uint64_t written = 0;
+  uint64_t events = 0;
+
+  bool sampled(const coll_t& cid) const;
+  void _trace_transactions(const coll_t& cid, std::vector<Transaction>& tls);
+  void _trace_read(const coll_t& cid, const ghobject_t& oid,
+		   uint64_t off, uint64_t len);
+  void _append(event_t& e);
+  void _flush();
+  void _close();
+};
+WRITE_CLASS_ENCODER(TransactionTracer::event_t)
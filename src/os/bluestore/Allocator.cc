@@ -10,6 +10,8 @@
 #include "HybridAllocator.h"
 #include "common/debug.h"
 #include "common/admin_socket.h"
+#include "common/ceph_mutex.h"
+#include "common/errno.h"
 #define dout_subsys ceph_subsys_bluestore
 using TOPNSPC::common::cmd_getval;
 
@@ -57,6 +59,13 @@ public:
 	  this,
 	  "build allocator free regions state histogram");
         ceph_assert(r == 0);
+        r = admin_socket->register_command(
+	  ("bluestore allocator trace " + name +
+           " name=action,type=CephChoice,strings=start|stop" +
+           " name=path,type=CephString,req=false").c_str(),
+	  this,
+	  "trace allocations and releases to path, for allocator_replay_test");
+        ceph_assert(r == 0);
       }
     }
   }
@@ -138,6 +147,18 @@ public:
         f->close_section();
       }
       f->close_section();
+    } else if (command == "bluestore allocator trace " + name) {
+      std::string action, path;
+      cmd_getval(cmdmap, "action", action);
+      if (action == "start") {
+        if (!cmd_getval(cmdmap, "path", path)) {
+          ss << "path is required to start tracing";
+          return -EINVAL;
+        }
+        r = alloc->start_trace(path, ss);
+      } else {
+        alloc->stop_trace();
+      }
     } else {
       ss << "Invalid command" << std::endl;
       r = -ENOSYS;
@@ -146,6 +167,22 @@ public:
   }
 
 };
+
+struct Allocator::TraceState {
+  ceph::mutex lock = ceph::make_mutex("Allocator::TraceState::lock");
+  FILE *f = nullptr;
+  uint64_t ops = 0;
+
+  ~TraceState() {
+    if (f) {
+      fclose(f);
+    }
+  }
+  void put_extent(uint64_t offset, uint64_t length) {
+    fprintf(f, " %" PRIx64 "~%" PRIx64, offset, length);
+  }
+};
+
 Allocator::Allocator(std::string_view name,
                      int64_t _capacity,
                      int64_t _block_size)
@@ -161,6 +198,88 @@ Allocator::~Allocator()
   delete asok_hook;
 }
 
+int Allocator::start_trace(const std::string& path, std::ostream& ss)
+{
+  if (!trace) {
+    trace = std::make_unique<TraceState>();
+  }
+  std::lock_guard l{trace->lock};
+  if (trace->f) {
+    ss << "already tracing";
+    return -EBUSY;
+  }
+  trace->f = fopen(path.c_str(), "w");
+  if (!trace->f) {
+    int r = -errno;
+    ss << "failed to open " << path << ": " << cpp_strerror(r);
+    return r;
+  }
+  trace->ops = 0;
+  fprintf(trace->f, "alloc_trace 1 %s %" PRIx64 " %" PRIx64 "\n",
+	  get_type(), device_size, block_size);
+  foreach([this](uint64_t offset, uint64_t length) {
+    fprintf(trace->f, "f %" PRIx64 " %" PRIx64 "\n", offset, length);
+  });
+  tracing = true;
+  ss << "tracing to " << path;
+  return 0;
+}
+
+void Allocator::stop_trace()
+{
+  if (!trace) {
+    return;
+  }
+  std::lock_guard l{trace->lock};
+  tracing = false;
+  if (trace->f) {
+    fclose(trace->f);
+    trace->f = nullptr;
+  }
+}
+
+void Allocator::_trace_allocate(uint64_t want_size, uint64_t block_size,
+				uint64_t max_alloc_size, int64_t hint,
+				const PExtentVector& extents)
+{
+  std::lock_guard l{trace->lock};
+  if (!trace->f) {
+    return;
+  }
+  fprintf(trace->f, "a %" PRIx64 " %" PRIx64 " %" PRIx64 " %" PRIx64,
+	  want_size, block_size, max_alloc_size, (uint64_t)hint);
+  for (auto& e : extents) {
+    trace->put_extent(e.offset, e.length);
+  }
+  fputc('\n', trace->f);
+  ++trace->ops;
+}
+
+void Allocator::_trace_release(const interval_set<uint64_t>& release_set)
+{
+  std::lock_guard l{trace->lock};
+  if (!trace->f) {
+    return;
+  }
+  fputc('r', trace->f);
+  for (auto [offset, length] : release_set) {
+    trace->put_extent(offset, length);
+  }
+  fputc('\n', trace->f);
+  ++trace->ops;
+}
+
+void Allocator::trace_release(const PExtentVector& release_vec)
+{
+  if (is_tracing()) {
+    interval_set<uint64_t> release_set;
+    for (auto& e : release_vec) {
+      release_set.insert(e.offset, e.length);
+    }
+    _trace_release(release_set);
+  }
+}
+
 const string& Allocator::get_name() const {
   return asok_hook->name;
 }
@@ -12,7 +12,9 @@
 #ifndef CEPH_OS_BLUESTORE_ALLOCATOR_H
 #define CEPH_OS_BLUESTORE_ALLOCATOR_H
 
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <ostream>
 #include "include/ceph_assert.h"
 #include "bluestore_types.h"
@@ -117,9 +119,41 @@ public:
   typedef std::vector<free_state_hist_bucket> FreeStateHistogram;
   void build_free_state_histogram(size_t alloc_unit, FreeStateHistogram& hist);
 
+  // Tracing of allocations and releases, for allocator_replay_test to
+  // replay with every allocator.  The trace starts with the free extents
+  // at the time; callers record an allocation once it is done, and a
+  // release before it is done, so that every traced op applies on top
+  // of them.
+  int start_trace(const std::string& path, std::ostream& ss);
+  void stop_trace();
+  bool is_tracing() const {
+    return tracing.load(std::memory_order_relaxed);
+  }
+  void trace_allocate(uint64_t want_size, uint64_t block_size,
+		      uint64_t max_alloc_size, int64_t hint,
+		      const PExtentVector& extents) {
+    if (is_tracing()) {
+      _trace_allocate(want_size, block_size, max_alloc_size, hint, extents);
+    }
+  }
+  void trace_release(const interval_set<uint64_t>& release_set) {
+    if (is_tracing()) {
+      _trace_release(release_set);
+    }
+  }
+  void trace_release(const PExtentVector& release_vec);
+
 private:
   class SocketHook;
   SocketHook* asok_hook = nullptr;
+
+  struct TraceState;
+  std::unique_ptr<TraceState> trace;
+  std::atomic<bool> tracing{false};
+  void _trace_allocate(uint64_t want_size, uint64_t block_size,
+		       uint64_t max_alloc_size, int64_t hint,
+		       const PExtentVector& extents);
+  void _trace_release(const interval_set<uint64_t>& release_set);
 protected:
   const int64_t device_size = 0;
   const int64_t block_size = 0;
@@ -504,6 +504,64 @@ void BitmapFreelistManager::release(
   }
 }
 
+void BitmapFreelistManager::update(
+  const interval_set<uint64_t>& allocated,
+  const interval_set<uint64_t>& released,
+  KeyValueDB::Transaction txn)
+{
+  dout(10) << __func__ << std::hex << " allocated 0x" << allocated
+	   << " released 0x" << released << std::dec << dendl;
+  if (is_null_manager()) {
+    return;
+  }
+  // Small writes tend to allocate and release blocks that share a bitmap
+  // key; fold all of them into one merge per key.
+  std::map<uint64_t, bufferptr> dirty;
+  for (auto p = allocated.begin(); p != allocated.end(); ++p) {
+    _xor_into(p.get_start(), p.get_len(), &dirty);
+  }
+  for (auto p = released.begin(); p != released.end(); ++p) {
+    _xor_into(p.get_start(), p.get_len(), &dirty);
+  }
+  for (auto& [key, p] : dirty) {
+    string k;
+    make_offset_key(key, &k);
+    bufferlist bl;
+    bl.append(std::move(p));
+    dout(30) << __func__ << " 0x" << std::hex << key << std::dec << ": ";
+    bl.hexdump(*_dout, false);
+    *_dout << dendl;
+    txn->merge(bitmap_prefix, k, bl);
+  }
+}
+
+void BitmapFreelistManager::_xor_into(
+  uint64_t offset, uint64_t length,
+  std::map<uint64_t, bufferptr> *dirty)
+{
+  // must be block aligned
+  ceph_assert((offset & block_mask) == offset);
+  ceph_assert((length & block_mask) == length);
+
+  uint64_t end = offset + length;
+  while (offset < end) {
+    uint64_t key = offset & key_mask;
+    uint64_t key_end = std::min(key + bytes_per_key, end);
+    auto [it, inserted] = dirty->try_emplace(key);
+    if (inserted) {
+      it->second = bufferptr(blocks_per_key >> 3);
+      it->second.zero();
+    }
+    auto& p = it->second;
+    unsigned s = (offset - key) / bytes_per_block;
+    unsigned e = (key_end - key) / bytes_per_block;
+    for (unsigned i = s; i < e; ++i) {
+      p[i >> 3] ^= 1ull << (i & 7);
+    }
+    offset = key_end;
+  }
+}
+
 void BitmapFreelistManager::_xor(
   uint64_t offset, uint64_t length,
   KeyValueDB::Transaction txn)
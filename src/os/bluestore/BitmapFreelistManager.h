@@ -6,6 +6,7 @@
 
 #include "FreelistManager.h"
 
+#include <map>
 #include <string>
 #include <mutex>
 
@@ -43,6 +44,10 @@ class BitmapFreelistManager : public FreelistManager {
   void _xor(
     uint64_t offset, uint64_t length,
     KeyValueDB::Transaction txn);
+  /// xor [offset, offset+length) into the per-key bitmaps in *dirty
+  void _xor_into(
+    uint64_t offset, uint64_t length,
+    std::map<uint64_t, ceph::buffer::ptr> *dirty);
 
   int _read_cfg(
     std::function<int(const std::string&, std::string*)> cfg_reader);
@@ -82,6 +87,10 @@ public:
   void release(
     uint64_t offset, uint64_t length,
     KeyValueDB::Transaction txn) override;
+  void update(
+    const interval_set<uint64_t>& allocated,
+    const interval_set<uint64_t>& released,
+    KeyValueDB::Transaction txn) override;
 
   inline uint64_t get_size() const override {
     return size;
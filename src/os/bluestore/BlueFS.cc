@@ -189,7 +189,8 @@ BlueFS::BlueFS(CephContext* cct)
     ioc(MAX_BDEV),
     block_reserved(MAX_BDEV),
     alloc(MAX_BDEV),
-    alloc_size(MAX_BDEV, 0)
+    alloc_size(MAX_BDEV, 0),
+    log_compact_thread(this)
 {
   dirty.pending_release.resize(MAX_BDEV);
   discard_cb[BDEV_WAL] = wal_discard_cb;
@@ -1072,6 +1073,7 @@ int BlueFS::mount()
            << dendl;
   // update log size
   logger->set(l_bluefs_log_bytes, log.writer->file->fnode.size);
+  _start_log_compact_thread();
   return 0;
 
  out:
@@ -1100,6 +1102,9 @@ void BlueFS::umount(bool avoid_compact)
 {
   dout(1) << __func__ << dendl;
 
+  // wait for an ongoing background compaction; from here on
+  // sync_metadata() compacts inline, if at all
+  _stop_log_compact_thread();
   sync_metadata(avoid_compact);
   if (cct->_conf->bluefs_check_volume_selector_on_umount) {
     _check_vselector_LNF();
@@ -4094,6 +4099,20 @@ void BlueFS::_maybe_compact_log_LNF_NF_LD_D()
 {
   if (!cct->_conf->bluefs_replay_recovery_disable_compact &&
       _should_start_compact_log_L_N()) {
+    if (!cct->_conf->bluefs_compact_log_sync) {
+      // hand the async compaction over to the background thread, if
+      // there is one, so the flushing/fsyncing caller doesn't wait for
+      // the new log image to be written out
+      std::lock_guard l(log_compact_lock);
+      if (log_compact_thread_running && !log_compact_stop) {
+        if (!log_compact_requested) {
+          dout(10) << __func__ << " queue background compaction" << dendl;
+          log_compact_requested = true;
+          log_compact_cond.notify_one();
+        }
+        return;
+      }
+    }
     auto t0 = mono_clock::now();
     if (cct->_conf->bluefs_compact_log_sync) {
       _compact_log_sync_LNF_LD();
@@ -4104,6 +4123,56 @@ void BlueFS::_maybe_compact_log_LNF_NF_LD_D()
   }
 }
 
+void BlueFS::_start_log_compact_thread()
+{
+  if (!cct->_conf->bluefs_compact_log_background) {
+    return;
+  }
+  std::lock_guard l(log_compact_lock);
+  ceph_assert(!log_compact_thread_running);
+  log_compact_stop = false;
+  log_compact_requested = false;
+  log_compact_thread_running = true;
+  log_compact_thread.create("bluefs_compact");
+}
+
+void BlueFS::_stop_log_compact_thread()
+{
+  {
+    std::lock_guard l(log_compact_lock);
+    if (!log_compact_thread_running) {
+      return;
+    }
+    log_compact_stop = true;
+    log_compact_cond.notify_one();
+  }
+  log_compact_thread.join();
+  std::lock_guard l(log_compact_lock);
+  log_compact_thread_running = false;
+}
+
+void BlueFS::_log_compact_thread_entry()
+{
+  dout(10) << __func__ << " start" << dendl;
+  std::unique_lock l(log_compact_lock);
+  while (!log_compact_stop) {
+    if (!log_compact_requested) {
+      log_compact_cond.wait(l);
+      continue;
+    }
+    log_compact_requested = false;
+    l.unlock();
+    // conditions might have changed since the request was queued
+    if (_should_start_compact_log_L_N()) {
+      auto t0 = mono_clock::now();
+      _compact_log_async_LD_LNF_D();
+      logger->tinc(l_bluefs_compaction_lat, mono_clock::now() - t0);
+    }
+    l.lock();
+  }
+  dout(10) << __func__ << " finish" << dendl;
+}
+
 int BlueFS::open_for_write(
   std::string_view dirname,
   std::string_view filename,
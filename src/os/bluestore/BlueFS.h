@@ -11,6 +11,7 @@
 #include "blk/BlockDevice.h"
 
 #include "common/RefCountedObj.h"
+#include "common/Thread.h"
 #include "common/ceph_context.h"
 #include "global/global_context.h"
 #include "include/common_fwd.h"
@@ -482,6 +483,22 @@ private:
   std::atomic<bool> log_is_compacting{false};                    ///< signals that bluefs log is already ongoing compaction
   std::atomic<bool> log_forbidden_to_expand{false};              ///< used to signal that async compaction is in state
                                                                  ///  that prohibits expansion of bluefs log
+
+  /// runs async log compactions off the flush/fsync path
+  struct LogCompactThread : public Thread {
+    BlueFS *fs;
+    explicit LogCompactThread(BlueFS *f) : fs(f) {}
+    void *entry() override {
+      fs->_log_compact_thread_entry();
+      return nullptr;
+    }
+  } log_compact_thread;
+  ceph::mutex log_compact_lock =
+    ceph::make_mutex("BlueFS::log_compact_lock");
+  ceph::condition_variable log_compact_cond;
+  bool log_compact_thread_running = false; ///< protected by log_compact_lock
+  bool log_compact_stop = false;           ///< protected by log_compact_lock
+  bool log_compact_requested = false;      ///< protected by log_compact_lock
   /*
    * There are up to 3 block devices:
    *
@@ -792,6 +809,9 @@ private:
 
   /// test and compact log, if necessary
   void _maybe_compact_log_LNF_NF_LD_D();
+  void _start_log_compact_thread();
+  void _stop_log_compact_thread();
+  void _log_compact_thread_entry();
   int _do_replay_recovery_read(FileReader *log,
 			       size_t log_pos,
 			       size_t read_offset,
@@ -41,6 +41,7 @@
 #include "common/PriorityCache.h"
 #include "common/url_escape.h"
 #include "Allocator.h"
+#include "CachingAllocator.h"
 #include "FreelistManager.h"
 #include "BlueFS.h"
 #include "BlueRocksEnv.h"
@@ -128,6 +129,7 @@ const string PREFIX_DEFERRED = "L";    // id -> deferred_transaction_t
 const string PREFIX_ALLOC = "B";       // u64 offset -> u64 length (freelist)
 const string PREFIX_ALLOC_BITMAP = "b";// (see BitmapFreelistManager)
 const string PREFIX_SHARED_BLOB = "X"; // u64 SB id -> shared_blob_t
+const string PREFIX_COMPRESSION_DICT = "D"; // u32 id -> dictionary
 
 const string BLUESTORE_GLOBAL_STATFS_KEY = "bluestore_statfs";
 
@@ -1078,6 +1080,7 @@ struct LruOnodeCacheShard : public BlueStore::OnodeCacheShard {
   void _add(BlueStore::Onode* o, int level) override
   {
     o->set_cached();
+    o->cache_credits = o->c->cache_priority;
     if (o->pin_nref == 1) {
       (level > 0) ? lru.push_front(*o) : lru.push_back(*o);
       o->cache_age_bin = age_bins.front();
@@ -1113,6 +1116,7 @@ struct LruOnodeCacheShard : public BlueStore::OnodeCacheShard {
       if(!o->lru_item.is_linked()) {
         if (o->exists) {
 	  lru.push_front(*o);
+	  o->cache_credits = o->c->cache_priority;
 	  o->cache_age_bin = age_bins.front();
 	  *(o->cache_age_bin) += 1;
 	  dout(20) << __func__ << " " << this << " " << o->oid << " unpinned"
@@ -1130,6 +1134,7 @@ struct LruOnodeCacheShard : public BlueStore::OnodeCacheShard {
         // move onode within LRU
         lru.erase(lru.iterator_to(*o));
         lru.push_front(*o);
+        o->cache_credits = o->c->cache_priority;
         if (o->cache_age_bin != age_bins.front()) {
           *(o->cache_age_bin) -= 1;
           o->cache_age_bin = age_bins.front();
@@ -1151,6 +1156,7 @@ struct LruOnodeCacheShard : public BlueStore::OnodeCacheShard {
                                  // before n == 0 due to pinned
                                  // entries. And hence being unable
                                  // to reach new_size target.
+    bool compact = cct->_conf->bluestore_onode_cache_compact;
     while (n-- > 0 && lru.size() > 0) {
       BlueStore::Onode *o = &lru.back();
       lru.pop_back();
@@ -1161,6 +1167,25 @@ struct LruOnodeCacheShard : public BlueStore::OnodeCacheShard {
       *(o->cache_age_bin) -= 1;
       if (o->pin_nref > 1) {
         dout(20) << __func__ << " " << this << " " << " " << " " << o->oid << dendl;
+      } else if (compact && o->extent_map.compact_shards()) {
+        // give the (now much smaller) onode another trip through the lru
+        // instead of evicting it; it is evicted on the next pass if
+        // nothing is decoded again in the meantime
+        dout(20) << __func__ << " " << this << " " << o->oid
+                 << " compacted" << dendl;
+        lru.push_front(*o);
+        o->cache_age_bin = age_bins.front();
+        *(o->cache_age_bin) += 1;
+      } else if (o->cache_credits > 0) {
+        // the pool asked for its metadata to stay resident; spend one
+        // credit and let lower priority onodes go first
+        --o->cache_credits;
+        dout(20) << __func__ << " " << this << " " << o->oid
+                 << " retained, credits " << (int)o->cache_credits << dendl;
+        lru.push_front(*o);
+        o->cache_age_bin = age_bins.front();
+        *(o->cache_age_bin) += 1;
+        logger->inc(l_bluestore_onode_priority_retained);
       } else {
 	ceph_assert(num);
         --num;
@@ -3540,6 +3565,7 @@ void BlueStore::ExtentMap::update(KeyValueDB::Transaction t,
 
     // schedule DB update for dirty shards
     string key;
+    bool keep_encoded = cct->_conf->bluestore_onode_cache_compact;
     for (auto& it : encoded_shards) {
       dout(20) << __func__ << "  encoding key for shard 0x" << std::hex
 	       << it.shard->shard_info->offset << std::dec << dendl;
@@ -3553,6 +3579,10 @@ void BlueStore::ExtentMap::update(KeyValueDB::Transaction t,
           t->set(PREFIX_OBJ, final_key, it.bl);
         }
       );
+      if (keep_encoded) {
+	it.bl.reassign_to_mempool(mempool::mempool_bluestore_cache_meta);
+	it.shard->encoded = std::move(it.bl);
+      }
     }
   }
 }
@@ -4186,6 +4216,7 @@ void BlueStore::ExtentMap::init_shards(bool loaded, bool dirty)
     shards[i].shard_info = &s;
     shards[i].loaded = loaded;
     shards[i].dirty = dirty;
+    shards[i].encoded.clear();
     ++i;
   }
 }
@@ -4210,7 +4241,18 @@ void BlueStore::ExtentMap::fault_range(
   while (start <= last) {
     ceph_assert((size_t)start < shards.size());
     auto p = &shards[start];
-    if (!p->loaded) {
+    if (!p->loaded && p->encoded.length()) {
+      // compacted by the onode cache; decode the cached copy
+      ceph_assert(p->dirty == false);
+      ceph_assert(p->encoded.length() == p->shard_info->bytes);
+      p->extents = decode_some(p->encoded);
+      p->loaded = true;
+      dout(20) << __func__ << " decoded shard 0x" << std::hex
+	       << p->shard_info->offset
+	       << " for range 0x" << offset << "~" << length << std::dec
+	       << " (" << p->encoded.length() << " bytes cached)" << dendl;
+      onode->c->store->logger->inc(l_bluestore_onode_shard_hits);
+    } else if (!p->loaded) {
       dout(30) << __func__ << " opening shard 0x" << std::hex
 	       << p->shard_info->offset << std::dec << dendl;
       bufferlist v;
@@ -4234,6 +4276,10 @@ void BlueStore::ExtentMap::fault_range(
 	       << " (" << v.length() << " bytes)" << dendl;
       ceph_assert(p->dirty == false);
       ceph_assert(v.length() == p->shard_info->bytes);
+      if (onode->c->store->cct->_conf->bluestore_onode_cache_compact) {
+	v.reassign_to_mempool(mempool::mempool_bluestore_cache_meta);
+	p->encoded = std::move(v);
+      }
       onode->c->store->logger->inc(l_bluestore_onode_shard_misses);
     } else {
       onode->c->store->logger->inc(l_bluestore_onode_shard_hits);
@@ -4275,11 +4321,41 @@ void BlueStore::ExtentMap::dirty_range(
       dout(20) << __func__ << " mark shard 0x" << std::hex
 	       << p->shard_info->offset << std::dec << " dirty" << dendl;
       p->dirty = true;
+      p->encoded.clear();
     }
     ++start;
   }
 }
 
+unsigned BlueStore::ExtentMap::compact_shards()
+{
+  unsigned n = 0;
+  for (size_t i = 0; i < shards.size(); ++i) {
+    auto& s = shards[i];
+    if (!s.loaded || s.dirty || s.encoded.length() == 0) {
+      continue;
+    }
+    uint32_t end = i + 1 < shards.size() ?
+      shards[i + 1].shard_info->offset : OBJECT_MAX_SIZE;
+    auto p = seek_lextent(s.shard_info->offset);
+    while (p != extent_map.end() && p->logical_offset < end) {
+      // shard-local blobs (and their cached buffers) go away with the
+      // last extent referencing them; spanning blobs stay in
+      // spanning_blob_map
+      rm(p++);
+    }
+    s.extents = 0;
+    s.loaded = false;
+    ++n;
+  }
+  if (n) {
+    dout(20) << __func__ << " " << onode->oid << " unloaded " << n
+	     << " shards" << dendl;
+    onode->c->store->logger->inc(l_bluestore_onode_shard_compacted, n);
+  }
+  return n;
+}
+
 BlueStore::extent_map_t::iterator BlueStore::ExtentMap::find(
   uint64_t offset)
 {
@@ -5121,6 +5197,9 @@ BlueStore::OnodeRef BlueStore::Collection::get_onode(
   return onode_space.add_onode(oid, o);
 }
 
+// onodes moved per cache shard lock hold by split_cache()
+static constexpr size_t SPLIT_CACHE_BATCH = 256;
+
 void BlueStore::Collection::split_cache(
   Collection *dest)
 {
@@ -5129,34 +5208,47 @@ void BlueStore::Collection::split_cache(
   auto *ocache = get_onode_cache();
   auto *ocache_dest = dest->get_onode_cache();
 
- // lock cache shards
-  std::lock(ocache->lock, ocache_dest->lock, cache->lock, dest->cache->lock);
-  std::lock_guard l(ocache->lock, std::adopt_lock);
-  std::lock_guard l2(ocache_dest->lock, std::adopt_lock);
-  std::lock_guard l3(cache->lock, std::adopt_lock);
-  std::lock_guard l4(dest->cache->lock, std::adopt_lock);
-
   int destbits = dest->cnode.bits;
   spg_t destpg;
   bool is_pg = dest->cid.is_pg(&destpg);
   ceph_assert(is_pg);
 
-  auto p = onode_space.onode_map.begin();
-  while (p != onode_space.onode_map.end()) {
-    OnodeRef o = p->second;
-    if (!p->second->oid.match(destbits, destpg.pgid.ps())) {
-      // onode does not belong to this child
-      ldout(store->cct, 20) << __func__ << " not moving " << o << " " << o->oid
-			    << dendl;
-      ++p;
-    } else {
+  // pick the onodes that belong to the child.  the refs held here keep
+  // nref >= 2, hence the onodes pinned, while the shard locks are dropped
+  // between batches below (both collections are locked by our caller)
+  std::vector<OnodeRef> to_move;
+  {
+    std::lock_guard l(ocache->lock);
+    for (auto& [oid, o] : onode_space.onode_map) {
+      if (!oid.match(destbits, destpg.pgid.ps())) {
+	// onode does not belong to this child
+	ldout(store->cct, 20) << __func__ << " not moving " << o << " " << oid
+			      << dendl;
+      } else {
+	to_move.push_back(o);
+      }
+    }
+  }
+  ldout(store->cct, 10) << __func__ << " moving " << to_move.size()
+			<< " onodes" << dendl;
+
+  // the cache shards are shared with other collections; move the onodes in
+  // batches so their IO is not stalled for the whole split
+  auto p = to_move.begin();
+  while (p != to_move.end()) {
+    // lock cache shards
+    std::lock(ocache->lock, ocache_dest->lock, cache->lock, dest->cache->lock);
+    std::lock_guard l(ocache->lock, std::adopt_lock);
+    std::lock_guard l2(ocache_dest->lock, std::adopt_lock);
+    std::lock_guard l3(cache->lock, std::adopt_lock);
+    std::lock_guard l4(dest->cache->lock, std::adopt_lock);
+    auto batch_end = p + std::min<size_t>(SPLIT_CACHE_BATCH, to_move.end() - p);
+    for (; p != batch_end; ++p) {
+      OnodeRef& o = *p;
       ldout(store->cct, 20) << __func__ << " moving " << o << " " << o->oid
 			    << dendl;
 
-      // ensuring that nref is always >= 2 and hence onode is pinned
-      OnodeRef o_pin = o;
-
-      p = onode_space.onode_map.erase(p);
+      onode_space.onode_map.erase(o->oid);
       dest->onode_space.onode_map[o->oid] = o;
       if (o->cached) {
         get_onode_cache()->_move_pinned(dest->get_onode_cache(), o.get());
@@ -5170,12 +5262,12 @@ void BlueStore::Collection::split_cache(
       auto rehome_blob = [&](Blob* b) {
 	for (auto& i : b->bc.buffer_map) {
 	  if (!i.second.is_writing()) {
-	    ldout(store->cct, 1) << __func__ << "   moving " << i.second
-				 << dendl;
+	    ldout(store->cct, 20) << __func__ << "   moving " << i.second
+				  << dendl;
 	    dest->cache->_move(cache, &i.second);
 	  } else {
-	    ldout(store->cct, 1) << __func__ << "   not moving " << i.second
-				 << dendl;
+	    ldout(store->cct, 20) << __func__ << "   not moving " << i.second
+				  << dendl;
 	  }
 	}
 	cache->rm_blob();
@@ -5224,7 +5316,12 @@ void BlueStore::Collection::split_cache(
       }
     }
   }
-  dest->cache->_trim();
+  {
+    std::lock_guard l(dest->cache->lock);
+    dest->cache->_trim();
+  }
+  // dropping the pins may take the onode cache shard lock
+  to_move.clear();
 }
 
 // =======================================================
@@ -5643,6 +5740,7 @@ void BlueStore::handle_discard(interval_set<uint64_t>& to_release)
 {
   dout(10) << __func__ << dendl;
   ceph_assert(alloc);
+  alloc->trace_release(to_release);
   alloc->release(to_release);
 }
 
@@ -5654,12 +5752,14 @@ BlueStore::BlueStore(CephContext *cct,
   uint64_t _min_alloc_size)
   : ObjectStore(cct, path),
     throttle(cct),
-    finisher(cct, "commit_finisher", "cfin"),
+    finisher(cct, "commit_finisher", "cfin",
+	     cct->_conf.get_val<uint64_t>("bluestore_finisher_threads")),
     kv_sync_thread(this),
     kv_finalize_thread(this),
     min_alloc_size(_min_alloc_size),
     min_alloc_size_order(std::countr_zero(_min_alloc_size)),
-    mempool_thread(this)
+    mempool_thread(this),
+    online_fsck_thread(this)
 {
   _init_logger();
   cct->_conf.add_observer(this);
@@ -6167,6 +6267,12 @@ void BlueStore::_init_logger()
   b.add_time_avg(l_bluestore_read_lat, "read_lat",
 		 "Average read latency",
 		 "r_l", PerfCountersBuilder::PRIO_CRITICAL);
+  b.add_u64_counter(l_bluestore_readahead_bytes, "readahead_bytes",
+		    "Bytes prefetched into the buffer cache by sequential "
+		    "read detection",
+		    NULL,
+		    PerfCountersBuilder::PRIO_DEBUGONLY,
+		    unit_t(UNIT_BYTES));
   //****************************************
 
   // kv_thread latencies
@@ -6298,6 +6404,12 @@ void BlueStore::_init_logger()
   b.add_u64_counter(l_bluestore_onode_shard_misses,
 		    "onode_shard_misses",
 		    "Count of onode shard cache lookups misses");
+  b.add_u64_counter(l_bluestore_onode_shard_compacted,
+		    "onode_shard_compacted",
+		    "Count of onode shards unloaded to their encoded form");
+  b.add_u64_counter(l_bluestore_onode_priority_retained,
+		    "onode_priority_retained",
+		    "Count of onodes kept in cache due to pool cache_priority");
   b.add_u64(l_bluestore_extents, "onode_extents",
 	    "Number of extents in cache");
   b.add_u64(l_bluestore_blobs, "onode_blobs",
@@ -6412,6 +6524,14 @@ void BlueStore::_init_logger()
     "Slow op count for read wait aio",
     "srwc",
     PerfCountersBuilder::PRIO_USEFUL);
+  b.add_u64_counter(l_bluestore_online_fsck_objects,
+    "online_fsck_objects",
+    "Objects checked by online fsck");
+  b.add_u64_counter(l_bluestore_online_fsck_errors,
+    "online_fsck_errors",
+    "Errors found by online fsck",
+    "ofse",
+    PerfCountersBuilder::PRIO_USEFUL);
 
   // Resulting size axis configuration for op histograms, values are in bytes
   PerfHistogramCommon::axis_config_d alloc_hist_x_axis_config{
@@ -6874,17 +6994,28 @@ int BlueStore::_create_alloc()
   uint64_t alloc_size = min_alloc_size;
 
   std::string allocator_type = cct->_conf->bluestore_allocator;
+  auto cache_shards =
+    cct->_conf.get_val<uint64_t>("bluestore_allocator_cache_shards");
 
   alloc = Allocator::create(
     cct, allocator_type,
     bdev->get_size(),
     alloc_size,
-    "block");
+    cache_shards ? "block.backing" : "block");
   if (!alloc) {
     lderr(cct) << __func__ << " failed to create " << allocator_type << " allocator"
 	       << dendl;
     return -EINVAL;
   }
+  if (cache_shards) {
+    alloc = new CachingAllocator(
+      cct, alloc,
+      cct->_conf.get_val<Option::size_t>("bluestore_allocator_cache_chunk_size"),
+      cct->_conf.get_val<Option::size_t>("bluestore_allocator_cache_max_alloc"),
+      cct->_conf.get_val<Option::size_t>("bluestore_allocator_cache_shard_max"),
+      cache_shards,
+      "block");
+  }
 
   // BlueFS will share the same allocator
   shared_alloc.set(alloc, alloc_size);
@@ -7459,6 +7590,14 @@ int BlueStore::_open_db_and_around(bool read_only, bool to_repair)
     dout(10) << __func__ << "::NCB::need_to_destage_allocation_file was set" << dendl;
   }
 
+  compression_dicts = std::make_unique<CompressionDictionaries>(
+    cct, PREFIX_COMPRESSION_DICT);
+  r = compression_dicts->open(db);
+  if (r < 0) {
+    compression_dicts.reset();
+    goto out_alloc;
+  }
+
   return 0;
 
 out_alloc:
@@ -7478,6 +7617,7 @@ out_fm:
 
 void BlueStore::_close_db_and_around()
 {
+  compression_dicts.reset();
   if (db) {
     _close_db();
   }
@@ -8888,6 +9028,8 @@ int BlueStore::_mount()
     }
   }
 
+  online_fsck_thread.init();
+
   mounted = true;
   return 0;
 }
@@ -8896,6 +9038,9 @@ int BlueStore::umount()
 {
   dout(5) << __func__ << dendl;
   ceph_assert(_kv_only || mounted);
+  if (!_kv_only) {
+    online_fsck_thread.shutdown();
+  }
   _osr_drain_all();
 
   mounted = false;
@@ -11604,6 +11749,197 @@ BlueStore::CollectionRef BlueStore::_get_collection_by_oid(const ghobject_t& oid
   return CollectionRef();
 }
 
+// online fsck
+
+void BlueStore::_online_fsck_thread()
+{
+  dout(10) << __func__ << " start" << dendl;
+  // the next object to check; a max oid means the collection is done
+  std::pair<coll_t, ghobject_t> cursor;
+  {
+    bufferlist bl;
+    if (db->get(PREFIX_SUPER, "online_fsck_cursor", &bl) >= 0 &&
+	bl.length()) {
+      try {
+	auto p = bl.cbegin();
+	decode(cursor.first, p);
+	decode(cursor.second, p);
+	dout(1) << __func__ << " resuming at " << cursor.first << " "
+		<< cursor.second << dendl;
+      } catch (ceph::buffer::error& e) {
+	derr << __func__ << " failed to decode cursor, restarting pass"
+	     << dendl;
+	cursor = {};
+      }
+    }
+  }
+  uint64_t objects = 0, errors = 0;
+  auto pass_start = mono_clock::now();
+  while (true) {
+    double sleep;
+    if (!cct->_conf.get_val<bool>("bluestore_online_fsck")) {
+      sleep = 5.0;
+    } else {
+      bool more = _online_fsck_batch(
+	&cursor,
+	cct->_conf.get_val<uint64_t>("bluestore_online_fsck_batch_objects"),
+	&objects, &errors);
+      if (!more) {
+	auto lat = mono_clock::now() - pass_start;
+	if (errors) {
+	  derr << __func__ << " pass found " << errors << " errors in "
+	       << objects << " objects" << dendl;
+	} else {
+	  dout(1) << __func__ << " pass checked " << objects
+		  << " objects in " << lat << dendl;
+	}
+	cursor = {};
+	objects = errors = 0;
+	pass_start = mono_clock::now();
+	sleep = cct->_conf.get_val<double>("bluestore_online_fsck_interval");
+      } else {
+	sleep = cct->_conf.get_val<double>("bluestore_online_fsck_sleep");
+      }
+      // persist progress, so that a restart resumes where we left off
+      bufferlist bl;
+      encode(cursor.first, bl);
+      encode(cursor.second, bl);
+      KeyValueDB::Transaction t = db->get_transaction();
+      t->set(PREFIX_SUPER, "online_fsck_cursor", bl);
+      db->submit_transaction(t);
+    }
+    if (!online_fsck_thread.wait(ceph::make_timespan(sleep))) {
+      break;
+    }
+  }
+  dout(10) << __func__ << " finish" << dendl;
+}
+
+bool BlueStore::_online_fsck_batch(std::pair<coll_t, ghobject_t>* cursor,
+				   uint64_t max_objects,
+				   uint64_t* objects, uint64_t* errors)
+{
+  // collections are visited in coll_t order
+  CollectionRef c;
+  {
+    std::shared_lock l(coll_lock);
+    for (auto& [cid, coll] : coll_map) {
+      if (cid < cursor->first ||
+	  (cid == cursor->first && cursor->second.is_max())) {
+	continue;
+      }
+      if (!c || cid < c->cid) {
+	c = coll;
+      }
+    }
+  }
+  if (!c) {
+    return false;
+  }
+  if (c->cid != cursor->first) {
+    *cursor = {c->cid, ghobject_t()};
+  }
+
+  vector<ghobject_t> ls;
+  ghobject_t next;
+  {
+    std::shared_lock l(c->lock);
+    int r = 0;
+    if (c->exists) {
+      r = _collection_list(c.get(), cursor->second, ghobject_t::get_max(),
+			   max_objects, false, &ls, &next);
+    }
+    if (!c->exists || r < 0) {
+      ls.clear();
+      next = ghobject_t::get_max();
+    }
+  }
+  dout(20) << __func__ << " " << c->cid << " " << cursor->second
+	   << " " << ls.size() << " objects" << dendl;
+  for (auto& oid : ls) {
+    // one object at a time, so that writers are not held off for long
+    std::shared_lock l(c->lock);
+    OnodeRef o = c->get_onode(oid, false);
+    if (!o || !o->exists) {
+      continue;
+    }
+    ++*objects;
+    logger->inc(l_bluestore_online_fsck_objects);
+    if (int e = _online_fsck_check_onode(o); e > 0) {
+      *errors += e;
+      logger->inc(l_bluestore_online_fsck_errors, e);
+    }
+  }
+  cursor->second = next;
+  return true;
+}
+
+int BlueStore::_online_fsck_check_onode(OnodeRef& o)
+{
+  // This runs against the live, cached onode: only invariants that hold
+  // between transactions are checked.  Allocation and shared blob
+  // reference counts need the global view of an offline fsck.
+  int errors = 0;
+  const ghobject_t& oid = o->oid;
+  o->extent_map.fault_range(db, 0, OBJECT_MAX_SIZE);
+  for (auto& s : o->extent_map.shards) {
+    if (s.shard_info->offset >= o->onode.size) {
+      derr << "online fsck error: " << oid << " shard 0x" << std::hex
+	   << s.shard_info->offset << " past EOF at 0x" << o->onode.size
+	   << std::dec << dendl;
+      ++errors;
+    }
+  }
+
+  uint64_t pos = 0;
+  std::map<Blob*, bluestore_blob_use_tracker_t> ref_map;
+  for (auto& l : o->extent_map.extent_map) {
+    if (l.logical_offset < pos) {
+      derr << "online fsck error: " << oid << " lextent at 0x"
+	   << std::hex << l.logical_offset
+	   << " overlaps with the previous, which ends at 0x" << pos
+	   << std::dec << dendl;
+      ++errors;
+    }
+    pos = l.logical_offset + l.length;
+    const bluestore_blob_t& blob = l.blob->get_blob();
+    if (l.blob_offset + l.length > blob.get_logical_length()) {
+      derr << "online fsck error: " << oid << " lextent " << l
+	   << " is past the end of its blob" << dendl;
+      ++errors;
+      continue;
+    }
+    auto& ref = ref_map[l.blob.get()];
+    if (ref.is_empty()) {
+      ref.init(blob.get_logical_length(),
+	       blob.get_release_size(min_alloc_size));
+    }
+    ref.get(l.blob_offset, l.length);
+  }
+
+  for (auto& [b, ref] : ref_map) {
+    const bluestore_blob_t& blob = b->get_blob();
+    if (!b->get_blob_use_tracker().equal(ref)) {
+      derr << "online fsck error: " << oid << " blob " << *b
+	   << " doesn't match expected ref_map " << ref << dendl;
+      ++errors;
+    }
+    for (auto& e : blob.get_extents()) {
+      if (e.is_valid() && e.end() > bdev->get_size()) {
+	derr << "online fsck error: " << oid << " blob " << *b
+	     << " extent " << e << " past end of block device" << dendl;
+	++errors;
+      }
+    }
+    if (blob.is_shared() && b->get_sbid() == 0) {
+      derr << "online fsck error: " << oid << " blob " << *b
+	   << " marked as shared but has uninitialized sbid" << dendl;
+      ++errors;
+    }
+  }
+  return errors;
+}
+
 void BlueStore::_queue_reap_collection(CollectionRef& c)
 {
   dout(10) << __func__ << " " << c << " " << c->cid << dendl;
@@ -11770,6 +12106,9 @@ int BlueStore::set_collection_opts(
     return -ENOENT;
   std::unique_lock l{c->lock};
   c->pool_opts = opts;
+  int64_t prio = 0;
+  opts.get(pool_opts_t::CACHE_PRIORITY, &prio);
+  c->cache_priority = std::clamp<int64_t>(prio, 0, 10);
   return 0;
 }
 
@@ -11836,6 +12175,98 @@ int BlueStore::read(
   return r;
 }
 
+int BlueStore::scrub_read(
+  CollectionHandle &c_,
+  const ghobject_t& oid,
+  uint64_t offset,
+  size_t length,
+  uint32_t *crc,
+  uint32_t op_flags)
+{
+  Collection *c = static_cast<Collection *>(c_.get());
+  dout(15) << __func__ << " " << c->get_cid() << " " << oid
+	   << " 0x" << std::hex << offset << "~" << length << std::dec
+	   << dendl;
+  if (!c->exists)
+    return -ENOENT;
+
+  int r;
+  {
+    std::shared_lock l(c->lock);
+    OnodeRef o = c->get_onode(oid, false);
+    if (!o || !o->exists) {
+      return -ENOENT;
+    }
+    bufferlist bl;
+    r = _do_read(c, o, offset, length, bl, op_flags);
+    if (r == -EIO) {
+      logger->inc(l_bluestore_read_eio);
+    }
+    if (r > 0) {
+      *crc = _scrub_crc(o, offset, bl, *crc);
+    }
+  }
+  if (r >= 0 && _debug_data_eio(oid)) {
+    r = -EIO;
+    derr << __func__ << " " << c->cid << " " << oid << " INJECT EIO" << dendl;
+  }
+  dout(10) << __func__ << " " << c->get_cid() << " " << oid
+	   << " 0x" << std::hex << offset << "~" << length
+	   << " crc 0x" << *crc << std::dec
+	   << " = " << r << dendl;
+  return r;
+}
+
+uint32_t BlueStore::_scrub_crc(
+  OnodeRef& o,
+  uint64_t offset,
+  const bufferlist& bl,
+  uint32_t crc)
+{
+  const uint64_t end = offset + bl.length();
+  uint64_t pos = offset;
+  auto hash_to = [&](uint64_t to) {
+    if (to > pos) {
+      bufferlist t;
+      t.substr_of(bl, pos - offset, to - pos);
+      crc = t.crc32c(crc);
+      pos = to;
+    }
+  };
+  if (!cct->_conf->bluestore_ignore_data_csum) {
+    // _do_read() has verified the data of every blob read against its
+    // csums, so for whole crc32c chunks the stored value is the crc of
+    // the data read.  Our own seed is folded in as the crc of zeros,
+    // the same way bufferlist::crc32c() reuses its cached crcs.
+    o->extent_map.fault_range(db, offset, end - offset);
+    for (auto ep = o->extent_map.seek_lextent(offset);
+	 ep != o->extent_map.extent_map.end() && ep->logical_offset < end;
+	 ++ep) {
+      const bluestore_blob_t& blob = ep->blob->get_blob();
+      uint64_t l_start = std::max<uint64_t>(pos, ep->logical_offset);
+      uint64_t l_end = std::min<uint64_t>(end, ep->logical_end());
+      if (l_start >= l_end ||
+	  blob.is_compressed() ||
+	  !blob.has_csum() ||
+	  blob.csum_type != Checksummer::CSUM_CRC32C) {
+	continue;
+      }
+      uint64_t chunk = blob.get_csum_chunk_size();
+      uint64_t b_off = ep->blob_offset + (l_start - ep->logical_offset);
+      if (b_off % chunk || (l_end - l_start) % chunk) {
+	continue;
+      }
+      hash_to(l_start);
+      for (uint64_t i = b_off / chunk; pos < l_end; ++i, pos += chunk) {
+	crc = blob.get_csum_item(i) ^
+	  ceph_crc32c(crc ^ 0xffffffff, nullptr, chunk);
+      }
+    }
+  }
+  hash_to(end);
+  return crc;
+}
+
 void BlueStore::_read_cache(
   OnodeRef& o,
   uint64_t offset,
@@ -12013,6 +12444,15 @@ int BlueStore::_generate_read_result_bl(
   bool* csum_error,
   bufferlist& bl)
 {
+ // verify all uncompressed blobs up front, in one batch
+  bool batched = blobs2read.size() > 1 &&
+    cct->_conf->bluestore_debug_inject_csum_err_probability == 0 &&
+    !cct->_conf->bluestore_ignore_data_csum;
+  if (batched && _verify_csum_batch(o, blobs2read) < 0) {
+    *csum_error = true;
+    return -EIO;
+  }
+
  // enumerate and decompress desired blobs
   auto p = compressed_blob_bls.begin();
   blobs2read_t::iterator b2r_it = blobs2read.begin();
@@ -12045,7 +12485,8 @@ int BlueStore::_generate_read_result_bl(
       }
     } else {
       for (auto& req : r2r) {
-        if (_verify_csum(o, &bptr->get_blob(), req.r_off, req.bl,
+        if (!batched &&
+            _verify_csum(o, &bptr->get_blob(), req.r_off, req.bl,
                          req.regs.front().logical_offset) < 0) {
           *csum_error = true;
           return -EIO;
@@ -12095,6 +12536,41 @@ int BlueStore::_generate_read_result_bl(
   return 0;
 }
 
+uint64_t BlueStore::_get_readahead_end(
+  Onode *o,
+  uint64_t offset,
+  uint64_t length)
+{
+  uint64_t end = offset + length;
+  uint64_t max_ra =
+    cct->_conf.get_val<Option::size_t>("bluestore_readahead_max_bytes");
+  // the window starts at the size of the second sequential read and
+  // doubles with every further one
+  uint64_t window = 0;
+  if (max_ra && offset == o->readahead_next) {
+    window = std::min<uint64_t>(
+      std::max<uint64_t>(2 * o->readahead_window, length), max_ra);
+  }
+  o->readahead_next = end;
+  o->readahead_window = window;
+  if (!window) {
+    return end;
+  }
+  // refill once half of the prefetched data has been consumed
+  if (o->readahead_end >= end + window / 2) {
+    return end;
+  }
+  uint64_t ra_end = std::min<uint64_t>(end + window, o->onode.size);
+  if (ra_end <= end) {
+    return end;
+  }
+  dout(20) << __func__ << " sequential read, prefetch 0x" << std::hex
+	   << end << "~" << ra_end - end << std::dec << dendl;
+  o->readahead_end = ra_end;
+  logger->inc(l_bluestore_readahead_bytes, ra_end - end);
+  return ra_end;
+}
+
 int BlueStore::_do_read(
   Collection *c,
   OnodeRef& o,
@@ -12134,6 +12610,19 @@ int BlueStore::_do_read(
     length = o->onode.size - offset;
   }
 
+  // sequential streams read past the request, in the same ios, and keep
+  // the extra data in the buffer cache for the following reads
+  size_t req_length = length;
+  if (retry_count == 0 &&
+      (op_flags & (CEPH_OSD_OP_FLAG_FADVISE_DONTNEED |
+		   CEPH_OSD_OP_FLAG_FADVISE_NOCACHE |
+		   CEPH_OSD_OP_FLAG_BYPASS_CLEAN_CACHE)) == 0) {
+    length = _get_readahead_end(o.get(), offset, length) - offset;
+    if (length > req_length) {
+      buffered = true;
+    }
+  }
+
   auto start = mono_clock::now();
   o->extent_map.fault_range(db, offset, length);
   log_latency(__func__,
@@ -12201,7 +12690,13 @@ int BlueStore::_do_read(
     if (retry_count >= cct->_conf->bluestore_retry_disk_reads) {
       return -EIO;
     }
-    return _do_read(c, o, offset, length, bl, op_flags, retry_count + 1);
+    return _do_read(c, o, offset, req_length, bl, op_flags, retry_count + 1);
+  }
+  if (length > req_length) {
+    // drop the prefetched tail; it is cached now
+    bufferlist head;
+    head.substr_of(bl, 0, std::min<uint64_t>(req_length, bl.length()));
+    bl = std::move(head);
   }
   r = bl.length();
   if (retry_count) {
@@ -12267,6 +12762,40 @@ int BlueStore::_verify_csum(OnodeRef& o,
   return r;
 }
 
+int BlueStore::_verify_csum_batch(OnodeRef& o,
+				  blobs2read_t& blobs2read) const
+{
+  std::vector<Checksummer::verify_item_t> items;
+  std::vector<std::pair<const bluestore_blob_t*, const read_req_t*>> reqs;
+  for (auto& [bptr, r2r] : blobs2read) {
+    const bluestore_blob_t& blob = bptr->get_blob();
+    if (blob.is_compressed() || !blob.has_csum()) {
+      continue;
+    }
+    for (auto& req : r2r) {
+      items.push_back({blob.csum_type, blob.get_csum_chunk_size(),
+		       req.r_off, &req.bl, &blob.csum_data});
+      reqs.emplace_back(&blob, &req);
+    }
+  }
+  auto start = mono_clock::now();
+  size_t bad_item;
+  int bad;
+  uint64_t bad_csum;
+  int r = Checksummer::verify_batch(items, &bad_item, &bad, &bad_csum);
+  log_latency(__func__,
+    l_bluestore_csum_lat,
+    mono_clock::now() - start,
+    cct->_conf->bluestore_log_op_age);
+  if (r < 0) {
+    // redo the failed one for the full report
+    auto [blob, req] = reqs[bad_item];
+    r = _verify_csum(o, blob, req->r_off, req->bl,
+		     req->regs.front().logical_offset);
+  }
+  return r;
+}
+
 int BlueStore::_decompress(bufferlist& source, bufferlist* result)
 {
   int r = 0;
@@ -12274,9 +12803,16 @@ int BlueStore::_decompress(bufferlist& source, bufferlist* result)
   auto i = source.cbegin();
   bluestore_compression_header_t chdr;
   decode(chdr, i);
-  int alg = int(chdr.type);
+  int alg = chdr.get_alg();
   CompressorRef cp = compressor;
-  if (!cp || (int)cp->get_type() != alg) {
+  if (chdr.has_dictionary()) {
+    cp = compression_dicts ? compression_dicts->find(chdr.dict_id) : nullptr;
+    if (!cp) {
+      derr << __func__ << " no compression dictionary " << chdr.dict_id
+	   << dendl;
+      return -EIO;
+    }
+  } else if (!cp || (int)cp->get_type() != alg) {
     cp = Compressor::create(cct, alg);
   }
 
@@ -12848,10 +13384,12 @@ int BlueStore::_collection_list(
     const KeyValueDB::IteratorBounds bounds = KeyValueDB::IteratorBounds{std::move(kv_low_key), std::move(kv_high_key)};
     if (legacy) {
       it = std::make_unique<SimpleCollectionListIterator>(
-              cct, db->get_iterator(PREFIX_OBJ, 0, std::move(bounds)));
+              cct, db->get_iterator(PREFIX_OBJ, KeyValueDB::ITERATOR_SCAN,
+                                    std::move(bounds)));
     } else {
       it = std::make_unique<SortedCollectionListIterator>(
-              db->get_iterator(PREFIX_OBJ, 0, std::move(bounds)));
+              db->get_iterator(PREFIX_OBJ, KeyValueDB::ITERATOR_SCAN,
+                               std::move(bounds)));
     }
     it->lower_bound(low);
     while (it->valid()) {
@@ -13069,14 +13607,22 @@ int BlueStore::omap_get_values(
     const string& prefix = o->get_omap_prefix();
     o->get_omap_key(string(), &final_key);
     size_t base_key_len = final_key.size();
-    for (set<string>::const_iterator p = keys.begin(); p != keys.end(); ++p) {
+    vector<string> final_keys;
+    final_keys.reserve(keys.size());
+    for (auto& k : keys) {
       final_key.resize(base_key_len); // keep prefix
-      final_key += *p;
-      bufferlist val;
-      if (db->get(prefix, final_key, &val) >= 0) {
-	dout(30) << __func__ << "  got " << pretty_binary_string(final_key)
+      final_key += k;
+      final_keys.push_back(final_key);
+    }
+    // one batched lookup instead of a point get per key
+    vector<std::optional<bufferlist>> vals;
+    db->get_multi(prefix, final_keys, &vals);
+    auto p = keys.begin();
+    for (size_t i = 0; i < final_keys.size(); ++i, ++p) {
+      if (vals[i]) {
+	dout(30) << __func__ << "  got " << pretty_binary_string(final_keys[i])
 		 << " -> " << *p << dendl;
-	out->insert(make_pair(*p, val));
+	out->emplace_hint(out->end(), *p, std::move(*vals[i]));
       }
     }
   }
@@ -13165,16 +13711,23 @@ int BlueStore::omap_check_keys(
     const string& prefix = o->get_omap_prefix();
     o->get_omap_key(string(), &final_key);
     size_t base_key_len = final_key.size();
-    for (set<string>::const_iterator p = keys.begin(); p != keys.end(); ++p) {
+    vector<string> final_keys;
+    final_keys.reserve(keys.size());
+    for (auto& k : keys) {
       final_key.resize(base_key_len); // keep prefix
-      final_key += *p;
-      bufferlist val;
-      if (db->get(prefix, final_key, &val) >= 0) {
-	dout(30) << __func__ << "  have " << pretty_binary_string(final_key)
+      final_key += k;
+      final_keys.push_back(final_key);
+    }
+    vector<std::optional<bufferlist>> vals;
+    db->get_multi(prefix, final_keys, &vals);
+    auto p = keys.begin();
+    for (size_t i = 0; i < final_keys.size(); ++i, ++p) {
+      if (vals[i]) {
+	dout(30) << __func__ << "  have " << pretty_binary_string(final_keys[i])
 		 << " -> " << *p << dendl;
 	out->insert(*p);
       } else {
-	dout(30) << __func__ << "  miss " << pretty_binary_string(final_key)
+	dout(30) << __func__ << "  miss " << pretty_binary_string(final_keys[i])
 		 << " -> " << *p << dendl;
       }
     }
@@ -13211,7 +13764,9 @@ ObjectMap::ObjectMapIterator BlueStore::get_omap_iterator(
     bounds.lower_bound = std::move(lower_bound);
     bounds.upper_bound = std::move(upper_bound);
   }
-  KeyValueDB::Iterator it = db->get_iterator(o->get_omap_prefix(), 0, std::move(bounds));
+  KeyValueDB::Iterator it = db->get_iterator(o->get_omap_prefix(),
+                                             KeyValueDB::ITERATOR_SCAN,
+                                             std::move(bounds));
   return ObjectMap::ObjectMapIterator(new OmapIteratorImpl(logger,c, o, it));
 }
 
@@ -13603,6 +14158,22 @@ void BlueStore::_txc_state_proc(TransContext *txc)
 	  _txc_apply_kv(txc, true);
 	}
       }
+      if (auto shard = _kv_sync_shard_of(txc->osr.get()); shard) {
+	std::lock_guard l(shard->lock);
+	shard->queue.push_back(txc);
+	if (!shard->in_progress) {
+	  shard->in_progress = true;
+	  shard->cond.notify_one();
+	}
+	if (txc->get_state() != TransContext::STATE_KV_SUBMITTED) {
+	  shard->queue_unsubmitted.push_back(txc);
+	  ++txc->osr->kv_committing_serially;
+	}
+	if (txc->had_ios)
+	  shard->ios++;
+	shard->throttle_costs += txc->cost;
+	return;
+      }
       {
 	std::lock_guard l(kv_lock);
 	kv_queue.push_back(txc);
@@ -13779,18 +14350,9 @@ void BlueStore::_txc_finalize_kv(TransContext *txc, KeyValueDB::Transaction t)
     }
 
     // update freelist with non-overlap sets
-    for (interval_set<uint64_t>::iterator p = pallocated->begin();
-	 p != pallocated->end();
-	 ++p) {
-      fm->allocate(p.get_start(), p.get_len(), t);
-    }
-    for (interval_set<uint64_t>::iterator p = preleased->begin();
-	 p != preleased->end();
-	 ++p) {
-      dout(20) << __func__ << " release 0x" << std::hex << p.get_start()
-	       << "~" << p.get_len() << std::dec << dendl;
-      fm->release(p.get_start(), p.get_len(), t);
-    }
+    dout(20) << __func__ << " allocate 0x" << std::hex << *pallocated
+	     << " release 0x" << *preleased << std::dec << dendl;
+    fm->update(*pallocated, *preleased, t);
   }
 
   _txc_update_store_statfs(txc);
@@ -13853,7 +14415,8 @@ void BlueStore::_txc_committed_kv(TransContext *txc)
     if (txc->ch->commit_queue) {
       txc->ch->commit_queue->queue(txc->oncommits);
     } else {
-      finisher.queue(txc->oncommits);
+      finisher.queue(reinterpret_cast<uintptr_t>(txc->osr.get()),
+		     txc->oncommits);
     }
   }
   throttle.log_state_latency(*txc, logger, l_bluestore_state_kv_committing_lat);
@@ -13968,6 +14531,7 @@ void BlueStore::_txc_release_alloc(TransContext *txc)
   if (!discard_queued) {
       dout(10) << __func__ << "(sync) " << txc << " " << std::hex
                << txc->released << std::dec << dendl;
+      alloc->trace_release(txc->released);
       alloc->release(txc->released);
   }
 
@@ -14132,8 +14696,33 @@ void BlueStore::_kv_start()
   dout(10) << __func__ << dendl;
 
   finisher.start();
+  if (auto n = cct->_conf.get_val<uint64_t>("bluestore_compression_threads");
+      n > 0) {
+    compress_tp = std::make_unique<ThreadPool>(
+      cct, "BlueStore::compress_tp", "bstore_compr", n);
+    compress_wq = std::make_unique<ContextWQ>(
+      "BlueStore::compress_wq", ceph::timespan::zero(), compress_tp.get());
+    compress_tp->start();
+  }
   kv_sync_thread.create("bstore_kv_sync");
   kv_finalize_thread.create("bstore_kv_final");
+
+  ceph_assert(kv_sync_shards.empty());
+  auto num_shards =
+    cct->_conf.get_val<uint64_t>("bluestore_kv_sync_shards");
+  if (num_shards > 1) {
+    dout(1) << __func__ << " using " << num_shards
+	    << " kv sync shards" << dendl;
+    {
+      std::lock_guard l(kv_max_lock);
+      kv_nid_max_submitted = nid_max;
+      kv_blobid_max_submitted = blobid_max;
+    }
+    for (uint32_t i = 1; i < num_shards; ++i) {
+      kv_sync_shards.emplace_back(std::make_unique<KVSyncShard>(this, i));
+      kv_sync_shards.back()->thread.create("bstore_kv_sync");
+    }
+  }
 }
 
 void BlueStore::_kv_stop()
@@ -14147,6 +14736,17 @@ void BlueStore::_kv_stop()
     kv_stop = true;
     kv_cond.notify_all();
   }
+  for (auto& shard : kv_sync_shards) {
+    std::unique_lock l{shard->lock};
+    while (!shard->started) {
+      shard->cond.wait(l);
+    }
+    shard->stop = true;
+    shard->cond.notify_all();
+  }
+  for (auto& shard : kv_sync_shards) {
+    shard->thread.join();
+  }
   {
     std::unique_lock l{kv_finalize_lock};
     while (!kv_finalize_started) {
@@ -14157,6 +14757,7 @@ void BlueStore::_kv_stop()
   }
   kv_sync_thread.join();
   kv_finalize_thread.join();
+  kv_sync_shards.clear();
   ceph_assert(removed_collections.empty());
   {
     std::lock_guard l(kv_lock);
@@ -14169,6 +14770,12 @@ void BlueStore::_kv_stop()
   dout(10) << __func__ << " stopping finishers" << dendl;
   finisher.wait_for_empty();
   finisher.stop();
+  if (compress_tp) {
+    compress_wq->drain();
+    compress_tp->stop();
+    compress_wq.reset();
+    compress_tp.reset();
+  }
   dout(10) << __func__ << " stopped" << dendl;
 }
 
@@ -14286,7 +14893,9 @@ void BlueStore::_kv_sync_thread()
       // it.  in either case, we increase the max in the earlier txn
       // we submit.
       uint64_t new_nid_max = 0, new_blobid_max = 0;
-      if (nid_last + cct->_conf->bluestore_nid_prealloc/2 > nid_max) {
+      if (!kv_sync_shards.empty()) {
+	_kv_sync_sharded_reserve_max(&new_nid_max, &new_blobid_max);
+      } else if (nid_last + cct->_conf->bluestore_nid_prealloc/2 > nid_max) {
 	KeyValueDB::Transaction t =
 	  kv_submitting.empty() ? synct : kv_submitting.front()->t;
 	new_nid_max = nid_last + cct->_conf->bluestore_nid_prealloc;
@@ -14295,7 +14904,9 @@ void BlueStore::_kv_sync_thread()
 	t->set(PREFIX_SUPER, "nid_max", bl);
 	dout(10) << __func__ << " new_nid_max " << new_nid_max << dendl;
       }
-      if (blobid_last + cct->_conf->bluestore_blobid_prealloc/2 > blobid_max) {
+      if (!kv_sync_shards.empty()) {
+	// handled by _kv_sync_sharded_reserve_max() above
+      } else if (blobid_last + cct->_conf->bluestore_blobid_prealloc/2 > blobid_max) {
 	KeyValueDB::Transaction t =
 	  kv_submitting.empty() ? synct : kv_submitting.front()->t;
 	new_blobid_max = blobid_last + cct->_conf->bluestore_blobid_prealloc;
@@ -14375,41 +14986,21 @@ void BlueStore::_kv_sync_thread()
       }
 #endif
 
-      {
-	std::unique_lock m{kv_finalize_lock};
-	if (kv_committing_to_finalize.empty()) {
-	  kv_committing_to_finalize.swap(kv_committing);
-	} else {
-	  kv_committing_to_finalize.insert(
-	      kv_committing_to_finalize.end(),
-	      kv_committing.begin(),
-	      kv_committing.end());
-	  kv_committing.clear();
-	}
-	if (deferred_stable_to_finalize.empty()) {
-	  deferred_stable_to_finalize.swap(deferred_stable);
-	} else {
-	  deferred_stable_to_finalize.insert(
-	      deferred_stable_to_finalize.end(),
-	      deferred_stable.begin(),
-	      deferred_stable.end());
-	  deferred_stable.clear();
+      _kv_sync_queue_finalize(kv_committing, deferred_stable);
+
+      if (!kv_sync_shards.empty()) {
+	_kv_sync_sharded_commit_max(new_nid_max, new_blobid_max);
+      } else {
+	if (new_nid_max) {
+	  nid_max = new_nid_max;
+	  dout(10) << __func__ << " nid_max now " << nid_max << dendl;
 	}
-	if (!kv_finalize_in_progress) {
-	  kv_finalize_in_progress = true;
-	  kv_finalize_cond.notify_one();
+	if (new_blobid_max) {
+	  blobid_max = new_blobid_max;
+	  dout(10) << __func__ << " blobid_max now " << blobid_max << dendl;
 	}
       }
 
-      if (new_nid_max) {
-	nid_max = new_nid_max;
-	dout(10) << __func__ << " nid_max now " << nid_max << dendl;
-      }
-      if (new_blobid_max) {
-	blobid_max = new_blobid_max;
-	dout(10) << __func__ << " blobid_max now " << blobid_max << dendl;
-      }
-
       {
 	auto finish = mono_clock::now();
 	ceph::timespan dur_flush = after_flush - start;
@@ -14444,6 +15035,199 @@ void BlueStore::_kv_sync_thread()
   kv_sync_started = false;
 }
 
+void BlueStore::_kv_sync_queue_finalize(
+  deque<TransContext*>& committed,
+  deque<DeferredBatch*>& deferred_stable)
+{
+  std::unique_lock m{kv_finalize_lock};
+  if (kv_committing_to_finalize.empty()) {
+    kv_committing_to_finalize.swap(committed);
+  } else {
+    kv_committing_to_finalize.insert(
+      kv_committing_to_finalize.end(),
+      committed.begin(),
+      committed.end());
+    committed.clear();
+  }
+  if (deferred_stable_to_finalize.empty()) {
+    deferred_stable_to_finalize.swap(deferred_stable);
+  } else {
+    deferred_stable_to_finalize.insert(
+      deferred_stable_to_finalize.end(),
+      deferred_stable.begin(),
+      deferred_stable.end());
+    deferred_stable.clear();
+  }
+  if (!kv_finalize_in_progress) {
+    kv_finalize_in_progress = true;
+    kv_finalize_cond.notify_one();
+  }
+}
+
+BlueStore::KVSyncShard *BlueStore::_kv_sync_shard_of(const OpSequencer *osr)
+{
+  if (kv_sync_shards.empty()) {
+    return nullptr;
+  }
+  // shard 0 is the main kv_sync_thread
+  uint32_t idx = osr->get_sequencer_id() % (kv_sync_shards.size() + 1);
+  return idx ? kv_sync_shards[idx - 1].get() : nullptr;
+}
+
+void BlueStore::_kv_sync_sharded_reserve_max(
+  uint64_t *new_nid_max,
+  uint64_t *new_blobid_max)
+{
+  // With several kv sync pipelines the {nid,blobid}_max keys may be
+  // updated concurrently.  Submit each bump as a standalone transaction
+  // while holding kv_max_lock so that the values land in the WAL in
+  // increasing order; the caller's subsequent sync commit makes them
+  // durable before any txc relying on them is acknowledged.
+  std::lock_guard l(kv_max_lock);
+  KeyValueDB::Transaction t;
+  if (nid_last + cct->_conf->bluestore_nid_prealloc/2 > nid_max) {
+    *new_nid_max = std::max<uint64_t>(
+      nid_last + cct->_conf->bluestore_nid_prealloc,
+      kv_nid_max_submitted);
+    kv_nid_max_submitted = *new_nid_max;
+    t = db->get_transaction();
+    bufferlist bl;
+    encode(*new_nid_max, bl);
+    t->set(PREFIX_SUPER, "nid_max", bl);
+    dout(10) << __func__ << " new_nid_max " << *new_nid_max << dendl;
+  }
+  if (blobid_last + cct->_conf->bluestore_blobid_prealloc/2 > blobid_max) {
+    *new_blobid_max = std::max<uint64_t>(
+      blobid_last + cct->_conf->bluestore_blobid_prealloc,
+      kv_blobid_max_submitted);
+    kv_blobid_max_submitted = *new_blobid_max;
+    if (!t) {
+      t = db->get_transaction();
+    }
+    bufferlist bl;
+    encode(*new_blobid_max, bl);
+    t->set(PREFIX_SUPER, "blobid_max", bl);
+    dout(10) << __func__ << " new_blobid_max " << *new_blobid_max << dendl;
+  }
+  if (t && !db_was_opened_read_only &&
+      !cct->_conf->bluestore_debug_omit_kv_commit) {
+    int r = db->submit_transaction(t);
+    ceph_assert(r == 0);
+  }
+}
+
+void BlueStore::_kv_sync_sharded_commit_max(
+  uint64_t new_nid_max,
+  uint64_t new_blobid_max)
+{
+  if (!new_nid_max && !new_blobid_max) {
+    return;
+  }
+  std::lock_guard l(kv_max_lock);
+  if (new_nid_max > nid_max) {
+    nid_max = new_nid_max;
+    dout(10) << __func__ << " nid_max now " << nid_max << dendl;
+  }
+  if (new_blobid_max > blobid_max) {
+    blobid_max = new_blobid_max;
+    dout(10) << __func__ << " blobid_max now " << blobid_max << dendl;
+  }
+}
+
+void BlueStore::_kv_sync_shard_thread(KVSyncShard *shard)
+{
+  dout(10) << __func__ << " shard " << shard->id << " start" << dendl;
+  std::unique_lock l{shard->lock};
+  ceph_assert(!shard->started);
+  shard->started = true;
+  shard->cond.notify_all();
+
+  while (true) {
+    if (shard->queue.empty()) {
+      if (shard->stop)
+	break;
+      dout(20) << __func__ << " shard " << shard->id << " sleep" << dendl;
+      shard->in_progress = false;
+      shard->cond.wait(l);
+      dout(20) << __func__ << " shard " << shard->id << " wake" << dendl;
+      continue;
+    }
+
+    deque<TransContext*> committing, submitting;
+    committing.swap(shard->queue);
+    submitting.swap(shard->queue_unsubmitted);
+    uint64_t aios = shard->ios;
+    uint64_t costs = shard->throttle_costs;
+    shard->ios = 0;
+    shard->throttle_costs = 0;
+    l.unlock();
+
+    dout(20) << __func__ << " shard " << shard->id
+	     << " committing " << committing.size()
+	     << " submitting " << submitting.size() << dendl;
+
+    auto start = mono_clock::now();
+    if (aios) {
+      // make data ios stable before the metadata referencing them
+      bdev->flush();
+    }
+    auto after_flush = mono_clock::now();
+
+    uint64_t new_nid_max = 0, new_blobid_max = 0;
+    _kv_sync_sharded_reserve_max(&new_nid_max, &new_blobid_max);
+
+    for (auto txc : committing) {
+      throttle.log_state_latency(*txc, logger, l_bluestore_state_kv_queued_lat);
+      if (txc->get_state() == TransContext::STATE_KV_QUEUED) {
+	_txc_apply_kv(txc, false);
+	--txc->osr->kv_committing_serially;
+      } else {
+	ceph_assert(txc->get_state() == TransContext::STATE_KV_SUBMITTED);
+      }
+      if (txc->had_ios) {
+	--txc->osr->txc_with_unstable_io;
+      }
+    }
+    throttle.release_kv_throttle(costs);
+
+    KeyValueDB::Transaction synct = db->get_transaction();
+    int r = db_was_opened_read_only || cct->_conf->bluestore_debug_omit_kv_commit ?
+      0 : db->submit_transaction_sync(synct);
+    ceph_assert(r == 0);
+
+    int committing_size = committing.size();
+    deque<DeferredBatch*> no_deferred;
+    _kv_sync_queue_finalize(committing, no_deferred);
+    _kv_sync_sharded_commit_max(new_nid_max, new_blobid_max);
+
+    {
+      auto finish = mono_clock::now();
+      ceph::timespan dur_flush = after_flush - start;
+      ceph::timespan dur_kv = finish - after_flush;
+      dout(20) << __func__ << " shard " << shard->id
+	       << " committed " << committing_size
+	       << " in " << (finish - start)
+	       << " (" << dur_flush << " flush + " << dur_kv << " kv commit)"
+	       << dendl;
+      log_latency("kv_flush",
+	l_bluestore_kv_flush_lat,
+	dur_flush,
+	cct->_conf->bluestore_log_op_age);
+      log_latency("kv_commit",
+	l_bluestore_kv_commit_lat,
+	dur_kv,
+	cct->_conf->bluestore_log_op_age);
+      log_latency("kv_sync",
+	l_bluestore_kv_sync_lat,
+	finish - start,
+	cct->_conf->bluestore_log_op_age);
+    }
+    l.lock();
+  }
+  dout(10) << __func__ << " shard " << shard->id << " finish" << dendl;
+  shard->started = false;
+}
+
 void BlueStore::_kv_finalize_thread()
 {
   deque<TransContext*> kv_committed;
@@ -14587,19 +15371,24 @@ void BlueStore::deferred_try_submit()
     }
   }
 
-  for (auto& osr : osrs) {
-    osr->deferred_lock.lock();
-    if (osr->deferred_pending) {
-      if (!osr->deferred_running) {
-	_deferred_submit_unlock(osr.get());
+  if (osrs.size() > 1 &&
+      cct->_conf.get_val<bool>("bluestore_deferred_aggregate")) {
+    _deferred_submit_aggregated(osrs);
+  } else {
+    for (auto& osr : osrs) {
+      osr->deferred_lock.lock();
+      if (osr->deferred_pending) {
+	if (!osr->deferred_running) {
+	  _deferred_submit_unlock(osr.get());
+	} else {
+	  osr->deferred_lock.unlock();
+	  dout(20) << __func__ << "  osr " << osr << " already has running"
+		   << dendl;
+	}
       } else {
 	osr->deferred_lock.unlock();
-	dout(20) << __func__ << "  osr " << osr << " already has running"
-		 << dendl;
+	dout(20) << __func__ << "  osr " << osr << " has no pending" << dendl;
       }
-    } else {
-      osr->deferred_lock.unlock();
-      dout(20) << __func__ << "  osr " << osr << " has no pending" << dendl;
     }
   }
 
@@ -14666,6 +15455,96 @@ void BlueStore::_deferred_submit_unlock(OpSequencer *osr)
   bdev->aio_submit(&b->ioc);
 }
 
+void BlueStore::_deferred_submit_aggregated(
+  const vector<OpSequencerRef>& osrs)
+{
+  uint64_t max_bytes =
+    cct->_conf.get_val<Option::size_t>("bluestore_deferred_aggregate_max_bytes");
+  DeferredGroup *g = nullptr;
+  interval_set<uint64_t> extents; ///< device ranges written by g
+  for (auto& osr : osrs) {
+    osr->deferred_lock.lock();
+    if (!osr->deferred_pending || osr->deferred_running) {
+      osr->deferred_lock.unlock();
+      dout(20) << __func__ << "  osr " << osr << " has no pending or running"
+	       << dendl;
+      continue;
+    }
+    auto b = osr->deferred_pending;
+    deferred_queue_size -= b->seq_bytes.size();
+    ceph_assert(deferred_queue_size >= 0);
+    osr->deferred_running = osr->deferred_pending;
+    osr->deferred_pending = nullptr;
+    osr->deferred_lock.unlock();
+
+    for (auto& txc : b->txcs) {
+      throttle.log_state_latency(txc, logger, l_bluestore_state_deferred_queued_lat);
+    }
+    interval_set<uint64_t> be;
+    bool overlap = false;
+    for (auto& [off, io] : b->iomap) {
+      be.insert(off, io.bl.length());
+      overlap = overlap || extents.intersects(off, io.bl.length());
+    }
+    // ios in one group must not overlap, otherwise their order on the
+    // device would be undefined; start a new window instead
+    if (g && (overlap ||
+	      (max_bytes && extents.size() + be.size() > max_bytes))) {
+      _deferred_submit_group(g);
+      g = nullptr;
+      extents.clear();
+    }
+    if (!g) {
+      g = new DeferredGroup(cct);
+    }
+    g->batches.push_back(b);
+    extents.union_of(be);
+    for (auto& [off, io] : b->iomap) {
+      g->iomap[off].claim_append(io.bl);
+    }
+  }
+  if (g) {
+    _deferred_submit_group(g);
+  }
+}
+
+void BlueStore::_deferred_submit_group(DeferredGroup *g)
+{
+  dout(10) << __func__ << " " << g->batches.size() << " batches, "
+	   << g->iomap.size() << " ios" << dendl;
+  uint64_t start = 0, pos = 0;
+  bufferlist bl;
+  auto i = g->iomap.begin();
+  while (true) {
+    if (i == g->iomap.end() || i->first != pos) {
+      if (bl.length()) {
+	dout(20) << __func__ << " write 0x" << std::hex
+		 << start << "~" << bl.length() << std::dec << dendl;
+	if (!g_conf()->bluestore_debug_omit_block_device_write) {
+	  logger->inc(l_bluestore_submitted_deferred_writes);
+	  logger->inc(l_bluestore_submitted_deferred_write_bytes, bl.length());
+	  int r = bdev->aio_write(start, bl, &g->ioc, false);
+	  ceph_assert(r == 0);
+	}
+      }
+      if (i == g->iomap.end()) {
+	break;
+      }
+      pos = i->first;
+      bl.clear();
+    }
+    if (!bl.length()) {
+      start = pos;
+    }
+    pos += i->second.length();
+    bl.claim_append(i->second);
+    ++i;
+  }
+  g->iomap.clear();
+
+  bdev->aio_submit(&g->ioc);
+}
+
 struct C_DeferredTrySubmit : public Context {
   BlueStore *store;
   C_DeferredTrySubmit(BlueStore *s) : store(s) {}
@@ -14953,7 +15832,7 @@ int BlueStore::queue_transactions(
     if (c->commit_queue) {
       c->commit_queue->queue(on_applied);
     } else {
-      finisher.queue(on_applied);
+      finisher.queue(reinterpret_cast<uintptr_t>(c->osr.get()), on_applied);
     }
   }
 
@@ -16166,6 +17045,42 @@ void BlueStore::_do_write_big(
   }
 }
 
+void BlueStore::_compress_blobs(
+  CompressorRef& c,
+  const std::vector<const bufferlist*>& in,
+  std::vector<compress_result_t>* out)
+{
+  out->resize(in.size());
+  if (!compress_wq || in.size() < 2) {
+    for (size_t i = 0; i < in.size(); ++i) {
+      auto& res = (*out)[i];
+      // FIXME: memory alignment here is bad
+      res.r = c->compress(*in[i], res.bl, res.compressor_message);
+    }
+    return;
+  }
+  // hand all but the first blob to the pool and do that one ourselves
+  // while waiting
+  ceph::mutex lock = ceph::make_mutex("BlueStore::_compress_blobs::lock");
+  ceph::condition_variable cond;
+  size_t pending = in.size() - 1;
+  for (size_t i = 1; i < in.size(); ++i) {
+    compress_wq->queue(new LambdaContext([&, i](int) {
+      auto& res = (*out)[i];
+      res.r = c->compress(*in[i], res.bl, res.compressor_message);
+      std::lock_guard l(lock);
+      if (--pending == 0) {
+	cond.notify_one();
+      }
+    }));
+  }
+  auto& res = out->front();
+  res.r = c->compress(*in[0], res.bl, res.compressor_message);
+  std::unique_lock l(lock);
+  cond.wait(l, [&] { return pending == 0; });
+  dout(20) << __func__ << " compressed " << in.size() << " blobs" << dendl;
+}
+
 int BlueStore::_do_alloc_write(
   TransContext *txc,
   CollectionRef coll,
@@ -16245,19 +17160,53 @@ int BlueStore::_do_alloc_write(
   // We assume that allocator does its best to provide contiguous space,
   // and the condition is : (data_size < deferred).
 
+  std::vector<const bufferlist*> to_compress;
+  std::vector<compress_result_t> compressed;
+  // writes of small blobs use the pool's dictionary, or train one
+  uint32_t dict_id = 0;
+  CompressorRef dict_c;
+  bool dict_sample = false;
+  if (c) {
+    uint64_t max_blob = 0;
+    for (auto& wi : wctx->writes) {
+      if (wi.blob_length > min_alloc_size) {
+	ceph_assert(wi.b_off == 0);
+	ceph_assert(wi.blob_length == wi.bl.length());
+	to_compress.push_back(&wi.bl);
+	max_blob = std::max<uint64_t>(max_blob, wi.blob_length);
+      }
+    }
+    if (!to_compress.empty() && compression_dicts &&
+	cct->_conf.get_val<bool>("bluestore_compression_dictionary") &&
+	max_blob <= cct->_conf.get_val<Option::size_t>(
+	  "bluestore_compression_dictionary_max_blob_size")) {
+      std::tie(dict_id, dict_c) = compression_dicts->get(coll->pool(), c);
+      dict_sample = !dict_c;
+    }
+    if (!to_compress.empty()) {
+      auto start = mono_clock::now();
+      _compress_blobs(dict_c ? dict_c : c, to_compress, &compressed);
+      log_latency("compress@_do_alloc_write",
+	l_bluestore_compress_lat,
+	mono_clock::now() - start,
+	cct->_conf->bluestore_log_op_age );
+    }
+    if (dict_sample) {
+      for (auto bl : to_compress) {
+	compression_dicts->sample(coll->pool(), c, *bl);
+      }
+    }
+  }
+
   auto max_bsize = std::max(wctx->target_blob_size, min_alloc_size);
+  auto cr = compressed.begin();
   for (auto& wi : wctx->writes) {
     if (c && wi.blob_length > min_alloc_size) {
-      auto start = mono_clock::now();
-
-      // compress
-      ceph_assert(wi.b_off == 0);
-      ceph_assert(wi.blob_length == wi.bl.length());
-
-      // FIXME: memory alignment here is bad
-      bufferlist t;
-      std::optional<int32_t> compressor_message;
-      int r = c->compress(wi.bl, t, compressor_message);
+      ceph_assert(cr != compressed.end());
+      bufferlist& t = cr->bl;
+      std::optional<int32_t>& compressor_message = cr->compressor_message;
+      int r = cr->r;
+      ++cr;
       uint64_t want_len_raw = wi.blob_length * crr;
       uint64_t want_len = p2roundup(want_len_raw, min_alloc_size);
       bool rejected = false;
@@ -16268,6 +17217,10 @@ int BlueStore::_do_alloc_write(
       if (r == 0 && result_len <= want_len && result_len < wi.blob_length) {
 	bluestore_compression_header_t chdr;
 	chdr.type = c->get_type();
+	if (dict_c) {
+	  chdr.type |= bluestore_compression_header_t::FLAG_DICTIONARY;
+	  chdr.dict_id = dict_id;
+	}
 	chdr.length = t.length();
 	chdr.compressor_message = compressor_message;
 	encode(chdr, wi.compressed_bl);
@@ -16321,10 +17274,6 @@ int BlueStore::_do_alloc_write(
 	need += wi.blob_length;
 	data_size += wi.bl.length();
       }
-      log_latency("compress@_do_alloc_write",
-	l_bluestore_compress_lat,
-        mono_clock::now() - start,
-	cct->_conf->bluestore_log_op_age );
     } else {
       need += wi.blob_length;
       data_size += wi.bl.length();
@@ -16337,6 +17286,7 @@ int BlueStore::_do_alloc_write(
   prealloc_left = alloc->allocate(
     need, min_alloc_size, need,
     0, &prealloc);
+  alloc->trace_allocate(need, min_alloc_size, need, 0, prealloc);
   log_latency("allocator@_do_alloc_write",
     l_bluestore_allocator_lat,
     mono_clock::now() - start,
@@ -16348,6 +17298,7 @@ int BlueStore::_do_alloc_write(
          << " available 0x " << alloc->get_free()
          << std::dec << dendl;
     if (prealloc.size()) {
+      alloc->trace_release(prealloc);
       alloc->release(prealloc);
     }
     return -ENOSPC;
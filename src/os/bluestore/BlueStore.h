@@ -53,6 +53,7 @@
 
 #include "bluestore_types.h"
 #include "BlueFS.h"
+#include "CompressionDictionaries.h"
 #include "common/EventTrace.h"
 
 #ifdef WITH_BLKIN
@@ -113,6 +114,7 @@ enum {
   l_bluestore_read_eio,
   l_bluestore_reads_with_retries,
   l_bluestore_read_lat,
+  l_bluestore_readahead_bytes,
   //****************************************
 
   // kv_thread latencies
@@ -169,6 +171,8 @@ enum {
   l_bluestore_onode_misses,
   l_bluestore_onode_shard_hits,
   l_bluestore_onode_shard_misses,
+  l_bluestore_onode_shard_compacted,
+  l_bluestore_onode_priority_retained,
   l_bluestore_extents,
   l_bluestore_blobs,
   //****************************************
@@ -228,6 +232,12 @@ enum {
   l_bluestore_slow_read_onode_meta_count,
   l_bluestore_slow_read_wait_aio_count,
   //****************************************
+
+  // online fsck
+  //****************************************
+  l_bluestore_online_fsck_objects,
+  l_bluestore_online_fsck_errors,
+  //****************************************
   l_bluestore_last
 };
 
@@ -962,6 +972,10 @@ public:
       unsigned extents = 0;  ///< count extents in this shard
       bool loaded = false;   ///< true if shard is loaded
       bool dirty = false;    ///< true if shard is dirty and needs reencoding
+      /// encoded copy of a clean shard, kept when onode cache compaction
+      /// is enabled so that an unloaded shard can be re-decoded without
+      /// going to the kv store
+      ceph::buffer::list encoded;
     };
 
     mempool::bluestore_cache_meta::vector<Shard> shards;    ///< shards
@@ -1140,6 +1154,11 @@ public:
     /// ensure a range of the map is marked dirty
     void dirty_range(uint32_t offset, uint32_t length);
 
+    /// drop the decoded extents of clean shards that have an encoded
+    /// copy; they are decoded again on the next fault_range().
+    /// returns the number of shards unloaded.
+    unsigned compact_shards();
+
     /// for seek_lextent test
     extent_map_t::iterator find(uint64_t offset);
 
@@ -1327,6 +1346,13 @@ public:
     bool cached;              ///< Onode is logically in the cache
                               /// (it can be pinned and hence physically out
                               /// of it at the moment though)
+    uint8_t cache_credits = 0; ///< extra lru passes before eviction, from
+                               /// the pool's cache_priority
+
+    // sequential read detection, see _get_readahead_end()
+    std::atomic<uint64_t> readahead_next = {UINT64_MAX}; ///< expected offset
+    std::atomic<uint64_t> readahead_end = {0};    ///< end of prefetched data
+    std::atomic<uint32_t> readahead_window = {0}; ///< current window, bytes
     ExtentMap extent_map;
 
     // track txc's that have not been committed to kv store (and whose
@@ -1641,6 +1667,8 @@ private:
 
     //pool options
     pool_opts_t pool_opts;
+    /// pool cache_priority, readable without the collection lock
+    std::atomic<uint8_t> cache_priority = {0};
     ContextQueue *commit_queue;
 
     OnodeCacheShard* get_onode_cache() const {
@@ -2114,6 +2142,24 @@ private:
     }
   };
 
+  /// deferred batches of several sequencers submitted as one set of ios
+  struct DeferredGroup final : public AioContext {
+    std::vector<DeferredBatch*> batches;
+    /// merged ios, by device offset
+    std::map<uint64_t,ceph::buffer::list> iomap;
+    IOContext ioc;
+
+    explicit DeferredGroup(CephContext *cct)
+      : ioc(cct, this) {}
+
+    void aio_finish(BlueStore *store) override {
+      for (auto b : batches) {
+	store->_deferred_aio_finish(b->osr);
+      }
+      delete this;
+    }
+  };
+
   class OpSequencer : public RefCountedObject {
   public:
     ceph::mutex qlock = ceph::make_mutex("BlueStore::OpSequencer::qlock");
@@ -2273,6 +2319,40 @@ private:
     }
   };
 
+  /// an additional kv commit pipeline (bluestore_kv_sync_shards > 1)
+  ///
+  /// Each OpSequencer is bound to exactly one kv sync pipeline (see
+  /// _kv_sync_shard_of()), so per-sequencer commit order is preserved.
+  /// Shard 0 is always the classic _kv_sync_thread, which keeps sole
+  /// ownership of deferred io cleanup; additional shards only batch,
+  /// submit and sync regular transactions before handing them to the
+  /// common kv_finalize_thread.
+  struct KVSyncShard {
+    struct ShardThread : public Thread {
+      BlueStore *store;
+      KVSyncShard *shard;
+      ShardThread(BlueStore *s, KVSyncShard *sh) : store(s), shard(sh) {}
+      void *entry() override {
+	store->_kv_sync_shard_thread(shard);
+	return NULL;
+      }
+    };
+
+    const uint32_t id;
+    ShardThread thread;
+    ceph::mutex lock = ceph::make_mutex("BlueStore::KVSyncShard::lock");
+    ceph::condition_variable cond;
+    bool started = false;
+    bool stop = false;
+    bool in_progress = false;
+    std::deque<TransContext*> queue;             ///< ready, already submitted
+    std::deque<TransContext*> queue_unsubmitted; ///< ready, need submit by shard
+    uint64_t ios = 0;
+    uint64_t throttle_costs = 0;
+
+    KVSyncShard(BlueStore *s, uint32_t i) : id(i), thread(s, this) {}
+  };
+
   struct BigDeferredWriteContext {
     uint64_t off = 0;     // original logical offset
     uint32_t b_off = 0;   // blob relative offset
@@ -2345,9 +2425,12 @@ private:
   deferred_osr_queue_t deferred_queue; ///< osr's with deferred io pending
   std::atomic_int deferred_queue_size = {0};         ///< num txc's queued across all osrs
   std::atomic_int deferred_aggressive = {0}; ///< aggressive wakeup of kv thread
-  Finisher  finisher;
+  ShardedFinisher finisher;  ///< keyed by OpSequencer
   utime_t  deferred_last_submitted = utime_t();
 
+  std::unique_ptr<ThreadPool> compress_tp;  ///< parallel blob compression
+  std::unique_ptr<ContextWQ> compress_wq;
+
   KVSyncThread kv_sync_thread;
   ceph::mutex kv_lock = ceph::make_mutex("BlueStore::kv_lock");
   ceph::condition_variable kv_cond;
@@ -2369,6 +2452,12 @@ private:
   std::deque<DeferredBatch*> deferred_stable_to_finalize; ///< pending finalization
   bool kv_finalize_in_progress = false;
 
+  std::vector<std::unique_ptr<KVSyncShard>> kv_sync_shards; ///< shards 1..n-1
+  ///< serializes {nid,blobid}_max updates when kv sync is sharded
+  ceph::mutex kv_max_lock = ceph::make_mutex("BlueStore::kv_max_lock");
+  uint64_t kv_nid_max_submitted = 0;    ///< protected by kv_max_lock
+  uint64_t kv_blobid_max_submitted = 0; ///< protected by kv_max_lock
+
   PerfCounters *logger = nullptr;
 
   std::list<CollectionRef> removed_collections;
@@ -2415,6 +2504,7 @@ private:
   std::atomic<Compressor::CompressionMode> comp_mode =
     {Compressor::COMP_NONE}; ///< compression mode
   CompressorRef compressor;
+  std::unique_ptr<CompressionDictionaries> compression_dicts;
   std::atomic<uint64_t> comp_min_blob_size = {0};
   std::atomic<uint64_t> comp_max_blob_size = {0};
 
@@ -2684,6 +2774,38 @@ private:
     void _resize_shards(bool interval_stats);
   } mempool_thread;
 
+  /// background, throttled and resumable consistency checker
+  struct OnlineFsckThread : public Thread {
+    BlueStore *store;
+    ceph::condition_variable cond;
+    ceph::mutex lock = ceph::make_mutex("BlueStore::OnlineFsckThread::lock");
+    bool stop = false;
+
+    explicit OnlineFsckThread(BlueStore *s) : store(s) {}
+    void *entry() override {
+      store->_online_fsck_thread();
+      return nullptr;
+    }
+    void init() {
+      ceph_assert(stop == false);
+      create("bstore_fsck");
+    }
+    void shutdown() {
+      lock.lock();
+      stop = true;
+      cond.notify_all();
+      lock.unlock();
+      join();
+      stop = false;
+    }
+    /// sleep for up to t; false if we are asked to stop
+    bool wait(ceph::timespan t) {
+      std::unique_lock l{lock};
+      cond.wait_for(l, t, [this] { return stop; });
+      return !stop;
+    }
+  } online_fsck_thread;
+
 #ifdef WITH_BLKIN
   ZTracer::Endpoint trace_endpoint {"0.0.0.0", 0, "BlueStore"};
 #endif
@@ -2782,6 +2904,13 @@ private:
 
   CollectionRef _get_collection(const coll_t& cid);
   CollectionRef _get_collection_by_oid(const ghobject_t& oid);
+
+  void _online_fsck_thread();
+  /// check the next batch of objects after *cursor; false at end of pass
+  bool _online_fsck_batch(std::pair<coll_t, ghobject_t>* cursor,
+			  uint64_t max_objects,
+			  uint64_t* objects, uint64_t* errors);
+  int _online_fsck_check_onode(OnodeRef& o);
   void _queue_reap_collection(CollectionRef& c);
   void _reap_collections();
 
@@ -2826,6 +2955,14 @@ private:
   void _kv_stop();
   void _kv_sync_thread();
   void _kv_finalize_thread();
+  KVSyncShard *_kv_sync_shard_of(const OpSequencer *osr);
+  void _kv_sync_shard_thread(KVSyncShard *shard);
+  void _kv_sync_queue_finalize(std::deque<TransContext*>& committed,
+			       std::deque<DeferredBatch*>& deferred_stable);
+  void _kv_sync_sharded_reserve_max(uint64_t *new_nid_max,
+				    uint64_t *new_blobid_max);
+  void _kv_sync_sharded_commit_max(uint64_t new_nid_max,
+				   uint64_t new_blobid_max);
 
   bluestore_deferred_op_t *_get_deferred_op(TransContext *txc, uint64_t len);
   void _deferred_queue(TransContext *txc);
@@ -2833,6 +2970,8 @@ public:
   void deferred_try_submit();
 private:
   void _deferred_submit_unlock(OpSequencer *osr);
+  void _deferred_submit_aggregated(const std::vector<OpSequencerRef>& osrs);
+  void _deferred_submit_group(DeferredGroup *g);
   void _deferred_aio_finish(OpSequencer *osr);
   int _deferred_replay();
   bool _eliminate_outdated_deferred(bluestore_deferred_transaction_t* deferred_txn,
@@ -3119,7 +3258,21 @@ public:
     ceph::buffer::list& bl,
     uint32_t op_flags = 0) override;
 
+  int scrub_read(
+    CollectionHandle &c,
+    const ghobject_t& oid,
+    uint64_t offset,
+    size_t len,
+    uint32_t *crc,
+    uint32_t op_flags = 0) override;
+
 private:
+  /// crc32c of bl, read at offset, from the (verified) blob csums
+  uint32_t _scrub_crc(
+    OnodeRef& o,
+    uint64_t offset,
+    const ceph::buffer::list& bl,
+    uint32_t crc);
 
   // --------------------------------------------------------
   // intermediate data structures used while reading
@@ -3193,6 +3346,10 @@ private:
     bool* csum_error,
     ceph::buffer::list& bl);
 
+  uint64_t _get_readahead_end(
+    Onode *o,
+    uint64_t offset,
+    uint64_t length);
   int _do_read(
     Collection *c,
     OnodeRef& o,
@@ -3504,6 +3661,9 @@ private:
     uint64_t blob_xoffset,
     const ceph::buffer::list& bl,
     uint64_t logical_offset) const;
+  int _verify_csum_batch(
+    OnodeRef& o,
+    blobs2read_t& blobs2read) const;
   int _decompress(ceph::buffer::list& source, ceph::buffer::list* result);
 
 
@@ -3613,6 +3773,15 @@ private:
     uint64_t offset, uint64_t length,
     ceph::buffer::list::iterator& blp,
     WriteContext *wctx);
+  struct compress_result_t {
+    int r = 0;
+    ceph::buffer::list bl;
+    std::optional<int32_t> compressor_message;
+  };
+  void _compress_blobs(
+    CompressorRef& c,
+    const std::vector<const ceph::buffer::list*>& in,
+    std::vector<compress_result_t>* out);
   int _do_alloc_write(
     TransContext *txc,
     CollectionRef c,
@@ -0,0 +1,238 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "CachingAllocator.h"
+
+#include <bit>
+#include <limits>
+
+#include "common/debug.h"
+
+#define dout_context cct
+#define dout_subsys ceph_subsys_bluestore
+#undef  dout_prefix
+#define dout_prefix *_dout << "CachingAllocator(" << this << ") "
+
+CachingAllocator::CachingAllocator(CephContext* cct,
+				   Allocator* backing,
+				   uint64_t chunk_size,
+				   uint64_t max_alloc,
+				   uint64_t shard_max,
+				   unsigned num_shards,
+				   std::string_view name)
+  : Allocator(name, backing->get_capacity(), backing->get_block_size()),
+    cct(cct),
+    backing(backing),
+    chunk_size(round_up_to(std::max<uint64_t>(chunk_size, block_size),
+			   (uint64_t)block_size)),
+    max_alloc(std::min(max_alloc, this->chunk_size)),
+    shard_max(std::max(shard_max, this->chunk_size)),
+    num_shards(num_shards ? num_shards : 1),
+    shards(new shard_t[this->num_shards])
+{
+  ldout(cct, 10) << __func__ << " " << backing->get_type()
+		 << std::hex << " chunk 0x" << this->chunk_size
+		 << " max_alloc 0x" << this->max_alloc
+		 << " shard_max 0x" << this->shard_max << std::dec
+		 << " shards " << this->num_shards << dendl;
+}
+
+CachingAllocator::~CachingAllocator()
+{
+}
+
+CachingAllocator::shard_t& CachingAllocator::_get_shard()
+{
+  static std::atomic<unsigned> next_index{0};
+  static thread_local unsigned index =
+    next_index.fetch_add(1, std::memory_order_relaxed);
+  return shards[index % num_shards];
+}
+
+uint64_t CachingAllocator::_take(shard_t& s,
+				 uint64_t want,
+				 uint64_t max_alloc_size,
+				 PExtentVector *extents)
+{
+  ceph_assert(ceph_mutex_is_locked(s.lock));
+  uint64_t got = 0;
+  PExtentVector taken;
+  // prefer a single extent that fits the whole request
+  for (auto p = s.free.begin(); p != s.free.end(); ++p) {
+    if (p.get_len() >= want && want <= max_alloc_size) {
+      taken.emplace_back(p.get_start(), want);
+      got = want;
+      break;
+    }
+  }
+  for (auto p = s.free.begin(); got < want && p != s.free.end(); ++p) {
+    uint64_t off = p.get_start();
+    uint64_t left = p.get_len();
+    while (left > 0 && got < want) {
+      uint64_t l = std::min({left, want - got, max_alloc_size});
+      taken.emplace_back(off, l);
+      off += l;
+      left -= l;
+      got += l;
+    }
+  }
+  for (auto& e : taken) {
+    s.free.erase(e.offset, e.length);
+    extents->emplace_back(e);
+  }
+  cached -= got;
+  return got;
+}
+
+void CachingAllocator::_shrink(shard_t& s,
+			       uint64_t target,
+			       interval_set<uint64_t> *to)
+{
+  ceph_assert(ceph_mutex_is_locked(s.lock));
+  while (s.free.size() > target) {
+    auto p = s.free.begin();
+    uint64_t off = p.get_start();
+    uint64_t len = p.get_len();
+    s.free.erase(off, len);
+    cached -= len;
+    to->insert(off, len);
+  }
+}
+
+void CachingAllocator::_drain()
+{
+  if (cached == 0) {
+    return;
+  }
+  interval_set<uint64_t> to_backing;
+  for (unsigned i = 0; i < num_shards; ++i) {
+    std::lock_guard l(shards[i].lock);
+    _shrink(shards[i], 0, &to_backing);
+  }
+  if (!to_backing.empty()) {
+    ldout(cct, 10) << __func__ << " 0x" << std::hex << to_backing.size()
+		   << std::dec << dendl;
+    backing->release(to_backing);
+  }
+}
+
+int64_t CachingAllocator::allocate(
+  uint64_t want,
+  uint64_t unit,
+  uint64_t max_alloc_size,
+  int64_t  hint,
+  PExtentVector *extents)
+{
+  ceph_assert(std::has_single_bit(unit));
+  ceph_assert(want % unit == 0);
+  if (unit != (uint64_t)block_size || want > max_alloc) {
+    // cached extents are only block_size aligned
+    return backing->allocate(want, unit, max_alloc_size, hint, extents);
+  }
+  if (max_alloc_size == 0) {
+    max_alloc_size = want;
+  }
+  if (constexpr auto cap = std::numeric_limits<decltype(bluestore_pextent_t::length)>::max();
+      max_alloc_size >= cap) {
+    max_alloc_size = p2align(uint64_t(cap), (uint64_t)block_size);
+  }
+
+  uint64_t got = 0;
+  {
+    auto& s = _get_shard();
+    std::lock_guard l(s.lock);
+    got = _take(s, want, max_alloc_size, extents);
+    if (got < want) {
+      PExtentVector reserved;
+      int64_t r = backing->allocate(chunk_size, block_size, chunk_size,
+				    hint, &reserved);
+      if (r > 0) {
+	for (auto& e : reserved) {
+	  s.free.insert(e.offset, e.length);
+	}
+	cached += r;
+	got += _take(s, want - got, max_alloc_size, extents);
+      }
+    }
+  }
+  if (got < want) {
+    // (nearly) out of space: give back what the other shards hold
+    // and try the backing allocator directly
+    ldout(cct, 5) << __func__ << " short 0x" << std::hex << want - got
+		  << std::dec << ", draining" << dendl;
+    _drain();
+    int64_t r = backing->allocate(want - got, unit, max_alloc_size, hint,
+				  extents);
+    if (r > 0) {
+      got += r;
+    }
+  }
+  ldout(cct, 20) << __func__ << " 0x" << std::hex << want << " -> 0x" << got
+		 << std::dec << dendl;
+  return got ? (int64_t)got : -ENOSPC;
+}
+
+void CachingAllocator::release(const interval_set<uint64_t>& release_set)
+{
+  interval_set<uint64_t> to_backing;
+  {
+    auto& s = _get_shard();
+    std::lock_guard l(s.lock);
+    for (auto p = release_set.begin(); p != release_set.end(); ++p) {
+      if (p.get_len() <= max_alloc) {
+	s.free.insert(p.get_start(), p.get_len());
+	cached += p.get_len();
+      } else {
+	to_backing.insert(p.get_start(), p.get_len());
+      }
+    }
+    if (s.free.size() > shard_max) {
+      // rebalance: keep half of the limit for reuse
+      _shrink(s, shard_max / 2, &to_backing);
+    }
+  }
+  if (!to_backing.empty()) {
+    backing->release(to_backing);
+  }
+}
+
+uint64_t CachingAllocator::get_free()
+{
+  return backing->get_free() + cached;
+}
+
+double CachingAllocator::get_fragmentation()
+{
+  return backing->get_fragmentation();
+}
+
+void CachingAllocator::dump()
+{
+  _drain();
+  backing->dump();
+}
+
+void CachingAllocator::foreach(
+  std::function<void(uint64_t offset, uint64_t length)> notify)
+{
+  _drain();
+  backing->foreach(notify);
+}
+
+void CachingAllocator::init_add_free(uint64_t offset, uint64_t length)
+{
+  _drain();
+  backing->init_add_free(offset, length);
+}
+
+void CachingAllocator::init_rm_free(uint64_t offset, uint64_t length)
+{
+  _drain();
+  backing->init_rm_free(offset, length);
+}
+
+void CachingAllocator::shutdown()
+{
+  _drain();
+  backing->shutdown();
+}
@@ -0,0 +1,87 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "Allocator.h"
+#include "common/ceph_mutex.h"
+#include "include/interval_set.h"
+
+/*
+ * A front-end cache of free space for a backing allocator.
+ *
+ * Allocations of up to max_alloc bytes in the allocator's own alloc unit
+ * are served from per-shard caches of free extents.  A shard refills by
+ * reserving a contiguous chunk from the backing allocator, and keeps the
+ * small extents released through it (magazine style) for reuse.  Once a
+ * shard caches more than shard_max bytes, it hands the excess back to
+ * the backing allocator in one batched release.  Threads are spread
+ * over the shards, so most calls only take an uncontended shard lock and
+ * the backing allocator's lock is taken once per chunk instead of once
+ * per allocation.
+ *
+ * Cached extents are still free space: get_free() counts them, and
+ * calls that need an exact view of the free space (foreach(), dump(),
+ * init_add_free(), init_rm_free()) first return all cached extents to
+ * the backing allocator.
+ */
+class CachingAllocator : public Allocator {
+  struct alignas(64) shard_t {
+    ceph::mutex lock = ceph::make_mutex("CachingAllocator::shard_t::lock");
+    interval_set<uint64_t> free;  ///< cached free extents
+  };
+
+  CephContext* cct;
+  std::unique_ptr<Allocator> backing;
+  const uint64_t chunk_size; ///< reservation size
+  const uint64_t max_alloc;  ///< larger allocations bypass the cache
+  const uint64_t shard_max;  ///< max cached bytes per shard
+  const unsigned num_shards;
+  std::unique_ptr<shard_t[]> shards;
+  std::atomic<uint64_t> cached = {0}; ///< bytes cached in all shards
+
+  shard_t& _get_shard();
+
+  /// carve up to want bytes out of s.free; s.lock must be held
+  uint64_t _take(shard_t& s, uint64_t want, uint64_t max_alloc_size,
+		 PExtentVector *extents);
+  /// move the extents of s beyond target bytes to *to; s.lock must be held
+  void _shrink(shard_t& s, uint64_t target, interval_set<uint64_t> *to);
+  /// return every cached extent to the backing allocator
+  void _drain();
+
+public:
+  CachingAllocator(CephContext* cct, Allocator* backing,
+		   uint64_t chunk_size, uint64_t max_alloc, uint64_t shard_max,
+		   unsigned num_shards, std::string_view name);
+  ~CachingAllocator() override;
+
+  const char* get_type() const override
+  {
+    return backing->get_type();
+  }
+  int64_t allocate(
+    uint64_t want,
+    uint64_t unit,
+    uint64_t max_alloc_size,
+    int64_t  hint,
+    PExtentVector *extents) override;
+  void release(const interval_set<uint64_t>& release_set) override;
+  using Allocator::release;
+  uint64_t get_free() override;
+  double get_fragmentation() override;
+
+  void dump() override;
+  void foreach(
+    std::function<void(uint64_t offset, uint64_t length)> notify) override;
+  void init_add_free(uint64_t offset, uint64_t length) override;
+  void init_rm_free(uint64_t offset, uint64_t length) override;
+  void shutdown() override;
+
+  uint64_t get_cached() const {
+    return cached;
+  }
+};
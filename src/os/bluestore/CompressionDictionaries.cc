@@ -0,0 +1,227 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "CompressionDictionaries.h"
+
+#include "common/debug.h"
+#include "common/errno.h"
+#include "include/encoding.h"
+
+#define dout_context cct
+#define dout_subsys ceph_subsys_bluestore
+#undef dout_prefix
+#define dout_prefix *_dout << "bluestore.dicts "
+
+using ceph::bufferlist;
+using ceph::decode;
+using ceph::encode;
+
+void CompressionDictionaries::dict_t::encode(bufferlist& bl) const
+{
+  ENCODE_START(1, 1, bl);
+  encode(pool, bl);
+  encode(alg, bl);
+  encode(data, bl);
+  ENCODE_FINISH(bl);
+}
+
+void CompressionDictionaries::dict_t::decode(bufferlist::const_iterator& p)
+{
+  DECODE_START(1, p);
+  decode(pool, p);
+  decode(alg, p);
+  decode(data, p);
+  DECODE_FINISH(p);
+}
+
+CompressionDictionaries::~CompressionDictionaries()
+{
+  close();
+}
+
+std::string CompressionDictionaries::key(uint32_t id)
+{
+  // big endian, so that the ids iterate in order
+  std::string k(4, 0);
+  for (int i = 3; i >= 0; --i, id >>= 8) {
+    k[i] = id & 0xff;
+  }
+  return k;
+}
+
+CompressorRef CompressionDictionaries::_load(uint32_t id, const dict_t& d)
+{
+  auto base = Compressor::create(cct, d.alg);
+  CompressorRef c = base ? base->with_dictionary(d.data) : nullptr;
+  if (!c) {
+    derr << __func__ << " cannot load dictionary " << id << " of pool "
+	 << d.pool << " for " << Compressor::get_comp_alg_name(d.alg) << dendl;
+    return nullptr;
+  }
+  by_id[id] = c;
+  auto& p = pools[d.pool];
+  if (id > p.id) {
+    p.id = id;
+    p.alg = d.alg;
+  }
+  last_id = std::max(last_id, id);
+  return c;
+}
+
+int CompressionDictionaries::open(KeyValueDB *kvdb)
+{
+  std::lock_guard l{lock};
+  db = kvdb;
+  auto it = db->get_iterator(prefix, KeyValueDB::ITERATOR_NOCACHE);
+  for (it->lower_bound(std::string()); it->valid(); it->next()) {
+    auto k = it->key();
+    if (k.size() != 4) {
+      derr << __func__ << " bad key of " << k.size() << " bytes" << dendl;
+      return -EIO;
+    }
+    uint32_t id = 0;
+    for (auto c : k) {
+      id = (id << 8) | (uint8_t)c;
+    }
+    dict_t d;
+    try {
+      auto bl = it->value();
+      auto p = bl.cbegin();
+      d.decode(p);
+    } catch (ceph::buffer::error& e) {
+      derr << __func__ << " cannot decode dictionary " << id << dendl;
+      return -EIO;
+    }
+    // a blob may need it even if the plugin is gone now, in which case
+    // reading that blob fails as it would without the dictionary
+    _load(id, d);
+    last_id = std::max(last_id, id);
+  }
+  dout(1) << __func__ << " " << by_id.size() << " dictionaries, last id "
+	  << last_id << dendl;
+  stopping = false;
+  trainer = std::thread([this] { trainer_entry(); });
+  return 0;
+}
+
+void CompressionDictionaries::close()
+{
+  {
+    std::lock_guard l{lock};
+    stopping = true;
+    cond.notify_all();
+  }
+  if (trainer.joinable()) {
+    trainer.join();
+  }
+  std::lock_guard l{lock};
+  to_train.clear();
+  by_id.clear();
+  pools.clear();
+  db = nullptr;
+}
+
+std::pair<uint32_t, CompressorRef> CompressionDictionaries::get(
+  int64_t pool, const CompressorRef& comp)
+{
+  std::lock_guard l{lock};
+  auto p = pools.find(pool);
+  if (p == pools.end() || !p->second.id ||
+      p->second.alg != comp->get_type()) {
+    return {0, nullptr};
+  }
+  return {p->second.id, by_id[p->second.id]};
+}
+
+CompressorRef CompressionDictionaries::find(uint32_t id)
+{
+  std::lock_guard l{lock};
+  auto p = by_id.find(id);
+  return p == by_id.end() ? nullptr : p->second;
+}
+
+void CompressionDictionaries::sample(int64_t pool, const CompressorRef& comp,
+				     const bufferlist& bl)
+{
+  auto want = cct->_conf.get_val<Option::size_t>(
+    "bluestore_compression_dictionary_train_bytes");
+  std::lock_guard l{lock};
+  auto& p = pools[pool];
+  if (p.training || stopping || !db) {
+    return;
+  }
+  if (p.id && p.alg == comp->get_type()) {
+    // trained already; a new version comes if the pool changes compressor
+    return;
+  }
+  // copy, rather than pin the write's buffers
+  ceph::buffer::ptr copy(bl.length());
+  bl.cbegin().copy(bl.length(), copy.c_str());
+  p.sample_bytes += bl.length();
+  p.samples.emplace_back().append(std::move(copy));
+  if (p.sample_bytes >= want) {
+    p.training = true;
+    to_train.push_back(job_t{pool, comp, std::move(p.samples)});
+    p.samples.clear();
+    p.sample_bytes = 0;
+    cond.notify_all();
+  }
+}
+
+void CompressionDictionaries::train(job_t& job)
+{
+  auto size = cct->_conf.get_val<Option::size_t>(
+    "bluestore_compression_dictionary_size");
+  bufferlist data;
+  int r = job.comp->train_dictionary(job.samples, size, &data);
+  if (r < 0) {
+    dout(1) << __func__ << " pool " << job.pool << ": cannot train a "
+	    << job.comp->get_type_name() << " dictionary on "
+	    << job.samples.size() << " samples: " << cpp_strerror(r) << dendl;
+    return;
+  }
+  dict_t d;
+  d.pool = job.pool;
+  d.alg = job.comp->get_type();
+  d.data = std::move(data);
+
+  uint32_t id;
+  {
+    std::lock_guard l{lock};
+    id = ++last_id;
+  }
+  bufferlist bl;
+  d.encode(bl);
+  auto t = db->get_transaction();
+  t->set(prefix, key(id), bl);
+  // blobs will refer to it as soon as it is loaded, so it must be durable
+  r = db->submit_transaction_sync(t);
+  if (r < 0) {
+    derr << __func__ << " cannot store dictionary " << id << ": "
+	 << cpp_strerror(r) << dendl;
+    return;
+  }
+  std::lock_guard l{lock};
+  if (_load(id, d)) {
+    dout(1) << __func__ << " pool " << job.pool << " dictionary " << id
+	    << ", " << d.data.length() << " bytes from " << job.samples.size()
+	    << " samples" << dendl;
+  }
+}
+
+void CompressionDictionaries::trainer_entry()
+{
+  std::unique_lock l{lock};
+  while (true) {
+    cond.wait(l, [this] { return stopping || !to_train.empty(); });
+    if (stopping) {
+      break;
+    }
+    auto job = std::move(to_train.front());
+    to_train.pop_front();
+    l.unlock();
+    train(job);
+    l.lock();
+    pools[job.pool].training = false;
+  }
+}
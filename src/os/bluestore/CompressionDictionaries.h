@@ -0,0 +1,89 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <deque>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "common/ceph_mutex.h"
+#include "compressor/Compressor.h"
+#include "kv/KeyValueDB.h"
+
+/**
+ * Compression dictionaries, trained per pool from samples of the blobs
+ * written to it.
+ *
+ * Small blobs have too little context of their own to compress well; a
+ * dictionary trained on blobs like them gives the compressor that
+ * context.  Each dictionary is stored in the DB under its id for as long
+ * as the store lives, since blobs keep referring to it from their
+ * compression header; a pool uses its newest one for new writes.
+ *
+ * Training runs on a thread of its own once a pool has offered enough
+ * samples.
+ */
+class CompressionDictionaries {
+public:
+  CompressionDictionaries(CephContext *cct, const std::string& prefix)
+    : cct(cct), prefix(prefix) {}
+  ~CompressionDictionaries();
+
+  /// load the stored dictionaries and start training
+  int open(KeyValueDB *db);
+  void close();
+
+  /// the dictionary id and compressor new blobs of pool should use, or
+  /// (0, nullptr) if pool has none for comp yet
+  std::pair<uint32_t, CompressorRef> get(int64_t pool,
+					 const CompressorRef& comp);
+  /// the compressor for a blob compressed with dictionary id
+  CompressorRef find(uint32_t id);
+
+  /// offer a blob of pool that comp compressed without a dictionary
+  void sample(int64_t pool, const CompressorRef& comp,
+	      const ceph::buffer::list& bl);
+
+private:
+  struct dict_t {
+    int64_t pool = 0;
+    uint8_t alg = 0;
+    ceph::buffer::list data;
+
+    void encode(ceph::buffer::list& bl) const;
+    void decode(ceph::buffer::list::const_iterator& p);
+  };
+  struct pool_t {
+    uint32_t id = 0;                 ///< newest dictionary, 0 for none
+    uint8_t alg = 0;                 ///< of the newest dictionary
+    std::vector<ceph::buffer::list> samples;
+    size_t sample_bytes = 0;
+    bool training = false;
+  };
+
+  CephContext *cct;
+  const std::string prefix;
+  KeyValueDB *db = nullptr;
+
+  ceph::mutex lock = ceph::make_mutex("CompressionDictionaries::lock");
+  std::map<uint32_t, CompressorRef> by_id;
+  std::map<int64_t, pool_t> pools;
+  uint32_t last_id = 0;
+
+  struct job_t {
+    int64_t pool;
+    CompressorRef comp;
+    std::vector<ceph::buffer::list> samples;
+  };
+  ceph::condition_variable cond;
+  std::deque<job_t> to_train;
+  bool stopping = false;
+  std::thread trainer;
+
+  static std::string key(uint32_t id);
+  CompressorRef _load(uint32_t id, const dict_t& d);
+  void train(job_t& job);
+  void trainer_entry();
+};
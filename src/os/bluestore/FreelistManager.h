@@ -9,6 +9,7 @@
 #include <mutex>
 #include <ostream>
 #include "kv/KeyValueDB.h"
+#include "include/interval_set.h"
 #include "bluestore_types.h"
 
 class FreelistManager {
@@ -45,6 +46,19 @@ public:
     uint64_t offset, uint64_t length,
     KeyValueDB::Transaction txn) = 0;
 
+  /// apply a transaction's (disjoint) allocated and released sets at once
+  virtual void update(
+    const interval_set<uint64_t>& allocated,
+    const interval_set<uint64_t>& released,
+    KeyValueDB::Transaction txn) {
+    for (auto p = allocated.begin(); p != allocated.end(); ++p) {
+      allocate(p.get_start(), p.get_len(), txn);
+    }
+    for (auto p = released.begin(); p != released.end(); ++p) {
+      release(p.get_start(), p.get_len(), txn);
+    }
+  }
+
   virtual uint64_t get_size() const = 0;
   virtual uint64_t get_alloc_units() const = 0;
   virtual uint64_t get_alloc_size() const = 0;
@@ -840,43 +840,9 @@ void bluestore_blob_t::calc_csum(uint64_t b_off, const bufferlist& bl)
 int bluestore_blob_t::verify_csum(uint64_t b_off, const bufferlist& bl,
 				  int* b_bad_off, uint64_t *bad_csum) const
 {
-  int r = 0;
-
   *b_bad_off = -1;
-  switch (csum_type) {
-  case Checksummer::CSUM_NONE:
-    break;
-  case Checksummer::CSUM_XXHASH32:
-    *b_bad_off = Checksummer::verify<Checksummer::xxhash32>(
-      get_csum_chunk_size(), b_off, bl.length(), bl, csum_data, bad_csum);
-    break;
-  case Checksummer::CSUM_XXHASH64:
-    *b_bad_off = Checksummer::verify<Checksummer::xxhash64>(
-      get_csum_chunk_size(), b_off, bl.length(), bl, csum_data, bad_csum);
-    break;
-  case Checksummer::CSUM_CRC32C:
-    *b_bad_off = Checksummer::verify<Checksummer::crc32c>(
-      get_csum_chunk_size(), b_off, bl.length(), bl, csum_data, bad_csum);
-    break;
-  case Checksummer::CSUM_CRC32C_16:
-    *b_bad_off = Checksummer::verify<Checksummer::crc32c_16>(
-      get_csum_chunk_size(), b_off, bl.length(), bl, csum_data, bad_csum);
-    break;
-  case Checksummer::CSUM_CRC32C_8:
-    *b_bad_off = Checksummer::verify<Checksummer::crc32c_8>(
-      get_csum_chunk_size(), b_off, bl.length(), bl, csum_data, bad_csum);
-    break;
-  default:
-    r = -EOPNOTSUPP;
-    break;
-  }
-
-  if (r < 0)
-    return r;
-  else if (*b_bad_off >= 0)
-    return -1; // bad checksum
-  else
-    return 0;
+  return Checksummer::verify(csum_type, get_csum_chunk_size(), b_off,
+			     bl.length(), bl, csum_data, b_bad_off, bad_csum);
 }
 
 void bluestore_blob_t::allocated(uint32_t b_off, uint32_t length, const PExtentVector& allocs)
@@ -1286,6 +1252,9 @@ void bluestore_compression_header_t::dump(Formatter *f) const
   if (compressor_message) {
     f->dump_int("compressor_message", *compressor_message);
   }
+  if (has_dictionary()) {
+    f->dump_unsigned("dict_id", dict_id);
+  }
 }
 
 void bluestore_compression_header_t::generate_test_instances(
@@ -1294,6 +1263,11 @@ void bluestore_compression_header_t::generate_test_instances(
   o.push_back(new bluestore_compression_header_t);
   o.push_back(new bluestore_compression_header_t(1));
   o.back()->length = 1234;
+  o.push_back(new bluestore_compression_header_t(
+    Compressor::COMP_ALG_ZSTD |
+    bluestore_compression_header_t::FLAG_DICTIONARY));
+  o.back()->length = 1234;
+  o.back()->dict_id = 2;
 }
 
 // adds more salt to build a hash func input
@@ -1172,21 +1172,36 @@ struct bluestore_deferred_transaction_t {
 WRITE_CLASS_DENC(bluestore_deferred_transaction_t)
 
 struct bluestore_compression_header_t {
+  /// set in type if the blob was compressed with dictionary dict_id; the
+  /// type is then unknown to the releases that cannot read it
+  static constexpr uint8_t FLAG_DICTIONARY = 0x80;
+
   uint8_t type = Compressor::COMP_ALG_NONE;
   uint32_t length = 0;
   std::optional<int32_t> compressor_message;
+  uint32_t dict_id = 0;
 
   bluestore_compression_header_t() {}
   bluestore_compression_header_t(uint8_t _type)
     : type(_type) {}
 
+  int get_alg() const {
+    return type & ~FLAG_DICTIONARY;
+  }
+  bool has_dictionary() const {
+    return type & FLAG_DICTIONARY;
+  }
+
   DENC(bluestore_compression_header_t, v, p) {
-    DENC_START(2, 1, p);
+    DENC_START(3, 1, p);
     denc(v.type, p);
     denc(v.length, p);
     if (struct_v >= 2) {
       denc(v.compressor_message, p);
     }
+    if (struct_v >= 3) {
+      denc(v.dict_id, p);
+    }
     DENC_FINISH(p);
   }
   void dump(ceph::Formatter *f) const;
@@ -1625,7 +1625,8 @@ struct MemStore::PageSetObject : public Object {
 
 private:
   FRIEND_MAKE_REF(PageSetObject);
-  explicit PageSetObject(size_t page_size) : data(page_size), data_len(0) {}
+  PageSetObject(size_t page_size, bool use_arena)
+    : data(page_size, use_arena), data_len(0) {}
 };
 
 #if defined(__GLIBCXX__)
@@ -1829,6 +1830,7 @@ int MemStore::PageSetObject::truncate(uint64_t size)
 
 MemStore::ObjectRef MemStore::Collection::create_object() const {
   if (use_page_set)
-    return ceph::make_ref<PageSetObject>(cct->_conf->memstore_page_size);
+    return ceph::make_ref<PageSetObject>(cct->_conf->memstore_page_size,
+                                         cct->_conf->memstore_page_arena);
   return make_ref<BufferlistObject>();
 }
@@ -18,17 +18,82 @@
 #include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <map>
 #include <mutex>
+#include <new>
 #include <vector>
+#include <sys/mman.h>
 #include <boost/intrusive/avl_set.hpp>
 #include <boost/intrusive_ptr.hpp>
 
 #include "include/encoding.h"
 
+// hands out page buffers carved from chunks of (transparent) huge pages,
+// and recycles the freed ones, so that new pages neither go through
+// malloc nor fault in the memory 4K at a time.  the chunks are never
+// returned to the system.
+class PageArena {
+  static constexpr size_t chunk_size = 2 << 20;
+
+  std::mutex lock;
+  std::map<size_t, std::vector<char*>> free_buffers; // by buffer size
+
+  static char *alloc_chunk(size_t len) {
+    // over-map to align the chunk to the huge page size
+    const size_t map_len = len + chunk_size;
+    void *m = ::mmap(nullptr, map_len, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m == MAP_FAILED)
+      throw std::bad_alloc();
+    auto start = reinterpret_cast<uintptr_t>(m);
+    auto aligned = (start + chunk_size - 1) & ~(chunk_size - 1);
+    if (aligned > start)
+      ::munmap(m, aligned - start);
+    if (auto tail = start + map_len - (aligned + len); tail > 0)
+      ::munmap(reinterpret_cast<void*>(aligned + len), tail);
+#ifdef MADV_HUGEPAGE
+    ::madvise(reinterpret_cast<void*>(aligned), len, MADV_HUGEPAGE);
+#endif
+    return reinterpret_cast<char*>(aligned);
+  }
+
+ public:
+  static PageArena& instance() {
+    static PageArena arena;
+    return arena;
+  }
+
+  char *alloc(size_t size) {
+    std::lock_guard<std::mutex> l(lock);
+    auto &buffers = free_buffers[size];
+    if (buffers.empty()) {
+      const size_t len = (size + chunk_size - 1) & ~(chunk_size - 1);
+      char *chunk = alloc_chunk(len);
+      for (size_t off = len / size * size; off >= size; off -= size)
+        buffers.push_back(chunk + off - size);
+    }
+    char *buffer = buffers.back();
+    buffers.pop_back();
+    return buffer;
+  }
+  void free(char *buffer, size_t size) {
+    std::lock_guard<std::mutex> l(lock);
+    free_buffers[size].push_back(buffer);
+  }
+  // number of free buffers of the given size, for tests
+  size_t num_free(size_t size) {
+    std::lock_guard<std::mutex> l(lock);
+    auto p = free_buffers.find(size);
+    return p == free_buffers.end() ? 0 : p->second.size();
+  }
+};
+
 struct Page {
   char *const data;
   boost::intrusive::avl_set_member_hook<> hook;
   uint64_t offset;
+  // size of the buffer if allocated from the PageArena, 0 otherwise
+  const size_t arena_size;
 
   // avoid RefCountedObject because it has a virtual destructor
   std::atomic<uint16_t> nrefs;
@@ -62,14 +127,18 @@ struct Page {
     decode(offset, p);
   }
 
-  static Ref create(size_t page_size, uint64_t offset = 0) {
+  static Ref create(size_t page_size, uint64_t offset = 0,
+                    bool use_arena = false) {
     // ensure proper alignment of the Page
     const auto align = alignof(Page);
     page_size = (page_size + align - 1) & ~(align - 1);
     // allocate the Page and its data in a single buffer
-    auto buffer = new char[page_size + sizeof(Page)];
+    const size_t size = page_size + sizeof(Page);
+    auto buffer = use_arena ? PageArena::instance().alloc(size) :
+                              new char[size];
     // place the Page structure at the end of the buffer
-    return new (buffer + page_size) Page(buffer, offset);
+    return new (buffer + page_size) Page(buffer, offset,
+                                         use_arena ? size : 0);
   }
 
   // copy disabled
@@ -77,10 +146,15 @@ struct Page {
   const Page& operator=(const Page&) = delete;
 
  private: // private constructor, use create() instead
-  Page(char *data, uint64_t offset) : data(data), offset(offset), nrefs(1) {}
+  Page(char *data, uint64_t offset, size_t arena_size)
+    : data(data), offset(offset), arena_size(arena_size), nrefs(1) {}
 
   static void operator delete(void *p) {
-    delete[] reinterpret_cast<Page*>(p)->data;
+    auto page = reinterpret_cast<Page*>(p);
+    if (page->arena_size)
+      PageArena::instance().free(page->data, page->arena_size);
+    else
+      delete[] page->data;
   }
 };
 
@@ -102,6 +176,7 @@ class PageSet {
 
   page_set pages;
   uint64_t page_size;
+  bool use_arena;
 
   typedef std::mutex lock_type;
   lock_type mutex;
@@ -129,9 +204,11 @@ class PageSet {
   }
 
  public:
-  explicit PageSet(size_t page_size) : page_size(page_size) {}
+  explicit PageSet(size_t page_size, bool use_arena = false)
+    : page_size(page_size), use_arena(use_arena) {}
   PageSet(PageSet &&rhs)
-    : pages(std::move(rhs.pages)), page_size(rhs.page_size) {}
+    : pages(std::move(rhs.pages)), page_size(rhs.page_size),
+      use_arena(rhs.use_arena) {}
   ~PageSet() {
     free_pages(pages.begin(), pages.end());
   }
@@ -161,7 +238,7 @@ class PageSet {
       typename page_set::insert_commit_data commit;
       auto insert = pages.insert_check(cur, page_offset, page_cmp(), commit);
       if (insert.second) {
-        auto page = Page::create(page_size, page_offset);
+        auto page = Page::create(page_size, page_offset, use_arena);
         cur = pages.insert_commit(*page, commit);
 
         // assume that the caller will write to the range [offset,length),
@@ -222,7 +299,7 @@ class PageSet {
     decode(count, p);
     auto cur = pages.end();
     for (unsigned i = 0; i < count; i++) {
-      auto page = Page::create(page_size);
+      auto page = Page::create(page_size, 0, use_arena);
       page->decode(p, page_size);
       cur = pages.insert_before(cur, *page);
     }
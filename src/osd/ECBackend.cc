@@ -1039,24 +1039,20 @@ void ECBackend::handle_sub_read(
         dout(25) << __func__ << " case2: going to do fragmented read." << dendl;
         int subchunk_size =
           sinfo.get_chunk_size() / ec_impl->get_sub_chunk_count();
-        bool error = false;
-        for (int m = 0; m < (int)j->get<1>() && !error;
+        // one vectored read for every sub-chunk of the extent, so that
+        // the store can issue them together
+        interval_set<uint64_t> extents;
+        for (int m = 0; m < (int)j->get<1>();
              m += sinfo.get_chunk_size()) {
           for (auto &&k:op.subchunks.find(i->first)->second) {
-            bufferlist bl0;
-            r = store->read(
-                ch,
-                ghobject_t(i->first, ghobject_t::NO_GEN, shard),
-                j->get<0>() + m + (k.first)*subchunk_size,
-                (k.second)*subchunk_size,
-                bl0, j->get<2>());
-            if (r < 0) {
-              error = true;
-              break;
-            }
-            bl.claim_append(bl0);
+            extents.insert(j->get<0>() + m + (k.first)*subchunk_size,
+                           (k.second)*subchunk_size);
           }
         }
+        r = store->readv(
+            ch,
+            ghobject_t(i->first, ghobject_t::NO_GEN, shard),
+            extents, bl, j->get<2>());
       }
 
       if (r < 0) {
@@ -1231,6 +1227,10 @@ void ECBackend::handle_sub_read_reply(
       ceph_assert(adjusted.first == j->first);
       riter->get<2>()[from] = std::move(j->second);
     }
+    auto &need = rop.to_read.find(i->first)->second.need;
+    if (auto p = need.find(from); p != need.end()) {
+      rop.complete[i->first].subchunks[from] = p->second;
+    }
   }
   for (auto i = op.attrs_read.begin();
        i != op.attrs_read.end();
@@ -1736,21 +1736,26 @@ int ECBackend::be_deep_scrub(
   if (stride % sinfo.get_chunk_size())
     stride += sinfo.get_chunk_size() - (stride % sinfo.get_chunk_size());
 
-  bufferlist bl;
-  r = store->read(
-    ch,
-    ghobject_t(
-      poid, ghobject_t::NO_GEN, get_parent()->whoami_shard().shard),
-    pos.data_pos,
-    stride, bl,
-    fadvise_flags);
+  const ghobject_t goid(
+    poid, ghobject_t::NO_GEN, get_parent()->whoami_shard().shard);
+  uint32_t crc = pos.data_hash.digest();
+  if (cct->_conf.get_val<bool>("osd_deep_scrub_store_csum")) {
+    r = store->scrub_read(ch, goid, pos.data_pos, stride, &crc,
+			  fadvise_flags);
+  } else {
+    bufferlist bl;
+    r = store->read(ch, goid, pos.data_pos, stride, bl, fadvise_flags);
+    if (r > 0) {
+      crc = bl.crc32c(crc);
+    }
+  }
   if (r < 0) {
     dout(20) << __func__ << "  " << poid << " got "
 	     << r << " on read, read_error" << dendl;
     o.read_error = true;
     return 0;
   }
-  if (bl.length() % sinfo.get_chunk_size()) {
+  if (r % sinfo.get_chunk_size()) {
     dout(20) << __func__ << "  " << poid << " got "
 	     << r << " on read, not chunk size " << sinfo.get_chunk_size() << " aligned"
 	     << dendl;
@@ -1758,7 +1763,7 @@ int ECBackend::be_deep_scrub(
     return 0;
   }
   if (r > 0) {
-    pos.data_hash << bl;
+    pos.data_hash = bufferhash(crc);
   }
   pos.data_pos += r;
   if (r == (int)stride) {
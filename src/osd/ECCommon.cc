@@ -23,6 +23,7 @@
 #include "messages/MOSDECSubOpRead.h"
 #include "messages/MOSDECSubOpReadReply.h"
 #include "ECMsgTypes.h"
+#include "crush/CrushWrapper.h"
 #include "PGLog.h"
 
 #include "osd_tracer.h"
@@ -276,9 +277,32 @@ int ECCommon::ReadPipeline::get_min_avail_to_read_shards(
   get_all_avail_shards(hoid, error_shards, have, shards, for_recovery);
 
   map<int, vector<pair<int, int>>> need;
-  int r = ec_impl->minimum_to_decode(want, have, &need);
-  if (r < 0)
-    return r;
+  int r;
+  if (!do_redundant_reads && cct->_conf->osd_read_ec_prefer_local &&
+      ec_impl->get_sub_chunk_count() == 1) {
+    auto loc = get_osdmap()->crush->get_full_location(
+      get_parent()->whoami_shard().osd);
+    std::multimap<string, string> primary_loc(loc.begin(), loc.end());
+    map<int, int> costs;
+    for (auto &&i : have) {
+      costs[i] = get_read_cost(shards[shard_id_t(i)], primary_loc);
+    }
+    set<int> minimum;
+    r = ec_impl->minimum_to_decode_with_cost(want, costs, &minimum);
+    if (r < 0)
+      return r;
+    dout(20) << __func__ << " costs " << costs << " minimum " << minimum
+	     << dendl;
+    vector<pair<int, int>> subchunks_list;
+    subchunks_list.push_back(make_pair(0, ec_impl->get_sub_chunk_count()));
+    for (auto &&i : minimum) {
+      need[i] = subchunks_list;
+    }
+  } else {
+    r = ec_impl->minimum_to_decode(want, have, &need);
+    if (r < 0)
+      return r;
+  }
 
   if (do_redundant_reads) {
       vector<pair<int, int>> subchunks_list;
@@ -298,6 +322,27 @@ int ECCommon::ReadPipeline::get_min_avail_to_read_shards(
   return 0;
 }
 
+int ECCommon::ReadPipeline::get_read_cost(
+  pg_shard_t shard,
+  const std::multimap<string, string> &primary_loc)
+{
+  // one for the read itself, the depth in the CRUSH hierarchy of the
+  // bucket shared with the primary (the osd 0, host 1, rack 3 ...) and
+  // the reads we already have in flight to that osd
+  int cost = 1;
+  if (shard.osd != get_parent()->whoami_shard().osd) {
+    const auto &crush = get_osdmap()->crush;
+    int distance = crush->get_common_ancestor_distance(
+      cct, shard.osd, primary_loc);
+    cost += distance < 0 ? crush->get_max_type_id() + 1 : distance;
+  }
+  auto p = shard_to_read_map.find(shard);
+  if (p != shard_to_read_map.end()) {
+    cost += p->second.size();
+  }
+  return cost;
+}
+
 int ECCommon::ReadPipeline::get_remaining_shards(
   const hobject_t &hoid,
   const set<int> &avail,
@@ -325,21 +370,22 @@ int ECCommon::ReadPipeline::get_remaining_shards(
     return -EIO;
   }
 
-  set<int> shards_left;
-  for (auto p : need) {
-    if (avail.find(p.first) == avail.end()) {
-      shards_left.insert(p.first);
+  // read the sub-chunks the plugin asks for, rather than whole chunks,
+  // so that a repair (e.g. clay) keeps its bandwidth savings.  the
+  // helpers may differ from the first pass, in which case a shard that
+  // returned other sub-chunks has to be read again, too
+  for (auto &&p : need) {
+    ceph_assert(shards.count(shard_id_t(p.first)));
+    pg_shard_t shard = shards[shard_id_t(p.first)];
+    if (avail.count(p.first)) {
+      auto got = result.subchunks.find(shard);
+      if (got == result.subchunks.end() || got->second == p.second) {
+	continue;
+      }
+      dout(10) << __func__ << " re-reading " << shard << " for sub-chunks "
+	       << p.second << ", have " << got->second << dendl;
     }
-  }
-
-  vector<pair<int, int>> subchunks;
-  subchunks.push_back(make_pair(0, ec_impl->get_sub_chunk_count()));
-  for (set<int>::iterator i = shards_left.begin();
-       i != shards_left.end();
-       ++i) {
-    ceph_assert(shards.count(shard_id_t(*i)));
-    ceph_assert(avail.find(*i) == avail.end());
-    to_read->insert(make_pair(shards[shard_id_t(*i)], subchunks));
+    to_read->insert(make_pair(shard, p.second));
   }
   return 0;
 }
@@ -461,6 +507,59 @@ void ECCommon::ReadPipeline::get_want_to_read_shards(
   }
 }
 
+void ECCommon::ReadPipeline::get_want_to_read_shards(
+  const list<boost::tuple<uint64_t, uint64_t, uint32_t>> &to_read,
+  std::set<int> *want_to_read) const
+{
+  // sub-chunk codes need whole chunks of every shard to decode
+  if (!cct->_conf.get_val<bool>("osd_ec_partial_reads") ||
+      ec_impl->get_sub_chunk_count() != 1) {
+    get_want_to_read_shards(want_to_read);
+    return;
+  }
+
+  const uint64_t stripe_width = sinfo.get_stripe_width();
+  const uint64_t chunk_size = sinfo.get_chunk_size();
+  const unsigned k = ec_impl->get_data_chunk_count();
+  std::set<unsigned> chunks;
+  for (auto &&read : to_read) {
+    uint64_t off = read.get<0>();
+    uint64_t len = read.get<1>();
+    if (len == 0) {
+      continue;
+    }
+    if (len >= stripe_width) {
+      get_want_to_read_shards(want_to_read);
+      return;
+    }
+    uint64_t end = off + len - 1;
+    unsigned first = (off % stripe_width) / chunk_size;
+    unsigned last = (end % stripe_width) / chunk_size;
+    if (off / stripe_width == end / stripe_width) {
+      for (unsigned i = first; i <= last; ++i) {
+	chunks.insert(i);
+      }
+    } else {
+      // wraps into the next stripe
+      for (unsigned i = first; i < k; ++i) {
+	chunks.insert(i);
+      }
+      for (unsigned i = 0; i <= last; ++i) {
+	chunks.insert(i);
+      }
+    }
+  }
+  if (chunks.empty()) {
+    chunks.insert(0);
+  }
+
+  const std::vector<int> &chunk_mapping = ec_impl->get_chunk_mapping();
+  for (unsigned i : chunks) {
+    int chunk = chunk_mapping.size() > i ? chunk_mapping[i] : i;
+    want_to_read->insert(chunk);
+  }
+}
+
 struct ClientReadCompleter : ECCommon::ReadCompleter {
   ClientReadCompleter(ECCommon::ReadPipeline &read_pipeline,
                       ECCommon::ClientAsyncReadStatus *status)
@@ -473,10 +572,12 @@ struct ClientReadCompleter : ECCommon::ReadCompleter {
     list<boost::tuple<uint64_t, uint64_t, uint32_t> > to_read) override
   {
     extent_map result;
+    set<int> want_to_read;
     if (res.r != 0)
       goto out;
     ceph_assert(res.returned.size() == to_read.size());
     ceph_assert(res.errors.empty());
+    read_pipeline.get_want_to_read_shards(to_read, &want_to_read);
     for (auto &&read: to_read) {
       pair<uint64_t, uint64_t> adjusted =
 	read_pipeline.sinfo.offset_len_to_stripe_bounds(
@@ -494,6 +595,7 @@ struct ClientReadCompleter : ECCommon::ReadCompleter {
       int r = ECUtil::decode(
 	read_pipeline.sinfo,
 	read_pipeline.ec_impl,
+	want_to_read,
 	to_decode,
 	&bl);
       if (r < 0) {
@@ -539,11 +641,11 @@ void ECCommon::ReadPipeline::objects_read_and_reconstruct(
   }
 
   map<hobject_t, set<int>> obj_want_to_read;
-  set<int> want_to_read;
-  get_want_to_read_shards(&want_to_read);
     
   map<hobject_t, read_request_t> for_read_op;
   for (auto &&to_read: reads) {
+    set<int> want_to_read;
+    get_want_to_read_shards(to_read.second, &want_to_read);
     map<pg_shard_t, vector<pair<int, int>>> shards;
     int r = get_min_avail_to_read_shards(
       to_read.first,
@@ -589,6 +691,25 @@ int ECCommon::ReadPipeline::send_all_remaining_reads(
   if (r)
     return r;
 
+  // whatever was returned for a shard being read again no longer
+  // matches the sub-chunks the decode will want
+  auto &result = rop.complete[hoid];
+  for (auto &&i : shards) {
+    for (auto &&extent : result.returned) {
+      auto &bufs = extent.get<2>();
+      for (auto j = bufs.begin(); j != bufs.end();) {
+	if (j->first.shard == i.first.shard) {
+	  j = bufs.erase(j);
+	} else {
+	  ++j;
+	}
+      }
+    }
+    std::erase_if(result.subchunks, [&i](const auto &p) {
+      return p.first.shard == i.first.shard;
+    });
+  }
+
   list<boost::tuple<uint64_t, uint64_t, uint32_t> > offsets =
     rop.to_read.find(hoid)->second.to_read;
 
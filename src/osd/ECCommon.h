@@ -265,6 +265,8 @@ struct ECCommon {
     std::list<
       boost::tuple<
 	uint64_t, uint64_t, std::map<pg_shard_t, ceph::buffer::list> > > returned;
+    // the sub-chunks each shard's buffers in returned hold
+    std::map<pg_shard_t, std::vector<std::pair<int, int>>> subchunks;
     read_result_t() : r(0) {}
   };
 
@@ -429,6 +431,10 @@ struct ECCommon {
         parent(parent) {
     }
 
+    int get_read_cost(
+      pg_shard_t shard,
+      const std::multimap<std::string, std::string> &primary_loc);
+
     int get_remaining_shards(
       const hobject_t &hoid,
       const std::set<int> &avail,
@@ -448,6 +454,10 @@ struct ECCommon {
     friend struct FinishReadOp;
 
     void get_want_to_read_shards(std::set<int> *want_to_read) const;
+    /// shards holding the data chunks that to_read touches
+    void get_want_to_read_shards(
+      const std::list<boost::tuple<uint64_t, uint64_t, uint32_t>> &to_read,
+      std::set<int> *want_to_read) const;
 
     /// Returns to_read replicas sufficient to reconstruct want
     int get_min_avail_to_read_shards(
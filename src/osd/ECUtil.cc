@@ -47,6 +47,66 @@ int ECUtil::decode(
   return 0;
 }
 
+int ECUtil::decode(
+  const stripe_info_t &sinfo,
+  ErasureCodeInterfaceRef &ec_impl,
+  const set<int> &want_to_read,
+  map<int, bufferlist> &to_decode,
+  bufferlist *out) {
+  const unsigned k = ec_impl->get_data_chunk_count();
+  const vector<int> &chunk_mapping = ec_impl->get_chunk_mapping();
+  auto shard_of = [&chunk_mapping](unsigned i) {
+    return chunk_mapping.size() > i ? chunk_mapping[i] : (int)i;
+  };
+  bool all = true;
+  for (unsigned i = 0; i < k; i++) {
+    if (!want_to_read.count(shard_of(i))) {
+      all = false;
+      break;
+    }
+  }
+  if (all) {
+    return decode(sinfo, ec_impl, to_decode, out);
+  }
+
+  ceph_assert(to_decode.size());
+  uint64_t total_data_size = to_decode.begin()->second.length();
+  ceph_assert(total_data_size % sinfo.get_chunk_size() == 0);
+  ceph_assert(out);
+  ceph_assert(out->length() == 0);
+  for (auto &&i : to_decode) {
+    ceph_assert(i.second.length() == total_data_size);
+  }
+  if (total_data_size == 0)
+    return 0;
+
+  // one shared zero chunk stands in for the data chunks not wanted
+  bufferptr zeros(buffer::create(sinfo.get_chunk_size()));
+  zeros.zero();
+  for (uint64_t off = 0; off < total_data_size; off += sinfo.get_chunk_size()) {
+    map<int, bufferlist> chunks;
+    for (auto &&j : to_decode) {
+      chunks[j.first].substr_of(j.second, off, sinfo.get_chunk_size());
+    }
+    map<int, bufferlist> decoded;
+    int r = ec_impl->decode(want_to_read, chunks, &decoded,
+			    sinfo.get_chunk_size());
+    if (r < 0)
+      return r;
+    for (unsigned i = 0; i < k; i++) {
+      auto p = decoded.find(shard_of(i));
+      if (want_to_read.count(shard_of(i))) {
+	ceph_assert(p != decoded.end());
+	ceph_assert(p->second.length() == sinfo.get_chunk_size());
+	out->claim_append(p->second);
+      } else {
+	out->append(zeros);
+      }
+    }
+  }
+  return 0;
+}
+
 int ECUtil::decode(
   const stripe_info_t &sinfo,
   ErasureCodeInterfaceRef &ec_impl,
@@ -136,19 +196,8 @@ int ECUtil::encode(
   if (logical_size == 0)
     return 0;
 
-  for (uint64_t i = 0; i < logical_size; i += sinfo.get_stripe_width()) {
-    map<int, bufferlist> encoded;
-    bufferlist buf;
-    buf.substr_of(in, i, sinfo.get_stripe_width());
-    int r = ec_impl->encode(want, buf, &encoded);
-    ceph_assert(r == 0);
-    for (map<int, bufferlist>::iterator i = encoded.begin();
-	 i != encoded.end();
-	 ++i) {
-      ceph_assert(i->second.length() == sinfo.get_chunk_size());
-      (*out)[i->first].claim_append(i->second);
-    }
-  }
+  int r = ec_impl->encode_stripes(want, in, sinfo.get_stripe_width(), out);
+  ceph_assert(r == 0);
 
   for (map<int, bufferlist>::iterator i = out->begin();
        i != out->end();
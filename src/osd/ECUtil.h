@@ -85,6 +85,15 @@ int decode(
   std::map<int, ceph::buffer::list> &to_decode,
   ceph::buffer::list *out);
 
+/// like the above, but only the data chunks on the want_to_read shards
+/// are decoded; the others are left zero filled in *out
+int decode(
+  const stripe_info_t &sinfo,
+  ceph::ErasureCodeInterfaceRef &ec_impl,
+  const std::set<int> &want_to_read,
+  std::map<int, ceph::buffer::list> &to_decode,
+  ceph::buffer::list *out);
+
 int decode(
   const stripe_info_t &sinfo,
   ceph::ErasureCodeInterfaceRef &ec_impl,
@@ -91,6 +91,7 @@
 #include "messages/MOSDPGNotify2.h"
 #include "messages/MOSDPGLog.h"
 #include "messages/MOSDPGRemove.h"
+#include "messages/MOSDRepOpBatch.h"
 #include "messages/MOSDPGInfo.h"
 #include "messages/MOSDPGCreate2.h"
 #include "messages/MOSDForceRecovery.h"
@@ -117,6 +118,7 @@
 #include "common/HeartbeatMap.h"
 #include "common/admin_socket.h"
 #include "common/ceph_context.h"
+#include "common/config_snapshot.h"
 
 #include "global/signal_handler.h"
 #include "global/pidfile.h"
@@ -244,9 +246,11 @@ OSDService::OSDService(OSD *osd, ceph::async::io_context_pool& poolctx) :
   monc(osd->monc),
   osd_max_object_size(cct->_conf, "osd_max_object_size"),
   osd_skip_data_digest(cct->_conf, "osd_skip_data_digest"),
+  txn_tracer(osd->cct),
   publish_lock{ceph::make_mutex("OSDService::publish_lock")},
   pre_publish_lock{ceph::make_mutex("OSDService::pre_publish_lock")},
   m_osd_scrub{cct, *this, cct->_conf},
+  repop_batch_thread(this),
   agent_valid_iterator(false),
   agent_ops(0),
   flush_mode_high_count(0),
@@ -541,6 +545,7 @@ void OSDService::init()
   mono_timer.resume();
 
   agent_thread.create("osd_srv_agent");
+  repop_batch_thread.create("osd_srv_repop");
 
   if (cct->_conf->osd_recovery_delay_start)
     defer_recovery(cct->_conf->osd_recovery_delay_start);
@@ -697,6 +702,130 @@ void OSDService::agent_stop()
   agent_thread.join();
 }
 
+// -------------------------------------
+// cross-PG rep op batching
+
+bool OSDService::maybe_batch_repop(int peer,
+				   const ConnectionRef& con,
+				   Message *m,
+				   const OSDMapRef& osdmap)
+{
+  if (m->get_type() != MSG_OSD_REPOP &&
+      m->get_type() != MSG_OSD_REPOPREPLY) {
+    return false;
+  }
+  using namespace ceph::common;
+  auto& conf = cct->_conf.snapshot();
+  if (!conf.get<option_id::osd_repop_batch>() ||
+      osdmap->require_osd_release < ceph_release_t::squid) {
+    return false;
+  }
+  std::lock_guard l{repop_batch_lock};
+  if (repop_batch_stop_flag) {
+    return false;
+  }
+  auto& b = repop_batches[peer];
+  if (b.con != con) {
+    // the peer reconnected; don't reorder across connections
+    if (!b.msgs.empty()) {
+      _send_repop_batch(b);
+    }
+    b.con = con;
+  }
+  if (repop_batch_queued++ == 0) {
+    repop_batch_cond.notify_all();
+  }
+  b.msgs.emplace_back(m, false);
+  if (b.msgs.size() >= conf.get<option_id::osd_repop_batch_max_msgs>()) {
+    _send_repop_batch(b);
+  }
+  return true;
+}
+
+void OSDService::_send_repop_batch(repop_batch_t& b)
+{
+  ceph_assert(ceph_mutex_is_locked(repop_batch_lock));
+  // sends only queue the message on the connection, so they can be
+  // done under the lock, which keeps the per-peer order.
+  repop_batch_queued -= b.msgs.size();
+  if (b.msgs.size() == 1) {
+    b.con->send_message2(std::move(b.msgs.front()));
+  } else {
+    int prio = 0;
+    for (auto& m : b.msgs) {
+      prio = std::max<int>(prio, m->get_priority());
+    }
+    dout(20) << __func__ << " " << b.msgs.size() << " msgs to "
+	     << b.con->get_peer_addr() << dendl;
+    auto batch = ceph::make_message<MOSDRepOpBatch>(std::move(b.msgs));
+    batch->set_priority(prio);
+    b.con->send_message2(std::move(batch));
+  }
+  b.msgs.clear();
+}
+
+void OSDService::_flush_repop_batch(int peer)
+{
+  std::lock_guard l{repop_batch_lock};
+  if (auto p = repop_batches.find(peer);
+      p != repop_batches.end() && !p->second.msgs.empty()) {
+    _send_repop_batch(p->second);
+  }
+}
+
+void OSDService::_flush_repop_batch(Connection *con)
+{
+  std::lock_guard l{repop_batch_lock};
+  for (auto& [peer, b] : repop_batches) {
+    if (b.con.get() == con && !b.msgs.empty()) {
+      _send_repop_batch(b);
+    }
+  }
+}
+
+void OSDService::repop_batch_entry()
+{
+  std::unique_lock l{repop_batch_lock};
+  dout(10) << __func__ << " start" << dendl;
+  while (!repop_batch_stop_flag) {
+    if (repop_batch_queued == 0) {
+      repop_batch_cond.wait(l);
+      continue;
+    }
+    // let ops from other PGs to the same peers accumulate
+    repop_batch_cond.wait_for(
+      l,
+      std::chrono::microseconds(
+	cct->_conf.get_val<uint64_t>("osd_repop_batch_window_us")));
+    for (auto p = repop_batches.begin(); p != repop_batches.end(); ) {
+      if (!p->second.msgs.empty()) {
+	_send_repop_batch(p->second);
+	++p;
+      } else {
+	// forget idle peers (and their connections)
+	p = repop_batches.erase(p);
+      }
+    }
+  }
+  for (auto& [peer, b] : repop_batches) {
+    if (!b.msgs.empty()) {
+      _send_repop_batch(b);
+    }
+  }
+  repop_batches.clear();
+  dout(10) << __func__ << " finish" << dendl;
+}
+
+void OSDService::repop_batch_stop()
+{
+  {
+    std::lock_guard l{repop_batch_lock};
+    repop_batch_stop_flag = true;
+    repop_batch_cond.notify_all();
+  }
+  repop_batch_thread.join();
+}
+
 // -------------------------------------
 
 void OSDService::promote_throttle_recalibrate()
@@ -1062,6 +1191,45 @@ void OSDService::inc_osd_stat_repaired()
   return;
 }
 
+void OSDService::start_recovery_pull(int osd)
+{
+  std::lock_guard l(recovery_pull_lock);
+  ++recovery_pulls[osd];
+}
+
+void OSDService::finish_recovery_pull(int osd)
+{
+  std::lock_guard l(recovery_pull_lock);
+  auto p = recovery_pulls.find(osd);
+  ceph_assert(p != recovery_pulls.end());
+  if (--p->second == 0) {
+    recovery_pulls.erase(p);
+  }
+}
+
+uint64_t OSDService::get_recovery_pull_cost(int osd)
+{
+  uint64_t pulls = 0;
+  {
+    std::lock_guard l(recovery_pull_lock);
+    auto p = recovery_pulls.find(osd);
+    if (p != recovery_pulls.end()) {
+      pulls = p->second;
+    }
+  }
+  uint64_t ping = 0;
+  {
+    std::lock_guard l(stat_lock);
+    auto p = osd_stat.hb_pingtime.find(osd);
+    if (p != osd_stat.hb_pingtime.end()) {
+      ping = p->second.back_pingtime[0];  // 1 minute average
+    }
+  }
+  // the new pull queues behind the ones already in flight from this
+  // peer (for all PGs), each taking at least a cluster round trip
+  return (pulls + 1) * std::max<uint64_t>(ping, 1);
+}
+
 float OSDService::compute_adjusted_ratio(osd_stat_t new_stat, float *pratio,
 				         uint64_t adjust_used)
 {
@@ -1112,7 +1280,10 @@ void OSDService::send_message_osd_cluster(int peer, Message *m, epoch_t from_epo
 	next_map->get_cluster_addrs(peer), false, true);
   }
   maybe_share_map(peer_con.get(), next_map);
-  peer_con->send_message(m);
+  if (peer == whoami || !maybe_batch_repop(peer, peer_con, m, next_map)) {
+    flush_repop_batch(peer);
+    peer_con->send_message(m);
+  }
   release_map(next_map);
 }
 
@@ -1137,7 +1308,11 @@ void OSDService::send_message_osd_cluster(std::vector<std::pair<int, Message*>>&
 	  next_map->get_cluster_addrs(iter.first), false, true);
     }
     maybe_share_map(peer_con.get(), next_map);
-    peer_con->send_message(iter.second);
+    if (iter.first == whoami ||
+	!maybe_batch_repop(iter.first, peer_con, iter.second, next_map)) {
+      flush_repop_batch(iter.first);
+      peer_con->send_message(iter.second);
+    }
   }
   release_map(next_map);
 }
@@ -1160,6 +1335,8 @@ ConnectionRef OSDService::get_con_osd_cluster(int peer, epoch_t from_epoch)
   } else {
     con = osd->cluster_messenger->connect_to_osd(
 	next_map->get_cluster_addrs(peer), false, true);
+    // the caller may send on con directly
+    flush_repop_batch(peer);
   }
   release_map(next_map);
   return con;
@@ -1469,7 +1646,8 @@ MOSDMap *OSDService::build_incremental_map_msg(epoch_t since, epoch_t to,
 }
 
 void OSDService::send_incremental_map(epoch_t since, Connection *con,
-                                      const OSDMapRef& osdmap)
+                                      const OSDMapRef& osdmap,
+                                      MessageEncodeCacheRef encode_cache)
 {
   epoch_t to = osdmap->get_epoch();
   dout(10) << fmt::format("{} epoch range: ({}, {}] to {} {}",
@@ -1484,7 +1662,11 @@ void OSDService::send_incremental_map(epoch_t since, Connection *con,
              << ", only sending most recent" << dendl;
     since = to - cct->_conf->osd_map_share_max_epochs;
   }
-  con->send_message(build_incremental_map_msg(since, to, sblock));
+  MOSDMap *m = build_incremental_map_msg(since, to, sblock);
+  if (encode_cache) {
+    m->set_encode_cache(std::move(encode_cache));
+  }
+  con->send_message(m);
 }
 
 bool OSDService::_get_map_bl(epoch_t e, bufferlist& bl)
@@ -1742,7 +1924,9 @@ void OSDService::queue_for_snap_trim(PG *pg, uint64_t cost_per_object)
        *    average object size, and,
        * 2) The final iteration which returns -ENOENT and performs clean-ups.
        */
-      return cost_per_object * cct->_conf->osd_pg_max_concurrent_snap_trims;
+      return cost_per_object * cct->_conf->osd_pg_max_concurrent_snap_trims *
+	std::max<uint64_t>(
+	  1, cct->_conf.get_val<uint64_t>("osd_snap_trim_batch_objects"));
     } else {
       /* We retain this legacy behavior for WeightedPriorityQueue.
        * This branch should be removed after Squid.
@@ -2411,6 +2595,8 @@ OSD::OSD(CephContext *cct_,
                                            cct->_conf->osd_op_history_duration);
   op_tracker.set_history_slow_op_size_and_threshold(cct->_conf->osd_op_history_slow_op_size,
                                                     cct->_conf->osd_op_history_slow_op_threshold);
+  op_tracker.set_sample_rate(
+    cct->_conf.get_val<uint64_t>("osd_op_tracker_sample_rate"));
   ObjectCleanRegions::set_max_num_intervals(cct->_conf->osd_object_clean_region_max_num_intervals);
 #ifdef WITH_BLKIN
   std::stringstream ss;
@@ -2525,6 +2711,7 @@ int OSD::set_numa_affinity()
 
   // check network numa node(s)
   int front_node = -1, back_node = -1;
+  int net_node = -1;
   string front_iface = pick_iface(
     cct,
     client_messenger->get_myaddrs().front().get_sockaddr_storage());
@@ -2551,6 +2738,13 @@ int OSD::set_numa_affinity()
       } else {
 	dout(1) << __func__ << " objectstore and network numa nodes do not match"
 		<< dendl;
+	if (store_node >= 0 &&
+	    g_conf().get_val<bool>("osd_numa_auto_split_affinity")) {
+	  // run the messenger workers next to the nic, the rest next to the
+	  // storage
+	  numa_node = store_node;
+	  net_node = front_node;
+	}
       }
     } else if (back_node == -2) {
       dout(1) << __func__ << " cluster network " << back_iface
@@ -2569,6 +2763,7 @@ int OSD::set_numa_affinity()
   if (int node = g_conf().get_val<int64_t>("osd_numa_node"); node >= 0) {
     // this takes precedence over the automagic logic above
     numa_node = node;
+    net_node = -1;
   }
   if (numa_node >= 0) {
     int r = get_numa_node_cpu_set(numa_node, &numa_cpu_set_size, &numa_cpu_set);
@@ -2589,7 +2784,24 @@ int OSD::set_numa_affinity()
 	numa_node = -1;
       }
     }
-  } else {
+  }
+  if (numa_node >= 0 && net_node >= 0) {
+    size_t net_cpu_set_size;
+    cpu_set_t net_cpu_set;
+    int r = get_numa_node_cpu_set(net_node, &net_cpu_set_size, &net_cpu_set);
+    if (r >= 0) {
+      r = set_cpu_affinity_named_threads("msgr-worker-", net_cpu_set_size,
+					 &net_cpu_set);
+    }
+    if (r < 0) {
+      derr << __func__ << " failed to set messenger worker numa affinity: "
+	   << cpp_strerror(r) << dendl;
+    } else {
+      dout(1) << __func__ << " setting numa affinity of " << r
+	      << " messenger workers to node " << net_node << " cpus "
+	      << cpu_set_to_str_list(net_cpu_set_size, &net_cpu_set) << dendl;
+    }
+  } else if (numa_node < 0) {
     dout(1) << __func__ << " not setting numa affinity" << dendl;
   }
   return 0;
@@ -2981,6 +3193,34 @@ will start to track new ops received afterwards.";
     store->generate_db_histogram(f);
   } else if (prefix == "flush_store_cache") {
     store->flush_cache(&ss);
+  } else if (prefix == "trace_transactions") {
+    string action = cmd_getval_or<string>(cmdmap, "action", "status");
+    if (action == "start") {
+      string path;
+      if (!cmd_getval(cmdmap, "path", path)) {
+	ss << "no path specified";
+	ret = -EINVAL;
+	goto out;
+      }
+      int64_t sample = cmd_getval_or<int64_t>(cmdmap, "sample", 1);
+      bool elide_data = cmd_getval_or<bool>(cmdmap, "elide_data", false);
+      int64_t max_mb = cmd_getval_or<int64_t>(cmdmap, "max_mb", 1024);
+      if (sample < 1 || max_mb < 0) {
+	ss << "sample must be positive, and max_mb not negative";
+	ret = -EINVAL;
+	goto out;
+      }
+      ret = service.txn_tracer.start(path, sample, elide_data,
+				     uint64_t(max_mb) << 20, ss);
+      if (ret < 0) {
+	goto out;
+      }
+    } else if (action == "stop") {
+      service.txn_tracer.stop();
+    }
+    f->open_object_section("trace_transactions");
+    service.txn_tracer.dump(f);
+    f->close_section();
   } else if (prefix == "rotate-stored-key") {
     store->write_meta("osd_key", inbl.to_str());
   } else if (prefix == "dump_pgstate_history") {
@@ -4223,6 +4463,17 @@ void OSD::final_init()
                                      asok_hook,
                                      "Flush bluestore internal cache");
   ceph_assert(r == 0);
+  r = admin_socket->register_command(
+    "trace_transactions "
+    "name=action,type=CephChoices,strings=start|stop|status,req=false "
+    "name=path,type=CephString,req=false "
+    "name=sample,type=CephInt,range=1,req=false "
+    "name=elide_data,type=CephBool,req=false "
+    "name=max_mb,type=CephInt,range=0,req=false",
+    asok_hook,
+    "record the transactions and reads PGs send to the object store to "
+    "path, for one in every <sample> PGs, see ceph_replay_transactions");
+  ceph_assert(r == 0);
   r = admin_socket->register_command("rotate-stored-key",
                                      asok_hook,
                                      "Update the stored osd_key");
@@ -4701,6 +4952,8 @@ int OSD::shutdown()
   dout(10) << "stopping agent" << dendl;
   service.agent_stop();
 
+  service.repop_batch_stop();
+
   boot_finisher.wait_for_empty();
 
   osd_lock.lock();
@@ -5280,7 +5533,10 @@ void OSD::load_pgs()
     derr << "failed to list pgs: " << cpp_strerror(-r) << dendl;
   }
 
-  int num = 0;
+  // create the PGs serially, then read their state (info, log and
+  // missing set) in parallel: that is where the time goes with many PGs
+  // and long logs
+  vector<pair<PGRef, coll_t>> to_load;
   for (vector<coll_t>::iterator it = ls.begin();
        it != ls.end();
        ++it) {
@@ -5333,20 +5589,52 @@ void OSD::load_pgs()
       recursive_remove_collection(cct, store.get(), pgid, *it);
       continue;
     }
+    to_load.emplace_back(std::move(pg), *it);
+  }
 
-    // there can be no waiters here, so we don't call _wake_pg_slot
-
+  // there can be no waiters here, so we don't call _wake_pg_slot
+  auto read_pg_state = [this](PG *pg) {
     pg->lock();
     pg->ch = store->open_collection(pg->coll);
-
     // read pg state, log
     pg->read_state(store.get());
+    pg->unlock();
+  };
+  const size_t num_threads = std::min<size_t>(
+    cct->_conf.get_val<uint64_t>("osd_load_pgs_threads"), to_load.size());
+  if (num_threads > 1) {
+    dout(10) << __func__ << " reading " << to_load.size() << " pgs with "
+	     << num_threads << " threads" << dendl;
+    std::atomic<size_t> next = {0};
+    vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+      threads.push_back(make_named_thread(
+	"osd_load_pgs",
+	[&] {
+	  for (size_t n = next++; n < to_load.size(); n = next++) {
+	    read_pg_state(to_load[n].first.get());
+	  }
+	}));
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+  } else {
+    for (auto& [pg, coll] : to_load) {
+      read_pg_state(pg.get());
+    }
+  }
 
+  int num = 0;
+  for (auto& [pg, coll] : to_load) {
+    spg_t pgid = pg->get_pgid();
+    pg->lock();
     if (pg->dne())  {
-      dout(10) << "load_pgs " << *it << " deleting dne" << dendl;
+      dout(10) << "load_pgs " << coll << " deleting dne" << dendl;
       pg->ch = nullptr;
       pg->unlock();
-      recursive_remove_collection(cct, store.get(), pgid, *it);
+      recursive_remove_collection(cct, store.get(), pgid, coll);
       continue;
     }
     {
@@ -5655,18 +5943,36 @@ void OSD::maybe_update_heartbeat_peers()
 
   dout(10) << "maybe_update_heartbeat_peers updating" << dendl;
 
+  auto subtree = cct->_conf.get_val<string>("mon_osd_reporter_subtree_level");
 
   // build heartbeat from set
   if (is_active()) {
     vector<PGRef> pgs;
     _get_pgs(&pgs);
+    set<int> pg_peers;
     for (auto& pg : pgs) {
       pg->with_heartbeat_peers([&](int peer) {
 	  if (get_osdmap()->is_up(peer)) {
-	    _add_heartbeat_peer(peer);
+	    pg_peers.insert(peer);
 	  }
 	});
     }
+    if (auto per_subtree = cct->_conf.get_val<uint64_t>(
+	  "osd_heartbeat_max_peers_per_subtree"); per_subtree > 0) {
+      // only a sample of each subtree; keep the current ones if we can
+      set<int> current, sampled;
+      for (auto& [peer, hi] : heartbeat_peers) {
+	current.insert(peer);
+      }
+      get_osdmap()->sample_osds_by_subtree(whoami, subtree, per_subtree,
+					    pg_peers, current, &sampled);
+      dout(10) << __func__ << " sampled " << sampled.size() << " of "
+	       << pg_peers.size() << " pg peers" << dendl;
+      pg_peers.swap(sampled);
+    }
+    for (auto peer : pg_peers) {
+      _add_heartbeat_peer(peer);
+    }
   }
 
   // include next and previous up osds to ensure we have a fully-connected set
@@ -5681,7 +5987,6 @@ void OSD::maybe_update_heartbeat_peers()
   // make sure we have at least **min_down** osds coming from different
   // subtree level (e.g., hosts) for fast failure detection.
   auto min_down = cct->_conf.get_val<uint64_t>("mon_osd_min_down_reporters");
-  auto subtree = cct->_conf.get_val<string>("mon_osd_reporter_subtree_level");
   auto limit = std::max(min_down, (uint64_t)cct->_conf->osd_heartbeat_min_peers);
   get_osdmap()->get_random_up_osds_by_subtree(
     whoami, subtree, limit, want, &want);
@@ -7574,6 +7879,8 @@ void OSD::ms_fast_dispatch(Message *m)
     return handle_fast_pg_info(static_cast<MOSDPGInfo*>(m));
   case MSG_OSD_PG_REMOVE:
     return handle_fast_pg_remove(static_cast<MOSDPGRemove*>(m));
+  case MSG_OSD_REPOP_BATCH:
+    return handle_fast_repop_batch(static_cast<MOSDRepOpBatch*>(m));
     // these are single-pg messages that handle themselves
   case MSG_OSD_PG_LOG:
   case MSG_OSD_PG_TRIM:
@@ -7948,6 +8255,44 @@ struct C_OnMapCommit : public Context {
   }
 };
 
+void OSD::maybe_fanout_map(epoch_t first, const entity_name_t& from)
+{
+  ceph_assert(ceph_mutex_is_locked(osd_lock));
+  unsigned fanout = cct->_conf.get_val<uint64_t>("osd_map_fanout");
+  OSDMapRef osdmap = get_osdmap();
+  epoch_t e = osdmap->get_epoch();
+  if (!fanout || e <= last_fanout_epoch) {
+    return;
+  }
+  epoch_t since = std::max(first - 1, last_fanout_epoch);
+  last_fanout_epoch = e;
+
+  vector<int> order, to;
+  osdmap->get_fanout_order(&order);
+  osdmap->get_fanout_children(order, whoami, fanout, &to);
+  int root = osdmap->get_fanout_root(order);
+  if (from.is_mon() && root != whoami && root >= 0) {
+    // the mon could not reach the root and fed us instead; hand the
+    // maps to the root so that the whole tree sees them
+    to.push_back(root);
+  }
+  // every child gets the same maps: encode them once per feature set
+  auto encode_cache = std::make_shared<MessageEncodeCache>();
+  for (auto peer : to) {
+    // never hand the maps back to where they came from
+    if (peer == whoami || (from.is_osd() && peer == from.num())) {
+      continue;
+    }
+    ConnectionRef con = service.get_con_osd_cluster(peer, e);
+    if (!con) {
+      continue;
+    }
+    dout(20) << __func__ << " e" << since << ".." << e << " to osd." << peer
+	     << dendl;
+    service.send_incremental_map(since, con.get(), osdmap, encode_cache);
+  }
+}
+
 void OSD::osdmap_subscribe(version_t epoch, bool force_request)
 {
   std::lock_guard l(osdmap_subscribe_lock);
@@ -8618,6 +8963,7 @@ void OSD::_committed_osd_maps(epoch_t first, epoch_t last, MOSDMap *m)
 
   if (is_active()) {
     activate_map();
+    maybe_fanout_map(first, m->get_source());
   }
 
   if (do_shutdown) {
@@ -9363,6 +9709,32 @@ void OSD::handle_fast_pg_remove(MOSDPGRemove *m)
   m->put();
 }
 
+void OSD::handle_fast_repop_batch(MOSDRepOpBatch *m)
+{
+  dout(20) << __func__ << " " << *m << " from " << m->get_source() << dendl;
+  if (!require_osd_peer(m)) {
+    m->put();
+    return;
+  }
+  for (auto& sub : m->msgs) {
+    if (sub->get_type() != MSG_OSD_REPOP &&
+	sub->get_type() != MSG_OSD_REPOPREPLY) {
+      dout(0) << __func__ << " unexpected " << *sub << " from "
+	      << m->get_source() << dendl;
+      continue;
+    }
+    // as if it had arrived on its own
+    sub->set_connection(m->get_connection());
+    sub->set_src(m->get_source());
+    sub->set_recv_stamp(m->get_recv_stamp());
+    sub->set_throttle_stamp(m->get_throttle_stamp());
+    sub->set_recv_complete_stamp(m->get_recv_complete_stamp());
+    sub->set_dispatch_stamp(m->get_dispatch_stamp());
+    ms_fast_dispatch(sub.detach());
+  }
+  m->put();
+}
+
 void OSD::handle_fast_force_recovery(MOSDForceRecovery *m)
 {
   dout(10) << __func__ << " " << *m << dendl;
@@ -9848,6 +10220,7 @@ const char** OSD::get_tracked_conf_keys() const
     "osd_op_history_slow_op_size",
     "osd_op_history_slow_op_threshold",
     "osd_enable_op_tracker",
+    "osd_op_tracker_sample_rate",
     "osd_map_cache_size",
     "osd_pg_epoch_max_lag_factor",
     "osd_pg_epoch_persisted_max_stale",
@@ -9952,6 +10325,10 @@ void OSD::handle_conf_change(const ConfigProxy& conf,
   if (changed.count("osd_enable_op_tracker")) {
       op_tracker.set_tracking(cct->_conf->osd_enable_op_tracker);
   }
+  if (changed.count("osd_op_tracker_sample_rate")) {
+    op_tracker.set_sample_rate(
+      cct->_conf.get_val<uint64_t>("osd_op_tracker_sample_rate"));
+  }
   if (changed.count("osd_map_cache_size")) {
     service.map_cache.set_size(cct->_conf->osd_map_cache_size);
     service.map_bl_cache.set_size(cct->_conf->osd_map_cache_size);
@@ -10631,6 +11008,9 @@ int OSDShard::_wake_pg_slot(
     }
   }
   slot->waiting_peering.clear();
+  // the items handed off to a draining thread were requeued with the rest
+  slot->num_running -= slot->handed_off;
+  slot->handed_off = 0;
   ++slot->requeue_seq;
   return count;
 }
@@ -10889,10 +11269,32 @@ void OSD::ShardedOpWQ::_add_slot_waiter(
 #undef dout_prefix
 #define dout_prefix *_dout << "osd." << osd->whoami << " op_wq(" << shard_index << ") "
 
+// a stealing thread that only found items scheduled for later backs
+// off until then, rather than spinning on the other shard
+static thread_local ceph::real_clock::time_point no_steal_until;
+
+OSDShard *OSD::ShardedOpWQ::_steal_shard(uint32_t shard_index)
+{
+  if (ceph::real_clock::now() < no_steal_until) {
+    return nullptr;
+  }
+  for (uint32_t i = 1; i < osd->num_shards; ++i) {
+    auto victim = osd->shards[(shard_index + i) % osd->num_shards];
+    if (!victim->shard_lock.try_lock()) {
+      continue;
+    }
+    if (!victim->scheduler->empty()) {
+      return victim;
+    }
+    victim->shard_lock.unlock();
+  }
+  return nullptr;
+}
+
 void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
 {
   uint32_t shard_index = thread_index % osd->num_shards;
-  auto& sdata = osd->shards[shard_index];
+  OSDShard *sdata = osd->shards[shard_index];
   ceph_assert(sdata);
 
   // If all threads of shards do oncommits, there is a out-of-order
@@ -10903,7 +11305,28 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
 
   // peek at spg_t
   sdata->shard_lock.lock();
+  bool stolen = false;
   if (sdata->scheduler->empty() &&
+      (!is_smallest_thread_index || sdata->context_queue.empty()) &&
+      osd->num_shards > 1 &&
+      osd->cct->_conf.get_val<bool>("osd_op_shard_steal")) {
+    // Rather than sleeping, run an item queued on a busy shard.  This
+    // thread then acts as one more thread of that shard: the item goes
+    // through the shard's pg slot as usual, so per-PG ordering holds
+    // just as it does with several threads per shard.
+    sdata->shard_lock.unlock();
+    if (auto victim = _steal_shard(shard_index); victim) {
+      dout(20) << __func__ << " shard " << shard_index << " stealing from "
+	       << victim->shard_name << dendl;
+      sdata = victim;
+      is_smallest_thread_index = false;
+      stolen = true;
+    } else {
+      sdata->shard_lock.lock();
+    }
+  }
+  if (!stolen &&
+      sdata->scheduler->empty() &&
       (!is_smallest_thread_index || sdata->context_queue.empty())) {
     std::unique_lock wait_lock{sdata->sdata_wait_lock};
     if (is_smallest_thread_index && !sdata->context_queue.empty()) {
@@ -10966,6 +11389,12 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
     // If the work item is scheduled in the future, wait until
     // the time returned in the dequeue response before retrying.
     if (auto when_ready = std::get_if<double>(&work_item)) {
+      if (stolen) {
+	// leave it to the shard's own threads
+	no_steal_until = ceph::real_clock::from_double(*when_ready);
+	sdata->shard_lock.unlock();
+	return;
+      }
       if (is_smallest_thread_index) {
         sdata->shard_lock.unlock();
         handle_oncommits(oncommits);
@@ -11020,6 +11449,59 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
   dout(20) << __func__ << " " << slot->to_process.back()
 	   << " queued" << dendl;
 
+  if (slot->pg && slot->draining) {
+    // another thread holds (or is taking) the pg lock and will run this
+    // item after its own; don't block a thread of the shard on the pg lock
+    dout(20) << __func__ << " " << token << " busy, handing off" << dendl;
+    ++slot->handed_off;
+    ++slot->num_running;
+    sdata->shard_lock.unlock();
+    handle_oncommits(oncommits);
+    return;
+  }
+  // not the thread that runs the oncommits: we could drain a hot pg for long
+  const bool drain = !is_smallest_thread_index && slot->pg &&
+    osd->cct->_conf.get_val<bool>("osd_op_handoff_busy_pg");
+  if (drain) {
+    slot->draining = true;
+  }
+  _process_slot(sdata, token, slot, hb, oncommits);
+  if (!drain) {
+    return;
+  }
+
+  // run whatever was handed off to us meanwhile
+  list<Context *> no_oncommits;
+  while (true) {
+    sdata->shard_lock.lock();
+    auto q = sdata->pg_slots.find(token);
+    if (q == sdata->pg_slots.end()) {
+      sdata->shard_lock.unlock();
+      break;
+    }
+    slot = q->second.get();
+    if (slot->handed_off == 0) {
+      slot->draining = false;
+      sdata->shard_lock.unlock();
+      break;
+    }
+    --slot->handed_off;
+    --slot->num_running;
+    dout(20) << __func__ << " " << token << " running handed off item" << dendl;
+    osd->cct->get_heartbeat_map()->reset_timeout(hb,
+      timeout_interval.load(), suicide_interval.load());
+    _process_slot(sdata, token, slot, hb, no_oncommits);
+  }
+}
+
+void OSD::ShardedOpWQ::_process_slot(
+  OSDShard *sdata,
+  spg_t token,
+  OSDShardPGSlot *slot,
+  heartbeat_handle_d *hb,
+  list<Context *>& oncommits)
+{
+  // called with shard_lock held, returns with it dropped
  retry_pg:
   PGRef pg = slot->pg;
 
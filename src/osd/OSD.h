@@ -32,6 +32,7 @@
 #include "mgr/MgrClient.h"
 
 #include "os/ObjectStore.h"
+#include "os/TransactionTracer.h"
 
 #include "include/CompatSet.h"
 #include "include/common_fwd.h"
@@ -90,6 +91,7 @@ class MOSDPGCreate2;
 class MOSDPGNotify;
 class MOSDPGInfo;
 class MOSDPGRemove;
+class MOSDRepOpBatch;
 class MOSDForceRecovery;
 class MMonGetPurgedSnapsReply;
 
@@ -117,6 +119,9 @@ public:
   md_config_cacher_t<Option::size_t> osd_max_object_size;
   md_config_cacher_t<bool> osd_skip_data_digest;
 
+  /// records what the PGs send to the store, see "trace_transactions"
+  TransactionTracer txn_tracer;
+
   void enqueue_back(OpSchedulerItem&& qi);
   void enqueue_front(OpSchedulerItem&& qi);
   /// scheduler cost per io, only valid for mclock, asserts for wpq
@@ -212,8 +217,10 @@ public:
 		       const OSDMapRef& osdmap,
 		       epoch_t peer_epoch_lb=0);
 
+  /// encode_cache, if given, is shared with other peers sent the same maps
   void send_incremental_map(epoch_t since, Connection *con,
-			    const OSDMapRef& osdmap);
+			    const OSDMapRef& osdmap,
+			    MessageEncodeCacheRef encode_cache = nullptr);
   MOSDMap *build_incremental_map_msg(epoch_t from, epoch_t to,
                                        OSDSuperblock& superblock);
 
@@ -222,9 +229,11 @@ public:
   void send_message_osd_cluster(int peer, Message *m, epoch_t from_epoch);
   void send_message_osd_cluster(std::vector<std::pair<int, Message*>>& messages, epoch_t from_epoch);
   void send_message_osd_cluster(MessageRef m, Connection *con) {
+    flush_repop_batch(con);
     con->send_message2(std::move(m));
   }
   void send_message_osd_cluster(Message *m, const ConnectionRef& con) {
+    flush_repop_batch(con.get());
     con->send_message(m);
   }
   void send_message_osd_client(Message *m, const ConnectionRef& con) {
@@ -262,6 +271,49 @@ public:
     return scrub_reserver;
   }
 
+ private:
+  // -- cross-PG rep op batching --
+  struct repop_batch_t {
+    ConnectionRef con;
+    std::vector<MessageRef> msgs;
+  };
+  ceph::mutex repop_batch_lock =
+    ceph::make_mutex("OSDService::repop_batch_lock");
+  ceph::condition_variable repop_batch_cond;
+  std::map<int, repop_batch_t> repop_batches; ///< by peer osd
+  std::atomic<unsigned> repop_batch_queued = {0};
+  bool repop_batch_stop_flag = false;
+  struct RepOpBatchThread : public Thread {
+    OSDService *osd;
+    explicit RepOpBatchThread(OSDService *o) : osd(o) {}
+    void *entry() override {
+      osd->repop_batch_entry();
+      return NULL;
+    }
+  } repop_batch_thread;
+
+  /// queue m for peer if it can go out as part of a batch
+  bool maybe_batch_repop(int peer, const ConnectionRef& con, Message *m,
+			 const OSDMapRef& osdmap);
+  void _send_repop_batch(repop_batch_t& b);
+  void _flush_repop_batch(int peer);
+  void _flush_repop_batch(Connection *con);
+  /// preserve ordering of anything else we send to a peer with queued ops
+  void flush_repop_batch(int peer) {
+    if (repop_batch_queued) {
+      _flush_repop_batch(peer);
+    }
+  }
+  void flush_repop_batch(Connection *con) {
+    if (repop_batch_queued) {
+      _flush_repop_batch(con);
+    }
+  }
+
+public:
+  void repop_batch_entry();
+  void repop_batch_stop();
+
  private:
   // -- agent shared state --
   ceph::mutex agent_lock = ceph::make_mutex("OSDService::agent_lock");
@@ -752,6 +804,17 @@ public:
     return;
   }
 
+  // -- recovery pull sources --
+private:
+  ceph::mutex recovery_pull_lock =
+    ceph::make_mutex("OSDService::recovery_pull_lock");
+  std::map<int, uint32_t> recovery_pulls;  ///< osd -> pulls in flight from it
+public:
+  void start_recovery_pull(int osd);
+  void finish_recovery_pull(int osd);
+  /// relative cost of pulling one more object from osd, lower is better
+  uint64_t get_recovery_pull_cost(int osd);
+
   // -- OSD Full Status --
 private:
   friend TestOpsSocketHook;
@@ -949,6 +1012,11 @@ struct OSDShardPGSlot {
   std::deque<OpSchedulerItem> to_process; ///< order items for this slot
   int num_running = 0;          ///< _process threads doing pg lookup/lock
 
+  /// a _process thread will keep running this slot's items after its own
+  bool draining = false;
+  /// items left in to_process for the draining thread (counted in num_running)
+  unsigned handed_off = 0;
+
   std::deque<OpSchedulerItem> waiting;   ///< waiting for pg (or map + pg)
 
   /// waiting for map (peering evt)
@@ -1542,6 +1610,9 @@ protected:
    * instantiated; in that case they will all get requeued together by
    * wake_pg_waiters, and (2) when wake_pg_waiters just ran, waiting_for_pg
    * and already requeued the items.
+   *
+   * An item queued while another thread is draining the slot is left in
+   * to_process for that thread (handed_off); it still counts in num_running.
    */
   friend class ceph::osd::scheduler::PGOpItem;
   friend class ceph::osd::scheduler::PGPeeringItem;
@@ -1569,8 +1640,14 @@ protected:
       OSDShardPGSlot *slot,
       OpSchedulerItem&& qi);
 
+    /// find another shard with queued work; returns it with shard_lock held
+    OSDShard *_steal_shard(uint32_t shard_index);
+
     /// try to do some work
     void _process(uint32_t thread_index, ceph::heartbeat_handle_d *hb) override;
+    void _process_slot(OSDShard *sdata, spg_t token, OSDShardPGSlot *slot,
+		       ceph::heartbeat_handle_d *hb,
+		       std::list<Context*>& oncommits);
 
     void stop_for_fast_shutdown();
 
@@ -1715,6 +1792,10 @@ protected:
     PeeringCtx &rctx);
   void consume_map();
   void activate_map();
+  /// forward newly committed maps, received from @a from, to our children
+  /// in the map fan-out tree
+  void maybe_fanout_map(epoch_t first, const entity_name_t& from);
+  epoch_t last_fanout_epoch = 0;
 
   // osd map cache (past osd maps)
   OSDMapRef get_map(epoch_t e) {
@@ -1866,6 +1947,7 @@ protected:
   void handle_pg_notify_nopg(const MNotifyRec& q);
   void handle_fast_pg_info(MOSDPGInfo *m);
   void handle_fast_pg_remove(MOSDPGRemove *m);
+  void handle_fast_repop_batch(MOSDRepOpBatch *m);
 
 public:
   // used by OSDShard
@@ -1916,6 +1998,7 @@ private:
     case MSG_OSD_RECOVERY_RESERVE:
     case MSG_OSD_REPOP:
     case MSG_OSD_REPOPREPLY:
+    case MSG_OSD_REPOP_BATCH:
     case MSG_OSD_PG_PUSH:
     case MSG_OSD_PG_PULL:
     case MSG_OSD_PG_PUSH_REPLY:
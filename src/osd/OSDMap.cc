@@ -1770,7 +1770,7 @@ uint64_t OSDMap::get_features(int entity_type, uint64_t *pmask) const
     features |= CEPH_FEATURE_CRUSH_MSR;
   mask |= CEPH_FEATURES_CRUSH;
 
-  if (!pg_upmap.empty() || !pg_upmap_items.empty() || !pg_upmap_primaries.empty())
+  if (!pg_upmap->empty() || !pg_upmap_items->empty() || !pg_upmap_primaries->empty())
     features |= CEPH_FEATUREMASK_OSDMAP_PG_UPMAP;
   mask |= CEPH_FEATUREMASK_OSDMAP_PG_UPMAP;
 
@@ -1975,6 +1975,18 @@ void OSDMap::dedup(const OSDMap *o, OSDMap *n)
   if (o->osd_uuid->size() == n->osd_uuid->size() &&
       *o->osd_uuid == *n->osd_uuid)
     n->osd_uuid = o->osd_uuid;
+
+  // do the upmap tables match?  these can hold an entry for most pgs
+  // once the balancer has run, and rarely change between epochs.
+  if (o->pg_upmap->size() == n->pg_upmap->size() &&
+      *o->pg_upmap == *n->pg_upmap)
+    n->pg_upmap = o->pg_upmap;
+  if (o->pg_upmap_items->size() == n->pg_upmap_items->size() &&
+      *o->pg_upmap_items == *n->pg_upmap_items)
+    n->pg_upmap_items = o->pg_upmap_items;
+  if (o->pg_upmap_primaries->size() == n->pg_upmap_primaries->size() &&
+      *o->pg_upmap_primaries == *n->pg_upmap_primaries)
+    n->pg_upmap_primaries = o->pg_upmap_primaries;
 }
 
 void OSDMap::clean_temps(CephContext *cct,
@@ -2066,10 +2078,10 @@ void OSDMap::clean_temps(CephContext *cct,
 
 void OSDMap::get_upmap_pgs(vector<pg_t> *upmap_pgs) const
 {
-  upmap_pgs->reserve(pg_upmap.size() + pg_upmap_items.size());
-  for (auto& p : pg_upmap)
+  upmap_pgs->reserve(pg_upmap->size() + pg_upmap_items->size());
+  for (auto& p : *pg_upmap)
     upmap_pgs->push_back(p.first);
-  for (auto& p : pg_upmap_items)
+  for (auto& p : *pg_upmap_items)
     upmap_pgs->push_back(p.first);
 }
 
@@ -2149,8 +2161,8 @@ bool OSDMap::check_pg_upmaps(
       continue;
     // okay, upmap is valid
     // continue to check if it is still necessary
-    auto i = pg_upmap.find(pg);
-    if (i != pg_upmap.end()) {
+    auto i = pg_upmap->find(pg);
+    if (i != pg_upmap->end()) {
       if (i->second == raw) {
         ldout(cct, 10) << __func__ << "removing redundant pg_upmap " << i->first << " "
                        << i->second << dendl;
@@ -2165,21 +2177,21 @@ bool OSDMap::check_pg_upmaps(
         continue;
       }
     }
-    auto j = pg_upmap_items.find(pg);
-    if (j != pg_upmap_items.end()) {
+    auto j = pg_upmap_items->find(pg);
+    if (j != pg_upmap_items->end()) {
       mempool::osdmap::vector<pair<int,int>> newmap;
       for (auto& p : j->second) {
 	auto osd_from = p.first;
 	auto osd_to = p.second;
         if (std::find(raw.begin(), raw.end(), osd_from) == raw.end()) {
           // cancel mapping if source osd does not exist anymore
-          ldout(cct, 20) << __func__ << " pg_upmap_items (source osd does not exist) " << pg_upmap_items << dendl;
+          ldout(cct, 20) << __func__ << " pg_upmap_items (source osd does not exist) " << *pg_upmap_items << dendl;
           continue;
         }
         if (osd_to != CRUSH_ITEM_NONE && osd_to < max_osd &&
             osd_to >= 0 && osd_weight[osd_to] == 0) {
           // cancel mapping if target osd is out
-          ldout(cct, 20) << __func__ << " pg_upmap_items (target osd is out) " << pg_upmap_items << dendl;
+          ldout(cct, 20) << __func__ << " pg_upmap_items (target osd is out) " << *pg_upmap_items << dendl;
           continue;
         }
         newmap.push_back(p);
@@ -2219,8 +2231,8 @@ void OSDMap::clean_pg_upmaps(
                      << dendl;
       pending_inc->new_pg_upmap.erase(i);
     }
-    auto j = pg_upmap.find(pg);
-    if (j != pg_upmap.end()) {
+    auto j = pg_upmap->find(pg);
+    if (j != pg_upmap->end()) {
       ldout(cct, 10) << __func__ << " cancel invalid pg_upmap entry "
                      << j->first << "->" << j->second
                      << dendl;
@@ -2234,8 +2246,8 @@ void OSDMap::clean_pg_upmaps(
                      << dendl;
       pending_inc->new_pg_upmap_items.erase(p);
     }
-    auto q = pg_upmap_items.find(pg);
-    if (q != pg_upmap_items.end()) {
+    auto q = pg_upmap_items->find(pg);
+    if (q != pg_upmap_items->end()) {
       ldout(cct, 10) << __func__ << " cancel invalid "
                      << "pg_upmap_items entry "
                      << q->first << "->" << q->second
@@ -2461,24 +2473,40 @@ int OSDMap::apply_incremental(const Incremental &inc)
       (*primary_temp)[pg.first] = pg.second;
   }
 
+  // the upmap tables may be shared with an older epoch (see dedup());
+  // copy them before they are modified
+  if ((!inc.new_pg_upmap.empty() || !inc.old_pg_upmap.empty()) &&
+      pg_upmap.use_count() > 1) {
+    pg_upmap = std::make_shared<pg_upmap_t>(*pg_upmap);
+  }
+  if ((!inc.new_pg_upmap_items.empty() || !inc.old_pg_upmap_items.empty()) &&
+      pg_upmap_items.use_count() > 1) {
+    pg_upmap_items = std::make_shared<pg_upmap_items_t>(*pg_upmap_items);
+  }
+  if ((!inc.new_pg_upmap_primary.empty() ||
+       !inc.old_pg_upmap_primary.empty()) &&
+      pg_upmap_primaries.use_count() > 1) {
+    pg_upmap_primaries =
+      std::make_shared<pg_upmap_primaries_t>(*pg_upmap_primaries);
+  }
   for (auto& p : inc.new_pg_upmap) {
-    pg_upmap[p.first] = p.second;
+    (*pg_upmap)[p.first] = p.second;
   }
   for (auto& pg : inc.old_pg_upmap) {
-    pg_upmap.erase(pg);
+    pg_upmap->erase(pg);
   }
   for (auto& p : inc.new_pg_upmap_items) {
-    pg_upmap_items[p.first] = p.second;
+    (*pg_upmap_items)[p.first] = p.second;
   }
   for (auto& pg : inc.old_pg_upmap_items) {
-    pg_upmap_items.erase(pg);
+    pg_upmap_items->erase(pg);
   }
 
   for (auto& [pg, prim] : inc.new_pg_upmap_primary) {
-    pg_upmap_primaries[pg] = prim;
+    (*pg_upmap_primaries)[pg] = prim;
   }
   for (auto& pg : inc.old_pg_upmap_primary) {
-    pg_upmap_primaries.erase(pg);
+    pg_upmap_primaries->erase(pg);
   }
 
   // blocklist
@@ -2700,8 +2728,8 @@ int OSDMap::_pick_primary(const vector<int>& osds) const
 void OSDMap::_apply_upmap(const pg_pool_t& pi, pg_t raw_pg, vector<int> *raw) const
 {
   pg_t pg = pi.raw_pg_to_pg(raw_pg);
-  auto p = pg_upmap.find(pg);
-  if (p != pg_upmap.end()) {
+  auto p = pg_upmap->find(pg);
+  if (p != pg_upmap->end()) {
     // make sure targets aren't marked out
     for (auto osd : p->second) {
       if (osd != CRUSH_ITEM_NONE && osd < max_osd && osd >= 0 &&
@@ -2714,8 +2742,8 @@ void OSDMap::_apply_upmap(const pg_pool_t& pi, pg_t raw_pg, vector<int> *raw) co
     // continue to check and apply pg_upmap_items if any
   }
 
-  auto q = pg_upmap_items.find(pg);
-  if (q != pg_upmap_items.end()) {
+  auto q = pg_upmap_items->find(pg);
+  if (q != pg_upmap_items->end()) {
     // NOTE: this approach does not allow a bidirectional swap,
     // e.g., [[1,2],[2,1]] applied to [0,1,2] -> [0,2,1].
     for (auto& [osd_from, osd_to] : q->second) {
@@ -2742,8 +2770,8 @@ void OSDMap::_apply_upmap(const pg_pool_t& pi, pg_t raw_pg, vector<int> *raw) co
       }
     }
   }
-  auto r = pg_upmap_primaries.find(pg);
-  if (r != pg_upmap_primaries.end()) {
+  auto r = pg_upmap_primaries->find(pg);
+  if (r != pg_upmap_primaries->end()) {
     auto new_prim = r->second;	
     // Apply mapping only if new primary is not marked out and valid osd id
     if (new_prim != CRUSH_ITEM_NONE && new_prim < max_osd && new_prim >= 0 &&
@@ -2970,6 +2998,53 @@ void OSDMap::_pg_to_up_acting_osds(
     *acting_primary = _acting_primary;
 }
 
+void OSDMap::pg_range_to_up_acting_osds(
+  int64_t poolid, unsigned ps_begin, unsigned ps_end,
+  const pg_mapping_fn_t& f) const
+{
+  const pg_pool_t *pool = get_pg_pool(poolid);
+  ceph_assert(pool);
+  ceph_assert(ps_begin <= ps_end);
+
+  // bound the memory used for raw crush results
+  constexpr unsigned batch_size = 1024;
+  const unsigned size = pool->get_size();
+  const int ruleno = pool->get_crush_rule();
+  vector<int> pps;
+  vector<vector<int>> raws;
+  for (unsigned begin = ps_begin; begin < ps_end; begin += batch_size) {
+    unsigned end = std::min(begin + batch_size, ps_end);
+    pps.resize(end - begin);
+    for (unsigned ps = begin; ps < end; ++ps) {
+      pps[ps - begin] = pool->raw_pg_to_pps(pg_t(ps, poolid));
+    }
+    if (ruleno >= 0) {
+      crush->do_rule_batch(ruleno, pps, raws, size, osd_weight, poolid);
+    } else {
+      raws.assign(pps.size(), vector<int>());
+    }
+    for (unsigned ps = begin; ps < end; ++ps) {
+      pg_t pg(ps, poolid);
+      vector<int>& raw = raws[ps - begin];
+      vector<int> up, acting;
+      int up_primary, acting_primary;
+      _remove_nonexistent_osds(*pool, raw);
+      _get_temp_osds(*pool, pg, &acting, &acting_primary);
+      _apply_upmap(*pool, pg, &raw);
+      _raw_to_up_osds(*pool, raw, &up);
+      up_primary = _pick_primary(up);
+      _apply_primary_affinity(pps[ps - begin], *pool, &up, &up_primary);
+      if (acting.empty()) {
+	acting = up;
+	if (acting_primary == -1) {
+	  acting_primary = up_primary;
+	}
+      }
+      f(pg, std::move(up), up_primary, std::move(acting), acting_primary);
+    }
+  }
+}
+
 int OSDMap::calc_pg_role_broken(int osd, const vector<int>& acting, int nrep)
 {
   // This implementation is broken for EC PGs since the osd may appear
@@ -3263,11 +3338,11 @@ void OSDMap::encode(ceph::buffer::list& bl, uint64_t features) const
     encode(erasure_code_profiles, bl);
 
     if (v >= 4) {
-      encode(pg_upmap, bl);
-      encode(pg_upmap_items, bl);
+      encode(*pg_upmap, bl);
+      encode(*pg_upmap_items, bl);
     } else {
-      ceph_assert(pg_upmap.empty());
-      ceph_assert(pg_upmap_items.empty());
+      ceph_assert(pg_upmap->empty());
+      ceph_assert(pg_upmap_items->empty());
     }
     if (v >= 6) {
       encode(crush_version, bl);
@@ -3281,9 +3356,9 @@ void OSDMap::encode(ceph::buffer::list& bl, uint64_t features) const
       encode(last_in_change, bl);
     }
     if (v >= 10) {
-      encode(pg_upmap_primaries, bl);
+      encode(*pg_upmap_primaries, bl);
     } else {
-      ceph_assert(pg_upmap_primaries.empty());
+      ceph_assert(pg_upmap_primaries->empty());
     }
     ENCODE_FINISH(bl); // client-usable data
   }
@@ -3604,11 +3679,11 @@ void OSDMap::decode(ceph::buffer::list::const_iterator& bl)
     // version increased from 3 to 4 still in luminous, so same as above
     // applies.
     if (struct_v >= 4) {
-      decode(pg_upmap, bl);
-      decode(pg_upmap_items, bl);
+      decode(*pg_upmap, bl);
+      decode(*pg_upmap_items, bl);
     } else {
-      pg_upmap.clear();
-      pg_upmap_items.clear();
+      pg_upmap->clear();
+      pg_upmap_items->clear();
     }
     // again, version increased from 5 to 6 still in luminous, so above
     // applies.
@@ -3626,9 +3701,9 @@ void OSDMap::decode(ceph::buffer::list::const_iterator& bl)
       decode(last_in_change, bl);
     }
     if (struct_v >= 10) {
-      decode(pg_upmap_primaries, bl);
+      decode(*pg_upmap_primaries, bl);
     } else {
-      pg_upmap_primaries.clear();
+      pg_upmap_primaries->clear();
     }
     DECODE_FINISH(bl); // client-usable data
   }
@@ -3969,7 +4044,7 @@ void OSDMap::dump(Formatter *f, CephContext *cct) const
   f->close_section();
 
   f->open_array_section("pg_upmap");
-  for (auto& p : pg_upmap) {
+  for (auto& p : *pg_upmap) {
     f->open_object_section("mapping");
     f->dump_stream("pgid") << p.first;
     f->open_array_section("osds");
@@ -3982,7 +4057,7 @@ void OSDMap::dump(Formatter *f, CephContext *cct) const
   f->close_section();
 
   f->open_array_section("pg_upmap_items");
-  for (auto& [pgid, mappings] : pg_upmap_items) {
+  for (auto& [pgid, mappings] : *pg_upmap_items) {
     f->open_object_section("mapping");
     f->dump_stream("pgid") << pgid;
     f->open_array_section("mappings");
@@ -3998,7 +4073,7 @@ void OSDMap::dump(Formatter *f, CephContext *cct) const
   f->close_section();
 
   f->open_array_section("pg_upmap_primaries");
-  for (const auto& [pg, osd] : pg_upmap_primaries) {
+  for (const auto& [pg, osd] : *pg_upmap_primaries) {
     f->open_object_section("primary_mapping");
     f->dump_stream("pgid") << pg;
     f->dump_int("primary_osd", osd);
@@ -4301,14 +4376,14 @@ void OSDMap::print(CephContext *cct, ostream& out) const
   print_osds(out);
   out << std::endl;
 
-  for (auto& p : pg_upmap) {
+  for (auto& p : *pg_upmap) {
     out << "pg_upmap " << p.first << " " << p.second << "\n";
   }
-  for (auto& p : pg_upmap_items) {
+  for (auto& p : *pg_upmap_items) {
     out << "pg_upmap_items " << p.first << " " << p.second << "\n";
   }
 
-  for (auto& [pg, osd] : pg_upmap_primaries) {
+  for (auto& [pg, osd] : *pg_upmap_primaries) {
     out << "pg_upmap_primary " << pg << " " << osd << "\n";
   }
 
@@ -5145,7 +5220,7 @@ int OSDMap::balance_primaries(
 	prim_dist_scores[up_primary] -= 1;
 
 	// Update the mappings
-	tmp_osd_map.pg_upmap_primaries[pg] = curr_best_osd;
+	(*tmp_osd_map.pg_upmap_primaries)[pg] = curr_best_osd;
 	if (curr_best_osd == orig_prims[pg]) {
           pending_inc->new_pg_upmap_primary.erase(pg);
           prim_pgs_to_check[pg] = false;
@@ -5205,7 +5280,7 @@ void OSDMap::rm_all_upmap_prims(CephContext *cct, OSDMap::Incremental *pending_i
         ldout(cct,30) << __func__ << "Removing pending pg_upmap_prim for pg " << pg << dendl;
         pending_inc->new_pg_upmap_primary.erase(pg);
       }
-      if (pg_upmap_primaries.contains(pg)) {
+      if (pg_upmap_primaries->contains(pg)) {
         ldout(cct, 30) << __func__ << "Removing pg_upmap_prim for pg " << pg << dendl;
         pending_inc->old_pg_upmap_primary.insert(pg);
       }
@@ -5571,7 +5646,50 @@ int OSDMap::calc_pg_upmaps(
     cct->_conf.get_val<bool>("osd_calc_pg_upmaps_aggressively_fast");
   auto local_fallback_retries =
     cct->_conf.get_val<uint64_t>("osd_calc_pg_upmaps_local_fallback_retries");
-    
+
+  // candidate changes are tried on temp_pgs_by_osd.  a change only moves
+  // pgs between the osds named by its (old and new) remapping pairs, so
+  // those are the only entries that have to be copied back or forth
+  // once the change has been accepted or rejected.
+  auto temp_pgs_by_osd = pgs_by_osd;
+  auto changed_osds = [&tmp_osd_map](
+    const set<pg_t>& to_unmap,
+    const map<pg_t, mempool::osdmap::vector<pair<int32_t,int32_t>>>& to_upmap) {
+    set<int> osds;
+    auto add_pairs = [&osds](const auto& items) {
+      for (auto& [from, to] : items) {
+	osds.insert(from);
+	osds.insert(to);
+      }
+    };
+    auto add_existing = [&](pg_t pg) {
+      auto p = tmp_osd_map.pg_upmap_items->find(pg);
+      if (p != tmp_osd_map.pg_upmap_items->end()) {
+	add_pairs(p->second);
+      }
+    };
+    for (auto pg : to_unmap) {
+      add_existing(pg);
+    }
+    for (auto& [pg, items] : to_upmap) {
+      add_existing(pg);
+      add_pairs(items);
+    }
+    return osds;
+  };
+  auto copy_osds = [](const set<int>& osds,
+		      const map<int,set<pg_t>>& from,
+		      map<int,set<pg_t>>& to) {
+    for (auto osd : osds) {
+      auto p = from.find(osd);
+      if (p == from.end()) {
+	to.erase(osd);
+      } else {
+	to[osd] = p->second;
+      }
+    }
+  };
+
   while (max--) {
     ldout(cct, 30) << "Top of loop #" << max+1 << dendl;
     // build overfull and underfull
@@ -5609,7 +5727,6 @@ int OSDMap::calc_pg_upmaps(
 
     set<pg_t> to_unmap;
     map<pg_t, mempool::osdmap::vector<pair<int32_t,int32_t>>> to_upmap;
-    auto temp_pgs_by_osd = pgs_by_osd;
     // always start with fullest, break if we find any changes to make
     for (auto p = deviation_osd.rbegin(); p != deviation_osd.rend(); ++p) {
       if (skip_overfull && !underfull.empty()) {
@@ -5663,8 +5780,8 @@ int OSDMap::calc_pg_upmaps(
 
       // try upmap
       for (auto pg : pgs) {
-        auto temp_it = tmp_osd_map.pg_upmap.find(pg);
-        if (temp_it != tmp_osd_map.pg_upmap.end()) {
+        auto temp_it = tmp_osd_map.pg_upmap->find(pg);
+        if (temp_it != tmp_osd_map.pg_upmap->end()) {
           // leave pg_upmap alone
           // it must be specified by admin since balancer does not
           // support pg_upmap yet
@@ -5676,8 +5793,8 @@ int OSDMap::calc_pg_upmaps(
         auto pg_pool_size = tmp_osd_map.get_pg_pool_size(pg);
         mempool::osdmap::vector<pair<int32_t,int32_t>> new_upmap_items;
         set<int> existing;
-        auto it = tmp_osd_map.pg_upmap_items.find(pg);
-        if (it != tmp_osd_map.pg_upmap_items.end()) {
+        auto it = tmp_osd_map.pg_upmap_items->find(pg);
+        if (it != tmp_osd_map.pg_upmap_items->end()) {
 	  auto& um_items = it->second;
           if (um_items.size() >= (size_t)pg_pool_size) {
             ldout(cct, 10) << " " << pg << " already has full-size pg_upmap_items "
@@ -5789,7 +5906,10 @@ int OSDMap::calc_pg_upmaps(
     					      pgs_per_weight, temp_osd_deviation,
 					      temp_deviation_osd, new_stddev);
     ldout(cct, 10) << " stddev " << stddev << " -> " << new_stddev << dendl;
+    auto changed = changed_osds(to_unmap, to_upmap);
     if (new_stddev >= stddev) {
+      // roll temp_pgs_by_osd back
+      copy_osds(changed, pgs_by_osd, temp_pgs_by_osd);
       if (!aggressive) {
         ldout(cct, 10) << " break because stddev is not decreasing"
                        << " and aggressive mode is not enabled"
@@ -5820,7 +5940,7 @@ int OSDMap::calc_pg_upmaps(
     // ready to go
     ceph_assert(new_stddev < stddev);
     stddev = new_stddev;
-    pgs_by_osd = temp_pgs_by_osd;
+    copy_osds(changed, temp_pgs_by_osd, pgs_by_osd);
     osd_deviation = temp_osd_deviation;
     deviation_osd = temp_deviation_osd;
     n_changes++;
@@ -6052,8 +6172,8 @@ int OSDMap::pack_upmap_results(
   int num_changed = 0;
   for (auto& i : to_unmap) {
     ldout(cct, 10) << " unmap pg " << i << dendl;
-    ceph_assert(tmp_osd_map.pg_upmap_items.count(i));
-    tmp_osd_map.pg_upmap_items.erase(i);
+    ceph_assert(tmp_osd_map.pg_upmap_items->count(i));
+    tmp_osd_map.pg_upmap_items->erase(i);
     pending_inc->old_pg_upmap_items.insert(i);
     ++num_changed;
   }
@@ -6061,7 +6181,7 @@ int OSDMap::pack_upmap_results(
     ldout(cct, 10) << " upmap pg " << pg
                    << " new pg_upmap_items " << um_items
                    << dendl;
-    tmp_osd_map.pg_upmap_items[pg] = um_items;
+    (*tmp_osd_map.pg_upmap_items)[pg] = um_items;
     pending_inc->new_pg_upmap_items[pg] = um_items;
     ++num_changed;
   }
@@ -6110,8 +6230,8 @@ bool OSDMap::try_drop_remap_overfull(
   // if it found an item that can be dropped, false if not. 
   //
   for (auto pg : pgs) {
-    auto p = tmp_osd_map.pg_upmap_items.find(pg);
-    if (p == tmp_osd_map.pg_upmap_items.end())
+    auto p = tmp_osd_map.pg_upmap_items->find(pg);
+    if (p == tmp_osd_map.pg_upmap_items->end())
       continue;
     mempool::osdmap::vector<pair<int32_t,int32_t>> new_upmap_items;
     auto& pg_upmap_items = p->second;
@@ -6282,8 +6402,8 @@ OSDMap::candidates_t OSDMap::build_candidates(
   // build the candidates data structure
   //
   candidates_t candidates;
-  candidates.reserve(tmp_osd_map.pg_upmap_items.size());
-  for (auto& [pg, um_pair] : tmp_osd_map.pg_upmap_items) {
+  candidates.reserve(tmp_osd_map.pg_upmap_items->size());
+  for (auto& [pg, um_pair] : *tmp_osd_map.pg_upmap_items) {
     if (to_skip.count(pg))
       continue;
     if (!only_pools.empty() && !only_pools.count(pg.pool()))
@@ -6718,6 +6838,52 @@ int OSDMap::get_osds_by_bucket_name(const string &name, set<int> *osds) const
   return crush->get_leaves(name, osds);
 }
 
+void OSDMap::get_fanout_order(vector<int> *order) const
+{
+  mempool::osdmap::vector<int> parent(max_osd, 0);
+  for (int b = -1; b >= -crush->get_max_buckets(); --b) {
+    if (!crush->bucket_exists(b) || crush->is_shadow_item(b)) {
+      continue;
+    }
+    for (int i = 0; i < crush->get_bucket_size(b); ++i) {
+      int item = crush->get_bucket_item(b, i);
+      if (item >= 0 && item < max_osd) {
+	parent[item] = b;
+      }
+    }
+  }
+  vector<pair<int,int>> v;  // (crush parent, osd)
+  for (int o = 0; o < max_osd; ++o) {
+    if (is_up(o)) {
+      v.emplace_back(parent[o], o);
+    }
+  }
+  std::sort(v.begin(), v.end());
+  order->clear();
+  order->reserve(v.size());
+  for (auto& [p, o] : v) {
+    order->push_back(o);
+  }
+}
+
+void OSDMap::get_fanout_children(const vector<int>& order, int osd,
+				 unsigned fanout, vector<int> *children) const
+{
+  children->clear();
+  unsigned n = order.size();
+  auto me = std::find(order.begin(), order.end(), osd);
+  if (n == 0 || fanout == 0 || me == order.end()) {
+    return;
+  }
+  auto root = std::find(order.begin(), order.end(), get_fanout_root(order));
+  uint64_t rank = ((me - order.begin()) + n - (root - order.begin())) % n;
+  for (uint64_t c = rank * fanout + 1;
+       c <= rank * fanout + fanout && c < n;
+       ++c) {
+    children->push_back(order[((root - order.begin()) + c) % n]);
+  }
+}
+
 // get pools whose crush rules might reference the given osd
 void OSDMap::get_pool_ids_by_osd(CephContext *cct,
                                 int osd,
@@ -7794,6 +7960,49 @@ void OSDMap::get_random_up_osds_by_subtree(int n,     // whoami
   }
 }
 
+void OSDMap::sample_osds_by_subtree(int n,
+                                    const string &subtree,
+                                    unsigned per_subtree,
+                                    const set<int> &peers,
+                                    const set<int> &prefer,
+                                    set<int> *out) const
+{
+  int subtree_type = crush->get_type_id(subtree);
+  if (subtree_type < 1 || per_subtree == 0) {
+    out->insert(peers.begin(), peers.end());
+    return;
+  }
+  map<int, vector<int>> by_subtree;
+  for (auto o : peers) {
+    int s = crush->get_parent_of_type(o, subtree_type);
+    if (s >= 0) {
+      out->insert(o);  // not in a subtree of that type
+    } else {
+      by_subtree[s].push_back(o);
+    }
+  }
+  for (auto& [s, osds] : by_subtree) {
+    if (osds.size() <= per_subtree) {
+      out->insert(osds.begin(), osds.end());
+      continue;
+    }
+    unsigned kept = 0;
+    for (auto o : osds) {
+      if (kept < per_subtree && prefer.count(o)) {
+	out->insert(o);
+	++kept;
+      }
+    }
+    for (unsigned i = 0; kept < per_subtree && i < osds.size(); ++i) {
+      int o = osds[(n + i) % osds.size()];
+      if (!prefer.count(o)) {
+	out->insert(o);
+	++kept;
+      }
+    }
+  }
+}
+
 float OSDMap::pool_raw_used_rate(int64_t poolid) const
 {
   const pg_pool_t *pool = get_pg_pool(poolid);
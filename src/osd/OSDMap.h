@@ -590,9 +590,13 @@ private:
   std::shared_ptr< mempool::osdmap::vector<__u32> > osd_primary_affinity; ///< 16.16 fixed point, 0x10000 = baseline
 
   // remap (post-CRUSH, pre-up)
-  mempool::osdmap::map<pg_t,mempool::osdmap::vector<int32_t>> pg_upmap; ///< remap pg
-  mempool::osdmap::map<pg_t,mempool::osdmap::vector<std::pair<int32_t,int32_t>>> pg_upmap_items; ///< remap osds in up set
-  mempool::osdmap::map<pg_t, int32_t> pg_upmap_primaries; ///< remap primary of a pg
+  // remap tables are shared between epochs by dedup() while unchanged
+  using pg_upmap_t = mempool::osdmap::map<pg_t,mempool::osdmap::vector<int32_t>>;
+  using pg_upmap_items_t = mempool::osdmap::map<pg_t,mempool::osdmap::vector<std::pair<int32_t,int32_t>>>;
+  using pg_upmap_primaries_t = mempool::osdmap::map<pg_t, int32_t>;
+  std::shared_ptr<pg_upmap_t> pg_upmap; ///< remap pg
+  std::shared_ptr<pg_upmap_items_t> pg_upmap_items; ///< remap osds in up set
+  std::shared_ptr<pg_upmap_primaries_t> pg_upmap_primaries; ///< remap primary of a pg
 
   mempool::osdmap::map<int64_t,pg_pool_t> pools;
   mempool::osdmap::map<int64_t,std::string> pool_name;
@@ -684,6 +688,9 @@ private:
 	     osd_addrs(std::make_shared<addrs_s>()),
 	     pg_temp(std::make_shared<PGTempMap>()),
 	     primary_temp(std::make_shared<mempool::osdmap::map<pg_t,int32_t>>()),
+	     pg_upmap(std::make_shared<pg_upmap_t>()),
+	     pg_upmap_items(std::make_shared<pg_upmap_items_t>()),
+	     pg_upmap_primaries(std::make_shared<pg_upmap_primaries_t>()),
 	     osd_uuid(std::make_shared<mempool::osdmap::vector<uuid_d>>()),
 	     cluster_snapshot_epoch(0),
 	     new_blocklist_entries(false),
@@ -711,6 +718,9 @@ public:
     primary_temp.reset(new mempool::osdmap::map<pg_t,int32_t>(*o.primary_temp));
     pg_temp.reset(new PGTempMap(*o.pg_temp));
     osd_uuid.reset(new mempool::osdmap::vector<uuid_d>(*o.osd_uuid));
+    pg_upmap.reset(new pg_upmap_t(*o.pg_upmap));
+    pg_upmap_items.reset(new pg_upmap_items_t(*o.pg_upmap_items));
+    pg_upmap_primaries.reset(new pg_upmap_primaries_t(*o.pg_upmap_primaries));
 
     if (o.osd_primary_affinity)
       osd_primary_affinity.reset(new mempool::osdmap::vector<__u32>(*o.osd_primary_affinity));
@@ -1097,6 +1107,19 @@ public:
                                      std::set<int> skip,
                                      std::set<int> *want) const;
 
+  /**
+   * keep at most per_subtree of peers from each subtree of the given
+   * type (e.g. host), preferring those in prefer and otherwise picking
+   * by n (whoami), so that different osds sample different peers.
+   * peers outside any such subtree are all kept.
+   */
+  void sample_osds_by_subtree(int n,
+                              const std::string &subtree,
+                              unsigned per_subtree,
+                              const std::set<int> &peers,
+                              const std::set<int> &prefer,
+                              std::set<int> *out) const;
+
   /**
    * get feature bits required by the current structure
    *
@@ -1300,6 +1323,21 @@ public:
     int up_primary, acting_primary;
     pg_to_up_acting_osds(pg, &up, &up_primary, &acting, &acting_primary);
   }
+  using pg_mapping_fn_t = std::function<void(pg_t pg,
+					      std::vector<int>&& up,
+					      int up_primary,
+					      std::vector<int>&& acting,
+					      int acting_primary)>;
+  /**
+   * map the pgs [ps_begin, ps_end) of a pool to their up and acting sets.
+   *
+   * Produces the same result as pg_to_up_acting_osds() for each pg, but
+   * runs CRUSH in batches, which is considerably cheaper when mapping
+   * all pgs of a pool.
+   */
+  void pg_range_to_up_acting_osds(int64_t pool, unsigned ps_begin,
+				  unsigned ps_end,
+				  const pg_mapping_fn_t& f) const;
   bool pg_is_ec(pg_t pg) const {
     auto i = pools.find(pg.pool());
     ceph_assert(i != pools.end());
@@ -1720,9 +1758,23 @@ private:
 public:
   int get_osds_by_bucket_name(const std::string &name, std::set<int> *osds) const;
 
+  /**
+   * map fan-out tree
+   *
+   * Up osds are ordered by their crush parent (host), and form a
+   * fanout-ary tree in that order, rooted at a position that rotates
+   * with the epoch.  Osds that sit under the same host are siblings.
+   */
+  void get_fanout_order(std::vector<int> *order) const;
+  int get_fanout_root(const std::vector<int>& order) const {
+    return order.empty() ? -1 : order[epoch % order.size()];
+  }
+  void get_fanout_children(const std::vector<int>& order, int osd,
+			   unsigned fanout, std::vector<int> *children) const;
+
   bool have_pg_upmaps(pg_t pg) const {
-    return pg_upmap.count(pg) ||
-      pg_upmap_items.count(pg);
+    return pg_upmap->count(pg) ||
+      pg_upmap_items->count(pg);
   }
 
   bool check_full(const std::set<pg_shard_t> &missing_on) const {
@@ -59,6 +59,156 @@ void OSDMapMapping::update(const OSDMap& osdmap, pg_t pgid)
   _update_range(osdmap, pgid.pool(), pgid.ps(), pgid.ps() + 1);
 }
 
+std::unique_ptr<OSDMapMapping::MappingJob> OSDMapMapping::start_update(
+  const OSDMap& map,
+  const OSDMap::Incremental& inc,
+  ParallelPGMapper& mapper,
+  unsigned pgs_per_item)
+{
+  vector<pg_t> pgs;
+  if (epoch == 0 ||
+      epoch + 1 != map.get_epoch() ||
+      inc.epoch != map.get_epoch() ||
+      !_get_affected_pgs(map, inc, &pgs)) {
+    return start_update(map, mapper, pgs_per_item);
+  }
+  std::unique_ptr<MappingJob> job(new MappingJob(&map, this));
+  if (pgs.empty()) {
+    // nothing to remap, but the epoch still has to advance
+    job->finish = ceph_clock_now();
+    job->complete();
+  } else {
+    mapper.queue(job.get(), pgs_per_item, pgs);
+  }
+  return job;
+}
+
+bool OSDMapMapping::_get_affected_pgs(
+  const OSDMap& osdmap,
+  const OSDMap::Incremental& inc,
+  vector<pg_t> *pgs) const
+{
+  if (inc.fullmap.length() ||
+      inc.crush.length() ||
+      inc.new_max_osd >= 0 ||
+      !inc.new_erasure_code_profiles.empty()) {
+    return false;
+  }
+
+  std::set<int64_t> full_pools;  // pools to remap entirely
+  std::set<pg_t> some_pgs;       // individual pgs to remap
+
+  // new or resized pools, and pools whose properties changed
+  for (auto& [poolid, pool] : osdmap.get_pools()) {
+    auto p = pools.find(poolid);
+    if (p == pools.end() ||
+	p->second.pg_num != pool.get_pg_num() ||
+	p->second.size != pool.get_size() ||
+	inc.new_pools.count(poolid)) {
+      full_pools.insert(poolid);
+    }
+  }
+
+  // weight changes, osds marked up or (re)created, or destroyed, may
+  // pull any pg whose rule can reach the osd towards or away from it.
+  std::set<int> reweighted;
+  for (auto& [osd, weight] : inc.new_weight) {
+    reweighted.insert(osd);
+  }
+  for (auto& [osd, addrs] : inc.new_up_client) {
+    reweighted.insert(osd);
+  }
+  // osds that went down only drop out of the pgs they are mapped to.
+  std::set<int> remapped;
+  for (auto& [osd, state] : inc.new_state) {
+    int s = state ? state : CEPH_OSD_UP;
+    if ((s & CEPH_OSD_EXISTS) || osdmap.is_up(osd)) {
+      reweighted.insert(osd);
+    } else if (s & CEPH_OSD_UP) {
+      remapped.insert(osd);
+    }
+  }
+  // primary affinity only reorders the up set of pgs mapped to the osd
+  for (auto& [osd, affinity] : inc.new_primary_affinity) {
+    remapped.insert(osd);
+  }
+
+  if (!reweighted.empty()) {
+    std::map<int, bool> rule_affected;
+    for (auto& [poolid, pool] : osdmap.get_pools()) {
+      int ruleno = pool.get_crush_rule();
+      auto r = rule_affected.find(ruleno);
+      if (r == rule_affected.end()) {
+	bool affected = false;
+	std::map<int, float> wm;
+	if (ruleno < 0 ||
+	    osdmap.crush->get_rule_weight_osd_map(ruleno, &wm) < 0) {
+	  affected = true;
+	} else {
+	  for (auto osd : reweighted) {
+	    if (wm.count(osd)) {
+	      affected = true;
+	      break;
+	    }
+	  }
+	}
+	r = rule_affected.emplace(ruleno, affected).first;
+      }
+      if (r->second) {
+	full_pools.insert(poolid);
+      }
+    }
+  }
+
+  if (!remapped.empty()) {
+    for (auto& [poolid, pm] : pools) {
+      if (full_pools.count(poolid)) {
+	continue;
+      }
+      for (unsigned ps = 0; ps < pm.pg_num; ++ps) {
+	const int32_t *row = &pm.table[pm.row_size() * ps];
+	bool hit = false;
+	for (int i = 0; i < row[2] && !hit; ++i) {
+	  hit = remapped.count(row[4 + i]);
+	}
+	for (int i = 0; i < row[3] && !hit; ++i) {
+	  hit = remapped.count(row[4 + pm.size + i]);
+	}
+	if (hit) {
+	  some_pgs.insert(pg_t(ps, poolid));
+	}
+      }
+    }
+  }
+
+  // per-pg overrides
+  auto add_pg = [&](pg_t pgid) {
+    auto pool = osdmap.get_pg_pool(pgid.pool());
+    if (pool && pgid.ps() < pool->get_pg_num() &&
+	!full_pools.count(pgid.pool())) {
+      some_pgs.insert(pgid);
+    }
+  };
+  for (auto& i : inc.new_pg_temp) add_pg(i.first);
+  for (auto& i : inc.new_primary_temp) add_pg(i.first);
+  for (auto& i : inc.new_pg_upmap) add_pg(i.first);
+  for (auto& i : inc.old_pg_upmap) add_pg(i);
+  for (auto& i : inc.new_pg_upmap_items) add_pg(i.first);
+  for (auto& i : inc.old_pg_upmap_items) add_pg(i);
+  for (auto& i : inc.new_pg_upmap_primary) add_pg(i.first);
+  for (auto& i : inc.old_pg_upmap_primary) add_pg(i);
+
+  pgs->clear();
+  for (auto poolid : full_pools) {
+    auto pool = osdmap.get_pg_pool(poolid);
+    for (unsigned ps = 0; ps < pool->get_pg_num(); ++ps) {
+      pgs->push_back(pg_t(ps, poolid));
+    }
+  }
+  pgs->insert(pgs->end(), some_pgs.begin(), some_pgs.end());
+  return true;
+}
+
 void OSDMapMapping::_build_rmap(const OSDMap& osdmap)
 {
   acting_rmap.resize(osdmap.get_max_osd());
@@ -114,15 +264,13 @@ void OSDMapMapping::_update_range(
   ceph_assert(i != pools.end());
   ceph_assert(pg_begin <= pg_end);
   ceph_assert(pg_end <= i->second.pg_num);
-  for (unsigned ps = pg_begin; ps < pg_end; ++ps) {
-    std::vector<int> up, acting;
-    int up_primary, acting_primary;
-    osdmap.pg_to_up_acting_osds(
-      pg_t(ps, pool),
-      &up, &up_primary, &acting, &acting_primary);
-    i->second.set(ps, std::move(up), up_primary,
-		  std::move(acting), acting_primary);
-  }
+  osdmap.pg_range_to_up_acting_osds(
+    pool, pg_begin, pg_end,
+    [&i](pg_t pgid, std::vector<int>&& up, int up_primary,
+	 std::vector<int>&& acting, int acting_primary) {
+      i->second.set(pgid.ps(), std::move(up), up_primary,
+		    std::move(acting), acting_primary);
+    });
 }
 
 // ---------------------------
@@ -9,6 +9,7 @@
 #include <map>
 
 #include "osd/osd_types.h"
+#include "osd/OSDMap.h"
 #include "common/WorkQueue.h"
 #include "common/Cond.h"
 
@@ -265,6 +266,16 @@ private:
 
   void _build_rmap(const OSDMap& osdmap);
 
+  /**
+   * work out which pgs may map differently after applying inc
+   *
+   * @return false if the change set cannot be determined cheaply and
+   *         the whole mapping must be recomputed
+   */
+  bool _get_affected_pgs(const OSDMap& osdmap,
+			 const OSDMap::Incremental& inc,
+			 std::vector<pg_t> *pgs) const;
+
   void _start(const OSDMap& osdmap) {
     _init_mappings(osdmap);
   }
@@ -280,7 +291,11 @@ private:
       : Job(osdmap), mapping(m) {
       mapping->_start(*osdmap);
     }
-    void process(const std::vector<pg_t>& pgs) override {}
+    void process(const std::vector<pg_t>& pgs) override {
+      for (auto& pgid : pgs) {
+	mapping->update(*osdmap, pgid);
+      }
+    }
     void process(int64_t pool, unsigned ps_begin, unsigned ps_end) override {
       mapping->_update_range(*osdmap, pool, ps_begin, ps_end);
     }
@@ -342,6 +357,19 @@ public:
     return job;
   }
 
+  /**
+   * update a mapping of the previous epoch with the changes in inc
+   *
+   * Only pgs whose mapping may be affected by inc are recomputed; if
+   * this mapping is not for map's previous epoch, or the change set
+   * cannot be bounded, this is equivalent to start_update(map, ...).
+   */
+  std::unique_ptr<MappingJob> start_update(
+    const OSDMap& map,
+    const OSDMap::Incremental& inc,
+    ParallelPGMapper& mapper,
+    unsigned pgs_per_item);
+
   epoch_t get_epoch() const {
     return epoch;
   }
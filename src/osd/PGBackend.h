@@ -246,6 +246,12 @@ typedef std::shared_ptr<const OSDMap> OSDMapRef;
        GenContext<ThreadPool::TPHandle&> *c,
        uint64_t cost) = 0;
 
+     /// account recovery pulls in flight from a peer osd
+     virtual void start_recovery_pull(int osd) = 0;
+     virtual void finish_recovery_pull(int osd) = 0;
+     /// relative cost of pulling one more object from osd, lower is better
+     virtual uint64_t get_recovery_pull_cost(int osd) = 0;
+
      virtual pg_shard_t whoami_shard() const = 0;
      int whoami() const {
        return whoami_shard().osd;
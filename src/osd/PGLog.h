@@ -111,6 +111,12 @@ constexpr auto PGLOG_INDEXED_ALL              = PGLOG_INDEXED_OBJECTS
                                               | PGLOG_INDEXED_CALLER_OPS 
                                               | PGLOG_INDEXED_EXTRA_CALLER_OPS 
                                               | PGLOG_INDEXED_DUPS;
+// callers look up objects directly, so that index is always kept
+// current.  The request indexes only serve dup detection on the
+// primary and are built on the first lookup.
+constexpr auto PGLOG_INDEXED_EAGER            = PGLOG_INDEXED_OBJECTS;
+constexpr auto PGLOG_INDEXED_LAZY             = PGLOG_INDEXED_ALL
+                                              & ~PGLOG_INDEXED_EAGER;
 
 struct PGLog : DoutPrefixProvider {
   std::ostream& gen_prefix(std::ostream& out) const override {
@@ -219,7 +225,7 @@ public:
       rollback_info_trimmed_to_riter(log.rbegin())
     {
       reset_rollback_info_trimmed_to_riter();
-      index();
+      index(PGLOG_INDEXED_EAGER);
     }
 
     IndexedLog(const IndexedLog &rhs) :
@@ -260,7 +266,7 @@ public:
 
     mempool::osd_pglog::list<pg_log_entry_t> rewind_from_head(eversion_t newhead) {
       auto divergent = pg_log_t::rewind_from_head(newhead);
-      index();
+      reindex();
       reset_rollback_info_trimmed_to_riter();
       return divergent;
     }
@@ -289,7 +295,7 @@ public:
       *this = IndexedLog(o);
 
       skip_can_rollback_to_to_head();
-      index();
+      reindex();
     }
 
     void split_out_child(
@@ -496,6 +502,19 @@ public:
       indexed_data |= to_index;
     }
 
+    /// rebuild the eager indexes and any lazy index already built
+    void reindex() const {
+      index(indexed_data | PGLOG_INDEXED_EAGER);
+    }
+
+    /// free the lazily built indexes; the next lookup rebuilds them
+    void unindex_lazy() {
+      caller_ops.clear();
+      extra_caller_ops.clear();
+      dup_index.clear();
+      indexed_data &= ~PGLOG_INDEXED_LAZY;
+    }
+
     void index_objects() const {
       index(PGLOG_INDEXED_OBJECTS);
     }
@@ -797,6 +816,8 @@ public:
 
   void unindex() { log.unindex(); }
 
+  void unindex_lazy() { log.unindex_lazy(); }
+
   void add(const pg_log_entry_t& e, bool applied = true) {
     mark_writeout_from(e.version);
     log.add(e, applied);
@@ -874,7 +895,7 @@ public:
     }
     log.merge_from(slogs, last_update);
 
-    index();
+    log.reindex();
 
     mark_log_for_rewrite();
   }
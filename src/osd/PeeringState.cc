@@ -709,6 +709,10 @@ void PeeringState::start_peering_interval(
     // did primary change?
     if (was_old_primary != is_primary()) {
       state_clear(PG_STATE_CLEAN);
+      if (!is_primary()) {
+	// only the primary looks up requests
+	pg_log.unindex_lazy();
+      }
     }
 
     pl->on_role_change();
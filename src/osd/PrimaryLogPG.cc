@@ -4633,7 +4633,8 @@ void PrimaryLogPG::do_backfill_remove(OpRequestRef op)
 
 int PrimaryLogPG::trim_object(
   bool first, const hobject_t &coid, snapid_t snap_to_trim,
-  PrimaryLogPG::OpContextUPtr *ctxp)
+  PrimaryLogPG::OpContextUPtr *ctxp,
+  OpContext *batch)
 {
   *ctxp = NULL;
 
@@ -4697,32 +4698,50 @@ int PrimaryLogPG::trim_object(
     }
   }
 
-  OpContextUPtr ctx = simple_opc_create(obc);
-  ctx->head_obc = head_obc;
+  OpContextUPtr ctx;
+  OpContext *c = batch;
+  if (!c) {
+    ctx = simple_opc_create(obc);
+    ctx->head_obc = head_obc;
+    c = ctx.get();
+  }
 
-  if (!ctx->lock_manager.get_snaptrimmer_write(
+  // in a batch, a failed lock may leave the clone locked until the
+  // batch completes; it is retried after that
+  if (!c->lock_manager.get_snaptrimmer_write(
 	coid,
 	obc,
 	first)) {
-    close_op_ctx(ctx.release());
+    if (ctx) {
+      close_op_ctx(ctx.release());
+    }
     dout(10) << __func__ << ": Unable to get a wlock on " << coid << dendl;
     return -ENOLCK;
   }
 
-  if (!ctx->lock_manager.get_snaptrimmer_write(
+  if (!c->lock_manager.get_snaptrimmer_write(
 	head_oid,
 	head_obc,
 	first)) {
-    close_op_ctx(ctx.release());
+    if (ctx) {
+      close_op_ctx(ctx.release());
+    }
     dout(10) << __func__ << ": Unable to get a wlock on " << head_oid << dendl;
     return -ENOLCK;
   }
 
-  ctx->at_version = get_next_version();
-
-  PGTransaction *t = ctx->op_t.get();
+  PGTransaction *t = c->op_t.get();
+  if (batch) {
+    // continue after the entries of the objects already in the batch;
+    // issue_repop() only registers the batch's own obcs
+    c->at_version.version++;
+    t->add_obc(obc);
+    t->add_obc(head_obc);
+  } else {
+    c->at_version = get_next_version();
+  }
 
-  int64_t num_objects_before_trim = ctx->delta_stats.num_objects;
+  int64_t num_objects_before_trim = c->delta_stats.num_objects;
 
   if (new_snaps.empty()) {
     // remove clone
@@ -4733,7 +4752,7 @@ int PrimaryLogPG::trim_object(
     ceph_assert(p != snapset.clones.end());
 
     snapid_t last = coid.snap;
-    ctx->delta_stats.num_bytes -= snapset.get_clone_bytes(last);
+    c->delta_stats.num_bytes -= snapset.get_clone_bytes(last);
 
     if (p != snapset.clones.begin()) {
       // not the oldest... merge overlap into next older clone
@@ -4743,29 +4762,29 @@ int PrimaryLogPG::trim_object(
       bool adjust_prev_bytes = is_present_clone(prev_coid);
 
       if (adjust_prev_bytes)
-	ctx->delta_stats.num_bytes -= snapset.get_clone_bytes(*n);
+	c->delta_stats.num_bytes -= snapset.get_clone_bytes(*n);
 
       snapset.clone_overlap[*n].intersection_of(
 	snapset.clone_overlap[*p]);
 
       if (adjust_prev_bytes)
-	ctx->delta_stats.num_bytes += snapset.get_clone_bytes(*n);
+	c->delta_stats.num_bytes += snapset.get_clone_bytes(*n);
     }
-    ctx->delta_stats.num_objects--;
+    c->delta_stats.num_objects--;
     if (coi.is_dirty())
-      ctx->delta_stats.num_objects_dirty--;
+      c->delta_stats.num_objects_dirty--;
     if (coi.is_omap())
-      ctx->delta_stats.num_objects_omap--;
+      c->delta_stats.num_objects_omap--;
     if (coi.is_whiteout()) {
       dout(20) << __func__ << " trimming whiteout on " << coid << dendl;
-      ctx->delta_stats.num_whiteouts--;
+      c->delta_stats.num_whiteouts--;
     }
-    ctx->delta_stats.num_object_clones--;
+    c->delta_stats.num_object_clones--;
     if (coi.is_cache_pinned())
-      ctx->delta_stats.num_objects_pinned--;
+      c->delta_stats.num_objects_pinned--;
     if (coi.has_manifest()) {
-      dec_all_refcount_manifest(coi, ctx.get());
-      ctx->delta_stats.num_objects_manifest--;
+      dec_all_refcount_manifest(coi, c);
+      c->delta_stats.num_objects_manifest--;
     }
     obc->obs.exists = false;
 
@@ -4774,15 +4793,15 @@ int PrimaryLogPG::trim_object(
     snapset.clone_size.erase(last);
     snapset.clone_snaps.erase(last);
 
-    ctx->log.push_back(
+    c->log.push_back(
       pg_log_entry_t(
 	pg_log_entry_t::DELETE,
 	coid,
-	ctx->at_version,
-	ctx->obs->oi.version,
+	c->at_version,
+	obc->obs.oi.version,
 	0,
 	osd_reqid_t(),
-	ctx->mtime,
+	c->mtime,
 	0)
       );
     t->remove(coid);
@@ -4793,7 +4812,7 @@ int PrimaryLogPG::trim_object(
 
     coi = object_info_t(coid);
 
-    ctx->at_version.version++;
+    c->at_version.version++;
   } else {
     // save adjusted snaps for this object
     dout(10) << coid << " snaps " << old_snaps << " -> " << new_snaps << dendl;
@@ -4803,12 +4822,12 @@ int PrimaryLogPG::trim_object(
     // snapmapper.update ... :(
 
     coi.prior_version = coi.version;
-    coi.version = ctx->at_version;
+    coi.version = c->at_version;
     bl.clear();
     encode(coi, bl, get_osdmap()->get_features(CEPH_ENTITY_TYPE_OSD, nullptr));
     t->setattr(coid, OI_ATTR, bl);
 
-    ctx->log.push_back(
+    c->log.push_back(
       pg_log_entry_t(
 	pg_log_entry_t::MODIFY,
 	coid,
@@ -4816,10 +4835,10 @@ int PrimaryLogPG::trim_object(
 	coi.prior_version,
 	0,
 	osd_reqid_t(),
-	ctx->mtime,
+	c->mtime,
 	0)
       );
-    ctx->at_version.version++;
+    c->at_version.version++;
 
     t->update_snaps(
       coid,
@@ -4839,35 +4858,35 @@ int PrimaryLogPG::trim_object(
     // is effectively evicting a whiteout we might otherwise want to
     // keep around.
     dout(10) << coid << " removing " << head_oid << dendl;
-    ctx->log.push_back(
+    c->log.push_back(
       pg_log_entry_t(
 	pg_log_entry_t::DELETE,
 	head_oid,
-	ctx->at_version,
+	c->at_version,
 	head_obc->obs.oi.version,
 	0,
 	osd_reqid_t(),
-	ctx->mtime,
+	c->mtime,
 	0)
       );
     dout(10) << "removing snap head" << dendl;
     object_info_t& oi = head_obc->obs.oi;
-    ctx->delta_stats.num_objects--;
+    c->delta_stats.num_objects--;
     if (oi.is_dirty()) {
-      ctx->delta_stats.num_objects_dirty--;
+      c->delta_stats.num_objects_dirty--;
     }
     if (oi.is_omap())
-      ctx->delta_stats.num_objects_omap--;
+      c->delta_stats.num_objects_omap--;
     if (oi.is_whiteout()) {
       dout(20) << __func__ << " trimming whiteout on " << oi.soid << dendl;
-      ctx->delta_stats.num_whiteouts--;
+      c->delta_stats.num_whiteouts--;
     }
     if (oi.is_cache_pinned()) {
-      ctx->delta_stats.num_objects_pinned--;
+      c->delta_stats.num_objects_pinned--;
     }
     if (oi.has_manifest()) {
-      ctx->delta_stats.num_objects_manifest--;
-      dec_all_refcount_manifest(oi, ctx.get());
+      c->delta_stats.num_objects_manifest--;
+      dec_all_refcount_manifest(oi, c);
     }
     head_obc->obs.exists = false;
     head_obc->obs.oi = object_info_t(head_oid);
@@ -4884,20 +4903,20 @@ int PrimaryLogPG::trim_object(
     }
     dout(10) << coid << " writing updated snapset on " << head_oid
 	     << ", snapset is " << snapset << dendl;
-    ctx->log.push_back(
+    c->log.push_back(
       pg_log_entry_t(
 	pg_log_entry_t::MODIFY,
 	head_oid,
-	ctx->at_version,
+	c->at_version,
 	head_obc->obs.oi.version,
 	0,
 	osd_reqid_t(),
-	ctx->mtime,
+	c->mtime,
 	0)
       );
 
     head_obc->obs.oi.prior_version = head_obc->obs.oi.version;
-    head_obc->obs.oi.version = ctx->at_version;
+    head_obc->obs.oi.version = c->at_version;
 
     map <string, bufferlist, less<>> attrs;
     bl.clear();
@@ -4912,13 +4931,15 @@ int PrimaryLogPG::trim_object(
   }
 
   // Stats reporting - Set number of objects trimmed
-  if (num_objects_before_trim > ctx->delta_stats.num_objects) {
+  if (num_objects_before_trim > c->delta_stats.num_objects) {
     int64_t num_objects_trimmed =
-      num_objects_before_trim - ctx->delta_stats.num_objects;
+      num_objects_before_trim - c->delta_stats.num_objects;
     add_objects_trimmed_count(num_objects_trimmed);
   }
 
-  *ctxp = std::move(ctx);
+  if (ctx) {
+    *ctxp = std::move(ctx);
+  }
   return 0;
 }
 
@@ -5847,6 +5868,9 @@ int PrimaryLogPG::do_read(OpContext *ctx, OSDOp& osd_op) {
     ctx->op_finishers[ctx->current_osd_subop_num].reset(
       new ReadFinisher(osd_op));
   } else {
+    osd->txn_tracer.trace_read(
+      coll, ghobject_t(soid, ghobject_t::NO_GEN, info.pgid.shard),
+      op.extent.offset, op.extent.length);
     int r = pgbackend->objects_read_sync(
       soid, op.extent.offset, op.extent.length, op.flags, &osd_op.outdata);
     // whole object?  can we verify the checksum?
@@ -5935,6 +5959,13 @@ int PrimaryLogPG::do_sparse_read(OpContext *ctx, OSDOp& osd_op) {
       return r;
     }
 
+    if (osd->txn_tracer.is_active()) {
+      for (auto& [off, len] : m) {
+	osd->txn_tracer.trace_read(
+	  coll, ghobject_t(soid, ghobject_t::NO_GEN, info.pgid.shard),
+	  off, len);
+      }
+    }
     bufferlist data_bl;
     r = pgbackend->objects_readv_sync(soid, m, op.flags, &data_bl);
     if (r == -EIO) {
@@ -8879,13 +8910,21 @@ void PrimaryLogPG::do_osd_op_effects(OpContext *ctx, const ConnectionRef& conn)
       dout(10) << "notify_ack " << make_pair(*(p->watch_cookie), p->notify_id) << dendl;
     else
       dout(10) << "notify_ack " << make_pair("NULL", p->notify_id) << dendl;
+    if (p->watch_cookie) {
+      // each watcher acks every notify: look it up rather than scan the
+      // watchers, which would make a notify quadratic in their number
+      auto i = ctx->obc->watchers.find(make_pair(*(p->watch_cookie), entity));
+      if (i != ctx->obc->watchers.end()) {
+	dout(10) << "acking notify on watch " << i->first << dendl;
+	i->second->notify_ack(p->notify_id, p->reply_bl);
+      }
+      continue;
+    }
     for (map<pair<uint64_t, entity_name_t>, WatchRef>::iterator i =
 	   ctx->obc->watchers.begin();
 	 i != ctx->obc->watchers.end();
 	 ++i) {
       if (i->first.second != entity) continue;
-      if (p->watch_cookie &&
-	  *(p->watch_cookie) != i->first.first) continue;
       dout(10) << "acking notify on watch " << i->first << dendl;
       i->second->notify_ack(p->notify_id, p->reply_bl);
     }
@@ -11900,9 +11939,14 @@ ObjectContextRef PrimaryLogPG::get_object_context(
 	     << dendl;
   } else {
     dout(10) << __func__ << ": obc NOT found in cache: " << soid << dendl;
+    object_info_t oi;
+    const bool have_oi = !attrs && take_prev_interval_oi(soid, &oi);
     // check disk
     bufferlist bv;
-    if (attrs) {
+    if (have_oi) {
+      dout(10) << __func__ << ": oi unchanged since the last interval: "
+	       << oi << dendl;
+    } else if (attrs) {
       auto it_oi = attrs->find(OI_ATTR);
       ceph_assert(it_oi != attrs->end());
       bv = it_oi->second;
@@ -11932,10 +11976,11 @@ ObjectContextRef PrimaryLogPG::get_object_context(
       }
     }
 
-    object_info_t oi;
     try {
-      bufferlist::const_iterator bliter = bv.begin();
-      decode(oi, bliter);
+      if (!have_oi) {
+	bufferlist::const_iterator bliter = bv.begin();
+	decode(oi, bliter);
+      }
     } catch (...) {
       dout(0) << __func__ << ": obc corrupt: " << soid << dendl;
       return ObjectContextRef();   // -ENOENT!
@@ -12954,6 +12999,36 @@ void PrimaryLogPG::clear_async_reads()
 void PrimaryLogPG::clear_cache()
 {
   object_contexts.clear();
+  prev_interval_oi.clear();
+}
+
+bool PrimaryLogPG::take_prev_interval_oi(const hobject_t& soid,
+					 object_info_t *oi)
+{
+  auto p = prev_interval_oi.find(soid);
+  if (p == prev_interval_oi.end()) {
+    return false;
+  }
+  *oi = std::move(p->second);
+  prev_interval_oi.erase(p);
+  // The oi was current as of prev_interval_last_update, though possibly
+  // including a write that peering then rolled back. It is still valid
+  // only if the log proves that nothing has changed the object since:
+  // - if the log has an entry for the object, it must be the one that
+  //   produced the oi;
+  // - otherwise the log must reach back past both the oi and the point
+  //   it was cached at, so that any later write would have an entry.
+  const auto& pg_log = recovery_state.get_pg_log();
+  if (pg_log.get_missing().is_missing(soid)) {
+    return false;
+  }
+  const auto& log = pg_log.get_log();
+  auto e = log.objects.find(soid);
+  if (e != log.objects.end()) {
+    return e->second->version == oi->version;
+  }
+  return oi->version <= log.tail &&
+    log.tail <= prev_interval_last_update;
 }
 
 void PrimaryLogPG::on_shutdown()
@@ -12986,6 +13061,7 @@ void PrimaryLogPG::on_shutdown()
 
   context_registry_on_change();
   object_contexts.clear();
+  prev_interval_oi.clear();
 
   clear_async_reads();
 
@@ -13168,6 +13244,21 @@ void PrimaryLogPG::on_change(ObjectStore::Transaction &t)
   // we don't want to cache object_contexts through the interval change
   // NOTE: we actually assert that all currently live references are dead
   // by the time the flush for the next interval completes.
+  // their object_infos are kept, though, to spare the next interval the
+  // disk reads of the hot objects; see take_prev_interval_oi()
+  prev_interval_oi.clear();
+  if (cct->_conf->osd_pg_object_context_keep_oi &&
+      !pool.info.is_erasure()) {
+    const auto max = cct->_conf->osd_pg_object_context_cache_count;
+    pair<hobject_t, ObjectContextRef> i;
+    while (object_contexts.get_next(i.first, &i) &&
+	   prev_interval_oi.size() < (size_t)max) {
+      if (i.second->obs.exists) {
+	prev_interval_oi.emplace(i.first, i.second->obs.oi);
+      }
+    }
+    prev_interval_last_update = info.last_update;
+  }
   object_contexts.clear();
 
   // should have been cleared above by finishing all of the degraded objects
@@ -13211,6 +13302,8 @@ void PrimaryLogPG::_clear_recovery_state()
   dout(15) << __func__ << " flags: " << m_planned_scrub << dendl;
 
   last_backfill_started = hobject_t();
+  backfill_prefetch.clear();
+  backfill_prefetch_queued = false;
   set<hobject_t>::iterator i = backfills_in_flight.begin();
   while (i != backfills_in_flight.end()) {
     backfills_in_flight.erase(i++);
@@ -13928,8 +14021,16 @@ uint64_t PrimaryLogPG::recover_backfill(
     if (backfill_info.begin <= earliest_peer_backfill() &&
 	!backfill_info.extends_to_end() && backfill_info.empty()) {
       hobject_t next = backfill_info.end;
-      backfill_info.reset(next);
-      backfill_info.end = hobject_t::get_max();
+      if (!backfill_prefetch_queued && backfill_prefetch.begin == next &&
+	  backfill_prefetch.end > next) {
+	dout(10) << " using prefetched interval " << backfill_prefetch
+		 << dendl;
+	backfill_info = std::move(backfill_prefetch);
+	backfill_prefetch.clear();
+      } else {
+	backfill_info.reset(next);
+	backfill_info.end = hobject_t::get_max();
+      }
       update_range(&backfill_info, handle);
       backfill_info.trim();
     }
@@ -14142,6 +14243,7 @@ uint64_t PrimaryLogPG::recover_backfill(
   }
 
   pgbackend->run_recovery_op(h, recovery_state.get_recovery_op_priority());
+  maybe_queue_backfill_prefetch();
 
   hobject_t backfill_pos =
     std::min(backfill_info.begin, earliest_peer_backfill());
@@ -14263,6 +14365,43 @@ int PrimaryLogPG::prep_backfill_object_push(
   return r;
 }
 
+void PrimaryLogPG::maybe_queue_backfill_prefetch()
+{
+  if (!cct->_conf.get_val<bool>("osd_backfill_scan_prefetch") ||
+      backfill_prefetch_queued ||
+      backfill_info.extends_to_end() ||
+      backfill_prefetch.begin == backfill_info.end) {
+    return;
+  }
+  // Scan the next interval from the recovery queue, i.e. after we drop
+  // the pg lock, so that the listing and object info reads overlap with
+  // the pushes just sent.  Changes made after the scan are caught up
+  // from the log by update_range() when the interval is used.
+  backfill_prefetch_queued = true;
+  hobject_t begin = backfill_info.end;
+  dout(10) << __func__ << " from " << begin << dendl;
+  schedule_recovery_work(
+    bless_unlocked_gencontext(
+      make_gen_lambda_context<ThreadPool::TPHandle&>(
+	[this, begin](ThreadPool::TPHandle &handle) {
+	  ceph_assert(is_locked());
+	  if (!backfill_prefetch_queued) {
+	    return;
+	  }
+	  backfill_prefetch_queued = false;
+	  if (!is_primary() || !state_test(PG_STATE_BACKFILLING) ||
+	      backfill_info.end != begin) {
+	    return;
+	  }
+	  backfill_prefetch.reset(begin);
+	  backfill_prefetch.version = info.last_update;
+	  scan_range(cct->_conf->osd_backfill_scan_min,
+		     cct->_conf->osd_backfill_scan_max,
+		     &backfill_prefetch, handle);
+	}).release()),
+    cct->_conf->osd_backfill_scan_max);
+}
+
 void PrimaryLogPG::update_range(
   BackfillInterval *bi,
   ThreadPool::TPHandle &handle)
@@ -15719,9 +15858,12 @@ boost::statechart::result PrimaryLogPG::AwaitAsyncWork::react(const DoSnapWork&)
   // we need to look for at least 1 snaptrim, otherwise we'll misinterpret
   // the ENOENT below and erase snap_to_trim.
   ceph_assert(max > 0);
+  // each of the (up to) max repops in flight trims up to batch_max clones
+  const unsigned batch_max = std::max<uint64_t>(
+    1, pg->cct->_conf.get_val<uint64_t>("osd_snap_trim_batch_objects"));
 
   auto to_trim =
-      pg->snap_mapper.get_next_objects_to_trim(snap_to_trim, max);
+      pg->snap_mapper.get_next_objects_to_trim(snap_to_trim, max * batch_max);
   if (!to_trim.has_value()) {
     // Done!
     ldout(pg->cct, 10) << "no more entries to trim" << dendl;
@@ -15756,12 +15898,38 @@ boost::statechart::result PrimaryLogPG::AwaitAsyncWork::react(const DoSnapWork&)
     return transit< NotTrimming >();
   }
 
+  OpContextUPtr batch;
+  std::vector<hobject_t> batch_objects;
+  auto submit_batch = [&]() {
+    if (!batch) {
+      return;
+    }
+    batch->register_on_success(
+      [pg, objects = std::move(batch_objects), &in_flight]() {
+	for (auto &object : objects) {
+	  ceph_assert(in_flight.find(object) != in_flight.end());
+	  in_flight.erase(object);
+	}
+	if (in_flight.empty()) {
+	  if (pg->state_test(PG_STATE_SNAPTRIM_ERROR)) {
+	    pg->snap_trimmer_machine.process_event(Reset());
+	  } else {
+	    pg->snap_trimmer_machine.process_event(RepopsComplete());
+	  }
+	}
+      });
+    batch_objects.clear();
+    pg->simple_opc_submit(std::move(batch));
+  };
+
   for (auto &&object: *to_trim) {
     // Get next
     ldout(pg->cct, 10) << "AwaitAsyncWork react trimming " << object << dendl;
     OpContextUPtr ctx;
-    int error = pg->trim_object(in_flight.empty(), object, snap_to_trim, &ctx);
+    int error = pg->trim_object(in_flight.empty(), object, snap_to_trim, &ctx,
+				batch.get());
     if (error) {
+      submit_batch();
       if (error == -ENOLCK) {
 	ldout(pg->cct, 10) << "could not get write lock on obj "
 			   << object << dendl;
@@ -15782,21 +15950,15 @@ boost::statechart::result PrimaryLogPG::AwaitAsyncWork::react(const DoSnapWork&)
     }
 
     in_flight.insert(object);
-    ctx->register_on_success(
-      [pg, object, &in_flight]() {
-	ceph_assert(in_flight.find(object) != in_flight.end());
-	in_flight.erase(object);
-	if (in_flight.empty()) {
-	  if (pg->state_test(PG_STATE_SNAPTRIM_ERROR)) {
-	    pg->snap_trimmer_machine.process_event(Reset());
-	  } else {
-	    pg->snap_trimmer_machine.process_event(RepopsComplete());
-	  }
-	}
-      });
-
-    pg->simple_opc_submit(std::move(ctx));
+    batch_objects.push_back(object);
+    if (ctx) {
+      batch = std::move(ctx);
+    }
+    if (batch_objects.size() >= batch_max) {
+      submit_batch();
+    }
   }
+  submit_batch();
 
   return transit< WaitRepops >();
 }
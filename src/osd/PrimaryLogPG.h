@@ -364,10 +364,13 @@ public:
   }
   void queue_transaction(ObjectStore::Transaction&& t,
 			 OpRequestRef op) override {
-    osd->store->queue_transaction(ch, std::move(t), op);
+    std::vector<ObjectStore::Transaction> tls;
+    tls.push_back(std::move(t));
+    queue_transactions(tls, op);
   }
   void queue_transactions(std::vector<ObjectStore::Transaction>& tls,
 			  OpRequestRef op) override {
+    osd->txn_tracer.trace_transactions(coll, tls);
     osd->store->queue_transactions(ch, tls, op, NULL);
   }
   epoch_t get_interval_start_epoch() const override {
@@ -565,6 +568,16 @@ public:
     GenContext<ThreadPool::TPHandle&> *c,
     uint64_t cost) override;
 
+  void start_recovery_pull(int peer) override {
+    osd->start_recovery_pull(peer);
+  }
+  void finish_recovery_pull(int peer) override {
+    osd->finish_recovery_pull(peer);
+  }
+  uint64_t get_recovery_pull_cost(int peer) override {
+    return osd->get_recovery_pull_cost(peer);
+  }
+
   pg_shard_t whoami_shard() const override {
     return pg_whoami;
   }
@@ -1016,6 +1029,11 @@ protected:
 
   // projected object info
   SharedLRU<hobject_t, ObjectContext> object_contexts;
+  /// the object_infos of the object contexts cached when the last
+  /// interval ended, and the last_update they were current as of
+  std::map<hobject_t, object_info_t> prev_interval_oi;
+  eversion_t prev_interval_last_update;
+  bool take_prev_interval_oi(const hobject_t& soid, object_info_t *oi);
   // std::map from oid.snapdir() to SnapSetContext *
   std::map<hobject_t, SnapSetContext*> snapset_contexts;
   ceph::mutex snapset_contexts_lock =
@@ -1146,6 +1164,10 @@ protected:
   hobject_t last_backfill_started;
   bool new_backfill;
 
+  /// next local backfill interval, scanned while the current one is pushed
+  BackfillInterval backfill_prefetch;
+  bool backfill_prefetch_queued = false;
+
   int prep_object_replica_pushes(const hobject_t& soid, eversion_t v,
 				 PGBackend::RecoveryHandle *h,
 				 bool *work_started);
@@ -1301,6 +1323,9 @@ protected:
     ThreadPool::TPHandle &handle
     );
 
+  /// queue a scan of the local interval following backfill_info
+  void maybe_queue_backfill_prefetch();
+
   /// Update a hash range to reflect changes since the last scan
   void update_range(
     BackfillInterval *bi,        ///< [in,out] interval to update
@@ -1526,8 +1551,14 @@ public:
 
   void handle_backoff(OpRequestRef& op);
 
+  /**
+   * trim snap_to_trim from clone coid
+   *
+   * With a batch, the updates are added to it and *ctxp is left empty;
+   * otherwise a new context is returned in *ctxp.
+   */
   int trim_object(bool first, const hobject_t &coid, snapid_t snap_to_trim,
-		  OpContextUPtr *ctxp);
+		  OpContextUPtr *ctxp, OpContext *batch = nullptr);
   void snap_trimmer(epoch_t e) override;
   void kick_snap_trim() override;
   void snap_trimmer_scrub_complete() override;
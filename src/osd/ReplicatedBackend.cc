@@ -247,6 +247,7 @@ void ReplicatedBackend::clear_recovery_state()
 
   for (auto &&i: pulling) {
     get_parent()->release_locks(i.second.lock_manager);
+    get_parent()->finish_recovery_pull(i.second.from.osd);
   }
   pulling.clear();
   pull_from_peer.clear();
@@ -656,24 +657,29 @@ int ReplicatedBackend::be_deep_scrub(
     }
 
     const uint64_t stride = cct->_conf->osd_deep_scrub_stride;
-
-    bufferlist bl;
-    r = store->read(
-      ch,
-      ghobject_t(
-	poid, ghobject_t::NO_GEN, get_parent()->whoami_shard().shard),
-      pos.data_pos,
-      stride, bl,
-      fadvise_flags);
+    const ghobject_t goid(
+      poid, ghobject_t::NO_GEN, get_parent()->whoami_shard().shard);
+
+    if (cct->_conf.get_val<bool>("osd_deep_scrub_store_csum")) {
+      uint32_t crc = pos.data_hash.digest();
+      r = store->scrub_read(ch, goid, pos.data_pos, stride, &crc,
+			    fadvise_flags);
+      if (r > 0) {
+	pos.data_hash = bufferhash(crc);
+      }
+    } else {
+      bufferlist bl;
+      r = store->read(ch, goid, pos.data_pos, stride, bl, fadvise_flags);
+      if (r > 0) {
+	pos.data_hash << bl;
+      }
+    }
     if (r < 0) {
       dout(20) << __func__ << "  " << poid << " got "
 	       << r << " on read, read_error" << dendl;
       o.read_error = true;
       return 0;
     }
-    if (r > 0) {
-      pos.data_hash << bl;
-    }
     pos.data_pos += r;
     if (static_cast<uint64_t>(r) == stride) {
       dout(20) << __func__ << "  " << poid << " more data, digest so far 0x"
@@ -1394,6 +1400,25 @@ void ReplicatedBackend::prepare_pull(
     std::advance(p,
                  ceph::util::generate_random_number<int>(0,
 							 q->second.size() - 1));
+    if (cct->_conf.get_val<bool>("osd_recovery_pull_load_aware") &&
+	q->second.size() > 1) {
+      // pick the least loaded source, starting from the random one so
+      // that ties are spread over all the copies
+      uint64_t best_cost = get_parent()->get_recovery_pull_cost(p->osd);
+      auto i = p;
+      for (size_t n = 1; n < q->second.size(); ++n) {
+	if (++i == q->second.end()) {
+	  i = q->second.begin();
+	}
+	uint64_t cost = get_parent()->get_recovery_pull_cost(i->osd);
+	if (cost < best_cost) {
+	  best_cost = cost;
+	  p = i;
+	}
+      }
+      dout(20) << __func__ << " " << soid << " least loaded source osd."
+	       << p->osd << " cost " << best_cost << dendl;
+    }
   }
   ceph_assert(get_osdmap()->is_up(p->osd));
   pg_shard_t fromshard = *p;
@@ -1467,6 +1492,7 @@ void ReplicatedBackend::prepare_pull(
 
   ceph_assert(!pulling.count(soid));
   pull_from_peer[fromshard].insert(soid);
+  get_parent()->start_recovery_pull(fromshard.osd);
   pull_info_t &pull_info = pulling[soid];
   pull_info.from = fromshard;
   pull_info.soid = soid;
@@ -2382,6 +2408,7 @@ void ReplicatedBackend::clear_pull(
     clear_pull_from(piter);
   }
   get_parent()->release_locks(piter->second.lock_manager);
+  get_parent()->finish_recovery_pull(piter->second.from.osd);
   pulling.erase(piter);
 }
 
@@ -118,14 +118,20 @@ void Notify::do_timeout()
   _watchers.swap(watchers);
   lock.unlock();
 
+  if (_watchers.empty()) {
+    return;
+  }
+  // the watchers are all on the notified object, hence in the same pg
+  boost::intrusive_ptr<PrimaryLogPG> pg((*_watchers.begin())->get_pg());
+  auto notif = self.lock();
+  pg->lock();
   for (auto i = _watchers.begin(); i != _watchers.end(); ++i) {
-    boost::intrusive_ptr<PrimaryLogPG> pg((*i)->get_pg());
-    pg->lock();
+    ceph_assert((*i)->get_pg() == pg.get());
     if (!(*i)->is_discarded()) {
-      (*i)->cancel_notify(self.lock());
+      (*i)->cancel_notify(notif);
     }
-    pg->unlock();
   }
+  pg->unlock();
 }
 
 void Notify::register_cb()
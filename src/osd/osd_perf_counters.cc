@@ -29,6 +29,8 @@ PerfCounters *build_osd_logger(CephContext *cct) {
 
   // All the basic OSD operation stats are to be considered useful
   osd_plb.set_prio_default(PerfCountersBuilder::PRIO_USEFUL);
+  // ...and are bumped for every op by every op shard thread
+  osd_plb.set_sharded_default(true);
 
   osd_plb.add_u64(
     l_osd_op_wip, "op_wip",
@@ -129,6 +131,7 @@ PerfCounters *build_osd_logger(CephContext *cct) {
   // Now we move on to some more obscure stats, revert to assuming things
   // are low priority unless otherwise specified.
   osd_plb.set_prio_default(PerfCountersBuilder::PRIO_DEBUGONLY);
+  osd_plb.set_sharded_default(false);
 
   osd_plb.add_time_avg(l_osd_op_before_dequeue_op_lat, "op_before_dequeue_op_lat",
     "Latency of IO before calling dequeue_op(already dequeued and get PG lock)"); // client io before dequeue_op latency
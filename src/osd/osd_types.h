@@ -1106,6 +1106,7 @@ public:
     DEDUP_CDC_CHUNK_SIZE,
     PG_NUM_MAX, // max pg_num
     READ_RATIO, // read ration for the read balancer work [0-100]
+    CACHE_PRIORITY, // objectstore metadata cache retention weight [0-10]
   };
 
   enum type_t {
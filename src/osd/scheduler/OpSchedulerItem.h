@@ -168,6 +168,9 @@ public:
   void set_qos_cost(uint32_t scaled_cost) {
     qos_cost = scaled_cost;
   }
+  uint32_t get_qos_cost() const {
+    return qos_cost;
+  }
 
   friend std::ostream& operator<<(std::ostream& out, const OpSchedulerItem& item) {
     out << "OpSchedulerItem("
@@ -13,6 +13,7 @@
  */
 
 
+#include <algorithm>
 #include <memory>
 #include <functional>
 
@@ -53,6 +54,7 @@ mClockScheduler::mClockScheduler(CephContext *cct,
 {
   cct->_conf.add_observer(this);
   ceph_assert(num_shards > 0);
+  set_calibration_params_from_config();
   set_osd_capacity_params_from_config();
   set_config_defaults_from_profile();
   client_registry.update_from_config(
@@ -183,6 +185,9 @@ void mClockScheduler::set_osd_capacity_params_from_config()
     static_cast<double>(osd_bandwidth_capacity) / osd_iop_capacity;
   osd_bandwidth_capacity_per_shard = static_cast<double>(osd_bandwidth_capacity)
     / static_cast<double>(num_shards);
+  // start over from the (new) configured capacity
+  calibration.configured_per_shard = osd_bandwidth_capacity_per_shard;
+  calibration.estimated_per_shard = 0;
 
   dout(1) << __func__ << ": osd_bandwidth_cost_per_io: "
           << std::fixed << std::setprecision(2)
@@ -192,6 +197,68 @@ void mClockScheduler::set_osd_capacity_params_from_config()
           << dendl;
 }
 
+void mClockScheduler::set_calibration_params_from_config()
+{
+  calibration.enabled =
+    cct->_conf.get_val<bool>("osd_mclock_capacity_calibration");
+  calibration.interval = ceph::make_timespan(
+    cct->_conf.get_val<double>("osd_mclock_capacity_calibration_interval"));
+  calibration.interval_start = ceph::coarse_mono_clock::now();
+  calibration.busy_since = {};
+  calibration.busy = ceph::timespan::zero();
+  calibration.cost = 0;
+  calibration.limited = false;
+}
+
+void mClockScheduler::calibration_note_dequeue(uint32_t cost, bool limited)
+{
+  auto& c = calibration;
+  auto now = ceph::coarse_mono_clock::now();
+  c.cost += cost;
+  c.limited |= limited;
+  if (c.busy_since == ceph::coarse_mono_time()) {
+    // calibration was enabled while we had a backlog
+    c.busy_since = now;
+  }
+  if (scheduler.empty()) {
+    c.busy += now - c.busy_since;
+    c.busy_since = {};
+  }
+  if (now - c.interval_start < c.interval) {
+    return;
+  }
+
+  auto busy = c.busy;
+  if (c.busy_since != ceph::coarse_mono_time()) {
+    busy += now - c.busy_since;
+    c.busy_since = now;
+  }
+  if (!c.limited && c.cost > 0 && busy >= c.interval / 2) {
+    double sample = c.cost / std::chrono::duration<double>(busy).count();
+    double alpha =
+      cct->_conf.get_val<double>("osd_mclock_capacity_calibration_alpha");
+    double est = c.estimated_per_shard ?
+      (1.0 - alpha) * c.estimated_per_shard + alpha * sample :
+      sample;
+    est = std::clamp(est, c.configured_per_shard / 4,
+		     c.configured_per_shard * 4);
+    dout(10) << __func__ << " shard " << shard_id
+	     << std::fixed << std::setprecision(2)
+	     << " sample " << sample << " bytes/second"
+	     << " over " << busy
+	     << ", capacity_per_shard " << osd_bandwidth_capacity_per_shard
+	     << " -> " << est << dendl;
+    c.estimated_per_shard = est;
+    osd_bandwidth_capacity_per_shard = est;
+    client_registry.update_from_config(
+      cct->_conf, osd_bandwidth_capacity_per_shard);
+  }
+  c.interval_start = now;
+  c.busy = ceph::timespan::zero();
+  c.cost = 0;
+  c.limited = false;
+}
+
 /**
  * profile_t
  *
@@ -401,6 +468,9 @@ void mClockScheduler::enqueue(OpSchedulerItem&& item)
              << " scaled_cost: " << cost
              << dendl;
 
+    if (calibration.enabled && scheduler.empty()) {
+      calibration.busy_since = ceph::coarse_mono_clock::now();
+    }
     // Add item to scheduler queue
     scheduler.add_request(
       std::move(item),
@@ -465,6 +535,9 @@ WorkItem mClockScheduler::dequeue()
   } else {
     mclock_queue_t::PullReq result = scheduler.pull_request();
     if (result.is_future()) {
+      if (calibration.enabled) {
+	calibration_note_dequeue(0, true);
+      }
       return result.getTime();
     } else if (result.is_none()) {
       ceph_assert(
@@ -474,6 +547,9 @@ WorkItem mClockScheduler::dequeue()
       ceph_assert(result.is_retn());
 
       auto &retn = result.get_retn();
+      if (calibration.enabled) {
+	calibration_note_dequeue(retn.request->get_qos_cost(), false);
+      }
       return std::move(*retn.request);
     }
   }
@@ -503,6 +579,8 @@ const char** mClockScheduler::get_tracked_conf_keys() const
     "osd_mclock_max_sequential_bandwidth_hdd",
     "osd_mclock_max_sequential_bandwidth_ssd",
     "osd_mclock_profile",
+    "osd_mclock_capacity_calibration",
+    "osd_mclock_capacity_calibration_interval",
     NULL
   };
   return KEYS;
@@ -524,6 +602,16 @@ void mClockScheduler::handle_conf_change(
     client_registry.update_from_config(
       conf, osd_bandwidth_capacity_per_shard);
   }
+  if (changed.count("osd_mclock_capacity_calibration") ||
+      changed.count("osd_mclock_capacity_calibration_interval")) {
+    set_calibration_params_from_config();
+    if (!calibration.enabled && calibration.estimated_per_shard) {
+      // back to the configured capacity
+      set_osd_capacity_params_from_config();
+      client_registry.update_from_config(
+	conf, osd_bandwidth_capacity_per_shard);
+    }
+  }
   if (changed.count("osd_mclock_profile")) {
     set_config_defaults_from_profile();
     client_registry.update_from_config(
@@ -26,6 +26,7 @@
 
 #include "osd/scheduler/OpScheduler.h"
 #include "common/config.h"
+#include "common/ceph_time.h"
 #include "common/ceph_context.h"
 #include "osd/scheduler/OpSchedulerItem.h"
 
@@ -142,6 +143,40 @@ class mClockScheduler : public OpScheduler, md_config_obs_t {
    */
   double osd_bandwidth_capacity_per_shard;
 
+  /**
+   * capacity calibration
+   *
+   * The configured capacity comes from a one-off benchmark and goes stale
+   * as the device ages, fills up or is shared.  With
+   * osd_mclock_capacity_calibration enabled, the scheduler measures the
+   * rate (cost/second) at which it hands out mclock items while it has a
+   * backlog, i.e. while the rate is bound by how fast the OSD completes
+   * work rather than by how fast work arrives.  Intervals spent mostly
+   * idle, or in which dequeue was held back by a limit, tell nothing about
+   * capacity and are ignored.  Samples are smoothed and bounded to
+   * [1/4, 4] times the configured capacity, and the result replaces
+   * osd_bandwidth_capacity_per_shard when resolving the reservation and
+   * limit ratios of the client infos.
+   *
+   * Any change to the capacity config restarts the estimate.
+   */
+  struct capacity_calibration_t {
+    bool enabled = false;
+    ceph::timespan interval;
+    double configured_per_shard = 0;  ///< from config, bytes/second
+    double estimated_per_shard = 0;   ///< 0 until the first sample
+
+    ceph::coarse_mono_time interval_start;
+    ceph::coarse_mono_time busy_since; ///< zero while idle
+    ceph::timespan busy = ceph::timespan::zero();
+    uint64_t cost = 0;                 ///< dequeued in this interval
+    bool limited = false;
+  } calibration;
+
+  void set_calibration_params_from_config();
+  /// account a dequeue of cost (0 for a future result) and maybe recalibrate
+  void calibration_note_dequeue(uint32_t cost, bool limited);
+
   class ClientRegistry {
     std::array<
       crimson::dmclock::ClientInfo,
@@ -265,6 +300,10 @@ public:
   double get_cost_per_io() const {
     return osd_bandwidth_cost_per_io;
   }
+
+  double get_capacity_per_shard() const {
+    return osd_bandwidth_capacity_per_shard;
+  }
 private:
   // Enqueue the op to the high priority queue
   void enqueue_high(unsigned prio, OpSchedulerItem &&item, bool front = false);
@@ -1197,6 +1197,8 @@ void PgScrubber::on_init()
 {
   // going upwards from 'inactive'
   ceph_assert(!is_scrub_active());
+  // all replicas were reserved
+  m_scrub_job->reservation_failures = 0;
   m_pg->reset_objects_scrubbed();
   preemption_data.reset();
   m_interval_start = m_pg->get_history().same_interval_since;
@@ -1816,9 +1818,27 @@ void PgScrubber::clear_scrub_blocked()
 
 void PgScrubber::flag_reservations_failure()
 {
-  dout(10) << __func__ << dendl;
-  // delay the next invocation of the scrubber on this target
-  penalize_next_scrub(Scrub::delay_cause_t::replicas);
+  // delay the next invocation of the scrubber on this target. The delay
+  // grows with each consecutive failure, and is randomized, so that the
+  // primaries competing for the same replicas spread their retries out
+  // instead of failing together again.
+  const auto& conf = get_pg_cct()->_conf;
+  const auto base =
+      conf.get_val<std::chrono::seconds>("osd_scrub_retry_busy_replicas");
+  const auto max_delay =
+      conf.get_val<std::chrono::seconds>("osd_scrub_retry_busy_replicas_max");
+  const int failures = std::min(++m_scrub_job->reservation_failures, 16);
+  const double backoff = std::min<double>(
+      max_delay.count(), double(base.count()) * (1 << (failures - 1)));
+  const double jitter = 0.5 + rand() / (double)RAND_MAX;
+  const auto delay = std::chrono::seconds(
+      std::max<int64_t>(1, std::llround(backoff * jitter)));
+  dout(10) << fmt::format(
+		  "{}: {} consecutive failure(s), retrying in {}", __func__,
+		  m_scrub_job->reservation_failures, delay)
+	   << dendl;
+  m_osds->get_scrub_services().delay_on_failure(
+      m_scrub_job, delay, Scrub::delay_cause_t::replicas, ceph_clock_now());
 }
 
 /*
@@ -74,6 +74,9 @@ class ScrubJob final : public RefCountedObject {
   /// how the last attempt to scrub this PG ended
   delay_cause_t last_issue{delay_cause_t::none};
 
+  /// consecutive failures to reserve the replicas, for the retry back-off
+  int reservation_failures{0};
+
   /**
    * 'updated' is a temporary flag, used to create a barrier after
    * 'sched_time' and 'deadline' (or any other job entry) were modified by
@@ -97,6 +97,10 @@ void Journaler::_set_layout(file_layout_t const *l)
   // (watch out, this is big if you use big objects or weird striping)
   uint64_t periods = cct->_conf.get_val<uint64_t>("journaler_prefetch_periods");
   fetch_len = layout.get_period() * periods;
+  // a replaying reader only waits on the reads, so it can take many
+  // more objects in flight than one that is also writing
+  periods = cct->_conf.get_val<uint64_t>("journaler_replay_prefetch_periods");
+  replay_fetch_len = std::max(fetch_len, layout.get_period() * periods);
 }
 
 
@@ -1076,7 +1080,7 @@ void Journaler::_prefetch()
     pf = temp_fetch_len;
     temp_fetch_len = 0;
   } else {
-    pf = fetch_len;
+    pf = readonly ? replay_fetch_len : fetch_len;
   }
 
   uint64_t raw_target = read_pos + pf;
@@ -1152,7 +1156,7 @@ bool Journaler::_have_next_entry()
     return false;
   }
 
-  if (need > fetch_len) {
+  if (need > (readonly ? replay_fetch_len : fetch_len)) {
     temp_fetch_len = need;
     ldout(cct, 10) << "_have_next_entry noting temp_fetch_len " << temp_fetch_len
 		   << dendl;
@@ -333,6 +333,7 @@ private:
   std::map<uint64_t,bufferlist> prefetch_buf;
 
   uint64_t fetch_len;     // how much to read at a time
+  uint64_t replay_fetch_len;  // ... while readonly, i.e. replaying
   uint64_t temp_fetch_len;
 
   // for wait_for_readable()
@@ -410,7 +411,7 @@ public:
     write_buf_throttle(cct, "write_buf_throttle", UINT_MAX - (UINT_MAX >> 3)),
     waiting_for_zero_pos(0),
     read_pos(0), requested_pos(0), received_pos(0),
-    fetch_len(0), temp_fetch_len(0),
+    fetch_len(0), replay_fetch_len(0), temp_fetch_len(0),
     on_readable(0), on_write_error(NULL), called_write_error(false),
     expire_pos(0), trimming_pos(0), trimmed_pos(0), readable(false),
     write_iohint(0)
@@ -441,6 +442,7 @@ public:
     requested_pos = 0;
     received_pos = 0;
     fetch_len = 0;
+    replay_fetch_len = 0;
     ceph_assert(!on_readable);
     expire_pos = 0;
     trimming_pos = 0;
@@ -541,7 +541,9 @@ class ObjectCacher {
 			    int64_t *amount, int *max_count);
 
   void trim();
-  void flush(ZTracer::Trace *trace, loff_t amount=0);
+  /// start writeback of amount dirty bytes (all if 0), stopping early
+  /// once *max_count bhs were started if max_count is set
+  void flush(ZTracer::Trace *trace, loff_t amount=0, int *max_count=nullptr);
 
   /**
    * flush a range of buffers
@@ -414,10 +414,73 @@ void Objecter::start(const OSDMap* o)
     osdmap->deepish_copy_from(*o);
     prune_pg_mapping(osdmap->get_pools());
   } else if (osdmap->get_epoch() == 0) {
+    _load_cached_osdmap();
     _maybe_request_map();
   }
 }
 
+void Objecter::_load_cached_osdmap()
+{
+  // rwlock is locked
+  auto path = cct->_conf.get_val<std::string>("objecter_osdmap_cache");
+  if (path.empty()) {
+    return;
+  }
+  cb::list bl;
+  std::string err;
+  if (bl.read_file(path.c_str(), &err) < 0) {
+    ldout(cct, 10) << __func__ << " no cached osdmap at " << path << ": "
+		   << err << dendl;
+    return;
+  }
+  auto m = std::make_unique<OSDMap>();
+  try {
+    m->decode(bl);
+  } catch (const cb::error& e) {
+    ldout(cct, 1) << __func__ << " failed to decode " << path << ": "
+		  << e.what() << dendl;
+    return;
+  }
+  if (m->get_fsid() != monc->get_fsid()) {
+    ldout(cct, 1) << __func__ << " " << path << " is for cluster "
+		  << m->get_fsid() << ", ignoring" << dendl;
+    return;
+  }
+  ldout(cct, 1) << __func__ << " loaded cached osdmap e" << m->get_epoch()
+		<< " from " << path << dendl;
+  cached_osdmap = std::move(m);
+}
+
+void Objecter::_save_cached_osdmap()
+{
+  // rwlock is locked
+  auto path = cct->_conf.get_val<std::string>("objecter_osdmap_cache");
+  if (path.empty() || osdmap->get_epoch() == 0) {
+    return;
+  }
+  cb::list bl;
+  osdmap->encode(bl, CEPH_FEATURES_SUPPORTED_DEFAULT);
+  // write a private file and rename it over the cache, so that a
+  // concurrent reader never sees a partial map
+  auto tmp = path + "." + std::to_string(getpid()) + ".tmp";
+  ::unlink(tmp.c_str()); // a leftover would keep its mode
+  int r = bl.write_file(tmp.c_str(), 0600);
+  if (r < 0) {
+    ldout(cct, 1) << __func__ << " failed to write " << tmp << ": "
+		  << cpp_strerror(r) << dendl;
+    return;
+  }
+  if (::rename(tmp.c_str(), path.c_str()) < 0) {
+    r = -errno;
+    ldout(cct, 1) << __func__ << " failed to rename " << tmp << " to "
+		  << path << ": " << cpp_strerror(r) << dendl;
+    ::unlink(tmp.c_str());
+    return;
+  }
+  ldout(cct, 10) << __func__ << " saved osdmap e" << osdmap->get_epoch()
+		 << " to " << path << dendl;
+}
+
 void Objecter::shutdown()
 {
   ceph_assert(initialized);
@@ -425,6 +488,7 @@ void Objecter::shutdown()
   unique_lock wl(rwlock);
 
   initialized = false;
+  _save_cached_osdmap();
 
   wl.unlock();
   cct->_conf.remove_observer(this);
@@ -535,7 +599,7 @@ void Objecter::shutdown()
 }
 
 void Objecter::_send_linger(LingerOp *info,
-			    ceph::shunique_lock<ceph::shared_mutex>& sul)
+			    ceph::shunique_lock<ceph::sharded_shared_mutex>& sul)
 {
   ceph_assert(sul.owns_lock() && sul.mutex() == &rwlock);
 
@@ -869,7 +933,7 @@ ceph_tid_t Objecter::linger_notify(LingerOp *info,
 }
 
 void Objecter::_linger_submit(LingerOp *info,
-			      ceph::shunique_lock<ceph::shared_mutex>& sul)
+			      ceph::shunique_lock<ceph::sharded_shared_mutex>& sul)
 {
   ceph_assert(sul.owns_lock() && sul.mutex() == &rwlock);
   ceph_assert(info->linger_id);
@@ -1037,7 +1101,7 @@ void Objecter::_scan_requests(
   map<ceph_tid_t, Op*>& need_resend,
   list<LingerOp*>& need_resend_linger,
   map<ceph_tid_t, CommandOp*>& need_resend_command,
-  ceph::shunique_lock<ceph::shared_mutex>& sul)
+  ceph::shunique_lock<ceph::sharded_shared_mutex>& sul)
 {
   ceph_assert(sul.owns_lock() && sul.mutex() == &rwlock);
 
@@ -1196,6 +1260,32 @@ void Objecter::handle_osd_map(MOSDMap *m)
 		  << m->get_first() << "," << m->get_last()
 		  << "] > " << osdmap->get_epoch() << dendl;
 
+    if (osdmap->get_epoch() == 0 && cached_osdmap) {
+      // now that the monitor has told us where the cluster is, the cached
+      // map can serve as the base for its incrementals
+      auto cached = std::move(cached_osdmap);
+      if (m->get_first() <= cached->get_epoch() + 1 &&
+	  cached->get_epoch() <= m->get_last()) {
+	for (auto p = osd_sessions.begin();
+	     p != osd_sessions.end(); ++p) {
+	  OSDSession *s = p->second;
+	  _scan_requests(s, false, false, NULL, need_resend,
+			 need_resend_linger, need_resend_command, sul);
+	}
+	ldout(cct, 3) << "handle_osd_map using cached epoch "
+		      << cached->get_epoch() << dendl;
+	osdmap = std::move(cached);
+	prune_pg_mapping(osdmap->get_pools());
+
+	_scan_requests(homeless_session, false, false, NULL,
+		       need_resend, need_resend_linger,
+		       need_resend_command, sul);
+      } else {
+	ldout(cct, 3) << "handle_osd_map cached epoch " << cached->get_epoch()
+		      << " does not fit, discarding it" << dendl;
+      }
+    }
+
     if (osdmap->get_epoch()) {
       bool skipped_map = false;
       // we want incrementals
@@ -1842,7 +1932,7 @@ void Objecter::_command_cancel_map_check(CommandOp *c)
  * promotion to write.
  */
 int Objecter::_get_session(int osd, OSDSession **session,
-			   shunique_lock<ceph::shared_mutex>& sul)
+			   shunique_lock<ceph::sharded_shared_mutex>& sul)
 {
   ceph_assert(sul && sul.mutex() == &rwlock);
 
@@ -2000,7 +2090,7 @@ void Objecter::wait_for_osd_map(epoch_t e)
 
 void Objecter::_get_latest_version(epoch_t oldest, epoch_t newest,
 				   OpCompletion fin,
-				   std::unique_lock<ceph::shared_mutex>&& l)
+				   std::unique_lock<ceph::sharded_shared_mutex>&& l)
 {
   ceph_assert(fin);
   if (osdmap->get_epoch() >= newest) {
@@ -2035,7 +2125,14 @@ void Objecter::_maybe_request_map()
       << "_maybe_request_map subscribing (onetime) to next osd map" << dendl;
     flag = CEPH_SUBSCRIBE_ONETIME;
   }
-  epoch_t epoch = osdmap->get_epoch() ? osdmap->get_epoch()+1 : 0;
+  epoch_t epoch = 0;
+  if (osdmap->get_epoch()) {
+    epoch = osdmap->get_epoch() + 1;
+  } else if (cached_osdmap) {
+    // ask from the cached epoch itself, so that the monitor answers even
+    // if the cached map is still current
+    epoch = cached_osdmap->get_epoch();
+  }
   if (monc->sub_want("osdmap", epoch, flag)) {
     monc->renew_subs();
   }
@@ -2123,7 +2220,7 @@ void Objecter::_kick_requests(OSDSession *session,
 }
 
 void Objecter::_linger_ops_resend(map<uint64_t, LingerOp *>& lresend,
-				  unique_lock<ceph::shared_mutex>& ul)
+				  unique_lock<ceph::sharded_shared_mutex>& ul)
 {
   ceph_assert(ul.owns_lock());
   shunique_lock sul(std::move(ul));
@@ -2283,8 +2380,18 @@ void Objecter::op_submit(Op *op, ceph_tid_t *ptid, int *ctx_budget)
   _op_submit_with_budget(op, rl, ptid, ctx_budget);
 }
 
+void Objecter::op_submit(std::span<Op*> ops)
+{
+  shunique_lock rl(rwlock, ceph::acquire_shared);
+  for (auto op : ops) {
+    ceph_tid_t tid = 0;
+    op->trace.event("op submit");
+    _op_submit_with_budget(op, rl, &tid);
+  }
+}
+
 void Objecter::_op_submit_with_budget(Op *op,
-				      shunique_lock<ceph::shared_mutex>& sul,
+				      shunique_lock<ceph::sharded_shared_mutex>& sul,
 				      ceph_tid_t *ptid,
 				      int *ctx_budget)
 {
@@ -2388,7 +2495,7 @@ void Objecter::_send_op_account(Op *op)
   }
 }
 
-void Objecter::_op_submit(Op *op, shunique_lock<ceph::shared_mutex>& sul, ceph_tid_t *ptid)
+void Objecter::_op_submit(Op *op, shunique_lock<ceph::sharded_shared_mutex>& sul, ceph_tid_t *ptid)
 {
   // rwlock is locked
 
@@ -2504,13 +2611,12 @@ int Objecter::op_cancel(OSDSession *s, ceph_tid_t tid, int r)
     return -ENOENT;
   }
 
-#if 0
-  if (s->con) {
+  if (p->second->con) {
     ldout(cct, 20) << " revoking rx ceph::buffer for " << tid
-		   << " on " << s->con << dendl;
-    s->con->revoke_rx_buffer(tid);
+		   << " on " << p->second->con << dendl;
+    p->second->con->revoke_rx_buffer(tid);
+    p->second->con = nullptr;
   }
-#endif
 
   ldout(cct, 10) << __func__ << " tid " << tid << " in session " << s->osd
 		 << dendl;
@@ -2969,10 +3075,29 @@ int Objecter::_calc_target(op_target_t *t, Connection *con, bool any_change)
       ceph_assert(is_read && t->acting[0] == acting_primary);
       if (t->flags & CEPH_OSD_FLAG_BALANCE_READS) {
 	int p = rand() % t->acting.size();
+	if (balance_reads_by_latency) {
+	  // the replica with the best latency times queue depth, starting
+	  // from the random one so that ties (e.g. no replies yet) spread
+	  uint64_t best_score = UINT64_MAX;
+	  int best = p;
+	  for (unsigned i = 0; i < t->acting.size(); ++i) {
+	    int r = (p + i) % t->acting.size();
+	    auto s = osd_sessions.find(t->acting[r]);
+	    uint64_t score = s == osd_sessions.end() ? 0 : s->second->read_score();
+	    ldout(cct, 20) << __func__ << " balance: rank " << r
+			   << " osd." << t->acting[r]
+			   << " score " << score << dendl;
+	    if (score < best_score) {
+	      best = r;
+	      best_score = score;
+	    }
+	  }
+	  p = best;
+	}
 	if (p)
 	  t->used_replica = true;
 	osd = t->acting[p];
-	ldout(cct, 10) << " chose random osd." << osd << " of " << t->acting
+	ldout(cct, 10) << " chose osd." << osd << " of " << t->acting
 		       << dendl;
       } else {
 	// look for a local replica.  prefer the primary if the
@@ -3016,7 +3141,7 @@ int Objecter::_calc_target(op_target_t *t, Connection *con, bool any_change)
 }
 
 int Objecter::_map_session(op_target_t *target, OSDSession **s,
-			   shunique_lock<ceph::shared_mutex>& sul)
+			   shunique_lock<ceph::sharded_shared_mutex>& sul)
 {
   _calc_target(target, nullptr);
   return _get_session(target->osd, s, sul);
@@ -3031,6 +3156,7 @@ void Objecter::_session_op_assign(OSDSession *to, Op *op)
   get_session(to);
   op->session = to;
   to->ops[op->tid] = op;
+  to->num_ops = to->ops.size();
 
   if (to->is_homeless()) {
     num_homeless_ops++;
@@ -3049,6 +3175,7 @@ void Objecter::_session_op_remove(OSDSession *from, Op *op)
   }
 
   from->ops.erase(op->tid);
+  from->num_ops = from->ops.size();
   put_session(from);
   op->session = NULL;
 
@@ -3123,7 +3250,7 @@ void Objecter::_session_command_op_assign(OSDSession *to, CommandOp *op)
 }
 
 int Objecter::_recalc_linger_op_target(LingerOp *linger_op,
-				       shunique_lock<ceph::shared_mutex>& sul)
+				       shunique_lock<ceph::sharded_shared_mutex>& sul)
 {
   // rwlock is locked unique
 
@@ -3181,6 +3308,11 @@ void Objecter::_finish_op(Op *op, int r)
   if (op->ontimeout && r != -ETIMEDOUT)
     timer.cancel_event(op->ontimeout);
 
+  if (op->con) {
+    op->con->revoke_rx_buffer(op->tid);
+    op->con = nullptr;
+  }
+
   if (op->session) {
     _session_op_remove(op->session, op);
   }
@@ -3300,14 +3432,15 @@ void Objecter::_send_op(Op *op)
   ConnectionRef con = op->session->con;
   ceph_assert(con);
 
-#if 0
   // preallocated rx ceph::buffer?
   if (op->con) {
     ldout(cct, 20) << " revoking rx ceph::buffer for " << op->tid << " on "
 		   << op->con << dendl;
     op->con->revoke_rx_buffer(op->tid);
+    op->con = nullptr;
   }
-  if (op->outbl &&
+  if (post_rx_buffers &&
+      op->outbl &&
       op->ontimeout == 0 &&  // only post rx_buffer if no timeout; see #9582
       op->outbl->length()) {
     op->outbl->invalidate_crc();  // messenger writes through c_str()
@@ -3316,7 +3449,6 @@ void Objecter::_send_op(Op *op)
     op->con = con;
     op->con->post_rx_buffer(op->tid, *op->outbl);
   }
-#endif
 
   op->incarnation = op->session->incarnation;
 
@@ -3345,7 +3477,7 @@ int Objecter::calc_op_budget(const bc::small_vector_base<OSDOp>& ops)
 }
 
 void Objecter::_throttle_op(Op *op,
-			    shunique_lock<ceph::shared_mutex>& sul,
+			    shunique_lock<ceph::sharded_shared_mutex>& sul,
 			    int op_budget)
 {
   ceph_assert(sul && sul.mutex() == &rwlock);
@@ -3452,6 +3584,7 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
     // just accept this one.  we may do ACK callbacks we shouldn't
     // have, but that is better than doing callbacks out of order.
   }
+  s->note_latency(ceph::coarse_mono_clock::now() - op->stamp);
 
   decltype(op->onfinish) onfinish;
 
@@ -3504,12 +3637,18 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
 
   // got data?
   if (op->outbl) {
-#if 0
-    if (op->con)
+    if (op->con) {
       op->con->revoke_rx_buffer(op->tid);
-#endif
+      op->con = nullptr;
+    }
     auto& bl = m->get_data();
     if (op->outbl->length() == bl.length() &&
+	bl.get_num_buffers() <= 1 &&
+	op->outbl->get_num_buffers() <= 1 &&
+	op->outbl->is_provided_buffer(bl.c_str())) {
+      // the messenger read the data straight into the posted buffer
+      ldout(cct,10) << __func__ << " data landed in rx ceph::buffer" << dendl;
+    } else if (op->outbl->length() == bl.length() &&
 	bl.get_num_buffers() <= 1) {
       // this is here to keep previous users to *relied* on getting data
       // read into existing buffers happy.  Notably,
@@ -4933,7 +5072,7 @@ void Objecter::submit_command(CommandOp *c, ceph_tid_t *ptid)
 }
 
 int Objecter::_calc_command_target(CommandOp *c,
-				   shunique_lock<ceph::shared_mutex>& sul)
+				   shunique_lock<ceph::sharded_shared_mutex>& sul)
 {
   ceph_assert(sul.owns_lock() && sul.mutex() == &rwlock);
 
@@ -4989,7 +5128,7 @@ int Objecter::_calc_command_target(CommandOp *c,
 }
 
 void Objecter::_assign_command_session(CommandOp *c,
-				       shunique_lock<ceph::shared_mutex>& sul)
+				       shunique_lock<ceph::sharded_shared_mutex>& sul)
 {
   ceph_assert(sul.owns_lock() && sul.mutex() == &rwlock);
 
@@ -5083,10 +5222,16 @@ Objecter::OSDSession::~OSDSession()
 Objecter::Objecter(CephContext *cct,
 		   Messenger *m, MonClient *mc,
 		   asio::io_context& service) :
-  Dispatcher(cct), messenger(m), monc(mc), service(service)
+  Dispatcher(cct), messenger(m), monc(mc), service(service),
+  rwlock(ceph::make_sharded_shared_mutex(
+	   "Objecter::rwlock",
+	   cct->_conf.get_val<uint64_t>("objecter_rwlock_shards")))
 {
   mon_timeout = cct->_conf.get_val<std::chrono::seconds>("rados_mon_op_timeout");
   osd_timeout = cct->_conf.get_val<std::chrono::seconds>("rados_osd_op_timeout");
+  post_rx_buffers = cct->_conf.get_val<bool>("objecter_post_rx_buffers");
+  balance_reads_by_latency = cct->_conf.get_val<bool>(
+    "objecter_balance_reads_by_latency");
 }
 
 Objecter::~Objecter()
@@ -15,11 +15,13 @@
 #ifndef CEPH_OBJECTER_H
 #define CEPH_OBJECTER_H
 
+#include <atomic>
 #include <condition_variable>
 #include <list>
 #include <map>
 #include <mutex>
 #include <memory>
+#include <span>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -54,6 +56,7 @@
 #include "common/ceph_mutex.h"
 #include "common/ceph_timer.h"
 #include "common/config_obs.h"
+#include "common/sharded_shared_mutex.h"
 #include "common/shunique_lock.h"
 #include "common/zipkin_trace.h"
 #include "common/tracer.h"
@@ -1799,12 +1802,20 @@ public:
 private:
 
   void _maybe_request_map();
+  /// optional on-disk osdmap cache (objecter_osdmap_cache)
+  void _load_cached_osdmap();
+  void _save_cached_osdmap();
+  /// map loaded from the cache, only a base for the first incrementals
+  /// from the monitor, never used for ops
+  std::unique_ptr<OSDMap> cached_osdmap;
 
   version_t last_seen_osdmap_version = 0;
   version_t last_seen_pgmap_version = 0;
 
-  mutable ceph::shared_mutex rwlock =
-	   ceph::make_shared_mutex("Objecter::rwlock");
+  // taken shared by every op submission and exclusively only on map
+  // changes and session setup/teardown, so spread the readers over
+  // objecter_rwlock_shards cache lines.
+  mutable ceph::sharded_shared_mutex rwlock;
   ceph::timer<ceph::coarse_mono_clock> timer;
 
   PerfCounters* logger = nullptr;
@@ -2355,9 +2366,9 @@ public:
 
   void submit_command(CommandOp *c, ceph_tid_t *ptid);
   int _calc_command_target(CommandOp *c,
-			   ceph::shunique_lock<ceph::shared_mutex> &sul);
+			   ceph::shunique_lock<ceph::sharded_shared_mutex> &sul);
   void _assign_command_session(CommandOp *c,
-			       ceph::shunique_lock<ceph::shared_mutex> &sul);
+			       ceph::shunique_lock<ceph::sharded_shared_mutex> &sul);
   void _send_command(CommandOp *c);
   int command_op_cancel(OSDSession *s, ceph_tid_t tid,
 			boost::system::error_code ec);
@@ -2502,6 +2513,20 @@ public:
     int num_locks;
     std::unique_ptr<std::mutex[]> completion_locks;
 
+    // for choosing the replica to balance a read to; read without lock
+    std::atomic<uint64_t> lat_ewma_ns = 0;  ///< op reply latency, 0 if none yet
+    std::atomic<uint32_t> num_ops = 0;      ///< ops.size()
+
+    void note_latency(ceph::timespan lat) {
+      uint64_t ns = std::chrono::nanoseconds(lat).count();
+      uint64_t old = lat_ewma_ns;
+      lat_ewma_ns = old ? old - old / 8 + ns / 8 : std::max<uint64_t>(ns, 1);
+    }
+    /// the lower, the sooner a read sent here should be answered
+    uint64_t read_score() const {
+      return lat_ewma_ns * (num_ops + 1);
+    }
+
     OSDSession(CephContext *cct, int o) :
       osd(o), incarnation(0), con(NULL),
       num_locks(cct->_conf->objecter_completion_locks_per_session),
@@ -2557,6 +2582,8 @@ public:
 
   ceph::timespan mon_timeout;
   ceph::timespan osd_timeout;
+  bool post_rx_buffers = false;
+  bool balance_reads_by_latency = true;
 
   MOSDOp *_prepare_osd_op(Op *op);
   void _send_op(Op *op);
@@ -2587,7 +2614,7 @@ public:
   int _calc_target(op_target_t *t, Connection *con,
 		   bool any_change = false);
   int _map_session(op_target_t *op, OSDSession **s,
-		   ceph::shunique_lock<ceph::shared_mutex>& lc);
+		   ceph::shunique_lock<ceph::sharded_shared_mutex>& lc);
 
   void _session_op_assign(OSDSession *s, Op *op);
   void _session_op_remove(OSDSession *s, Op *op);
@@ -2596,16 +2623,16 @@ public:
   void _session_command_op_assign(OSDSession *to, CommandOp *op);
   void _session_command_op_remove(OSDSession *from, CommandOp *op);
 
-  int _assign_op_target_session(Op *op, ceph::shunique_lock<ceph::shared_mutex>& lc,
+  int _assign_op_target_session(Op *op, ceph::shunique_lock<ceph::sharded_shared_mutex>& lc,
 				bool src_session_locked,
 				bool dst_session_locked);
   int _recalc_linger_op_target(LingerOp *op,
-			       ceph::shunique_lock<ceph::shared_mutex>& lc);
+			       ceph::shunique_lock<ceph::sharded_shared_mutex>& lc);
 
   void _linger_submit(LingerOp *info,
-		      ceph::shunique_lock<ceph::shared_mutex>& sul);
+		      ceph::shunique_lock<ceph::sharded_shared_mutex>& sul);
   void _send_linger(LingerOp *info,
-		    ceph::shunique_lock<ceph::shared_mutex>& sul);
+		    ceph::shunique_lock<ceph::sharded_shared_mutex>& sul);
   void _linger_commit(LingerOp *info, boost::system::error_code ec,
 		      ceph::buffer::list& outbl);
   void _linger_reconnect(LingerOp *info, boost::system::error_code ec);
@@ -2649,10 +2676,10 @@ private:
 
   void _kick_requests(OSDSession *session, std::map<uint64_t, LingerOp *>& lresend);
   void _linger_ops_resend(std::map<uint64_t, LingerOp *>& lresend,
-			  std::unique_lock<ceph::shared_mutex>& ul);
+			  std::unique_lock<ceph::sharded_shared_mutex>& ul);
 
   int _get_session(int osd, OSDSession **session,
-		   ceph::shunique_lock<ceph::shared_mutex>& sul);
+		   ceph::shunique_lock<ceph::sharded_shared_mutex>& sul);
   void put_session(OSDSession *s);
   void get_session(OSDSession *s);
   void _reopen_session(OSDSession *session);
@@ -2670,9 +2697,9 @@ private:
    * If throttle_op needs to throttle it will unlock client_lock.
    */
   int calc_op_budget(const boost::container::small_vector_base<OSDOp>& ops);
-  void _throttle_op(Op *op, ceph::shunique_lock<ceph::shared_mutex>& sul,
+  void _throttle_op(Op *op, ceph::shunique_lock<ceph::sharded_shared_mutex>& sul,
 		    int op_size = 0);
-  int _take_op_budget(Op *op, ceph::shunique_lock<ceph::shared_mutex>& sul) {
+  int _take_op_budget(Op *op, ceph::shunique_lock<ceph::sharded_shared_mutex>& sul) {
     ceph_assert(sul && sul.mutex() == &rwlock);
     int op_budget = calc_op_budget(op->ops);
     if (keep_balanced_budget) {
@@ -2746,7 +2773,7 @@ private:
     std::map<ceph_tid_t, Op*>& need_resend,
     std::list<LingerOp*>& need_resend_linger,
     std::map<ceph_tid_t, CommandOp*>& need_resend_command,
-    ceph::shunique_lock<ceph::shared_mutex>& sul);
+    ceph::shunique_lock<ceph::sharded_shared_mutex>& sul);
 
   int64_t get_object_hash_position(int64_t pool, const std::string& key,
 				   const std::string& ns);
@@ -2831,15 +2858,17 @@ private:
                              const OSDMap &new_osd_map);
 
   // low-level
-  void _op_submit(Op *op, ceph::shunique_lock<ceph::shared_mutex>& lc,
+  void _op_submit(Op *op, ceph::shunique_lock<ceph::sharded_shared_mutex>& lc,
 		  ceph_tid_t *ptid);
   void _op_submit_with_budget(Op *op,
-			      ceph::shunique_lock<ceph::shared_mutex>& lc,
+			      ceph::shunique_lock<ceph::sharded_shared_mutex>& lc,
 			      ceph_tid_t *ptid,
 			      int *ctx_budget = NULL);
   // public interface
 public:
   void op_submit(Op *op, ceph_tid_t *ptid = NULL, int *ctx_budget = NULL);
+  /// submit several prepared ops, taking rwlock once for all of them
+  void op_submit(std::span<Op*> ops);
   bool is_active() {
     std::shared_lock l(rwlock);
     return !((!inflight_ops) && linger_ops.empty() &&
@@ -2954,7 +2983,7 @@ public:
 
   void _get_latest_version(epoch_t oldest, epoch_t neweset,
 			   OpCompletion fin,
-			   std::unique_lock<ceph::shared_mutex>&& ul);
+			   std::unique_lock<ceph::sharded_shared_mutex>&& ul);
 
   /** Get the current set of global op flags */
   int get_global_op_flags() const { return global_op_flags; }
@@ -3073,12 +3102,13 @@ public:
     return tid;
   }
 
-  void mutate(const object_t& oid, const object_locator_t& oloc,
-	      ObjectOperation&& op, const SnapContext& snapc,
-	      ceph::real_time mtime, int flags,
-	      Op::OpComp oncommit,
-	      version_t *objver = NULL, osd_reqid_t reqid = osd_reqid_t(),
-	      ZTracer::Trace *parent_trace = nullptr) {
+  Op *prepare_mutate_op(const object_t& oid, const object_locator_t& oloc,
+			ObjectOperation&& op, const SnapContext& snapc,
+			ceph::real_time mtime, int flags,
+			Op::OpComp oncommit,
+			version_t *objver = NULL,
+			osd_reqid_t reqid = osd_reqid_t(),
+			ZTracer::Trace *parent_trace = nullptr) {
     Op *o = new Op(oid, oloc, std::move(op.ops), flags | global_op_flags |
 		   CEPH_OSD_FLAG_WRITE, std::move(oncommit), objver,
 		   nullptr, parent_trace);
@@ -3091,7 +3121,17 @@ public:
     o->out_ec.swap(op.out_ec);
     o->reqid = reqid;
     op.clear();
-    op_submit(o);
+    return o;
+  }
+  void mutate(const object_t& oid, const object_locator_t& oloc,
+	      ObjectOperation&& op, const SnapContext& snapc,
+	      ceph::real_time mtime, int flags,
+	      Op::OpComp oncommit,
+	      version_t *objver = NULL, osd_reqid_t reqid = osd_reqid_t(),
+	      ZTracer::Trace *parent_trace = nullptr) {
+    op_submit(prepare_mutate_op(oid, oloc, std::move(op), snapc, mtime, flags,
+				std::move(oncommit), objver, reqid,
+				parent_trace));
   }
 
   void mutate(const object_t& oid, const object_locator_t& oloc,
@@ -3145,11 +3185,12 @@ public:
     return tid;
   }
 
-  void read(const object_t& oid, const object_locator_t& oloc,
-	    ObjectOperation&& op, snapid_t snapid, ceph::buffer::list *pbl,
-	    int flags, Op::OpComp onack,
-	    version_t *objver = nullptr, int *data_offset = nullptr,
-	    uint64_t features = 0, ZTracer::Trace *parent_trace = nullptr) {
+  Op *prepare_read_op(const object_t& oid, const object_locator_t& oloc,
+		      ObjectOperation&& op, snapid_t snapid,
+		      ceph::buffer::list *pbl, int flags, Op::OpComp onack,
+		      version_t *objver = nullptr, int *data_offset = nullptr,
+		      uint64_t features = 0,
+		      ZTracer::Trace *parent_trace = nullptr) {
     Op *o = new Op(oid, oloc, std::move(op.ops), flags | global_op_flags |
 		   CEPH_OSD_FLAG_READ, std::move(onack), objver,
 		   data_offset, parent_trace);
@@ -3167,7 +3208,16 @@ public:
     if (features)
       o->features = features;
     op.clear();
-    op_submit(o);
+    return o;
+  }
+  void read(const object_t& oid, const object_locator_t& oloc,
+	    ObjectOperation&& op, snapid_t snapid, ceph::buffer::list *pbl,
+	    int flags, Op::OpComp onack,
+	    version_t *objver = nullptr, int *data_offset = nullptr,
+	    uint64_t features = 0, ZTracer::Trace *parent_trace = nullptr) {
+    op_submit(prepare_read_op(oid, oloc, std::move(op), snapid, pbl, flags,
+			      std::move(onack), objver, data_offset, features,
+			      parent_trace));
   }
 
   void read(const object_t& oid, const object_locator_t& oloc,
@@ -25,6 +25,10 @@ class BasePyOSDMap(object):
     def _pool_raw_used_rate(self, pool_id):...
     @classmethod
     def _build_simple(cls, epoch: int, uuid: Optional[str], num_osd: int) -> 'BasePyOSDMap' :...
+    def _get_pools(self) -> Dict[str, List[Dict[str, Any]]]: ...
+    def _get_erasure_code_profiles(self) -> Dict[str, Dict[str, Dict[str, str]]]: ...
+    def _get_require_osd_release(self) -> str: ...
+    def _get_osd_columns(self) -> Dict[str, memoryview]: ...
 
 class BasePyOSDMapIncremental(object):
     def _get_epoch(self):...
@@ -75,6 +79,8 @@ class BaseMgrModule(object):
     def _ceph_get_rocksdb_version(self) -> str: ...
     def _ceph_get_counter(self, svc_type: str, svc_name: str, path: str) -> Dict[str, List[Tuple[float, int]]]: ...
     def _ceph_get_latest_counter(self, svc_type, svc_name, path): ...
+    def _ceph_get_unlabeled_perf_counters(self, prio_limit: int, services: List[str]) -> Dict[str, Dict[str, Any]]: ...
+    def _ceph_get_perf_counters_prometheus(self, prio_limit: int, services: List[str], by_host: bool) -> str: ...
     def _ceph_get_metadata(self, svc_type, svc_id): ...
     def _ceph_get_daemon_status(self, svc_type, svc_id): ...
     def _ceph_send_command(self,
@@ -180,14 +180,18 @@ class OSDMap(ceph_module.BasePyOSDMap):
         return self._dump()
 
     def get_pools(self) -> Dict[int, Dict[str, Any]]:
-        # FIXME: efficient implementation
-        d = self._dump()
-        return dict([(p['pool'], p) for p in d['pools']])
+        return dict([(p['pool'], p) for p in self._get_pools()['pools']])
 
     def get_pools_by_name(self) -> Dict[str, Dict[str, Any]]:
-        # FIXME: efficient implementation
-        d = self._dump()
-        return dict([(p['pool_name'], p) for p in d['pools']])
+        return dict([(p['pool_name'], p) for p in self._get_pools()['pools']])
+
+    def get_osd_columns(self) -> Dict[str, memoryview]:
+        """
+        The state of every OSD in the map, as one array per field: osd,
+        up, in, up_from, up_thru, down_at (int64) and weight,
+        primary_affinity (double), in the same OSD order.
+        """
+        return self._get_osd_columns()
 
     def new_incremental(self) -> 'OSDMapIncremental':
         return self._new_incremental()
@@ -229,13 +233,10 @@ class OSDMap(ceph_module.BasePyOSDMap):
         return cls._build_simple(epoch, uuid, num_osd)
 
     def get_ec_profile(self, name: str) -> Optional[List[Dict[str, str]]]:
-        # FIXME: efficient implementation
-        d = self._dump()
-        return d['erasure_code_profiles'].get(name, None)
+        return self._get_erasure_code_profiles()['erasure_code_profiles'].get(name, None)
 
     def get_require_osd_release(self) -> str:
-        d = self._dump()
-        return d['require_osd_release']
+        return self._get_require_osd_release()
 
 
 class OSDMapIncremental(ceph_module.BasePyOSDMapIncremental):
@@ -1433,7 +1434,13 @@ class MgrModule(ceph_module.BaseMgrModule, MgrModuleLoggingMixin):
                 health, mon_status, devices, device <devid>, pg_stats,
                 pool_stats, pg_ready, osd_ping_times, mgr_map, mgr_ips,
                 modified_config_options, service_map, mds_metadata,
-                have_local_config_map, osd_pool_stats, pg_status.
+                have_local_config_map, osd_pool_stats, pg_status,
+                pg_stats_columns, osd_stats_columns.
+
+        The ``*_columns`` names return a dict of field name to a typed
+        memoryview with one value per PG or OSD, which is much cheaper
+        than the dicts of pg_stats or osd_stats when only a few fields are
+        needed.  See get_pg_stats_columns() and get_osd_stats_columns().
 
         Note:
             All these structures have their own JSON representations: experiment
@@ -2136,6 +2143,28 @@ class MgrModule(ceph_module.BaseMgrModule, MgrModuleLoggingMixin):
         else:
             return 0, 0
 
+    @API.expose
+    def get_pg_stats_columns(self) -> Dict[str, memoryview]:
+        """
+        The stats of every PG, as one int64 array per field: pool, ps,
+        state (the PG_STATE_* bits), reported_epoch, up_primary,
+        acting_primary, log_size, ondisk_log_size and the num_bytes,
+        num_objects, num_objects_degraded/misplaced/unfound,
+        num_omap_bytes/keys, num_read(_kb) and num_write(_kb) sums, all in
+        the same PG order.  The arrays can be indexed or summed directly,
+        or given to numpy.frombuffer().
+        """
+        return self._ceph_get('pg_stats_columns')
+
+    @API.expose
+    def get_osd_stats_columns(self) -> Dict[str, memoryview]:
+        """
+        The stats of every OSD, as one int64 array per field: osd, total,
+        available, used_raw, num_pgs, snap_trim_queue_len,
+        num_shards_repaired, apply_latency_ns and commit_latency_ns.
+        """
+        return self._ceph_get('osd_stats_columns')
+
     @API.expose
     @profile_method()
     def get_unlabeled_perf_counters(self, prio_limit: int = PRIO_USEFUL,
@@ -2154,61 +2183,34 @@ class MgrModule(ceph_module.BaseMgrModule, MgrModuleLoggingMixin):
         value.
         """
 
-        result = defaultdict(dict)  # type: Dict[str, dict]
-
-        for server in self.list_servers():
-            for service in cast(List[ServiceInfoT], server['services']):
-                if service['type'] not in services:
-                    continue
-
-                schemas = self.get_perf_schema(service['type'], service['id'])
-                if not schemas:
-                    self.log.warning("No perf counter schema for {0}.{1}".format(
-                        service['type'], service['id']
-                    ))
-                    continue
-
-                # Value is returned in a potentially-multi-service format,
-                # get just the service we're asking about
-                svc_full_name = "{0}.{1}".format(
-                    service['type'], service['id'])
-                schema = schemas[svc_full_name]
-
-                # Populate latest values
-                for counter_path, counter_schema in schema.items():
-                    # self.log.debug("{0}: {1}".format(
-                    #     counter_path, json.dumps(counter_schema)
-                    # ))
-                    priority = counter_schema['priority']
-                    assert isinstance(priority, int)
-                    if priority < prio_limit:
-                        continue
-
-                    tp = counter_schema['type']
-                    assert isinstance(tp, int)
-                    counter_info = dict(counter_schema)
-                    # Also populate count for the long running avgs
-                    if tp & self.PERFCOUNTER_LONGRUNAVG:
-                        v, c = self.get_latest_avg(
-                            service['type'],
-                            service['id'],
-                            counter_path
-                        )
-                        counter_info['value'], counter_info['count'] = v, c
-                        result[svc_full_name][counter_path] = counter_info
-                    else:
-                        counter_info['value'] = self.get_latest(
-                            service['type'],
-                            service['id'],
-                            counter_path
-                        )
-
-                    result[svc_full_name][counter_path] = counter_info
+        # the walk over every daemon's schema is done natively, it is
+        # too slow in python with thousands of OSDs
+        result = self._ceph_get_unlabeled_perf_counters(prio_limit,
+                                                        list(services))
 
         self.log.debug("returning {0} counter".format(len(result)))
 
         return result
 
+    @API.expose
+    @profile_method()
+    def get_perf_counters_prometheus(self, prio_limit: int = PRIO_USEFUL,
+                                     services: Sequence[str] = ("mds", "mon", "osd",
+                                                                "rbd-mirror", "cephfs-mirror",
+                                                                "rgw", "tcmu-runner"),
+                                     by_host: bool = False) -> str:
+        """
+        Return the same counters as get_unlabeled_perf_counters, as metric
+        families in the prometheus text exposition format.
+
+        With `by_host`, every family also gets a ``<name>_by_host`` family
+        summing the counter over the daemons of each host.  The text is
+        rendered at most once per ``mgr_stats_period``.
+        """
+        return self._ceph_get_perf_counters_prometheus(prio_limit,
+                                                       list(services),
+                                                       by_host)
+
     @API.expose
     def set_uri(self, uri: str) -> None:
         """
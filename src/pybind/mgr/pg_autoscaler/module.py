@@ -409,21 +409,19 @@ class PgAutoscaler(MgrModule):
             osdmap, pools, crush, result, overlapped_roots, roots
         )
         # finish subtrees
-        all_stats = self.get('osd_stats')
+        osd_stats = self.get_osd_stats_columns()
+        osd_total = dict(zip(osd_stats['osd'], osd_stats['total']))
         for s in roots:
             assert s.osds is not None
             s.osd_count = len(s.osds)
             s.pg_target = s.osd_count * self.mon_target_pg_per_osd
             s.pg_left = s.pg_target
             s.pool_count = len(s.pool_ids)
-            capacity = 0
-            for osd_stats in all_stats['osd_stats']:
-                if osd_stats['osd'] in s.osds:
-                    # Intentionally do not apply the OSD's reweight to
-                    # this, because we want to calculate PG counts based
-                    # on the physical storage available, not how it is
-                    # reweighted right now.
-                    capacity += osd_stats['kb'] * 1024
+            # Intentionally do not apply the OSD's reweight to this,
+            # because we want to calculate PG counts based on the
+            # physical storage available, not how it is reweighted
+            # right now.
+            capacity = sum(osd_total.get(osd, 0) for osd in s.osds)
 
             s.capacity = capacity
             self.log.debug('root_ids %s pools %s with %d osds, pg_target %d',
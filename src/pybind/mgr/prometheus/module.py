@@ -608,6 +608,14 @@ class Module(MgrModule, OrchestratorClientMixin):
             desc='Do not include perf-counters in the metrics output',
             long_desc='Gathering perf-counters from a single Prometheus exporter can degrade ceph-mgr performance, especially in large clusters. Instead, Ceph-exporter daemons are now used by default for perf-counter gathering. This should only be disabled when no ceph-exporters are deployed.',
             runtime=True
+        ),
+        Option(
+            name='native_perf_counters',
+            type='bool',
+            default=False,
+            desc='Render perf-counters in ceph-mgr rather than in this module',
+            long_desc='When perf-counters are included in the metrics output, have ceph-mgr render them as prometheus text, with per-host sums of every counter, instead of building them here counter by counter.',
+            runtime=True
         )
     ]
 
@@ -1637,7 +1645,7 @@ class Module(MgrModule, OrchestratorClientMixin):
                 cast(MetricCounter, count_metric).add(1, (method_name,))
 
     def get_pool_repaired_objects(self) -> None:
-        dump = self.get('pg_dump')
+        dump = self.get('pool_stats')
         for stats in dump['pool_stats']:
             path = 'pool_objects_repaired'
             self.metrics[path].set(stats['stat_sum']['num_objects_repaired'],
@@ -1721,8 +1729,13 @@ class Module(MgrModule, OrchestratorClientMixin):
         self.get_num_objects()
         self.get_all_daemon_health_metrics()
 
+        native_perf_counters = ''
         if not self.get_module_option('exclude_perf_counters'):
-            self.get_perf_counters()
+            if self.get_module_option('native_perf_counters'):
+                native_perf_counters = self.get_perf_counters_prometheus(
+                    by_host=True)
+            else:
+                self.get_perf_counters()
         self.get_rbd_stats()
 
         self.get_collect_time_metrics()
@@ -1732,7 +1745,7 @@ class Module(MgrModule, OrchestratorClientMixin):
         for k in self.metrics.keys():
             self.metrics[k].clear()
 
-        return ''.join(_metrics) + '\n'
+        return ''.join(_metrics) + native_perf_counters + '\n'
 
     @CLIReadCommand('prometheus file_sd_config')
     def get_file_sd_config(self) -> Tuple[int, str, str]:
@@ -15,6 +15,7 @@
 #ifndef _INCLUDED_RBD_REPLAY_PENDINGIO_HPP
 #define _INCLUDED_RBD_REPLAY_PENDINGIO_HPP
 
+#include <chrono>
 #include <boost/enable_shared_from_this.hpp>
 #include "actions.hpp"
 
@@ -31,6 +32,13 @@ class PendingIO : public boost::enable_shared_from_this<PendingIO> {
 public:
   typedef boost::shared_ptr<PendingIO> ptr;
 
+  enum io_type_t {
+    IO_NONE,
+    IO_READ,
+    IO_WRITE,
+    IO_DISCARD,
+  };
+
   PendingIO(action_id_t id,
             ActionCtx &worker);
 
@@ -48,6 +56,25 @@ public:
     return *m_completion;
   }
 
+  /// Marks the start of the I/O against the image, for its latency.
+  void start_io(imagectx_id_t imagectx_id, io_type_t type) {
+    m_imagectx_id = imagectx_id;
+    m_type = type;
+    m_start = std::chrono::steady_clock::now();
+  }
+
+  io_type_t io_type() const {
+    return m_type;
+  }
+
+  imagectx_id_t imagectx_id() const {
+    return m_imagectx_id;
+  }
+
+  std::chrono::steady_clock::time_point start_time() const {
+    return m_start;
+  }
+
 private:
   void completed(librbd::completion_t cb);
 
@@ -57,6 +84,9 @@ private:
   ceph::bufferlist m_bl;
   librbd::RBD::AioCompletion *m_completion;
   ActionCtx &m_worker;
+  io_type_t m_type = IO_NONE;
+  imagectx_id_t m_imagectx_id = 0;
+  std::chrono::steady_clock::time_point m_start;
 };
 
 }
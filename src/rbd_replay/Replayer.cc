@@ -18,10 +18,12 @@
 #include "rbd_replay/ActionTypes.h"
 #include "rbd_replay/BufferReader.h"
 #include <boost/foreach.hpp>
+#include <bit>
 #include <chrono>
 #include <condition_variable>
 #include <thread>
 #include <fstream>
+#include <unordered_map>
 #include "global/global_context.h"
 #include "rbd_replay_debug.hpp"
 
@@ -55,6 +57,35 @@ bool is_versioned_replay(BufferReader &buffer_reader) {
 
 } // anonymous namespace
 
+void LatencyHistogram::add(uint64_t ns) {
+  size_t i = ns;
+  if (ns >= (1ull << SUB_BITS)) {
+    unsigned shift = 63 - std::countl_zero(ns) - SUB_BITS;
+    i = ((shift + 1) << SUB_BITS) + ((ns >> shift) & ((1 << SUB_BITS) - 1));
+  }
+  ++m_counts[i];
+  ++m_count;
+  m_sum += ns;
+  m_max = std::max(m_max, ns);
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+  uint64_t want = q * m_count;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < m_counts.size(); ++i) {
+    seen += m_counts[i];
+    if (seen > want) {
+      if (i < (1u << SUB_BITS)) {
+        return i;
+      }
+      unsigned shift = (i >> SUB_BITS) - 1;
+      uint64_t mantissa = (i & ((1 << SUB_BITS) - 1)) | (1 << SUB_BITS);
+      return std::min(((mantissa + 1) << shift) - 1, m_max);
+    }
+  }
+  return m_max;
+}
+
 Worker::Worker(Replayer &replayer)
   : m_replayer(replayer),
     m_buffer(100),
@@ -92,6 +123,9 @@ void Worker::run() {
     Action::ptr action;
     m_buffer.pop_back(&action);
     m_replayer.wait_for_actions(action->predecessors());
+    if (m_replayer.open_loop()) {
+      m_replayer.wait_until_scheduled(*action);
+    }
     action->perform(*this);
     m_replayer.set_action_complete(action->id());
   }
@@ -116,6 +150,9 @@ void Worker::run() {
 
 void Worker::remove_pending(PendingIO::ptr io) {
   ceph_assert(io);
+  if (io->io_type() != PendingIO::IO_NONE) {
+    m_replayer.record_latency(*io);
+  }
   m_replayer.set_action_complete(io->id());
   std::scoped_lock lock{m_pending_ios_mutex};
   size_t num_erased = m_pending_ios.erase(io->id());
@@ -159,8 +196,14 @@ bool Worker::readonly() const {
   return m_replayer.readonly();
 }
 
+bool Worker::open_loop() const {
+  return m_replayer.open_loop();
+}
+
 rbd_loc Worker::map_image_name(std::string image_name, std::string snap_name) const {
-  return m_replayer.image_name_map().map(rbd_loc("", image_name, snap_name));
+  rbd_loc name = m_replayer.image_name_map().map(rbd_loc("", image_name, snap_name));
+  name.image += m_replayer.image_suffix();
+  return name;
 }
 
 
@@ -168,6 +211,7 @@ Replayer::Replayer(int num_action_trackers)
   : m_rbd(NULL), m_ioctx(0),
     m_latency_multiplier(1.0),
     m_readonly(false), m_dump_perf_counters(false),
+    m_open_loop(false),
     m_num_action_trackers(num_action_trackers),
     m_action_trackers(new action_tracker_d[m_num_action_trackers]) {
   assertf(num_action_trackers > 0, "num_action_trackers = %d", num_action_trackers);
@@ -226,6 +270,15 @@ void Replayer::run(const std::string& replay_file) {
 
       BufferReader buffer_reader(fd);
       bool versioned = is_versioned_replay(buffer_reader);
+
+      if (m_start_time > std::chrono::system_clock::now()) {
+        dout(THREAD_LEVEL) << "Waiting for the start time" << dendl;
+        std::this_thread::sleep_until(m_start_time);
+      }
+      m_replay_start = std::chrono::steady_clock::now();
+
+      // when each action was issued in the trace, from its dependencies
+      std::unordered_map<action_id_t, uint64_t> trace_times;
       while (true) {
         action::ActionEntry action_entry;
         try {
@@ -255,6 +308,15 @@ void Replayer::run(const std::string& replay_file) {
           // unknown / unsupported action
 	  continue;
 	}
+	uint64_t trace_time = 0;
+	for (auto& dep : action->predecessors()) {
+	  auto t = trace_times.find(dep.id);
+	  if (t != trace_times.end()) {
+	    trace_time = std::max(trace_time, t->second + dep.time_delta);
+	  }
+	}
+	trace_times[action->id()] = trace_time;
+	action->set_trace_time(trace_time);
 
 	if (action->is_start_thread()) {
 	  Worker *worker = new Worker(*this);
@@ -271,6 +333,10 @@ void Replayer::run(const std::string& replay_file) {
 	w.second->join();
 	delete w.second;
       }
+      if (m_open_loop && m_late_actions) {
+        cout << m_late_actions << " actions were issued late, by at most "
+             << m_max_lag_us / 1000.0 << "ms" << std::endl;
+      }
       clear_images();
       delete m_rbd;
       m_rbd = NULL;
@@ -291,6 +357,12 @@ librbd::Image* Replayer::get_image(imagectx_id_t imagectx_id) {
 
 void Replayer::put_image(imagectx_id_t imagectx_id, librbd::Image *image) {
   ceph_assert(image);
+  {
+    std::string name;
+    image->get_name(&name);
+    std::scoped_lock lock{m_image_stats_mutex};
+    m_image_stats[imagectx_id].name = name;
+  }
   std::unique_lock lock{m_images_mutex};
   ceph_assert(m_images.count(imagectx_id) == 0);
   m_images[imagectx_id] = image;
@@ -358,7 +430,8 @@ void Replayer::wait_for_actions(const action::Dependencies &deps) {
       release_time = sub_release_time;
     }
   }
-  if (release_time > std::chrono::system_clock::now()) {
+  // in open loop, wait_until_scheduled() keeps to the trace instead
+  if (!m_open_loop && release_time > std::chrono::system_clock::now()) {
     auto sleep_for = release_time - std::chrono::system_clock::now();
     dout(SLEEP_LEVEL) << "Sleeping for "
 		      << std::chrono::duration_cast<std::chrono::microseconds>(sleep_for).count()
@@ -367,6 +440,49 @@ void Replayer::wait_for_actions(const action::Dependencies &deps) {
   }
 }
 
+void Replayer::wait_until_scheduled(const Action &action) {
+  auto release_time = m_replay_start +
+    std::chrono::nanoseconds{static_cast<uint64_t>(action.trace_time() * m_latency_multiplier)};
+  auto now = std::chrono::steady_clock::now();
+  if (release_time > now) {
+    std::this_thread::sleep_until(release_time);
+    return;
+  }
+  // more than a millisecond behind the schedule counts as late
+  uint64_t lag_us = std::chrono::duration_cast<std::chrono::microseconds>(now - release_time).count();
+  if (lag_us >= 1000) {
+    ++m_late_actions;
+    uint64_t max_lag = m_max_lag_us;
+    while (lag_us > max_lag && !m_max_lag_us.compare_exchange_weak(max_lag, lag_us)) {
+    }
+  }
+}
+
+void Replayer::record_latency(const PendingIO &io) {
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - io.start_time()).count();
+  std::scoped_lock lock{m_image_stats_mutex};
+  m_image_stats[io.imagectx_id()].latencies[io.io_type()].add(ns);
+}
+
+void Replayer::dump_latencies(std::ostream &out) const {
+  static const char *types[] = {"", "read", "write", "discard"};
+  std::scoped_lock lock{m_image_stats_mutex};
+  for (auto& [id, stats] : m_image_stats) {
+    for (int t = PendingIO::IO_READ; t <= PendingIO::IO_DISCARD; ++t) {
+      auto& h = stats.latencies[t];
+      if (!h.count()) {
+        continue;
+      }
+      out << stats.name << "\t" << types[t] << "\t" << h.count() << "\t"
+          << h.mean() / 1000 << "\t" << h.percentile(0.5) / 1000.0 << "\t"
+          << h.percentile(0.99) / 1000.0 << "\t"
+          << h.percentile(0.999) / 1000.0 << "\t" << h.max() / 1000.0
+          << std::endl;
+    }
+  }
+}
+
 void Replayer::clear_images() {
   std::shared_lock lock{m_images_mutex};
   if (m_dump_perf_counters && !m_images.empty()) {
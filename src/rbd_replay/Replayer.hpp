@@ -15,10 +15,13 @@
 #ifndef _INCLUDED_RBD_REPLAY_REPLAYER_HPP
 #define _INCLUDED_RBD_REPLAY_REPLAYER_HPP
 
+#include <atomic>
 #include <chrono>
 #include <mutex>
+#include <ostream>
 #include <thread>
 #include <condition_variable>
+#include <vector>
 #include "rbd_replay/ActionTypes.h"
 #include "BoundedBuffer.hpp"
 #include "ImageNameMap.hpp"
@@ -28,6 +31,38 @@ namespace rbd_replay {
 
 class Replayer;
 
+/**
+   Log-linear histogram of latencies in nanoseconds, with 32 buckets per
+   power of two, so that percentiles are good to about 3%.
+ */
+class LatencyHistogram {
+public:
+  void add(uint64_t ns);
+
+  uint64_t count() const {
+    return m_count;
+  }
+
+  double mean() const {
+    return m_count ? (double)m_sum / m_count : 0;
+  }
+
+  uint64_t max() const {
+    return m_max;
+  }
+
+  /// Upper bound of the latency a fraction q of the samples do not exceed.
+  uint64_t percentile(double q) const;
+
+private:
+  static const unsigned SUB_BITS = 5;
+
+  std::vector<uint64_t> m_counts = std::vector<uint64_t>(64 << SUB_BITS);
+  uint64_t m_count = 0;
+  uint64_t m_sum = 0;
+  uint64_t m_max = 0;
+};
+
 /**
    Performs Actions within a single thread.
  */
@@ -62,6 +97,8 @@ public:
 
   bool readonly() const override;
 
+  bool open_loop() const override;
+
   rbd_loc map_image_name(std::string image_name, std::string snap_name) const override;
 
 private:
@@ -85,6 +122,9 @@ public:
 
   void run(const std::string &replay_file);
 
+  /// Print the latency percentiles of the I/Os to each image.
+  void dump_latencies(std::ostream &out) const;
+
   librbd::RBD* get_rbd() {
     return m_rbd;
   }
@@ -105,6 +145,12 @@ public:
 
   void wait_for_actions(const action::Dependencies &deps);
 
+  /// Waits until the trace time of the action, scaled by the latency
+  /// multiplier, has passed since the start of the replay.
+  void wait_until_scheduled(const Action &action);
+
+  void record_latency(const PendingIO &io);
+
   std::string pool_name() const;
 
   void set_pool_name(std::string pool_name);
@@ -123,6 +169,29 @@ public:
     m_dump_perf_counters = dump_perf_counters;
   }
 
+  bool open_loop() const {
+    return m_open_loop;
+  }
+
+  void set_open_loop(bool open_loop) {
+    m_open_loop = open_loop;
+  }
+
+  /// Wall clock time to start replaying at, so that replays in several
+  /// processes can be started together.
+  void set_start_time(std::chrono::system_clock::time_point t) {
+    m_start_time = t;
+  }
+
+  /// Appended to the (mapped) name of every image opened.
+  const std::string &image_suffix() const {
+    return m_image_suffix;
+  }
+
+  void set_image_suffix(const std::string &suffix) {
+    m_image_suffix = suffix;
+  }
+
   const ImageNameMap &image_name_map() const {
     return m_image_name_map;
   }
@@ -155,6 +224,20 @@ private:
   std::map<imagectx_id_t, librbd::Image*> m_images;
   std::shared_mutex m_images_mutex;
 
+  bool m_open_loop;
+  std::chrono::system_clock::time_point m_start_time;
+  std::chrono::steady_clock::time_point m_replay_start;
+  std::string m_image_suffix;
+  std::atomic<uint64_t> m_max_lag_us{0};
+  std::atomic<uint64_t> m_late_actions{0};
+
+  struct image_stats_d {
+    std::string name;
+    LatencyHistogram latencies[PendingIO::IO_DISCARD + 1];
+  };
+  std::map<imagectx_id_t, image_stats_d> m_image_stats;
+  mutable std::mutex m_image_stats_mutex;
+
   /// Actions are hashed across the trackers by ID.
   /// Number of trackers should probably be larger than the number of cores and prime.
   /// Should definitely be odd.
@@ -0,0 +1,186 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#include "Synthesizer.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "common/ceph_json.h"
+#include "common/errno.h"
+#include "common/strtol.h"
+#include "rbd_replay/ActionTypes.h"
+
+using namespace rbd_replay;
+using namespace rbd_replay::action;
+
+namespace {
+
+struct ImageLoad {
+  std::string pool;
+  std::string name;
+  double read_ops = 0;
+  double write_ops = 0;
+  double read_bytes = 0;
+  double write_bytes = 0;
+
+  void decode_json(JSONObj *obj) {
+    JSONDecoder::decode_json("pool", pool, obj);
+    JSONDecoder::decode_json("image", name, obj, true);
+    read_ops = decode_rate("read_ops", obj);
+    write_ops = decode_rate("write_ops", obj);
+    read_bytes = decode_rate("read_bytes", obj);
+    write_bytes = decode_rate("write_bytes", obj);
+  }
+
+  static double decode_rate(const char *name, JSONObj *obj) {
+    JSONObj *o = obj->find_obj(name);
+    if (!o) {
+      return 0;
+    }
+    std::string err;
+    double rate = strict_strtod(o->get_data().c_str(), &err);
+    if (!err.empty() || rate < 0) {
+      throw JSONDecoder::err(std::string("bad ") + name + ": " + o->get_data());
+    }
+    return rate;
+  }
+};
+
+// Average request size, in whole sectors, and at most 4M.
+uint64_t request_size(double bytes, double ops) {
+  uint64_t size = ops > 0 ? bytes / ops : 0;
+  size = (size + 511) & ~511ull;
+  return std::clamp<uint64_t>(size, 512, 4 << 20);
+}
+
+}
+
+int rbd_replay::synthesize(const std::string &iostat_file,
+                           const std::string &replay_file,
+                           const SynthesizeParams &params, std::ostream &err) {
+  JSONParser parser;
+  if (!parser.parse(iostat_file.c_str()) || !parser.is_array()) {
+    err << "Unable to parse " << iostat_file
+        << ", expected the output of rbd perf image iostat --format json"
+        << std::endl;
+    return -EINVAL;
+  }
+  std::vector<ImageLoad> images;
+  try {
+    for (auto it = parser.find_first(); !it.end(); ++it) {
+      ImageLoad image;
+      image.decode_json(*it);
+      images.push_back(image);
+    }
+  } catch (const JSONDecoder::err &e) {
+    err << "Unable to parse " << iostat_file << ": " << e.what() << std::endl;
+    return -EINVAL;
+  }
+  if (images.empty()) {
+    err << "No images in " << iostat_file << std::endl;
+    return -EINVAL;
+  }
+  for (auto &image : images) {
+    if (image.pool != images[0].pool) {
+      err << "Warning: the images are in several pools, they will all be "
+          << "replayed in the pool given to rbd-replay" << std::endl;
+      break;
+    }
+  }
+
+  std::mt19937_64 rng(params.seed);
+  const uint64_t duration_ns = params.duration * 1000000000;
+
+  // One thread and image context per image.  Each action waits for the
+  // previous one of its thread, for as long as the arrival gap, and ids
+  // are even, as rbd-replay-prep leaves odd ones for completions.
+  std::vector<std::pair<uint64_t, ActionEntry>> entries;
+  action_id_t next_id = 0;
+  auto next = [&next_id]() {
+    next_id += 2;
+    return next_id;
+  };
+  for (size_t i = 0; i < images.size(); ++i) {
+    const ImageLoad &image = images[i];
+    const thread_id_t thread_id = i + 1;
+    const imagectx_id_t imagectx_id = i + 1;
+    const double ops = image.read_ops + image.write_ops;
+    const uint64_t read_size = request_size(image.read_bytes, image.read_ops);
+    const uint64_t write_size = request_size(image.write_bytes,
+                                             image.write_ops);
+
+    action_id_t prev = next();
+    entries.emplace_back(0, Action(StartThreadAction(prev, thread_id, {})));
+    action_id_t id = next();
+    entries.emplace_back(0, Action(OpenImageAction(
+      id, thread_id, {Dependency(prev, 0)}, imagectx_id, image.name, "",
+      false)));
+    prev = id;
+
+    uint64_t t = 0;
+    if (ops > 0) {
+      std::exponential_distribution<double> gap(ops / 1000000000);
+      std::bernoulli_distribution is_read(image.read_ops / ops);
+      while (true) {
+        uint64_t delta = gap(rng);
+        if (t + delta >= duration_ns) {
+          break;
+        }
+        t += delta;
+        bool read = is_read(rng);
+        uint64_t length = read ? read_size : write_size;
+        uint64_t align = length >= 4096 ? 4096 : 512;
+        uint64_t slots = params.image_size > length ?
+          (params.image_size - length) / align + 1 : 1;
+        uint64_t offset = std::uniform_int_distribution<uint64_t>(
+          0, slots - 1)(rng) * align;
+        id = next();
+        Dependencies deps{Dependency(prev, delta)};
+        if (read) {
+          entries.emplace_back(t, Action(AioReadAction(
+            id, thread_id, deps, imagectx_id, offset, length)));
+        } else {
+          entries.emplace_back(t, Action(AioWriteAction(
+            id, thread_id, deps, imagectx_id, offset, length)));
+        }
+        prev = id;
+      }
+    }
+
+    id = next();
+    entries.emplace_back(duration_ns, Action(CloseImageAction(
+      id, thread_id, {Dependency(prev, duration_ns - t)}, imagectx_id)));
+    entries.emplace_back(duration_ns, Action(StopThreadAction(
+      next(), thread_id, {Dependency(id, 0)})));
+  }
+
+  // The replayer reads actions in order, so interleave the threads.
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const auto &a, const auto &b) {
+                     return a.first < b.first;
+                   });
+
+  bufferlist bl;
+  bl.append(BANNER);
+  for (auto &entry : entries) {
+    encode(entry.second, bl);
+  }
+  int r = bl.write_file(replay_file.c_str(), 0644);
+  if (r < 0) {
+    err << "Error writing " << replay_file << ": " << cpp_strerror(r)
+        << std::endl;
+    return r;
+  }
+  err << "Wrote " << entries.size() << " actions for " << images.size()
+      << " images to " << replay_file << std::endl;
+  return 0;
+}
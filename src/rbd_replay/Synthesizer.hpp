@@ -0,0 +1,44 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#ifndef _INCLUDED_RBD_REPLAY_SYNTHESIZER_HPP
+#define _INCLUDED_RBD_REPLAY_SYNTHESIZER_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace rbd_replay {
+
+struct SynthesizeParams {
+  /// Seconds of I/O to generate.
+  double duration = 60;
+
+  /// Offsets are spread uniformly over this many bytes of every image.
+  uint64_t image_size = 1ull << 30;
+
+  uint64_t seed = 0;
+};
+
+/**
+   Writes a replay file with the I/O rates and sizes of the images in the
+   output of "rbd perf image iostat --format json", with Poisson arrivals,
+   for when no blkin or LTTng trace of the workload can be taken.
+
+   @return 0 on success, or a negative error code
+ */
+int synthesize(const std::string &iostat_file, const std::string &replay_file,
+               const SynthesizeParams &params, std::ostream &err);
+
+}
+
+#endif
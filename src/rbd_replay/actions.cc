@@ -113,6 +113,7 @@ void AioReadAction::perform(ActionCtx &worker) {
   ceph_assert(image);
   PendingIO::ptr io(new PendingIO(pending_io_id(), worker));
   worker.add_pending(io);
+  io->start_io(m_action.imagectx_id, PendingIO::IO_READ);
   int r = image->aio_read(m_action.offset, m_action.length, io->bufferlist(), &io->completion());
   assertf(r >= 0, "id = %d, r = %d", id(), r);
 }
@@ -122,6 +123,12 @@ void ReadAction::perform(ActionCtx &worker) {
   librbd::Image *image = worker.get_image(m_action.imagectx_id);
   PendingIO::ptr io(new PendingIO(pending_io_id(), worker));
   worker.add_pending(io);
+  io->start_io(m_action.imagectx_id, PendingIO::IO_READ);
+  if (worker.open_loop()) {
+    int r = image->aio_read(m_action.offset, m_action.length, io->bufferlist(), &io->completion());
+    assertf(r >= 0, "id = %d, r = %d", id(), r);
+    return;
+  }
   ssize_t r = image->read(m_action.offset, m_action.length, io->bufferlist());
   assertf(r >= 0, "id = %d, r = %d", id(), r);
   worker.remove_pending(io);
@@ -142,6 +149,7 @@ void AioWriteAction::perform(ActionCtx &worker) {
   if (worker.readonly()) {
     worker.remove_pending(io);
   } else {
+    io->start_io(m_action.imagectx_id, PendingIO::IO_WRITE);
     int r = image->aio_write(m_action.offset, m_action.length, io->bufferlist(), &io->completion());
     assertf(r >= 0, "id = %d, r = %d", id(), r);
   }
@@ -154,6 +162,12 @@ void WriteAction::perform(ActionCtx &worker) {
   worker.add_pending(io);
   io->bufferlist().append_zero(m_action.length);
   if (!worker.readonly()) {
+    io->start_io(m_action.imagectx_id, PendingIO::IO_WRITE);
+    if (worker.open_loop()) {
+      int r = image->aio_write(m_action.offset, m_action.length, io->bufferlist(), &io->completion());
+      assertf(r >= 0, "id = %d, r = %d", id(), r);
+      return;
+    }
     ssize_t r = image->write(m_action.offset, m_action.length, io->bufferlist());
     assertf(r >= 0, "id = %d, r = %d", id(), r);
   }
@@ -168,6 +182,7 @@ void AioDiscardAction::perform(ActionCtx &worker) {
   if (worker.readonly()) {
     worker.remove_pending(io);
   } else {
+    io->start_io(m_action.imagectx_id, PendingIO::IO_DISCARD);
     int r = image->aio_discard(m_action.offset, m_action.length, &io->completion());
     assertf(r >= 0, "id = %d, r = %d", id(), r);
   }
@@ -179,6 +194,12 @@ void DiscardAction::perform(ActionCtx &worker) {
   PendingIO::ptr io(new PendingIO(pending_io_id(), worker));
   worker.add_pending(io);
   if (!worker.readonly()) {
+    io->start_io(m_action.imagectx_id, PendingIO::IO_DISCARD);
+    if (worker.open_loop()) {
+      int r = image->aio_discard(m_action.offset, m_action.length, &io->completion());
+      assertf(r >= 0, "id = %d, r = %d", id(), r);
+      return;
+    }
     ssize_t r = image->discard(m_action.offset, m_action.length);
     assertf(r >= 0, "id = %d, r = %d", id(), r);
   }
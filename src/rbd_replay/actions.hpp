@@ -77,6 +77,13 @@ public:
 
   virtual void stop() = 0;
 
+  /**
+     True if actions are issued at their traced times regardless of how
+     earlier ones fare, in which case synchronous I/Os are issued
+     asynchronously so that they do not hold up the ones after them.
+   */
+  virtual bool open_loop() const = 0;
+
   /**
      Maps an image name from the name in the original trace to the name that should be used when replaying.
      @param image_name name of the image in the original trace
@@ -118,7 +125,20 @@ public:
 
   virtual std::ostream& dump(std::ostream& o) const = 0;
 
+  /// Nanoseconds since the start of the trace at which this action was
+  /// issued, as far as its dependencies tell.
+  uint64_t trace_time() const {
+    return m_trace_time;
+  }
+
+  void set_trace_time(uint64_t t) {
+    m_trace_time = t;
+  }
+
   static ptr construct(const action::ActionEntry &action_entry);
+
+private:
+  uint64_t m_trace_time = 0;
 };
 
 template <typename ActionType>
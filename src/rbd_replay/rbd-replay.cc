@@ -12,11 +12,15 @@
  *
  */
 
+#include <memory>
+#include <thread>
 #include <vector>
 #include <boost/thread.hpp>
 #include "common/ceph_argparse.h"
+#include "common/strtol.h"
 #include "global/global_init.h"
 #include "Replayer.hpp"
+#include "Synthesizer.hpp"
 #include "rbd_replay_debug.hpp"
 #include "ImageNameMap.hpp"
 
@@ -34,7 +38,8 @@ static const char* get_remainder(const char *string, const char *prefix) {
 }
 
 static void usage(const char* program) {
-  cout << "Usage: " << program << " --conf=<config_file> <replay_file>" << std::endl;
+  cout << "Usage: " << program << " --conf=<config_file> <replay_file> [<replay_file>...]" << std::endl;
+  cout << "       " << program << " --synthesize <iostat_file> <replay_file>" << std::endl;
   cout << "Options:" << std::endl;
   cout << "  -p, --pool-name <pool>          Name of the pool to use.  Default: rbd" << std::endl;
   cout << "  --latency-multiplier <float>    Multiplies inter-request latencies.  Default: 1" << std::endl;
@@ -48,6 +53,21 @@ static void usage(const char* program) {
   cout << "                                  the same image is opened and closed multiple times." << std::endl;
   cout << "                                  Performance counters and their meaning may change between" << std::endl;
   cout << "                                  versions." << std::endl;
+  cout << "  --open-loop                     Issue every action at its time in the trace," << std::endl;
+  cout << "                                  whether or not the I/Os before it completed." << std::endl;
+  cout << "  --start-at <unix time>          Start replaying at this wall clock time, to" << std::endl;
+  cout << "                                  start replays on several clients together." << std::endl;
+  cout << "  --scale <n>                     Replay each trace n times at once, against" << std::endl;
+  cout << "                                  images with the suffixes -0 to -<n-1>." << std::endl;
+  cout << std::endl;
+  cout << "Synthesis options:" << std::endl;
+  cout << "  --synthesize <iostat_file>      Write a replay file with the load of the images" << std::endl;
+  cout << "                                  in the output of" << std::endl;
+  cout << "                                  rbd perf image iostat --iterations 1 --format json" << std::endl;
+  cout << "  --duration <seconds>            Length of the synthesized trace.  Default: 60" << std::endl;
+  cout << "  --image-size <size>             Bytes of each image to spread I/O over." << std::endl;
+  cout << "                                  Default: 1G" << std::endl;
+  cout << "  --seed <n>                      Random seed.  Default: 0" << std::endl;
   cout << std::endl;
   cout << "Image mapping rules:" << std::endl;
   cout << "A rule of image1@snap1=image2@snap2 would map snap1 of image1 to snap2 of" << std::endl;
@@ -75,6 +95,12 @@ int main(int argc, const char **argv) {
   std::string val;
   std::ostringstream err;
   bool dump_perf_counters = false;
+  bool open_loop = false;
+  double start_at = 0;
+  int scale = 0;
+  string iostat_file;
+  SynthesizeParams synth;
+  std::string parse_err;
   for (i = args.begin(); i != args.end(); ) {
     if (ceph_argparse_double_dash(args, i)) {
       break;
@@ -98,6 +124,39 @@ int main(int argc, const char **argv) {
       }
     } else if (ceph_argparse_flag(args, i, "--dump-perf-counters", (char*)NULL)) {
       dump_perf_counters = true;
+    } else if (ceph_argparse_flag(args, i, "--open-loop", (char*)NULL)) {
+      open_loop = true;
+    } else if (ceph_argparse_witharg(args, i, &val, "--start-at", (char*)NULL)) {
+      start_at = strict_strtod(val.c_str(), &parse_err);
+      if (!parse_err.empty()) {
+	cerr << "Invalid --start-at: " << parse_err << std::endl;
+	return 1;
+      }
+    } else if (ceph_argparse_witharg(args, i, &scale, err, "--scale", (char*)NULL)) {
+      if (!err.str().empty() || scale < 1) {
+	cerr << "Invalid --scale: " << val << err.str() << std::endl;
+	return 1;
+      }
+    } else if (ceph_argparse_witharg(args, i, &val, "--synthesize", (char*)NULL)) {
+      iostat_file = val;
+    } else if (ceph_argparse_witharg(args, i, &val, "--duration", (char*)NULL)) {
+      synth.duration = strict_strtod(val.c_str(), &parse_err);
+      if (!parse_err.empty() || synth.duration <= 0) {
+	cerr << "Invalid --duration: " << val << std::endl;
+	return 1;
+      }
+    } else if (ceph_argparse_witharg(args, i, &val, "--image-size", (char*)NULL)) {
+      synth.image_size = strict_iecstrtoll(val, &parse_err);
+      if (!parse_err.empty() || synth.image_size == 0) {
+	cerr << "Invalid --image-size: " << val << std::endl;
+	return 1;
+      }
+    } else if (ceph_argparse_witharg(args, i, &val, "--seed", (char*)NULL)) {
+      synth.seed = strict_strtoll(val.c_str(), 10, &parse_err);
+      if (!parse_err.empty()) {
+	cerr << "Invalid --seed: " << val << std::endl;
+	return 1;
+      }
     } else if (get_remainder(*i, "-")) {
       cerr << "Unrecognized argument: " << *i << std::endl;
       return 1;
@@ -108,22 +167,66 @@ int main(int argc, const char **argv) {
 
   common_init_finish(g_ceph_context);
 
-  string replay_file;
-  if (!args.empty()) {
-    replay_file = args[0];
-  }
-
-  if (replay_file.empty()) {
+  if (args.empty()) {
     cerr << "No replay file specified." << std::endl;
     return 1;
   }
 
+  if (!iostat_file.empty()) {
+    if (args.size() != 1) {
+      cerr << "--synthesize writes a single replay file." << std::endl;
+      return 1;
+    }
+    return synthesize(iostat_file, args[0], synth, cerr) < 0 ? 1 : 0;
+  }
+
+  // Every replayer waits for the same start time, so that the traces, and
+  // the copies of each with --scale, are replayed together.
+  auto start_time = std::chrono::system_clock::now();
+  if (start_at > 0) {
+    start_time = std::chrono::system_clock::time_point(
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+	std::chrono::duration<double>(start_at)));
+  }
+
   unsigned int nthreads = boost::thread::hardware_concurrency();
-  Replayer replayer(2 * nthreads + 1);
-  replayer.set_latency_multiplier(latency_multiplier);
-  replayer.set_pool_name(pool_name);
-  replayer.set_readonly(readonly);
-  replayer.set_image_name_map(image_name_map);
-  replayer.set_dump_perf_counters(dump_perf_counters);
-  replayer.run(replay_file);
+  std::vector<std::unique_ptr<Replayer>> replayers;
+  std::vector<std::string> replay_files;
+  for (auto file : args) {
+    for (int n = 0; n < std::max(scale, 1); ++n) {
+      auto replayer = std::make_unique<Replayer>(2 * nthreads + 1);
+      replayer->set_latency_multiplier(latency_multiplier);
+      replayer->set_pool_name(pool_name);
+      replayer->set_readonly(readonly);
+      replayer->set_image_name_map(image_name_map);
+      replayer->set_dump_perf_counters(dump_perf_counters);
+      replayer->set_open_loop(open_loop);
+      replayer->set_start_time(start_time);
+      if (scale) {
+	replayer->set_image_suffix("-" + std::to_string(n));
+      }
+      replayers.push_back(std::move(replayer));
+      replay_files.push_back(file);
+    }
+  }
+
+  if (replayers.size() == 1) {
+    replayers[0]->run(replay_files[0]);
+  } else {
+    std::vector<std::thread> threads;
+    for (size_t n = 0; n < replayers.size(); ++n) {
+      threads.emplace_back([&, n] {
+	replayers[n]->run(replay_files[n]);
+      });
+    }
+    for (auto &t : threads) {
+      t.join();
+    }
+  }
+
+  cout << "image\top\tcount\tavg_us\tp50_us\tp99_us\tp99.9_us\tmax_us"
+       << std::endl;
+  for (auto &replayer : replayers) {
+    replayer->dump_latencies(cout);
+  }
 }
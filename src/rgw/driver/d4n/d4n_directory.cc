@@ -1,6 +1,7 @@
 #include <boost/asio/consign.hpp>
 #include "common/async/blocked_completion.h"
 #include "common/dout.h" 
+#include "include/ceph_hash.h"
 #include "d4n_directory.h"
 
 namespace rgw { namespace d4n {
@@ -47,6 +48,98 @@ void redis_exec(std::shared_ptr<connection> conn,
   }
 }
 
+/* Number of points per Redis instance on the hash ring */
+static constexpr unsigned DIRECTORY_RING_VNODES = 64;
+
+static uint32_t directory_hash(const std::string& s)
+{
+  return ceph_str_hash_rjenkins(s.data(), s.size());
+}
+
+Directory::Directory(std::vector<std::shared_ptr<connection>> conns) : conns(std::move(conns))
+{
+  ceph_assert(!this->conns.empty());
+  for (size_t i = 0; i < this->conns.size(); ++i) {
+    for (unsigned v = 0; v < DIRECTORY_RING_VNODES; ++v) {
+      ring.emplace(directory_hash(std::to_string(i) + "_" + std::to_string(v)), i);
+    }
+  }
+}
+
+std::shared_ptr<connection>& Directory::get_conn(const std::string& key)
+{
+  if (conns.size() == 1) {
+    return conns.front();
+  }
+  auto it = ring.lower_bound(directory_hash(key));
+  if (it == ring.end()) {
+    it = ring.begin();
+  }
+  return conns[it->second];
+}
+
+/* COPY only works within a single Redis instance. Copy an entry whose
+ * source and destination keys live on different instances field by field. */
+static int copy_across(std::shared_ptr<connection> src, const std::string& key,
+                       std::shared_ptr<connection> dst, const std::string& copyKey,
+                       const std::string& copyName, const std::string& copyBucketName,
+                       optional_yield y)
+{
+  try {
+    {
+      boost::system::error_code ec;
+      request req;
+      req.push("EXISTS", copyKey);
+      response<int> resp;
+
+      redis_exec(dst, ec, req, resp, y);
+
+      if (ec) {
+	return -ec.value();
+      } else if (std::get<0>(resp).value()) {
+	return -1; /* Same as COPY without REPLACE */
+      }
+    }
+
+    std::map<std::string, std::string> fields;
+    {
+      boost::system::error_code ec;
+      request req;
+      req.push("HGETALL", key);
+      response< std::map<std::string, std::string> > resp;
+
+      redis_exec(src, ec, req, resp, y);
+
+      if (ec) {
+	return -ec.value();
+      } else if (std::get<0>(resp).value().empty()) {
+	return -ENOENT;
+      }
+      fields = std::move(std::get<0>(resp).value());
+    }
+
+    fields["objName"] = copyName;
+    fields["bucketName"] = copyBucketName;
+
+    {
+      boost::system::error_code ec;
+      request req;
+      req.push_range("HMSET", copyKey, fields);
+      response<std::string> resp;
+
+      redis_exec(dst, ec, req, resp, y);
+
+      if (ec) {
+	return -ec.value();
+      }
+    }
+  } catch (std::exception &e) {
+    return -EINVAL;
+  }
+
+  return 0;
+}
+
 std::string ObjectDirectory::build_index(CacheObj* object) 
 {
   return object->bucketName + "_" + object->objName;
@@ -55,6 +148,7 @@ std::string ObjectDirectory::build_index(CacheObj* object)
 int ObjectDirectory::exist_key(CacheObj* object, optional_yield y) 
 {
   std::string key = build_index(object);
+  auto& conn = get_conn(key);
   response<int> resp;
 
   try {
@@ -74,6 +168,7 @@ int ObjectDirectory::exist_key(CacheObj* object, optional_yield y)
 int ObjectDirectory::set(CacheObj* object, optional_yield y) 
 {
   std::string key = build_index(object);
+  auto& conn = get_conn(key);
     
   /* Every set will be treated as new */
   std::string endpoint;
@@ -123,6 +218,7 @@ int ObjectDirectory::set(CacheObj* object, optional_yield y)
 int ObjectDirectory::get(CacheObj* object, optional_yield y) 
 {
   std::string key = build_index(object);
+  auto& conn = get_conn(key);
 
   if (exist_key(object, y)) {
     std::vector<std::string> fields;
@@ -175,10 +271,15 @@ int ObjectDirectory::get(CacheObj* object, optional_yield y)
 int ObjectDirectory::copy(CacheObj* object, std::string copyName, std::string copyBucketName, optional_yield y) 
 {
   std::string key = build_index(object);
+  auto& conn = get_conn(key);
   auto copyObj = CacheObj{ .objName = copyName, .bucketName = copyBucketName };
   std::string copyKey = build_index(&copyObj);
 
   if (exist_key(object, y)) {
+    if (auto& copyConn = get_conn(copyKey); copyConn != conn) {
+      return copy_across(conn, key, copyConn, copyKey, copyName, copyBucketName, y);
+    }
+
     try {
       response<int> resp;
      
@@ -219,6 +320,7 @@ int ObjectDirectory::copy(CacheObj* object, std::string copyName, std::string co
 int ObjectDirectory::del(CacheObj* object, optional_yield y) 
 {
   std::string key = build_index(object);
+  auto& conn = get_conn(key);
 
   if (exist_key(object, y)) {
     try {
@@ -245,6 +347,7 @@ int ObjectDirectory::del(CacheObj* object, optional_yield y)
 int ObjectDirectory::update_field(CacheObj* object, std::string field, std::string value, optional_yield y) 
 {
   std::string key = build_index(object);
+  auto& conn = get_conn(key);
 
   if (exist_key(object, y)) {
     try {
@@ -306,6 +409,68 @@ int ObjectDirectory::update_field(CacheObj* object, std::string field, std::stri
   }
 }
 
+void BlockDirectory::init(CephContext* cct)
+{
+  this->cct = cct;
+  cache_max = cct->_conf.get_val<uint64_t>("rgw_d4n_directory_cache_size");
+  cache_ttl = cct->_conf.get_val<std::chrono::seconds>("rgw_d4n_directory_cache_ttl");
+}
+
+bool BlockDirectory::cache_get(const std::string& key, CacheBlock* block)
+{
+  if (!cache_max) {
+    return false;
+  }
+  std::lock_guard l{cache_lock};
+  auto it = cache.find(key);
+  if (it == cache.end()) {
+    return false;
+  }
+  if (it->second.expires < ceph::coarse_mono_clock::now()) {
+    cache_lru.erase(it->second.lru_pos);
+    cache.erase(it);
+    return false;
+  }
+  cache_lru.splice(cache_lru.begin(), cache_lru, it->second.lru_pos);
+  *block = it->second.block;
+  return true;
+}
+
+void BlockDirectory::cache_put(const std::string& key, const CacheBlock& block)
+{
+  if (!cache_max) {
+    return;
+  }
+  std::lock_guard l{cache_lock};
+  auto expires = ceph::coarse_mono_clock::now() + cache_ttl;
+  auto [it, inserted] = cache.try_emplace(key);
+  if (inserted) {
+    cache_lru.push_front(key);
+    it->second.lru_pos = cache_lru.begin();
+  } else {
+    cache_lru.splice(cache_lru.begin(), cache_lru, it->second.lru_pos);
+  }
+  it->second.block = block;
+  it->second.expires = expires;
+
+  while (cache.size() > cache_max) {
+    cache.erase(cache_lru.back());
+    cache_lru.pop_back();
+  }
+}
+
+void BlockDirectory::cache_invalidate(const std::string& key)
+{
+  if (!cache_max) {
+    return;
+  }
+  std::lock_guard l{cache_lock};
+  if (auto it = cache.find(key); it != cache.end()) {
+    cache_lru.erase(it->second.lru_pos);
+    cache.erase(it);
+  }
+}
+
 std::string BlockDirectory::build_index(CacheBlock* block) 
 {
   return block->cacheObj.bucketName + "_" + block->cacheObj.objName + "_" + std::to_string(block->blockID) + "_" + std::to_string(block->size);
@@ -314,6 +479,7 @@ std::string BlockDirectory::build_index(CacheBlock* block)
 int BlockDirectory::exist_key(CacheBlock* block, optional_yield y) 
 {
   std::string key = build_index(block);
+  auto& conn = get_conn(key);
   response<int> resp;
 
   try {
@@ -333,6 +499,8 @@ int BlockDirectory::exist_key(CacheBlock* block, optional_yield y)
 int BlockDirectory::set(CacheBlock* block, optional_yield y) 
 {
   std::string key = build_index(block);
+  auto& conn = get_conn(key);
+  cache_invalidate(key);
     
   /* Every set will be treated as new */
   std::string endpoint;
@@ -405,6 +573,11 @@ int BlockDirectory::set(CacheBlock* block, optional_yield y)
 int BlockDirectory::get(CacheBlock* block, optional_yield y) 
 {
   std::string key = build_index(block);
+  auto& conn = get_conn(key);
+
+  if (cache_get(key, block)) {
+    return 0;
+  }
 
   if (exist_key(block, y)) {
     std::vector<std::string> fields;
@@ -466,6 +639,8 @@ int BlockDirectory::get(CacheBlock* block, optional_yield y)
 	  block->cacheObj.hostsList.push_back(host);
 	}
       }
+
+      cache_put(key, *block);
     } catch (std::exception &e) {
       return -EINVAL;
     }
@@ -480,10 +655,16 @@ int BlockDirectory::get(CacheBlock* block, optional_yield y)
 int BlockDirectory::copy(CacheBlock* block, std::string copyName, std::string copyBucketName, optional_yield y) 
 {
   std::string key = build_index(block);
+  auto& conn = get_conn(key);
   auto copyBlock = CacheBlock{ .cacheObj = { .objName = copyName, .bucketName = copyBucketName }, .blockID = 0 };
   std::string copyKey = build_index(&copyBlock);
+  cache_invalidate(copyKey);
 
   if (exist_key(block, y)) {
+    if (auto& copyConn = get_conn(copyKey); copyConn != conn) {
+      return copy_across(conn, key, copyConn, copyKey, copyName, copyBucketName, y);
+    }
+
     try {
       response<int> resp;
      
@@ -524,6 +705,8 @@ int BlockDirectory::copy(CacheBlock* block, std::string copyName, std::string co
 int BlockDirectory::del(CacheBlock* block, optional_yield y) 
 {
   std::string key = build_index(block);
+  auto& conn = get_conn(key);
+  cache_invalidate(key);
 
   if (exist_key(block, y)) {
     try {
@@ -550,6 +733,8 @@ int BlockDirectory::del(CacheBlock* block, optional_yield y)
 int BlockDirectory::update_field(CacheBlock* block, std::string field, std::string value, optional_yield y) 
 {
   std::string key = build_index(block);
+  auto& conn = get_conn(key);
+  cache_invalidate(key);
 
   if (exist_key(block, y)) {
     try {
@@ -614,6 +799,8 @@ int BlockDirectory::update_field(CacheBlock* block, std::string field, std::stri
 int BlockDirectory::remove_host(CacheBlock* block, std::string delValue, optional_yield y) 
 {
   std::string key = build_index(block);
+  auto& conn = get_conn(key);
+  cache_invalidate(key);
 
   if (exist_key(block, y)) {
     try {
@@ -2,6 +2,9 @@
 
 #include "rgw_common.h"
 
+#include <list>
+#include <mutex>
+#include <unordered_map>
 #include <boost/lexical_cast.hpp>
 #include <boost/asio/detached.hpp>
 #include <boost/redis/connection.hpp>
@@ -31,16 +34,27 @@ struct CacheBlock {
   std::vector<std::string> hostsList; /* List of hostnames <ip:port> of block locations */
 };
 
+/* The directory may be spread over several Redis instances. Keys are mapped
+ * to an instance by consistent hashing, so adding an instance only moves a
+ * share of the keys. */
 class Directory {
   public:
     CephContext* cct;
 
     Directory() {}
+    Directory(std::vector<std::shared_ptr<connection>> conns);
+
+  protected:
+    std::vector<std::shared_ptr<connection>> conns;
+    std::map<uint32_t, size_t> ring; /* hash -> index into conns */
+
+    std::shared_ptr<connection>& get_conn(const std::string& key);
 };
 
 class ObjectDirectory: public Directory {
   public:
-    ObjectDirectory(std::shared_ptr<connection>& conn) : conn(conn) {}
+    ObjectDirectory(std::shared_ptr<connection>& conn) : Directory({conn}) {}
+    ObjectDirectory(std::vector<std::shared_ptr<connection>> conns) : Directory(std::move(conns)) {}
 
     void init(CephContext* cct) {
       this->cct = cct;
@@ -54,18 +68,15 @@ class ObjectDirectory: public Directory {
     int update_field(CacheObj* object, std::string field, std::string value, optional_yield y);
 
   private:
-    std::shared_ptr<connection> conn;
-
     std::string build_index(CacheObj* object);
 };
 
 class BlockDirectory: public Directory {
   public:
-    BlockDirectory(std::shared_ptr<connection>& conn) : conn(conn) {}
+    BlockDirectory(std::shared_ptr<connection>& conn) : Directory({conn}) {}
+    BlockDirectory(std::vector<std::shared_ptr<connection>> conns) : Directory(std::move(conns)) {}
     
-    void init(CephContext* cct) {
-      this->cct = cct;
-    }
+    void init(CephContext* cct);
     int exist_key(CacheBlock* block, optional_yield y);
 
     int set(CacheBlock* block, optional_yield y);
@@ -76,7 +87,24 @@ class BlockDirectory: public Directory {
     int remove_host(CacheBlock* block, std::string value, optional_yield y);
 
   private:
-    std::shared_ptr<connection> conn;
+    /* Local cache of block entries, which saves the round trips to Redis
+     * on repeated lookups. Changes made through this directory invalidate
+     * the cached entry; changes made by other gateways are picked up once
+     * the entry expires. */
+    struct CachedBlock {
+      CacheBlock block;
+      ceph::coarse_mono_time expires;
+      std::list<std::string>::iterator lru_pos;
+    };
+    std::mutex cache_lock;
+    std::unordered_map<std::string, CachedBlock> cache;
+    std::list<std::string> cache_lru; /* front is most recently used */
+    size_t cache_max = 0;
+    ceph::timespan cache_ttl;
+
+    bool cache_get(const std::string& key, CacheBlock* block);
+    void cache_put(const std::string& key, const CacheBlock& block);
+    void cache_invalidate(const std::string& key);
 
     std::string build_index(CacheBlock* block);
 };
@@ -77,6 +77,7 @@ class LFUDAPolicy : public CachePolicy {
     optional_yield y = null_yield;
     std::shared_ptr<connection> conn;
     BlockDirectory* dir;
+    bool own_dir;
     rgw::cache::CacheDriver* cacheDriver;
     std::optional<asio::steady_timer> rthread_timer;
 
@@ -101,13 +102,22 @@ class LFUDAPolicy : public CachePolicy {
   public:
     LFUDAPolicy(std::shared_ptr<connection>& conn, rgw::cache::CacheDriver* cacheDriver) : CachePolicy(), 
 											   conn(conn), 
+											   own_dir(true),
 											   cacheDriver(cacheDriver)
     {
       dir = new BlockDirectory{conn};
     }
+    /* Share the block directory of the filter, which may be sharded over
+     * several Redis instances. conn is used for the policy's own state. */
+    LFUDAPolicy(std::shared_ptr<connection>& conn, BlockDirectory* dir, rgw::cache::CacheDriver* cacheDriver) : CachePolicy(),
+											   conn(conn),
+											   dir(dir),
+											   own_dir(false),
+											   cacheDriver(cacheDriver) {}
     ~LFUDAPolicy() {
       rthread_stop();
-      delete dir;
+      if (own_dir)
+	delete dir;
     } 
 
     virtual int init(CephContext *cct, const DoutPrefixProvider* dpp, asio::io_context& io_context);
@@ -153,6 +163,14 @@ class PolicyDriver {
 	cachePolicy = new LRUPolicy(cacheDriver);
       }
     }
+    PolicyDriver(std::shared_ptr<connection>& conn, BlockDirectory* dir, rgw::cache::CacheDriver* cacheDriver, std::string _policyName) : policyName(_policyName) 
+    {
+      if (policyName == "lfuda") {
+	cachePolicy = new LFUDAPolicy(conn, dir, cacheDriver);
+      } else if (policyName == "lru") {
+	cachePolicy = new LRUPolicy(cacheDriver);
+      }
+    }
     ~PolicyDriver() {
       delete cachePolicy;
     }
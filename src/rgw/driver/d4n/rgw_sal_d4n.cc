@@ -14,6 +14,7 @@
  */
 
 #include "rgw_sal_d4n.h"
+#include "include/str_list.h"
 
 namespace rgw { namespace sal {
 
@@ -36,7 +37,16 @@ static inline Object* nextObject(Object* t)
 D4NFilterDriver::D4NFilterDriver(Driver* _next, boost::asio::io_context& io_context) : FilterDriver(_next),
                                                                                        io_context(io_context) 
 {
-  conn = std::make_shared<connection>(boost::asio::make_strand(io_context));
+  /* The directory is sharded over all configured Redis instances; the
+   * first one also holds the policy state. */
+  std::vector<std::string> addresses;
+  get_str_vec(g_conf()->rgw_d4n_address, ", ", addresses);
+  if (addresses.empty()) {
+    addresses.emplace_back();
+  }
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    conns.push_back(std::make_shared<connection>(boost::asio::make_strand(io_context)));
+  }
 
   rgw::cache::Partition partition_info;
   partition_info.location = g_conf()->rgw_d4n_l1_datacache_persistent_path;
@@ -45,20 +55,22 @@ D4NFilterDriver::D4NFilterDriver(Driver* _next, boost::asio::io_context& io_cont
   partition_info.size = g_conf()->rgw_d4n_l1_datacache_size;
 
   cacheDriver = new rgw::cache::SSDDriver(partition_info);
-  objDir = new rgw::d4n::ObjectDirectory(conn);
-  blockDir = new rgw::d4n::BlockDirectory(conn);
-  policyDriver = new rgw::d4n::PolicyDriver(conn, cacheDriver, "lfuda");
+  objDir = new rgw::d4n::ObjectDirectory(conns);
+  blockDir = new rgw::d4n::BlockDirectory(conns);
+  policyDriver = new rgw::d4n::PolicyDriver(conns.front(), blockDir, cacheDriver, "lfuda");
 }
 
 D4NFilterDriver::~D4NFilterDriver()
 {
-  // call cancel() on the connection's executor
-  boost::asio::dispatch(conn->get_executor(), [c = conn] { c->cancel(); });
+  // call cancel() on each connection's executor
+  for (auto& conn : conns) {
+    boost::asio::dispatch(conn->get_executor(), [c = conn] { c->cancel(); });
+  }
 
   delete cacheDriver;
+  delete policyDriver;
   delete objDir; 
   delete blockDir; 
-  delete policyDriver;
 }
 
 int D4NFilterDriver::initialize(CephContext *cct, const DoutPrefixProvider *dpp)
@@ -66,18 +78,27 @@ int D4NFilterDriver::initialize(CephContext *cct, const DoutPrefixProvider *dpp)
   namespace net = boost::asio;
   using boost::redis::config;
 
-  std::string address = cct->_conf->rgw_d4n_address;
-  config cfg;
-  cfg.addr.host = address.substr(0, address.find(":"));
-  cfg.addr.port = address.substr(address.find(":") + 1, address.length());
-  cfg.clientname = "D4N.Filter";
-
-  if (!cfg.addr.host.length() || !cfg.addr.port.length()) {
+  std::vector<std::string> addresses;
+  get_str_vec(cct->_conf->rgw_d4n_address, ", ", addresses);
+  if (addresses.size() != conns.size()) {
     ldpp_dout(dpp, 10) << "D4NFilterDriver::" << __func__ << "(): Endpoint was not configured correctly." << dendl;
     return -EDESTADDRREQ;
   }
 
-  conn->async_run(cfg, {}, net::consign(net::detached, conn));
+  for (size_t i = 0; i < conns.size(); ++i) {
+    const auto& address = addresses[i];
+    config cfg;
+    cfg.addr.host = address.substr(0, address.find(":"));
+    cfg.addr.port = address.substr(address.find(":") + 1, address.length());
+    cfg.clientname = "D4N.Filter";
+
+    if (!cfg.addr.host.length() || !cfg.addr.port.length()) {
+      ldpp_dout(dpp, 10) << "D4NFilterDriver::" << __func__ << "(): Endpoint was not configured correctly." << dendl;
+      return -EDESTADDRREQ;
+    }
+
+    conns[i]->async_run(cfg, {}, net::consign(net::detached, conns[i]));
+  }
 
   FilterDriver::initialize(cct, dpp);
 
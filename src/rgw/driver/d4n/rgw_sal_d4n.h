@@ -41,7 +41,7 @@ using boost::redis::connection;
 
 class D4NFilterDriver : public FilterDriver {
   private:
-    std::shared_ptr<connection> conn;
+    std::vector<std::shared_ptr<connection>> conns; /* one per directory shard */
     rgw::cache::CacheDriver* cacheDriver;
     rgw::d4n::ObjectDirectory* objDir;
     rgw::d4n::BlockDirectory* blockDir;
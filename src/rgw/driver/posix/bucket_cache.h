@@ -4,6 +4,7 @@
 #pragma once
 
 #include <iostream>
+#include <fstream>
 #include <lmdb.h>
 #include <memory>
 #include <tuple>
@@ -21,6 +22,7 @@
 #include "zpp_bits.h"
 #include "notify.h"
 #include <stdint.h>
+#include <sys/stat.h>
 #include <time.h> // struct timespec
 #include <xxhash.h>
 
@@ -160,10 +162,14 @@ public:
 #endif
 	bc->cache.remove(hk, this, bucket_avl_cache::FLAG_NONE);
 
-	/* discard lmdb data associated with this bucket */
-	auto txn = env->getRWTransaction();
-	mdb_drop(*txn, dbi, 0);
-	txn->commit();
+	/* discard lmdb data associated with this bucket, unless it is
+	 * complete and persisted, in which case it is revalidated
+	 * against the bucket directory when the bucket is next listed */
+	if (! (bc->lmdbs.persistent() && (flags & FLAG_FILLED))) {
+	  auto txn = env->getRWTransaction();
+	  mdb_drop(*txn, dbi, 0);
+	  txn->commit();
+	}
 	/* LMDB applications don't "normally" close database handles,
 	 * but doing so (atomically) is supported, and we must as
 	 * we continually recycle them */
@@ -203,29 +209,52 @@ struct BucketCache : public Notifiable
   /* the lmdb handle cache maintains a vector of lmdb environments,
    * each supports 1 rw and unlimited ro transactions;  the materialized
    * listing for each bucket is stored as a database in one of these
-   * environments, selected by a hash of the bucket name; a bucket's database
-   * is dropped/cleared whenever its entry is reclaimed from cache; the entire
-   * complex is cleared on restart to preserve consistency */
+   * environments, selected by a hash of the bucket name; unless the
+   * cache is persistent, a bucket's database is dropped/cleared whenever
+   * its entry is reclaimed from cache, and the entire complex is cleared
+   * on restart to preserve consistency
+   *
+   * a persistent cache instead keeps complete listings across reclaim and
+   * restart; each environment holds a stamp database which records the
+   * state of the bucket directory (inode and mtime) from which a listing
+   * was filled, and a listing is reused only while the directory still
+   * carries the same stamp */
   class Lmdbs
   {
     std::string database_root;
     uint8_t lmdb_count;
+    bool persist;
     std::vector<std::shared_ptr<LMDBSafe::MDBEnv>> envs;
+    std::vector<LMDBSafe::MDBDbi> stamp_dbis;
     sf::path dbp;
 
+    /* not a valid bucket name */
+    static constexpr std::string_view stamp_db_name = ".rgw_posix_fill_stamps";
+
   public:
-    Lmdbs(std::string& database_root, uint8_t lmdb_count)
+    Lmdbs(std::string& database_root, uint8_t lmdb_count, bool persist)
       : database_root(database_root), lmdb_count(lmdb_count),
-        dbp(database_root) {
+        persist(persist), dbp(database_root) {
 
       /* create a root for lmdb directory partitions (if it doesn't
        * exist already) */
       sf::path safe_root_path{dbp / fmt::format("rgw_posix_lmdbs")};
       sf::create_directory(safe_root_path);
 
-      /* purge cache completely */
-      for (const auto& dir_entry : sf::directory_iterator{safe_root_path}) {
-	sf::remove_all(dir_entry);
+      /* a persisted cache is only valid for the same partitioning */
+      sf::path format_path{safe_root_path / "format"};
+      bool purge{true};
+      if (persist) {
+	std::ifstream ifs(format_path);
+	unsigned count{0};
+	purge = ! ((ifs >> count) && (count == lmdb_count));
+      }
+
+      if (purge) {
+	/* purge cache completely */
+	for (const auto& dir_entry : sf::directory_iterator{safe_root_path}) {
+	  sf::remove_all(dir_entry);
+	}
       }
 
       /* repopulate cache basis */
@@ -233,8 +262,14 @@ struct BucketCache : public Notifiable
 	sf::path env_path{safe_root_path / fmt::format("part_{}", ix)};
 	sf::create_directory(env_path);
 	auto env = LMDBSafe::getMDBEnv(env_path.string().c_str(), 0 /* flags? */, 0600);
+	stamp_dbis.push_back(env->openDB(stamp_db_name, MDB_CREATE));
 	envs.push_back(env);
       }
+
+      if (persist && purge) {
+	std::ofstream ofs(format_path);
+	ofs << unsigned(lmdb_count) << std::endl;
+      }
     }
 
     inline std::shared_ptr<LMDBSafe::MDBEnv>& get_sp_env(BucketCacheEntry<D, B>* bucket)  {
@@ -245,6 +280,12 @@ struct BucketCache : public Notifiable
       return *(get_sp_env(bucket));
     }
 
+    inline LMDBSafe::MDBDbi& get_stamp_dbi(BucketCacheEntry<D, B>* bucket) {
+      return stamp_dbis[(bucket->hk % lmdb_count)];
+    }
+
+    bool persistent() const { return persist; }
+
     const std::string& get_root() const { return database_root; }
   } lmdbs;
 
@@ -253,12 +294,12 @@ struct BucketCache : public Notifiable
 public:
   BucketCache(D* driver, std::string bucket_root, std::string database_root,
 	      uint32_t max_buckets=100, uint8_t max_lanes=3,
-	      uint8_t max_partitions=3, uint8_t lmdb_count=3)
+	      uint8_t max_partitions=3, uint8_t lmdb_count=3, bool persist=false)
     : driver(driver), bucket_root(bucket_root), max_buckets(max_buckets),
       lru(max_lanes, max_buckets/max_lanes),
       cache(max_lanes, max_buckets/max_partitions),
       rp(bucket_root),
-      lmdbs(database_root, lmdb_count),
+      lmdbs(database_root, lmdb_count, persist),
       un(Notify::factory(this, bucket_root))
     {
       if (! (sf::exists(rp) && sf::is_directory(rp))) {
@@ -356,9 +397,82 @@ public:
     return k_str;
   }
 
+  /* the state of a bucket directory which a cached listing reflects */
+  struct FillStamp
+  {
+    uint64_t ino{0};
+    int64_t sec{0};
+    int64_t nsec{0};
+
+    bool operator==(const FillStamp& rhs) const = default;
+  };
+
+  bool get_fill_stamp(const std::string& name, FillStamp& stamp) {
+    struct stat st;
+    sf::path bp{rp / name};
+    if (::stat(bp.c_str(), &st) == -1) {
+      return false;
+    }
+    stamp.ino = st.st_ino;
+    stamp.sec = st.st_mtim.tv_sec;
+    stamp.nsec = st.st_mtim.tv_nsec;
+    return true;
+  }
+
+  static bool stamp_is_racy(const FillStamp& stamp) {
+    /* directory timestamps are coarse-grained: a change made within the
+     * same tick as the scan may not advance the mtime, so a stamp that
+     * is this recent doesn't prove the listing is complete */
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (stamp.sec + 1) >= now.tv_sec;
+  }
+
+  /* reuse a persisted listing if the bucket directory hasn't changed
+   * since it was filled, otherwise discard it */
+  bool restore(BucketCacheEntry<D, B>* bucket) /* assert: LOCKED */
+  {
+    using namespace LMDBSafe;
+
+    if (! lmdbs.persistent()) {
+      return false;
+    }
+
+    FillStamp cur, saved;
+    auto& stamp_dbi = lmdbs.get_stamp_dbi(bucket);
+    auto txn = bucket->env->getRWTransaction();
+    MDBOutVal data;
+    if (txn->get(stamp_dbi, bucket->name, data) == MDB_SUCCESS) {
+      std::string ser_v{data.get<string_view>()};
+      zpp::bits::in in_v(ser_v);
+      auto errc = in_v(saved.ino, saved.sec, saved.nsec);
+      if (errc.code == std::errc{0}) {
+	/* watch before validating, so that no later change is lost */
+	un->add_watch(bucket->name, bucket);
+	if (get_fill_stamp(bucket->name, cur) && (saved == cur)) {
+	  txn->abort();
+	  bucket->flags |= BucketCacheEntry<D, B>::FLAG_FILLED;
+	  return true;
+	}
+	un->remove_watch(bucket->name);
+      }
+    }
+
+    mdb_drop(*txn, bucket->dbi, 0);
+    txn->del(stamp_dbi, bucket->name);
+    txn->commit();
+    return false;
+  } /* restore */
+
   int fill(const DoutPrefixProvider* dpp, BucketCacheEntry<D, B>* bucket,
 	    B* sal_bucket, uint32_t flags, optional_yield y) /* assert: LOCKED */
   {
+      /* stamp the directory before the scan, so that any change which
+       * races with it will invalidate the stamp */
+      FillStamp stamp;
+      bool have_stamp = lmdbs.persistent() &&
+	get_fill_stamp(bucket->name, stamp) && !stamp_is_racy(stamp);
+
       auto txn = bucket->env->getRWTransaction();
 
       /* instruct the bucket provider to enumerate all entries,
@@ -386,6 +500,14 @@ public:
 	  return 0;
 	});
 
+      if (have_stamp && (rc == 0)) {
+	std::string ser_stamp;
+	zpp::bits::out out(ser_stamp);
+	auto errc = out(stamp.ino, stamp.sec, stamp.nsec);
+	if (errc.code == std::errc{0}) {
+	  txn->put(lmdbs.get_stamp_dbi(bucket), bucket->name, ser_stamp);
+	}
+      }
       txn->commit();
       bucket->flags |= BucketCacheEntry<D, B>::FLAG_FILLED;
       un->add_watch(bucket->name, bucket);
@@ -403,7 +525,8 @@ public:
 		 BucketCache<D, B>::FLAG_LOCK | BucketCache<D, B>::FLAG_CREATE);
     auto [b /* BucketCacheEntry */, flags] = gbr;
     if (b /* XXX again, can this fail? */) {
-      if (! (b->flags & BucketCacheEntry<D, B>::FLAG_FILLED)) {
+      if (! (b->flags & BucketCacheEntry<D, B>::FLAG_FILLED) &&
+	  ! restore(b)) {
 	/* bulk load into lmdb cache */
 	rc = fill(dpp, b, sal_bucket, FLAG_NONE, y);
       }
@@ -528,6 +651,7 @@ public:
 	  /* yikes, cache blown */
 	  ulk.lock();
 	  mdb_drop(*txn, b->dbi, 0);
+	  txn->del(lmdbs.get_stamp_dbi(b), b->name);
 	  txn->commit();
 	  b->flags &= ~BucketCacheEntry<D, B>::FLAG_FILLED;
 	  return 0; /* don't process any more events in this batch */
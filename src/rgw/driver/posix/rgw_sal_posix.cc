@@ -14,6 +14,8 @@
  */
 
 #include "rgw_sal_posix.h"
+#include <atomic>
+#include <thread>
 #include <dirent.h>
 #include <sys/stat.h>
 #include <sys/xattr.h>
@@ -251,7 +253,8 @@ int POSIXDriver::initialize(CephContext *cct, const DoutPrefixProvider *dpp)
       g_conf().get_val<int64_t>("rgw_posix_cache_max_buckets"),
       g_conf().get_val<int64_t>("rgw_posix_cache_lanes"),
       g_conf().get_val<int64_t>("rgw_posix_cache_partitions"),
-      g_conf().get_val<int64_t>("rgw_posix_cache_lmdb_count")));
+      g_conf().get_val<int64_t>("rgw_posix_cache_lmdb_count"),
+      g_conf().get_val<bool>("rgw_posix_cache_persist")));
 
   root_fd = openat(-1, base_path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
   if (root_fd == -1) {
@@ -650,17 +653,25 @@ int POSIXDriver::mint_listing_entry(const std::string &bname,
 int POSIXBucket::fill_cache(const DoutPrefixProvider* dpp, optional_yield y,
 			    fill_cache_cb_t cb)
 {
-  int ret = for_each(dpp, [this, &cb, &dpp, &y](const char* name) {
+  /* entries are read from the directory in batches; stat and xattr
+   * reads for a batch are spread over the fill threads, and the results
+   * are handed to the cache from this thread, which owns its write
+   * transaction */
+  static constexpr size_t fill_batch_size = 1024;
+  const auto nthreads =
+    g_conf().get_val<uint64_t>("rgw_posix_cache_fill_threads");
+  std::vector<std::string> names;
+  std::vector<rgw_bucket_dir_entry> bdes;
+  std::vector<int> rets;
+  names.reserve(fill_batch_size);
+
+  auto fill_entry = [this, &dpp](const std::string& name, optional_yield y,
+				 rgw_bucket_dir_entry& bde) -> int {
     int ret;
     std::unique_ptr<Object> obj;
     POSIXObject* pobj;
 
-    if (name[0] == '.') {
-      /* Skip dotfiles */
-      return 0;
-    }
-
-    obj = get_object(decode_obj_key(name));
+    obj = get_object(decode_obj_key(name.c_str()));
     pobj = static_cast<POSIXObject*>(obj.get());
 
     if (!pobj->check_exists(dpp)) {
@@ -674,15 +685,62 @@ int POSIXBucket::fill_cache(const DoutPrefixProvider* dpp, optional_yield y,
     if (ret < 0)
       return ret;
 
-    rgw_bucket_dir_entry bde{};
-    ret = pobj->fill_bde(dpp, y, bde);
-    if (ret < 0)
-      return ret;
+    return pobj->fill_bde(dpp, y, bde);
+  };
 
-    cb(dpp, bde);
+  auto flush = [&]() -> int {
+    int ret = 0;
+    bdes.assign(names.size(), rgw_bucket_dir_entry{});
+    rets.assign(names.size(), 0);
 
-    return 0;
+    if (nthreads < 2 || names.size() < 2) {
+      for (size_t ix = 0; ix < names.size(); ++ix) {
+	rets[ix] = fill_entry(names[ix], y, bdes[ix]);
+      }
+    } else {
+      std::atomic<size_t> next{0};
+      std::vector<std::thread> threads;
+      auto n = std::min<size_t>(nthreads, names.size());
+      threads.reserve(n);
+      for (size_t t = 0; t < n; ++t) {
+	threads.emplace_back([&] {
+	  for (size_t ix = next++; ix < names.size(); ix = next++) {
+	    rets[ix] = fill_entry(names[ix], null_yield, bdes[ix]);
+	  }
+	});
+      }
+      for (auto& t : threads) {
+	t.join();
+      }
+    }
+
+    for (size_t ix = 0; ix < names.size(); ++ix) {
+      if (rets[ix] < 0) {
+	ret = rets[ix];
+	continue;
+      }
+      cb(dpp, bdes[ix]);
+    }
+    names.clear();
+    return ret;
+  };
+
+  int ret = for_each(dpp, [&names, &flush](const char* name) {
+    if (name[0] == '.') {
+      /* Skip dotfiles */
+      return 0;
+    }
+
+    names.emplace_back(name);
+    if (names.size() < fill_batch_size) {
+      return 0;
+    }
+    return flush();
   });
+  int r = flush();
+  if (r < 0) {
+    ret = r;
+  }
   if (ret < 0) {
     ldpp_dout(dpp, 0) << "ERROR: could not list bucket " << get_name() << ": "
       << cpp_strerror(ret) << dendl;
@@ -757,7 +757,7 @@ int FIFO::_prepare_new_part(const DoutPrefixProvider *dpp,
       auto found = (info.journal.contains({create, new_part_num}) ||
 		    info.journal.contains({set_head, new_part_num}));
       if ((info.max_push_part_num >= new_part_num &&
-	   info.head_part_num >= new_part_num)) {
+	   (!is_head || info.head_part_num >= new_part_num))) {
 	ldpp_dout(dpp, 20) << __PRETTY_FUNCTION__ << ":" << __LINE__
 		       << " raced, but journaled and processed: i=" << i
 		       << " tid=" << tid << dendl;
@@ -881,15 +881,16 @@ struct NewPartPreparer : public Completion<NewPartPreparer> {
   std::vector<fifo::journal_entry> jentries;
   int i = 0;
   std::int64_t new_part_num;
+  bool is_head;
   bool canceled = false;
   uint64_t tid;
 
   NewPartPreparer(const DoutPrefixProvider *dpp, FIFO* f, lr::AioCompletion* super,
 		  std::vector<fifo::journal_entry> jentries,
-		  std::int64_t new_part_num,
+		  std::int64_t new_part_num, bool is_head,
 		  std::uint64_t tid)
     : Completion(dpp, super), f(f), jentries(std::move(jentries)),
-      new_part_num(new_part_num), tid(tid) {}
+      new_part_num(new_part_num), is_head(is_head), tid(tid) {}
 
   void handle(const DoutPrefixProvider *dpp, Ptr&& p, int r) {
     ldpp_dout(dpp, 20) << __PRETTY_FUNCTION__ << ":" << __LINE__
@@ -912,7 +913,7 @@ struct NewPartPreparer : public Completion<NewPartPreparer> {
       auto version = f->info.version;
       l.unlock();
       if ((max_push_part_num >= new_part_num &&
-	   head_part_num >= new_part_num)) {
+	   (!is_head || head_part_num >= new_part_num))) {
 	ldpp_dout(dpp, 20) << __PRETTY_FUNCTION__ << ":" << __LINE__
 			  << " raced, but journaled and processed: i=" << i
 			  << " tid=" << tid << dendl;
@@ -965,7 +966,7 @@ void FIFO::_prepare_new_part(const DoutPrefixProvider *dpp, std::int64_t new_par
   l.unlock();
 
   auto n = std::make_unique<NewPartPreparer>(dpp, this, c, jentries,
-					     new_part_num, tid);
+					     new_part_num, is_head, tid);
   auto np = n.get();
   _update_meta(dpp, fifo::update{}.journal_entries_add(jentries), version,
 	       &np->canceled, tid, NewPartPreparer::call(std::move(n)));
@@ -1319,7 +1320,95 @@ void FIFO::push(const DoutPrefixProvider *dpp, const cb::list& bl, lr::AioComple
   push(dpp, std::vector{ bl }, c);
 }
 
+FIFO::~FIFO()
+{
+  if (next_part) {
+    next_part->wait_for_complete();
+    next_part->release();
+  }
+}
+
+void FIFO::prepare_next_part()
+{
+  std::unique_lock l(m);
+  if (next_part) {
+    if (!next_part->is_complete()) {
+      return;
+    }
+    next_part->release();
+    next_part = nullptr;
+  }
+  if (info.max_push_part_num > info.head_part_num) {
+    return;
+  }
+  auto new_part_num = info.head_part_num + 1;
+  auto tid = ++next_tid;
+  next_part = lr::Rados::aio_create_completion();
+  auto c = next_part;
+  l.unlock();
+  ldpp_dout(&next_part_dpp, 20) << __PRETTY_FUNCTION__ << ":" << __LINE__
+		 << " creating part " << new_part_num
+		 << " ahead of the head: tid=" << tid << dendl;
+  // Failure is harmless: the next rollover creates the part itself.
+  _prepare_new_part(&next_part_dpp, new_part_num, false, tid, c);
+}
+
 int FIFO::push(const DoutPrefixProvider *dpp, const std::vector<cb::list>& data_bufs, optional_yield y)
+{
+  if (y || data_bufs.empty()) {
+    // a coroutine must not block on other callers
+    return _push(dpp, data_bufs, y);
+  }
+  {
+    std::unique_lock l(m);
+    auto max_entry_size = info.params.max_entry_size;
+    l.unlock();
+    // an entry that is too big must fail its own push only
+    for (const auto& bl : data_bufs) {
+      if (bl.length() > max_entry_size) {
+	ldpp_dout(dpp, -1) << __PRETTY_FUNCTION__ << ":" << __LINE__
+		   << " entry bigger than max_entry_size" << dendl;
+	return -E2BIG;
+      }
+    }
+  }
+
+  std::unique_lock l(push_m);
+  int r;
+  if (!pushing) {
+    pushing = true;
+    l.unlock();
+    r = _push(dpp, data_bufs, y);
+    l.lock();
+  } else {
+    if (!next_push) {
+      next_push = std::make_shared<push_group>();
+    }
+    auto g = next_push;
+    g->entries.insert(g->entries.end(), data_bufs.begin(), data_bufs.end());
+    push_cond.wait(l, [&] { return g->done || !pushing; });
+    if (g->done) {
+      return g->r;
+    }
+    // our turn: push the whole group, while new callers form the next one
+    pushing = true;
+    next_push.reset();
+    auto entries = std::move(g->entries);
+    l.unlock();
+    ldpp_dout(dpp, 20) << __PRETTY_FUNCTION__ << ":" << __LINE__
+		   << " pushing " << entries.size()
+		   << " combined entries" << dendl;
+    r = _push(dpp, entries, y);
+    l.lock();
+    g->r = r;
+    g->done = true;
+  }
+  pushing = false;
+  push_cond.notify_all();
+  return r;
+}
+
+int FIFO::_push(const DoutPrefixProvider *dpp, const std::vector<cb::list>& data_bufs, optional_yield y)
 {
   std::unique_lock l(m);
   auto tid = ++next_tid;
@@ -1355,6 +1444,7 @@ int FIFO::push(const DoutPrefixProvider *dpp, const std::vector<cb::list>& data_
 		 << " tid=" << tid << dendl;
       return r;
     }
+    prepare_next_part();
   }
 
   std::deque<cb::list> remaining(data_bufs.begin(), data_bufs.end());
@@ -1404,6 +1494,7 @@ int FIFO::push(const DoutPrefixProvider *dpp, const std::vector<cb::list>& data_
 		   << " tid=" << tid << dendl;
 	return r;
       }
+      prepare_next_part();
       r = 0;
       continue;
     }
@@ -1563,6 +1654,9 @@ struct Pusher : public Completion<Pusher> {
 	return;
       }
       state = pushing;
+      if (r == 0) {
+	f->prepare_next_part();
+      }
       handle_new_head(dpp, std::move(p), r);
       break;
 
@@ -15,6 +15,7 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <cstdint>
 #include <deque>
 #include <map>
@@ -118,6 +119,25 @@ class FIFO {
   std::uint32_t part_header_size = 0xdeadbeef;
   std::uint32_t part_entry_overhead = 0xdeadbeef;
 
+  /// Blocking pushes that arrive while another one is in flight join
+  /// the next group, which the first of them to get a turn pushes for
+  /// all of them; see push().
+  struct push_group {
+    std::vector<cb::list> entries;
+    int r = 0;
+    bool done = false;
+  };
+  std::mutex push_m;
+  std::condition_variable push_cond;
+  bool pushing = false;
+  std::shared_ptr<push_group> next_push;
+
+  /// Creation of the part after the head, started when the head rolls
+  /// over so that the next rollover only has to move the head. Guarded
+  /// by m.
+  lr::AioCompletion* next_part = nullptr;
+  NoDoutPrefix next_part_dpp{cct, ceph_subsys_rgw};
+
   std::optional<marker> to_marker(std::string_view s);
 
   FIFO(lr::IoCtx&& ioc,
@@ -146,6 +166,9 @@ class FIFO {
   int _prepare_new_head(const DoutPrefixProvider *dpp, std::int64_t new_head_part_num,
 			std::uint64_t tid, optional_yield y);
   void _prepare_new_head(const DoutPrefixProvider *dpp, std::int64_t new_head_part_num, std::uint64_t tid, lr::AioCompletion* c);
+  void prepare_next_part();
+  int _push(const DoutPrefixProvider *dpp,
+	    const std::vector<cb::list>& data_bufs, optional_yield y);
   int push_entries(const DoutPrefixProvider *dpp, const std::deque<cb::list>& data_bufs,
 		   std::uint64_t tid, optional_yield y);
   void push_entries(const std::deque<cb::list>& data_bufs,
@@ -166,6 +189,7 @@ public:
   FIFO& operator =(const FIFO&) = delete;
   FIFO(FIFO&&) = delete;
   FIFO& operator =(FIFO&&) = delete;
+  ~FIFO();
 
   /// Open an existing FIFO.
   static int open(const DoutPrefixProvider *dpp, lr::IoCtx ioctx, //< IO Context
@@ -209,7 +233,8 @@ public:
   void push(const DoutPrefixProvider *dpp, const cb::list& bl, //< Entry to push
 	    lr::AioCompletion* c //< Async Completion
     );
-  /// Push entries to the FIFO
+  /// Push entries to the FIFO. Without a yield context, concurrent
+  /// callers are combined into as few pushes as possible.
   int push(const DoutPrefixProvider *dpp, 
            const std::vector<cb::list>& data_bufs, //< Entries to push
 	   optional_yield y //< Optional yield
@@ -3041,7 +3041,7 @@ public:
                                                             std::move(dest_params),
                                                             need_retry);
 
-          call(new RGWFetchRemoteObjCR(sync_env->async_rados, sync_env->driver, sc->source_zone,
+          call(new RGWFetchRemoteObjCR(sync_env->svc->fetch_processor, sync_env->driver, sc->source_zone,
                                        nullopt,
                                        sync_pipe.source_bucket_info.bucket,
                                        std::nullopt, sync_pipe.dest_bucket_info,
@@ -15,6 +15,7 @@
 #include "include/random.h"
 #include "rgw_gc_log.h"
 
+#include <algorithm>
 #include <list> // XXX
 #include <sstream>
 #include "xxhash.h"
@@ -35,6 +36,8 @@ void RGWGC::initialize(CephContext *_cct, RGWRados *_store, optional_yield y) {
   max_objs = min(static_cast<int>(cct->_conf->rgw_gc_max_objs), rgw_shards_max());
 
   obj_names = new string[max_objs];
+  transitioned_objects_cache.reset(new std::atomic<bool>[max_objs]());
+  shard_busy.reset(new std::atomic<bool>[max_objs]());
 
   for (int i = 0; i < max_objs; i++) {
     obj_names[i] = gc_oid_prefix;
@@ -42,9 +45,6 @@ void RGWGC::initialize(CephContext *_cct, RGWRados *_store, optional_yield y) {
     snprintf(buf, 32, ".%d", i);
     obj_names[i].append(buf);
 
-    auto it = transitioned_objects_cache.begin() + i;
-    transitioned_objects_cache.insert(it, false);
-
     //version = 0 -> not ready for transition
     //version = 1 -> marked ready for transition
     librados::ObjectWriteOperation op;
@@ -405,7 +405,14 @@ public:
 
   int handle_next_completion() {
     ceph_assert(!ios.empty());
-    IO& io = ios.front();
+    /* reap any io that has completed rather than waiting behind the oldest
+     * one, which may sit on a slow osd */
+    auto it = std::find_if(ios.begin(), ios.end(),
+                           [](const IO& io) { return io.c->is_complete(); });
+    if (it == ios.end()) {
+      it = ios.begin();
+    }
+    IO& io = *it;
     io.c->wait_for_complete();
     int ret = io.c->get_return_value();
     io.c->release();
@@ -433,7 +440,7 @@ public:
     }
 
   done:
-    ios.pop_front();
+    ios.erase(it);
     return ret;
   }
 
@@ -549,6 +556,22 @@ public:
 
 int RGWGC::process(int index, int max_secs, bool expired_only,
                    RGWGCIOManager& io_manager, optional_yield y)
+{
+  if (shard_busy[index].exchange(true)) {
+    ldpp_dout(this, 10) << "RGWGC::process shard " << obj_names[index] <<
+      " is being processed by another worker" << dendl;
+    return 0;
+  }
+  auto busy_guard = make_scope_guard([&] { shard_busy[index] = false; });
+
+  bool unfinished = false;
+  return process_shard(index, max_secs, expired_only, io_manager,
+                       &unfinished, y);
+}
+
+int RGWGC::process_shard(int index, int max_secs, bool expired_only,
+                         RGWGCIOManager& io_manager, bool *unfinished,
+                         optional_yield y)
 {
   ldpp_dout(this, 20) << "RGWGC::process entered with GC index_shard=" <<
     index << ", max_secs=" << max_secs << ", expired_only=" <<
@@ -644,6 +667,7 @@ int RGWGC::process(int index, int max_secs, bool expired_only,
 
       utime_t now = ceph_clock_now();
       if (now >= end) {
+        *unfinished = true;
         goto done;
       }
       if (! transitioned_objects_cache[index]) {
@@ -733,16 +757,36 @@ int RGWGC::process(bool expired_only, optional_yield y)
 
   RGWGCIOManager io_manager(this, store->ctx(), this);
 
+  unsigned unfinished_shards = 0;
   for (int i = 0; i < max_objs; i++) {
     int index = (i + start) % max_objs;
-    int ret = process(index, max_secs, expired_only, io_manager, y);
+    if (shard_busy[index].exchange(true)) {
+      continue; // another worker of ours has it
+    }
+    auto busy_guard = make_scope_guard([&] { shard_busy[index] = false; });
+    bool unfinished = false;
+    int ret = process_shard(index, max_secs, expired_only, io_manager,
+                            &unfinished, y);
     if (ret < 0)
       return ret;
+    if (unfinished) {
+      ++unfinished_shards;
+    }
   }
   if (!going_down()) {
     io_manager.drain();
   }
 
+  const unsigned prev = backlog.exchange(unfinished_shards);
+  ldpp_dout(this, 10) << "RGWGC::process " << unfinished_shards <<
+    " shards left unfinished" << dendl;
+  if (unfinished_shards > prev) {
+    /* bring in the helper workers */
+    for (size_t i = 1; i < workers.size(); i++) {
+      workers[i]->wakeup();
+    }
+  }
+
   return 0;
 }
 
@@ -753,19 +797,21 @@ bool RGWGC::going_down()
 
 void RGWGC::start_processor()
 {
-  worker = new GCWorker(this, cct, this);
-  worker->create("rgw_gc");
+  const auto num_workers = cct->_conf.get_val<uint64_t>("rgw_gc_max_workers");
+  for (unsigned i = 0; i < num_workers; i++) {
+    auto& w = workers.emplace_back(std::make_unique<GCWorker>(this, cct, this, i));
+    w->create("rgw_gc");
+  }
 }
 
 void RGWGC::stop_processor()
 {
   down_flag = true;
-  if (worker) {
-    worker->stop();
-    worker->join();
+  for (auto& w : workers) {
+    w->stop();
+    w->join();
   }
-  delete worker;
-  worker = NULL;
+  workers.clear();
 }
 
 unsigned RGWGC::get_subsys() const
@@ -781,12 +827,14 @@ std::ostream& RGWGC::gen_prefix(std::ostream& out) const
 void *RGWGC::GCWorker::entry() {
   do {
     utime_t start = ceph_clock_now();
-    ldpp_dout(dpp, 2) << "garbage collection: start" << dendl;
-    int r = gc->process(true, null_yield);
-    if (r < 0) {
-      ldpp_dout(dpp, 0) << "ERROR: garbage collection process() returned error r=" << r << dendl;
+    if (ix == 0 || gc->backlog >= ix) {
+      ldpp_dout(dpp, 2) << "garbage collection: start worker=" << ix << dendl;
+      int r = gc->process(true, null_yield);
+      if (r < 0) {
+        ldpp_dout(dpp, 0) << "ERROR: garbage collection process() returned error r=" << r << dendl;
+      }
+      ldpp_dout(dpp, 2) << "garbage collection: stop worker=" << ix << dendl;
     }
-    ldpp_dout(dpp, 2) << "garbage collection: stop" << dendl;
 
     if (gc->going_down())
       break;
@@ -812,3 +860,9 @@ void RGWGC::GCWorker::stop()
   std::lock_guard l{lock};
   cond.notify_all();
 }
+
+void RGWGC::GCWorker::wakeup()
+{
+  std::lock_guard l{lock};
+  cond.notify_all();
+}
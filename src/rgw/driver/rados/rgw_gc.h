@@ -14,6 +14,8 @@
 #include "cls/rgw/cls_rgw_types.h"
 
 #include <atomic>
+#include <memory>
+#include <vector>
 
 class RGWGCIOManager;
 
@@ -29,27 +31,40 @@ class RGWGC : public DoutPrefixProvider {
   int tag_index(const std::string& tag);
   int send_chain(const cls_rgw_obj_chain& chain, const std::string& tag, optional_yield y);
 
+  /* worker 0 always runs; worker n only joins in while the last round
+   * left at least n shards unfinished */
   class GCWorker : public Thread {
     const DoutPrefixProvider *dpp;
     CephContext *cct;
     RGWGC *gc;
+    const unsigned ix;
     ceph::mutex lock = ceph::make_mutex("GCWorker");
     ceph::condition_variable cond;
 
   public:
-    GCWorker(const DoutPrefixProvider *_dpp, CephContext *_cct, RGWGC *_gc) : dpp(_dpp), cct(_cct), gc(_gc) {}
+    GCWorker(const DoutPrefixProvider *_dpp, CephContext *_cct, RGWGC *_gc,
+             unsigned _ix) : dpp(_dpp), cct(_cct), gc(_gc), ix(_ix) {}
     void *entry() override;
     void stop();
+    void wakeup();
   };
 
-  GCWorker *worker;
+  std::vector<std::unique_ptr<GCWorker>> workers;
+  /* shards claimed by a local worker */
+  std::unique_ptr<std::atomic<bool>[]> shard_busy;
+  /* number of shards the last round ran out of time on */
+  std::atomic<unsigned> backlog = { 0 };
+
+  int process_shard(int index, int max_secs, bool expired_only,
+                    RGWGCIOManager& io_manager, bool *unfinished,
+                    optional_yield y);
 public:
-  RGWGC() : cct(NULL), store(NULL), max_objs(0), obj_names(NULL), worker(NULL) {}
+  RGWGC() : cct(NULL), store(NULL), max_objs(0), obj_names(NULL) {}
   ~RGWGC() {
     stop_processor();
     finalize();
   }
-  std::vector<bool> transitioned_objects_cache;
+  std::unique_ptr<std::atomic<bool>[]> transitioned_objects_cache;
   std::tuple<int, std::optional<cls_rgw_obj_chain>> send_split_chain(const cls_rgw_obj_chain& chain, const std::string& tag, optional_yield y);
 
   // asynchronously defer garbage collection on an object that's still being read
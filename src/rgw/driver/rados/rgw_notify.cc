@@ -12,6 +12,7 @@
 #include <boost/asio/spawn.hpp>
 #include <boost/context/protected_fixedsize_stack.hpp>
 #include "include/function2.hpp"
+#include "common/async/completion.h"
 #include "rgw_sal_rados.h"
 #include "rgw_pubsub.h"
 #include "rgw_pubsub_push.h"
@@ -1016,6 +1017,199 @@ static inline bool notification_match(reservation_t& res,
   return true;
 }
 
+namespace {
+
+// coalesces the reservations that concurrent requests make on the same
+// persistent queue. while a reservation op is in flight on a queue, later
+// requests for it wait, and are sent together as a single
+// cls_2pc_queue_reserve_batch op once it completes
+class ReservationBatcher {
+  // this allows waiting until "finish()" is called from a different thread
+  // waiting could be blocking the waiting thread or yielding, depending
+  // whether the optional_yield is set
+  class Waiter {
+    using Signature = void(boost::system::error_code);
+    using Completion = ceph::async::Completion<Signature>;
+    std::unique_ptr<Completion> completion = nullptr;
+    int ret = 0;
+
+    bool done = false;
+    std::mutex lock;
+    std::condition_variable cond;
+
+  public:
+    int wait(optional_yield y) {
+      std::unique_lock l{lock};
+      if (done) {
+        return ret;
+      }
+      if (y) {
+        boost::system::error_code ec;
+        auto yield = y.get_yield_context();
+        auto&& token = yield[ec];
+        boost::asio::async_initiate<boost::asio::yield_context, Signature>(
+            [this, &l] (auto handler, auto ex) {
+              completion = Completion::create(ex, std::move(handler));
+              l.unlock(); // unlock before suspend
+            }, token, yield.get_executor());
+        return -ec.value();
+      }
+      cond.wait(l, [this]{return done;});
+      return ret;
+    }
+
+    void finish(int r) {
+      std::unique_lock l{lock};
+      ret = r;
+      done = true;
+      if (completion) {
+        boost::system::error_code ec(-ret, boost::system::system_category());
+        Completion::post(std::move(completion), ec);
+      } else {
+        cond.notify_all();
+      }
+    }
+  };
+
+  struct Request {
+    const uint64_t size;
+    cls_2pc_reservation::id_t res_id = cls_2pc_reservation::NO_ID;
+    Waiter waiter;
+
+    explicit Request(uint64_t size) : size(size) {}
+  };
+
+  struct Batch {
+    ReservationBatcher* const batcher;
+    librados::IoCtx ioctx;
+    const std::string queue_name;
+    std::vector<Request*> requests;
+    bufferlist obl;
+    int rval = 0;
+    librados::AioCompletion* completion = nullptr;
+
+    Batch(ReservationBatcher* batcher, librados::IoCtx& ioctx,
+          const std::string& queue_name, Request* request)
+      : batcher(batcher), ioctx(ioctx), queue_name(queue_name),
+        requests{request} {}
+  };
+
+  std::mutex lock;
+  // queues with a batch in flight, and the requests waiting for the next one
+  std::map<std::string, std::vector<Request*>> queues;
+  // cleared if the osds don't support cls_2pc_queue_reserve_batch yet
+  std::atomic<bool> supported = true;
+
+  static void send(std::unique_ptr<Batch> batch) {
+    std::vector<uint64_t> sizes;
+    sizes.reserve(batch->requests.size());
+    for (const auto* r : batch->requests) {
+      sizes.push_back(r->size);
+    }
+    librados::ObjectWriteOperation op;
+    batch->obl.clear();
+    cls_2pc_queue_reserve_batch(op, sizes, 1, &batch->obl, &batch->rval);
+    auto b = batch.release();
+    b->completion = librados::Rados::aio_create_completion(b, handle_completion);
+    const int ret = b->ioctx.aio_operate(b->queue_name, b->completion, &op,
+                                         librados::OPERATION_RETURNVEC);
+    if (ret < 0) {
+      b->completion->release();
+      b->completion = nullptr;
+      complete(std::unique_ptr<Batch>{b}, ret);
+    }
+  }
+
+  static void handle_completion(librados::completion_t, void* arg) {
+    std::unique_ptr<Batch> batch{static_cast<Batch*>(arg)};
+    const int ret = batch->completion->get_return_value();
+    batch->completion->release();
+    batch->completion = nullptr;
+    complete(std::move(batch), ret);
+  }
+
+  static void complete(std::unique_ptr<Batch> batch, int ret) {
+    std::vector<int> results;
+    std::vector<cls_2pc_reservation::id_t> res_ids;
+    if (ret == 0) {
+      ret = cls_2pc_queue_reserve_batch_result(batch->obl, results, res_ids);
+    }
+    if (ret == 0 && results.size() != batch->requests.size()) {
+      ret = -EIO;
+    }
+    for (size_t i = 0; i < batch->requests.size(); ++i) {
+      auto r = batch->requests[i];
+      if (ret < 0) {
+        r->waiter.finish(ret);
+      } else {
+        r->res_id = res_ids[i];
+        r->waiter.finish(results[i]);
+      }
+    }
+
+    // send the requests that arrived in the meantime
+    auto batcher = batch->batcher;
+    {
+      std::lock_guard l{batcher->lock};
+      auto i = batcher->queues.find(batch->queue_name);
+      ceph_assert(i != batcher->queues.end());
+      if (i->second.empty()) {
+        batcher->queues.erase(i);
+        return;
+      }
+      batch->requests = std::move(i->second);
+      i->second.clear();
+    }
+    send(std::move(batch));
+  }
+
+public:
+  // reserve size bytes for one entry on the queue
+  int reserve(const DoutPrefixProvider* dpp, librados::IoCtx& ioctx,
+              const std::string& queue_name, uint64_t size,
+              cls_2pc_reservation::id_t& res_id, optional_yield y) {
+    if (supported) {
+      Request req{size};
+      std::unique_ptr<Batch> batch;
+      {
+        std::lock_guard l{lock};
+        auto [i, inserted] = queues.try_emplace(queue_name);
+        if (inserted) {
+          batch = std::make_unique<Batch>(this, ioctx, queue_name, &req);
+        } else {
+          i->second.push_back(&req);
+        }
+      }
+      if (batch) {
+        send(std::move(batch));
+      }
+      const int ret = req.waiter.wait(y);
+      if (ret != -EOPNOTSUPP) {
+        res_id = req.res_id;
+        return ret;
+      }
+      ldpp_dout(dpp, 1) << "WARNING: batched reservations are not supported "
+          "by the osds, reserving one at a time" << dendl;
+      supported = false;
+    }
+
+    librados::ObjectWriteOperation op;
+    bufferlist obl;
+    int rval;
+    cls_2pc_queue_reserve(op, size, 1, &obl, &rval);
+    auto ret = rgw_rados_operate(dpp, ioctx, queue_name, &op, y,
+                                 librados::OPERATION_RETURNVEC);
+    if (ret < 0) {
+      return ret;
+    }
+    return cls_2pc_queue_reserve_result(obl, res_id);
+  }
+};
+
+ReservationBatcher reservation_batcher;
+
+} // anonymous namespace
+
 int publish_reserve(const DoutPrefixProvider* dpp,
                     const SiteConfig& site,
                     const EventTypeList& event_types,
@@ -1081,14 +1275,23 @@ int publish_reserve(const DoutPrefixProvider* dpp,
         // TODO: take default reservation size from conf
         constexpr auto DEFAULT_RESERVATION = 4 * 1024U;  // 4K
         res.size = DEFAULT_RESERVATION;
-        librados::ObjectWriteOperation op;
-        bufferlist obl;
-        int rval;
         const auto& queue_name = topic_cfg.dest.persistent_queue;
-        cls_2pc_queue_reserve(op, res.size, 1, &obl, &rval);
-        auto ret = rgw_rados_operate(
-            res.dpp, res.store->getRados()->get_notif_pool_ctx(), queue_name,
-            &op, res.yield, librados::OPERATION_RETURNVEC);
+        auto& ioctx = res.store->getRados()->get_notif_pool_ctx();
+        int ret;
+        if (res.dpp->get_cct()->_conf->rgw_topic_persistency_batch_reservations) {
+          ret = reservation_batcher.reserve(res.dpp, ioctx, queue_name,
+                                            res.size, res_id, res.yield);
+        } else {
+          librados::ObjectWriteOperation op;
+          bufferlist obl;
+          int rval;
+          cls_2pc_queue_reserve(op, res.size, 1, &obl, &rval);
+          ret = rgw_rados_operate(res.dpp, ioctx, queue_name, &op, res.yield,
+                                  librados::OPERATION_RETURNVEC);
+          if (ret == 0) {
+            ret = cls_2pc_queue_reserve_result(obl, res_id);
+          }
+        }
         if (ret < 0) {
           ldpp_dout(res.dpp, 1)
               << "ERROR: failed to reserve notification on queue: "
@@ -1096,13 +1299,6 @@ int publish_reserve(const DoutPrefixProvider* dpp,
           // if no space is left in queue we ask client to slow down
           return (ret == -ENOSPC) ? -ERR_RATE_LIMITED : ret;
         }
-        ret = cls_2pc_queue_reserve_result(obl, res_id);
-        if (ret < 0) {
-          ldpp_dout(res.dpp, 1)
-              << "ERROR: failed to parse reservation id. error: " << ret
-              << dendl;
-          return ret;
-        }
       }
 
       res.topics.emplace_back(topic_filter.s3_id, topic_cfg, res_id, event_type);
@@ -1027,6 +1027,9 @@ void RGWRados::finalize()
   if (svc.async_processor) {
     svc.async_processor->stop();
   }
+  if (svc.fetch_processor && svc.fetch_processor != svc.async_processor) {
+    svc.fetch_processor->stop();
+  }
 
   if (run_sync_thread) {
     std::lock_guard l{meta_sync_thread_lock};
@@ -3301,6 +3304,17 @@ int RGWRados::Object::Write::_do_write_meta(uint64_t size, uint64_t accounted_si
       /* ignoring error, nothing we can do at this point */
     }
   }
+
+  /* every head write goes through here, including sync, copy and bulk
+   * upload, so that the lifecycle time index sees all of them */
+  if (store->lc && !versioned_op && obj.key.ns.empty()) {
+    r = store->lc->add_time_index_hints(rctx.dpp, target->get_bucket_info(),
+                                        obj.key.name, meta.set_mtime, rctx.y);
+    if (r < 0) {
+      ldpp_dout(rctx.dpp, 1) << "WARNING: failed to add lifecycle time index entries for "
+                             << obj << ", r=" << r << dendl;
+    }
+  }
   meta.canceled = false;
 
   /* update quota cache */
@@ -5439,6 +5453,48 @@ int RGWRados::bucket_check_index(const DoutPrefixProvider *dpp, RGWBucketInfo& b
   return 0;
 }
 
+int RGWRados::bucket_prefix_stats(const DoutPrefixProvider *dpp, const RGWBucketInfo& bucket_info,
+                                  const std::string& prefix, const std::string& delimiter,
+                                  map<string, RGWStorageStats> *stats)
+{
+  librados::IoCtx index_pool;
+  map<int, string> oids;
+
+  int ret = svc.bi_rados->open_bucket_index(dpp, bucket_info, std::nullopt, bucket_info.layout.current_index, &index_pool, &oids, nullptr);
+  if (ret < 0) {
+    return ret;
+  }
+
+  // index entries carry the escaped key names
+  const string index_prefix = rgw_obj_key(prefix).get_index_key_name();
+  constexpr uint32_t max_entries = 10000;
+
+  map<string, rgw_bucket_category_stats> raw_stats;
+  for (const auto& [shard_id, oid] : oids) {
+    ret = cls_rgw_bucket_prefix_stats(index_pool, oid, index_prefix, delimiter,
+                                      max_entries, &raw_stats);
+    if (ret < 0) {
+      ldpp_dout(dpp, 0) << "ERROR: " << __func__ << ": prefix stats of bucket index shard "
+                        << oid << " returned " << cpp_strerror(-ret) << dendl;
+      return ret;
+    }
+  }
+
+  for (const auto& [group, raw] : raw_stats) {
+    string name = group;
+    if (name.size() > 1 && name[0] == '_' && name[1] == '_') {
+      name.erase(0, 1);
+    }
+    RGWStorageStats& s = (*stats)[name];
+    s.size += raw.total_size;
+    s.size_rounded += raw.total_size_rounded;
+    s.size_utilized += raw.actual_size;
+    s.num_objects += raw.num_entries;
+  }
+
+  return 0;
+}
+
 int RGWRados::bucket_rebuild_index(const DoutPrefixProvider *dpp, RGWBucketInfo& bucket_info)
 {
   librados::IoCtx index_pool;
@@ -7299,8 +7355,10 @@ int RGWRados::Object::Read::iterate(const DoutPrefixProvider *dpp, int64_t ofs,
   CephContext *cct = store->ctx();
   const uint64_t chunk_size = cct->_conf->rgw_get_obj_max_req_size;
   const uint64_t window_size = cct->_conf->rgw_get_obj_window_size;
+  const uint64_t max_window_size =
+    cct->_conf.get_val<Option::size_t>("rgw_get_obj_max_window_size");
 
-  auto aio = rgw::make_throttle(window_size, y);
+  auto aio = rgw::make_throttle(cct, window_size, max_window_size, y);
   get_obj_data data(store, cb, &*aio, ofs, y);
 
   int r = store->iterate_obj(dpp, source->get_ctx(), source->get_bucket_info(), state.obj,
@@ -9528,17 +9586,21 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     const std::string& oid_name;
     RGWRados::ent_map_t::iterator cursor;
     RGWRados::ent_map_t::iterator end;
+    // number of entries to request when the shard needs to be refilled
+    uint32_t batch;
 
     // manages an iterator through a shard and provides other
     // accessors
     ShardTracker(size_t _shard_idx,
 		 rgw_cls_list_ret& _result,
-		 const std::string& _oid_name):
+		 const std::string& _oid_name,
+		 uint32_t _batch):
       shard_idx(_shard_idx),
       result(_result),
       oid_name(_oid_name),
       cursor(_result.dir.m.begin()),
-      end(_result.dir.m.end())
+      end(_result.dir.m.end()),
+      batch(_batch)
     {}
 
     inline const std::string& entry_name() const {
@@ -9559,8 +9621,48 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     inline bool at_end() const {
       return cursor == end;
     }
+    // replace the consumed results with the next batch of the shard
+    void reset(rgw_cls_list_ret&& next) {
+      result = std::move(next);
+      cursor = result.dir.m.begin();
+      end = result.dir.m.end();
+    }
   }; // ShardTracker
 
+  // a shard whose results were all consumed but which has more
+  // entries is read again on demand, starting right after the entry
+  // just merged, rather than ending the page early; every refill of
+  // the same shard doubles its batch, as the shard evidently holds a
+  // large part of the range being listed
+  auto refill_shard = [&] (ShardTracker& t,
+			   const cls_rgw_obj_key& after,
+			   uint32_t max_entries) -> int {
+    const uint32_t batch = std::min(t.batch, max_entries);
+    t.batch = std::min(num_entries, t.batch * 2);
+
+    ldpp_dout(dpp, 20) << __func__ << ": refilling shard " << t.shard_idx <<
+      " after " << after << " with up to " << batch << " entries" << dendl;
+
+    std::map<int, std::string> oids{{int(t.shard_idx), t.oid_name}};
+    std::map<int, rgw_cls_list_ret> results;
+    int ret = CLSRGWIssueBucketList(ioctx, after, prefix, delimiter, batch,
+				    list_versions, oids, results, 1)();
+    if (ret < 0) {
+      ldpp_dout(dpp, 0) << __func__ << ": refilling shard " <<
+	t.shard_idx << " of " << bucket_info.bucket << " failed, r=" <<
+	ret << dendl;
+      return ret;
+    }
+
+    auto iter = results.find(t.shard_idx);
+    if (iter == results.end()) {
+      return -EIO;
+    }
+    *cls_filtered = *cls_filtered && iter->second.cls_filtered;
+    t.reset(std::move(iter->second));
+    return 0;
+  };
+
   // add the next unique candidate, or return false if we reach the end
   auto next_candidate = [] (CephContext *cct, ShardTracker& t,
                             std::multimap<std::string, size_t>& candidates,
@@ -9575,7 +9677,8 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
   std::vector<ShardTracker> results_trackers;
   results_trackers.reserve(shard_list_results.size());
   for (auto& r : shard_list_results) {
-    results_trackers.emplace_back(r.first, r.second, shard_oids[r.first]);
+    results_trackers.emplace_back(r.first, r.second, shard_oids[r.first],
+				  num_entries_per_shard);
 
     // if any *one* shard's result is truncated, the entire result is
     // truncated
@@ -9602,8 +9705,9 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     ++tracker_idx;
   }
 
-  rgw_bucket_dir_entry*
-    last_entry_visited = nullptr; // to set last_entry (marker)
+  // to set last_entry (marker); a copy, as the entry may belong to a
+  // shard result that is replaced by a refill
+  std::optional<cls_rgw_obj_key> last_entry_visited;
   std::map<std::string, bufferlist> updates;
   uint32_t count = 0;
   while (count < num_entries && !candidates.empty()) {
@@ -9649,6 +9753,7 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     }
 
     const cls_rgw_obj_key dirent_key = dirent.key;
+    const bool dirent_is_common_prefix = dirent.is_common_prefix();
 
     // at this point either r >= 0 or r == -ENOENT
     if (r >= 0) { // i.e., if r != -ENOENT
@@ -9656,7 +9761,7 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
 	dirent_key << dendl;
 
       auto [it, inserted] = m.insert_or_assign(name, std::move(dirent));
-      last_entry_visited = &it->second;
+      last_entry_visited = it->second.key;
       if (inserted) {
 	++count;
       } else {
@@ -9667,7 +9772,7 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     } else {
       ldpp_dout(dpp, 10) << __func__ << ": skipping " <<
 	dirent.key.name << "[" << dirent.key.instance << "]" << dendl;
-      last_entry_visited = &tracker.dir_entry();
+      last_entry_visited = dirent_key;
     }
 
     // refresh the candidates map
@@ -9681,6 +9786,19 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     for (auto idx : vidx) {
       auto& tracker_match = results_trackers.at(idx);
       tracker_match.advance();
+      if (tracker_match.at_end() && tracker_match.is_truncated() &&
+	  count < num_entries) {
+	// everything up to and including dirent_key has been merged;
+	// skip over the rest of a common prefix
+	r = refill_shard(tracker_match,
+			 (dirent_is_common_prefix ?
+			  cls_rgw_obj_key(cls_rgw_after_delim(dirent_key.name)) :
+			  dirent_key),
+			 num_entries - count);
+	if (r < 0) {
+	  return r;
+	}
+      }
       next_candidate(cct, tracker_match, candidates, idx);
       if (tracker_match.at_end() && tracker_match.is_truncated()) {
         need_to_stop = true;
@@ -9736,8 +9854,8 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
       count << ", which is truncated" << dendl;
   }
 
-  if (last_entry_visited != nullptr && last_entry) {
-    *last_entry = last_entry_visited->key;
+  if (last_entry_visited && last_entry) {
+    *last_entry = *last_entry_visited;
     ldpp_dout(dpp, 20) << __func__ <<
       ": returning, last_entry=" << *last_entry << dendl;
   } else {
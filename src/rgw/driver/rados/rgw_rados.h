@@ -1558,6 +1558,11 @@ public:
                          std::map<RGWObjCategory, RGWStorageStats> *existing_stats,
                          std::map<RGWObjCategory, RGWStorageStats> *calculated_stats);
   int bucket_rebuild_index(const DoutPrefixProvider *dpp, RGWBucketInfo& bucket_info);
+  /// aggregate the stats of the objects under prefix, grouped by the next
+  /// delimiter, without listing them
+  int bucket_prefix_stats(const DoutPrefixProvider *dpp, const RGWBucketInfo& bucket_info,
+                          const std::string& prefix, const std::string& delimiter,
+                          std::map<std::string, RGWStorageStats> *stats);
 
   // Search the bucket for encrypted multipart uploads, and increase their mtime
   // slightly to generate a bilog entry to trigger a resync to repair any
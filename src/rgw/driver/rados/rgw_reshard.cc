@@ -335,6 +335,86 @@ public:
   }
 }; // class BucketReshardManager
 
+// reads the index entries of a source shard batch by batch; the next
+// batch is requested as soon as the current one arrives, so reading
+// overlaps with copying the entries to the target shards
+class BucketReshardSourceShard {
+  RGWRados::BucketShard bs;
+  const uint32_t max_entries;
+  std::string marker;
+  librados::AioCompletion *c = nullptr;
+  rgw_cls_bi_list_ret result;
+  int result_ret = 0;
+  int issue_ret = 0; ///< error of a batch that could not be requested
+
+  int issue() {
+    ceph_assert(c == nullptr);
+    result = rgw_cls_bi_list_ret();
+    result_ret = 0;
+
+    librados::ObjectReadOperation op;
+    const std::string null_object_filter;
+    cls_rgw_bi_list(op, null_object_filter, marker, max_entries, &result,
+                    &result_ret);
+    c = librados::Rados::aio_create_completion(nullptr, nullptr);
+    int ret = bs.bucket_obj.aio_operate(c, &op, nullptr);
+    if (ret < 0) {
+      c->release();
+      c = nullptr;
+    }
+    return ret;
+  }
+
+public:
+  BucketReshardSourceShard(RGWRados *store, uint32_t max_entries)
+    : bs(store), max_entries(max_entries) {}
+
+  ~BucketReshardSourceShard() {
+    if (c) {
+      c->wait_for_complete();
+      c->release();
+    }
+  }
+
+  // request the first batch; errors are returned by next()
+  void start(const DoutPrefixProvider *dpp, const RGWBucketInfo& bucket_info,
+             const rgw::bucket_index_layout_generation& index, int shard_id,
+             optional_yield y) {
+    issue_ret = bs.init(dpp, bucket_info, index, shard_id, y);
+    if (issue_ret < 0) {
+      ldpp_dout(dpp, 5) << "bs.init() returned ret=" << issue_ret << dendl;
+      return;
+    }
+    issue_ret = issue();
+  }
+
+  // wait for the batch in flight and request the one after it
+  int next(std::list<rgw_cls_bi_entry> *entries, bool *is_truncated) {
+    *is_truncated = false;
+    if (c == nullptr) {
+      return issue_ret;
+    }
+    c->wait_for_complete();
+    int ret = c->get_return_value();
+    c->release();
+    c = nullptr;
+    if (ret >= 0) {
+      ret = result_ret;
+    }
+    if (ret < 0) {
+      return ret;
+    }
+
+    entries->swap(result.entries);
+    *is_truncated = result.is_truncated && !entries->empty();
+    if (*is_truncated) {
+      marker = entries->back().idx;
+      issue_ret = issue();
+    }
+    return 0;
+  }
+}; // class BucketReshardSourceShard
+
 RGWBucketReshard::RGWBucketReshard(rgw::sal::RadosStore* _store,
 				   const RGWBucketInfo& _bucket_info,
 				   const std::map<std::string, bufferlist>& _bucket_attrs,
@@ -918,14 +998,31 @@ int RGWBucketReshard::do_reshard(const rgw::bucket_index_layout_generation& curr
   }
 
   const uint32_t num_source_shards = rgw::num_shards(current.layout.normal);
+  const uint32_t read_ahead = std::min<uint32_t>(
+    num_source_shards,
+    store->ctx()->_conf.get_val<uint64_t>("rgw_reshard_read_ahead"));
+
+  // the first batches of the next read_ahead source shards are always in
+  // flight
+  std::vector<std::unique_ptr<BucketReshardSourceShard>> source_shards(
+    num_source_shards);
+  auto start_source_shard = [&] (uint32_t shard_id) {
+    auto& shard = source_shards[shard_id];
+    shard = std::make_unique<BucketReshardSourceShard>(store->getRados(),
+                                                       max_entries);
+    shard->start(dpp, bucket_info, current, shard_id, y);
+  };
+  for (uint32_t i = 0; i < read_ahead; ++i) {
+    start_source_shard(i);
+  }
+
   string marker;
   for (uint32_t i = 0; i < num_source_shards; ++i) {
     bool is_truncated = true;
     marker.clear();
-    const std::string null_object_filter; // empty string since we're not filtering by object
     while (is_truncated) {
       entries.clear();
-      int ret = store->getRados()->bi_list(dpp, bucket_info, i, null_object_filter, marker, max_entries, &entries, &is_truncated, y);
+      int ret = source_shards[i]->next(&entries, &is_truncated);
       if (ret == -ENOENT) {
         ldpp_dout(dpp, 1) << "WARNING: " << __func__ << " failed to find shard "
             << i << ", skipping" << dendl;
@@ -1007,6 +1104,11 @@ int RGWBucketReshard::do_reshard(const rgw::bucket_index_layout_generation& curr
 	}
       } // entries loop
     }
+
+    source_shards[i].reset();
+    if (i + read_ahead < num_source_shards) {
+      start_source_shard(i + read_ahead);
+    }
   }
 
   if (verbose_json_out) {
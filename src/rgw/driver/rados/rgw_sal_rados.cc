@@ -68,6 +68,7 @@
 #include "services/svc_user.h"
 #include "services/svc_sys_obj_cache.h"
 #include "cls/rgw/cls_rgw_client.h"
+#include "cls/timeindex/cls_timeindex_client.h"
 
 #include "account.h"
 #include "buckets.h"
@@ -2206,7 +2207,8 @@ std::unique_ptr<Writer> RadosStore::get_append_writer(const DoutPrefixProvider *
 {
   RGWBucketInfo& bucket_info = obj->get_bucket()->get_info();
   RGWObjectCtx& obj_ctx = static_cast<RadosObject*>(obj)->get_ctx();
-  auto aio = rgw::make_throttle(ctx()->_conf->rgw_put_obj_min_window_size, y);
+  auto aio = rgw::make_throttle(ctx(), ctx()->_conf->rgw_put_obj_min_window_size,
+				 ctx()->_conf->rgw_put_obj_max_window_size, y);
   return std::make_unique<RadosAppendWriter>(dpp, y,
 				 bucket_info, obj_ctx, obj->get_obj(),
 				 this, std::move(aio), owner,
@@ -2225,7 +2227,8 @@ std::unique_ptr<Writer> RadosStore::get_atomic_writer(const DoutPrefixProvider *
 {
   RGWBucketInfo& bucket_info = obj->get_bucket()->get_info();
   RGWObjectCtx& obj_ctx = static_cast<RadosObject*>(obj)->get_ctx();
-  auto aio = rgw::make_throttle(ctx()->_conf->rgw_put_obj_min_window_size, y);
+  auto aio = rgw::make_throttle(ctx(), ctx()->_conf->rgw_put_obj_min_window_size,
+				 ctx()->_conf->rgw_put_obj_max_window_size, y);
   return std::make_unique<RadosAtomicWriter>(dpp, y,
 				 bucket_info, obj_ctx, obj->get_obj(),
 				 this, std::move(aio), owner,
@@ -2925,12 +2928,11 @@ int RadosObject::swift_versioning_copy(const ACLOwner& owner, const rgw_user& re
                                         y);
 }
 
-int RadosMultipartUpload::cleanup_part_history(const DoutPrefixProvider* dpp,
-                                               optional_yield y,
-                                               RadosMultipartPart *part,
-                                               list<rgw_obj_index_key>& remove_objs)
+void RadosMultipartUpload::cleanup_part_history(const DoutPrefixProvider* dpp,
+                                                RadosMultipartPart *part,
+                                                list<rgw_obj_index_key>& remove_objs,
+                                                cls_rgw_obj_chain& chain)
 {
-  cls_rgw_obj_chain chain;
   for (auto& ppfx : part->get_past_prefixes()) {
     rgw_obj past_obj;
     past_obj.init_ns(bucket->get_key(), ppfx + "." + std::to_string(part->info.num), mp_ns);
@@ -2948,6 +2950,12 @@ int RadosMultipartUpload::cleanup_part_history(const DoutPrefixProvider* dpp,
       chain.push_obj(raw_part_obj.pool.to_str(), part_key, raw_part_obj.loc);
     }
   }
+}
+
+int RadosMultipartUpload::send_chain(const DoutPrefixProvider* dpp,
+                                     optional_yield y,
+                                     cls_rgw_obj_chain& chain)
+{
   if (store->getRados()->get_gc() == nullptr) {
     // Delete objects inline if gc hasn't been initialised (in case when bypass gc is specified)
     store->getRados()->delete_objs_inline(dpp, chain, mp_obj.get_upload_id());
@@ -3011,27 +3019,16 @@ int RadosMultipartUpload::abort(const DoutPrefixProvider *dpp, CephContext *cct,
           head->get_key().get_index_key(&key);
           remove_objs.push_back(key);
 
-          cleanup_part_history(dpp, null_yield, obj_part, remove_objs);
+          cleanup_part_history(dpp, obj_part, remove_objs, chain);
         }
       }
       parts_accounted_size += obj_part->info.accounted_size;
     }
   } while (truncated);
 
-  if (store->getRados()->get_gc() == nullptr) {
-    //Delete objects inline if gc hasn't been initialised (in case when bypass gc is specified)
-    store->getRados()->delete_objs_inline(dpp, chain, mp_obj.get_upload_id());
-  } else {
-    /* use upload id as tag and do it synchronously */
-    auto [ret, leftover_chain] = store->getRados()->send_chain_to_gc(chain, mp_obj.get_upload_id(), y);
-    if (ret < 0 && leftover_chain) {
-      ldpp_dout(dpp, 5) << __func__ << ": gc->send_chain() returned " << ret << dendl;
-      if (ret == -ENOENT) {
-        return -ERR_NO_SUCH_UPLOAD;
-      }
-      //Delete objects inline if send chain to gc fails
-      store->getRados()->delete_objs_inline(dpp, *leftover_chain, mp_obj.get_upload_id());
-    }
+  ret = send_chain(dpp, y, chain);
+  if (ret < 0) {
+    return ret;
   }
 
   std::unique_ptr<rgw::sal::Object::DeleteOp> del_op = meta_obj->get_delete_op();
@@ -3221,6 +3218,88 @@ int RadosMultipartUpload::list_parts(const DoutPrefixProvider *dpp, CephContext
   return 0;
 }
 
+int RadosMultipartUpload::list_all_parts(const DoutPrefixProvider *dpp, CephContext *cct,
+                                         uint32_t num_parts, bool *more,
+                                         optional_yield y)
+{
+  constexpr uint32_t parts_per_read = 1000;
+
+  if (!is_v2_upload_id(get_upload_id()) || num_parts <= parts_per_read) {
+    return list_parts(dpp, cct, num_parts, 0, nullptr, more, y);
+  }
+
+  rgw_obj_key key(get_meta(), std::string(), RGW_OBJ_NS_MULTIPART);
+  rgw_obj obj(bucket->get_key(), key);
+  obj.in_extra_data = true;
+
+  rgw_raw_obj raw_obj;
+  store->getRados()->obj_to_raw(bucket->get_placement_rule(), obj, &raw_obj);
+  rgw_rados_ref ref;
+  int ret = store->getRados()->get_raw_obj_ref(dpp, raw_obj, &ref);
+  if (ret < 0) {
+    return ret;
+  }
+
+  /* the omap keys of a v2 upload sort by part number, so each range of
+   * part numbers can be read on its own, and all of them concurrently;
+   * the last range reads one more entry to detect any parts beyond
+   * num_parts */
+  const uint32_t num_reads = (num_parts + parts_per_read - 1) / parts_per_read;
+  std::vector<std::map<std::string, bufferlist>> part_maps(num_reads);
+  std::vector<int> rvals(num_reads, 0);
+  auto aio = rgw::make_throttle(cct->_conf->rgw_multipart_part_read_concurrency, y);
+  for (uint32_t i = 0; i < num_reads; ++i) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "part.%08u", i * parts_per_read);
+    const uint32_t count = parts_per_read + (i + 1 == num_reads ? 1 : 0);
+
+    librados::ObjectReadOperation op;
+    op.omap_get_vals2(buf, count, &part_maps[i], nullptr, &rvals[i]);
+    static constexpr uint64_t cost = 1;
+    auto completed = aio->get(ref.obj, rgw::Aio::librados_op(ref.ioctx, std::move(op), y),
+                              cost, i);
+    ret = rgw::check_for_errors(completed);
+    if (ret < 0) {
+      aio->drain();
+      return ret;
+    }
+  }
+  ret = rgw::check_for_errors(aio->drain());
+  if (ret < 0) {
+    return ret;
+  }
+
+  parts.clear();
+  uint32_t expected_next = 1;
+  *more = false;
+  for (auto& part_map : part_maps) {
+    for (auto& [k, bl] : part_map) {
+      auto bli = bl.cbegin();
+      std::unique_ptr<RadosMultipartPart> part = std::make_unique<RadosMultipartPart>();
+      try {
+        decode(part->info, bli);
+      } catch (buffer::error& err) {
+        ldpp_dout(dpp, 0) << "ERROR: could not part info, caught buffer::error" <<
+          dendl;
+        return -EIO;
+      }
+      if (part->info.num != expected_next) {
+        /* the parts aren't numbered contiguously (or a gateway wrote them
+         * unsorted), so the ranges don't line up; read them all at once */
+        return list_parts(dpp, cct, num_parts, 0, nullptr, more, y, true);
+      }
+      if (part->info.num > num_parts) {
+        *more = true;
+        break;
+      }
+      ++expected_next;
+      parts[part->info.num] = std::move(part);
+    }
+  }
+
+  return 0;
+}
+
 int RadosMultipartUpload::complete(const DoutPrefixProvider *dpp,
 				   optional_yield y, CephContext* cct,
 				   map<int, string>& part_etags,
@@ -3243,14 +3322,13 @@ int RadosMultipartUpload::complete(const DoutPrefixProvider *dpp,
 
   int total_parts = 0;
   int handled_parts = 0;
-  int max_parts = 1000;
-  int marker = 0;
   uint64_t min_part_size = cct->_conf->rgw_multipart_min_part_size;
   auto etags_iter = part_etags.begin();
   rgw::sal::Attrs& attrs = target_obj->get_attrs();
+  cls_rgw_obj_chain history_chain;
 
-  do {
-    ret = list_parts(dpp, cct, max_parts, marker, &marker, &truncated, y);
+  {
+    ret = list_all_parts(dpp, cct, part_etags.size(), &truncated, y);
     if (ret == -ENOENT) {
       ret = -ERR_NO_SUCH_UPLOAD;
     }
@@ -3258,7 +3336,7 @@ int RadosMultipartUpload::complete(const DoutPrefixProvider *dpp,
       return ret;
 
     total_parts += parts.size();
-    if (!truncated && total_parts != (int)part_etags.size()) {
+    if (truncated || total_parts != (int)part_etags.size()) {
       ldpp_dout(dpp, 0) << "NOTICE: total parts mismatch: have: " << total_parts
 		       << " expected: " << part_etags.size() << dendl;
       ret = -ERR_INVALID_PART;
@@ -3350,12 +3428,12 @@ int RadosMultipartUpload::complete(const DoutPrefixProvider *dpp,
 
       remove_objs.push_back(remove_key);
 
-      cleanup_part_history(dpp, y, part, remove_objs);
+      cleanup_part_history(dpp, part, remove_objs, history_chain);
 
       ofs += obj_part.size;
       accounted_size += obj_part.accounted_size;
     }
-  } while (truncated);
+  }
   hash.Final((unsigned char *)final_etag);
 
   buf_to_hex((unsigned char *)final_etag, sizeof(final_etag), final_etag_str);
@@ -3416,7 +3494,15 @@ int RadosMultipartUpload::complete(const DoutPrefixProvider *dpp,
   if (ret < 0)
     return ret;
 
-  return ret;
+  /* the tails of parts that were uploaded more than once are garbage now
+   * that the object is committed; hand them all to gc at once */
+  ret = send_chain(dpp, y, history_chain);
+  if (ret < 0) {
+    ldpp_dout(dpp, 5) << __func__ << ": failed to clean up replaced parts: "
+                      << cpp_strerror(-ret) << dendl;
+  }
+
+  return 0;
 }
 
 int RadosMultipartUpload::get_info(const DoutPrefixProvider *dpp, optional_yield y, rgw_placement_rule** rule, rgw::sal::Attrs* attrs)
@@ -3507,7 +3593,9 @@ std::unique_ptr<Writer> RadosMultipartUpload::get_writer(
 {
   RGWBucketInfo& bucket_info = obj->get_bucket()->get_info();
   RGWObjectCtx& obj_ctx = static_cast<RadosObject*>(obj)->get_ctx();
-  auto aio = rgw::make_throttle(store->ctx()->_conf->rgw_put_obj_min_window_size, y);
+  auto aio = rgw::make_throttle(store->ctx(),
+				 store->ctx()->_conf->rgw_put_obj_min_window_size,
+				 store->ctx()->_conf->rgw_put_obj_max_window_size, y);
   return std::make_unique<RadosMultipartWriter>(dpp, y, get_upload_id(),
 				 bucket_info, obj_ctx,
 				 obj->get_obj(), store, std::move(aio), owner,
@@ -3664,6 +3752,78 @@ std::unique_ptr<LCSerializer> RadosLifecycle::get_serializer(const std::string&
   return std::make_unique<LCRadosSerializer>(store, oid, lock_name, cookie);
 }
 
+int RadosLifecycle::add_time_index_entries(const DoutPrefixProvider* dpp,
+					   const std::string& oid,
+					   const std::vector<LCTimeIndexEntry>& entries,
+					   optional_yield y)
+{
+  std::list<cls_timeindex_entry> cls_entries;
+  bufferlist empty;
+  for (const auto& e : entries) {
+    auto& ce = cls_entries.emplace_back();
+    cls_timeindex_add_prepare_entry(ce, utime_t(e.due), e.key, empty);
+  }
+
+  librados::ObjectWriteOperation op;
+  cls_timeindex_add(op, cls_entries);
+  return rgw_rados_operate(dpp, *store->getRados()->get_lc_pool_ctx(), oid,
+			   &op, y);
+}
+
+int RadosLifecycle::list_time_index(const DoutPrefixProvider* dpp,
+				    const std::string& oid,
+				    const ceph::real_time& end,
+				    const std::string& marker,
+				    uint32_t max_entries,
+				    std::vector<LCTimeIndexEntry>& entries,
+				    std::string* out_marker, bool* truncated,
+				    optional_yield y)
+{
+  entries.clear();
+
+  std::list<cls_timeindex_entry> cls_entries;
+  librados::ObjectReadOperation op;
+  cls_timeindex_list(op, utime_t(), utime_t(end), marker, max_entries,
+		     cls_entries, out_marker, truncated);
+  bufferlist obl;
+  int ret = rgw_rados_operate(dpp, *store->getRados()->get_lc_pool_ctx(), oid,
+			      &op, &obl, y);
+  if (ret == -ENOENT) {
+    *truncated = false;
+    return 0;
+  }
+  if (ret < 0) {
+    return ret;
+  }
+
+  entries.reserve(cls_entries.size());
+  for (auto& ce : cls_entries) {
+    entries.push_back({ce.key_ts.to_real_time(), std::move(ce.key_ext)});
+  }
+  return 0;
+}
+
+int RadosLifecycle::trim_time_index(const DoutPrefixProvider* dpp,
+				    const std::string& oid,
+				    const std::string& to_marker,
+				    optional_yield y)
+{
+  /* each call removes a bounded number of entries; -ENODATA once there
+   * is nothing left to remove */
+  for (;;) {
+    librados::ObjectWriteOperation op;
+    cls_timeindex_trim(op, utime_t(), utime_t(), std::string(), to_marker);
+    int ret = rgw_rados_operate(dpp, *store->getRados()->get_lc_pool_ctx(),
+				oid, &op, y);
+    if (ret == -ENODATA || ret == -ENOENT) {
+      return 0;
+    }
+    if (ret < 0) {
+      return ret;
+    }
+  }
+}
+
 int RadosNotification::publish_reserve(const DoutPrefixProvider *dpp, RGWObjTags* obj_tags)
 {
   return rgw::notify::publish_reserve(dpp, *store->svc()->site, event_types, res, obj_tags);
@@ -828,10 +828,17 @@ public:
 			  uint64_t part_num,
 			  const std::string& part_num_str) override;
 protected:
-  int cleanup_part_history(const DoutPrefixProvider* dpp,
-                           optional_yield y,
-                           RadosMultipartPart* part,
-                           std::list<rgw_obj_index_key>& remove_objs);
+  /// read every part of the upload, up to num_parts, for completion;
+  /// *more is set if there are parts beyond num_parts
+  int list_all_parts(const DoutPrefixProvider* dpp, CephContext* cct,
+                     uint32_t num_parts, bool* more, optional_yield y);
+  /// add the objects of a part's past uploads to remove_objs and chain
+  void cleanup_part_history(const DoutPrefixProvider* dpp,
+                            RadosMultipartPart* part,
+                            std::list<rgw_obj_index_key>& remove_objs,
+                            cls_rgw_obj_chain& chain);
+  int send_chain(const DoutPrefixProvider* dpp, optional_yield y,
+                 cls_rgw_obj_chain& chain);
 };
 
 class MPRadosSerializer : public StoreMPSerializer {
@@ -880,6 +887,21 @@ public:
   virtual std::unique_ptr<LCSerializer> get_serializer(const std::string& lock_name,
 						       const std::string& oid,
 						       const std::string& cookie) override;
+  virtual int add_time_index_entries(const DoutPrefixProvider* dpp,
+				     const std::string& oid,
+				     const std::vector<LCTimeIndexEntry>& entries,
+				     optional_yield y) override;
+  virtual int list_time_index(const DoutPrefixProvider* dpp,
+			      const std::string& oid,
+			      const ceph::real_time& end,
+			      const std::string& marker, uint32_t max_entries,
+			      std::vector<LCTimeIndexEntry>& entries,
+			      std::string* out_marker, bool* truncated,
+			      optional_yield y) override;
+  virtual int trim_time_index(const DoutPrefixProvider* dpp,
+			      const std::string& oid,
+			      const std::string& to_marker,
+			      optional_yield y) override;
 };
 
 class RadosNotification : public StoreNotification {
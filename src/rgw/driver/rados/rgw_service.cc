@@ -84,6 +84,12 @@ int RGWServices_Def::init(CephContext *cct,
   role_rados = std::make_unique<RGWSI_Role_RADOS>(cct);
   async_processor = std::make_unique<RGWAsyncRadosProcessor>(
     cct, cct->_conf->rgw_num_async_rados_threads);
+  if (const auto fetch_threads =
+        cct->_conf.get_val<uint64_t>("rgw_data_sync_fetch_threads");
+      run_sync && fetch_threads > 0) {
+    fetch_processor = std::make_unique<RGWAsyncRadosProcessor>(
+      cct, fetch_threads);
+  }
 
   if (have_cache) {
     sysobj_cache = std::make_unique<RGWSI_SysObj_Cache>(dpp, cct);
@@ -92,6 +98,9 @@ int RGWServices_Def::init(CephContext *cct,
   vector<RGWSI_MetaBackend *> meta_bes{meta_be_sobj.get(), meta_be_otp.get()};
 
   async_processor->start();
+  if (fetch_processor) {
+    fetch_processor->start();
+  }
   finisher->init();
   bi_rados->init(zone.get(), driver->getRados()->get_rados_handle(),
 		 bilog_rados.get(), datalog_rados.get());
@@ -303,6 +312,9 @@ void RGWServices_Def::shutdown()
   zone_utils->shutdown();
   zone->shutdown();
   async_processor->stop();
+  if (fetch_processor) {
+    fetch_processor->stop();
+  }
 
   has_shutdown = true;
 }
@@ -345,6 +357,8 @@ int RGWServices::do_init(CephContext *_cct, rgw::sal::RadosStore* driver, bool h
   user = _svc.user_rados.get();
   role = _svc.role_rados.get();
   async_processor = _svc.async_processor.get();
+  fetch_processor = _svc.fetch_processor ?
+    _svc.fetch_processor.get() : async_processor;
 
   return 0;
 }
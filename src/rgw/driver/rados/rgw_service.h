@@ -110,6 +110,7 @@ struct RGWServices_Def
   std::unique_ptr<RGWDataChangesLog> datalog_rados;
   std::unique_ptr<RGWSI_Role_RADOS> role_rados;
   std::unique_ptr<RGWAsyncRadosProcessor> async_processor;
+  std::unique_ptr<RGWAsyncRadosProcessor> fetch_processor;
 
   RGWServices_Def();
   ~RGWServices_Def();
@@ -157,6 +158,8 @@ struct RGWServices
   RGWSI_User *user{nullptr};
   RGWSI_Role_RADOS *role{nullptr};
   RGWAsyncRadosProcessor* async_processor;
+  /* runs data sync object fetches; async_processor unless configured */
+  RGWAsyncRadosProcessor* fetch_processor{nullptr};
 
   int do_init(CephContext *cct, rgw::sal::RadosStore* store, bool have_cache,
 	      bool raw_storage, bool run_sync, optional_yield y,
@@ -171,6 +171,7 @@ void usage()
   cout << "  bucket check                     check bucket index by verifying size and object count stats\n";
   cout << "  bucket check olh                 check for olh index entries and objects that are pending removal\n";
   cout << "  bucket check unlinked            check for object versions that are not visible in a bucket listing \n";
+  cout << "  bucket prefix stats              show object count and size under --prefix, grouped by --delimiter\n";
   cout << "  bucket chown                     link bucket to specified user and update its object ACLs\n";
   cout << "  bucket reshard                   reshard bucket\n";
   cout << "  bucket rewrite                   rewrite all objects in the specified bucket\n";
@@ -686,6 +687,7 @@ enum class OPT {
   BUCKET_CHECK,
   BUCKET_CHECK_OLH,
   BUCKET_CHECK_UNLINKED,
+  BUCKET_PREFIX_STATS,
   BUCKET_SYNC_CHECKPOINT,
   BUCKET_SYNC_INFO,
   BUCKET_SYNC_STATUS,
@@ -919,6 +921,7 @@ static SimpleCmd::Commands all_cmds = {
   { "bucket check", OPT::BUCKET_CHECK },
   { "bucket check olh", OPT::BUCKET_CHECK_OLH },
   { "bucket check unlinked", OPT::BUCKET_CHECK_UNLINKED },
+  { "bucket prefix stats", OPT::BUCKET_PREFIX_STATS },
   { "bucket sync checkpoint", OPT::BUCKET_SYNC_CHECKPOINT },
   { "bucket sync info", OPT::BUCKET_SYNC_INFO },
   { "bucket sync status", OPT::BUCKET_SYNC_STATUS },
@@ -3588,6 +3591,7 @@ int main(int argc, const char **argv)
   std::optional<rgw_zone_id> opt_effective_zone_id;
 
   std::optional<string> opt_prefix;
+  std::optional<string> opt_delimiter;
   std::optional<string> opt_prefix_rm;
 
   std::optional<int> opt_priority;
@@ -4117,6 +4121,8 @@ int main(int argc, const char **argv)
       opt_effective_zone_id = rgw_zone_id(val);
     } else if (ceph_argparse_witharg(args, i, &val, "--prefix", (char*)NULL)) {
       opt_prefix = val;
+    } else if (ceph_argparse_witharg(args, i, &val, "--delimiter", (char*)NULL)) {
+      opt_delimiter = val;
     } else if (ceph_argparse_witharg(args, i, &val, "--prefix-rm", (char*)NULL)) {
       opt_prefix_rm = val;
     } else if (ceph_argparse_witharg(args, i, &val, "--priority", (char*)NULL)) {
@@ -4269,6 +4275,7 @@ int main(int argc, const char **argv)
 			 OPT::BUCKET_LIMIT_CHECK,
 			 OPT::BUCKET_LAYOUT,
 			 OPT::BUCKET_STATS,
+			 OPT::BUCKET_PREFIX_STATS,
 			 OPT::BUCKET_SYNC_CHECKPOINT,
 			 OPT::BUCKET_SYNC_INFO,
 			 OPT::BUCKET_SYNC_STATUS,
@@ -8737,6 +8744,48 @@ next:
     RGWBucketAdminOp::check_index_olh(store, bucket_op, stream_flusher, dpp());
   }
 
+  if (opt_cmd == OPT::BUCKET_PREFIX_STATS) {
+    rgw::sal::RadosStore* store = dynamic_cast<rgw::sal::RadosStore*>(driver);
+    if (!store) {
+      cerr <<
+	      "WARNING: this command is only relevant when the cluster has a RADOS backing store." <<
+	      std::endl;
+      return 0;
+    }
+    if (bucket_name.empty()) {
+      cerr << "ERROR: bucket not specified" << std::endl;
+      return EINVAL;
+    }
+    int ret = init_bucket(tenant, bucket_name, bucket_id, &bucket);
+    if (ret < 0) {
+      return -ret;
+    }
+    const string prefix = opt_prefix.value_or("");
+    const string delimiter = opt_delimiter.value_or("");
+    map<string, RGWStorageStats> stats;
+    ret = store->getRados()->bucket_prefix_stats(dpp(), bucket->get_info(),
+                                                 prefix, delimiter, &stats);
+    if (ret < 0) {
+      cerr << "ERROR: failed to get prefix stats: " << cpp_strerror(-ret) << std::endl;
+      return -ret;
+    }
+
+    formatter->open_object_section("prefix_stats");
+    encode_json("bucket", bucket->get_name(), formatter.get());
+    encode_json("prefix", prefix, formatter.get());
+    encode_json("delimiter", delimiter, formatter.get());
+    formatter->open_array_section("prefixes");
+    for (auto& [name, s] : stats) {
+      formatter->open_object_section("entry");
+      encode_json("prefix", name, formatter.get());
+      s.dump(formatter.get());
+      formatter->close_section();
+    }
+    formatter->close_section(); // prefixes
+    formatter->close_section(); // prefix_stats
+    formatter->flush(cout);
+  }
+
   if (opt_cmd == OPT::BUCKET_CHECK_UNLINKED) {
     rgw::sal::RadosStore* store = dynamic_cast<rgw::sal::RadosStore*>(driver);
     if (!store) {
@@ -14,9 +14,44 @@
  */
 
 #include "rgw_aio_throttle.h"
+#include "common/ceph_context.h"
 
 namespace rgw {
 
+bool AioWindowBudget::try_reserve(uint64_t bytes)
+{
+  auto cur = reserved.load();
+  do {
+    if (cur + bytes > limit) {
+      return false;
+    }
+  } while (!reserved.compare_exchange_weak(cur, cur + bytes));
+  return true;
+}
+
+void Throttle::adapt_window(ceph::timespan latency, uint64_t cost)
+{
+  lat_min = std::min(lat_min, latency);
+  if (lat_avg == ceph::timespan::zero()) {
+    lat_avg = latency;
+  } else {
+    lat_avg = (lat_avg * 7 + latency) / 8;
+  }
+
+  if (lat_avg > lat_min * 2) {
+    // rados is queueing our requests, back off
+    const uint64_t shrunk = std::max(min_window, window - window / 4);
+    budget->release(window - shrunk);
+    window = shrunk;
+  } else if (limited && window < max_window) {
+    const uint64_t grow = std::min(cost, max_window - window);
+    if (budget->try_reserve(grow)) {
+      window += grow;
+    }
+  }
+  limited = false;
+}
+
 bool Throttle::waiter_ready() const
 {
   switch (waiter) {
@@ -45,6 +80,7 @@ AioResultList BlockingAioThrottle::get(rgw_raw_obj obj,
     pending_size += p->cost;
     if (!is_available()) {
       ceph_assert(waiter == Wait::None);
+      limited = true;
       waiter = Wait::Available;
       cond.wait(lock, [this] { return is_available(); });
       waiter = Wait::None;
@@ -52,6 +88,9 @@ AioResultList BlockingAioThrottle::get(rgw_raw_obj obj,
 
     // register the pending write and attach a completion
     p->parent = this;
+    if (is_adaptive()) {
+      p->start = ceph::mono_clock::now();
+    }
     pending.push_back(*p);
     lock.unlock();
     std::move(f)(this, *static_cast<AioResult*>(p.get()));
@@ -72,6 +111,9 @@ void BlockingAioThrottle::put(AioResult& r)
   completed.push_back(p);
 
   pending_size -= p.cost;
+  if (is_adaptive()) {
+    adapt_window(ceph::mono_clock::now() - p.start, p.cost);
+  }
 
   if (waiter_ready()) {
     cond.notify_one();
@@ -139,11 +181,15 @@ AioResultList YieldingAioThrottle::get(rgw_raw_obj obj,
       ceph_assert(!completion);
 
       boost::system::error_code ec;
+      limited = true;
       waiter = Wait::Available;
       async_wait(yield[ec]);
     }
 
     // register the pending write and initiate the operation
+    if (is_adaptive()) {
+      p->start = ceph::mono_clock::now();
+    }
     pending.push_back(*p);
     std::move(f)(this, *static_cast<AioResult*>(p.get()));
   }
@@ -161,6 +207,9 @@ void YieldingAioThrottle::put(AioResult& r)
   completed.push_back(p);
 
   pending_size -= p.cost;
+  if (is_adaptive()) {
+    adapt_window(ceph::mono_clock::now() - p.start, p.cost);
+  }
 
   if (waiter_ready()) {
     ceph_assert(completion);
@@ -199,4 +248,25 @@ AioResultList YieldingAioThrottle::drain()
   }
   return std::move(completed);
 }
+
+std::unique_ptr<Aio> make_throttle(CephContext* cct, uint64_t window_size,
+                                   uint64_t max_window, optional_yield y)
+{
+  if (!cct->_conf.get_val<bool>("rgw_aio_window_adaptive")) {
+    return make_throttle(window_size, y);
+  }
+  auto budget = &cct->lookup_or_create_singleton_object<AioWindowBudget>(
+      "rgw::AioWindowBudget", false,
+      cct->_conf.get_val<Option::size_t>("rgw_aio_window_budget"));
+
+  std::unique_ptr<Aio> aio;
+  if (y) {
+    aio = std::make_unique<YieldingAioThrottle>(window_size, max_window,
+                                                budget, y.get_yield_context());
+  } else {
+    aio = std::make_unique<BlockingAioThrottle>(window_size, max_window,
+                                                budget);
+  }
+  return aio;
+}
 } // namespace rgw
@@ -15,19 +15,49 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include "common/ceph_mutex.h"
+#include "common/ceph_time.h"
 #include "common/async/completion.h"
 #include "common/async/yield_context.h"
 #include "rgw_aio.h"
 
 namespace rgw {
 
+// gateway-wide pool of window bytes that adaptive throttles may borrow on
+// top of their base window
+class AioWindowBudget {
+  const uint64_t limit;
+  std::atomic<uint64_t> reserved = {0};
+ public:
+  explicit AioWindowBudget(uint64_t limit) : limit(limit) {}
+
+  bool try_reserve(uint64_t bytes);
+  void release(uint64_t bytes) { reserved -= bytes; }
+  uint64_t get_reserved() const { return reserved; }
+};
+
 class Throttle {
  protected:
-  const uint64_t window;
+  uint64_t window;
   uint64_t pending_size = 0;
 
+  // adaptive window control. the window starts at and never drops below its
+  // base size. it grows by the size of each completed operation while the
+  // throttle is full and latency stays near the lowest seen; it shrinks by a
+  // quarter when latency rises above twice that floor. growth beyond the base
+  // window is borrowed from the gateway-wide budget
+  const uint64_t min_window;
+  const uint64_t max_window;
+  AioWindowBudget* const budget;
+  ceph::timespan lat_min = ceph::timespan::max();
+  ceph::timespan lat_avg = ceph::timespan::zero();
+  bool limited = false; // a request had to wait for the window
+
+  bool is_adaptive() const { return budget != nullptr; }
+  void adapt_window(ceph::timespan latency, uint64_t cost);
+
   AioResultList pending;
   AioResultList completed;
 
@@ -41,12 +71,21 @@ class Throttle {
   bool waiter_ready() const;
 
  public:
-  Throttle(uint64_t window) : window(window) {}
+  Throttle(uint64_t window)
+    : window(window), min_window(window), max_window(window), budget(nullptr)
+  {}
+  Throttle(uint64_t window, uint64_t max_window, AioWindowBudget* budget)
+    : window(window), min_window(window),
+      max_window(std::max(window, max_window)), budget(budget)
+  {}
 
   virtual ~Throttle() {
     // must drain before destructing
     ceph_assert(pending.empty());
     ceph_assert(completed.empty());
+    if (budget) {
+      budget->release(window - min_window);
+    }
   }
 };
 
@@ -59,9 +98,13 @@ class BlockingAioThrottle final : public Aio, private Throttle {
   struct Pending : AioResultEntry {
     BlockingAioThrottle *parent = nullptr;
     uint64_t cost = 0;
+    ceph::mono_time start;
   };
  public:
   BlockingAioThrottle(uint64_t window) : Throttle(window) {}
+  BlockingAioThrottle(uint64_t window, uint64_t max_window,
+                      AioWindowBudget* budget)
+    : Throttle(window, max_window, budget) {}
 
   virtual ~BlockingAioThrottle() override {};
 
@@ -90,12 +133,20 @@ class YieldingAioThrottle final : public Aio, private Throttle {
   template <typename CompletionToken>
   auto async_wait(CompletionToken&& token);
 
-  struct Pending : AioResultEntry { uint64_t cost = 0; };
+  struct Pending : AioResultEntry {
+    uint64_t cost = 0;
+    ceph::mono_time start;
+  };
 
  public:
   YieldingAioThrottle(uint64_t window, boost::asio::yield_context yield)
     : Throttle(window), yield(yield)
   {}
+  YieldingAioThrottle(uint64_t window, uint64_t max_window,
+                      AioWindowBudget* budget,
+                      boost::asio::yield_context yield)
+    : Throttle(window, max_window, budget), yield(yield)
+  {}
 
   virtual ~YieldingAioThrottle() override {};
 
@@ -124,4 +175,10 @@ inline auto make_throttle(uint64_t window_size, optional_yield y)
   return aio;
 }
 
+// return a smart pointer to Aio. with rgw_aio_window_adaptive enabled, its
+// window adapts between window_size and max_window_size to the observed
+// RADOS latency
+std::unique_ptr<Aio> make_throttle(CephContext* cct, uint64_t window_size,
+                                   uint64_t max_window_size, optional_yield y);
+
 } // namespace rgw
@@ -31,6 +31,12 @@ class ClientIO : public io::RestfulClient,
   rgw::io::StaticOutputBufferer<> txbuf;
   bool sent100continue = false;
 
+ protected:
+  /* Send exactly @len bytes of @bl starting at @ofs with a single gathered
+   * write. On success returns @len. On failure throws rgw::io::Exception. */
+  virtual size_t write_buffers(const ceph::bufferlist& bl,
+                               size_t ofs, size_t len) = 0;
+
  public:
   ClientIO(parser_type& parser, bool is_ssl,
            const endpoint_type& local_endpoint,
@@ -51,6 +57,11 @@ class ClientIO : public io::RestfulClient,
     return write_data(buf, len);
   }
 
+  size_t send_body_list(const ceph::bufferlist& bl,
+                        size_t ofs, size_t len) override {
+    return write_buffers(bl, ofs, len);
+  }
+
   RGWEnv& get_env() noexcept override {
     return env;
   }
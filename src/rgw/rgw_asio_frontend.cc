@@ -1,17 +1,21 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
 // vim: ts=8 sw=2 smarttab ft=cpp
 
+#include <algorithm>
 #include <atomic>
 #include <ctime>
 #include <memory>
+#include <thread>
 #include <vector>
 
 #include <boost/asio/error.hpp>
+#include <boost/asio/executor_work_guard.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ip/v6_only.hpp>
 #include <boost/asio/read.hpp>
 #include <boost/asio/write.hpp>
+#include <boost/container/small_vector.hpp>
 
 #include <boost/intrusive/list.hpp>
 #include <boost/smart_ptr/intrusive_ref_counter.hpp>
@@ -19,8 +23,11 @@
 #include <boost/context/protected_fixedsize_stack.hpp>
 #include <boost/asio/spawn.hpp>
 
+#include <fmt/format.h>
+
 #include "common/async/shared_mutex.h"
 #include "common/errno.h"
+#include "common/Thread.h"
 #include "common/strtol.h"
 
 #include "rgw_asio_client.h"
@@ -86,11 +93,12 @@ class StreamIO : public rgw::asio::ClientIO {
 
   boost::system::error_code get_fatal_error_code() const { return fatal_ec; }
 
-  size_t write_data(const char* buf, size_t len) override {
+ private:
+  template <typename ConstBufferSequence>
+  size_t write(const ConstBufferSequence& buffers) {
     boost::system::error_code ec;
     timeout.start();
-    auto bytes = boost::asio::async_write(stream, boost::asio::buffer(buf, len),
-                                          yield[ec]);
+    auto bytes = boost::asio::async_write(stream, buffers, yield[ec]);
     timeout.cancel();
     if (ec) {
       ldout(cct, 4) << "write_data failed: " << ec.message() << dendl;
@@ -106,6 +114,32 @@ class StreamIO : public rgw::asio::ClientIO {
     return bytes;
   }
 
+ protected:
+  size_t write_buffers(const bufferlist& bl, size_t ofs, size_t len) override {
+    // reference the bufferlist's segments in place, the socket layer
+    // gathers them into a single writev()
+    boost::container::small_vector<boost::asio::const_buffer, 16> buffers;
+    for (const auto& ptr : bl.buffers()) {
+      if (len == 0) {
+        break;
+      }
+      if (ofs >= ptr.length()) {
+        ofs -= ptr.length();
+        continue;
+      }
+      const size_t seg_len = std::min<size_t>(ptr.length() - ofs, len);
+      buffers.emplace_back(ptr.c_str() + ofs, seg_len);
+      ofs = 0;
+      len -= seg_len;
+    }
+    return write(buffers);
+  }
+
+ public:
+  size_t write_data(const char* buf, size_t len) override {
+    return write(boost::asio::buffer(buf, len));
+  }
+
   size_t recv_body(char* buf, size_t max) override {
     auto& message = parser.get();
     auto& body_remaining = message.body();
@@ -419,7 +453,23 @@ class AsioFrontend {
   SharedMutex pause_mutex;
   std::unique_ptr<rgw::dmclock::Scheduler> scheduler;
 
+  // with io_shards=N, each shard runs a private io_context on its own
+  // threads, and accepts connections on its own SO_REUSEPORT listeners.
+  // connections stay on the shard that accepted them
+  struct Shard {
+    boost::asio::io_context context;
+    boost::asio::executor_work_guard<
+        boost::asio::io_context::executor_type> work;
+    std::vector<std::thread> threads;
+
+    explicit Shard(int concurrency_hint)
+      : context(concurrency_hint), work(context.get_executor()) {}
+  };
+  std::vector<std::unique_ptr<Shard>> shards;
+  int threads_per_shard = 1;
+
   struct Listener {
+    boost::asio::io_context* context;
     tcp::endpoint endpoint;
     tcp::acceptor acceptor;
     tcp::socket socket;
@@ -427,10 +477,12 @@ class AsioFrontend {
     bool use_nodelay = false;
 
     explicit Listener(boost::asio::io_context& context)
-      : acceptor(context), socket(context) {}
+      : context(&context), acceptor(context), socket(context) {}
   };
   std::vector<Listener> listeners;
 
+  int init_shards();
+
   ConnectionList connections;
 
   std::atomic<bool> going_down{false};
@@ -467,9 +519,7 @@ class AsioFrontend {
   }
 
   int init();
-  int run() {
-    return 0;
-  }
+  int run();
   void stop();
   void join();
   void pause();
@@ -598,8 +648,9 @@ int AsioFrontend::init()
     }
   }
 
+  int r = 0;
 #ifdef WITH_RADOSGW_BEAST_OPENSSL
-  int r = init_ssl();
+  r = init_ssl();
   if (r < 0) {
     return r;
   }
@@ -637,7 +688,11 @@ int AsioFrontend::init()
       l.use_nodelay = (nodelay->second == "1");
     }
   }
-  
+
+  r = init_shards();
+  if (r < 0) {
+    return r;
+  }
 
   bool socket_bound = false;
   // start listeners
@@ -664,6 +719,18 @@ int AsioFrontend::init()
     }
 
     l.acceptor.set_option(tcp::acceptor::reuse_address(true));
+#ifdef SO_REUSEPORT
+    if (!shards.empty()) {
+      using reuse_port = boost::asio::detail::socket_option::boolean<
+          SOL_SOCKET, SO_REUSEPORT>;
+      l.acceptor.set_option(reuse_port(true), ec);
+      if (ec) {
+        lderr(ctx()) << "failed to set SO_REUSEPORT socket option: "
+            << ec.message() << dendl;
+        return -ec.value();
+      }
+    }
+#endif
     l.acceptor.bind(l.endpoint, ec);
     if (ec) {
       lderr(ctx()) << "failed to bind address " << l.endpoint
@@ -698,6 +765,69 @@ int AsioFrontend::init()
   return drop_privileges(ctx());
 }
 
+int AsioFrontend::init_shards()
+{
+  auto& config = conf->get_config_map();
+  auto i = config.find("io_shards");
+  if (i == config.end()) {
+    return 0;
+  }
+  auto count = ceph::parse<unsigned>(i->second);
+  if (!count) {
+    lderr(ctx()) << "failed to parse io_shards=" << i->second << dendl;
+    return -EINVAL;
+  }
+  if (*count == 0) {
+    return 0;
+  }
+#ifndef SO_REUSEPORT
+  lderr(ctx()) << "io_shards requires SO_REUSEPORT support" << dendl;
+  return -EOPNOTSUPP;
+#else
+  // split the frontend threads between the shards
+  threads_per_shard = std::max<int>(1, ctx()->_conf->rgw_thread_pool_size / *count);
+  shards.reserve(*count);
+  for (unsigned n = 0; n < *count; ++n) {
+    shards.push_back(std::make_unique<Shard>(threads_per_shard));
+  }
+
+  // give every shard its own listener for each endpoint. the kernel
+  // spreads incoming connections over the sockets bound to a port
+  std::vector<Listener> sharded;
+  sharded.reserve(listeners.size() * shards.size());
+  for (const auto& l : listeners) {
+    for (auto& shard : shards) {
+      auto& s = sharded.emplace_back(shard->context);
+      s.endpoint = l.endpoint;
+      s.use_ssl = l.use_ssl;
+      s.use_nodelay = l.use_nodelay;
+    }
+  }
+  listeners = std::move(sharded);
+
+  ldout(ctx(), 4) << "frontend using " << shards.size() << " io shards with "
+      << threads_per_shard << " threads each" << dendl;
+  return 0;
+#endif
+}
+
+int AsioFrontend::run()
+{
+  for (size_t n = 0; n < shards.size(); ++n) {
+    auto& shard = *shards[n];
+    for (int t = 0; t < threads_per_shard; ++t) {
+      shard.threads.push_back(make_named_thread(
+          fmt::format("rgw_beast_{}", n),
+          [&shard] {
+            // request warnings on synchronous librados calls in this thread
+            is_asio_thread = true;
+            shard.context.run();
+          }));
+    }
+  }
+  return 0;
+}
+
 #ifdef WITH_RADOSGW_BEAST_OPENSSL
 
 static string config_val_prefix = "config://";
@@ -1022,8 +1152,8 @@ void AsioFrontend::accept(Listener& l, boost::system::error_code ec)
   // spawn a coroutine to handle the connection
 #ifdef WITH_RADOSGW_BEAST_OPENSSL
   if (l.use_ssl) {
-    boost::asio::spawn(make_strand(context), std::allocator_arg, make_stack_allocator(),
-      [this, s=std::move(stream)] (boost::asio::yield_context yield) mutable {
+    boost::asio::spawn(make_strand(*l.context), std::allocator_arg, make_stack_allocator(),
+      [this, &context=*l.context, s=std::move(stream)] (boost::asio::yield_context yield) mutable {
         auto conn = boost::intrusive_ptr{new Connection(std::move(s))};
         auto c = connections.add(*conn);
         // wrap the tcp stream in an ssl stream
@@ -1057,8 +1187,8 @@ void AsioFrontend::accept(Listener& l, boost::system::error_code ec)
 #else
   {
 #endif // WITH_RADOSGW_BEAST_OPENSSL
-    boost::asio::spawn(make_strand(context), std::allocator_arg, make_stack_allocator(),
-      [this, s=std::move(stream)] (boost::asio::yield_context yield) mutable {
+    boost::asio::spawn(make_strand(*l.context), std::allocator_arg, make_stack_allocator(),
+      [this, &context=*l.context, s=std::move(stream)] (boost::asio::yield_context yield) mutable {
         auto conn = boost::intrusive_ptr{new Connection(std::move(s))};
         auto c = connections.add(*conn);
         auto timeout = timeout_timer{context.get_executor(), request_timeout, conn};
@@ -1089,6 +1219,10 @@ void AsioFrontend::stop()
   // close all connections
   connections.close(ec);
   pause_mutex.cancel();
+  // let the shard threads return once their connections finish
+  for (auto& shard : shards) {
+    shard->work.reset();
+  }
 }
 
 void AsioFrontend::join()
@@ -1096,6 +1230,12 @@ void AsioFrontend::join()
   if (!going_down) {
     stop();
   }
+  for (auto& shard : shards) {
+    for (auto& t : shard->threads) {
+      t.join();
+    }
+    shard->threads.clear();
+  }
 }
 
 void AsioFrontend::pause()
@@ -18,6 +18,10 @@
 #include "rgw_client_io.h"
 #include "rgw_rest.h"
 #include "rgw_crypt_sanitize.h"
+#include "include/scope_guard.h"
+#include <boost/asio/post.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
 
 #include <boost/container/small_vector.hpp>
 #include <boost/algorithm/string.hpp>
@@ -1061,6 +1065,102 @@ get_v2_signature(CephContext* const cct,
   }
 }
 
+namespace {
+
+/* Threads shared by the PayloadHashers of all requests */
+class PayloadHashPool {
+  boost::asio::thread_pool pool;
+public:
+  explicit PayloadHashPool(unsigned threads) : pool(threads) {}
+  ~PayloadHashPool() {
+    pool.join();
+  }
+  auto get_executor() {
+    return pool.get_executor();
+  }
+};
+
+} // anonymous namespace
+
+struct PayloadHasher::Offload {
+  const size_t min_size;
+  /* runs the updates of one hasher in order */
+  boost::asio::strand<boost::asio::thread_pool::executor_type> strand;
+  ceph::mutex lock = ceph::make_mutex("PayloadHasher::Offload::lock");
+  ceph::condition_variable cond;
+  size_t pending = 0;
+
+  Offload(PayloadHashPool& pool, size_t min_size)
+    : min_size(min_size), strand(boost::asio::make_strand(pool.get_executor()))
+  {}
+};
+
+PayloadHasher::PayloadHasher(CephContext* const cct)
+  : hash(calc_hash_sha256_open_stream())
+{
+  const auto threads =
+    cct->_conf.get_val<uint64_t>("rgw_sigv4_hash_offload_threads");
+  if (threads > 0) {
+    auto& pool = cct->lookup_or_create_singleton_object<PayloadHashPool>(
+      "rgw::auth::s3::PayloadHashPool", false, threads);
+    offload = std::make_unique<Offload>(pool,
+      cct->_conf.get_val<Option::size_t>("rgw_sigv4_hash_offload_min_size"));
+  }
+}
+
+PayloadHasher::~PayloadHasher()
+{
+  wait();
+  if (hash) {
+    calc_hash_sha256_close_stream(&hash);
+  }
+}
+
+size_t PayloadHasher::get_piece_size() const
+{
+  return offload ? offload->min_size : 0;
+}
+
+void PayloadHasher::update(const char* const buf, const size_t len)
+{
+  if (offload) {
+    std::unique_lock l{offload->lock};
+    if (len >= offload->min_size || offload->pending > 0) {
+      ++offload->pending;
+      l.unlock();
+      boost::asio::post(offload->strand, [this, buf, len] {
+        calc_hash_sha256_update_stream(hash, buf, len);
+        std::lock_guard g{offload->lock};
+        if (--offload->pending == 0) {
+          offload->cond.notify_all();
+        }
+      });
+      return;
+    }
+  }
+  calc_hash_sha256_update_stream(hash, buf, len);
+}
+
+void PayloadHasher::wait()
+{
+  if (offload) {
+    std::unique_lock l{offload->lock};
+    offload->cond.wait(l, [this] { return offload->pending == 0; });
+  }
+}
+
+std::string PayloadHasher::restart()
+{
+  wait();
+  return calc_hash_sha256_restart_stream(&hash);
+}
+
+std::string PayloadHasher::close()
+{
+  wait();
+  return calc_hash_sha256_close_stream(&hash);
+}
+
 bool AWSv4ComplMulti::ChunkMeta::is_new_chunk_in_stream(size_t stream_pos) const
 {
   return stream_pos >= (data_offset_in_stream + data_length);
@@ -1210,7 +1310,7 @@ bool AWSv4ComplMulti::is_signature_mismatched()
 
   /* The validity of previous chunk can be verified only after getting meta-
    * data of the next one. */
-  const auto payload_hash = calc_hash_sha256_restart_stream(&sha256_hash);
+  const auto payload_hash = sha256_hash.restart();
   const auto calc_signature = calc_chunk_signature(payload_hash);
 
   if (cct()->_conf->subsys.should_gather(ceph_subsys_rgw, 16)) [[unlikely]] {
@@ -1329,7 +1429,7 @@ AWSv4ComplMulti::ReceiveChunkResult AWSv4ComplMulti::recv_chunk(
     std::copy(std::begin(parsing_buf), data_end_iter, buf);
     parsing_buf.erase(std::begin(parsing_buf), data_end_iter);
 
-    calc_hash_sha256_update_stream(sha256_hash, buf, data_len);
+    sha256_hash.update(buf, data_len);
 
     to_extract -= data_len;
     buf_pos += data_len;
@@ -1337,8 +1437,12 @@ AWSv4ComplMulti::ReceiveChunkResult AWSv4ComplMulti::recv_chunk(
 
   /* Now we can do the bulk read directly from RestfulClient without any extra
    * buffering. */
+  const size_t piece = sha256_hash.get_piece_size();
   while (to_extract > 0) {
-    const size_t received = io_base_t::recv_body(buf + buf_pos, to_extract);
+    /* With hash offload, read in pieces so the hashing of one overlaps
+     * with receiving the next. */
+    const size_t received = io_base_t::recv_body(buf + buf_pos,
+      piece ? std::min(to_extract, piece) : to_extract);
     dout(30) << "AWSv4ComplMulti: to_extract=" << to_extract << ", received=" << received << dendl;
 
     if (received == 0) {
@@ -1346,7 +1450,7 @@ AWSv4ComplMulti::ReceiveChunkResult AWSv4ComplMulti::recv_chunk(
       break;
     }
 
-    calc_hash_sha256_update_stream(sha256_hash, buf + buf_pos, received);
+    sha256_hash.update(buf + buf_pos, received);
 
     buf_pos += received;
     stream_pos += received;
@@ -1487,6 +1591,9 @@ size_t AWSv4ComplMulti::recv_body(char* const buf, const size_t buf_max)
 
   ldout(cct(), 20) << "AWSv4ComplMulti::recv_body() buf_max: " << buf_max << dendl;
 
+  /* buf must not be handed back while it's still being hashed */
+  auto wait_hash = make_scope_guard([this] { sha256_hash.wait(); });
+
   uint32_t cnt = 0;
   while (total < buf_max && !eof) {
     ReceiveChunkResult rcr =
@@ -1690,10 +1797,28 @@ AWSv4ComplMulti::create(const req_state* const s,
 
 size_t AWSv4ComplSingle::recv_body(char* const buf, const size_t max)
 {
-  const auto received = io_base_t::recv_body(buf, max);
-  calc_hash_sha256_update_stream(sha256_hash, buf, received);
+  const size_t piece = sha256_hash.get_piece_size();
+  if (!piece) {
+    const auto received = io_base_t::recv_body(buf, max);
+    sha256_hash.update(buf, received);
+
+    return received;
+  }
 
-  return received;
+  /* Read in pieces so the hashing of one overlaps with receiving the next.
+   * buf must not be handed back while it's still being hashed. */
+  auto wait_hash = make_scope_guard([this] { sha256_hash.wait(); });
+  size_t total = 0;
+  while (total < max) {
+    const size_t want = std::min(max - total, piece);
+    const auto received = io_base_t::recv_body(buf + total, want);
+    sha256_hash.update(buf + total, received);
+    total += received;
+    if (received < want) {
+      break;
+    }
+  }
+  return total;
 }
 
 void AWSv4ComplSingle::modify_request_state(const DoutPrefixProvider* dpp, req_state* const s_rw)
@@ -1708,7 +1833,7 @@ bool AWSv4ComplSingle::complete()
   /* The completer is only for the cases where signed payload has been
    * requested. It won't be used, for instance, during the query string-based
    * authentication. */
-  const auto payload_hash = calc_hash_sha256_close_stream(&sha256_hash);
+  const auto payload_hash = sha256_hash.close();
 
   /* Validate x-amz-sha256 */
   if (payload_hash.compare(expected_request_payload_hash) == 0) {
@@ -1728,7 +1853,7 @@ AWSv4ComplSingle::AWSv4ComplSingle(const req_state* const s)
   : io_base_t(nullptr),
     cct(s->cct),
     expected_request_payload_hash(get_v4_exp_payload_hash(s->info)),
-    sha256_hash(calc_hash_sha256_open_stream()) {
+    sha256_hash(s->cct) {
 }
 
 rgw::auth::Completer::cmplptr_t
@@ -267,6 +267,34 @@ public:
   }
 }; /* AWSAuthstrategy */
 
+/* Streaming SHA-256 of a request payload. When rgw_sigv4_hash_offload_threads
+ * is set, updates of at least rgw_sigv4_hash_offload_min_size bytes are run
+ * in order on a shared thread pool, so hashing of already received data can
+ * overlap with reading the rest of the payload from the client. The memory
+ * passed to update() must stay valid until wait() returns. */
+class PayloadHasher {
+  struct Offload;
+
+  ceph::crypto::SHA256* hash;
+  std::unique_ptr<Offload> offload;
+
+public:
+  explicit PayloadHasher(CephContext* cct);
+  ~PayloadHasher();
+
+  /* The size to read from the client before handing the data over for
+   * hashing, or 0 when hashing is done inline. */
+  size_t get_piece_size() const;
+
+  void update(const char* buf, size_t len);
+  /* Wait for all submitted updates to finish. */
+  void wait();
+  /* Return the hex digest of the data so far and start over. */
+  std::string restart();
+  /* Return the hex digest of the data. */
+  std::string close();
+};
+
 class AWSv4ComplMulti : public rgw::auth::Completer,
                         public rgw::io::DecoratedRestfulClient<rgw::io::RestfulClient*>,
                         public std::enable_shared_from_this<AWSv4ComplMulti> {
@@ -352,7 +380,7 @@ class AWSv4ComplMulti : public rgw::auth::Completer,
   size_t stream_pos;
   boost::container::static_vector<char, ChunkMeta::META_MAX_SIZE> parsing_buf;
   boost::optional<std::string_view> x_amz_trailer;
-  ceph::crypto::SHA256* sha256_hash;
+  PayloadHasher sha256_hash;
   std::string prev_chunk_signature;
 
   bool is_signature_mismatched();
@@ -418,7 +446,7 @@ class AWSv4ComplMulti : public rgw::auth::Completer,
 		   seed_signature, flags, 0 /* first call in cycle */)),
       lf_bytes(0),
       stream_pos(0),
-      sha256_hash(calc_hash_sha256_open_stream()),
+      sha256_hash(s->cct),
       prev_chunk_signature(std::move(seed_signature))
   {
     auto cksum = s->info.env->get("HTTP_X_AMZ_TRAILER");
@@ -427,12 +455,6 @@ class AWSv4ComplMulti : public rgw::auth::Completer,
     }
   } /* AWSv4ComplMulti */
 
-  ~AWSv4ComplMulti() {
-    if (sha256_hash) {
-      calc_hash_sha256_close_stream(&sha256_hash);
-    }
-  }
-
   /* rgw::io::DecoratedRestfulClient. */
   size_t recv_body(char* buf, size_t max) override;
 
@@ -457,7 +479,7 @@ class AWSv4ComplSingle : public rgw::auth::Completer,
 
   CephContext* const cct;
   const char* const expected_request_payload_hash;
-  ceph::crypto::SHA256* sha256_hash = nullptr;
+  PayloadHasher sha256_hash;
 
 public:
   /* Defined in rgw_auth_s3.cc because of get_v4_exp_payload_hash(). We need
@@ -465,12 +487,6 @@ public:
    * the create() method. */
   explicit AWSv4ComplSingle(const req_state* const s);
 
-  ~AWSv4ComplSingle() {
-    if (sha256_hash) {
-      calc_hash_sha256_close_stream(&sha256_hash);
-    }
-  }
-
   /* rgw::io::DecoratedRestfulClient. */
   size_t recv_body(char* buf, size_t max) override;
 
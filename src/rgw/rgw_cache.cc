@@ -5,6 +5,7 @@
 #include "rgw_perf_counters.h"
 
 #include <errno.h>
+#include <algorithm>
 
 #define dout_subsys ceph_subsys_rgw
 
@@ -13,8 +14,10 @@ using namespace std;
 int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCacheInfo& info, uint32_t mask, rgw_cache_entry_info *cache_info)
 {
 
-  std::shared_lock rl{lock};
-  std::unique_lock wl{lock, std::defer_lock}; // may be promoted to write lock
+  auto& shard = get_shard(name);
+  auto& cache_map = shard.cache_map;
+  std::shared_lock rl{shard.lock};
+  std::unique_lock wl{shard.lock, std::defer_lock}; // may be promoted to write lock
   if (!enabled) {
     return -ENOENT;
   }
@@ -37,7 +40,7 @@ int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCa
     if (iter != cache_map.end()) {
       for (auto &kv : iter->second.chained_entries)
         kv.first->invalidate(kv.second);
-      remove_lru(name, iter->second.lru_iter);
+      remove_lru(shard, name, iter->second.lru_iter);
       cache_map.erase(iter);
     }
     if (perfcounter) {
@@ -48,8 +51,8 @@ int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCa
 
   ObjectCacheEntry *entry = &iter->second;
 
-  if (lru_counter - entry->lru_promotion_ts > lru_window) {
-    ldpp_dout(dpp, 20) << "cache get: touching lru, lru_counter=" << lru_counter
+  if (shard.lru_counter - entry->lru_promotion_ts > lru_window) {
+    ldpp_dout(dpp, 20) << "cache get: touching lru, lru_counter=" << shard.lru_counter
                    << " promotion_ts=" << entry->lru_promotion_ts << dendl;
     rl.unlock();
     wl.lock(); // write lock for touch_lru()
@@ -63,8 +66,8 @@ int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCa
 
     entry = &iter->second;
     /* check again, we might have lost a race here */
-    if (lru_counter - entry->lru_promotion_ts > lru_window) {
-      touch_lru(dpp, name, *entry, iter->second.lru_iter);
+    if (shard.lru_counter - entry->lru_promotion_ts > lru_window) {
+      touch_lru(dpp, shard, name, *entry, iter->second.lru_iter);
     }
   }
 
@@ -99,7 +102,20 @@ bool ObjectCache::chain_cache_entry(const DoutPrefixProvider *dpp,
                                     std::initializer_list<rgw_cache_entry_info*> cache_info_entries,
 				    RGWChainedCache::Entry *chained_entry)
 {
-  std::unique_lock l{lock};
+  // lock the shards of all entries, in the same order as lock_all()
+  std::vector<size_t> entry_shards;
+  entry_shards.reserve(cache_info_entries.size());
+  for (auto cache_info : cache_info_entries) {
+    entry_shards.push_back(get_shard_index(cache_info->cache_locator));
+  }
+  std::sort(entry_shards.begin(), entry_shards.end());
+  entry_shards.erase(std::unique(entry_shards.begin(), entry_shards.end()),
+                     entry_shards.end());
+  std::vector<std::unique_lock<ceph::shared_mutex>> locks;
+  locks.reserve(entry_shards.size());
+  for (auto shard_index : entry_shards) {
+    locks.emplace_back(shards[shard_index]->lock);
+  }
 
   if (!enabled) {
     return false;
@@ -111,6 +127,7 @@ bool ObjectCache::chain_cache_entry(const DoutPrefixProvider *dpp,
   for (auto cache_info : cache_info_entries) {
     ldpp_dout(dpp, 10) << "chain_cache_entry: cache_locator="
 		   << cache_info->cache_locator << dendl;
+    auto& cache_map = get_shard(cache_info->cache_locator).cache_map;
     auto iter = cache_map.find(cache_info->cache_locator);
     if (iter == cache_map.end()) {
       ldpp_dout(dpp, 20) << "chain_cache_entry: couldn't find cache locator" << dendl;
@@ -141,7 +158,8 @@ bool ObjectCache::chain_cache_entry(const DoutPrefixProvider *dpp,
 
 void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectCacheInfo& info, rgw_cache_entry_info *cache_info)
 {
-  std::unique_lock l{lock};
+  auto& shard = get_shard(name);
+  std::unique_lock l{shard.lock};
 
   if (!enabled) {
     return;
@@ -150,11 +168,11 @@ void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectC
   ldpp_dout(dpp, 10) << "cache put: name=" << name << " info.flags=0x"
                  << std::hex << info.flags << std::dec << dendl;
 
-  auto [iter, inserted] = cache_map.emplace(name, ObjectCacheEntry{});
+  auto [iter, inserted] = shard.cache_map.emplace(name, ObjectCacheEntry{});
   ObjectCacheEntry& entry = iter->second;
   entry.info.time_added = ceph::coarse_mono_clock::now();
   if (inserted) {
-    entry.lru_iter = lru.end();
+    entry.lru_iter = shard.lru.end();
   }
   ObjectCacheInfo& target = entry.info;
 
@@ -163,7 +181,7 @@ void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectC
   entry.chained_entries.clear();
   entry.gen++;
 
-  touch_lru(dpp, name, entry, entry.lru_iter);
+  touch_lru(dpp, shard, name, entry, entry.lru_iter);
 
   target.status = info.status;
 
@@ -218,14 +236,15 @@ void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectC
 // negative lookup. It must only invalidate.
 bool ObjectCache::invalidate_remove(const DoutPrefixProvider *dpp, const string& name)
 {
-  std::unique_lock l{lock};
+  auto& shard = get_shard(name);
+  std::unique_lock l{shard.lock};
 
   if (!enabled) {
     return false;
   }
 
-  auto iter = cache_map.find(name);
-  if (iter == cache_map.end())
+  auto iter = shard.cache_map.find(name);
+  if (iter == shard.cache_map.end())
     return false;
 
   ldpp_dout(dpp, 10) << "removing " << name << " from cache" << dendl;
@@ -235,15 +254,19 @@ bool ObjectCache::invalidate_remove(const DoutPrefixProvider *dpp, const string&
     kv.first->invalidate(kv.second);
   }
 
-  remove_lru(name, iter->second.lru_iter);
-  cache_map.erase(iter);
+  remove_lru(shard, name, iter->second.lru_iter);
+  shard.cache_map.erase(iter);
   return true;
 }
 
-void ObjectCache::touch_lru(const DoutPrefixProvider *dpp, const string& name, ObjectCacheEntry& entry,
+void ObjectCache::touch_lru(const DoutPrefixProvider *dpp, Shard& shard,
+                            const string& name, ObjectCacheEntry& entry,
 			    std::list<string>::iterator& lru_iter)
 {
-  while (lru_size > (size_t)cct->_conf->rgw_cache_lru_size) {
+  auto& cache_map = shard.cache_map;
+  auto& lru = shard.lru;
+  auto& lru_size = shard.lru_size;
+  while (lru_size > lru_max) {
     auto iter = lru.begin();
     if ((*iter).compare(name) == 0) {
       /*
@@ -276,19 +299,19 @@ void ObjectCache::touch_lru(const DoutPrefixProvider *dpp, const string& name, O
     --lru_iter;
   }
 
-  lru_counter++;
-  entry.lru_promotion_ts = lru_counter;
+  shard.lru_counter++;
+  entry.lru_promotion_ts = shard.lru_counter;
 }
 
-void ObjectCache::remove_lru(const string& name,
+void ObjectCache::remove_lru(Shard& shard, const string& name,
 			     std::list<string>::iterator& lru_iter)
 {
-  if (lru_iter == lru.end())
+  if (lru_iter == shard.lru.end())
     return;
 
-  lru.erase(lru_iter);
-  lru_size--;
-  lru_iter = lru.end();
+  shard.lru.erase(lru_iter);
+  shard.lru_size--;
+  lru_iter = shard.lru.end();
 }
 
 void ObjectCache::invalidate_lru(ObjectCacheEntry& entry)
@@ -300,9 +323,19 @@ void ObjectCache::invalidate_lru(ObjectCacheEntry& entry)
   }
 }
 
+std::vector<std::unique_lock<ceph::shared_mutex>> ObjectCache::lock_all()
+{
+  std::vector<std::unique_lock<ceph::shared_mutex>> locks;
+  locks.reserve(shards.size());
+  for (auto& shard : shards) {
+    locks.emplace_back(shard->lock);
+  }
+  return locks;
+}
+
 void ObjectCache::set_enabled(bool status)
 {
-  std::unique_lock l{lock};
+  auto locks = lock_all();
 
   enabled = status;
 
@@ -313,32 +346,34 @@ void ObjectCache::set_enabled(bool status)
 
 void ObjectCache::invalidate_all()
 {
-  std::unique_lock l{lock};
+  auto locks = lock_all();
 
   do_invalidate_all();
 }
 
 void ObjectCache::do_invalidate_all()
 {
-  cache_map.clear();
-  lru.clear();
+  for (auto& shard : shards) {
+    shard->cache_map.clear();
+    shard->lru.clear();
 
-  lru_size = 0;
-  lru_counter = 0;
-  lru_window = 0;
+    shard->lru_size = 0;
+    shard->lru_counter = 0;
+  }
 
+  std::shared_lock l{chained_lock};
   for (auto& cache : chained_cache) {
     cache->invalidate_all();
   }
 }
 
 void ObjectCache::chain_cache(RGWChainedCache *cache) {
-  std::unique_lock l{lock};
+  std::unique_lock l{chained_lock};
   chained_cache.push_back(cache);
 }
 
 void ObjectCache::unchain_cache(RGWChainedCache *cache) {
-  std::unique_lock l{lock};
+  std::unique_lock l{chained_lock};
 
   auto iter = chained_cache.begin();
   for (; iter != chained_cache.end(); ++iter) {
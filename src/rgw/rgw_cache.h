@@ -3,9 +3,12 @@
 
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <map>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 #include "include/types.h"
 #include "include/utime.h"
 #include "include/ceph_assert.h"
@@ -159,28 +162,55 @@ struct ObjectCacheEntry {
 };
 
 class ObjectCache {
-  std::unordered_map<std::string, ObjectCacheEntry> cache_map;
-  std::list<std::string> lru;
-  unsigned long lru_size;
-  unsigned long lru_counter;
+  // entries are spread over shards by name hash, each with its own lock
+  // and LRU, so that lookups of unrelated entries don't contend
+  struct Shard {
+    std::unordered_map<std::string, ObjectCacheEntry> cache_map;
+    std::list<std::string> lru;
+    unsigned long lru_size = 0;
+    unsigned long lru_counter = 0;
+    // lockdep needs a distinct name per shard, chain_cache_entry() and
+    // lock_all() hold several of them at once
+    ceph::shared_mutex lock;
+
+    explicit Shard(size_t index)
+      : lock(ceph::make_shared_mutex(
+	       "ObjectCache::Shard::" + std::to_string(index))) {}
+  };
+  std::vector<std::unique_ptr<Shard>> shards;
+  unsigned long lru_max;    ///< max entries per shard
   unsigned long lru_window;
-  ceph::shared_mutex lock = ceph::make_shared_mutex("ObjectCache");
   CephContext *cct;
 
+  ceph::shared_mutex chained_lock =
+    ceph::make_shared_mutex("ObjectCache::chained_lock");
   std::vector<RGWChainedCache *> chained_cache;
 
-  bool enabled;
+  std::atomic<bool> enabled;
   ceph::timespan expiry;
 
-  void touch_lru(const DoutPrefixProvider *dpp, const std::string& name, ObjectCacheEntry& entry,
+  size_t get_shard_index(const std::string& name) const {
+    return std::hash<std::string>{}(name) % shards.size();
+  }
+  Shard& get_shard(const std::string& name) {
+    return *shards[get_shard_index(name)];
+  }
+  /// lock all shards (in order) for cache-wide operations
+  std::vector<std::unique_lock<ceph::shared_mutex>> lock_all();
+
+  void touch_lru(const DoutPrefixProvider *dpp, Shard& shard,
+                 const std::string& name, ObjectCacheEntry& entry,
 		 std::list<std::string>::iterator& lru_iter);
-  void remove_lru(const std::string& name, std::list<std::string>::iterator& lru_iter);
+  void remove_lru(Shard& shard, const std::string& name,
+                  std::list<std::string>::iterator& lru_iter);
   void invalidate_lru(ObjectCacheEntry& entry);
 
   void do_invalidate_all();
 
 public:
-  ObjectCache() : lru_size(0), lru_counter(0), lru_window(0), cct(NULL), enabled(false) { }
+  ObjectCache() : lru_max(0), lru_window(0), cct(NULL), enabled(false) {
+    shards.emplace_back(std::make_unique<Shard>(0));
+  }
   ~ObjectCache();
   int get(const DoutPrefixProvider *dpp, const std::string& name, ObjectCacheInfo& bl, uint32_t mask, rgw_cache_entry_info *cache_info);
   std::optional<ObjectCacheInfo> get(const DoutPrefixProvider *dpp, const std::string& name) {
@@ -191,12 +221,14 @@ public:
 
   template<typename F>
   void for_each(const F& f) {
-    std::shared_lock l{lock};
-    if (enabled) {
-      auto now  = ceph::coarse_mono_clock::now();
-      for (const auto& [name, entry] : cache_map) {
-        if (expiry.count() && (now - entry.info.time_added) < expiry) {
-          f(name, entry);
+    for (auto& shard : shards) {
+      std::shared_lock l{shard->lock};
+      if (enabled) {
+        auto now  = ceph::coarse_mono_clock::now();
+        for (const auto& [name, entry] : shard->cache_map) {
+          if (expiry.count() && (now - entry.info.time_added) < expiry) {
+            f(name, entry);
+          }
         }
       }
     }
@@ -206,7 +238,15 @@ public:
   bool invalidate_remove(const DoutPrefixProvider *dpp, const std::string& name);
   void set_ctx(CephContext *_cct) {
     cct = _cct;
-    lru_window = cct->_conf->rgw_cache_lru_size / 2;
+    auto num_shards = std::max<uint64_t>(
+      1, cct->_conf.get_val<uint64_t>("rgw_cache_shards"));
+    shards.clear();
+    for (uint64_t i = 0; i < num_shards; ++i) {
+      shards.emplace_back(std::make_unique<Shard>(i));
+    }
+    lru_max = std::max<unsigned long>(
+      1, cct->_conf->rgw_cache_lru_size / num_shards);
+    lru_window = lru_max / 2;
     expiry = std::chrono::seconds(cct->_conf.get_val<uint64_t>(
 						"rgw_cache_expiry_interval"));
   }
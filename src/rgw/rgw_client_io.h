@@ -145,6 +145,32 @@ public:
    * of response's body. On failure throws rgw::io::Exception. */
   virtual size_t send_body(const char* buf, size_t len) = 0;
 
+  /* Generate a part of response's body by taking exactly @len bytes of @bl
+   * starting at @ofs. The default implementation hands each ceph::buffer::ptr
+   * to send_body() separately, so @bl never needs to be rebuilt into a
+   * continuous memory area. Front-ends capable of vectored writes should
+   * override it to pass all the segments down at once. On success returns
+   * number of generated bytes of response's body. On failure throws
+   * rgw::io::Exception. */
+  virtual size_t send_body_list(const ceph::bufferlist& bl,
+                                size_t ofs, size_t len) {
+    size_t sent = 0;
+    for (const auto& ptr : bl.buffers()) {
+      if (len == 0) {
+        break;
+      }
+      if (ofs >= ptr.length()) {
+        ofs -= ptr.length();
+        continue;
+      }
+      const size_t seg_len = std::min<size_t>(ptr.length() - ofs, len);
+      sent += send_body(ptr.c_str() + ofs, seg_len);
+      ofs = 0;
+      len -= seg_len;
+    }
+    return sent;
+  }
+
   /* Flushes all already generated data to a direct client of RadosGW.
    * On failure throws rgw::io::Exception containing errno. */
   virtual void flush() = 0;
@@ -239,6 +265,11 @@ public:
     return get_decoratee().send_body(buf, len);
   }
 
+  size_t send_body_list(const ceph::bufferlist& bl,
+                        const size_t ofs, const size_t len) override {
+    return get_decoratee().send_body_list(bl, ofs, len);
+  }
+
   void flush() override {
     return get_decoratee().flush();
   }
@@ -121,6 +121,18 @@ public:
     return sent;
   }
 
+  size_t send_body_list(const ceph::bufferlist& bl,
+                        const size_t ofs, const size_t len) override {
+    const auto sent = DecoratedRestfulClient<T>::send_body_list(bl, ofs, len);
+    lsubdout(cct, rgw, 30) << "AccountingFilter::send_body_list: e="
+        << (enabled ? "1" : "0") << ", sent=" << sent << ", total="
+        << total_sent << dendl;
+    if (enabled) {
+      total_sent += sent;
+    }
+    return sent;
+  }
+
   size_t complete_request() override {
     const auto sent = DecoratedRestfulClient<T>::complete_request();
     lsubdout(cct, rgw, 30) << "AccountingFilter::complete_request: e="
@@ -172,6 +184,8 @@ public:
   size_t send_chunked_transfer_encoding() override;
   size_t complete_header() override;
   size_t send_body(const char* buf, size_t len) override;
+  size_t send_body_list(const ceph::bufferlist& bl,
+                        size_t ofs, size_t len) override;
   size_t complete_request() override;
 };
 
@@ -190,6 +204,25 @@ size_t BufferingFilter<T>::send_body(const char* const buf,
   return DecoratedRestfulClient<T>::send_body(buf, len);
 }
 
+template <typename T>
+size_t BufferingFilter<T>::send_body_list(const ceph::bufferlist& bl,
+                                          const size_t ofs,
+                                          const size_t len)
+{
+  if (buffer_data) {
+    /* Share the buffers instead of copying their contents. */
+    ceph::bufferlist part;
+    part.substr_of(bl, ofs, len);
+    data.claim_append(part);
+
+    lsubdout(cct, rgw, 30) << "BufferingFilter<T>::send_body_list: defer count = "
+        << len << dendl;
+    return 0;
+  }
+
+  return DecoratedRestfulClient<T>::send_body_list(bl, ofs, len);
+}
+
 template <typename T>
 size_t BufferingFilter<T>::send_content_length(const uint64_t len)
 {
@@ -237,12 +270,9 @@ size_t BufferingFilter<T>::complete_request()
   }
 
   if (buffer_data) {
-    /* We are sending each buffer separately to avoid extra memory shuffling
+    /* We are sending the buffers as they are to avoid extra memory shuffling
      * that would occur on data.c_str() to provide a continuous memory area. */
-    for (const auto& ptr : data.buffers()) {
-      sent += DecoratedRestfulClient<T>::send_body(ptr.c_str(),
-                                                   ptr.length());
-    }
+    sent += DecoratedRestfulClient<T>::send_body_list(data, 0, data.length());
     data.clear();
     buffer_data = false;
     lsubdout(cct, rgw, 30) << "BufferingFilter::complete_request: buffer_data: sent="
@@ -301,6 +331,26 @@ public:
     }
   }
 
+  size_t send_body_list(const ceph::bufferlist& bl,
+                        const size_t ofs, const size_t len) override {
+    if (! chunking_enabled || len == 0) {
+      /* An empty chunk would terminate the body prematurely. */
+      return DecoratedRestfulClient<T>::send_body_list(bl, ofs, len);
+    } else {
+      static constexpr char HEADER_END[] = "\r\n";
+      char chunk_size[32];
+      const auto chunk_size_len = snprintf(chunk_size, sizeof(chunk_size),
+                                           "%zx\r\n", len);
+      size_t sent = 0;
+
+      sent += DecoratedRestfulClient<T>::send_body(chunk_size, chunk_size_len);
+      sent += DecoratedRestfulClient<T>::send_body_list(bl, ofs, len);
+      sent += DecoratedRestfulClient<T>::send_body(HEADER_END,
+                                                   sizeof(HEADER_END) - 1);
+      return sent;
+    }
+  }
+
   size_t complete_request() override {
     size_t sent = 0;
 
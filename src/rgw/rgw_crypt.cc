@@ -25,6 +25,12 @@
 
 #include <openssl/evp.h>
 
+#include <boost/asio/append.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/use_future.hpp>
+
 #define dout_context g_ceph_context
 #define dout_subsys ceph_subsys_rgw
 
@@ -375,6 +381,28 @@ bool evp_sym_transform(const DoutPrefixProvider* dpp,
 }
 
 
+namespace {
+
+/* Threads shared by the software AES_256_CBC transforms of all requests */
+class CryptOffloadPool {
+  const unsigned threads;
+  boost::asio::thread_pool pool;
+public:
+  explicit CryptOffloadPool(unsigned threads)
+    : threads(threads), pool(threads) {}
+  ~CryptOffloadPool() {
+    pool.join();
+  }
+  unsigned size() const {
+    return threads;
+  }
+  auto get_executor() {
+    return pool.get_executor();
+  }
+};
+
+} // anonymous namespace
+
 /**
  * Encryption in CBC mode. Chunked to 4K blocks. Offset is used as IV for each 4K block.
  *
@@ -439,6 +467,101 @@ public:
       dpp, cct, EVP_aes_256_cbc(), out, in, size, iv, key, encrypt);
   }
 
+  /// transform each 4K chunk with the accelerator if given, otherwise
+  /// with EVP
+  bool cbc_transform_chunks(unsigned char* out,
+                            const unsigned char* in,
+                            size_t size,
+                            off_t stream_offset,
+                            const unsigned char (&key)[AES_256_KEYSIZE],
+                            bool encrypt,
+                            CryptoAccel* accel,
+                            optional_yield y)
+  {
+    bool result = true;
+    unsigned char iv[AES_256_IVSIZE];
+    for (size_t offset = 0; result && (offset < size); offset += CHUNK_SIZE) {
+      size_t process_size = offset + CHUNK_SIZE <= size ? CHUNK_SIZE : size - offset;
+      prepare_iv(iv, stream_offset + offset);
+      if (accel != nullptr) {
+        if (encrypt) {
+          result = accel->cbc_encrypt(out + offset, in + offset,
+                                      process_size, iv, key, y);
+        } else {
+          result = accel->cbc_decrypt(out + offset, in + offset,
+                                      process_size, iv, key, y);
+        }
+      } else {
+        result = cbc_transform(
+            out + offset, in + offset, process_size,
+            iv, key, encrypt);
+      }
+    }
+    return result;
+  }
+
+  /// return the offload pool if transforms of this size should use it
+  CryptOffloadPool* get_offload_pool(size_t size)
+  {
+    static const size_t min_size =
+      cct->_conf.get_val<Option::size_t>("rgw_crypt_offload_min_size");
+    static const auto threads =
+      cct->_conf.get_val<uint64_t>("rgw_crypt_offload_threads");
+    if (threads == 0 || size < min_size) {
+      return nullptr;
+    }
+    return &cct->lookup_or_create_singleton_object<CryptOffloadPool>(
+        "rgw::CryptOffloadPool", false, threads);
+  }
+
+  /// split the chunks over the offload threads, and complete with the
+  /// result once all of them are transformed
+  template <typename CompletionToken>
+  auto async_cbc_transform(CryptOffloadPool& pool,
+                           unsigned char* out,
+                           const unsigned char* in,
+                           size_t size,
+                           off_t stream_offset,
+                           const unsigned char (&key)[AES_256_KEYSIZE],
+                           bool encrypt,
+                           CryptoAccel* accel,
+                           CompletionToken&& token)
+  {
+    using Signature = void(bool);
+    return boost::asio::async_initiate<CompletionToken, Signature>(
+        [this, &pool, out, in, size, stream_offset, &key, encrypt, accel]
+        (auto handler) {
+          using Handler = decltype(handler);
+          struct State {
+            Handler handler;
+            std::atomic<size_t> remaining;
+            std::atomic<bool> result{true};
+            State(Handler&& h, size_t n) : handler(std::move(h)), remaining(n) {}
+          };
+          const size_t chunks = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+          const size_t per_part = (chunks + pool.size() - 1) / pool.size();
+          const size_t part_size = per_part * CHUNK_SIZE;
+          const size_t parts = (size + part_size - 1) / part_size;
+          auto state = std::make_shared<State>(std::move(handler), parts);
+          for (size_t offset = 0; offset < size; offset += part_size) {
+            const size_t len = std::min(part_size, size - offset);
+            boost::asio::post(pool.get_executor(),
+              [this, state, out, in, offset, len, stream_offset, &key,
+               encrypt, accel] {
+                if (!cbc_transform_chunks(out + offset, in + offset, len,
+                                          stream_offset + offset, key,
+                                          encrypt, accel, null_yield)) {
+                  state->result = false;
+                }
+                if (--state->remaining == 0) {
+                  boost::asio::post(boost::asio::append(
+                      std::move(state->handler), state->result.load()));
+                }
+              });
+          }
+        }, token);
+  }
+
   bool cbc_transform(unsigned char* out,
                      const unsigned char* in,
                      size_t size,
@@ -475,24 +598,22 @@ public:
     }
     if (result == false) {
       // If QAT don't have free instance, we can fall back to this
-      result = true;
-      unsigned char iv[AES_256_IVSIZE];
-      for (size_t offset = 0; result && (offset < size); offset += CHUNK_SIZE) {
-        size_t process_size = offset + CHUNK_SIZE <= size ? CHUNK_SIZE : size - offset;
-        prepare_iv(iv, stream_offset + offset);
-        if (crypto_accel != nullptr && accelerator != "crypto_qat") {
-          if (encrypt) {
-            result = crypto_accel->cbc_encrypt(out + offset, in + offset,
-                                              process_size, iv, key, y);
-          } else {
-            result = crypto_accel->cbc_decrypt(out + offset, in + offset,
-                                              process_size, iv, key, y);
-          }
-        } else {
-          result = cbc_transform(
-              out + offset, in + offset, process_size,
-              iv, key, encrypt);
-        }
+      CryptoAccel* accel = nullptr;
+      if (accelerator != "crypto_qat") {
+        accel = crypto_accel.get();
+      }
+      CryptOffloadPool* pool = get_offload_pool(size);
+      if (pool == nullptr) {
+        result = cbc_transform_chunks(out, in, size, stream_offset, key,
+                                      encrypt, accel, y);
+      } else if (y) {
+        auto yield = y.get_yield_context();
+        result = async_cbc_transform(*pool, out, in, size, stream_offset, key,
+                                     encrypt, accel, yield);
+      } else {
+        result = async_cbc_transform(*pool, out, in, size, stream_offset, key,
+                                     encrypt, accel,
+                                     boost::asio::use_future).get();
       }
     }
     return result;
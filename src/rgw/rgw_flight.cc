@@ -14,6 +14,7 @@
 #include <mutex>
 #include <map>
 #include <algorithm>
+#include <numeric>
 
 #include "arrow/type.h"
 #include "arrow/buffer.h"
@@ -254,6 +255,28 @@ public:
   }
 }; // class OwnedBuffer
 
+  // A Buffer that points into the memory of a bufferlist and keeps it
+  // alive, so data read from rados reaches arrow without a copy
+class BufferlistBuffer : public arw::Buffer {
+
+  bufferlist bl;
+
+  BufferlistBuffer(bufferlist&& _bl, const char* data) :
+    Buffer(reinterpret_cast<const uint8_t*>(data), _bl.length()),
+    bl(std::move(_bl))
+    { }
+
+public:
+
+  // a bufferlist made of a single segment is wrapped as is, others are
+  // first rebuilt into one
+  static std::shared_ptr<BufferlistBuffer> make(bufferlist&& bl) {
+    const char* data = bl.c_str();
+    return std::shared_ptr<BufferlistBuffer>(
+      new BufferlistBuffer(std::move(bl), data));
+  }
+}; // class BufferlistBuffer
+
 #if 0 // remove classes used for testing and incrementally building
 
 // make local to DoGet eventually
@@ -554,9 +577,8 @@ public:
     return is_closed;
   }
 
-  arw::Result<int64_t> Read(int64_t nbytes, void* out) override {
-    INFO << "entered: asking for " << nbytes << " bytes" << dendl;
-
+  // read up to nbytes at the current position into bl
+  arw::Result<int64_t> Read(int64_t nbytes, bufferlist& bl) {
     if (position < 0) {
       ERROR << "error, position indicated error" << dendl;
       return arw::Status::IOError("object read op is in bad state");
@@ -565,8 +587,6 @@ public:
     // note: read function reads through end_position inclusive
     int64_t end_position = position + nbytes - 1;
 
-    bufferlist bl;
-
     const int64_t bytes_read =
       op->read(position, end_position, bl, null_yield, &dp);
     if (bytes_read < 0) {
@@ -579,10 +599,6 @@ public:
 	bytes_read);
     }
 
-    // TODO: see if there's a way to get rid of this copy, perhaps
-    // updating rgw::sal::read_op
-    bl.cbegin().copy(bytes_read, reinterpret_cast<char*>(out));
-
     position += bytes_read;
 
     if (nbytes != bytes_read) {
@@ -593,21 +609,27 @@ public:
     return bytes_read;
   }
 
-  arw::Result<std::shared_ptr<arw::Buffer>> Read(int64_t nbytes) override {
+  arw::Result<int64_t> Read(int64_t nbytes, void* out) override {
     INFO << "entered: asking for " << nbytes << " bytes" << dendl;
 
-    std::shared_ptr<OwnedBuffer> buffer;
-    ARROW_ASSIGN_OR_RAISE(buffer, OwnedBuffer::make(nbytes));
+    bufferlist bl;
+    ARROW_ASSIGN_OR_RAISE(const int64_t bytes_read, Read(nbytes, bl));
+    // the caller owns the memory, so this copy can't be avoided; arrow
+    // uses Read(nbytes) instead since we support zero copy
+    bl.cbegin().copy(bytes_read, reinterpret_cast<char*>(out));
+    return bytes_read;
+  }
 
-    ARROW_ASSIGN_OR_RAISE(const int64_t bytes_read,
-			  Read(nbytes, buffer->writeable_data()));
-    buffer->set_size(bytes_read);
+  arw::Result<std::shared_ptr<arw::Buffer>> Read(int64_t nbytes) override {
+    INFO << "entered: asking for " << nbytes << " bytes" << dendl;
 
-    return buffer;
+    bufferlist bl;
+    ARROW_RETURN_NOT_OK(Read(nbytes, bl));
+    return BufferlistBuffer::make(std::move(bl));
   }
 
   bool supports_zero_copy() const override {
-    return false;
+    return true;
   }
 
   // implement Seekable
@@ -662,6 +684,43 @@ public:
   }
 }; // class RandomAccessObject
 
+  // A RecordBatchReader over all row groups of a parquet file, which
+  // owns the parquet reader that its batches are read from
+class ParquetBatchReader : public arw::RecordBatchReader {
+
+  std::unique_ptr<parquet::arrow::FileReader> file_reader;
+  std::unique_ptr<arw::RecordBatchReader> batch_reader;
+
+  ParquetBatchReader(std::unique_ptr<parquet::arrow::FileReader>&& _file_reader,
+		     std::unique_ptr<arw::RecordBatchReader>&& _batch_reader) :
+    file_reader(std::move(_file_reader)),
+    batch_reader(std::move(_batch_reader))
+    { }
+
+public:
+
+  static arw::Result<std::shared_ptr<ParquetBatchReader>> make(
+    std::unique_ptr<parquet::arrow::FileReader>&& file_reader)
+  {
+    std::vector<int> row_groups(file_reader->num_row_groups());
+    std::iota(row_groups.begin(), row_groups.end(), 0);
+
+    std::unique_ptr<arw::RecordBatchReader> batch_reader;
+    ARROW_RETURN_NOT_OK(
+      file_reader->GetRecordBatchReader(row_groups, &batch_reader));
+    return std::shared_ptr<ParquetBatchReader>(
+      new ParquetBatchReader(std::move(file_reader), std::move(batch_reader)));
+  }
+
+  std::shared_ptr<arw::Schema> schema() const override {
+    return batch_reader->schema();
+  }
+
+  arw::Status ReadNext(std::shared_ptr<arw::RecordBatch>* batch) override {
+    return batch_reader->ReadNext(batch);
+  }
+}; // class ParquetBatchReader
+
 arw::Status FlightServer::DoGet(const flt::ServerCallContext &context,
 				const flt::Ticket &request,
 				std::unique_ptr<flt::FlightDataStream> *stream) {
@@ -703,30 +762,25 @@ arw::Status FlightServer::DoGet(const flt::ServerCallContext &context,
   auto input = std::make_shared<RandomAccessObject>(fd, object, dp);
   ARROW_RETURN_NOT_OK(input->Open());
 
-  std::unique_ptr<parquet::arrow::FileReader> reader;
-  ARROW_RETURN_NOT_OK(parquet::arrow::OpenFile(input,
-					       arw::default_memory_pool(),
-					       &reader));
-
-  std::shared_ptr<arrow::Table> table;
-  ARROW_RETURN_NOT_OK(reader->ReadTable(&table));
-
-  std::vector<std::shared_ptr<arw::RecordBatch>> batches;
-  arw::TableBatchReader batch_reader(*table);
-  while (true) {
-    std::shared_ptr<arw::RecordBatch> p;
-    auto s = batch_reader.ReadNext(&p);
-    if (!s.ok()) {
-      break;
-    }
-    batches.push_back(p);
-  }
+  // coalesce the reads of the column chunks of each row group, and
+  // decode the columns in parallel
+  parquet::ArrowReaderProperties properties;
+  properties.set_pre_buffer(true);
+  properties.set_use_threads(true);
 
-  ARROW_ASSIGN_OR_RAISE(auto owning_reader,
-			arw::RecordBatchReader::Make(
-			  std::move(batches), table->schema()));
+  parquet::arrow::FileReaderBuilder builder;
+  ARROW_RETURN_NOT_OK(builder.Open(input));
+  std::unique_ptr<parquet::arrow::FileReader> reader;
+  ARROW_RETURN_NOT_OK(builder.memory_pool(arw::default_memory_pool())
+		      ->properties(properties)
+		      ->Build(&reader));
+
+  // stream the row groups as they are read, rather than reading the
+  // whole table before sending the first batch
+  ARROW_ASSIGN_OR_RAISE(auto batch_reader,
+			ParquetBatchReader::make(std::move(reader)));
   *stream = std::unique_ptr<flt::FlightDataStream>(
-    new flt::RecordBatchStream(owning_reader));
+    new flt::RecordBatchStream(std::move(batch_reader)));
 
   return arw::Status::OK();
 } // flightServer::DoGet
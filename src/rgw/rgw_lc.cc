@@ -8,6 +8,8 @@
 #include <algorithm>
 #include <tuple>
 #include <functional>
+#include <deque>
+#include <set>
 
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string.hpp>
@@ -358,6 +360,7 @@ class LCObjsLister {
   rgw_bucket_dir_entry pre_obj;
   uint64_t num_noncurrent{0};
   int64_t delay_ms;
+  int max_entries{1000};
 
 public:
   LCObjsLister(rgw::sal::Driver* _driver, rgw::sal::Bucket* _bucket) :
@@ -372,12 +375,19 @@ public:
     list_params.prefix = prefix;
   }
 
+  /* list only the entry of object @a name, if it exists */
+  void set_key(const string& name) {
+    set_prefix(name);
+    list_params.allow_unordered = false;
+    max_entries = 1;
+  }
+
   int init(const DoutPrefixProvider *dpp) {
     return fetch(dpp);
   }
 
   int fetch(const DoutPrefixProvider *dpp) {
-    int ret = bucket->list(dpp, list_params, 1000, list_results, null_yield);
+    int ret = bucket->list(dpp, list_params, max_entries, list_results, null_yield);
     if (ret < 0) {
       return ret;
     }
@@ -1647,6 +1657,233 @@ int LCOpRule::process(rgw_bucket_dir_entry& o,
 
 }
 
+/*
+ * Lifecycle time index
+ *
+ * For unversioned buckets, every write records in the bucket's time index
+ * when each of the object's current-version expiration and transition
+ * actions falls due.  Once a full scan has gone over a bucket under its
+ * current rules (and indexed the objects written before), RGW_ATTR_LC_TIME_INDEX
+ * holds the crc of those rules, and lifecycle processing only visits the
+ * objects whose index entries are due.  Changing the rules invalidates the
+ * index, and the next run goes back to a full scan.  Filters and actions
+ * are always re-checked against the object itself, so spurious or stale
+ * entries are harmless.
+ */
+static std::string lc_time_index_oid(const std::string& bucket_marker,
+				     uint32_t shard)
+{
+  return fmt::format("lc_tindex.{}.{}", bucket_marker, shard);
+}
+
+static std::string lc_time_index_oid(CephContext* cct,
+				     const std::string& bucket_marker,
+				     const std::string& key)
+{
+  const auto num_shards =
+    cct->_conf.get_val<uint64_t>("rgw_lc_time_index_num_shards");
+  const uint32_t shard =
+    ceph_str_hash_linux(key.c_str(), key.size()) % num_shards;
+  return lc_time_index_oid(bucket_marker, shard);
+}
+
+ceph::real_time rgw::lc::time_index_due(CephContext* cct,
+					ceph::real_time mtime, int days)
+{
+  const time_t base = ceph::real_clock::to_time_t(mtime);
+  if (cct->_conf->rgw_lc_debug_interval > 0) {
+    return ceph::real_clock::from_time_t(
+      base + time_t(days) * cct->_conf->rgw_lc_debug_interval);
+  }
+  /* expiry is checked at day granularity */
+  time_t due = base + time_t(days) * secs_in_a_day;
+  due = (due + secs_in_a_day - 1) / secs_in_a_day * secs_in_a_day;
+  return ceph::real_clock::from_time_t(due);
+}
+
+void rgw::lc::time_index_entries(
+  CephContext* cct, RGWLifecycleConfiguration& config,
+  const std::string& key, ceph::real_time mtime,
+  std::vector<rgw::sal::Lifecycle::LCTimeIndexEntry>& entries)
+{
+  for (auto& [prefix, op] : config.get_prefix_map()) {
+    if (!op.status || key.compare(0, prefix.size(), prefix) != 0) {
+      continue;
+    }
+    if (op.expiration > 0) {
+      entries.push_back({time_index_due(cct, mtime, op.expiration), key});
+    } else if (op.expiration_date) {
+      entries.push_back({*op.expiration_date, key});
+    }
+    for (auto& [sc, transition] : op.transitions) {
+      if (transition.days >= 0) {
+	entries.push_back({time_index_due(cct, mtime, transition.days), key});
+      } else if (transition.date) {
+	entries.push_back({*transition.date, key});
+      }
+    }
+  }
+}
+
+static int lc_time_index_add(const DoutPrefixProvider* dpp,
+			     rgw::sal::Lifecycle* sal_lc,
+			     rgw::sal::Bucket* bucket,
+			     RGWLifecycleConfiguration& config,
+			     const std::string& key, ceph::real_time mtime,
+			     optional_yield y)
+{
+  std::vector<rgw::sal::Lifecycle::LCTimeIndexEntry> entries;
+  rgw::lc::time_index_entries(dpp->get_cct(), config, key, mtime, entries);
+  if (entries.empty()) {
+    return 0;
+  }
+  return sal_lc->add_time_index_entries(
+    dpp, lc_time_index_oid(dpp->get_cct(), bucket->get_marker(), key),
+    entries, y);
+}
+
+static uint32_t lc_time_index_crc(const bufferlist& lc_bl)
+{
+  return lc_bl.crc32c(0);
+}
+
+/* whether the time index of @a bucket covers the rules in @a lc_bl */
+static bool lc_time_index_valid(rgw::sal::Bucket* bucket,
+				const bufferlist& lc_bl)
+{
+  auto& attrs = bucket->get_attrs();
+  auto iter = attrs.find(RGW_ATTR_LC_TIME_INDEX);
+  if (iter == attrs.end()) {
+    return false;
+  }
+  uint32_t crc;
+  try {
+    auto p = iter->second.cbegin();
+    ceph::decode(crc, p);
+  } catch (const buffer::error&) {
+    return false;
+  }
+  return crc == lc_time_index_crc(lc_bl);
+}
+
+int RGWLC::add_time_index_hints(const DoutPrefixProvider* dpp,
+				const RGWBucketInfo& bucket_info,
+				const std::string& key,
+				ceph::real_time mtime, optional_yield y)
+{
+  if (!cct->_conf.get_val<bool>("rgw_lc_time_index") ||
+      bucket_info.versioned()) {
+    return 0;
+  }
+  /* the rules are in the bucket attrs, which come from the bucket
+   * instance cache */
+  std::unique_ptr<rgw::sal::Bucket> bucket;
+  int ret = driver->load_bucket(dpp, bucket_info.bucket, &bucket, y);
+  if (ret < 0) {
+    return ret;
+  }
+  auto& attrs = bucket->get_attrs();
+  auto aiter = attrs.find(RGW_ATTR_LC);
+  if (aiter == attrs.end()) {
+    return 0;
+  }
+  RGWLifecycleConfiguration config(cct);
+  try {
+    auto iter = aiter->second.cbegin();
+    config.decode(iter);
+  } catch (const buffer::error&) {
+    return -EIO;
+  }
+  ret = lc_time_index_add(dpp, sal_lc.get(), bucket.get(), config, key,
+			  mtime, y);
+  if (ret == -EOPNOTSUPP) {
+    return 0;
+  }
+  return ret;
+}
+
+int RGWLC::time_index_process(rgw::sal::Bucket* bucket,
+			      RGWLifecycleConfiguration& config,
+			      LCWorker* worker, time_t stop_at, bool once)
+{
+  rgw::sal::Zone* zone = driver->get_zone();
+  auto& prefix_map = config.get_prefix_map();
+  const auto now = ceph::real_clock::now();
+  const auto num_shards =
+    cct->_conf.get_val<uint64_t>("rgw_lc_time_index_num_shards");
+
+  for (uint32_t shard = 0; shard < num_shards; ++shard) {
+    const std::string oid = lc_time_index_oid(bucket->get_marker(), shard);
+    std::string marker;
+    bool truncated = false;
+    do {
+      if (worker_should_stop(stop_at, once)) {
+	ldpp_dout(this, 5) << __func__ << " interval budget EXPIRED worker="
+			   << worker->ix << " bucket=" << bucket->get_name()
+			   << dendl;
+	return 0;
+      }
+
+      std::vector<rgw::sal::Lifecycle::LCTimeIndexEntry> entries;
+      std::string out_marker;
+      int ret = sal_lc->list_time_index(this, oid, now, marker, 1000, entries,
+					&out_marker, &truncated, null_yield);
+      if (ret < 0) {
+	ldpp_dout(this, 0) << "ERROR: list_time_index() oid=" << oid
+			   << " returned ret=" << ret << dendl;
+	return ret;
+      }
+      if (entries.empty()) {
+	break;
+      }
+
+      /* the work items refer to their lister until drained */
+      std::deque<LCObjsLister> listers;
+      std::set<std::string> seen;
+      for (auto& e : entries) {
+	if (!seen.insert(e.key).second) {
+	  continue;
+	}
+	auto& ol = listers.emplace_back(driver, bucket);
+	ol.set_key(e.key);
+	ret = ol.init(this);
+	if (ret < 0 && ret != -ENOENT) {
+	  ldpp_dout(this, 0) << "ERROR: listing " << e.key
+			     << " returned ret=" << ret << dendl;
+	  worker->workpool->drain();
+	  return ret;
+	}
+	rgw_bucket_dir_entry* o{nullptr};
+	if (ret < 0 || !ol.get_obj(this, &o) || o->key.name != e.key) {
+	  continue; // removed since
+	}
+	for (auto& [prefix, op] : prefix_map) {
+	  if (!is_valid_op(op) || !zone_check(op, zone) ||
+	      e.key.compare(0, prefix.size(), prefix) != 0) {
+	    continue;
+	  }
+	  op_env oenv(op, driver, worker, bucket, ol);
+	  LCOpRule orule(oenv);
+	  orule.build();
+	  orule.update();
+	  std::tuple<LCOpRule, rgw_bucket_dir_entry> t1 = {orule, *o};
+	  worker->workpool->enqueue(WorkItem{t1});
+	}
+      }
+      worker->workpool->drain();
+
+      ret = sal_lc->trim_time_index(this, oid, out_marker, null_yield);
+      if (ret < 0) {
+	ldpp_dout(this, 0) << "ERROR: trim_time_index() oid=" << oid
+			   << " returned ret=" << ret << dendl;
+	return ret;
+      }
+      marker = std::move(out_marker);
+    } while (truncated);
+  }
+  return 0;
+}
+
 int RGWLC::bucket_lc_process(string& shard_id, LCWorker* worker,
 			     time_t stop_at, bool once)
 {
@@ -1709,7 +1946,14 @@ int RGWLC::bucket_lc_process(string& shard_id, LCWorker* worker,
   /* fetch information for zone checks */
   rgw::sal::Zone* zone = driver->get_zone();
 
-  auto pf = [&bucket_name](RGWLC::LCWorker* wk, WorkQ* wq, WorkItem& wi) {
+  const bool time_index =
+    cct->_conf.get_val<bool>("rgw_lc_time_index") && !bucket->versioned();
+  const bool use_time_index =
+    time_index && lc_time_index_valid(bucket.get(), aiter->second);
+  /* set if the full scan failed to index an object */
+  std::atomic<bool> index_failed = false;
+
+  auto pf = [&](RGWLC::LCWorker* wk, WorkQ* wq, WorkItem& wi) {
     auto wt =
       boost::get<std::tuple<LCOpRule, rgw_bucket_dir_entry>>(wi);
     auto& [op_rule, o] = wt;
@@ -1725,9 +1969,34 @@ int RGWLC::bucket_lc_process(string& shard_id, LCWorker* worker,
 	<< " bucket=" << bucket_name
 	<< dendl;
     }
+    if (use_time_index) {
+      if (ret < 0) {
+	/* retry with the next run */
+	ret = sal_lc->add_time_index_entries(
+	  wk->dpp, lc_time_index_oid(cct, bucket->get_marker(), o.key.name),
+	  {{ceph::real_clock::now(), o.key.name}}, null_yield);
+      }
+    } else if (time_index && !index_failed) {
+      ret = lc_time_index_add(wk->dpp, sal_lc.get(), bucket.get(), config,
+			      o.key.name, o.meta.mtime, null_yield);
+      if (ret < 0) {
+	index_failed = true;
+      }
+    }
   };
   worker->workpool->setf(pf);
 
+  if (use_time_index) {
+    ldpp_dout(this, 10) << __func__ << "() processing time index of bucket="
+			<< bucket_name << dendl;
+    ret = time_index_process(bucket.get(), config, worker, stop_at, once);
+    if (ret < 0) {
+      return ret;
+    }
+    return handle_multipart_expiration(bucket.get(), config.get_prefix_map(),
+				       worker, stop_at, once);
+  }
+
   multimap<string, lc_op>& prefix_map = config.get_prefix_map();
   ldpp_dout(this, 10) << __func__ <<  "() prefix_map size="
 		      << prefix_map.size()
@@ -1796,6 +2065,24 @@ int RGWLC::bucket_lc_process(string& shard_id, LCWorker* worker,
     worker->workpool->drain();
   }
 
+  if (time_index) {
+    if (!index_failed) {
+      /* the full scan has indexed every object */
+      bufferlist bl;
+      ceph::encode(lc_time_index_crc(aiter->second), bl);
+      rgw::sal::Attrs attrs;
+      attrs[RGW_ATTR_LC_TIME_INDEX] = std::move(bl);
+      ret = bucket->merge_and_store_attrs(this, attrs, null_yield);
+      if (ret < 0) {
+	ldpp_dout(this, 1) << "WARNING: failed to mark the time index of bucket="
+			   << bucket_name << " complete, ret=" << ret << dendl;
+      }
+    } else {
+      ldpp_dout(this, 1) << "WARNING: failed to index some objects of bucket="
+			 << bucket_name << ", will scan it again" << dendl;
+    }
+  }
+
   ret = handle_multipart_expiration(bucket.get(), prefix_map, worker, stop_at, once);
   return ret;
 }
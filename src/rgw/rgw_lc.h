@@ -659,6 +659,13 @@ public:
   int remove_bucket_config(rgw::sal::Bucket* bucket,
                            const rgw::sal::Attrs& bucket_attrs,
 			   bool merge_attrs = true);
+  /** record in the bucket's time index when the lifecycle actions of the
+   * object @a key, written at @a mtime, fall due.  Called by the driver
+   * for every head object it writes. */
+  int add_time_index_hints(const DoutPrefixProvider* dpp,
+			   const RGWBucketInfo& bucket_info,
+			   const std::string& key,
+			   ceph::real_time mtime, optional_yield y);
 
   CephContext *get_cct() const override { return cct; }
   rgw::sal::Lifecycle* get_lc() const { return sal_lc.get(); }
@@ -667,6 +674,9 @@ public:
 
   private:
 
+  int time_index_process(rgw::sal::Bucket* bucket,
+			 RGWLifecycleConfiguration& config,
+			 LCWorker* worker, time_t stop_at, bool once);
   int handle_multipart_expiration(rgw::sal::Bucket* target,
 				  const std::multimap<std::string, lc_op>& prefix_map,
 				  LCWorker* worker, time_t stop_at, bool once);
@@ -686,6 +696,17 @@ std::string s3_expiration_header(
   const ceph::real_time& mtime,
   const std::map<std::string, buffer::list>& bucket_attrs);
 
+/// the first time at which an object written at @a mtime is @a days old
+/// by the rounding of lifecycle processing
+ceph::real_time time_index_due(CephContext* cct, ceph::real_time mtime,
+			       int days);
+
+/// the time index entries of the object @a key written at @a mtime
+void time_index_entries(
+  CephContext* cct, RGWLifecycleConfiguration& config,
+  const std::string& key, ceph::real_time mtime,
+  std::vector<rgw::sal::Lifecycle::LCTimeIndexEntry>& entries);
+
 bool s3_multipart_abort_header(
   DoutPrefixProvider* dpp,
   const rgw_obj_key& obj_key,
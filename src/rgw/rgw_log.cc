@@ -17,7 +17,9 @@
 
 #include "services/svc_zone.h"
 
+#include <atomic>
 #include <chrono>
+#include <thread>
 #include <math.h>
 
 #define dout_subsys ceph_subsys_rgw
@@ -92,15 +94,26 @@ string render_log_object_name(const string& format,
 }
 
 /* usage logger */
+/*
+ * Usage is accumulated in memory between flushes, already aggregated per
+ * user, bucket and hour.  The accumulation is sharded by thread, so that
+ * concurrent requests don't all serialize on one lock; the shards are
+ * merged when they are flushed.
+ */
 class UsageLogger : public DoutPrefixProvider {
+  static constexpr size_t num_shards = 16;
+
+  struct alignas(64) Shard {
+    ceph::mutex lock = ceph::make_mutex("UsageLogger::Shard");
+    map<rgw_user_bucket, RGWUsageBatch> usage_map;
+  };
+
   CephContext *cct;
   rgw::sal::Driver* driver;
-  map<rgw_user_bucket, RGWUsageBatch> usage_map;
-  ceph::mutex lock = ceph::make_mutex("UsageLogger");
-  int32_t num_entries;
+  std::unique_ptr<Shard[]> shards;
+  std::atomic<int32_t> num_entries;
   ceph::mutex timer_lock = ceph::make_mutex("UsageLogger::timer_lock");
   SafeTimer timer;
-  utime_t round_timestamp;
 
   class C_UsageLogTimeout : public Context {
     UsageLogger *logger;
@@ -115,14 +128,20 @@ class UsageLogger : public DoutPrefixProvider {
   void set_timer() {
     timer.add_event_after(cct->_conf->rgw_usage_log_tick_interval, new C_UsageLogTimeout(this));
   }
+
+  Shard& get_shard() {
+    static thread_local const size_t idx =
+      std::hash<std::thread::id>{}(std::this_thread::get_id()) % num_shards;
+    return shards[idx];
+  }
 public:
 
-  UsageLogger(CephContext *_cct, rgw::sal::Driver* _driver) : cct(_cct), driver(_driver), num_entries(0), timer(cct, timer_lock) {
+  UsageLogger(CephContext *_cct, rgw::sal::Driver* _driver)
+    : cct(_cct), driver(_driver), shards(new Shard[num_shards]),
+      num_entries(0), timer(cct, timer_lock) {
     timer.init();
     std::lock_guard l{timer_lock};
     set_timer();
-    utime_t ts = ceph_clock_now();
-    recalc_round_timestamp(ts);
   }
 
   ~UsageLogger() {
@@ -132,24 +151,22 @@ public:
     timer.shutdown();
   }
 
-  void recalc_round_timestamp(utime_t& ts) {
-    round_timestamp = ts.round_to_hour();
-  }
-
   void insert_user(utime_t& timestamp, const rgw_user& user, rgw_usage_log_entry& entry) {
-    lock.lock();
-    if (timestamp.sec() > round_timestamp + 3600)
-      recalc_round_timestamp(timestamp);
+    utime_t round_timestamp = timestamp.round_to_hour();
     entry.epoch = round_timestamp.sec();
     bool account;
     string u = user.to_str();
     rgw_user_bucket ub(u, entry.bucket);
     real_time rt = round_timestamp.to_real_time();
-    usage_map[ub].insert(rt, entry, &account);
-    if (account)
-      num_entries++;
-    bool need_flush = (num_entries > cct->_conf->rgw_usage_log_flush_threshold);
-    lock.unlock();
+    {
+      auto& shard = get_shard();
+      std::lock_guard l{shard.lock};
+      shard.usage_map[ub].insert(rt, entry, &account);
+    }
+    bool need_flush = false;
+    if (account) {
+      need_flush = (++num_entries > cct->_conf->rgw_usage_log_flush_threshold);
+    }
     if (need_flush) {
       std::lock_guard l{timer_lock};
       flush();
@@ -166,11 +183,31 @@ public:
 
   void flush() {
     map<rgw_user_bucket, RGWUsageBatch> old_map;
-    lock.lock();
-    old_map.swap(usage_map);
     num_entries = 0;
-    lock.unlock();
+    for (size_t i = 0; i < num_shards; ++i) {
+      map<rgw_user_bucket, RGWUsageBatch> shard_map;
+      {
+        std::lock_guard l{shards[i].lock};
+        shard_map.swap(shards[i].usage_map);
+      }
+      if (old_map.empty()) {
+        old_map.swap(shard_map);
+        continue;
+      }
+      /* the same user and bucket may have been logged by several shards */
+      for (auto& [ub, batch] : shard_map) {
+        auto& old_batch = old_map[ub];
+        for (auto& [t, entry] : batch.m) {
+          real_time rt = t;
+          bool account;
+          old_batch.insert(rt, entry, &account);
+        }
+      }
+    }
 
+    if (old_map.empty()) {
+      return;
+    }
     driver->log_usage(this, old_map, null_yield);
   }
 
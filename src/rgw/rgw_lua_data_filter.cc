@@ -104,7 +104,7 @@ int RGWObjFilter::execute(bufferlist& bl, off_t offset, const char* op_name) con
     }
 
     // execute the lua script
-    if (luaL_dostring(L, script.c_str()) != LUA_OK) {
+    if (doscript(L, script) != LUA_OK) {
       const std::string err(lua_tostring(L, -1));
       ldpp_dout(s, 1) << "Lua ERROR: " << err << dendl;
       return -EINVAL;
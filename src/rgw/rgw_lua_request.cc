@@ -820,7 +820,7 @@ int execute(
     }
 
     // execute the lua script
-    if (luaL_dostring(L, script.c_str()) != LUA_OK) {
+    if (doscript(L, script) != LUA_OK) {
       const std::string err(lua_tostring(L, -1));
       ldpp_dout(s, 1) << "Lua ERROR: " << err << dendl;
       rc = -1;
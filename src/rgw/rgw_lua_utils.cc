@@ -1,4 +1,5 @@
 #include <string>
+#include <unordered_map>
 #include <lua.hpp>
 #include "common/ceph_context.h"
 #include "common/debug.h"
@@ -91,6 +92,45 @@ void open_standard_libs(lua_State* L) {
   }
 }
 
+// the contexts of a few tenants; any script beyond that evicts another
+constexpr std::size_t MAX_CACHED_SCRIPTS = 16;
+
+int loadscript(lua_State* L, const std::string& script) {
+  thread_local std::unordered_map<std::string, std::string> bytecode;
+  if (const auto it = bytecode.find(script); it != bytecode.end()) {
+    return luaL_loadbufferx(L, it->second.data(), it->second.size(),
+        script.c_str(), "b");
+  }
+  // named after the source, as luaL_loadstring() does
+  const auto rc = luaL_loadbufferx(L, script.data(), script.size(),
+      script.c_str(), "t");
+  if (rc != LUA_OK) {
+    return rc;
+  }
+  std::string dumped;
+  // keep the debug information, so that errors still point at a line
+  const auto writer = [](lua_State*, const void* p, std::size_t sz, void* ud) {
+    reinterpret_cast<std::string*>(ud)->append(
+        reinterpret_cast<const char*>(p), sz);
+    return 0;
+  };
+  if (lua_dump(L, writer, &dumped, 0) == 0) {
+    if (bytecode.size() >= MAX_CACHED_SCRIPTS) {
+      bytecode.erase(bytecode.begin());
+    }
+    bytecode.emplace(script, std::move(dumped));
+  }
+  return LUA_OK;
+}
+
+int doscript(lua_State* L, const std::string& script) {
+  const auto rc = loadscript(L, script);
+  if (rc != LUA_OK) {
+    return rc;
+  }
+  return lua_pcall(L, 0, LUA_MULTRET, 0);
+}
+
 // allocator function that verifies against maximum allowed memory value
 void* allocator(void* ud, void* ptr, std::size_t osize, std::size_t nsize) {
   auto mem = reinterpret_cast<std::size_t*>(ud); // remaining memory
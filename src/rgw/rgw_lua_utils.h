@@ -77,6 +77,16 @@ public:
 
 int dostring(lua_State* L, const char* str);
 
+// load the script as a function on top of the stack.
+// the bytecode of the scripts recently loaded by this thread is cached,
+// so that the same script is parsed and compiled only once per thread.
+// the cache is keyed by the script text, so a new version of a script
+// never runs an older one
+int loadscript(lua_State* L, const std::string& script);
+
+// same as luaL_dostring(), using loadscript()
+int doscript(lua_State* L, const std::string& script);
+
 constexpr const int MAX_LUA_VALUE_SIZE = 1000;
 constexpr const int MAX_LUA_KEY_ENTRIES = 100000;
 
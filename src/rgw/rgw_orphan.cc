@@ -1,7 +1,9 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
 // vim: ts=8 sw=2 smarttab ft=cpp
 
+#include <atomic>
 #include <string>
+#include <thread>
 
 
 #include "common/config.h"
@@ -255,7 +257,7 @@ int RGWOrphanSearch::log_oids(const DoutPrefixProvider *dpp, map<int, string>& l
 
   for (; miter != oids.end(); ++miter) {
     log_iter_info info;
-    info.oid = log_shards[miter->first];
+    info.oid = log_shards.at(miter->first);
     info.cur = miter->second.begin();
     info.end = miter->second.end();
     liters.push_back(info);
@@ -292,73 +294,76 @@ int RGWOrphanSearch::log_oids(const DoutPrefixProvider *dpp, map<int, string>& l
   return 0;
 }
 
-int RGWOrphanSearch::build_all_oids_index(const DoutPrefixProvider *dpp)
+int RGWOrphanSearch::build_all_oids_slice(const DoutPrefixProvider *dpp,
+                                          librados::IoCtx& ioctx,
+                                          const librados::ObjectCursor& begin,
+                                          const librados::ObjectCursor& end,
+                                          int n, int m,
+                                          std::atomic<uint64_t>& total)
 {
-  librados::IoCtx ioctx;
-
-  int ret = rgw_init_ioctx(dpp, static_cast<rgw::sal::RadosStore*>(store)->getRados()->get_rados_handle(), search_info.pool, ioctx);
-  if (ret < 0) {
-    ldpp_dout(dpp, -1) << __func__ << ": rgw_init_ioctx() returned ret=" << ret << dendl;
-    return ret;
-  }
-
-  ioctx.set_namespace(librados::all_nspaces);
-  librados::NObjectIterator i = ioctx.nobjects_begin();
-  librados::NObjectIterator i_end = ioctx.nobjects_end();
+  librados::ObjectCursor slice_start;
+  librados::ObjectCursor slice_end;
+  ioctx.object_list_slice(begin, end, n, m, &slice_start, &slice_end);
 
   map<int, list<string> > oids;
 
   int count = 0;
-  uint64_t total = 0;
-
-  cout << "logging all objects in the pool" << std::endl;
+  int ret;
 
-  for (; i != i_end; ++i) {
-    string nspace = i->get_nspace();
-    string oid = i->get_oid();
-    string locator = i->get_locator();
-
-    ssize_t pos = oid.find('_');
-    if (pos < 0) {
-      cout << "unidentified oid: " << oid << ", skipping" << std::endl;
-      /* what is this object, oids should be in the format of <bucket marker>_<obj>,
-       * skip this entry
-       */
-      continue;
-    }
-    string stripped_oid = oid.substr(pos + 1);
-    rgw_obj_key key;
-    if (!rgw_obj_key::parse_raw_oid(stripped_oid, &key)) {
-      cout << "cannot parse oid: " << oid << ", skipping" << std::endl;
-      continue;
+  librados::ObjectCursor c(slice_start);
+  while (c < slice_end) {
+    std::vector<librados::ObjectItem> result;
+#define COUNT_BEFORE_FLUSH 1000
+    ret = ioctx.object_list(c, slice_end, COUNT_BEFORE_FLUSH, {}, &result, &c);
+    if (ret < 0) {
+      ldpp_dout(dpp, -1) << __func__ << ": object_list() returned ret=" << ret << dendl;
+      return ret;
     }
 
-    if (key.ns.empty()) {
-      /* skipping head objects, we don't want to remove these as they are mutable and
-       * cleaning them up is racy (can race with object removal and a later recreation)
-       */
-      cout << "skipping head object: oid=" << oid << std::endl;
-      continue;
-    }
+    for (const auto& i : result) {
+      const string& oid = i.oid;
 
-    string oid_fp = obj_fingerprint(oid);
+      ssize_t pos = oid.find('_');
+      if (pos < 0) {
+        cout << "unidentified oid: " << oid << ", skipping" << std::endl;
+        /* what is this object, oids should be in the format of <bucket marker>_<obj>,
+         * skip this entry
+         */
+        continue;
+      }
+      string stripped_oid = oid.substr(pos + 1);
+      rgw_obj_key key;
+      if (!rgw_obj_key::parse_raw_oid(stripped_oid, &key)) {
+        cout << "cannot parse oid: " << oid << ", skipping" << std::endl;
+        continue;
+      }
 
-    ldout(store->ctx(), 20) << "oid_fp=" << oid_fp << dendl;
+      if (key.ns.empty()) {
+        /* skipping head objects, we don't want to remove these as they are mutable and
+         * cleaning them up is racy (can race with object removal and a later recreation)
+         */
+        cout << "skipping head object: oid=" << oid << std::endl;
+        continue;
+      }
 
-    int shard = orphan_shard(oid_fp);
-    oids[shard].push_back(oid);
+      string oid_fp = obj_fingerprint(oid);
 
-#define COUNT_BEFORE_FLUSH 1000
-    ++total;
-    if (++count >= COUNT_BEFORE_FLUSH) {
-      ldout(store->ctx(), 1) << "iterated through " << total << " objects" << dendl;
-      ret = log_oids(dpp, all_objs_index, oids);
-      if (ret < 0) {
-        cerr << __func__ << ": ERROR: log_oids() returned ret=" << ret << std::endl;
-        return ret;
+      ldout(store->ctx(), 20) << "oid_fp=" << oid_fp << dendl;
+
+      int shard = orphan_shard(oid_fp);
+      oids[shard].push_back(oid);
+
+      ++total;
+      if (++count >= COUNT_BEFORE_FLUSH) {
+        ldout(store->ctx(), 1) << "iterated through " << total << " objects" << dendl;
+        ret = log_oids(dpp, all_objs_index, oids);
+        if (ret < 0) {
+          cerr << __func__ << ": ERROR: log_oids() returned ret=" << ret << std::endl;
+          return ret;
+        }
+        count = 0;
+        oids.clear();
       }
-      count = 0;
-      oids.clear();
     }
   }
   ret = log_oids(dpp, all_objs_index, oids);
@@ -366,7 +371,50 @@ int RGWOrphanSearch::build_all_oids_index(const DoutPrefixProvider *dpp)
     cerr << __func__ << ": ERROR: log_oids() returned ret=" << ret << std::endl;
     return ret;
   }
-  
+
+  return 0;
+}
+
+int RGWOrphanSearch::build_all_oids_index(const DoutPrefixProvider *dpp)
+{
+  librados::IoCtx ioctx;
+
+  int ret = rgw_init_ioctx(dpp, static_cast<rgw::sal::RadosStore*>(store)->getRados()->get_rados_handle(), search_info.pool, ioctx);
+  if (ret < 0) {
+    ldpp_dout(dpp, -1) << __func__ << ": rgw_init_ioctx() returned ret=" << ret << dendl;
+    return ret;
+  }
+
+  ioctx.set_namespace(librados::all_nspaces);
+
+  /* list the pool in slices, each by its own thread; the entries of all the
+   * slices go to the same (hash sharded) index, so the order they are found
+   * in does not matter
+   */
+  const int num_slices = std::max<int>(1, max_concurrent_ios);
+  const librados::ObjectCursor begin = ioctx.object_list_begin();
+  const librados::ObjectCursor end = ioctx.object_list_end();
+  std::atomic<uint64_t> total = 0;
+  std::vector<int> rets(num_slices, 0);
+
+  cout << "logging all objects in the pool" << std::endl;
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_slices);
+  for (int n = 0; n < num_slices; ++n) {
+    threads.emplace_back([&, n] {
+      rets[n] = build_all_oids_slice(dpp, ioctx, begin, end, n, num_slices, total);
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (auto r : rets) {
+    if (r < 0) {
+      return r;
+    }
+  }
+
   return 0;
 }
 
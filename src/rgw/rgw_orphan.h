@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "common/config.h"
 #include "common/Formatter.h"
 #include "common/errno.h"
@@ -171,6 +173,10 @@ class RGWOrphanSearch {
   };
 
   int log_oids(const DoutPrefixProvider *dpp, std::map<int, std::string>& log_shards, std::map<int, std::list<std::string> >& oids);
+  int build_all_oids_slice(const DoutPrefixProvider *dpp, librados::IoCtx& ioctx,
+                           const librados::ObjectCursor& begin,
+                           const librados::ObjectCursor& end,
+                           int n, int m, std::atomic<uint64_t>& total);
 
 #define RGW_ORPHANSEARCH_HASH_PRIME 7877
   int orphan_shard(const std::string& str) {
@@ -67,6 +67,19 @@ protected:
     }
   };
 
+  /* re-arm the async refresh of an entry whose refresh failed */
+  class StatsAsyncRefreshRetry : public lru_map<T, RGWQuotaCacheStats>::UpdateContext {
+  public:
+    bool update(RGWQuotaCacheStats *entry) override {
+      if (entry->async_refresh_time.sec() != 0)
+        return false;
+
+      entry->async_refresh_time = ceph_clock_now();
+
+      return true;
+    }
+  };
+
   virtual int fetch_stats_from_storage(const rgw_owner& owner, const rgw_bucket& bucket, RGWStorageStats& stats, optional_yield y, const DoutPrefixProvider *dpp) = 0;
 
   virtual bool map_find(const rgw_owner& owner, const rgw_bucket& bucket, RGWQuotaCacheStats& qs) = 0;
@@ -108,13 +121,23 @@ int RGWQuotaCache<T>::async_refresh(const rgw_owner& owner, const rgw_bucket& bu
     return 0;
   }
 
-  return init_refresh(owner, bucket, async_refcount);
+  int r = init_refresh(owner, bucket, async_refcount);
+  if (r < 0) {
+    /* no refresh is in flight, let the next lookup try again */
+    StatsAsyncRefreshRetry retry;
+    map_find_and_update(owner, bucket, &retry);
+  }
+  return r;
 }
 
 template<class T>
 void RGWQuotaCache<T>::async_refresh_fail(const rgw_owner& owner, rgw_bucket& bucket)
 {
   ldout(driver->ctx(), 20) << "async stats refresh response for bucket=" << bucket << dendl;
+
+  /* the next lookup may try again */
+  StatsAsyncRefreshRetry retry;
+  map_find_and_update(owner, bucket, &retry);
 }
 
 template<class T>
@@ -159,6 +182,19 @@ int RGWQuotaCache<T>::get_stats(const rgw_owner& owner, const rgw_bucket& bucket
       stats = qs.stats;
       return 0;
     }
+
+    /* serve stale stats for a while, rather than stalling this request,
+     * as long as a background refresh is under way */
+    RGWQuotaCacheStats cur;
+    if (map_find(owner, bucket, cur) &&
+        rgw_quota_stale_stats_usable(driver->ctx()->_conf, qs.expiration,
+                                     cur.async_refresh_time.sec() == 0,
+                                     ceph_clock_now())) {
+      ldpp_dout(dpp, 20) << "using stale quota stats for bucket=" << bucket
+                         << " while they are refreshed" << dendl;
+      stats = cur.stats;
+      return 0;
+    }
   }
 
   int ret = fetch_stats_from_storage(owner, bucket, stats, y, dpp);
@@ -993,6 +1029,20 @@ void RGWQuotaHandler::free_handler(RGWQuotaHandler *handler)
 }
 
 
+bool rgw_quota_stale_stats_usable(const ConfigProxy& conf,
+                                  const utime_t& expiration,
+                                  bool refresh_in_flight,
+                                  const utime_t& now)
+{
+  if (!refresh_in_flight || conf->rgw_bucket_quota_ttl == 0 ||
+      conf->rgw_bucket_quota_stale_ttl <= 0) {
+    return false;
+  }
+  utime_t stale_expiration = expiration;
+  stale_expiration += conf->rgw_bucket_quota_stale_ttl;
+  return stale_expiration > now;
+}
+
 void rgw_apply_default_bucket_quota(RGWQuotaInfo& quota, const ConfigProxy& conf)
 {
   if (conf->rgw_bucket_default_quota_max_objects >= 0) {
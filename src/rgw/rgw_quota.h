@@ -45,3 +45,11 @@ public:
 void rgw_apply_default_bucket_quota(RGWQuotaInfo& quota, const ConfigProxy& conf);
 void rgw_apply_default_user_quota(RGWQuotaInfo& quota, const ConfigProxy& conf);
 void rgw_apply_default_account_quota(RGWQuotaInfo& quota, const ConfigProxy& conf);
+
+// whether cached quota stats that expired at @a expiration may still be
+// used at @a now, see rgw_bucket_quota_stale_ttl. only while a background
+// refresh of them is in flight
+bool rgw_quota_stale_stats_usable(const ConfigProxy& conf,
+                                  const utime_t& expiration,
+                                  bool refresh_in_flight,
+                                  const utime_t& now);
@@ -771,9 +771,7 @@ void dump_range(req_state* const s,
 }
 
 
-int dump_body(req_state* const s,
-              const char* const buf,
-              const size_t len)
+static void account_body(req_state* const s, const size_t len)
 {
   bool healthcheck = false;
   // we dont want to limit health checks
@@ -785,6 +783,13 @@ int dump_body(req_state* const s,
     if(!rgw::sal::Bucket::empty(s->bucket.get()))
       s->ratelimit_data->decrease_bytes(method, s->ratelimit_bucket_marker, len, &s->bucket_ratelimit);
   }
+}
+
+int dump_body(req_state* const s,
+              const char* const buf,
+              const size_t len)
+{
+  account_body(s, len);
   try {
     return RESTFUL_IO(s)->send_body(buf, len);
   } catch (rgw::io::Exception& e) {
@@ -792,9 +797,20 @@ int dump_body(req_state* const s,
   }
 }
 
+int dump_body(req_state* const s, const ceph::buffer::list& bl,
+              const size_t ofs, const size_t len)
+{
+  account_body(s, len);
+  try {
+    return RESTFUL_IO(s)->send_body_list(bl, ofs, len);
+  } catch (rgw::io::Exception& e) {
+    return -e.code().value();
+  }
+}
+
 int dump_body(req_state* const s, /* const */ ceph::buffer::list& bl)
 {
-  return dump_body(s, bl.c_str(), bl.length());
+  return dump_body(s, bl, 0, bl.length());
 }
 
 int dump_body(req_state* const s, const std::string& str)
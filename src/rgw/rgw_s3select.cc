@@ -378,10 +378,8 @@ int RGWSelectObj_ObjStore_S3::get_params(optional_yield y)
   return RGWGetObj_ObjStore_S3::get_params(y);
 }
 
-int RGWSelectObj_ObjStore_S3::run_s3select_on_csv(const char* query, const char* input, size_t input_length)
+int RGWSelectObj_ObjStore_S3::init_s3select_on_csv(const char* query)
 {
-  int status = 0;
-  uint32_t length_before_processing, length_post_processing;
   csv_object::csv_defintions csv;
 
   s3select_syntax.parse_query(query);
@@ -433,6 +431,19 @@ int RGWSelectObj_ObjStore_S3::run_s3select_on_csv(const char* query, const char*
     ldpp_dout(this, 10) << "s3-select query: failed to prase the following query {" << query << "}" << dendl;
     ldpp_dout(this, 10) << "s3-select query: syntax-error {" << s3select_syntax.get_error_description() << "}" << dendl;
     return -1;
+  }
+  m_csv_query_ready = true;
+  return 0;
+}
+
+int RGWSelectObj_ObjStore_S3::run_s3select_on_csv(const char* query, const char* input, size_t input_length)
+{
+  int status = 0;
+  uint32_t length_before_processing, length_post_processing;
+
+  //the query and the csv definitions are set up once per request, not per chunk
+  if (!m_csv_query_ready && init_s3select_on_csv(query) < 0) {
+    return -1;
   } else {
     if (input == nullptr) {
       input = "";
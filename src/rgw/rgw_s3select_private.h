@@ -189,6 +189,7 @@ private:
   std::string m_s3select_input;
   std::string m_s3select_output;
   s3selectEngine::csv_object m_s3_csv_object;
+  bool m_csv_query_ready{false};
 #ifdef _ARROW_EXIST
   s3selectEngine::parquet_object m_s3_parquet_object;
 #endif
@@ -263,6 +264,8 @@ private:
 
   int json_processing(bufferlist& bl, off_t ofs, off_t len);
 
+  int init_s3select_on_csv(const char* query);
+
   int run_s3select_on_csv(const char* query, const char* input, size_t input_length);
 
   int run_s3select_on_parquet(const char* query);
@@ -1538,6 +1538,13 @@ public:
       }
   };
 
+  /** Entry of a bucket's lifecycle time index: the object @a key has a
+   * lifecycle action that falls due at @a due. */
+  struct LCTimeIndexEntry {
+    ceph::real_time due;
+    std::string key;
+  };
+
   Lifecycle() = default;
   virtual ~Lifecycle() = default;
 
@@ -1564,6 +1571,26 @@ public:
   virtual std::unique_ptr<LCSerializer> get_serializer(const std::string& lock_name,
 						       const std::string& oid,
 						       const std::string& cookie) = 0;
+
+  /** Add entries to the time index stored in @a oid */
+  virtual int add_time_index_entries(const DoutPrefixProvider* dpp,
+				     const std::string& oid,
+				     const std::vector<LCTimeIndexEntry>& entries,
+				     optional_yield y) = 0;
+  /** List the entries of the time index in @a oid that are due by @a end */
+  virtual int list_time_index(const DoutPrefixProvider* dpp,
+			      const std::string& oid,
+			      const ceph::real_time& end,
+			      const std::string& marker, uint32_t max_entries,
+			      std::vector<LCTimeIndexEntry>& entries,
+			      std::string* out_marker, bool* truncated,
+			      optional_yield y) = 0;
+  /** Remove the entries of the time index in @a oid up to and including
+   * @a to_marker */
+  virtual int trim_time_index(const DoutPrefixProvider* dpp,
+			      const std::string& oid,
+			      const std::string& to_marker,
+			      optional_yield y) = 0;
 };
 
 /**
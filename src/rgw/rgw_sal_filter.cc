@@ -1421,6 +1421,35 @@ std::unique_ptr<LCSerializer> FilterLifecycle::get_serializer(
   return std::make_unique<FilterLCSerializer>(std::move(ns));
 }
 
+int FilterLifecycle::add_time_index_entries(const DoutPrefixProvider* dpp,
+					    const std::string& oid,
+					    const std::vector<LCTimeIndexEntry>& entries,
+					    optional_yield y)
+{
+  return next->add_time_index_entries(dpp, oid, entries, y);
+}
+
+int FilterLifecycle::list_time_index(const DoutPrefixProvider* dpp,
+				     const std::string& oid,
+				     const ceph::real_time& end,
+				     const std::string& marker,
+				     uint32_t max_entries,
+				     std::vector<LCTimeIndexEntry>& entries,
+				     std::string* out_marker, bool* truncated,
+				     optional_yield y)
+{
+  return next->list_time_index(dpp, oid, end, marker, max_entries, entries,
+			       out_marker, truncated, y);
+}
+
+int FilterLifecycle::trim_time_index(const DoutPrefixProvider* dpp,
+				     const std::string& oid,
+				     const std::string& to_marker,
+				     optional_yield y)
+{
+  return next->trim_time_index(dpp, oid, to_marker, y);
+}
+
 int FilterNotification::publish_reserve(const DoutPrefixProvider *dpp,
 					RGWObjTags* obj_tags)
 {
@@ -1013,6 +1013,21 @@ public:
   virtual std::unique_ptr<LCSerializer> get_serializer(const std::string& lock_name,
 						       const std::string& oid,
 						       const std::string& cookie) override;
+  virtual int add_time_index_entries(const DoutPrefixProvider* dpp,
+				     const std::string& oid,
+				     const std::vector<LCTimeIndexEntry>& entries,
+				     optional_yield y) override;
+  virtual int list_time_index(const DoutPrefixProvider* dpp,
+			      const std::string& oid,
+			      const ceph::real_time& end,
+			      const std::string& marker, uint32_t max_entries,
+			      std::vector<LCTimeIndexEntry>& entries,
+			      std::string* out_marker, bool* truncated,
+			      optional_yield y) override;
+  virtual int trim_time_index(const DoutPrefixProvider* dpp,
+			      const std::string& oid,
+			      const std::string& to_marker,
+			      optional_yield y) override;
 };
 
 class FilterNotification : public Notification {
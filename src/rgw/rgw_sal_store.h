@@ -492,6 +492,28 @@ public:
       return std::make_unique<StoreLCEntry>();
   }
   using Lifecycle::get_entry;
+
+  virtual int add_time_index_entries(const DoutPrefixProvider* dpp,
+				     const std::string& oid,
+				     const std::vector<LCTimeIndexEntry>& entries,
+				     optional_yield y) override {
+    return -EOPNOTSUPP;
+  }
+  virtual int list_time_index(const DoutPrefixProvider* dpp,
+			      const std::string& oid,
+			      const ceph::real_time& end,
+			      const std::string& marker, uint32_t max_entries,
+			      std::vector<LCTimeIndexEntry>& entries,
+			      std::string* out_marker, bool* truncated,
+			      optional_yield y) override {
+    return -EOPNOTSUPP;
+  }
+  virtual int trim_time_index(const DoutPrefixProvider* dpp,
+			      const std::string& oid,
+			      const std::string& to_marker,
+			      optional_yield y) override {
+    return -EOPNOTSUPP;
+  }
 };
 
 class StoreNotification : public Notification {
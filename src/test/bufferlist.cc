@@ -23,6 +23,8 @@
 #include <errno.h>
 #include <sys/uio.h>
 
+#include <thread>
+
 #include "include/buffer.h"
 #include "include/buffer_raw.h"
 #include "include/compat.h"
@@ -3018,6 +3020,32 @@ TEST(BufferList, TestIsProvidedBuffer) {
   ASSERT_FALSE(bl.is_provided_buffer(buff));
 }
 
+TEST(BufferList, PtrNodeCacheAcrossThreads) {
+  // nodes built on one thread and released on another end up in the
+  // releasing thread's cache; both must keep working.
+  bufferptr bp(buffer::create(16));
+  bp.zero();
+  bufferlist produced;
+  for (unsigned i = 0; i < 1000; ++i) {
+    produced.push_back(bufferptr(bp, 0, 16));
+  }
+  std::thread consumer([&produced, &bp] {
+    bufferlist bl = std::move(produced);
+    ASSERT_EQ(1000u, bl.get_num_buffers());
+    bl.clear();
+    for (unsigned i = 0; i < 1000; ++i) {
+      bl.push_back(bufferptr(bp, 0, 16));
+    }
+    ASSERT_EQ(16000u, bl.length());
+  });
+  consumer.join();
+  bufferlist bl;
+  for (unsigned i = 0; i < 1000; ++i) {
+    bl.push_back(bufferptr(bp, i % 16, 1));
+  }
+  ASSERT_EQ(1000u, bl.length());
+}
+
 TEST(BufferList, DISABLED_DanglingLastP) {
   bufferlist bl;
   {
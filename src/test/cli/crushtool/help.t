@@ -100,6 +100,10 @@
         [--simulate]       simulate placements using a random
                            number generator in place of the CRUSH
                            algorithm
+     -i mapfn --bench      time the mappings --test would compute,
+                           with the --test parameters
+        [--bench-threads n[,n...]]
+                           with each of these numbers of threads
      --show-utilization    show OSD usage
      --show-utilization-all
                            include zero weight items
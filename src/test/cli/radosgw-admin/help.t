@@ -36,6 +36,7 @@
     bucket check                     check bucket index by verifying size and object count stats
     bucket check olh                 check for olh index entries and objects that are pending removal
     bucket check unlinked            check for object versions that are not visible in a bucket listing 
+    bucket prefix stats              show object count and size under --prefix, grouped by --delimiter
     bucket chown                     link bucket to specified user and update its object ACLs
     bucket reshard                   reshard bucket
     bucket rewrite                   rewrite all objects in the specified bucket
@@ -140,6 +140,124 @@ TEST_F(TestCls2PCQueue, AsyncReserve)
   }
 }
 
+TEST_F(TestCls2PCQueue, ReserveBatch)
+{
+  const std::string queue_name = __PRETTY_FUNCTION__;
+  const auto max_size = 1024U*1024U;
+  constexpr auto number_of_ops = 10U;
+  constexpr auto number_of_elements = 23U;
+  const auto size_to_reserve = 250U;
+  librados::ObjectWriteOperation wop;
+  wop.create(true);
+  cls_2pc_queue_init(wop, queue_name, max_size);
+  ASSERT_EQ(0, ioctx.operate(queue_name, &wop));
+
+  const std::vector<uint64_t> sizes(number_of_ops, size_to_reserve);
+  bufferlist res_bl;
+  int res_rc;
+  cls_2pc_queue_reserve_batch(wop, sizes, number_of_elements, &res_bl, &res_rc);
+  ASSERT_EQ(0, ioctx.operate(queue_name, &wop, librados::OPERATION_RETURNVEC));
+  ASSERT_EQ(res_rc, 0);
+  std::vector<int> results;
+  std::vector<cls_2pc_reservation::id_t> res_ids;
+  ASSERT_EQ(0, cls_2pc_queue_reserve_batch_result(res_bl, results, res_ids));
+  ASSERT_EQ(results.size(), number_of_ops);
+  ASSERT_EQ(res_ids.size(), number_of_ops);
+  for (auto i = 0U; i < number_of_ops; ++i) {
+    ASSERT_EQ(results[i], 0);
+    ASSERT_EQ(res_ids[i], i+1);
+  }
+
+  cls_2pc_reservations reservations;
+  ASSERT_EQ(0, cls_2pc_queue_list_reservations(ioctx, queue_name, reservations));
+  ASSERT_EQ(reservations.size(), number_of_ops);
+
+  // every reservation of the batch is committed on its own
+  for (const auto res_id : res_ids) {
+    std::vector<bufferlist> data(1);
+    data[0].append(std::string(size_to_reserve, 'a'));
+    librados::ObjectWriteOperation op;
+    cls_2pc_queue_commit(op, data, res_id);
+    ASSERT_EQ(0, ioctx.operate(queue_name, &op));
+  }
+  ASSERT_EQ(0, cls_2pc_queue_list_reservations(ioctx, queue_name, reservations));
+  ASSERT_EQ(reservations.size(), 0);
+}
+
+TEST_F(TestCls2PCQueue, ReserveBatchError)
+{
+  const std::string queue_name = __PRETTY_FUNCTION__;
+  const auto max_size = 256U*1024U;
+  const auto number_of_ops = 254U;
+  const auto number_of_elements = 1U;
+  const auto size_to_reserve = 1024U;
+  librados::ObjectWriteOperation op;
+  op.create(true);
+  cls_2pc_queue_init(op, queue_name, max_size);
+  ASSERT_EQ(0, ioctx.operate(queue_name, &op));
+
+  // the last one exceeds the queue size, the one after it reserves 0 bytes
+  std::vector<uint64_t> sizes(number_of_ops, size_to_reserve);
+  sizes.push_back(0);
+  bufferlist res_bl;
+  int res_rc;
+  cls_2pc_queue_reserve_batch(op, sizes, number_of_elements, &res_bl, &res_rc);
+  ASSERT_EQ(0, ioctx.operate(queue_name, &op, librados::OPERATION_RETURNVEC));
+  ASSERT_EQ(res_rc, 0);
+  std::vector<int> results;
+  std::vector<cls_2pc_reservation::id_t> res_ids;
+  ASSERT_EQ(0, cls_2pc_queue_reserve_batch_result(res_bl, results, res_ids));
+  ASSERT_EQ(results.size(), number_of_ops+1);
+  for (auto i = 0U; i < number_of_ops-1; ++i) {
+    ASSERT_EQ(results[i], 0);
+    ASSERT_NE(res_ids[i], cls_2pc_reservation::NO_ID);
+  }
+  ASSERT_EQ(results[number_of_ops-1], -ENOSPC);
+  ASSERT_EQ(res_ids[number_of_ops-1], cls_2pc_reservation::NO_ID);
+  ASSERT_EQ(results[number_of_ops], -EINVAL);
+  ASSERT_EQ(res_ids[number_of_ops], cls_2pc_reservation::NO_ID);
+
+  cls_2pc_reservations reservations;
+  ASSERT_EQ(0, cls_2pc_queue_list_reservations(ioctx, queue_name, reservations));
+  ASSERT_EQ(reservations.size(), number_of_ops-1);
+}
+
+TEST_F(TestCls2PCQueue, ReserveBatchSpillover)
+{
+  const std::string queue_name = __PRETTY_FUNCTION__;
+  const auto max_size = 1024U*1024U;
+  const auto number_of_batches = 16U;
+  const auto batch_size = 64U;
+  const auto number_of_elements = 8U;
+  const auto size_to_reserve = 64U;
+  librados::ObjectWriteOperation op;
+  op.create(true);
+  cls_2pc_queue_init(op, queue_name, max_size);
+  ASSERT_EQ(0, ioctx.operate(queue_name, &op));
+
+  const std::vector<uint64_t> sizes(batch_size, size_to_reserve);
+  for (auto i = 0U; i < number_of_batches; ++i) {
+    bufferlist res_bl;
+    int res_rc;
+    cls_2pc_queue_reserve_batch(op, sizes, number_of_elements, &res_bl, &res_rc);
+    ASSERT_EQ(0, ioctx.operate(queue_name, &op, librados::OPERATION_RETURNVEC));
+    ASSERT_EQ(res_rc, 0);
+    std::vector<int> results;
+    std::vector<cls_2pc_reservation::id_t> res_ids;
+    ASSERT_EQ(0, cls_2pc_queue_reserve_batch_result(res_bl, results, res_ids));
+    for (const auto r : results) {
+      ASSERT_EQ(r, 0);
+    }
+  }
+  cls_2pc_reservations reservations;
+  ASSERT_EQ(0, cls_2pc_queue_list_reservations(ioctx, queue_name, reservations));
+  ASSERT_EQ(reservations.size(), number_of_batches*batch_size);
+  for (const auto& r : reservations) {
+      ASSERT_NE(r.first, cls_2pc_reservation::NO_ID);
+      ASSERT_GT(r.second.timestamp.time_since_epoch().count(), 0);
+  }
+}
+
 TEST_F(TestCls2PCQueue, Commit)
 {
   const std::string queue_name = __PRETTY_FUNCTION__;
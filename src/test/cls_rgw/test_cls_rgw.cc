@@ -783,6 +783,73 @@ static bool cmp_objs(cls_rgw_obj& obj1, cls_rgw_obj& obj2)
 }
 
 
+TEST_F(cls_rgw, bucket_prefix_stats)
+{
+  string bucket_oid = "prefix_stats_bucket";
+
+  ObjectWriteOperation op;
+  cls_rgw_bucket_init_index(op);
+  ASSERT_EQ(0, ioctx.operate(bucket_oid, &op));
+
+  const uint64_t obj_size = 1024;
+  const std::vector<std::string> names = {
+    "a/1", "a/2", "a/3", "a/4", "a/b/1", "a/b/2", "c/1", "top", "об'єкт/1"
+  };
+  uint64_t epoch = 1;
+  for (const auto& name : names) {
+    cls_rgw_obj_key obj{name};
+    string tag = "tag-" + name;
+    string loc = "loc";
+    index_prepare(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, obj, loc);
+
+    rgw_bucket_dir_entry_meta meta;
+    meta.category = RGWObjCategory::Main;
+    meta.size = obj_size;
+    index_complete(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, epoch, obj, meta);
+  }
+
+  // scan few entries per call, so that the results span several calls
+  for (uint32_t max_entries : {2u, 1000u}) {
+    std::map<std::string, rgw_bucket_category_stats> stats;
+    ASSERT_EQ(0, cls_rgw_bucket_prefix_stats(ioctx, bucket_oid, "", "/",
+                                             max_entries, &stats));
+    ASSERT_EQ(4u, stats.size());
+    EXPECT_EQ(6u, stats["a/"].num_entries);
+    EXPECT_EQ(6 * obj_size, stats["a/"].total_size);
+    EXPECT_EQ(1u, stats["c/"].num_entries);
+    EXPECT_EQ(1u, stats["об'єкт/"].num_entries);
+    EXPECT_EQ(1u, stats[""].num_entries); // "top"
+
+    stats.clear();
+    ASSERT_EQ(0, cls_rgw_bucket_prefix_stats(ioctx, bucket_oid, "a/", "/",
+                                             max_entries, &stats));
+    ASSERT_EQ(2u, stats.size());
+    EXPECT_EQ(4u, stats["a/"].num_entries);
+    EXPECT_EQ(2u, stats["a/b/"].num_entries);
+
+    stats.clear();
+    ASSERT_EQ(0, cls_rgw_bucket_prefix_stats(ioctx, bucket_oid, "a/", "",
+                                             max_entries, &stats));
+    ASSERT_EQ(1u, stats.size());
+    EXPECT_EQ(6u, stats["a/"].num_entries);
+  }
+
+  // removed objects are no longer accounted
+  {
+    cls_rgw_obj_key obj{"a/b/1"};
+    string tag = "tag-rm";
+    string loc = "loc";
+    index_prepare(ioctx, bucket_oid, CLS_RGW_OP_DEL, tag, obj, loc);
+    rgw_bucket_dir_entry_meta meta;
+    index_complete(ioctx, bucket_oid, CLS_RGW_OP_DEL, tag, ++epoch, obj, meta);
+  }
+  std::map<std::string, rgw_bucket_category_stats> stats;
+  ASSERT_EQ(0, cls_rgw_bucket_prefix_stats(ioctx, bucket_oid, "a/b/", "/",
+                                           1000, &stats));
+  ASSERT_EQ(1u, stats.size());
+  EXPECT_EQ(1u, stats["a/b/"].num_entries);
+}
+
 TEST_F(cls_rgw, gc_set)
 {
   /* add chains */
@@ -1340,3 +1407,108 @@ TEST_F(cls_rgw, index_racing_removes)
 
   test_stats(ioctx, bucket_oid, RGWObjCategory::None, 0, 0);
 }
+
+TEST_F(cls_rgw, index_bulk_ops)
+{
+  string bucket_oid = str_int("bucket", 9);
+
+  ObjectWriteOperation op;
+  cls_rgw_bucket_init_index(op);
+  ASSERT_EQ(0, ioctx.operate(bucket_oid, &op));
+
+  const uint64_t obj_size = 1024;
+  auto prepare_all = [&] (RGWModifyOp index_op) {
+    vector<rgw_cls_obj_prepare_op> ops(NUM_OBJS);
+    for (int i = 0; i < NUM_OBJS; i++) {
+      ops[i].op = index_op;
+      ops[i].key = str_int("obj", i);
+      ops[i].tag = str_int("tag", i);
+      ops[i].log_op = true;
+    }
+    return ops;
+  };
+  auto complete_all = [&] (RGWModifyOp index_op, int epoch) {
+    vector<rgw_cls_obj_complete_op> ops(NUM_OBJS);
+    for (int i = 0; i < NUM_OBJS; i++) {
+      ops[i].op = index_op;
+      ops[i].key = str_int("obj", i);
+      ops[i].tag = str_int("tag", i);
+      ops[i].ver.pool = ioctx.get_id();
+      ops[i].ver.epoch = epoch;
+      ops[i].meta.category = RGWObjCategory::None;
+      ops[i].meta.size = ops[i].meta.accounted_size = obj_size;
+      ops[i].log_op = true;
+    }
+    return ops;
+  };
+
+  // add them all in two calls
+  {
+    ObjectWriteOperation op;
+    cls_rgw_bucket_prepare_ops(op, prepare_all(CLS_RGW_OP_ADD));
+    ASSERT_EQ(0, ioctx.operate(bucket_oid, &op));
+  }
+  test_stats(ioctx, bucket_oid, RGWObjCategory::None, 0, 0);
+  {
+    ObjectWriteOperation op;
+    cls_rgw_bucket_complete_ops(op, complete_all(CLS_RGW_OP_ADD, 1));
+    ASSERT_EQ(0, ioctx.operate(bucket_oid, &op));
+  }
+  test_stats(ioctx, bucket_oid, RGWObjCategory::None, NUM_OBJS,
+	     obj_size * NUM_OBJS);
+  {
+    // one bilog entry per op, each with its own id
+    cls_rgw_bi_log_list_ret bilog;
+    ASSERT_EQ(0, bilog_list(ioctx, bucket_oid, &bilog));
+    ASSERT_EQ((size_t)NUM_OBJS, bilog.entries.size());
+    set<string> ids;
+    for (auto& e : bilog.entries) {
+      EXPECT_EQ(CLS_RGW_OP_ADD, e.op);
+      ids.insert(e.id);
+    }
+    EXPECT_EQ((size_t)NUM_OBJS, ids.size());
+  }
+
+  // a key twice in a batch is rejected, and nothing is applied
+  {
+    auto ops = prepare_all(CLS_RGW_OP_DEL);
+    ops.push_back(ops.front());
+    ObjectWriteOperation op;
+    cls_rgw_bucket_prepare_ops(op, ops);
+    ASSERT_EQ(-EINVAL, ioctx.operate(bucket_oid, &op));
+  }
+  // as is a batch with an op that fails: this tag was never prepared
+  {
+    auto ops = complete_all(CLS_RGW_OP_DEL, 2);
+    ObjectWriteOperation op;
+    cls_rgw_bucket_complete_ops(op, ops);
+    ASSERT_EQ(-EINVAL, ioctx.operate(bucket_oid, &op));
+  }
+  test_stats(ioctx, bucket_oid, RGWObjCategory::None, NUM_OBJS,
+	     obj_size * NUM_OBJS);
+
+  // delete them all
+  {
+    ObjectWriteOperation op;
+    cls_rgw_bucket_prepare_ops(op, prepare_all(CLS_RGW_OP_DEL));
+    ASSERT_EQ(0, ioctx.operate(bucket_oid, &op));
+  }
+  {
+    ObjectWriteOperation op;
+    cls_rgw_bucket_complete_ops(op, complete_all(CLS_RGW_OP_DEL, 2));
+    ASSERT_EQ(0, ioctx.operate(bucket_oid, &op));
+  }
+  test_stats(ioctx, bucket_oid, RGWObjCategory::None, 0, 0);
+  {
+    list<rgw_cls_bi_entry> entries;
+    bool truncated{false};
+    ASSERT_EQ(0, cls_rgw_bi_list(ioctx, bucket_oid, "", "", 128,
+                                 &entries, &truncated));
+    EXPECT_EQ(0u, entries.size());
+  }
+  {
+    cls_rgw_bi_log_list_ret bilog;
+    ASSERT_EQ(0, bilog_list(ioctx, bucket_oid, &bilog));
+    EXPECT_EQ((size_t)NUM_OBJS * 2, bilog.entries.size());
+  }
+}
@@ -22,11 +22,13 @@
 #include <stdio.h>
 #include <signal.h>
 
+#include <atomic>
 #include <chrono>
 #include <list>
 #include <mutex>
 #include <random>
 #include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "common/Thread.h"
@@ -212,6 +214,38 @@ TEST_F(ThrottleTest, wait) {
   } while(!waited);
 }
 
+TEST_F(ThrottleTest, concurrent) {
+  // the lock-free get() and put() must neither overshoot nor lose wakeups
+  const int64_t throttle_max = 16;
+  Throttle throttle(g_ceph_context, "throttle", throttle_max);
+  std::atomic<bool> overshot = false;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&, i] {
+      std::mt19937 rng(i);
+      for (int j = 0; j < 20000; ++j) {
+	const int64_t c = 1 + rng() % 4;
+	if (j % 3 == 0) {
+	  if (!throttle.get_or_fail(c)) {
+	    continue;
+	  }
+	} else {
+	  throttle.get(c);
+	}
+	if (throttle.get_current() > throttle_max) {
+	  overshot = true;
+	}
+	throttle.put(c);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_FALSE(overshot);
+  ASSERT_EQ(0, throttle.get_current());
+}
+
 std::pair<double, std::chrono::duration<double> > test_backoff(
   double low_threshhold,
   double high_threshhold,
@@ -306,3 +306,53 @@ TYPED_TEST(BitVectorTest, iterator) {
     ASSERT_EQ(offset % radix, *it);
   }
 }
+
+TYPED_TEST(BitVectorTest, get_set_elements) {
+  typename TestFixture::bit_vector_t bit_vector;
+
+  uint64_t radix = 1 << bit_vector.BIT_COUNT;
+  uint64_t size = 3 * 4096 + 7;
+
+  // create fragmented in-memory bufferlist layout
+  uint64_t resize = 0;
+  while (resize < size) {
+    resize = std::min(resize + 1021, size);
+    bit_vector.resize(resize);
+  }
+
+  for (uint64_t i = 0; i < size; ++i) {
+    bit_vector[i] = i % radix;
+  }
+
+  std::vector<uint8_t> elements(size);
+  bit_vector.get_elements(0, size, elements.data());
+  for (uint64_t i = 0; i < size; ++i) {
+    ASSERT_EQ(i % radix, elements[i]);
+  }
+
+  // unaligned sub-ranges
+  uint64_t offset = 3;
+  uint64_t length = size - 9;
+  bit_vector.get_elements(offset, length, elements.data());
+  for (uint64_t i = 0; i < length; ++i) {
+    ASSERT_EQ((offset + i) % radix, elements[i]);
+  }
+
+  for (uint64_t i = 0; i < length; ++i) {
+    elements[i] = (offset + i + 1) % radix;
+  }
+  bit_vector.set_elements(offset, length, elements.data());
+  for (uint64_t i = 0; i < size; ++i) {
+    if (i < offset || i >= offset + length) {
+      ASSERT_EQ(i % radix, bit_vector[i]);
+    } else {
+      ASSERT_EQ((i + 1) % radix, bit_vector[i]);
+    }
+  }
+
+  uint8_t element = radix - 1;
+  bit_vector.set_elements(1, 1, &element);
+  ASSERT_EQ(0U, bit_vector[0]);
+  ASSERT_EQ(radix - 1, bit_vector[1]);
+  ASSERT_EQ(2U % radix, bit_vector[2]);
+}
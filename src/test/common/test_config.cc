@@ -20,6 +20,7 @@
  *
  */
 #include "common/config_proxy.h"
+#include "common/config_snapshot.h"
 #include "common/errno.h"
 #include "gtest/gtest.h"
 #include "common/hostname.h"
@@ -260,6 +261,33 @@ TEST(md_config_t, set_val)
   }
 }
 
+TEST(md_config_t, snapshot)
+{
+  using namespace ceph::common;
+  ConfigProxy conf{false};
+  static_assert(std::is_same_v<
+    ConfigSnapshot::value_type<option_id::mgr_osd_bytes>, Option::size_t>);
+  EXPECT_EQ(conf.get_val<Option::size_t>("mgr_osd_bytes"),
+	    conf.snapshot().get<option_id::mgr_osd_bytes>());
+  EXPECT_EQ(0, conf.set_val("mgr_osd_bytes", "512M", nullptr));
+  EXPECT_EQ(Option::size_t{512 << 20},
+	    conf.snapshot().get<option_id::mgr_osd_bytes>());
+  // metavariables are expanded
+  EXPECT_EQ(0, conf.set_val("admin_socket", "$run_dir/x"));
+  EXPECT_EQ(conf.get_val<std::string>("run_dir") + "/x",
+	    conf.snapshot().get<option_id::admin_socket>());
+  // an unchanged config keeps the same snapshot
+  auto* s = &conf.snapshot();
+  EXPECT_EQ(s, &conf.snapshot());
+  // snapshots of another ConfigProxy are kept apart
+  ConfigProxy other{false};
+  EXPECT_EQ(0, other.set_val("mgr_tick_period", "17"));
+  EXPECT_EQ(std::chrono::seconds(17),
+	    other.snapshot().get<option_id::mgr_tick_period>());
+  EXPECT_EQ(conf.get_val<std::chrono::seconds>("mgr_tick_period"),
+	    conf.snapshot().get<option_id::mgr_tick_period>());
+}
+
 TEST(Option, validation)
 {
   Option opt_int("foo", Option::TYPE_INT, Option::LEVEL_BASIC);
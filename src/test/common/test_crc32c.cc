@@ -271,6 +271,20 @@ TEST(Crc32c, RangeNull) {
   }
 }
 
+TEST(Crc32c, Combine) {
+  unsigned len = 1 << 16;
+  unsigned char *a = (unsigned char *)malloc(len);
+  for (unsigned i = 0; i < len; i++)
+    a[i] = i * 7 + (i >> 8);
+  uint32_t whole = ceph_crc32c(1234, a, len);
+  for (unsigned split : {0u, 1u, 15u, 16u, 4096u, len / 3, len}) {
+    uint32_t crc_a = ceph_crc32c(1234, a, split);
+    uint32_t crc_b = ceph_crc32c(0, a + split, len - split);
+    ASSERT_EQ(whole, ceph_crc32c_combine(crc_a, crc_b, len - split));
+  }
+  free(a);
+}
+
 double estimate_clock_resolution()
 {
   volatile char* p = (volatile char*)malloc(1024);
@@ -0,0 +1,111 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "common/timer_wheel.h"
+
+namespace {
+struct entry : ceph::timer_wheel_hook {
+  int id = 0;
+};
+}
+
+TEST(TimerWheel, Basic)
+{
+  ceph::timer_wheel<entry> w;
+  entry a, b, c;
+  a.id = 1;
+  b.id = 2;
+  c.id = 3;
+  ASSERT_EQ(std::numeric_limits<uint64_t>::max(), w.next_tick());
+  w.add(a, 10);
+  w.add(b, 1000);
+  w.add(c, 5);
+  ASSERT_LE(w.next_tick(), 5u);
+  w.advance(4);
+  ASSERT_EQ(nullptr, w.pop_expired());
+  w.advance(10);
+  ASSERT_EQ(&c, w.pop_expired());
+  ASSERT_EQ(&a, w.pop_expired());
+  ASSERT_EQ(nullptr, w.pop_expired());
+  ASSERT_TRUE(b.is_scheduled());
+  b.cancel();
+  ASSERT_FALSE(b.is_scheduled());
+  w.advance(2000);
+  ASSERT_EQ(nullptr, w.pop_expired());
+  {
+    entry d;
+    w.add(d, 3000);
+  }
+  // the destroyed entry unlinked itself
+  w.advance(4000);
+  ASSERT_EQ(nullptr, w.pop_expired());
+  // already due
+  w.add(a, 100);
+  ASSERT_EQ(w.get_now(), w.next_tick());
+  ASSERT_EQ(&a, w.pop_expired());
+}
+
+TEST(TimerWheel, Random)
+{
+  std::mt19937_64 rng(42);
+  constexpr int n = 20000;
+  for (int round = 0; round < 10; ++round) {
+    ceph::timer_wheel<entry> w(rng() % (1ull << 40));
+    uint64_t now = w.get_now();
+    std::vector<std::unique_ptr<entry>> es(n);
+    for (int i = 0; i < n; ++i) {
+      es[i] = std::make_unique<entry>();
+      es[i]->id = i;
+    }
+    std::map<int, uint64_t> pending;
+    int next = 0;
+    for (int step = 0; step < n; ++step) {
+      const int op = rng() % 10;
+      if (op < 5 && next < n) {
+	uint64_t delta;
+	switch (rng() % 4) {
+	case 0: delta = rng() % 300; break;
+	case 1: delta = rng() % 20000; break;
+	case 2: delta = rng() % (1ull << 26); break;
+	default: delta = rng() % (1ull << 34); break;
+	}
+	w.add(*es[next], now + delta);
+	pending[next] = now + delta;
+	++next;
+      } else if (op < 7 && !pending.empty()) {
+	auto p = pending.begin();
+	std::advance(p, rng() % pending.size());
+	es[p->first]->cancel();
+	pending.erase(p);
+      } else {
+	now += rng() % 4 == 0 ? rng() % (1ull << 30) : rng() % 1000;
+	w.advance(now);
+	uint64_t last = 0;
+	while (entry *e = w.pop_expired()) {
+	  // in expiry order, and never early
+	  ASSERT_LE(last, e->get_expires());
+	  last = e->get_expires();
+	  auto p = pending.find(e->id);
+	  ASSERT_NE(p, pending.end());
+	  ASSERT_LE(p->second, now);
+	  pending.erase(p);
+	}
+	uint64_t first = std::numeric_limits<uint64_t>::max();
+	for (auto& [id, expires] : pending) {
+	  // nothing missed
+	  ASSERT_GT(expires, now);
+	  first = std::min(first, expires);
+	}
+	ASSERT_LE(w.next_tick(), first);
+      }
+    }
+  }
+}
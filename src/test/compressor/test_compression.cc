@@ -388,6 +388,39 @@ INSTANTIATE_TEST_SUITE_P(
 #endif
     "zstd"));
 
+TEST(ZstdCompressor, dictionary)
+{
+  CompressorRef zstd = Compressor::create(g_ceph_context, "zstd");
+  if (!zstd) {
+    // skip the test if the plugin is not ready
+    return;
+  }
+  bufferlist dict;
+  for (int i = 0; i < 64; ++i) {
+    dict.append("osd_op(client.4123.0:17 2.1f 2:f8e2a0b1:::rbd_data.1234.");
+  }
+  CompressorRef primed = zstd->with_dictionary(dict);
+  ASSERT_TRUE(primed);
+  ASSERT_EQ(zstd->get_type(), primed->get_type());
+
+  bufferlist orig;
+  orig.append("osd_op(client.4123.0:18 2.1f 2:f8e2a0b1:::rbd_data.1234.0042");
+  std::optional<int32_t> compressor_message;
+  bufferlist plain, compressed;
+  ASSERT_EQ(0, zstd->compress(orig, plain, compressor_message));
+  ASSERT_EQ(0, primed->compress(orig, compressed, compressor_message));
+  ASSERT_LT(compressed.length(), plain.length());
+
+  bufferlist decompressed;
+  ASSERT_EQ(0, primed->decompress(compressed, decompressed, compressor_message));
+  ASSERT_TRUE(decompressed.contents_equal(orig));
+
+  // the shared instance is left alone
+  decompressed.clear();
+  ASSERT_EQ(0, zstd->decompress(plain, decompressed, compressor_message));
+  ASSERT_TRUE(decompressed.contents_equal(orig));
+}
+
 #if defined(__x86_64__) || defined(__aarch64__)
 
 TEST(ZlibCompressor, zlib_isal_compatibility)
@@ -158,6 +158,128 @@ TEST(ErasureCodeTest, encode_misaligned_non_contiguous)
   }
 }
 
+// single parity chunk, the xor of the data chunks, computed either
+// from bufferlists or from raw pointers
+class ErasureCodeXorTest : public ErasureCodeTest {
+public:
+  bool with_encode_stripe;
+
+  ErasureCodeXorTest(unsigned int _k, unsigned int _chunk_size,
+		     bool _with_encode_stripe) :
+    ErasureCodeTest(_k, 1, _chunk_size),
+    with_encode_stripe(_with_encode_stripe) {}
+
+  int encode_chunks(const set<int> &want_to_encode,
+		    map<int, bufferlist> *encoded) override {
+    char *data[k];
+    for (unsigned int i = 0; i < k; i++)
+      data[i] = (*encoded)[i].c_str();
+    char *coding = (*encoded)[k].c_str();
+    xor_chunks(data, &coding, (*encoded)[0].length());
+    return 0;
+  }
+  int encode_stripe(const set<int> &want_to_encode,
+		    char **data,
+		    char **coding,
+		    unsigned int blocksize) override {
+    if (!with_encode_stripe)
+      return -EOPNOTSUPP;
+    for (unsigned int i = 0; i < k; i++)
+      EXPECT_EQ(0u, (uintptr_t)data[i] % ErasureCode::SIMD_ALIGN);
+    xor_chunks(data, coding, blocksize);
+    return 0;
+  }
+  void xor_chunks(char **data, char **coding, unsigned int blocksize) {
+    for (unsigned int j = 0; j < blocksize; j++) {
+      char c = 0;
+      for (unsigned int i = 0; i < k; i++)
+	c ^= data[i][j];
+      coding[0][j] = c;
+    }
+  }
+};
+
+TEST(ErasureCodeTest, encode_stripes)
+{
+  const unsigned int k = 3;
+  const unsigned chunk_size = ErasureCode::SIMD_ALIGN * 4;
+  const unsigned stripe_width = k * chunk_size;
+  const unsigned stripes = 5;
+
+  // a mix of aligned stripe sized fragments and misaligned ones
+  // straddling chunk boundaries
+  bufferlist in;
+  auto append = [&in](bufferptr&& ptr) {
+    for (unsigned i = 0; i < ptr.length(); i++)
+      ptr[i] = (char)((in.length() + i) * 7 + 3);
+    in.append(std::move(ptr));
+  };
+  {
+    bufferptr ptr(buffer::create_aligned(2 * stripe_width,
+					 ErasureCode::SIMD_ALIGN));
+    append(std::move(ptr));
+  }
+  {
+    bufferptr ptr(buffer::create_aligned(stripe_width + chunk_size,
+					 ErasureCode::SIMD_ALIGN));
+    ptr.set_offset(1);
+    ptr.set_length(stripe_width + chunk_size / 2 - 1);
+    append(std::move(ptr));
+  }
+  {
+    bufferptr ptr(buffer::create_aligned(2 * stripe_width,
+					 ErasureCode::SIMD_ALIGN));
+    ptr.set_length(2 * stripe_width - chunk_size / 2 + 1);
+    append(std::move(ptr));
+  }
+  ASSERT_EQ(stripes * stripe_width, in.length());
+  ASSERT_FALSE(in.is_contiguous());
+
+  set<int> want_to_encode;
+  for (unsigned int i = 0; i < k + 1; i++)
+    want_to_encode.insert(i);
+
+  map<int, bufferlist> expected;
+  {
+    ErasureCodeXorTest erasure_code(k, chunk_size, false);
+    for (unsigned s = 0; s < stripes; s++) {
+      bufferlist stripe;
+      stripe.substr_of(in, s * stripe_width, stripe_width);
+      map<int, bufferlist> encoded;
+      ASSERT_EQ(0, erasure_code.encode(want_to_encode, stripe, &encoded));
+      for (auto &[shard, chunk] : encoded)
+	expected[shard].claim_append(chunk);
+    }
+  }
+
+  for (bool with_encode_stripe : { false, true }) {
+    ErasureCodeXorTest erasure_code(k, chunk_size, with_encode_stripe);
+    map<int, bufferlist> encoded;
+    ASSERT_EQ(0, erasure_code.encode_stripes(want_to_encode, in,
+					     stripe_width, &encoded));
+    ASSERT_EQ(expected.size(), encoded.size());
+    for (auto &[shard, chunk] : expected) {
+      ASSERT_EQ(stripes * chunk_size, encoded[shard].length());
+      ASSERT_TRUE(chunk.contents_equal(encoded[shard])) << "shard " << shard;
+    }
+    if (with_encode_stripe) {
+      // the parity of all stripes is a single buffer
+      ASSERT_EQ(1u, encoded[k].get_num_buffers());
+    }
+  }
+
+  // only the wanted chunks are returned
+  {
+    ErasureCodeXorTest erasure_code(k, chunk_size, true);
+    set<int> want = { 0, (int)k };
+    map<int, bufferlist> encoded;
+    ASSERT_EQ(0, erasure_code.encode_stripes(want, in, stripe_width,
+					     &encoded));
+    ASSERT_EQ(2u, encoded.size());
+    ASSERT_TRUE(expected[k].contents_equal(encoded[k]));
+  }
+}
+
 /*
  * Local Variables:
  * compile-command: "cd ../.. ;
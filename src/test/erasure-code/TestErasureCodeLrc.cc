@@ -602,6 +602,52 @@ TEST(ErasureCodeLrc, minimum_to_decode)
   }
 }
 
+TEST(ErasureCodeLrc, minimum_to_decode_with_cost)
+{
+  ErasureCodeLrc lrc(g_conf().get_val<std::string>("erasure_code_dir"));
+  ErasureCodeProfile profile;
+  profile["mapping"] =
+    "__DDD__DD";
+  const char *description_string =
+    "[ "
+    "  [ \"_cDDD_cDD\", \"\" ],"
+    "  [ \"c_DDD____\", \"\" ],"
+    "  [ \"_____cDDD\", \"\" ],"
+    "]";
+  profile["layers"] = description_string;
+  EXPECT_EQ(0, lrc.init(profile, &cerr));
+  // all chunks are available except 2
+  map<int, int> available;
+  for (int i = 0; i < (int)lrc.get_chunk_count(); i++) {
+    if (i != 2)
+      available[i] = 1;
+  }
+  // the wanted chunk is available, read nothing else
+  {
+    set<int> want_to_read = {3};
+    set<int> minimum;
+    EXPECT_EQ(0, lrc.minimum_to_decode_with_cost(want_to_read, available, &minimum));
+    EXPECT_EQ(want_to_read, minimum);
+  }
+  // at equal costs, c_DDD____ recovers 2 from the fewest chunks
+  {
+    set<int> want_to_read = {2};
+    set<int> minimum;
+    EXPECT_EQ(0, lrc.minimum_to_decode_with_cost(want_to_read, available, &minimum));
+    set<int> expected_minimum = {0, 3, 4};
+    EXPECT_EQ(expected_minimum, minimum);
+  }
+  // when 0 is far away, five nearby chunks of _cDDD_cDD cost less
+  {
+    available[0] = 10;
+    set<int> want_to_read = {2};
+    set<int> minimum;
+    EXPECT_EQ(0, lrc.minimum_to_decode_with_cost(want_to_read, available, &minimum));
+    set<int> expected_minimum = {1, 3, 4, 6, 7};
+    EXPECT_EQ(expected_minimum, minimum);
+  }
+}
+
 TEST(ErasureCodeLrc, encode_decode)
 {
   ErasureCodeLrc lrc(g_conf().get_val<std::string>("erasure_code_dir"));
@@ -24,12 +24,24 @@
 #include <boost/program_options/parsers.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+
 #include "global/global_context.h"
 #include "global/global_init.h"
 #include "common/ceph_argparse.h"
 #include "common/ceph_context.h"
 #include "common/config.h"
 #include "common/Clock.h"
+#include "common/Cycles.h"
+#include "include/str_list.h"
+#include "common/strtol.h"
 #include "include/utime.h"
 #include "erasure-code/ErasureCodePlugin.h"
 #include "erasure-code/ErasureCode.h"
@@ -71,6 +83,21 @@ int ErasureCodeBench::setup(int argc, char** argv) {
      " the first chunk, then the second etc.)")
     ("parameter,P", po::value<vector<string> >(),
      "add a parameter to the erasure code profile")
+    ("threads,t", po::value<string>(),
+     "comma separated thread counts to run with, e.g. 1,2,4,8")
+    ("sizes", po::value<string>(),
+     "comma separated buffer sizes to encode, e.g. 4K,64K,1M")
+    ("stripe-units", po::value<string>(),
+     "comma separated stripe units; each encodes one stripe of k of them")
+    ("compare", po::value<vector<string> >(),
+     "plugin[,key=value...] to run as well as or instead of --plugin, on "
+     "top of the --parameter profile (repeat for more than one)")
+    ("erasure-matrix",
+     "decode every combination of --erasures erased chunks, a row each")
+    ("cold",
+     "rotate over buffers larger than the last level cache")
+    ("cpu-ghz", po::value<double>(),
+     "clock to convert cpu time to cycles/byte (default: the TSC rate)")
     ;
 
   po::variables_map vm;
@@ -149,6 +176,59 @@ int ErasureCodeBench::setup(int argc, char** argv) {
 
   verbose = vm.count("verbose") > 0 ? true : false;
 
+  // any of these produce a table instead of the single line of output
+  // that qa/workunits/erasure-code/bench.sh parses
+  auto parse_list = [](const string& s, const char *what,
+		       vector<uint64_t> *out) {
+    for (auto& v : get_str_vec(s, ",")) {
+      string err;
+      uint64_t n = strict_iecstrtoll(v, &err);
+      if (!err.empty() || n == 0) {
+	cerr << "bad " << what << " " << v << endl;
+	return -EINVAL;
+      }
+      out->push_back(n);
+    }
+    return 0;
+  };
+  if (vm.count("threads")) {
+    vector<uint64_t> t;
+    if (int r = parse_list(vm["threads"].as<string>(), "thread count", &t);
+	r < 0) {
+      return r;
+    }
+    threads.assign(t.begin(), t.end());
+    sweep = true;
+  }
+  if (vm.count("sizes")) {
+    if (int r = parse_list(vm["sizes"].as<string>(), "size", &sizes); r < 0) {
+      return r;
+    }
+    sweep = true;
+  }
+  if (vm.count("stripe-units")) {
+    if (int r = parse_list(vm["stripe-units"].as<string>(), "stripe unit",
+			   &stripe_units); r < 0) {
+      return r;
+    }
+    sweep = true;
+  }
+  if (vm.count("compare")) {
+    compare = vm["compare"].as<vector<string> >();
+    sweep = true;
+  }
+  if (vm.count("erasure-matrix")) {
+    erasure_matrix = true;
+    sweep = true;
+  }
+  if (vm.count("cold")) {
+    cold = true;
+    sweep = true;
+  }
+  if (vm.count("cpu-ghz")) {
+    cpu_ghz = vm["cpu-ghz"].as<double>();
+  }
+
   return 0;
 }
 
@@ -156,12 +236,256 @@ int ErasureCodeBench::run() {
   ErasureCodePluginRegistry &instance = ErasureCodePluginRegistry::instance();
   instance.disable_dlclose = true;
 
+  if (sweep)
+    return run_sweep();
   if (workload == "encode")
     return encode();
   else
     return decode();
 }
 
+static double thread_cpu_seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long cache_size(int name)
+{
+  long r = sysconf(name);
+  return r > 0 ? r : 0;
+}
+
+/// the smallest cache the data fits in: its share for each thread in
+/// the per core caches, all of it in the shared one
+static string cache_level(uint64_t per_thread, uint64_t total)
+{
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+  if (per_thread <= (uint64_t)cache_size(_SC_LEVEL1_DCACHE_SIZE))
+    return "L1";
+  if (per_thread <= (uint64_t)cache_size(_SC_LEVEL2_CACHE_SIZE))
+    return "L2";
+  if (total <= (uint64_t)cache_size(_SC_LEVEL3_CACHE_SIZE))
+    return "L3";
+  return "mem";
+#else
+  return "?";
+#endif
+}
+
+int ErasureCodeBench::sweep_one(ErasureCodeInterfaceRef erasure_code,
+				uint64_t size, int nthreads,
+				const set<int> *erased_chunks,
+				sweep_result *res)
+{
+  const unsigned chunk_count = erasure_code->get_chunk_count();
+  const uint64_t chunk_size = erasure_code->get_chunk_size(size);
+  // the input and every chunk, or the chunks and what is decoded
+  const uint64_t per_buffer = size + chunk_size * chunk_count;
+  unsigned nbuf = 1;
+  if (cold) {
+    uint64_t llc = 32 << 20;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    if (long l = cache_size(_SC_LEVEL3_CACHE_SIZE); l > 0)
+      llc = l;
+#endif
+    nbuf = std::max<uint64_t>(1, 2 * llc / (per_buffer * nthreads)) + 1;
+  }
+  res->working_set_per_thread = per_buffer * nbuf;
+
+  set<int> want;
+  for (unsigned i = 0; i < chunk_count; i++)
+    want.insert(i);
+
+  std::mutex lock;
+  std::condition_variable cond;
+  int ready = 0;
+  bool go = false;
+  std::atomic<int> error = 0;
+  std::atomic<uint64_t> cpu_ns = 0;
+  vector<std::thread> workers;
+  for (int t = 0; t < nthreads; t++) {
+    workers.emplace_back([&, t] {
+      // every thread has buffers of its own, as the OSD's would
+      vector<bufferlist> in(nbuf);
+      vector<map<int,bufferlist>> encoded(nbuf);
+      for (unsigned b = 0; b < nbuf; b++) {
+	in[b].append(string(size, 'X' + b % 8));
+	in[b].rebuild_aligned(ErasureCode::SIMD_ALIGN);
+	if (workload != "encode") {
+	  if (int r = erasure_code->encode(want, in[b], &encoded[b]); r)
+	    error = r;
+	}
+      }
+      std::minstd_rand rng(t);
+      {
+	std::unique_lock l{lock};
+	++ready;
+	cond.notify_all();
+	cond.wait(l, [&] { return go; });
+      }
+      const double cpu_start = thread_cpu_seconds();
+      for (int i = 0; i < max_iterations && !error; i++) {
+	const unsigned b = i % nbuf;
+	int r;
+	if (workload == "encode") {
+	  map<int,bufferlist> out;
+	  r = erasure_code->encode(want, in[b], &out);
+	} else {
+	  map<int,bufferlist> chunks = encoded[b];
+	  if (erased_chunks) {
+	    for (int c : *erased_chunks)
+	      chunks.erase(c);
+	  } else {
+	    for (int j = 0; j < erasures; j++) {
+	      int c;
+	      do {
+		c = rng() % chunk_count;
+	      } while (chunks.count(c) == 0);
+	      chunks.erase(c);
+	    }
+	  }
+	  map<int,bufferlist> decoded;
+	  r = erasure_code->decode(want, chunks, &decoded, 0);
+	}
+	if (r)
+	  error = r;
+      }
+      cpu_ns += (thread_cpu_seconds() - cpu_start) * 1e9;
+    });
+  }
+  utime_t begin_time;
+  {
+    std::unique_lock l{lock};
+    cond.wait(l, [&] { return ready == nthreads; });
+    begin_time = ceph_clock_now();
+    go = true;
+    cond.notify_all();
+  }
+  for (auto& w : workers)
+    w.join();
+  utime_t end_time = ceph_clock_now();
+  if (error)
+    return error;
+
+  res->seconds = (end_time - begin_time);
+  res->cpu_seconds = cpu_ns / 1e9;
+  res->bytes = size * max_iterations * nthreads;
+  return 0;
+}
+
+int ErasureCodeBench::run_sweep()
+{
+  ErasureCodePluginRegistry &instance = ErasureCodePluginRegistry::instance();
+  Cycles::init();
+  const double hz = cpu_ghz > 0 ? cpu_ghz * 1e9 : Cycles::per_second();
+
+  vector<std::pair<string, ceph::ErasureCodeProfile>> targets;
+  if (compare.empty())
+    targets.emplace_back(plugin, profile);
+  for (auto& spec : compare) {
+    auto parts = get_str_vec(spec, ",");
+    if (parts.empty())
+      continue;
+    ceph::ErasureCodeProfile p = profile;
+    for (size_t i = 1; i < parts.size(); i++) {
+      auto eq = parts[i].find('=');
+      if (eq == string::npos) {
+	cerr << "--compare " << spec << ": " << parts[i]
+	     << " is not key=value" << endl;
+	return -EINVAL;
+      }
+      p[parts[i].substr(0, eq)] = parts[i].substr(eq + 1);
+    }
+    targets.emplace_back(parts[0], p);
+  }
+  if (threads.empty())
+    threads.push_back(1);
+
+  cout << "plugin\tprofile\tsize\tthreads\terased\tGB/s\tGB/s/core"
+       << "\tcycles/B\tcache" << endl;
+  for (auto& [name, prof] : targets) {
+    ErasureCodeInterfaceRef erasure_code;
+    stringstream messages;
+    int code = instance.factory(name,
+				g_conf().get_val<std::string>("erasure_code_dir"),
+				prof, &erasure_code, &messages);
+    if (code) {
+      cerr << name << ": " << messages.str() << endl;
+      return code;
+    }
+    string profile_str;
+    for (auto& [key, val] : prof) {
+      if (key == "directory")
+	continue;
+      profile_str += (profile_str.empty() ? "" : ",") + key + "=" + val;
+    }
+
+    vector<uint64_t> all_sizes = sizes;
+    for (auto su : stripe_units)
+      all_sizes.push_back(su * erasure_code->get_data_chunk_count());
+    if (all_sizes.empty())
+      all_sizes.push_back(in_size);
+
+    // nullopt erases chunks at random on every iteration
+    vector<std::optional<set<int>>> patterns;
+    const unsigned chunk_count = erasure_code->get_chunk_count();
+    if (workload == "encode") {
+      patterns.emplace_back();
+    } else if (erasure_matrix) {
+      // every combination of erasures chunks out of chunk_count
+      vector<bool> pick(chunk_count, false);
+      std::fill(pick.begin(),
+		pick.begin() + std::min<unsigned>(erasures, chunk_count), true);
+      do {
+	set<int> e;
+	for (unsigned c = 0; c < chunk_count; c++)
+	  if (pick[c])
+	    e.insert(c);
+	patterns.emplace_back(e);
+      } while (std::prev_permutation(pick.begin(), pick.end()));
+    } else if (!erased.empty()) {
+      patterns.emplace_back(set<int>(erased.begin(), erased.end()));
+    } else {
+      patterns.emplace_back();
+    }
+
+    for (auto size : all_sizes) {
+      for (auto& pattern : patterns) {
+	for (int nthreads : threads) {
+	  sweep_result r;
+	  code = sweep_one(erasure_code, size, nthreads,
+			   pattern ? &*pattern : nullptr, &r);
+	  if (code) {
+	    cerr << name << " failed with " << code << endl;
+	    return code;
+	  }
+	  string erased_str = "-";
+	  if (workload != "encode") {
+	    if (!pattern) {
+	      erased_str = "random" + std::to_string(erasures);
+	    } else {
+	      erased_str.clear();
+	      for (int c : *pattern)
+		erased_str += (erased_str.empty() ? "" : ",") +
+		  std::to_string(c);
+	    }
+	  }
+	  const double gbps = r.bytes / r.seconds / 1e9;
+	  cout << name << "\t" << profile_str << "\t" << size << "\t"
+	       << nthreads << "\t" << erased_str << "\t" << gbps << "\t"
+	       << gbps / nthreads << "\t" << r.cpu_seconds * hz / r.bytes
+	       << "\t" << cache_level(r.working_set_per_thread,
+				       r.working_set_per_thread * nthreads)
+	       << endl;
+	}
+      }
+    }
+  }
+  return 0;
+}
+
 int ErasureCodeBench::encode()
 {
   ErasureCodePluginRegistry &instance = ErasureCodePluginRegistry::instance();
@@ -20,6 +20,7 @@
 
 #include <string>
 #include <map>
+#include <set>
 #include <vector>
 
 #include <boost/intrusive_ptr.hpp>
@@ -47,6 +48,28 @@ class ErasureCodeBench {
 
   bool verbose;
   boost::intrusive_ptr<CephContext> cct;
+
+  // sweep mode, a table row per plugin, size, erasures and thread count
+  bool sweep = false;
+  std::vector<int> threads;
+  std::vector<uint64_t> sizes;
+  std::vector<uint64_t> stripe_units;
+  std::vector<std::string> compare;
+  bool erasure_matrix = false;
+  bool cold = false;
+  double cpu_ghz = 0;
+
+  struct sweep_result {
+    double seconds;      ///< wall clock, from the first start to the last end
+    double cpu_seconds;  ///< summed over the threads
+    uint64_t bytes;      ///< of input to encode, or of object decoded
+    uint64_t working_set_per_thread;
+  };
+  int sweep_one(ErasureCodeInterfaceRef erasure_code, uint64_t size,
+		int nthreads, const std::set<int> *erased_chunks,
+		sweep_result *res);
+  int run_sweep();
+
 public:
   int setup(int argc, char** argv);
   int run();
@@ -0,0 +1,775 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ *  Ceph librados engine
+ *
+ * IO engine issuing a weighted mix of librados operations -- reads and
+ * writes, but also omap, xattr, cls method calls and compound operations --
+ * to the objects of a pool, and reporting latency percentiles for each
+ * kind of operation.
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "include/rados/librados.hpp"
+#include "include/str_list.h"
+#include "common/strtol.h"
+
+#include <fio.h>
+#include <optgroup.h>
+
+#include "include/ceph_assert.h" // fio.h clobbers our assert.h
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+/// fio configuration options read from the job file
+struct Options {
+  thread_data* td;
+  char* conf;
+  char* client_name;
+  char* cluster_name;
+  char* pool;
+  char* read_mix;
+  char* write_mix;
+  char* call_read;
+  char* call_write;
+  unsigned omap_keys;
+  unsigned omap_key_space;
+  unsigned long long omap_value_len;
+  unsigned xattrs;
+  unsigned long long xattr_len;
+};
+
+template <class Func> // void Func(fio_option&)
+fio_option make_option(Func&& func)
+{
+  // zero-initialize and set common defaults
+  auto o = fio_option{};
+  o.category = FIO_OPT_C_ENGINE;
+  o.group    = FIO_OPT_G_RBD;
+  func(std::ref(o));
+  return o;
+}
+
+static std::vector<fio_option> ceph_options{
+  make_option([] (fio_option& o) {
+    o.name   = "conf";
+    o.lname  = "ceph configuration file";
+    o.type   = FIO_OPT_STR_STORE;
+    o.help   = "Path to a ceph configuration file";
+    o.off1   = offsetof(Options, conf);
+  }),
+  make_option([] (fio_option& o) {
+    o.name   = "clientname";
+    o.lname  = "ceph client name";
+    o.type   = FIO_OPT_STR_STORE;
+    o.help   = "Name of the ceph client to connect as";
+    o.off1   = offsetof(Options, client_name);
+    o.def    = "client.admin";
+  }),
+  make_option([] (fio_option& o) {
+    o.name   = "clustername";
+    o.lname  = "ceph cluster name";
+    o.type   = FIO_OPT_STR_STORE;
+    o.help   = "Name of the ceph cluster";
+    o.off1   = offsetof(Options, cluster_name);
+    o.def    = "ceph";
+  }),
+  make_option([] (fio_option& o) {
+    o.name   = "pool";
+    o.lname  = "pool name";
+    o.type   = FIO_OPT_STR_STORE;
+    o.help   = "Pool holding the objects, one per fio file";
+    o.off1   = offsetof(Options, pool);
+  }),
+  make_option([] (fio_option& o) {
+    o.name   = "read_mix";
+    o.lname  = "mix of read operations";
+    o.type   = FIO_OPT_STR_STORE;
+    o.help   = "Weighted operations issued for fio reads, as op[:weight],...; "
+	       "ops are read, sparse_read, stat, getxattr, omap_get, "
+	       "omap_list, call and compound";
+    o.off1   = offsetof(Options, read_mix);
+    o.def    = "read";
+  }),
+  make_option([] (fio_option& o) {
+    o.name   = "write_mix";
+    o.lname  = "mix of write operations";
+    o.type   = FIO_OPT_STR_STORE;
+    o.help   = "Weighted operations issued for fio writes, as op[:weight],...; "
+	       "ops are write, write_full, append, setxattr, omap_set, "
+	       "omap_rm, call and compound";
+    o.off1   = offsetof(Options, write_mix);
+    o.def    = "write";
+  }),
+  make_option([] (fio_option& o) {
+    o.name   = "call_read";
+    o.lname  = "cls method for read calls";
+    o.type   = FIO_OPT_STR_STORE;
+    o.help   = "class.method read mix calls run, with the fio buffer as input";
+    o.off1   = offsetof(Options, call_read);
+    o.def    = "hello.say_hello";
+  }),
+  make_option([] (fio_option& o) {
+    o.name   = "call_write";
+    o.lname  = "cls method for write calls";
+    o.type   = FIO_OPT_STR_STORE;
+    o.help   = "class.method write mix calls run, with the fio buffer as input";
+    o.off1   = offsetof(Options, call_write);
+  }),
+  make_option([] (fio_option& o) {
+    o.name   = "omap_keys";
+    o.lname  = "omap keys per op";
+    o.type   = FIO_OPT_INT;
+    o.help   = "Number of omap keys each omap operation sets, gets or lists";
+    o.off1   = offsetof(Options, omap_keys);
+    o.def    = "1";
+    o.minval = 1;
+  }),
+  make_option([] (fio_option& o) {
+    o.name   = "omap_key_space";
+    o.lname  = "omap keys per object";
+    o.type   = FIO_OPT_INT;
+    o.help   = "Number of distinct omap keys of each object to pick from";
+    o.off1   = offsetof(Options, omap_key_space);
+    o.def    = "100000";
+    o.minval = 1;
+  }),
+  make_option([] (fio_option& o) {
+    o.name   = "omap_value_len";
+    o.lname  = "omap value length";
+    o.type   = FIO_OPT_STR_VAL;
+    o.help   = "Length of each omap value set";
+    o.off1   = offsetof(Options, omap_value_len);
+    o.def    = "256";
+  }),
+  make_option([] (fio_option& o) {
+    o.name   = "xattrs";
+    o.lname  = "xattrs per object";
+    o.type   = FIO_OPT_INT;
+    o.help   = "Number of distinct xattrs of each object to pick from";
+    o.off1   = offsetof(Options, xattrs);
+    o.def    = "8";
+    o.minval = 1;
+  }),
+  make_option([] (fio_option& o) {
+    o.name   = "xattr_len";
+    o.lname  = "xattr length";
+    o.type   = FIO_OPT_STR_VAL;
+    o.help   = "Length of each xattr value set";
+    o.off1   = offsetof(Options, xattr_len);
+    o.def    = "256";
+  }),
+  {} // fio expects a 'null'-terminated list
+};
+
+enum op_t {
+  OP_READ,
+  OP_SPARSE_READ,
+  OP_STAT,
+  OP_GETXATTR,
+  OP_OMAP_GET,
+  OP_OMAP_LIST,
+  OP_CALL_READ,
+  OP_COMPOUND_READ,
+  OP_WRITE,
+  OP_WRITE_FULL,
+  OP_APPEND,
+  OP_SETXATTR,
+  OP_OMAP_SET,
+  OP_OMAP_RM,
+  OP_CALL_WRITE,
+  OP_COMPOUND_WRITE,
+  OP_MAX
+};
+
+const char *op_names[OP_MAX] = {
+  "read", "sparse_read", "stat", "getxattr", "omap_get", "omap_list",
+  "call", "compound",
+  "write", "write_full", "append", "setxattr", "omap_set", "omap_rm",
+  "call", "compound",
+};
+
+/// ops of a mix, by cumulative weight
+struct OpMix {
+  std::vector<std::pair<unsigned, op_t>> ops;
+  unsigned total = 0;
+
+  // parse "op[:weight],...", of the ops from first to last
+  void parse(const char *s, op_t first, op_t last) {
+    for (auto& item : get_str_vec(s ? s : "", ",")) {
+      auto v = get_str_vec(item, ":");
+      unsigned weight = 1;
+      if (v.size() == 2) {
+	std::string err;
+	weight = strict_strtol(v[1].c_str(), 10, &err);
+	if (!err.empty()) {
+	  throw std::runtime_error("bad weight in " + item);
+	}
+      } else if (v.size() != 1) {
+	throw std::runtime_error("bad op " + item);
+      }
+      int op = first;
+      while (op <= last && v[0] != op_names[op]) {
+	++op;
+      }
+      if (op > last) {
+	throw std::runtime_error("unknown op " + v[0]);
+      }
+      if (weight) {
+	total += weight;
+	ops.emplace_back(total, op_t(op));
+      }
+    }
+  }
+
+  op_t pick(std::mt19937& rng) const {
+    unsigned n = std::uniform_int_distribution<unsigned>(0, total - 1)(rng);
+    return std::upper_bound(ops.begin(), ops.end(),
+			    std::make_pair(n, OP_MAX))->second;
+  }
+};
+
+/// latencies in microseconds, in buckets of 1/16 of a power of two
+struct LatencyHistogram {
+  static constexpr unsigned SUB = 16;
+  std::vector<uint64_t> buckets = std::vector<uint64_t>(64 * SUB);
+  uint64_t count = 0;
+  double sum = 0;
+  uint64_t max = 0;
+
+  static unsigned bucket_of(uint64_t us) {
+    if (us < SUB) {
+      return us;
+    }
+    unsigned bits = 63 - __builtin_clzll(us);
+    return (bits - 3) * SUB + ((us >> (bits - 4)) & (SUB - 1));
+  }
+  static uint64_t upper_of(unsigned b) {
+    if (b < SUB) {
+      return b;
+    }
+    unsigned bits = b / SUB + 3;
+    return ((SUB + b % SUB + 1ull) << (bits - 4)) - 1;
+  }
+
+  void add(uint64_t us) {
+    ++buckets[bucket_of(us)];
+    ++count;
+    sum += us;
+    max = std::max(max, us);
+  }
+  void merge(const LatencyHistogram& o) {
+    for (unsigned i = 0; i < buckets.size(); ++i) {
+      buckets[i] += o.buckets[i];
+    }
+    count += o.count;
+    sum += o.sum;
+    max = std::max(max, o.max);
+  }
+  uint64_t percentile(double q) const {
+    uint64_t want = std::ceil(q * count), seen = 0;
+    for (unsigned i = 0; i < buckets.size(); ++i) {
+      seen += buckets[i];
+      if (seen >= want && seen) {
+	return std::min(upper_of(i), max);
+      }
+    }
+    return max;
+  }
+};
+
+/// global engine state shared between all jobs within the process
+struct Engine {
+  librados::Rados rados;
+  librados::IoCtx ioctx;
+  OpMix read_mix, write_mix;
+  std::string call_read_cls, call_read_method;
+  std::string call_write_cls, call_write_method;
+
+  std::mutex lock;
+  int ref_count = 0;
+  LatencyHistogram latencies[OP_MAX];
+  uint64_t errors[OP_MAX] = {};
+
+  explicit Engine(thread_data* td);
+  ~Engine();
+
+  static Engine* get_instance(thread_data* td) {
+    // note: creates an Engine with the options associated with the first job
+    static Engine engine(td);
+    return &engine;
+  }
+
+  void ref() {
+    std::lock_guard l(lock);
+    ++ref_count;
+  }
+  void deref() {
+    std::lock_guard l(lock);
+    if (--ref_count == 0) {
+      print_latencies();
+    }
+  }
+  void print_latencies();
+};
+
+std::pair<std::string, std::string> split_method(const char *s)
+{
+  std::string m = s ? s : "";
+  auto dot = m.find('.');
+  if (dot == m.npos || dot == 0 || dot + 1 == m.size()) {
+    throw std::runtime_error("bad cls method '" + m + "', expected class.method");
+  }
+  return {m.substr(0, dot), m.substr(dot + 1)};
+}
+
+Engine::Engine(thread_data* td)
+{
+  auto o = static_cast<Options*>(td->eo);
+  if (!o->pool) {
+    throw std::runtime_error("pool must be set");
+  }
+  read_mix.parse(o->read_mix, OP_READ, OP_COMPOUND_READ);
+  write_mix.parse(o->write_mix, OP_WRITE, OP_COMPOUND_WRITE);
+  if ((td_read(td) && !read_mix.total) || (td_write(td) && !write_mix.total)) {
+    throw std::runtime_error("no ops in read_mix or write_mix");
+  }
+  auto uses = [](const OpMix& mix, op_t op) {
+    return std::any_of(mix.ops.begin(), mix.ops.end(),
+		       [op](auto& p) { return p.second == op; });
+  };
+  if (uses(read_mix, OP_CALL_READ)) {
+    std::tie(call_read_cls, call_read_method) = split_method(o->call_read);
+  }
+  if (uses(write_mix, OP_CALL_WRITE)) {
+    std::tie(call_write_cls, call_write_method) = split_method(o->call_write);
+  }
+
+  int r = rados.init2(o->client_name, o->cluster_name, 0);
+  if (r < 0) {
+    throw std::system_error(-r, std::system_category(), "rados init failed");
+  }
+  r = rados.conf_read_file(o->conf);
+  if (r < 0) {
+    throw std::system_error(-r, std::system_category(), "conf_read_file failed");
+  }
+  rados.conf_parse_env(nullptr);
+  r = rados.connect();
+  if (r < 0) {
+    throw std::system_error(-r, std::system_category(), "connect failed");
+  }
+  r = rados.ioctx_create(o->pool, ioctx);
+  if (r < 0) {
+    rados.shutdown();
+    throw std::system_error(-r, std::system_category(), "ioctx_create failed");
+  }
+}
+
+Engine::~Engine()
+{
+  ceph_assert(!ref_count);
+  ioctx.close();
+  rados.shutdown();
+}
+
+void Engine::print_latencies()
+{
+  std::cout << "\nlatency (usec)   " << std::setw(12) << "ops"
+	    << std::setw(8) << "errors" << std::setw(10) << "avg"
+	    << std::setw(10) << "p50" << std::setw(10) << "p99"
+	    << std::setw(10) << "p99.9" << std::setw(10) << "max" << std::endl;
+  for (int op = 0; op < OP_MAX; ++op) {
+    auto& h = latencies[op];
+    if (!h.count && !errors[op]) {
+      continue;
+    }
+    std::string name = (op < OP_WRITE ? "read " : "write ") +
+      std::string(op_names[op]);
+    std::cout << std::left << std::setw(17) << name << std::right
+	      << std::setw(12) << h.count << std::setw(8) << errors[op]
+	      << std::setw(10) << uint64_t(h.count ? h.sum / h.count : 0)
+	      << std::setw(10) << h.percentile(0.5)
+	      << std::setw(10) << h.percentile(0.99)
+	      << std::setw(10) << h.percentile(0.999)
+	      << std::setw(10) << h.max << std::endl;
+  }
+}
+
+/// an io_u in flight
+struct RadosIO {
+  io_u* u;
+  op_t op = OP_MAX;
+  std::chrono::steady_clock::time_point start;
+  librados::AioCompletion* c = nullptr;
+  uint64_t latency_us = 0;
+  std::atomic<bool> done{false};
+
+  // outputs of the ops
+  bufferlist bl;
+  std::map<uint64_t, uint64_t> extents;
+  std::map<std::string, bufferlist> vals;
+  bufferlist attr;
+  uint64_t size = 0;
+  time_t mtime = 0;
+  bool more = false;
+  int rval = 0;
+
+  explicit RadosIO(io_u* u) : u(u) {}
+
+  void reset() {
+    bl.clear();
+    extents.clear();
+    vals.clear();
+    attr.clear();
+  }
+};
+
+/// per-thread state of a job
+struct Job {
+  Engine* engine;
+  std::vector<io_u*> events;
+  std::mt19937 rng;
+  bufferlist omap_value, xattr_value;
+
+  std::mutex lock;
+  LatencyHistogram latencies[OP_MAX];
+  uint64_t errors[OP_MAX] = {};
+
+  Job(Engine* engine, thread_data* td)
+    : engine(engine), events(td->o.iodepth), rng(td->thread_number) {
+    auto o = static_cast<Options*>(td->eo);
+    omap_value.append_zero(o->omap_value_len);
+    xattr_value.append_zero(o->xattr_len);
+    engine->ref();
+  }
+  ~Job() {
+    {
+      std::lock_guard l(engine->lock);
+      for (int op = 0; op < OP_MAX; ++op) {
+	engine->latencies[op].merge(latencies[op]);
+	engine->errors[op] += errors[op];
+      }
+    }
+    engine->deref();
+  }
+};
+
+int fio_ceph_rados_setup(thread_data* td)
+{
+  // the jobs share one connection to the cluster, so they must run in the
+  // same process
+  td->o.use_thread = 1;
+
+  try {
+    auto engine = Engine::get_instance(td);
+    td->io_ops_data = new Job(engine, td);
+  } catch (std::exception& e) {
+    std::cerr << "setup failed with " << e.what() << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+void fio_ceph_rados_cleanup(thread_data* td)
+{
+  auto job = static_cast<Job*>(td->io_ops_data);
+  td->io_ops_data = nullptr;
+  delete job;
+}
+
+io_u* fio_ceph_rados_event(thread_data* td, int event)
+{
+  // return the requested event from fio_ceph_rados_getevents()
+  auto job = static_cast<Job*>(td->io_ops_data);
+  return job->events[event];
+}
+
+/// copy the data read into the fio buffer, and account for the io
+void reap(thread_data* td, Job* job, RadosIO* io)
+{
+  io_u* u = io->u;
+  int r = io->c->get_return_value();
+  io->c->release();
+  io->c = nullptr;
+  if (r < 0) {
+    u->error = -r;
+  } else if (io->op == OP_READ || io->op == OP_COMPOUND_READ) {
+    io->bl.begin().copy(std::min<size_t>(io->bl.length(), u->xfer_buflen),
+			static_cast<char*>(u->xfer_buf));
+    u->resid = u->xfer_buflen - std::min<size_t>(io->bl.length(),
+						 u->xfer_buflen);
+  } else if (io->op == OP_SPARSE_READ) {
+    // lay the extents read out over a zeroed buffer
+    memset(u->xfer_buf, 0, u->xfer_buflen);
+    auto p = io->bl.cbegin();
+    for (auto& [off, len] : io->extents) {
+      if (off >= u->offset && off + len <= u->offset + u->xfer_buflen) {
+	p.copy(len, static_cast<char*>(u->xfer_buf) + (off - u->offset));
+      }
+    }
+  }
+  std::lock_guard l(job->lock);
+  if (r < 0) {
+    ++job->errors[io->op];
+  } else {
+    job->latencies[io->op].add(io->latency_us);
+  }
+}
+
+int fio_ceph_rados_getevents(thread_data* td, unsigned int min,
+			     unsigned int max, const timespec* t)
+{
+  auto job = static_cast<Job*>(td->io_ops_data);
+  unsigned int events = 0;
+  io_u* u = NULL;
+  unsigned int i = 0;
+
+  // loop through inflight ios until we find 'min' completions
+  do {
+    io_u_qiter(&td->io_u_all, u, i) {
+      if (!(u->flags & IO_U_F_FLIGHT))
+	continue;
+
+      auto io = static_cast<RadosIO*>(u->engine_data);
+      if (io->c && io->done.exchange(false, std::memory_order_acquire)) {
+	reap(td, job, io);
+	job->events[events] = u;
+	events++;
+	if (events >= max)
+	  break;
+      }
+    }
+    if (events >= min)
+      break;
+    usleep(100);
+  } while (1);
+
+  return events;
+}
+
+void rados_complete(librados::completion_t, void* arg)
+{
+  auto io = static_cast<RadosIO*>(arg);
+  io->latency_us = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - io->start).count();
+  io->done.store(true, std::memory_order_release);
+}
+
+std::string omap_key(unsigned n)
+{
+  char key[32];
+  snprintf(key, sizeof(key), "key.%010u", n);
+  return key;
+}
+
+enum fio_q_status fio_ceph_rados_queue(thread_data* td, io_u* u)
+{
+  fio_ro_check(td, u);
+
+  auto o = static_cast<const Options*>(td->eo);
+  auto job = static_cast<Job*>(td->io_ops_data);
+  auto engine = job->engine;
+  auto io = static_cast<RadosIO*>(u->engine_data);
+  const std::string oid = u->file->file_name;
+
+  if (u->ddir != DDIR_READ && u->ddir != DDIR_WRITE) {
+    std::cerr << "WARNING: Only DDIR_READ and DDIR_WRITE are supported!"
+	      << std::endl;
+    u->error = EINVAL;
+    td_verror(td, u->error, "xfer");
+    return FIO_Q_COMPLETED;
+  }
+
+  io->reset();
+  io->op = u->ddir == DDIR_READ ? engine->read_mix.pick(job->rng) :
+				  engine->write_mix.pick(job->rng);
+
+  std::set<std::string> keys;
+  std::map<std::string, bufferlist> kv;
+  auto pick_keys = [&](bool values) {
+    for (unsigned n = 0; n < o->omap_keys; ++n) {
+      auto key = omap_key(std::uniform_int_distribution<unsigned>(
+	0, o->omap_key_space - 1)(job->rng));
+      if (values) {
+	kv[key] = job->omap_value;
+      } else {
+	keys.insert(key);
+      }
+    }
+  };
+  auto xattr_name = "fio." + std::to_string(
+    std::uniform_int_distribution<unsigned>(0, o->xattrs - 1)(job->rng));
+
+  bufferlist data;
+  if (u->ddir == DDIR_WRITE || io->op == OP_CALL_READ) {
+    data.append(static_cast<char*>(u->xfer_buf), u->xfer_buflen);
+  }
+
+  librados::ObjectReadOperation rop;
+  librados::ObjectWriteOperation wop;
+  switch (io->op) {
+  case OP_READ:
+    rop.read(u->offset, u->xfer_buflen, &io->bl, &io->rval);
+    break;
+  case OP_SPARSE_READ:
+    rop.sparse_read(u->offset, u->xfer_buflen, &io->extents, &io->bl,
+		    &io->rval);
+    break;
+  case OP_STAT:
+    rop.stat(&io->size, &io->mtime, &io->rval);
+    break;
+  case OP_GETXATTR:
+    // an xattr that was never set is not an error
+    rop.getxattr(xattr_name.c_str(), &io->attr, &io->rval);
+    rop.set_op_flags2(LIBRADOS_OP_FLAG_FAILOK);
+    break;
+  case OP_OMAP_GET:
+    pick_keys(false);
+    rop.omap_get_vals_by_keys(keys, &io->vals, &io->rval);
+    break;
+  case OP_OMAP_LIST:
+    // a page of a listing, as of a bucket index
+    rop.omap_get_vals2(omap_key(std::uniform_int_distribution<unsigned>(
+			 0, o->omap_key_space - 1)(job->rng)),
+		       o->omap_keys, &io->vals, &io->more, &io->rval);
+    break;
+  case OP_CALL_READ:
+    rop.exec(engine->call_read_cls.c_str(), engine->call_read_method.c_str(),
+	     data, &io->attr, &io->rval);
+    break;
+  case OP_COMPOUND_READ:
+    // data and metadata, as of an object read through a gateway
+    rop.read(u->offset, u->xfer_buflen, &io->bl, &io->rval);
+    rop.getxattr(xattr_name.c_str(), &io->attr, nullptr);
+    rop.set_op_flags2(LIBRADOS_OP_FLAG_FAILOK);
+    pick_keys(false);
+    rop.omap_get_vals_by_keys(keys, &io->vals, nullptr);
+    break;
+  case OP_WRITE:
+    wop.write(u->offset, data);
+    break;
+  case OP_WRITE_FULL:
+    wop.write_full(data);
+    break;
+  case OP_APPEND:
+    wop.append(data);
+    break;
+  case OP_SETXATTR:
+    wop.setxattr(xattr_name.c_str(), job->xattr_value);
+    break;
+  case OP_OMAP_SET:
+    pick_keys(true);
+    wop.omap_set(kv);
+    break;
+  case OP_OMAP_RM:
+    pick_keys(false);
+    wop.omap_rm_keys(keys);
+    break;
+  case OP_CALL_WRITE:
+    wop.exec(engine->call_write_cls.c_str(), engine->call_write_method.c_str(),
+	     data);
+    break;
+  case OP_COMPOUND_WRITE:
+    // data, an xattr and index entries in one transaction
+    wop.write(u->offset, data);
+    wop.setxattr(xattr_name.c_str(), job->xattr_value);
+    pick_keys(true);
+    wop.omap_set(kv);
+    break;
+  default:
+    ceph_abort();
+  }
+
+  io->c = librados::Rados::aio_create_completion(io, rados_complete);
+  io->start = std::chrono::steady_clock::now();
+  int r;
+  if (io->op < OP_WRITE) {
+    r = engine->ioctx.aio_operate(oid, io->c, &rop, nullptr);
+  } else {
+    r = engine->ioctx.aio_operate(oid, io->c, &wop);
+  }
+  if (r < 0) {
+    io->c->release();
+    io->c = nullptr;
+    u->error = -r;
+    td_verror(td, u->error, "xfer");
+    return FIO_Q_COMPLETED;
+  }
+  return FIO_Q_QUEUED;
+}
+
+int fio_ceph_rados_commit(thread_data* td)
+{
+  // librados batches nothing, each op was sent as it was queued
+  return 0;
+}
+
+// open/close are noops. we set the FIO_DISKLESSIO flag in ioengine_ops to
+// prevent fio from creating the files
+int fio_ceph_rados_open(thread_data* td, fio_file* f) { return 0; }
+int fio_ceph_rados_close(thread_data* td, fio_file* f) { return 0; }
+
+int fio_ceph_rados_io_u_init(thread_data* td, io_u* u)
+{
+  u->engine_data = new RadosIO(u);
+  return 0;
+}
+
+void fio_ceph_rados_io_u_free(thread_data* td, io_u* u)
+{
+  auto io = static_cast<RadosIO*>(u->engine_data);
+  if (io && io->c) {
+    io->c->wait_for_complete();
+    io->c->release();
+  }
+  delete io;
+  u->engine_data = nullptr;
+}
+
+
+// ioengine_ops for get_ioengine()
+struct ceph_ioengine : public ioengine_ops {
+  ceph_ioengine() : ioengine_ops({}) {
+    name        = "ceph-rados";
+    version     = FIO_IOOPS_VERSION;
+    flags       = FIO_DISKLESSIO;
+    setup       = fio_ceph_rados_setup;
+    queue       = fio_ceph_rados_queue;
+    commit      = fio_ceph_rados_commit;
+    getevents   = fio_ceph_rados_getevents;
+    event       = fio_ceph_rados_event;
+    cleanup     = fio_ceph_rados_cleanup;
+    open_file   = fio_ceph_rados_open;
+    close_file  = fio_ceph_rados_close;
+    io_u_init   = fio_ceph_rados_io_u_init;
+    io_u_free   = fio_ceph_rados_io_u_free;
+    options     = ceph_options.data();
+    option_struct_size = sizeof(struct Options);
+  }
+};
+
+} // anonymous namespace
+
+extern "C" {
+// the exported fio engine interface
+void get_ioengine(struct ioengine_ops** ioengine_ptr) {
+  static ceph_ioengine ioengine;
+  *ioengine_ptr = &ioengine;
+}
+} // extern "C"
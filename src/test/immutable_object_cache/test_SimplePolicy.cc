@@ -233,3 +233,33 @@ TEST_F(TestSimplePolicy, test_evict_list_10) {
     m_promoted_lru.erase(m_promoted_lru.begin());
   }
 }
+
+TEST_F(TestSimplePolicy, test_evict_list_scan_resistant) {
+  // a second lookup protects the first 10 entries
+  for (uint64_t index = 0; index < 10; index++) {
+    ASSERT_EQ(OBJ_CACHE_PROMOTED,
+              m_simple_policy->lookup_object(generate_file_name(index)));
+  }
+  // then a scan fills the cache up
+  uint64_t left_entry_num = m_cache_size - m_promoted_lru.size();
+  for (uint64_t i = 0; i < left_entry_num; i++, ++m_entry_index) {
+    insert_entry_into_promoted_lru(generate_file_name(m_entry_index));
+  }
+  ASSERT_EQ(0u, m_simple_policy->get_free_size());
+
+  // the protected entries go last
+  std::vector<std::string> hot(m_promoted_lru.begin(),
+                               m_promoted_lru.begin() + 10);
+  m_promoted_lru.erase(m_promoted_lru.begin(), m_promoted_lru.begin() + 10);
+  m_promoted_lru.insert(m_promoted_lru.end(), hot.begin(), hot.end());
+
+  std::list<std::string> evict_entry_list;
+  m_simple_policy->get_evict_list(&evict_entry_list);
+  ASSERT_EQ(m_cache_size * 0.1, evict_entry_list.size());
+  uint64_t index = 10;
+  for (auto& file_name : evict_entry_list) {
+    ASSERT_EQ(generate_file_name(index++), file_name);
+    ASSERT_EQ(m_promoted_lru.front(), file_name);
+    m_promoted_lru.erase(m_promoted_lru.begin());
+  }
+}
@@ -1,6 +1,8 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
 // vim: ts=8 sw=2 smarttab
 #include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <map>
 #include <sstream>
 #include <string>
@@ -922,3 +924,65 @@ TEST_F(LibRadosMiscPP, Conf) {
   ASSERT_EQ(0, cluster.conf_get(option, actual));
   ASSERT_EQ(expected, actual);
 }
+
+static bool has_pool(Rados& c, const std::string& pool_name) {
+  std::list<std::string> pools;
+  EXPECT_EQ(0, c.pool_list(pools));
+  return std::find(pools.begin(), pools.end(), pool_name) != pools.end();
+}
+
+TEST_F(LibRadosMiscPP, OSDMapCachePP) {
+  const std::string path = "/tmp/" + get_temp_pool_name("osdmap-cache-");
+  auto remove_cache = make_scope_guard([&] {
+    ::unlink(path.c_str());
+  });
+  const std::map<std::string, std::string> config = {
+    {"objecter_osdmap_cache", path}};
+
+  // the map is saved on shutdown, private to its owner
+  {
+    Rados c;
+    ASSERT_EQ("", connect_cluster_pp(c, config));
+    ASSERT_EQ(0, c.wait_for_latest_osdmap());
+    c.shutdown();
+  }
+  struct stat st;
+  ASSERT_EQ(0, ::stat(path.c_str(), &st));
+  ASSERT_EQ(0600u, st.st_mode & 0777);
+
+  // a cached map that is still current gets the client going
+  {
+    Rados c;
+    ASSERT_EQ("", connect_cluster_pp(c, config));
+    ASSERT_TRUE(has_pool(c, pool_name));
+    c.shutdown();
+  }
+
+  // a stale cached map is not taken for the current one
+  const std::string new_pool = get_temp_pool_name();
+  ASSERT_EQ(0, cluster.pool_create(new_pool.c_str()));
+  auto remove_pool = make_scope_guard([&] {
+    cluster.pool_delete(new_pool.c_str());
+  });
+  {
+    Rados c;
+    ASSERT_EQ("", connect_cluster_pp(c, config));
+    ASSERT_TRUE(has_pool(c, new_pool));
+    c.shutdown();
+  }
+}
+
+TEST_F(LibRadosMiscPP, OSDMapCacheGarbagePP) {
+  const std::string path = "/tmp/" + get_temp_pool_name("osdmap-cache-");
+  auto remove_cache = make_scope_guard([&] {
+    ::unlink(path.c_str());
+  });
+  bufferlist bl;
+  bl.append("not an osdmap");
+  ASSERT_EQ(0, bl.write_file(path.c_str(), 0600));
+
+  Rados c;
+  ASSERT_EQ("", connect_cluster_pp(c, {{"objecter_osdmap_cache", path}}));
+  ASSERT_TRUE(has_pool(c, pool_name));
+  c.shutdown();
+}
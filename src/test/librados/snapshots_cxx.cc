@@ -545,6 +545,82 @@ TEST_F(LibRadosSnapshotsSelfManagedPP, ReusePurgedSnap) {
   //sleep(600);
 }
 
+// trim enough clones that the snap trimmer batches several of them into
+// one update, with clones that are only partially trimmed mixed in
+TEST_F(LibRadosSnapshotsSelfManagedPP, TrimBatchPP) {
+  const int num_objects = 40;
+  auto oid = [](int i) { return "obj" + std::to_string(i); };
+  IoCtx readioctx;
+  ASSERT_EQ(0, cluster.ioctx_create(pool_name.c_str(), readioctx));
+  readioctx.set_namespace(nspace);
+  readioctx.snap_set_read(LIBRADOS_SNAP_DIR);
+
+  char buf[bufsize];
+  memset(buf, 0xcc, sizeof(buf));
+  bufferlist bl1;
+  bl1.append(buf, sizeof(buf));
+  for (int i = 0; i < num_objects; ++i) {
+    ASSERT_EQ(0, ioctx.write_full(oid(i), bl1));
+  }
+
+  // one clone of every object belongs to two snaps, a second clone of
+  // every other object to a third one
+  std::vector<uint64_t> my_snaps(3);
+  ASSERT_EQ(0, ioctx.selfmanaged_snap_create(&my_snaps[0]));
+  ASSERT_EQ(0, ioctx.selfmanaged_snap_create(&my_snaps[1]));
+  std::vector<uint64_t> snapc{my_snaps[1], my_snaps[0]};
+  ASSERT_EQ(0, ioctx.selfmanaged_snap_set_write_ctx(snapc[0], snapc));
+  char buf2[sizeof(buf)];
+  memset(buf2, 0xdd, sizeof(buf2));
+  bufferlist bl2;
+  bl2.append(buf2, sizeof(buf2));
+  for (int i = 0; i < num_objects; ++i) {
+    ASSERT_EQ(0, ioctx.write_full(oid(i), bl2));
+  }
+  ASSERT_EQ(0, ioctx.selfmanaged_snap_create(&my_snaps[2]));
+  snapc.insert(snapc.begin(), my_snaps[2]);
+  ASSERT_EQ(0, ioctx.selfmanaged_snap_set_write_ctx(snapc[0], snapc));
+  for (int i = 0; i < num_objects; i += 2) {
+    ASSERT_EQ(0, ioctx.write_full(oid(i), bl1));
+  }
+
+  auto wait_for_clones = [&](const std::vector<snap_t>& snaps) {
+    for (int t = 0; t < 120; ++t) {
+      bool trimmed = true;
+      for (int i = 0; i < num_objects && trimmed; ++i) {
+        snap_set_t ss;
+        if (readioctx.list_snaps(oid(i), &ss) < 0) {
+          return false;
+        }
+        // the head is listed last
+        trimmed = ss.clones.size() == (snaps.empty() ? 1u : 2u) &&
+                  (snaps.empty() || ss.clones[0].snaps == snaps);
+      }
+      if (trimmed) {
+        return true;
+      }
+      sleep(1);
+    }
+    return false;
+  };
+
+  ASSERT_EQ(0, ioctx.selfmanaged_snap_remove(my_snaps[0]));
+  ASSERT_EQ(0, ioctx.selfmanaged_snap_remove(my_snaps[2]));
+  ASSERT_TRUE(wait_for_clones({my_snaps[1]}));
+
+  ioctx.snap_set_read(my_snaps[1]);
+  for (int i = 0; i < num_objects; ++i) {
+    bufferlist bl;
+    ASSERT_EQ((int)sizeof(buf), ioctx.read(oid(i), bl, sizeof(buf), 0));
+    ASSERT_EQ(0, memcmp(bl.c_str(), buf, sizeof(buf)));
+  }
+  ioctx.snap_set_read(LIBRADOS_SNAP_HEAD);
+
+  ASSERT_EQ(0, ioctx.selfmanaged_snap_remove(my_snaps[1]));
+  ASSERT_TRUE(wait_for_clones({}));
+  readioctx.close();
+}
+
 TEST(LibRadosPoolIsInSelfmanagedSnapsMode, NotConnected) {
   librados::Rados cluster;
   ASSERT_EQ(0, cluster.init(nullptr));
@@ -140,6 +140,79 @@ TEST_F(TestMockIoSimpleSchedulerObjectDispatch, Read) {
   ASSERT_EQ(0, cond.wait());
 }
 
+TEST_F(TestMockIoSimpleSchedulerObjectDispatch, ReadMerged) {
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockTestImageCtx mock_image_ctx(*ictx);
+  mock_image_ctx.config.set_val_or_die("rbd_io_scheduler_simple_merge_reads",
+                                       "true");
+  MockSimpleSchedulerObjectDispatch
+      mock_simple_scheduler_object_dispatch(&mock_image_ctx);
+
+  expect_get_object_name(mock_image_ctx, 0);
+
+  C_SaferCond cond1;
+  Context *on_finish1 = &cond1;
+  io::ReadExtents extents1 = {{0, 4096}};
+  ASSERT_FALSE(mock_simple_scheduler_object_dispatch.read(
+      0, &extents1, mock_image_ctx.get_data_io_context(), 0, 0, {}, nullptr,
+      nullptr, nullptr, &on_finish1, nullptr));
+  ASSERT_NE(on_finish1, &cond1);
+
+  // reads arriving while the first read is in flight are held back
+  io::DispatchResult dispatch_result;
+  C_SaferCond cond2;
+  Context *on_finish2 = &cond2;
+  C_SaferCond on_dispatched2;
+  io::ReadExtents extents2 = {{4096, 4096}};
+  ASSERT_TRUE(mock_simple_scheduler_object_dispatch.read(
+      0, &extents2, mock_image_ctx.get_data_io_context(), 0, 0, {}, nullptr,
+      nullptr, &dispatch_result, &on_finish2, &on_dispatched2));
+  ASSERT_EQ(dispatch_result, io::DISPATCH_RESULT_COMPLETE);
+
+  C_SaferCond cond3;
+  Context *on_finish3 = &cond3;
+  C_SaferCond on_dispatched3;
+  io::ReadExtents extents3 = {{2048, 4096}};
+  ASSERT_TRUE(mock_simple_scheduler_object_dispatch.read(
+      0, &extents3, mock_image_ctx.get_data_io_context(), 0, 0, {}, nullptr,
+      nullptr, &dispatch_result, &on_finish3, &on_dispatched3));
+  ASSERT_EQ(dispatch_result, io::DISPATCH_RESULT_COMPLETE);
+
+  // ... and sent as a single merged read
+  EXPECT_CALL(*mock_image_ctx.io_object_dispatcher, send(_))
+    .WillOnce(Invoke([&mock_image_ctx](ObjectDispatchSpec* spec) {
+                auto read = boost::get<ObjectDispatchSpec::ReadRequest>(
+                  &spec->request);
+                ASSERT_TRUE(read != nullptr);
+                ASSERT_EQ(1U, read->extents->size());
+                auto& extent = read->extents->front();
+                ASSERT_EQ(2048U, extent.offset);
+                ASSERT_EQ(6144U, extent.length);
+                extent.bl.append(std::string(2048, '1'));
+                extent.bl.append(std::string(2048, '2'));
+                extent.extent_map = {{2048, 2048}, {6144, 2048}};
+
+                spec->dispatch_result = io::DISPATCH_RESULT_COMPLETE;
+                mock_image_ctx.image_ctx->op_work_queue->queue(
+                    &spec->dispatcher_ctx, 0);
+              }));
+
+  on_finish1->complete(0);
+  ASSERT_EQ(0, cond1.wait());
+  ASSERT_EQ(0, on_dispatched2.wait());
+  ASSERT_EQ(0, on_dispatched3.wait());
+
+  io::Extents expected_extent_map2 = {{6144, 2048}};
+  ASSERT_EQ(expected_extent_map2, extents2[0].extent_map);
+  ASSERT_EQ(std::string(2048, '2'), extents2[0].bl.to_str());
+
+  io::Extents expected_extent_map3 = {{2048, 2048}};
+  ASSERT_EQ(expected_extent_map3, extents3[0].extent_map);
+  ASSERT_EQ(std::string(2048, '1'), extents3[0].bl.to_str());
+}
+
 TEST_F(TestMockIoSimpleSchedulerObjectDispatch, Discard) {
   librbd::ImageCtx *ictx;
   ASSERT_EQ(0, open_image(m_image_name, &ictx));
@@ -167,3 +167,44 @@ TEST(pgmap, dump_object_stat_sum_2)
   ASSERT_EQ(percentify(0), tbl.get(0, col++));
   ASSERT_EQ(stringify(byte_u_t(avail/pool.size)), tbl.get(0, col++));
 }
+
+TEST(pgmap, calc_purged_snaps_incremental)
+{
+  PGMap pg_map;
+  auto apply = [&](const map<pg_t, interval_set<snapid_t>>& updates) {
+    PGMap::Incremental inc;
+    inc.version = pg_map.get_version() + 1;
+    for (auto& [pgid, purged] : updates) {
+      pg_stat_t s;
+      s.state = PG_STATE_ACTIVE;
+      s.purged_snaps = purged;
+      inc.pg_stat_updates[pgid] = s;
+    }
+    pg_map.apply_incremental(nullptr, inc);
+    pg_map.calc_purged_snaps();
+  };
+  interval_set<snapid_t> a, b, ab;
+  a.insert(snapid_t(1), 4);
+  b.insert(snapid_t(3), 4);
+  ab.insert(snapid_t(3), 2);
+
+  apply({{pg_t(0, 1), a}, {pg_t(1, 1), a}, {pg_t(0, 2), b}});
+  ASSERT_EQ(2u, pg_map.purged_snaps.size());
+  ASSERT_EQ(a, pg_map.purged_snaps[1]);
+  ASSERT_EQ(b, pg_map.purged_snaps[2]);
+
+  // only pool 1 changes; pool 2 keeps its result
+  apply({{pg_t(1, 1), b}});
+  ASSERT_EQ(ab, pg_map.purged_snaps[1]);
+  ASSERT_EQ(b, pg_map.purged_snaps[2]);
+
+  // a removed pg no longer constrains the intersection
+  {
+    PGMap::Incremental inc;
+    inc.version = pg_map.get_version() + 1;
+    inc.pg_remove.insert(pg_t(0, 1));
+    pg_map.apply_incremental(nullptr, inc);
+    pg_map.calc_purged_snaps();
+  }
+  ASSERT_EQ(b, pg_map.purged_snaps[1]);
+}
@@ -0,0 +1,517 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+/*
+ * Open-loop messenger benchmark.
+ *
+ * Unlike ceph_perf_msgr_client, which keeps a fixed number of messages
+ * in flight, the client sends MOSDOps at a fixed target rate whether or
+ * not replies come back, and measures each reply against the time the
+ * request was *scheduled* to go out.  A stalled connection therefore
+ * shows up in the tail instead of quietly lowering the offered load.
+ * Each (size, rate) step reports latency percentiles, the achieved rate
+ * and the client's CPU time per message, as text or as json.
+ *
+ * The transport, connection mode and compression are the usual config
+ * options (--ms_type, --ms_client_mode/--ms_service_mode,
+ * --ms_osd_compress_mode, ...), so the same run can be repeated across
+ * them.
+ */
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <bit>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "auth/DummyAuth.h"
+#include "common/ceph_argparse.h"
+#include "common/ceph_time.h"
+#include "common/debug.h"
+#include "common/errno.h"
+#include "common/Formatter.h"
+#include "common/strtol.h"
+#include "global/global_init.h"
+#include "include/str_list.h"
+#include "messages/MOSDOp.h"
+#include "messages/MOSDOpReply.h"
+#include "msg/Messenger.h"
+
+using namespace std;
+
+/*
+ * Log-linear histogram of nanosecond values, HdrHistogram style: each
+ * power of two is split into 2^SUB_BITS equal buckets, so every value is
+ * recorded with a relative error below 2^-SUB_BITS (~3%).
+ */
+class LatencyHistogram {
+  static constexpr unsigned SUB_BITS = 5;
+  static constexpr uint64_t SUB_COUNT = 1ull << SUB_BITS;
+
+  vector<uint64_t> counts = vector<uint64_t>((64 - SUB_BITS + 1) * SUB_COUNT);
+  uint64_t total = 0;
+  uint64_t sum = 0;
+  uint64_t max = 0;
+
+  static unsigned index_of(uint64_t v) {
+    if (v < SUB_COUNT) {
+      return v;
+    }
+    unsigned shift = std::bit_width(v) - 1 - SUB_BITS;
+    return ((shift + 1) << SUB_BITS) | ((v >> shift) & (SUB_COUNT - 1));
+  }
+  /// largest value recorded in bucket i
+  static uint64_t highest_of(unsigned i) {
+    if (i < SUB_COUNT) {
+      return i;
+    }
+    unsigned shift = (i >> SUB_BITS) - 1;
+    return (((i & (SUB_COUNT - 1)) | SUB_COUNT) << shift) + (1ull << shift) - 1;
+  }
+
+public:
+  void record(uint64_t v) {
+    ++counts[index_of(v)];
+    ++total;
+    sum += v;
+    max = std::max(max, v);
+  }
+  void reset() {
+    std::fill(counts.begin(), counts.end(), 0);
+    total = sum = max = 0;
+  }
+  uint64_t count() const {
+    return total;
+  }
+  double mean() const {
+    return total ? (double)sum / total : 0;
+  }
+  uint64_t get_max() const {
+    return max;
+  }
+  uint64_t percentile(double p) const {
+    if (!total) {
+      return 0;
+    }
+    uint64_t want = std::max<uint64_t>(1, (uint64_t)(p / 100.0 * total + 0.5));
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < counts.size(); ++i) {
+      seen += counts[i];
+      if (seen >= want) {
+	return std::min(highest_of(i), max);
+      }
+    }
+    return max;
+  }
+};
+
+class BenchServer : public Dispatcher {
+  Messenger *msgr = nullptr;
+  DummyAuthClientServer dummy_auth;
+
+public:
+  BenchServer(const string &type)
+    : Dispatcher(g_ceph_context), dummy_auth(g_ceph_context) {
+    msgr = Messenger::create(g_ceph_context, type, entity_name_t::OSD(0),
+			     "server", 0);
+    msgr->set_default_policy(Messenger::Policy::stateless_server(0));
+    dummy_auth.auth_registry.refresh_config();
+    msgr->set_auth_server(&dummy_auth);
+  }
+  ~BenchServer() override {
+    delete msgr;
+  }
+
+  bool ms_can_fast_dispatch_any() const override { return true; }
+  bool ms_can_fast_dispatch(const Message *m) const override {
+    return m->get_type() == CEPH_MSG_OSD_OP;
+  }
+  void ms_fast_dispatch(Message *m) override {
+    auto reply = new MOSDOpReply(static_cast<MOSDOp*>(m), 0, 0, 0, false);
+    m->get_connection()->send_message(reply);
+    m->put();
+  }
+  bool ms_dispatch(Message *m) override { return true; }
+  bool ms_handle_reset(Connection *con) override { return true; }
+  void ms_handle_remote_reset(Connection *con) override {}
+  bool ms_handle_refused(Connection *con) override { return false; }
+  int ms_handle_fast_authentication(Connection *con) override {
+    return 1;
+  }
+
+  int run(const string &bindaddr) {
+    entity_addr_t addr;
+    if (!addr.parse(bindaddr.c_str())) {
+      cerr << "unable to parse bind address " << bindaddr << std::endl;
+      return -EINVAL;
+    }
+    int r = msgr->bind(addr);
+    if (r < 0) {
+      cerr << "unable to bind to " << bindaddr << ": " << cpp_strerror(r)
+	   << std::endl;
+      return r;
+    }
+    msgr->add_dispatcher_head(this);
+    msgr->start();
+    msgr->wait();
+    return 0;
+  }
+};
+
+class BenchClient : public Dispatcher {
+public:
+  struct result_t {
+    uint64_t size = 0;
+    uint64_t target_rate = 0;
+    double achieved_rate = 0;
+    uint64_t sent = 0;
+    uint64_t completed = 0;
+    double cpu_us_per_msg = 0;
+    LatencyHistogram lat;
+  };
+
+private:
+  Messenger *msgr = nullptr;
+  vector<ConnectionRef> conns;
+  DummyAuthClientServer dummy_auth;
+
+  ceph::mutex lock = ceph::make_mutex("BenchClient::lock");
+  ceph::condition_variable cond;
+  uint64_t tid_base = 1;           ///< first tid of the current step
+  vector<ceph::mono_time> intended; ///< scheduled send time, by tid - tid_base
+  uint64_t outstanding = 0;
+  LatencyHistogram *lat = nullptr;
+
+  static ceph::timespan cpu_time() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (std::chrono::seconds(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) +
+	    std::chrono::microseconds(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec));
+  }
+
+  void send_op(ConnectionRef& con, uint64_t tid, const bufferlist& data) {
+    hobject_t hobj(object_t("object-name"), "", CEPH_NOSNAP, 0, 1, "");
+    spg_t pgid(pg_t(0, 1));
+    auto m = new MOSDOp(0, tid, hobj, pgid, 0, 0, 0);
+    bufferlist bl(data);
+    m->write(0, bl.length(), bl);
+    con->send_message(m);
+  }
+
+  bool wait_for_replies(ceph::timespan timeout) {
+    std::unique_lock l(lock);
+    return cond.wait_for(l, timeout, [this] { return outstanding == 0; });
+  }
+
+public:
+  BenchClient(const string &type)
+    : Dispatcher(g_ceph_context), dummy_auth(g_ceph_context) {
+    msgr = Messenger::create(g_ceph_context, type, entity_name_t::CLIENT(0),
+			     "client", getpid());
+    msgr->set_default_policy(Messenger::Policy::lossy_client(0));
+    dummy_auth.auth_registry.refresh_config();
+    msgr->set_auth_client(&dummy_auth);
+  }
+  ~BenchClient() override {
+    msgr->shutdown();
+    msgr->wait();
+    delete msgr;
+  }
+
+  bool ms_can_fast_dispatch_any() const override { return true; }
+  bool ms_can_fast_dispatch(const Message *m) const override {
+    return m->get_type() == CEPH_MSG_OSD_OPREPLY;
+  }
+  void ms_fast_dispatch(Message *m) override {
+    auto now = ceph::mono_clock::now();
+    uint64_t tid = m->get_tid();
+    m->put();
+    std::lock_guard l(lock);
+    if (tid >= tid_base && tid - tid_base < intended.size()) {
+      if (lat) {
+	lat->record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		      now - intended[tid - tid_base]).count());
+      }
+      if (--outstanding == 0) {
+	cond.notify_all();
+      }
+    }
+  }
+  bool ms_dispatch(Message *m) override { return true; }
+  bool ms_handle_reset(Connection *con) override { return true; }
+  void ms_handle_remote_reset(Connection *con) override {}
+  bool ms_handle_refused(Connection *con) override { return false; }
+  int ms_handle_fast_authentication(Connection *con) override {
+    return 1;
+  }
+
+  int connect(const string &serveraddr, unsigned num_conns) {
+    entity_addr_t addr;
+    if (!addr.parse(serveraddr.c_str())) {
+      cerr << "unable to parse server address " << serveraddr << std::endl;
+      return -EINVAL;
+    }
+    addr.set_nonce(0);
+    msgr->add_dispatcher_head(this);
+    msgr->start();
+    for (unsigned i = 0; i < num_conns; ++i) {
+      // anonymous connections are not shared with the first one
+      conns.push_back(msgr->connect_to_osd(entity_addrvec_t(addr),
+					   false, i > 0));
+    }
+    // one round trip per connection so that the handshakes are not timed
+    {
+      std::lock_guard l(lock);
+      intended.assign(conns.size(), ceph::mono_clock::now());
+      outstanding = conns.size();
+    }
+    for (unsigned i = 0; i < conns.size(); ++i) {
+      send_op(conns[i], tid_base + i, bufferlist());
+    }
+    if (!wait_for_replies(std::chrono::seconds(30))) {
+      cerr << "no reply from " << serveraddr << std::endl;
+      return -ETIMEDOUT;
+    }
+    tid_base += conns.size();
+    return 0;
+  }
+
+  void run(uint64_t size, uint64_t rate, double duration, result_t *res) {
+    res->size = size;
+    res->target_rate = rate;
+    uint64_t n = std::max<uint64_t>(1, rate * duration);
+
+    bufferlist data;
+    if (size) {
+      bufferptr ptr(size);
+      memset(ptr.c_str(), 0, size);
+      data.append(ptr);
+    }
+
+    auto start = ceph::mono_clock::now() + std::chrono::milliseconds(10);
+    {
+      std::lock_guard l(lock);
+      intended.resize(n);
+      for (uint64_t i = 0; i < n; ++i) {
+	intended[i] = start + std::chrono::nanoseconds(i * 1000000000ull / rate);
+      }
+      outstanding = n;
+      lat = &res->lat;
+    }
+    auto cpu_start = cpu_time();
+    for (uint64_t i = 0; i < n; ++i) {
+      auto now = ceph::mono_clock::now();
+      if (intended[i] > now) {
+	std::this_thread::sleep_for(intended[i] - now);
+      }
+      // if we fell behind the schedule we send right away; the lag is
+      // still counted against the reply
+      send_op(conns[i % conns.size()], tid_base + i, data);
+    }
+    auto send_end = ceph::mono_clock::now();
+    wait_for_replies(std::chrono::seconds(10));
+    auto cpu_end = cpu_time();
+
+    std::lock_guard l(lock);
+    lat = nullptr;
+    res->sent = n;
+    res->completed = n - outstanding;
+    res->achieved_rate = n / std::max(1e-9, ceph::to_seconds<double>(
+					send_end - start));
+    res->cpu_us_per_msg =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+	cpu_end - cpu_start).count() / 1000.0 / std::max<uint64_t>(1, n);
+    // late replies of this step are ignored by the next one
+    tid_base += n;
+    intended.clear();
+    outstanding = 0;
+  }
+};
+
+static void usage(const char *name)
+{
+  cout << "usage: " << name << " server <bind ip:port>\n"
+       << "       " << name << " client <server ip:port> [options]\n"
+       << "client options:\n"
+       << "  --rates <r1,r2,...>     target messages per second (default 1000)\n"
+       << "  --sizes <s1,s2,...>     message data bytes (default 4096)\n"
+       << "  --duration <seconds>    length of each step (default 10)\n"
+       << "  --conns <n>             connections to spread the load over (default 1)\n"
+       << "  --format <plain|json|json-pretty>\n"
+       << "every (size, rate) pair is run as one step.  The transport, mode\n"
+       << "and compression come from the usual ms_* options.\n";
+}
+
+static bool parse_list(const string &s, vector<uint64_t> *out)
+{
+  out->clear();
+  for (auto& i : get_str_vec(s, ",")) {
+    string err;
+    uint64_t v = strict_iecstrtoll(i, &err);
+    if (!err.empty() || v == 0) {
+      return false;
+    }
+    out->push_back(v);
+  }
+  return !out->empty();
+}
+
+static void dump_result(const BenchClient::result_t &r, Formatter *f)
+{
+  f->open_object_section("step");
+  f->dump_unsigned("size", r.size);
+  f->dump_unsigned("target_rate", r.target_rate);
+  f->dump_float("achieved_rate", r.achieved_rate);
+  f->dump_unsigned("sent", r.sent);
+  f->dump_unsigned("completed", r.completed);
+  f->dump_float("cpu_us_per_msg", r.cpu_us_per_msg);
+  f->open_object_section("latency_us");
+  f->dump_float("mean", r.lat.mean() / 1000.0);
+  for (auto [name, p] : {pair{"p50", 50.0}, {"p90", 90.0}, {"p99", 99.0},
+			 {"p99.9", 99.9}, {"p99.99", 99.99}}) {
+    f->dump_float(name, r.lat.percentile(p) / 1000.0);
+  }
+  f->dump_float("max", r.lat.get_max() / 1000.0);
+  f->close_section();
+  f->close_section();
+}
+
+int main(int argc, char **argv)
+{
+  auto args = argv_to_vec(argc, argv);
+
+  auto cct = global_init(NULL, args, CEPH_ENTITY_TYPE_CLIENT,
+			 CODE_ENVIRONMENT_UTILITY,
+			 CINIT_FLAG_NO_DEFAULT_CONFIG_FILE);
+  common_init_finish(g_ceph_context);
+  g_ceph_context->_conf.apply_changes(nullptr);
+
+  vector<uint64_t> rates{1000}, sizes{4096};
+  double duration = 10;
+  unsigned num_conns = 1;
+  string format = "plain";
+  vector<const char*> rest;
+  for (auto i = args.begin(); i != args.end(); ) {
+    string val;
+    if (ceph_argparse_double_dash(args, i)) {
+      break;
+    } else if (ceph_argparse_flag(args, i, "-h", "--help", (char*)NULL)) {
+      usage(argv[0]);
+      return 0;
+    } else if (ceph_argparse_witharg(args, i, &val, "--rates", (char*)NULL)) {
+      if (!parse_list(val, &rates)) {
+	cerr << "bad --rates " << val << std::endl;
+	return 1;
+      }
+    } else if (ceph_argparse_witharg(args, i, &val, "--sizes", (char*)NULL)) {
+      if (!parse_list(val, &sizes)) {
+	cerr << "bad --sizes " << val << std::endl;
+	return 1;
+      }
+    } else if (ceph_argparse_witharg(args, i, &val, "--duration", (char*)NULL)) {
+      string err;
+      duration = strict_strtod(val.c_str(), &err);
+      if (!err.empty() || duration <= 0) {
+	cerr << "bad --duration " << val << std::endl;
+	return 1;
+      }
+    } else if (ceph_argparse_witharg(args, i, &val, "--conns", (char*)NULL)) {
+      string err;
+      num_conns = strict_strtol(val.c_str(), 10, &err);
+      if (!err.empty() || num_conns == 0) {
+	cerr << "bad --conns " << val << std::endl;
+	return 1;
+      }
+    } else if (ceph_argparse_witharg(args, i, &val, "--format", (char*)NULL)) {
+      format = val;
+    } else {
+      rest.push_back(*i);
+      ++i;
+    }
+  }
+  if (rest.size() != 2) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  auto& conf = g_ceph_context->_conf;
+  string type = conf->ms_public_type.empty() ?
+    conf.get_val<string>("ms_type") : conf->ms_public_type;
+
+  if (rest[0] == string("server")) {
+    BenchServer server(type);
+    return -server.run(rest[1]);
+  } else if (rest[0] != string("client")) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  BenchClient client(type);
+  if (int r = client.connect(rest[1], num_conns); r < 0) {
+    return 1;
+  }
+
+  unique_ptr<Formatter> f;
+  if (format != "plain") {
+    f.reset(Formatter::create(format, "json-pretty", "json-pretty"));
+    f->open_object_section("msgr_bench");
+    f->dump_string("ms_type", type);
+    f->dump_string("ms_client_mode", conf.get_val<string>("ms_client_mode"));
+    f->dump_string("ms_osd_compress_mode",
+		   conf.get_val<string>("ms_osd_compress_mode"));
+    f->dump_unsigned("conns", num_conns);
+    f->dump_float("duration", duration);
+    f->open_array_section("steps");
+  } else {
+    cout << "ms_type " << type
+	 << " ms_client_mode " << conf.get_val<string>("ms_client_mode")
+	 << " ms_osd_compress_mode "
+	 << conf.get_val<string>("ms_osd_compress_mode")
+	 << " conns " << num_conns << std::endl;
+    cout << "    size   target  achieved  complete  cpu_us/msg"
+	 << "     p50_us     p99_us   p99.9_us     max_us" << std::endl;
+  }
+
+  for (auto size : sizes) {
+    for (auto rate : rates) {
+      BenchClient::result_t r;
+      client.run(size, rate, duration, &r);
+      if (f) {
+	dump_result(r, f.get());
+      } else {
+	cout << std::fixed << std::setprecision(1)
+	     << std::setw(8) << r.size
+	     << std::setw(9) << r.target_rate
+	     << std::setw(10) << r.achieved_rate
+	     << std::setw(10) << r.completed
+	     << std::setw(12) << r.cpu_us_per_msg
+	     << std::setw(11) << r.lat.percentile(50) / 1000.0
+	     << std::setw(11) << r.lat.percentile(99) / 1000.0
+	     << std::setw(11) << r.lat.percentile(99.9) / 1000.0
+	     << std::setw(11) << r.lat.get_max() / 1000.0
+	     << std::endl;
+      }
+    }
+  }
+  if (f) {
+    f->close_section();
+    f->close_section();
+    f->flush(cout);
+    cout << std::endl;
+  }
+  return 0;
+}
@@ -575,6 +575,151 @@ TEST_P(NetworkWorkerTest, ComplexTest) {
   });
 }
 
+// connect a client and a server socket on one worker, for the tests that
+// only look at one connection
+static void connect_local(EventCenter *center, Worker *worker,
+                          entity_addr_t &bind_addr,
+                          ServerSocket *bind_socket,
+                          ConnectedSocket *cli_socket,
+                          ConnectedSocket *srv_socket)
+{
+  SocketOptions options;
+  entity_addr_t cli_addr;
+  ASSERT_EQ(0, worker->listen(bind_addr, 0, options, bind_socket));
+  ASSERT_EQ(0, worker->connect(bind_addr, options, cli_socket));
+  {
+    C_poll cb(center);
+    center->create_file_event(bind_socket->fd(), EVENT_READABLE, &cb);
+    ASSERT_TRUE(cb.poll(500));
+    center->delete_file_event(bind_socket->fd(), EVENT_READABLE);
+  }
+  ASSERT_EQ(0, bind_socket->accept(srv_socket, options, &cli_addr, worker));
+  C_poll cb(center);
+  center->create_file_event(cli_socket->fd(), EVENT_READABLE, &cb);
+  int r = cli_socket->is_connected();
+  if (r == 0) {
+    ASSERT_TRUE(cb.poll(500));
+    r = cli_socket->is_connected();
+  }
+  ASSERT_EQ(1, r);
+  center->delete_file_event(cli_socket->fd(), EVENT_READABLE);
+}
+
+// ms_tcp_zerocopy_min_bytes: sends below the threshold go out copied,
+// larger ones zero-copy, and their buffers are held until the kernel
+// reports them complete.  Where the kernel does not support SO_ZEROCOPY
+// everything falls back to copied sends, which must look the same.
+TEST_P(NetworkWorkerTest, ZeroCopySendTest) {
+  if (strcmp(GetParam(), "posix")) {
+    GTEST_SKIP() << "zero-copy sends are posix only";
+  }
+  entity_addr_t bind_addr;
+  ASSERT_TRUE(bind_addr.parse(get_addr().c_str()));
+  g_ceph_context->_conf.set_val("ms_tcp_zerocopy_min_bytes", "4096");
+
+  exec_events([bind_addr](Worker *worker) mutable {
+    if (worker->id != 0)
+      return;
+    EventCenter *center = &worker->center;
+    ServerSocket bind_socket;
+    ConnectedSocket cli_socket, srv_socket;
+    connect_local(center, worker, bind_addr, &bind_socket,
+                  &cli_socket, &srv_socket);
+
+    // below the threshold: a plain copied send, released right away
+    const char *message = "this is a small message";
+    size_t small_len = strlen(message);
+    bufferptr small(message, small_len);
+    bufferlist bl;
+    bl.append(small);
+    ASSERT_EQ((ssize_t)small_len, cli_socket.send(bl, false));
+    ASSERT_EQ(0u, bl.length());
+    ASSERT_EQ(1, small.raw_nref());
+
+    // above it: sent zero-copy, possibly over several calls
+    const size_t big_len = 256 << 10;
+    bufferptr big = buffer::create_page_aligned(big_len);
+    for (size_t i = 0; i < big_len; ++i) {
+      big.c_str()[i] = (char)(i * 31);
+    }
+    bl.append(big);
+
+    std::string received;
+    char buf[65536];
+    C_poll cb(center);
+    center->create_file_event(srv_socket.fd(), EVENT_READABLE, &cb);
+    while (received.size() < small_len + big_len) {
+      if (bl.length()) {
+        ssize_t r = cli_socket.send(bl, false);
+        ASSERT_GE(r, 0);
+      }
+      ssize_t r = srv_socket.read(buf, sizeof(buf));
+      if (r == -EAGAIN) {
+        cb.reset();
+        cb.poll(100);
+        continue;
+      }
+      ASSERT_GT(r, 0);
+      received.append(buf, r);
+    }
+    center->delete_file_event(srv_socket.fd(), EVENT_READABLE);
+    ASSERT_EQ(0, memcmp(received.data(), message, small_len));
+    ASSERT_EQ(0, memcmp(received.data() + small_len, big.c_str(), big_len));
+
+    // the completions go to the client's error queue, which it drains
+    // as it reads
+    for (int i = 0; i < 5000 && big.raw_nref() > 1; ++i) {
+      ASSERT_EQ(-EAGAIN, cli_socket.read(buf, sizeof(buf)));
+      usleep(1000);
+    }
+    ASSERT_EQ(1, big.raw_nref());
+
+    bind_socket.abort_accept();
+    srv_socket.close();
+    cli_socket.close();
+  });
+  g_ceph_context->_conf.rm_val("ms_tcp_zerocopy_min_bytes");
+}
+
+// a zero-copy send failing midway must not leak the buffers it holds
+TEST_P(NetworkWorkerTest, ZeroCopySendErrorTest) {
+  if (strcmp(GetParam(), "posix")) {
+    GTEST_SKIP() << "zero-copy sends are posix only";
+  }
+  entity_addr_t bind_addr;
+  ASSERT_TRUE(bind_addr.parse(get_addr().c_str()));
+  g_ceph_context->_conf.set_val("ms_tcp_zerocopy_min_bytes", "4096");
+
+  exec_events([bind_addr](Worker *worker) mutable {
+    if (worker->id != 0)
+      return;
+    EventCenter *center = &worker->center;
+    ServerSocket bind_socket;
+    ConnectedSocket cli_socket, srv_socket;
+    connect_local(center, worker, bind_addr, &bind_socket,
+                  &cli_socket, &srv_socket);
+    bind_socket.abort_accept();
+    srv_socket.close();
+
+    const size_t big_len = 256 << 10;
+    bufferptr big = buffer::create_page_aligned(big_len);
+    memset(big.c_str(), 0x5a, big_len);
+    ssize_t r = 0;
+    for (int i = 0; i < 1000 && r >= 0; ++i) {
+      bufferlist bl;
+      bl.append(big);
+      r = cli_socket.send(bl, false);
+      usleep(1000);
+    }
+    ASSERT_TRUE(r == -EPIPE || r == -ECONNRESET);
+
+    // whatever is still waiting for a completion goes with the socket
+    cli_socket.close();
+    ASSERT_EQ(1, big.raw_nref());
+  });
+  g_ceph_context->_conf.rm_val("ms_tcp_zerocopy_min_bytes");
+}
+
 class StressFactory {
   struct Client;
   struct Server;
@@ -468,6 +468,77 @@ INSTANTIATE_TEST_SUITE_P(
         ::testing::ValuesIn(round_trip_perf_instances),
         ::testing::ValuesIn(modes)));
 
+TEST(SecureModeTest, FragmentedPlaintext) {
+  AuthConnectionMeta auth_meta;
+  auth_meta.con_mode = CEPH_CON_MODE_SECURE;
+  auth_meta.connection_secret.resize(64);
+  g_ceph_context->random()->get_bytes(auth_meta.connection_secret.data(),
+                                      auth_meta.connection_secret.size());
+
+  // short buffers (coalesced before encryption) mixed with long ones
+  bufferlist fragmented;
+  for (unsigned i = 0; i < 200; i++) {
+    unsigned len = (i % 7 == 6) ? 4096 + i : 1 + (i * 37) % 600;
+    bufferptr bp(len);
+    g_ceph_context->random()->get_bytes(bp.c_str(), len);
+    fragmented.append(std::move(bp));
+  }
+  bufferlist contiguous;
+  contiguous.append(fragmented.c_str(), fragmented.length());
+  ASSERT_GT(fragmented.get_num_buffers(), 1u);
+
+  auto encrypt = [&](const bufferlist& plaintext) {
+    auto tx = ceph::crypto::onwire::rxtx_t::create_handler_pair(
+        g_ceph_context, auth_meta, /*new_nonce_format=*/true,
+        /*crossed=*/false);
+    tx.tx->reset_tx_handler({plaintext.length()});
+    tx.tx->authenticated_encrypt_update(plaintext);
+    return tx.tx->authenticated_encrypt_final();
+  };
+  bufferlist from_fragmented = encrypt(fragmented);
+  bufferlist from_contiguous = encrypt(contiguous);
+  EXPECT_TRUE(from_fragmented.contents_equal(from_contiguous));
+
+  auto rx = ceph::crypto::onwire::rxtx_t::create_handler_pair(
+      g_ceph_context, auth_meta, /*new_nonce_format=*/true,
+      /*crossed=*/true);
+  rx.rx->reset_rx_handler();
+  rx.rx->authenticated_decrypt_update_final(from_fragmented);
+  EXPECT_TRUE(from_fragmented.contents_equal(contiguous));
+}
+
+TEST(SecureModeTest, SmallFramesShareBuffer) {
+  AuthConnectionMeta auth_meta;
+  auth_meta.con_mode = CEPH_CON_MODE_SECURE;
+  auth_meta.connection_secret.resize(64);
+  g_ceph_context->random()->get_bytes(auth_meta.connection_secret.data(),
+                                      auth_meta.connection_secret.size());
+  auto tx = ceph::crypto::onwire::rxtx_t::create_handler_pair(
+      g_ceph_context, auth_meta, /*new_nonce_format=*/true,
+      /*crossed=*/false);
+  auto rx = ceph::crypto::onwire::rxtx_t::create_handler_pair(
+      g_ceph_context, auth_meta, /*new_nonce_format=*/true,
+      /*crossed=*/true);
+
+  std::vector<bufferlist> plaintexts, sealed;
+  for (unsigned i = 0; i < 3; i++) {
+    plaintexts.push_back(make_bufferlist(100 + i, 'A' + i));
+    tx.tx->reset_tx_handler({plaintexts.back().length()});
+    tx.tx->authenticated_encrypt_update(plaintexts.back());
+    sealed.push_back(tx.tx->authenticated_encrypt_final());
+    ASSERT_EQ(1u, sealed.back().get_num_buffers());
+  }
+  // sealed back to back
+  EXPECT_EQ(sealed[0].front().end_c_str(), sealed[1].front().c_str());
+  EXPECT_EQ(sealed[1].front().end_c_str(), sealed[2].front().c_str());
+
+  for (unsigned i = 0; i < 3; i++) {
+    rx.rx->reset_rx_handler();
+    rx.rx->authenticated_decrypt_update_final(sealed[i]);
+    EXPECT_TRUE(sealed[i].contents_equal(plaintexts[i]));
+  }
+}
+
 }  // namespace ceph::msgr::v2
 
 int main(int argc, char* argv[]) {
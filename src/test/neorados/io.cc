@@ -17,6 +17,7 @@
 
 #include <fmt/format.h>
 
+#include <boost/asio/as_tuple.hpp>
 #include <boost/asio/use_awaitable.hpp>
 
 #include <boost/container/flat_map.hpp>
@@ -379,3 +380,33 @@ CORO_TEST_F(NeoRadosIo, GetXattrs, NeoRadosTest) {
 
   co_return;
 }
+
+CORO_TEST_F(NeoRadosIo, Batch, NeoRadosTest) {
+  const auto bl = filled_buffer_list(0xbb, 64);
+  std::array<std::pair<neorados::Object, WriteOp>, 3> writes;
+  for (auto i = 0u; i < writes.size(); ++i) {
+    writes[i].first = fmt::format("batch{}", i);
+    writes[i].second.write_full(bl);
+  }
+  auto ecs = co_await rados().execute(pool(), std::span(writes),
+				      asio::use_awaitable);
+  EXPECT_EQ(writes.size(), ecs.size());
+
+  // per-op results, with the first failure as the batch's
+  std::array<buffer::list, 3> resbl;
+  std::array<std::pair<neorados::Object, ReadOp>, 3> reads;
+  for (auto i = 0u; i < reads.size(); ++i) {
+    reads[i].first = fmt::format("batch{}", i == 1 ? 9 : i);
+    reads[i].second.read(0, 0, &resbl[i]);
+  }
+  auto [ec, rs] = co_await rados().execute(
+    pool(), std::span(reads), asio::as_tuple(asio::use_awaitable));
+  EXPECT_EQ(sys::errc::no_such_file_or_directory, ec);
+  EXPECT_EQ(reads.size(), rs.size());
+  EXPECT_FALSE(rs[0]);
+  EXPECT_EQ(sys::errc::no_such_file_or_directory, rs[1]);
+  EXPECT_FALSE(rs[2]);
+  EXPECT_EQ(bl, resbl[0]);
+  EXPECT_EQ(bl, resbl[2]);
+  co_return;
+}
@@ -13,6 +13,7 @@
 #include "include/stringify.h"
 #include "include/Context.h"
 #include "os/bluestore/Allocator.h"
+#include "os/bluestore/CachingAllocator.h"
 
 using namespace std;
 
@@ -652,6 +653,59 @@ TEST_P(AllocTest, test_init_rm_free_unbound)
   }
 }
 
+TEST_P(AllocTest, test_caching_allocator)
+{
+  int64_t block_size = 0x1000;
+  int64_t capacity = 0x40000000;
+  CachingAllocator ca(g_ceph_context,
+		      Allocator::create(g_ceph_context, GetParam(), capacity,
+					block_size),
+		      0x100000, 0x10000, 0x400000, 4, "");
+  ca.init_add_free(0, capacity);
+  ASSERT_EQ((uint64_t)capacity, ca.get_free());
+
+  auto worker = [&ca](size_t seed) {
+    gen_type rng(seed);
+    boost::uniform_int<> u(1, 16);
+    std::vector<PExtentVector> held;
+    for (size_t i = 0; i < 2000; i++) {
+      uint64_t want = u(rng) * 0x1000;
+      PExtentVector extents;
+      ASSERT_EQ((int64_t)want, ca.allocate(want, 0x1000, 0, 0, &extents));
+      held.push_back(std::move(extents));
+      if (i % 3 == 0) {
+	ca.release(held.front());
+	held.erase(held.begin());
+      }
+    }
+    for (auto& e : held) {
+      ca.release(e);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; i++) {
+    threads.emplace_back(worker, i);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  // everything came back, part of it may still sit in the caches
+  ASSERT_EQ((uint64_t)capacity, ca.get_free());
+
+  // bigger and differently aligned requests bypass the caches
+  PExtentVector extents;
+  ASSERT_EQ(0x200000, ca.allocate(0x200000, 0x10000, 0, 0, &extents));
+  ca.release(extents);
+
+  uint64_t total = 0;
+  ca.foreach([&](size_t off, size_t len) {
+    total += len;
+  });
+  ASSERT_EQ((uint64_t)capacity, total);
+  ASSERT_EQ(0u, ca.get_cached());
+  ca.shutdown();
+}
+
 INSTANTIATE_TEST_SUITE_P(
   Allocator,
   AllocTest,
@@ -0,0 +1,502 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Feed a KeyValueDB with the key patterns of BlueStore or of the monitor.
+ *
+ * test/kv_store_bench and test/omap_bench write uniform keys through
+ * higher layers, and predate column family sharding.  What BlueStore
+ * commits for a client write is an onode and an extent shard under O,
+ * pg log keys under P (added at the head, trimmed at the tail), omap
+ * keys under p, a deferred write under L that is removed again shortly after, and
+ * freelist bitmap merges under b.  The monitor commits a paxos value and
+ * the service state it carries, and trims old versions in batches.
+ *
+ * This tool generates either pattern from a number of threads, against
+ * a store opened with the given options and sharding (by default those
+ * BlueStore or the monitor would use), and reports commit latency
+ * percentiles, write amplification as measured by the bytes this process
+ * wrote to storage, and the time writes were stopped or delayed by
+ * RocksDB.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/ceph_argparse.h"
+#include "common/errno.h"
+#include "common/Formatter.h"
+#include "common/strtol.h"
+#include "global/global_context.h"
+#include "global/global_init.h"
+#include "include/ceph_hash.h"
+#include "kv/KeyValueDB.h"
+
+using namespace std;
+using ceph::bufferlist;
+using steady = std::chrono::steady_clock;
+
+static void usage()
+{
+  cout << "usage: ceph_perf_keyvaluedb --path DIR [flags]\n"
+    "  --workload bluestore|mon  key patterns to issue (bluestore)\n"
+    "  --db-type TYPE       KeyValueDB backend (rocksdb)\n"
+    "  --options STR        backend options (bluestore_rocksdb_options, or\n"
+    "                       mon_rocksdb_options for mon)\n"
+    "  --sharding STR       column family sharding (bluestore_rocksdb_cfs,\n"
+    "                       none for mon); \"\" for none\n"
+    "  --threads N          writing threads, each with its own PG (1);\n"
+    "                       bluestore only\n"
+    "  --ops N              transactions per thread (100000)\n"
+    "  --duration SECS      stop after this long instead, if set\n"
+    "  --objects N          objects per thread (10000)\n"
+    "  --value-size BYTES   deferred write or paxos value size (4K)\n"
+    "  --omap-ratio N       percent of writes that update omap (25)\n"
+    "  --deferred-ratio N   percent of writes that are deferred (50)\n"
+    "  --pglog-size N       pg log entries kept per thread (3000)\n"
+    "  --seed N             random seed (0)\n"
+    "  --stats              dump the backend statistics at the end\n"
+       << std::endl;
+  generic_server_usage();
+}
+
+struct Config {
+  std::string path;
+  std::string workload = "bluestore";
+  std::string db_type = "rocksdb";
+  std::string options;
+  std::string sharding;
+  bool have_options = false;
+  bool have_sharding = false;
+  int threads = 1;
+  uint64_t ops = 100000;
+  int duration = 0;
+  uint64_t objects = 10000;
+  uint64_t value_size = 4096;
+  uint64_t omap_ratio = 25;
+  uint64_t deferred_ratio = 50;
+  uint64_t pglog_size = 3000;
+  uint64_t seed = 0;
+  bool stats = false;
+};
+
+// BlueStore's prefixes, see BlueStore.cc
+static const std::string PREFIX_OBJ = "O";
+static const std::string PREFIX_PGMETA_OMAP = "P";
+static const std::string PREFIX_PERPG_OMAP = "p";
+static const std::string PREFIX_DEFERRED = "L";
+static const std::string PREFIX_ALLOC_BITMAP = "b";
+
+struct XorMergeOperator : public KeyValueDB::MergeOperator {
+  void merge_nonexistent(
+    const char *rdata, size_t rlen, std::string *new_value) override {
+    *new_value = std::string(rdata, rlen);
+  }
+  void merge(
+    const char *ldata, size_t llen,
+    const char *rdata, size_t rlen,
+    std::string *new_value) override {
+    ceph_assert(llen == rlen);
+    *new_value = std::string(ldata, llen);
+    for (size_t i = 0; i < rlen; ++i) {
+      (*new_value)[i] ^= rdata[i];
+    }
+  }
+  const char *name() const override {
+    return "bitwise_xor";
+  }
+};
+
+static void append_be(std::string& s, uint64_t v, int bytes)
+{
+  for (int i = bytes - 1; i >= 0; --i) {
+    s.push_back((char)(v >> (i * 8)));
+  }
+}
+
+static std::string u64_key(uint64_t v)
+{
+  std::string k;
+  append_be(k, v, 8);
+  return k;
+}
+
+/// what one thread issues, and what it saw
+class Writer {
+  const Config& cfg;
+  KeyValueDB *db;
+  const int id;
+  std::mt19937_64 rng;
+  bufferlist filler;
+
+  uint64_t user_bytes = 0;
+  std::vector<uint32_t> lat_us;
+
+  // bluestore
+  uint64_t pglog_head = 0, pglog_tail = 0;
+  uint64_t deferred_seq = 0;
+  std::vector<uint64_t> deferred_pending;
+
+  // mon
+  uint64_t paxos_version = 0, paxos_first = 1;
+
+  bufferlist value(size_t len) {
+    bufferlist bl;
+    bl.append(filler.c_str(), std::min<size_t>(len, filler.length()));
+    while (bl.length() < len) {
+      bl.append(filler.c_str(), std::min<size_t>(len - bl.length(),
+						 filler.length()));
+    }
+    return bl;
+  }
+  void set(KeyValueDB::Transaction& t, const std::string& prefix,
+	   const std::string& key, bufferlist bl) {
+    user_bytes += key.size() + bl.length();
+    t->set(prefix, key, bl);
+  }
+
+  std::string onode_key(uint64_t o) const {
+    // shard, pool, hash and name, as in get_object_key()
+    std::string k;
+    k.push_back((char)0x7f);
+    append_be(k, 0x8000000000000000ull + 1 + id, 8);
+    append_be(k, ceph_str_hash_rjenkins((char*)&o, sizeof(o)), 4);
+    k.push_back('!');
+    k += "rbd_data.1234567890ab." + std::to_string(o);
+    k.append("!!\xfe\xff\xff\xff\xff\xff\xff\xff\xfeo", 13);
+    return k;
+  }
+  std::string omap_key(uint64_t nid, const std::string& name) const {
+    // pool, hash and nid, as in get_omap_key() of per-pg omap
+    std::string k;
+    append_be(k, 1 + id, 8);
+    append_be(k, id, 4);
+    append_be(k, nid, 8);
+    k.push_back('.');
+    k += name;
+    return k;
+  }
+
+  void bluestore_op(KeyValueDB::Transaction& t) {
+    const uint64_t o = rng() % cfg.objects;
+    const std::string okey = onode_key(o);
+    // onode, and one extent shard of it
+    set(t, PREFIX_OBJ, okey, value(400 + rng() % 300));
+    std::string skey = okey;
+    append_be(skey, (rng() % 4) << 20, 4);
+    skey.push_back('x');
+    set(t, PREFIX_OBJ, skey, value(200 + rng() % 600));
+
+    // pg log entry and info on the pgmeta object, trimmed at the tail
+    const uint64_t pgmeta = 0xffff0000ull + id;
+    char name[32];
+    snprintf(name, sizeof(name), "%010u.%020llu", 1u,
+	     (unsigned long long)++pglog_head);
+    set(t, PREFIX_PGMETA_OMAP, omap_key(pgmeta, name), value(180));
+    set(t, PREFIX_PGMETA_OMAP, omap_key(pgmeta, "_info"), value(900));
+    if (pglog_head - pglog_tail > cfg.pglog_size) {
+      snprintf(name, sizeof(name), "%010u.%020llu", 1u,
+	       (unsigned long long)++pglog_tail);
+      t->rmkey(PREFIX_PGMETA_OMAP, omap_key(pgmeta, name));
+    }
+
+    if (rng() % 100 < cfg.omap_ratio) {
+      for (int i = 0; i < 4; ++i) {
+	set(t, PREFIX_PERPG_OMAP,
+	    omap_key(o + 1, "key_" + std::to_string(rng() % 64)),
+	    value(64 + rng() % 192));
+      }
+    }
+
+    if (rng() % 100 < cfg.deferred_ratio) {
+      // small writes go through L, and are removed once applied
+      uint64_t seq = ((uint64_t)id << 48) | ++deferred_seq;
+      set(t, PREFIX_DEFERRED, u64_key(seq), value(cfg.value_size));
+      deferred_pending.push_back(seq);
+      if (deferred_pending.size() > 32) {
+	t->rmkey(PREFIX_DEFERRED, u64_key(deferred_pending.front()));
+	deferred_pending.erase(deferred_pending.begin());
+      }
+    } else {
+      // a new allocation flips bits of the freelist
+      bufferlist bl;
+      bl.append_zero(128);
+      bl.c_str()[rng() % 128] = (char)(1 << (rng() % 8));
+      std::string k = u64_key((rng() % (1ull << 20)) << 19);
+      user_bytes += k.size() + bl.length();
+      t->merge(PREFIX_ALLOC_BITMAP, k, bl);
+    }
+  }
+
+  void mon_op(KeyValueDB::Transaction& t) {
+    // a paxos commit carries an osdmap incremental and log entries
+    ++paxos_version;
+    set(t, "paxos", std::to_string(paxos_version), value(cfg.value_size));
+    set(t, "paxos", "last_committed", value(8));
+    set(t, "osdmap", std::to_string(paxos_version), value(cfg.value_size / 2));
+    set(t, "osdmap", "last_committed", value(8));
+    for (int i = 0; i < 4; ++i) {
+      set(t, "logm", "full_" + std::to_string(paxos_version * 4 + i),
+	  value(256));
+    }
+    set(t, "logm", "last_committed", value(8));
+    // trim old versions in batches of 500, as paxos_service_trim_max
+    if (paxos_version - paxos_first > 1000) {
+      for (uint64_t v = paxos_first; v < paxos_first + 500; ++v) {
+	t->rmkey("paxos", std::to_string(v));
+	t->rmkey("osdmap", std::to_string(v));
+      }
+      paxos_first += 500;
+      set(t, "paxos", "first_committed", value(8));
+      set(t, "osdmap", "first_committed", value(8));
+    }
+  }
+
+public:
+  Writer(const Config& cfg, KeyValueDB *db, int id)
+    : cfg(cfg), db(db), id(id), rng(cfg.seed + id) {
+    std::string s(64 << 10, 0);
+    for (auto& c : s) {
+      c = (char)rng();
+    }
+    filler.append(s);
+  }
+
+  void run(const std::atomic<bool>& stop) {
+    lat_us.reserve(cfg.duration ? 1 << 20 : cfg.ops);
+    for (uint64_t n = 0; (cfg.duration || n < cfg.ops) && !stop; ++n) {
+      auto t = db->get_transaction();
+      if (cfg.workload == "mon") {
+	mon_op(t);
+      } else {
+	bluestore_op(t);
+      }
+      auto start = steady::now();
+      int r = db->submit_transaction_sync(t);
+      ceph_assert(r == 0);
+      lat_us.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+			 steady::now() - start).count());
+    }
+  }
+
+  uint64_t get_user_bytes() const {
+    return user_bytes;
+  }
+  const std::vector<uint32_t>& get_latencies() const {
+    return lat_us;
+  }
+};
+
+/// bytes this process had storage write, from /proc/self/io
+static uint64_t process_write_bytes()
+{
+  std::ifstream in("/proc/self/io");
+  std::string k;
+  uint64_t v;
+  while (in >> k >> v) {
+    if (k == "write_bytes:") {
+      return v;
+    }
+  }
+  return 0;
+}
+
+int main(int argc, const char **argv)
+{
+  auto args = argv_to_vec(argc, argv);
+  if (args.empty()) {
+    cerr << argv[0] << ": -h or --help for usage" << std::endl;
+    exit(1);
+  }
+  if (ceph_argparse_need_usage(args)) {
+    usage();
+    exit(0);
+  }
+
+  auto cct = global_init(nullptr, args, CEPH_ENTITY_TYPE_CLIENT,
+			 CODE_ENVIRONMENT_UTILITY,
+			 CINIT_FLAG_NO_DEFAULT_CONFIG_FILE);
+
+  Config cfg;
+  std::string val, err;
+  auto parse_size = [&](uint64_t *v, const char *what) {
+    *v = strict_iecstrtoll(val, &err);
+    if (!err.empty()) {
+      cerr << "error parsing " << what << ": " << err << std::endl;
+      exit(1);
+    }
+  };
+  for (auto i = args.begin(); i != args.end(); ) {
+    if (ceph_argparse_double_dash(args, i)) {
+      break;
+    } else if (ceph_argparse_witharg(args, i, &cfg.path, "--path", (char*)nullptr)) {
+    } else if (ceph_argparse_witharg(args, i, &cfg.workload, "--workload", (char*)nullptr)) {
+    } else if (ceph_argparse_witharg(args, i, &cfg.db_type, "--db-type", (char*)nullptr)) {
+    } else if (ceph_argparse_witharg(args, i, &cfg.options, "--options", (char*)nullptr)) {
+      cfg.have_options = true;
+    } else if (ceph_argparse_witharg(args, i, &cfg.sharding, "--sharding", (char*)nullptr)) {
+      cfg.have_sharding = true;
+    } else if (ceph_argparse_witharg(args, i, &cfg.threads, cerr,
+				     "--threads", (char*)nullptr)) {
+    } else if (ceph_argparse_witharg(args, i, &cfg.duration, cerr,
+				     "--duration", (char*)nullptr)) {
+    } else if (ceph_argparse_witharg(args, i, &val, "--ops", (char*)nullptr)) {
+      parse_size(&cfg.ops, "ops");
+    } else if (ceph_argparse_witharg(args, i, &val, "--objects", (char*)nullptr)) {
+      parse_size(&cfg.objects, "objects");
+    } else if (ceph_argparse_witharg(args, i, &val, "--value-size", (char*)nullptr)) {
+      parse_size(&cfg.value_size, "value-size");
+    } else if (ceph_argparse_witharg(args, i, &val, "--omap-ratio", (char*)nullptr)) {
+      parse_size(&cfg.omap_ratio, "omap-ratio");
+    } else if (ceph_argparse_witharg(args, i, &val, "--deferred-ratio", (char*)nullptr)) {
+      parse_size(&cfg.deferred_ratio, "deferred-ratio");
+    } else if (ceph_argparse_witharg(args, i, &val, "--pglog-size", (char*)nullptr)) {
+      parse_size(&cfg.pglog_size, "pglog-size");
+    } else if (ceph_argparse_witharg(args, i, &val, "--seed", (char*)nullptr)) {
+      parse_size(&cfg.seed, "seed");
+    } else if (ceph_argparse_flag(args, i, "--stats", (char*)nullptr)) {
+      cfg.stats = true;
+    } else {
+      cerr << "Error: can't understand argument: " << *i << std::endl;
+      exit(1);
+    }
+  }
+  if (cfg.path.empty()) {
+    cerr << "--path is required" << std::endl;
+    exit(1);
+  }
+  if (cfg.workload != "bluestore" && cfg.workload != "mon") {
+    cerr << "unknown workload " << cfg.workload << std::endl;
+    exit(1);
+  }
+  if (cfg.threads <= 0 || cfg.objects == 0) {
+    cerr << "threads and objects must be positive" << std::endl;
+    exit(1);
+  }
+  const bool mon = cfg.workload == "mon";
+  if (mon && cfg.threads != 1) {
+    cerr << "the monitor commits from a single thread" << std::endl;
+    exit(1);
+  }
+  if (!cfg.have_options && cfg.db_type == "rocksdb") {
+    cfg.options = mon ? g_conf().get_val<std::string>("mon_rocksdb_options")
+		      : g_conf()->bluestore_rocksdb_options;
+  }
+  if (!cfg.have_sharding && !mon) {
+    cfg.sharding = g_conf().get_val<std::string>("bluestore_rocksdb_cfs");
+  }
+
+  common_init_finish(g_ceph_context);
+
+  std::unique_ptr<KeyValueDB> db(
+    KeyValueDB::create(g_ceph_context, cfg.db_type, cfg.path));
+  if (!db) {
+    cerr << "unknown db type " << cfg.db_type << std::endl;
+    exit(1);
+  }
+  if (!mon) {
+    db->set_merge_operator(PREFIX_ALLOC_BITMAP,
+			   std::make_shared<XorMergeOperator>());
+  }
+  db->init(cfg.options);
+  std::ostringstream ss;
+  if (int r = db->create_and_open(ss, cfg.sharding); r < 0) {
+    cerr << "failed to open " << cfg.path << ": " << cpp_strerror(r) << " "
+	 << ss.str() << std::endl;
+    exit(1);
+  }
+
+  cout << "workload " << cfg.workload << ", " << cfg.threads << " threads\n"
+       << "options " << cfg.options << "\n"
+       << "sharding " << (cfg.sharding.empty() ? "none" : cfg.sharding)
+       << std::endl;
+
+  // time writes are stopped or delayed, sampled every 10ms
+  std::atomic<bool> stop{false};
+  uint64_t stopped_ms = 0, delayed_ms = 0;
+  std::thread sampler([&] {
+    while (!stop) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      uint64_t v = 0;
+      if (db->get_property("rocksdb.is-write-stopped", &v) && v) {
+	stopped_ms += 10;
+      } else if (db->get_property("rocksdb.actual-delayed-write-rate", &v) &&
+		 v) {
+	delayed_ms += 10;
+      }
+    }
+  });
+
+  std::vector<std::unique_ptr<Writer>> writers;
+  for (int i = 0; i < cfg.threads; ++i) {
+    writers.push_back(std::make_unique<Writer>(cfg, db.get(), i));
+  }
+  const uint64_t written_before = process_write_bytes();
+  const auto start = steady::now();
+  std::vector<std::thread> threads;
+  std::atomic<bool> done{false};
+  for (auto& w : writers) {
+    threads.emplace_back([&w, &done] { w->run(done); });
+  }
+  if (cfg.duration) {
+    std::this_thread::sleep_for(std::chrono::seconds(cfg.duration));
+    done = true;
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  std::chrono::duration<double> elapsed = steady::now() - start;
+  const uint64_t written = process_write_bytes() - written_before;
+  stop = true;
+  sampler.join();
+
+  std::vector<uint32_t> lat;
+  uint64_t user_bytes = 0;
+  for (auto& w : writers) {
+    auto& l = w->get_latencies();
+    lat.insert(lat.end(), l.begin(), l.end());
+    user_bytes += w->get_user_bytes();
+  }
+  if (lat.empty()) {
+    cerr << "no transactions were submitted" << std::endl;
+    exit(1);
+  }
+  std::sort(lat.begin(), lat.end());
+  auto at = [&lat](double q) {
+    return lat[std::min<size_t>(q * lat.size(), lat.size() - 1)];
+  };
+  cout << "transactions " << lat.size() << " in " << elapsed.count() << "s, "
+       << lat.size() / elapsed.count() << "/s\n"
+       << "commit latency us: p50 " << at(0.5) << " p99 " << at(0.99)
+       << " p99.9 " << at(0.999) << " max " << lat.back() << "\n"
+       << "user bytes " << user_bytes << ", written " << written
+       << ", write amplification "
+       << (user_bytes ? (double)written / user_bytes : 0) << "\n"
+       << "writes stopped " << stopped_ms << "ms, delayed " << delayed_ms
+       << "ms" << std::endl;
+  for (auto p : {"rocksdb.total-sst-files-size",
+		 "rocksdb.estimate-pending-compaction-bytes",
+		 "rocksdb.num-running-compactions"}) {
+    uint64_t v;
+    if (db->get_property(p, &v)) {
+      cout << p << " " << v << std::endl;
+    }
+  }
+  if (cfg.stats) {
+    std::unique_ptr<ceph::Formatter> f(
+      ceph::Formatter::create("json-pretty"));
+    f->open_object_section("stats");
+    db->get_statistics(f.get());
+    f->close_section();
+    f->flush(cout);
+    cout << std::endl;
+  }
+  db->close();
+  return 0;
+}
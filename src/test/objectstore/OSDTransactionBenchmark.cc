@@ -0,0 +1,614 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Replay OSD shaped transaction mixes against an ObjectStore.
+ *
+ * ceph_perf_objectstore and ceph_objectstore_bench only issue plain
+ * writes.  What the OSD queues is rather different: a client write also
+ * updates the object info and snapset xattrs, appends to (and trims) the
+ * pg log in the pgmeta omap, and may clone the head first; EC pools
+ * write shards and a hash info xattr; deletes drop objects with omap.
+ * This tool builds such transactions from a weighted mix, queues them
+ * from one thread per PG with a bounded number in flight, and reports
+ * commit latency per kind of transaction together with the store's own
+ * counters.  The transactions can be recorded and replayed later, so the
+ * same sequence can be fed to different builds or stores.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+
+#include "common/ceph_argparse.h"
+#include "common/Cond.h"
+#include "common/errno.h"
+#include "common/Formatter.h"
+#include "common/perf_counters_collection.h"
+#include "common/strtol.h"
+#include "global/global_init.h"
+#include "os/ObjectStore.h"
+#include "osd/osd_types.h"
+
+using namespace std;
+using ceph::bufferlist;
+
+static void usage()
+{
+  cout << "usage: ceph_perf_osd_transactions [flags]\n"
+    "  --threads N          number of PGs, each fed by its own thread (1)\n"
+    "  --queue-depth N      transactions in flight per PG (16)\n"
+    "  --ops N              transactions per PG (10000)\n"
+    "  --duration SECS      stop after this long instead, if set\n"
+    "  --objects N          objects per PG (1000)\n"
+    "  --write-size BYTES   client write size (4K)\n"
+    "  --object-size BYTES  object size writes are spread over (4M)\n"
+    "  --ec-k N             data chunks of the EC shard writes (4)\n"
+    "  --pglog-size N       pg log entries kept before trimming (3000)\n"
+    "  --mix KIND=W,...     weights of write, ec_write, clone, omap and\n"
+    "                       delete transactions (write=100)\n"
+    "  --seed N             random seed (0)\n"
+    "  --record FILE        save the transactions issued to FILE\n"
+    "  --replay FILE        issue the transactions saved in FILE instead\n"
+    "  --perf-dump          dump the store's perf counters at the end\n"
+       << std::endl;
+  generic_server_usage();
+}
+
+enum txn_kind : uint8_t {
+  TXN_WRITE,
+  TXN_EC_WRITE,
+  TXN_CLONE,
+  TXN_OMAP,
+  TXN_DELETE,
+  TXN_MAX
+};
+
+static const char *kind_names[TXN_MAX] = {
+  "write", "ec_write", "clone", "omap", "delete"
+};
+
+struct Config {
+  int threads = 1;
+  int queue_depth = 16;
+  uint64_t ops = 10000;
+  int duration = 0;
+  uint64_t objects = 1000;
+  uint64_t write_size = 4096;
+  uint64_t object_size = 4 << 20;
+  unsigned ec_k = 4;
+  uint64_t pglog_size = 3000;
+  std::vector<unsigned> weights = std::vector<unsigned>(TXN_MAX);
+  uint64_t seed = 0;
+  std::string record;
+  std::string replay;
+  bool perf_dump = false;
+
+  Config() {
+    weights[TXN_WRITE] = 100;
+  }
+};
+
+static bool parse_mix(const std::string& s, Config *cfg, std::string *err)
+{
+  std::fill(cfg->weights.begin(), cfg->weights.end(), 0);
+  std::vector<std::string> items;
+  get_str_vec(s, ",", items);
+  for (auto& item : items) {
+    auto eq = item.find('=');
+    auto name = item.substr(0, eq);
+    auto k = std::find(std::begin(kind_names), std::end(kind_names), name);
+    if (k == std::end(kind_names)) {
+      *err = "unknown transaction kind '" + name + "'";
+      return false;
+    }
+    unsigned w = 1;
+    if (eq != std::string::npos) {
+      w = strict_strtol(item.substr(eq + 1), 10, err);
+      if (!err->empty()) {
+	return false;
+      }
+    }
+    cfg->weights[k - std::begin(kind_names)] = w;
+  }
+  return true;
+}
+
+/// commit latencies of one kind of transaction
+struct latency_stats {
+  std::vector<double> lat;  // seconds
+
+  void merge(const latency_stats& o) {
+    lat.insert(lat.end(), o.lat.begin(), o.lat.end());
+  }
+  double percentile(double q) {
+    if (lat.empty()) {
+      return 0;
+    }
+    size_t n = std::min<size_t>(q * lat.size(), lat.size() - 1);
+    std::nth_element(lat.begin(), lat.begin() + n, lat.end());
+    return lat[n];
+  }
+  double avg() const {
+    double sum = 0;
+    for (auto l : lat) {
+      sum += l;
+    }
+    return lat.empty() ? 0 : sum / lat.size();
+  }
+};
+
+/// one PG worth of collections, objects and the state the OSD would keep
+/// for them, enough to build transactions that a real OSD could send
+class PGWorkload {
+  const Config& cfg;
+  const int id;
+  std::mt19937_64 rng;
+
+  coll_t cid, ec_cid;
+  ghobject_t pgmeta, ec_pgmeta;
+  struct object_state {
+    bool exists = false;
+    std::vector<snapid_t> clones;
+  };
+  std::vector<object_state> objects;
+  uint64_t version = 0;
+  snapid_t snap_seq = 1;
+
+  bufferlist data, ec_data, oi, snapset, hinfo, log_entry, info;
+
+  ghobject_t head(uint64_t i, bool ec, snapid_t snap = CEPH_NOSNAP) const {
+    const int64_t pool = ec ? 2 : 1;
+    return ghobject_t(
+      hobject_t(object_t("obj_" + std::to_string(i)), "", snap,
+		id, pool, ""),
+      ghobject_t::NO_GEN,
+      ec ? shard_id_t(0) : shard_id_t::NO_SHARD);
+  }
+
+  uint64_t random_offset(uint64_t len) {
+    const uint64_t blocks = std::max<uint64_t>(cfg.object_size / len, 1);
+    return (rng() % blocks) * len;
+  }
+
+  /// the pg log append, and the trim of the oldest entry, that every
+  /// modifying transaction carries
+  void log_update(ObjectStore::Transaction& t, const coll_t& c,
+		  const ghobject_t& meta) {
+    ++version;
+    char key[64];
+    snprintf(key, sizeof(key), "%010u.%020llu", 1u, (unsigned long long)version);
+    std::map<std::string, bufferlist> keys;
+    keys[key] = log_entry;
+    keys["_info"] = info;
+    t.omap_setkeys(c, meta, keys);
+    if (version > cfg.pglog_size) {
+      snprintf(key, sizeof(key), "%010u.%020llu", 1u,
+	       (unsigned long long)(version - cfg.pglog_size));
+      t.omap_rmkey(c, meta, key);
+    }
+  }
+
+public:
+  PGWorkload(const Config& cfg, int id)
+    : cfg(cfg), id(id), rng(cfg.seed + id), objects(cfg.objects) {
+    spg_t pg(pg_t(id, 1));
+    spg_t ec_pg(pg_t(id, 2), shard_id_t(0));
+    cid = coll_t(pg);
+    ec_cid = coll_t(ec_pg);
+    pgmeta = pg.make_pgmeta_oid();
+    ec_pgmeta = ec_pg.make_pgmeta_oid();
+
+    // about the sizes the OSD encodes for a small object
+    data.append_zero(cfg.write_size);
+    ec_data.append_zero(std::max<uint64_t>(cfg.write_size / cfg.ec_k, 4096));
+    oi.append_zero(256);
+    snapset.append_zero(32);
+    hinfo.append_zero(32 + 4 * (cfg.ec_k + 2));
+    log_entry.append_zero(180);
+    info.append_zero(160);
+  }
+
+  const coll_t& get_cid() const { return cid; }
+  const coll_t& get_ec_cid() const { return ec_cid; }
+
+  void init(ObjectStore::Transaction& t, ObjectStore::Transaction& ec_t) {
+    t.create_collection(cid, 0);
+    t.touch(cid, pgmeta);
+    ec_t.create_collection(ec_cid, 0);
+    ec_t.touch(ec_cid, ec_pgmeta);
+  }
+
+  txn_kind pick_kind() {
+    unsigned total = 0;
+    for (auto w : cfg.weights) {
+      total += w;
+    }
+    unsigned r = rng() % total;
+    for (unsigned k = 0; k < TXN_MAX; ++k) {
+      if (r < cfg.weights[k]) {
+	return txn_kind(k);
+      }
+      r -= cfg.weights[k];
+    }
+    return TXN_WRITE;
+  }
+
+  /// build the next transaction of the given kind; kinds that need an
+  /// existing object degrade to a write when the object picked is absent
+  txn_kind build(txn_kind kind, ObjectStore::Transaction& t) {
+    const uint64_t i = rng() % objects.size();
+    auto& o = objects[i];
+    if (!o.exists && (kind == TXN_CLONE || kind == TXN_OMAP ||
+		      kind == TXN_DELETE)) {
+      kind = TXN_WRITE;
+    }
+    switch (kind) {
+    case TXN_WRITE:
+      {
+	auto oid = head(i, false);
+	t.write(cid, oid, random_offset(cfg.write_size), data.length(), data);
+	t.setattr(cid, oid, OI_ATTR, oi);
+	t.setattr(cid, oid, SS_ATTR, snapset);
+	log_update(t, cid, pgmeta);
+	o.exists = true;
+      }
+      break;
+    case TXN_EC_WRITE:
+      {
+	// every EC write rewrites the object info and the shard hashes
+	auto oid = head(i, true);
+	t.write(ec_cid, oid, random_offset(ec_data.length()), ec_data.length(),
+		ec_data);
+	t.setattr(ec_cid, oid, OI_ATTR, oi);
+	t.setattr(ec_cid, oid, "hinfo_key", hinfo);
+	log_update(t, ec_cid, ec_pgmeta);
+      }
+      break;
+    case TXN_CLONE:
+      {
+	// the first write to the head after a snapshot
+	auto oid = head(i, false);
+	auto clone = head(i, false, ++snap_seq);
+	t.clone(cid, oid, clone);
+	t.setattr(cid, clone, OI_ATTR, oi);
+	t.write(cid, oid, random_offset(cfg.write_size), data.length(), data);
+	t.setattr(cid, oid, OI_ATTR, oi);
+	t.setattr(cid, oid, SS_ATTR, snapset);
+	log_update(t, cid, pgmeta);
+	o.clones.push_back(snap_seq);
+      }
+      break;
+    case TXN_OMAP:
+      {
+	// an index update, as from rgw or cephfs directories
+	auto oid = head(i, false);
+	std::map<std::string, bufferlist> keys;
+	const unsigned n = 1 + rng() % 8;
+	for (unsigned k = 0; k < n; ++k) {
+	  keys["key_" + std::to_string(rng() % 100000)] = log_entry;
+	}
+	t.omap_setkeys(cid, oid, keys);
+	t.setattr(cid, oid, OI_ATTR, oi);
+	log_update(t, cid, pgmeta);
+      }
+      break;
+    case TXN_DELETE:
+      {
+	for (auto s : o.clones) {
+	  t.remove(cid, head(i, false, s));
+	}
+	t.remove(cid, head(i, false));
+	log_update(t, cid, pgmeta);
+	o = object_state();
+      }
+      break;
+    default:
+      ceph_abort();
+    }
+    return kind;
+  }
+};
+
+class C_Committed : public Context {
+  std::function<void()> f;
+public:
+  explicit C_Committed(std::function<void()>&& f) : f(std::move(f)) {}
+  void finish(int r) override {
+    f();
+  }
+};
+
+struct worker_result {
+  latency_stats stats[TXN_MAX];
+  uint64_t done = 0;
+  bufferlist recorded;
+};
+
+/// issue transactions at most queue_depth at a time, either generated
+/// from the workload or decoded from a recording
+static void run_worker(ObjectStore *os, const Config& cfg, PGWorkload *pg,
+		       bufferlist *replay, worker_result *res)
+{
+  auto ch = os->open_collection(pg->get_cid());
+  auto ec_ch = os->open_collection(pg->get_ec_cid());
+  ceph_assert(ch && ec_ch);
+
+  std::mutex lock;
+  std::condition_variable cond;
+  int in_flight = 0;
+
+  auto replay_p = replay ? replay->cbegin() : bufferlist::const_iterator();
+  const auto stop = std::chrono::steady_clock::now() +
+    std::chrono::seconds(cfg.duration);
+  for (uint64_t n = 0; ; ++n) {
+    if (replay) {
+      if (replay_p.end()) {
+	break;
+      }
+    } else if (cfg.duration ? std::chrono::steady_clock::now() >= stop
+			    : n >= cfg.ops) {
+      break;
+    }
+
+    ObjectStore::Transaction t;
+    txn_kind kind;
+    if (replay) {
+      uint8_t k;
+      decode(k, replay_p);
+      t.decode(replay_p);
+      kind = txn_kind(k);
+    } else {
+      kind = pg->build(pg->pick_kind(), t);
+      if (!cfg.record.empty()) {
+	encode((uint8_t)kind, res->recorded);
+	t.encode(res->recorded);
+      }
+    }
+
+    {
+      std::unique_lock l{lock};
+      cond.wait(l, [&] { return in_flight < cfg.queue_depth; });
+      ++in_flight;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    t.register_on_commit(new C_Committed([&, start, kind] {
+      std::chrono::duration<double> lat =
+	std::chrono::steady_clock::now() - start;
+      std::lock_guard l{lock};
+      res->stats[kind].lat.push_back(lat.count());
+      ++res->done;
+      --in_flight;
+      cond.notify_all();
+    }));
+    os->queue_transaction(kind == TXN_EC_WRITE ? ec_ch : ch, std::move(t));
+  }
+
+  std::unique_lock l{lock};
+  cond.wait(l, [&] { return in_flight == 0; });
+}
+
+int main(int argc, const char **argv)
+{
+  auto args = argv_to_vec(argc, argv);
+  if (args.empty()) {
+    cerr << argv[0] << ": -h or --help for usage" << std::endl;
+    exit(1);
+  }
+  if (ceph_argparse_need_usage(args)) {
+    usage();
+    exit(0);
+  }
+
+  auto cct = global_init(nullptr, args, CEPH_ENTITY_TYPE_OSD,
+			 CODE_ENVIRONMENT_UTILITY,
+			 CINIT_FLAG_NO_DEFAULT_CONFIG_FILE);
+
+  Config cfg;
+  std::string val, err;
+  auto parse_size = [&](uint64_t *v, const char *what) {
+    *v = strict_iecstrtoll(val, &err);
+    if (!err.empty()) {
+      cerr << "error parsing " << what << ": " << err << std::endl;
+      exit(1);
+    }
+  };
+  for (auto i = args.begin(); i != args.end(); ) {
+    if (ceph_argparse_double_dash(args, i)) {
+      break;
+    } else if (ceph_argparse_witharg(args, i, &cfg.threads, cerr,
+				     "--threads", (char*)nullptr)) {
+    } else if (ceph_argparse_witharg(args, i, &cfg.queue_depth, cerr,
+				     "--queue-depth", (char*)nullptr)) {
+    } else if (ceph_argparse_witharg(args, i, &cfg.duration, cerr,
+				     "--duration", (char*)nullptr)) {
+    } else if (ceph_argparse_witharg(args, i, &val, "--ops", (char*)nullptr)) {
+      parse_size(&cfg.ops, "ops");
+    } else if (ceph_argparse_witharg(args, i, &val, "--objects", (char*)nullptr)) {
+      parse_size(&cfg.objects, "objects");
+    } else if (ceph_argparse_witharg(args, i, &val, "--write-size", (char*)nullptr)) {
+      parse_size(&cfg.write_size, "write-size");
+    } else if (ceph_argparse_witharg(args, i, &val, "--object-size", (char*)nullptr)) {
+      parse_size(&cfg.object_size, "object-size");
+    } else if (ceph_argparse_witharg(args, i, &val, "--pglog-size", (char*)nullptr)) {
+      parse_size(&cfg.pglog_size, "pglog-size");
+    } else if (ceph_argparse_witharg(args, i, &val, "--seed", (char*)nullptr)) {
+      parse_size(&cfg.seed, "seed");
+    } else if (ceph_argparse_witharg(args, i, &val, "--ec-k", (char*)nullptr)) {
+      uint64_t k;
+      parse_size(&k, "ec-k");
+      cfg.ec_k = std::max<uint64_t>(k, 1);
+    } else if (ceph_argparse_witharg(args, i, &val, "--mix", (char*)nullptr)) {
+      if (!parse_mix(val, &cfg, &err)) {
+	cerr << "error parsing mix: " << err << std::endl;
+	exit(1);
+      }
+    } else if (ceph_argparse_witharg(args, i, &cfg.record, "--record", (char*)nullptr)) {
+    } else if (ceph_argparse_witharg(args, i, &cfg.replay, "--replay", (char*)nullptr)) {
+    } else if (ceph_argparse_flag(args, i, "--perf-dump", (char*)nullptr)) {
+      cfg.perf_dump = true;
+    } else {
+      cerr << "Error: can't understand argument: " << *i << std::endl;
+      exit(1);
+    }
+  }
+  if (cfg.threads <= 0 || cfg.queue_depth <= 0 || cfg.objects == 0 ||
+      cfg.write_size == 0) {
+    cerr << "threads, queue-depth, objects and write-size must be positive"
+	 << std::endl;
+    exit(1);
+  }
+  unsigned total_weight = 0;
+  for (auto w : cfg.weights) {
+    total_weight += w;
+  }
+  if (!total_weight) {
+    cerr << "the mix must have some weight" << std::endl;
+    exit(1);
+  }
+
+  // a recording holds one sequence of transactions per PG
+  std::vector<bufferlist> replay;
+  if (!cfg.replay.empty()) {
+    bufferlist bl;
+    int r = bl.read_file(cfg.replay.c_str(), &err);
+    if (r < 0) {
+      cerr << "failed to read " << cfg.replay << ": " << err << std::endl;
+      exit(1);
+    }
+    auto p = bl.cbegin();
+    decode(replay, p);
+    cfg.threads = replay.size();
+  }
+
+  common_init_finish(g_ceph_context);
+
+  DIR *dir = ::opendir(g_conf()->osd_data.c_str());
+  if (dir) {
+    bool non_empty = readdir(dir) != NULL && readdir(dir) != NULL &&
+      readdir(dir) != NULL;
+    ::closedir(dir);
+    if (non_empty) {
+      cerr << "data directory " << g_conf()->osd_data
+	   << " isn't empty, please clean it first" << std::endl;
+      exit(1);
+    }
+  } else if (::mkdir(g_conf()->osd_data.c_str(), 0755) < 0) {
+    cerr << "failed to create " << g_conf()->osd_data << ": "
+	 << cpp_strerror(errno) << std::endl;
+    exit(1);
+  }
+
+  auto os = ObjectStore::create(g_ceph_context,
+				g_conf()->osd_objectstore,
+				g_conf()->osd_data,
+				g_conf()->osd_journal);
+  if (!os) {
+    cerr << "bad objectstore type " << g_conf()->osd_objectstore << std::endl;
+    exit(1);
+  }
+  if (os->mkfs() < 0 || os->mount() < 0) {
+    cerr << "mkfs or mount failed" << std::endl;
+    exit(1);
+  }
+
+  std::vector<std::unique_ptr<PGWorkload>> pgs;
+  for (int i = 0; i < cfg.threads; ++i) {
+    pgs.emplace_back(new PGWorkload(cfg, i));
+    ObjectStore::Transaction t, ec_t;
+    pgs.back()->init(t, ec_t);
+    C_SaferCond created, ec_created;
+    t.register_on_commit(&created);
+    ec_t.register_on_commit(&ec_created);
+    auto ch = os->create_new_collection(pgs.back()->get_cid());
+    auto ec_ch = os->create_new_collection(pgs.back()->get_ec_cid());
+    os->queue_transaction(ch, std::move(t));
+    os->queue_transaction(ec_ch, std::move(ec_t));
+    created.wait();
+    ec_created.wait();
+  }
+  // keep the setup out of the counters
+  g_ceph_context->get_perfcounters_collection()->reset("all");
+
+  std::vector<worker_result> results(cfg.threads);
+  std::vector<std::thread> workers;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < cfg.threads; ++i) {
+    workers.emplace_back(run_worker, os.get(), std::cref(cfg), pgs[i].get(),
+			 replay.empty() ? nullptr : &replay[i], &results[i]);
+  }
+  for (auto& w : workers) {
+    w.join();
+  }
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - start;
+
+  latency_stats stats[TXN_MAX];
+  uint64_t done = 0;
+  for (auto& r : results) {
+    for (unsigned k = 0; k < TXN_MAX; ++k) {
+      stats[k].merge(r.stats[k]);
+    }
+    done += r.done;
+  }
+
+  cout << "objectstore " << g_conf()->osd_objectstore
+       << ", " << cfg.threads << " pgs, queue depth " << cfg.queue_depth
+       << std::endl
+       << done << " transactions in " << elapsed.count() << "s, "
+       << done / elapsed.count() << " txn/s" << std::endl;
+  cout << "kind          count    avg(ms)    p50(ms)    p99(ms)  p99.9(ms)"
+       << std::endl;
+  for (unsigned k = 0; k < TXN_MAX; ++k) {
+    auto& s = stats[k];
+    if (s.lat.empty()) {
+      continue;
+    }
+    char line[128];
+    snprintf(line, sizeof(line), "%-10s %8zu %10.3f %10.3f %10.3f %10.3f",
+	     kind_names[k], s.lat.size(), s.avg() * 1000,
+	     s.percentile(0.5) * 1000, s.percentile(0.99) * 1000,
+	     s.percentile(0.999) * 1000);
+    cout << line << std::endl;
+  }
+  auto st = os->get_cur_stats();
+  cout << "store commit latency " << st.os_commit_latency_ns / 1000000.0
+       << "ms, apply latency " << st.os_apply_latency_ns / 1000000.0 << "ms"
+       << std::endl;
+  if (cfg.perf_dump) {
+    // the per state latencies (bluestore's state_*_lat) are the breakdown
+    JSONFormatter f(true);
+    f.open_object_section("perf");
+    g_ceph_context->get_perfcounters_collection()->dump_formatted(
+      &f, false, false);
+    f.close_section();
+    f.flush(cout);
+    cout << std::endl;
+  }
+
+  if (!cfg.record.empty()) {
+    std::vector<bufferlist> recorded;
+    for (auto& r : results) {
+      recorded.push_back(std::move(r.recorded));
+    }
+    bufferlist bl;
+    encode(recorded, bl);
+    int r = bl.write_file(cfg.record.c_str());
+    if (r < 0) {
+      cerr << "failed to write " << cfg.record << ": " << cpp_strerror(r)
+	   << std::endl;
+    }
+  }
+
+  os->umount();
+  return 0;
+}
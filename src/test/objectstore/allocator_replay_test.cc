@@ -4,7 +4,10 @@
  * Allocator replay tool.
  * Author: Igor Fedotov, ifedotov@suse.com
  */
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <sstream>
 #include <vector>
 
 #include "common/ceph_argparse.h"
@@ -14,6 +17,7 @@
 #include "common/ceph_json.h"
 #include "common/admin_socket.h"
 #include "include/denc.h"
+#include "include/str_list.h"
 #include "global/global_init.h"
 #include "os/bluestore/Allocator.h"
 
@@ -30,6 +34,17 @@ void usage(const string &name) {
           "export_binary <out_file>|"
           "free_histogram [<alloc_unit>] [<num_buckets>]"
        << std::endl;
+  cerr << "       " << name << " <alloc_trace> "
+       << "compare_trace [<sample_every>] [<alloc_type>[,...]]"
+       << std::endl;
+}
+
+void usage_compare_trace(const string &name) {
+  cerr << "Detailed compare_trace usage: " << name << " <alloc_trace> compare_trace [<sample_every>] [<alloc_type>[,...]]" << std::endl;
+  cerr << "The trace is taken from an OSD with \"ceph daemon osd.N bluestore allocator trace <name> start <path>\"," << std::endl;
+  cerr << "and replayed with each of the given allocators (avl,btree,hybrid,bitmap,stupid by default)." << std::endl;
+  cerr << "Every <sample_every> ops (10000 by default) a line of op latencies, fragmentation score" << std::endl;
+  cerr << "and free extent histogram is printed for each allocator, tab separated." << std::endl;
 }
 
 void usage_replay_alloc(const string &name) {
@@ -534,6 +549,303 @@ int check_duplicates(char* fname)
   return r >= 0 ? errors != 0 : r;
 }
 
+/*
+ * A trace of allocations and releases, as written by
+ * "bluestore allocator trace <name> start <path>".  Releases are resolved
+ * to the parts of earlier allocations they free, so that they can be
+ * applied to whatever another allocator returned for them.
+ */
+struct alloc_trace_t {
+  struct piece_t {
+    int64_t id;   ///< the allocation, or -1 if it was before the trace
+    uint64_t off; ///< into the allocation, or on the device for -1
+    uint64_t len;
+  };
+  struct op_t {
+    bool alloc = false;
+    uint64_t want = 0, unit = 0, max = 0;
+    int64_t hint = 0;
+    std::vector<piece_t> pieces; ///< release only
+  };
+
+  std::string type;
+  uint64_t capacity = 0;
+  uint64_t alloc_unit = 0;
+  std::vector<std::pair<uint64_t, uint64_t>> free_extents;
+  std::vector<op_t> ops;
+  size_t num_allocs = 0;
+
+  int load(const char* fname);
+
+private:
+  struct owner_t {
+    uint64_t len;
+    int64_t id;
+    uint64_t off;
+  };
+  std::map<uint64_t, owner_t> live;  ///< by device offset
+
+  void resolve(uint64_t off, uint64_t len, std::vector<piece_t>& pieces);
+};
+
+void alloc_trace_t::resolve(uint64_t off, uint64_t len,
+			    std::vector<piece_t>& pieces)
+{
+  const uint64_t end = off + len;
+  uint64_t pos = off;
+  auto it = live.upper_bound(pos);
+  if (it != live.begin()) {
+    --it;
+  }
+  while (pos < end) {
+    if (it != live.end() && it->first + it->second.len <= pos) {
+      ++it;
+      continue;
+    }
+    if (it == live.end() || it->first >= end) {
+      pieces.push_back({-1, pos, end - pos});
+      break;
+    }
+    if (it->first > pos) {
+      pieces.push_back({-1, pos, it->first - pos});
+      pos = it->first;
+    }
+    const uint64_t ext_off = it->first;
+    const owner_t o = it->second;
+    const uint64_t ext_end = ext_off + o.len;
+    const uint64_t piece_end = std::min(end, ext_end);
+    pieces.push_back({o.id, o.off + (pos - ext_off), piece_end - pos});
+    // keep what is left of the extent on either side
+    it = live.erase(it);
+    if (ext_off < pos) {
+      live[ext_off] = {pos - ext_off, o.id, o.off};
+    }
+    if (piece_end < ext_end) {
+      it = live.emplace(
+	piece_end,
+	owner_t{ext_end - piece_end, o.id, o.off + piece_end - ext_off}).first;
+    }
+    pos = piece_end;
+  }
+}
+
+int alloc_trace_t::load(const char* fname)
+{
+  std::ifstream in(fname);
+  if (!in) {
+    std::cerr << "error: unable to open " << fname << std::endl;
+    return -1;
+  }
+  std::string line;
+  if (!std::getline(in, line)) {
+    std::cerr << "error: " << fname << " is empty" << std::endl;
+    return -1;
+  }
+  {
+    std::istringstream ss(line);
+    std::string magic;
+    int version = 0;
+    ss >> magic >> version >> type >> std::hex >> capacity >> alloc_unit;
+    if (magic != "alloc_trace" || version != 1 || !ss) {
+      std::cerr << "error: " << fname << " is not an allocator trace"
+		<< std::endl;
+      return -1;
+    }
+  }
+  auto parse_extents = [](std::istringstream& ss, auto fn) {
+    std::string e;
+    while (ss >> e) {
+      uint64_t off, len;
+      if (std::sscanf(e.c_str(), "%" SCNx64 "~%" SCNx64, &off, &len) != 2) {
+	return false;
+      }
+      fn(off, len);
+    }
+    return true;
+  };
+  for (size_t n = 2; std::getline(in, line); ++n) {
+    std::istringstream ss(line);
+    char c = 0;
+    ss >> c >> std::hex;
+    bool ok = true;
+    if (c == 'f') {
+      uint64_t off, len;
+      ok = bool(ss >> off >> len);
+      free_extents.emplace_back(off, len);
+    } else if (c == 'a') {
+      op_t op;
+      op.alloc = true;
+      uint64_t hint;
+      ok = bool(ss >> op.want >> op.unit >> op.max >> hint);
+      op.hint = hint;
+      const int64_t id = num_allocs++;
+      uint64_t loff = 0;
+      ok = ok && parse_extents(ss, [&](uint64_t off, uint64_t len) {
+	live[off] = {len, id, loff};
+	loff += len;
+      });
+      ops.push_back(std::move(op));
+    } else if (c == 'r') {
+      op_t op;
+      ok = parse_extents(ss, [&](uint64_t off, uint64_t len) {
+	resolve(off, len, op.pieces);
+      });
+      ops.push_back(std::move(op));
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      std::cerr << "error: malformed line " << n << ": " << line << std::endl;
+      return -1;
+    }
+  }
+  live.clear();
+  return 0;
+}
+
+/// add the device extents holding [off, off + len) of an allocation
+static void translate(const PExtentVector& extents, uint64_t off,
+		      uint64_t len, interval_set<uint64_t>& out)
+{
+  uint64_t pos = 0;
+  for (auto& e : extents) {
+    if (len == 0) {
+      break;
+    }
+    if (off < pos + e.length) {
+      uint64_t skip = off - pos;
+      uint64_t l = std::min<uint64_t>(len, e.length - skip);
+      out.insert(e.offset + skip, l);
+      off += l;
+      len -= l;
+    }
+    pos += e.length;
+  }
+  // anything left was not allocated by this allocator in the first place
+}
+
+struct latency_window_t {
+  std::vector<uint64_t> ns;
+
+  void add(ceph::mono_clock::time_point t0) {
+    ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      ceph::mono_clock::now() - t0).count());
+  }
+  /// p50, p99 and max, tab separated
+  std::string take() {
+    if (ns.empty()) {
+      return "-\t-\t-";
+    }
+    std::sort(ns.begin(), ns.end());
+    auto at = [this](double q) {
+      return ns[std::min<size_t>(q * ns.size(), ns.size() - 1)];
+    };
+    std::ostringstream ss;
+    ss << at(0.5) << "\t" << at(0.99) << "\t" << ns.back();
+    ns.clear();
+    return ss.str();
+  }
+};
+
+int compare_trace(const char* fname, uint64_t sample_every,
+		  const std::vector<std::string>& types)
+{
+  alloc_trace_t trace;
+  std::cout << "parsing..." << std::endl;
+  if (int r = trace.load(fname); r < 0) {
+    return r;
+  }
+  std::cout << "traced on " << trace.type << " capacity 0x" << std::hex
+	    << trace.capacity << " alloc_unit 0x" << trace.alloc_unit
+	    << std::dec << ", " << trace.free_extents.size()
+	    << " free extents, " << trace.ops.size() << " ops" << std::endl;
+
+  constexpr size_t num_buckets = 8;
+  std::cout << "alloc\tops\tfree\tscore\talloc_p50_ns\talloc_p99_ns"
+	    << "\talloc_max_ns\trelease_p50_ns\trelease_p99_ns\trelease_max_ns";
+  for (size_t i = 0; i < num_buckets; ++i) {
+    auto m = Allocator::free_state_hist_bucket::get_max(i, num_buckets);
+    if (i < num_buckets - 1) {
+      std::cout << "\tfree<=" << m;
+    } else {
+      std::cout << "\tfree>"
+		<< Allocator::free_state_hist_bucket::get_max(i - 1, num_buckets);
+    }
+  }
+  std::cout << std::endl;
+
+  for (auto& type : types) {
+    unique_ptr<Allocator> alloc(
+      Allocator::create(g_ceph_context, type, trace.capacity,
+			trace.alloc_unit, "replay_" + type));
+    if (!alloc) {
+      std::cerr << "error: unknown allocator " << type << std::endl;
+      return -1;
+    }
+    for (auto& [off, len] : trace.free_extents) {
+      alloc->init_add_free(off, len);
+    }
+    std::vector<PExtentVector> allocated(trace.num_allocs);
+    latency_window_t alloc_lat, release_lat;
+    uint64_t failures = 0;
+    double alloc_total = 0;
+    int64_t id = 0;
+
+    auto sample = [&](uint64_t ops) {
+      Allocator::FreeStateHistogram hist(num_buckets);
+      alloc->build_free_state_histogram(trace.alloc_unit, hist);
+      std::cout << type << "\t" << ops << "\t" << alloc->get_free() << "\t"
+		<< alloc->get_fragmentation_score() << "\t"
+		<< alloc_lat.take() << "\t" << release_lat.take();
+      for (auto& b : hist) {
+	std::cout << "\t" << b.total;
+      }
+      std::cout << std::endl;
+    };
+
+    sample(0);
+    uint64_t n = 0;
+    for (auto& op : trace.ops) {
+      if (op.alloc) {
+	auto& extents = allocated[id++];
+	auto t0 = ceph::mono_clock::now();
+	auto r = alloc->allocate(op.want, op.unit, op.max, op.hint, &extents);
+	alloc_lat.add(t0);
+	alloc_total += alloc_lat.ns.back();
+	if (r < (int64_t)op.want) {
+	  ++failures;
+	}
+      } else {
+	interval_set<uint64_t> release_set;
+	for (auto& p : op.pieces) {
+	  if (p.id < 0) {
+	    release_set.insert(p.off, p.len);
+	  } else {
+	    translate(allocated[p.id], p.off, p.len, release_set);
+	  }
+	}
+	if (!release_set.empty()) {
+	  auto t0 = ceph::mono_clock::now();
+	  alloc->release(release_set);
+	  release_lat.add(t0);
+	}
+      }
+      if (++n % sample_every == 0) {
+	sample(n);
+      }
+    }
+    if (n % sample_every) {
+      sample(n);
+    }
+    std::cerr << type << ": " << trace.num_allocs << " allocations, "
+	      << failures << " short or failed, " << alloc_total / 1e6
+	      << " ms allocating, final fragmentation score "
+	      << alloc->get_fragmentation_score() << std::endl;
+    alloc->shutdown();
+  }
+  return 0;
+}
+
 int main(int argc, char **argv)
 {
   auto args = argv_to_vec(argc, argv);
@@ -780,5 +1092,21 @@ int main(int argc, char **argv)
     return export_as_binary(argv[1], argv[3]);
   } else if (strcmp(argv[2], "duplicates") == 0) {
     return check_duplicates(argv[1]);
+  } else if (strcmp(argv[2], "compare_trace") == 0) {
+    uint64_t sample_every = 10000;
+    std::vector<std::string> types = {
+      "avl", "btree", "hybrid", "bitmap", "stupid"
+    };
+    if (argc >= 4) {
+      sample_every = strtoull(argv[3], nullptr, 10);
+    }
+    if (argc >= 5) {
+      types = get_str_vec(argv[4], ",");
+    }
+    if (sample_every == 0 || types.empty()) {
+      usage_compare_trace(argv[0]);
+      return 1;
+    }
+    return compare_trace(argv[1], sample_every, types);
   }
 }
@@ -4022,6 +4022,59 @@ TEST_P(StoreTest, BlueStoreUnshareBlobBugTest) {
 }
 #endif
 
+TEST_P(StoreTest, ScrubReadTest) {
+  int r;
+  coll_t cid;
+  ghobject_t hoid(hobject_t(sobject_t("ScrubRead", CEPH_NOSNAP)));
+  auto ch = store->create_new_collection(cid);
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  {
+    // aligned data, an unaligned overwrite, a hole and an unaligned tail
+    bufferlist a, b, c;
+    a.append(std::string(0x20000, 'a'));
+    b.append(std::string(0x1234, 'b'));
+    c.append(std::string(0x777, 'c'));
+    ObjectStore::Transaction t;
+    t.write(cid, hoid, 0, a.length(), a);
+    t.write(cid, hoid, 0x3100, b.length(), b);
+    t.write(cid, hoid, 0x30000, c.length(), c);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  for (uint64_t stride : {0x1000ull, 0x5500ull, 0x80000ull}) {
+    uint32_t crc = -1;
+    uint32_t expected = -1;
+    uint64_t pos = 0;
+    while (true) {
+      bufferlist bl;
+      r = store->read(ch, hoid, pos, stride, bl);
+      ASSERT_GE(r, 0);
+      expected = bl.crc32c(expected);
+      int r2 = store->scrub_read(ch, hoid, pos, stride, &crc);
+      ASSERT_EQ(r, r2);
+      ASSERT_EQ(expected, crc) << "stride 0x" << std::hex << stride
+                               << " pos 0x" << pos;
+      pos += r;
+      if ((uint64_t)r < stride) {
+        break;
+      }
+    }
+    ASSERT_EQ(0x30777u, pos);
+  }
+  {
+    ObjectStore::Transaction t;
+    t.remove(cid, hoid);
+    t.remove_collection(cid);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+}
+
 TEST_P(StoreTest, SimpleObjectLongnameTest) {
   int r;
   coll_t cid;
@@ -5449,6 +5502,23 @@ TEST_P(StoreTestSpecificAUSize, SyntheticMatrixCompression) {
   do_matrix(m, &StoreTestSpecificAUSize::SyntheticTest);
 }
 
+TEST_P(StoreTestSpecificAUSize, SyntheticMatrixCompressionThreads) {
+  if (string(GetParam()) != "bluestore")
+    return;
+
+  SetVal(g_conf(), "bluestore_compression_threads", "4");
+  const char *m[][10] = {
+    { "bluestore_min_alloc_size", "4096", "65536", 0 }, // to be the first!
+    { "max_write", "1048576", 0 },
+    { "max_size", "4194304", 0 },
+    { "alignment", "65536", 0 },
+    { "bluestore_compression_mode", "force", 0},
+    { "bluestore_compression_max_blob_size", "65536", 0},
+    { 0 },
+  };
+  do_matrix(m, &StoreTestSpecificAUSize::SyntheticTest);
+}
+
 TEST_P(StoreTestSpecificAUSize, SyntheticMatrixCompressionAlgorithm) {
   if (string(GetParam()) != "bluestore")
     return;
@@ -5502,6 +5572,202 @@ TEST_P(StoreTestSpecificAUSize, SyntheticMatrixPreferDeferred) {
   };
   do_matrix(m, &StoreTestSpecificAUSize::SyntheticTest);
 }
+
+TEST_P(StoreTestSpecificAUSize, SyntheticMatrixKVSyncShards) {
+  if (string(GetParam()) != "bluestore")
+    return;
+
+  const char *m[][10] = {
+    { "bluestore_min_alloc_size", "4096", 0 }, // to be the first!
+    { "max_write", "65536", 0 },
+    { "max_size", "1048576", 0 },
+    { "alignment", "512", 0 },
+    { "bluestore_kv_sync_shards", "4", 0 },
+    { "bluestore_prefer_deferred_size", "32768", "0", 0},
+    { "bluestore_sync_submit_transaction", "true", "false", 0 },
+    { 0 },
+  };
+  do_matrix(m, &StoreTestSpecificAUSize::SyntheticTest);
+}
+
+TEST_P(StoreTestDeferredSetup, KVSyncShardsRemount) {
+  if (string(GetParam()) != "bluestore")
+    return;
+
+  // collections map to the shards by sequencer, so with more collections
+  // than shards every shard commits at the same time as the others
+  SetVal(g_conf(), "bluestore_kv_sync_shards", "4");
+  g_conf().apply_changes(nullptr);
+  DeferredSetup();
+
+  const int num_colls = 8;
+  const int num_objects = 64;
+  std::vector<coll_t> cids;
+  std::vector<ObjectStore::CollectionHandle> chs;
+  for (int i = 0; i < num_colls; ++i) {
+    cids.emplace_back(spg_t(pg_t(i, 1)));
+    chs.push_back(store->create_new_collection(cids.back()));
+    ObjectStore::Transaction t;
+    t.create_collection(cids.back(), 0);
+    ASSERT_EQ(0, queue_transaction(store, chs.back(), std::move(t)));
+  }
+  auto oid = [](int c, int i, int round) {
+    return ghobject_t(hobject_t(
+      sobject_t("obj_" + stringify(round) + "_" + stringify(i), CEPH_NOSNAP),
+      "", c, 1, ""));
+  };
+  auto data = [](int c, int i, int round) {
+    bufferlist bl;
+    bl.append(string(4096 + i, 'a' + (c + i + round) % 26));
+    return bl;
+  };
+  auto write_all = [&](int round) {
+    std::list<C_SaferCond> conds;
+    for (int i = 0; i < num_objects; ++i) {
+      for (int c = 0; c < num_colls; ++c) {
+	ObjectStore::Transaction t;
+	bufferlist bl = data(c, i, round);
+	t.write(cids[c], oid(c, i, round), 0, bl.length(), bl);
+	t.register_on_commit(&conds.emplace_back());
+	store->queue_transaction(chs[c], std::move(t));
+      }
+    }
+    for (auto& cond : conds) {
+      cond.wait();
+    }
+  };
+  auto verify = [&](int rounds) {
+    for (int round = 0; round < rounds; ++round) {
+      for (int c = 0; c < num_colls; ++c) {
+	for (int i = 0; i < num_objects; ++i) {
+	  bufferlist bl;
+	  int r = store->read(chs[c], oid(c, i, round), 0, 0, bl);
+	  ASSERT_EQ(4096 + i, r);
+	  bufferlist expected = data(c, i, round);
+	  ASSERT_TRUE(bl_eq(expected, bl));
+	}
+      }
+    }
+  };
+
+  write_all(0);
+  verify(1);
+
+  // the nids and blobids handed out by every shard must have been
+  // persisted, or the objects written after the remount would reuse them
+  chs.clear();
+  ASSERT_EQ(0, store->umount());
+  ASSERT_EQ(0, store->fsck(false));
+  ASSERT_EQ(0, store->mount());
+  for (auto& cid : cids) {
+    chs.push_back(store->open_collection(cid));
+  }
+  write_all(1);
+  verify(2);
+
+  chs.clear();
+  ASSERT_EQ(0, store->umount());
+  ASSERT_EQ(0, store->fsck(false));
+  ASSERT_EQ(0, store->mount());
+  for (auto& cid : cids) {
+    chs.push_back(store->open_collection(cid));
+  }
+  verify(2);
+}
+
+TEST_P(StoreTestSpecificAUSize, OnodeCacheCompact) {
+  if (string(GetParam()) != "bluestore")
+    return;
+
+  // plenty of small extents, spread over many extent map shards
+  SetVal(g_conf(), "bluestore_extent_map_shard_min_size", "60");
+  SetVal(g_conf(), "bluestore_extent_map_shard_max_size", "300");
+  SetVal(g_conf(), "bluestore_extent_map_shard_target_size", "150");
+  SetVal(g_conf(), "bluestore_onode_cache_compact", "true");
+  g_conf().apply_changes(nullptr);
+  StartDeferred(4096);
+
+  coll_t cid;
+  ghobject_t hoid(hobject_t(sobject_t("Object 1", CEPH_NOSNAP)));
+  const PerfCounters* logger = store->get_perf_counters();
+  auto ch = store->create_new_collection(cid);
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    ASSERT_EQ(0, queue_transaction(store, ch, std::move(t)));
+  }
+
+  const unsigned num_blocks = 256;
+  const unsigned block = 4096;
+  bufferlist expected;
+  expected.append_zero(num_blocks * 2 * block);
+  auto write_block = [&](unsigned i, char c) {
+    bufferlist bl;
+    bl.append(string(block, c));
+    ObjectStore::Transaction t;
+    t.write(cid, hoid, i * 2 * block, block, bl);
+    ASSERT_EQ(0, queue_transaction(store, ch, std::move(t)));
+    bufferlist head;
+    expected.splice(0, i * 2 * block, &head);
+    expected.splice(0, block);
+    head.claim_append(bl);
+    head.claim_append(expected);
+    expected.swap(head);
+  };
+  auto verify = [&]() {
+    bufferlist bl;
+    ASSERT_EQ((int)expected.length(),
+	      store->read(ch, hoid, 0, expected.length(), bl));
+    ASSERT_TRUE(bl_eq(expected, bl));
+  };
+  for (unsigned i = 0; i < num_blocks; ++i) {
+    write_block(i, 'a' + i % 26);
+  }
+  verify();
+
+  // the first trim unloads the clean shards and keeps the onode; wait
+  // out a commit that may still pin it
+  auto compacted = logger->get(l_bluestore_onode_shard_compacted);
+  for (int i = 0; i < 100; ++i) {
+    store->flush_cache();
+    if (logger->get(l_bluestore_onode_shard_compacted) > compacted) {
+      break;
+    }
+    usleep(10000);
+  }
+  ASSERT_GT(logger->get(l_bluestore_onode_shard_compacted), compacted);
+
+  // the shards come back from their cached bytes, not from the kv store
+  auto misses = logger->get(l_bluestore_onode_shard_misses);
+  verify();
+  ASSERT_EQ(misses, logger->get(l_bluestore_onode_shard_misses));
+
+  // dirtied shards drop the cached bytes and are encoded anew
+  for (unsigned i = 0; i < num_blocks; i += 16) {
+    write_block(i, 'A' + i % 26);
+  }
+  verify();
+  store->flush_cache();
+  verify();
+
+  // a compacted onode is evicted on the next trim
+  store->flush_cache();
+  store->flush_cache();
+  verify();
+
+  ch.reset();
+  ASSERT_EQ(0, store->umount());
+  ASSERT_EQ(0, store->fsck(false));
+  ASSERT_EQ(0, store->mount());
+  ch = store->open_collection(cid);
+  verify();
+  {
+    ObjectStore::Transaction t;
+    t.remove(cid, hoid);
+    t.remove_collection(cid);
+    ASSERT_EQ(0, queue_transaction(store, ch, std::move(t)));
+  }
+}
 #endif // WITH_BLUESTORE
 
 TEST_P(StoreTest, AttrSynthetic) {
@@ -8654,6 +8920,203 @@ TEST_P(StoreTestSpecificAUSize, DeferredOnBigOverwrite4) {
   }
 }
 
+TEST_P(StoreTestSpecificAUSize, DeferredAggregate) {
+
+  if (string(GetParam()) != "bluestore")
+    return;
+
+  size_t block_size = 4096;
+  StartDeferred(block_size);
+  SetVal(g_conf(), "bluestore_prefer_deferred_size", "65536");
+  SetVal(g_conf(), "bluestore_deferred_aggregate", "true");
+  // keep deferred ios pending until umount submits them all at once
+  SetVal(g_conf(), "bluestore_deferred_batch_ops", "1024");
+  g_conf().apply_changes(nullptr);
+
+  int r;
+  const unsigned num_colls = 4;
+  vector<coll_t> cids;
+  ghobject_t hoid(hobject_t("test", "", CEPH_NOSNAP, 0, -1, ""));
+  bufferlist expected;
+  expected.append(std::string(block_size, 'a'));
+  expected.append(std::string(block_size, 'b'));
+  expected.append(std::string(2 * block_size, 'a'));
+  {
+    vector<ObjectStore::CollectionHandle> chs;
+    for (unsigned i = 0; i < num_colls; ++i) {
+      coll_t cid(spg_t(pg_t(i, 1), shard_id_t::NO_SHARD));
+      auto ch = store->create_new_collection(cid);
+      ObjectStore::Transaction t;
+      t.create_collection(cid, 0);
+      bufferlist bl;
+      bl.append(std::string(4 * block_size, 'a'));
+      t.write(cid, hoid, 0, bl.length(), bl);
+      r = queue_transaction(store, ch, std::move(t));
+      ASSERT_EQ(r, 0);
+      cids.push_back(cid);
+      chs.push_back(ch);
+    }
+    for (unsigned i = 0; i < num_colls; ++i) {
+      ObjectStore::Transaction t;
+      bufferlist bl;
+      bl.append(std::string(block_size, 'b'));
+      t.write(cids[i], hoid, block_size, bl.length(), bl);
+      r = queue_transaction(store, chs[i], std::move(t));
+      ASSERT_EQ(r, 0);
+    }
+    for (unsigned i = 0; i < num_colls; ++i) {
+      bufferlist bl;
+      r = store->read(chs[i], hoid, 0, expected.length(), bl);
+      ASSERT_EQ(r, (int)expected.length());
+      ASSERT_TRUE(bl_eq(expected, bl));
+    }
+  }
+  r = store->umount();
+  ASSERT_EQ(0, r);
+  r = store->mount();
+  ASSERT_EQ(0, r);
+  for (auto& cid : cids) {
+    auto ch = store->open_collection(cid);
+    bufferlist bl;
+    r = store->read(ch, hoid, 0, expected.length(), bl);
+    ASSERT_EQ(r, (int)expected.length());
+    ASSERT_TRUE(bl_eq(expected, bl));
+
+    ObjectStore::Transaction t;
+    t.remove(cid, hoid);
+    t.remove_collection(cid);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+}
+
+TEST_P(StoreTestSpecificAUSize, SequentialReadahead) {
+
+  if (string(GetParam()) != "bluestore")
+    return;
+
+  StartDeferred(4096);
+  SetVal(g_conf(), "bluestore_readahead_max_bytes", "262144");
+  g_conf().apply_changes(nullptr);
+
+  int r;
+  coll_t cid;
+  ghobject_t hoid(hobject_t("test", "", CEPH_NOSNAP, 0, -1, ""));
+  PerfCounters* logger = const_cast<PerfCounters*>(store->get_perf_counters());
+
+  const unsigned chunk = 65536;
+  const unsigned chunks = 16;
+  bufferlist data;
+  for (unsigned i = 0; i < chunks; ++i) {
+    data.append(std::string(chunk, 'a' + i));
+  }
+  auto ch = store->create_new_collection(cid);
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    t.write(cid, hoid, 0, data.length(), data,
+	    CEPH_OSD_OP_FLAG_FADVISE_DONTNEED);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  // start from a cold cache
+  ch.reset();
+  r = store->umount();
+  ASSERT_EQ(0, r);
+  r = store->mount();
+  ASSERT_EQ(0, r);
+  ch = store->open_collection(cid);
+
+  logger->reset();
+  for (unsigned i = 0; i < chunks; ++i) {
+    bufferlist bl, expected;
+    expected.substr_of(data, i * chunk, chunk);
+    r = store->read(ch, hoid, i * chunk, chunk, bl);
+    ASSERT_EQ(r, (int)chunk);
+    ASSERT_TRUE(bl_eq(expected, bl));
+  }
+  ASSERT_GT(logger->get(l_bluestore_readahead_bytes), 0u);
+  // nothing is read beyond the end of the object
+  ASSERT_LE(logger->get(l_bluestore_readahead_bytes),
+	    (uint64_t)data.length());
+
+  {
+    ObjectStore::Transaction t;
+    t.remove(cid, hoid);
+    t.remove_collection(cid);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+}
+
+TEST_P(StoreTestSpecificAUSize, OnlineFsck) {
+
+  if (string(GetParam()) != "bluestore")
+    return;
+
+  SetVal(g_conf(), "bluestore_online_fsck", "true");
+  SetVal(g_conf(), "bluestore_online_fsck_batch_objects", "4");
+  SetVal(g_conf(), "bluestore_online_fsck_sleep", "0");
+  StartDeferred(4096);
+
+  int r;
+  const unsigned num_colls = 3;
+  const unsigned num_objs = 10;
+  PerfCounters* logger = const_cast<PerfCounters*>(store->get_perf_counters());
+
+  vector<coll_t> cids;
+  vector<ObjectStore::CollectionHandle> chs;
+  for (unsigned i = 0; i < num_colls; ++i) {
+    coll_t cid(spg_t(pg_t(i, 1), shard_id_t::NO_SHARD));
+    auto ch = store->create_new_collection(cid);
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    for (unsigned j = 0; j < num_objs; ++j) {
+      ghobject_t hoid(hobject_t("obj" + stringify(j), "", CEPH_NOSNAP,
+				i, 1, ""));
+      bufferlist bl;
+      bl.append(std::string(4096 * (j + 1), 'a' + j));
+      t.write(cid, hoid, 0, bl.length(), bl);
+    }
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+    cids.push_back(cid);
+    chs.push_back(ch);
+  }
+
+  // a pass over all collections completes in the background
+  for (unsigned i = 0; i < 300; ++i) {
+    if (logger->get(l_bluestore_online_fsck_objects) >=
+	num_colls * num_objs) {
+      break;
+    }
+    usleep(100 * 1000);
+  }
+  ASSERT_GE(logger->get(l_bluestore_online_fsck_objects),
+	    (uint64_t)num_colls * num_objs);
+  ASSERT_EQ(logger->get(l_bluestore_online_fsck_errors), 0u);
+
+  // the thread stops cleanly and restarts from the persisted cursor
+  chs.clear();
+  r = store->umount();
+  ASSERT_EQ(0, r);
+  r = store->mount();
+  ASSERT_EQ(0, r);
+
+  for (unsigned i = 0; i < num_colls; ++i) {
+    auto ch = store->open_collection(cids[i]);
+    ObjectStore::Transaction t;
+    for (unsigned j = 0; j < num_objs; ++j) {
+      ghobject_t hoid(hobject_t("obj" + stringify(j), "", CEPH_NOSNAP,
+				i, 1, ""));
+      t.remove(cids[i], hoid);
+    }
+    t.remove_collection(cids[i]);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+}
+
 TEST_P(StoreTestSpecificAUSize, DeferredOnBigOverwrite5) {
 
   if (string(GetParam()) != "bluestore")
@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <iostream>
+#include <thread>
 #include <gtest/gtest.h>
 #include "global/global_init.h"
 #include "global/global_context.h"
@@ -91,6 +92,66 @@ TEST(KernelDevice, Ticket45337) {
   b->close();
 }
 
+TEST(KernelDevice, MultipleQueues) {
+  uint64_t size = 1048576ull * 64;
+  TempBdev bdev{ size };
+
+  // bdev_aio_queues is a startup option
+  g_ceph_context->_conf._clear_safe_to_start_threads();
+  g_ceph_context->_conf.set_val_or_die("bdev_aio_queues", "4");
+  std::unique_ptr<BlockDevice> b(
+    BlockDevice::create(g_ceph_context, bdev.path, NULL, NULL,
+      [](void* handle, void* aio) {}, NULL));
+  g_ceph_context->_conf.set_val_or_die("bdev_aio_queues", "1");
+  g_ceph_context->_conf.set_safe_to_start_threads();
+  int r = b->open(bdev.path);
+  if (r < 0) {
+    std::cerr << "open " << bdev.path << " failed" << std::endl;
+    return;
+  }
+
+  // every thread binds to its own queue
+  const unsigned num_threads = 8;
+  const uint64_t region = size / num_threads;
+  const uint64_t chunk = 65536;
+  std::vector<std::thread> threads;
+  std::atomic<unsigned> errors = {0};
+  for (unsigned t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      IOContext ioc(g_ceph_context, NULL);
+      for (uint64_t off = 0; off < region; off += chunk) {
+	bufferlist bl;
+	bl.append_zero(chunk);
+	memset(bl.c_str(), 'a' + t, chunk);
+	if (b->aio_write(t * region + off, bl, &ioc, false) != 0) {
+	  ++errors;
+	}
+      }
+      b->aio_submit(&ioc);
+      ioc.aio_wait();
+
+      IOContext rioc(g_ceph_context, NULL);
+      bufferlist rbl;
+      if (b->aio_read(t * region, region, &rbl, &rioc) != 0) {
+	++errors;
+      }
+      b->aio_submit(&rioc);
+      rioc.aio_wait();
+      string expected(region, 'a' + t);
+      if (rbl.length() != region ||
+	  memcmp(rbl.c_str(), expected.c_str(), region) != 0) {
+	++errors;
+      }
+    });
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+  ASSERT_EQ(0u, errors.load());
+
+  b->close();
+}
+
 int main(int argc, char **argv) {
   auto args = argv_to_vec(argc, argv);
   map<string,string> defaults = {
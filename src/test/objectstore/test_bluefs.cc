@@ -611,6 +611,48 @@ TEST(BlueFS, test_simple_compaction_async) {
   fs.umount();
 }
 
+TEST(BlueFS, test_compaction_background) {
+  uint64_t size = 1048576 * 128;
+  TempBdev bdev{size};
+  ConfSaver conf(g_ceph_context->_conf);
+  conf.SetVal("bluefs_compact_log_sync", "false");
+  conf.SetVal("bluefs_compact_log_background", "true");
+  // make sure fsync always asks for log compaction
+  conf.SetVal("bluefs_log_compact_min_ratio", "0");
+  conf.SetVal("bluefs_log_compact_min_size", "0");
+  conf.ApplyChanges();
+
+  BlueFS fs(g_ceph_context);
+  ASSERT_EQ(0, fs.add_block_device(BlueFS::BDEV_DB, bdev.path, false));
+  uuid_d fsid;
+  ASSERT_EQ(0, fs.mkfs(fsid, { BlueFS::BDEV_DB, false, false }));
+  ASSERT_EQ(0, fs.mount());
+  ASSERT_EQ(0, fs.maybe_verify_layout({ BlueFS::BDEV_DB, false, false }));
+  ASSERT_EQ(0, fs.mkdir("dir"));
+  for (int j = 0; j < 100; j++) {
+    BlueFS::FileWriter *h;
+    ASSERT_EQ(0, fs.open_for_write("dir", "file." + to_string(j), &h, false));
+    ASSERT_NE(nullptr, h);
+    auto sg = make_scope_guard([&fs, h] { fs.close_writer(h); });
+    std::unique_ptr<char[]> buf = gen_buffer(4096);
+    h->append(buf.get(), 4096);
+    fs.fsync(h);
+  }
+  // compactions were queued by fsync and run by the background thread
+  auto *logger = fs.get_perf_counters();
+  for (int i = 0; i < 100 && logger->get(l_bluefs_log_compactions) == 0; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_NE(0u, logger->get(l_bluefs_log_compactions));
+  fs.umount(true);
+  // remount and check the compacted log replays
+  ASSERT_EQ(0, fs.mount());
+  std::vector<std::string> ls;
+  ASSERT_EQ(0, fs.readdir("dir", &ls));
+  ASSERT_EQ(100u + 2u, ls.size()); // with . and ..
+  fs.umount();
+}
+
 TEST(BlueFS, test_compaction_sync) {
   uint64_t size = 1048576 * 128;
   TempBdev bdev{size};
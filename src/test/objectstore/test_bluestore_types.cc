@@ -397,6 +397,53 @@ TEST(bluestore_blob_t, calc_csum)
   }
 }
 
+TEST(bluestore_blob_t, verify_csum_batch)
+{
+  bufferlist bl;
+  bl.append("asdfghjkqwertyuizxcvbnm,");
+  // same content, spread over several buffers
+  bufferlist split;
+  split.append("asdfg");
+  split.append("hjkqwertyu");
+  split.append("izxcvbnm,");
+  bufferlist bad;
+  bad.append("asdfghjkqwertyuiXXXXXXXX");
+  bufferlist tail;
+  tail.substr_of(bl, 16, 8);
+
+  for (unsigned csum_type = Checksummer::CSUM_NONE + 1;
+       csum_type < Checksummer::CSUM_MAX;
+       ++csum_type) {
+    cout << "csum_type " << Checksummer::get_csum_type_string(csum_type)
+	 << std::endl;
+
+    bluestore_blob_t a, b;
+    a.init_csum(csum_type, 3, 24);
+    a.calc_csum(0, bl);
+    b.init_csum(csum_type, 3, 24);
+    b.calc_csum(0, split);
+    ASSERT_EQ(a.get_csum_item(2), b.get_csum_item(2));
+
+    size_t bad_item;
+    int bad_off;
+    uint64_t bad_csum;
+    std::vector<Checksummer::verify_item_t> items = {
+      {a.csum_type, a.get_csum_chunk_size(), 0, &bl, &a.csum_data},
+      {b.csum_type, b.get_csum_chunk_size(), 0, &split, &b.csum_data},
+      {a.csum_type, a.get_csum_chunk_size(), 16, &tail, &a.csum_data},
+    };
+    ASSERT_EQ(0, Checksummer::verify_batch(items, &bad_item, &bad_off,
+					   &bad_csum));
+
+    items.push_back({b.csum_type, b.get_csum_chunk_size(), 0, &bad,
+		     &b.csum_data});
+    ASSERT_EQ(-1, Checksummer::verify_batch(items, &bad_item, &bad_off,
+					    &bad_csum));
+    ASSERT_EQ(3u, bad_item);
+    ASSERT_EQ(16, bad_off);
+  }
+}
+
 TEST(bluestore_blob_t, csum_bench)
 {
   bufferlist bl;
@@ -20,6 +20,7 @@
 #include "kv/KeyValueDB.h"
 #include "kv/RocksDBStore.h"
 #include "include/Context.h"
+#include "include/stringify.h"
 #include "common/ceph_argparse.h"
 #include "global/global_init.h"
 #include "common/Cond.h"
@@ -358,6 +359,44 @@ TEST_P(KVTest, ShardingRMRange) {
   fini();
 }
 
+TEST_P(KVTest, GetMulti) {
+  // O is sharded over column families, P lives in the default one
+  std::string cfs("O(3)=");
+  ASSERT_EQ(0, db->create_and_open(cout, cfs));
+  {
+    KeyValueDB::Transaction t = db->get_transaction();
+    for (size_t i = 0; i < 100; i += 2) {
+      bufferlist value;
+      value.append("value" + stringify(i));
+      t->set("O", "key" + stringify(i), value);
+      t->set("P", "key" + stringify(i), value);
+    }
+    db->submit_transaction_sync(t);
+  }
+  for (auto prefix : { "O", "P" }) {
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < 100; i++) {
+      keys.push_back("key" + stringify(i));
+    }
+    std::vector<std::optional<bufferlist>> values;
+    ASSERT_EQ(50, db->get_multi(prefix, keys, &values));
+    ASSERT_EQ(keys.size(), values.size());
+    for (size_t i = 0; i < 100; i++) {
+      if (i % 2) {
+	ASSERT_FALSE(values[i]);
+      } else {
+	ASSERT_TRUE(values[i]);
+	ASSERT_EQ("value" + stringify(i), values[i]->to_str());
+      }
+    }
+    std::set<std::string> kset(keys.begin(), keys.end());
+    std::map<std::string, bufferlist> out;
+    ASSERT_EQ(0, db->get(prefix, kset, &out));
+    ASSERT_EQ(50u, out.size());
+    ASSERT_EQ("value42", out["key42"].to_str());
+  }
+  fini();
+}
 
 TEST_P(KVTest, RocksDBColumnFamilyTest) {
   if(string(GetParam()) != "rocksdb")
@@ -13,7 +13,9 @@
  */
 
 #include "os/ObjectStore.h"
+#include "os/TransactionTracer.h"
 #include <gtest/gtest.h>
+#include "common/Formatter.h"
 #include "common/Clock.h"
 #include "include/utime.h"
 #include <boost/tuple/tuple.hpp>
@@ -211,3 +213,52 @@ TEST(Transaction, GetNumBytesBenchCurrent)
 {
    bench_num_bytes(false);
 }
+
+TEST(Transaction, TraceElideRestore)
+{
+  coll_t cid(spg_t(pg_t(1, 2)));
+  ghobject_t a(hobject_t(sobject_t("a", CEPH_NOSNAP)));
+  ghobject_t b(hobject_t(sobject_t("b", CEPH_NOSNAP)));
+  bufferlist data, attr;
+  data.append(std::string(4096, 'x'));
+  attr.append("oi");
+  std::map<std::string, bufferlist> keys = {{"k", attr}};
+
+  ObjectStore::Transaction t;
+  t.write(cid, a, 0, data.length(), data);
+  t.setattr(cid, a, "_", attr);
+  t.omap_setkeys(cid, a, keys);
+  t.clone(cid, a, b);
+  t.zero(cid, b, 100, 200);
+  t.write(cid, b, 8192, data.length(), data);
+
+  // writes are recorded as zeros, which restore() turns back into writes
+  TransactionTracer::event_t e;
+  ObjectStore::Transaction elided;
+  ASSERT_TRUE(TransactionTracer::rebuild(t, elided,
+    [&e](uint32_t i, uint32_t op) {
+      if (op == ObjectStore::Transaction::OP_WRITE) {
+	e.elided.push_back(i);
+	return true;
+      }
+      return false;
+    }));
+  ASSERT_EQ(std::vector<uint32_t>({0, 5}), e.elided);
+  elided.encode(e.txn);
+  ASSERT_LT(e.txn.length(), data.length());
+
+  bufferlist bl;
+  encode(e, bl);
+  TransactionTracer::event_t d;
+  auto p = bl.cbegin();
+  decode(d, p);
+  auto restored = d.restore();
+
+  JSONFormatter f1, f2;
+  t.dump(&f1);
+  restored.dump(&f2);
+  std::ostringstream s1, s2;
+  f1.flush(s1);
+  f2.flush(s2);
+  ASSERT_EQ(s1.str(), s2.str());
+}
@@ -261,3 +261,38 @@ TEST_F(mClockSchedulerTest, TestAllQueuesEnqueueDequeue) {
 
   ASSERT_TRUE(q.empty());
 }
+
+TEST_F(mClockSchedulerTest, TestCapacityCalibration) {
+  const double configured = q.get_capacity_per_shard();
+  auto& conf = g_ceph_context->_conf;
+  conf.set_val_or_die("osd_mclock_capacity_calibration_interval", "0.05");
+  conf.set_val_or_die("osd_mclock_capacity_calibration_alpha", "1");
+  conf.set_val_or_die("osd_mclock_capacity_calibration", "true");
+  conf.apply_changes(nullptr);
+
+  // a backlog drained far slower than the configured capacity
+  for (unsigned i = 0; i < 200; ++i) {
+    q.enqueue(create_item(i, client1, op_scheduler_class::client));
+  }
+  while (!q.empty()) {
+    auto r = q.dequeue();
+    if (!std::get_if<OpSchedulerItem>(&r)) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_TRUE(q.empty());
+
+  // the estimate is bounded by the configured capacity
+  ASSERT_LT(q.get_capacity_per_shard(), configured);
+  ASSERT_GE(q.get_capacity_per_shard(), configured / 4);
+
+  conf.set_val_or_die("osd_mclock_capacity_calibration", "false");
+  conf.apply_changes(nullptr);
+  ASSERT_EQ(configured, q.get_capacity_per_shard());
+
+  conf.rm_val("osd_mclock_capacity_calibration");
+  conf.rm_val("osd_mclock_capacity_calibration_interval");
+  conf.rm_val("osd_mclock_capacity_calibration_alpha");
+  conf.apply_changes(nullptr);
+}
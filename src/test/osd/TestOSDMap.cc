@@ -545,6 +545,211 @@ TEST_F(OSDMapTest, MapFunctionsMatch) {
   EXPECT_EQ(acting_osds, acting_osds_two);
 }
 
+TEST_F(OSDMapTest, MapPGRangeMatches) {
+  set_up_map();
+
+  // make sure temps and upmaps are honoured by the batched path
+  {
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    pg_t pgid = osdmap.raw_pg_to_pg(pg_t(1, my_rep_pool));
+    vector<int> up_osds, acting_osds;
+    osdmap.pg_to_up_acting_osds(pgid, up_osds, acting_osds);
+    std::reverse(acting_osds.begin(), acting_osds.end());
+    inc.new_pg_temp[pgid] = mempool::osdmap::vector<int>(
+      acting_osds.begin(), acting_osds.end());
+    osdmap.apply_incremental(inc);
+  }
+
+  for (auto pool : {my_ec_pool, my_rep_pool}) {
+    unsigned pg_num = osdmap.get_pg_pool(pool)->get_pg_num();
+    unsigned mapped = 0;
+    osdmap.pg_range_to_up_acting_osds(
+      pool, 0, pg_num,
+      [&](pg_t pgid, vector<int>&& up, int up_primary,
+	  vector<int>&& acting, int acting_primary) {
+	ASSERT_EQ(mapped++, pgid.ps());
+	vector<int> up_osds, acting_osds;
+	int up_p, acting_p;
+	osdmap.pg_to_up_acting_osds(pgid, &up_osds, &up_p,
+				    &acting_osds, &acting_p);
+	EXPECT_EQ(up_osds, up);
+	EXPECT_EQ(up_p, up_primary);
+	EXPECT_EQ(acting_osds, acting);
+	EXPECT_EQ(acting_p, acting_primary);
+      });
+    EXPECT_EQ(pg_num, mapped);
+  }
+}
+
+TEST_F(OSDMapTest, IncrementalMapping) {
+  set_up_map();
+  ThreadPool tp(g_ceph_context, "IncrementalMapping::tp", "inc_map_tp", 2);
+  tp.start();
+  ParallelPGMapper mapper(g_ceph_context, &tp);
+  mapping.start_update(osdmap, mapper, 16)->wait();
+
+  auto apply_and_check = [&](OSDMap::Incremental& inc) {
+    osdmap.apply_incremental(inc);
+    mapping.start_update(osdmap, inc, mapper, 16)->wait();
+    ASSERT_EQ(osdmap.get_epoch(), mapping.get_epoch());
+    for (auto& [poolid, pool] : osdmap.get_pools()) {
+      for (unsigned ps = 0; ps < pool.get_pg_num(); ++ps) {
+	pg_t pgid(ps, poolid);
+	vector<int> up, acting, up2, acting2;
+	int up_primary, acting_primary, up_primary2, acting_primary2;
+	osdmap.pg_to_up_acting_osds(pgid, &up, &up_primary,
+				    &acting, &acting_primary);
+	mapping.get(pgid, &up2, &up_primary2, &acting2, &acting_primary2);
+	ASSERT_EQ(up, up2);
+	ASSERT_EQ(up_primary, up_primary2);
+	ASSERT_EQ(acting, acting2);
+	ASSERT_EQ(acting_primary, acting_primary2);
+      }
+    }
+  };
+
+  {
+    // osd marked down
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_state[0] = CEPH_OSD_UP;
+    apply_and_check(inc);
+  }
+  {
+    // osd marked out
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_weight[1] = CEPH_OSD_OUT;
+    apply_and_check(inc);
+  }
+  {
+    // primary affinity and an upmap
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_primary_affinity[2] = 0;
+    pg_t pgid(0, my_rep_pool);
+    vector<int> up, acting;
+    osdmap.pg_to_up_acting_osds(pgid, up, acting);
+    int to = (up[0] + 1) % get_num_osds();
+    while (std::find(up.begin(), up.end(), to) != up.end() || to == 0 || to == 1)
+      to = (to + 1) % get_num_osds();
+    inc.new_pg_upmap_items[pgid] =
+      mempool::osdmap::vector<pair<int32_t,int32_t>>({{up[0], to}});
+    apply_and_check(inc);
+  }
+  {
+    // osd back up and in
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_state[0] = CEPH_OSD_UP;
+    inc.new_weight[1] = CEPH_OSD_IN;
+    apply_and_check(inc);
+  }
+  tp.stop();
+}
+
+TEST_F(OSDMapTest, DedupSharesUpmaps) {
+  set_up_map();
+  pg_t pgid(0, my_rep_pool);
+  pg_t pgid2(1, my_rep_pool);
+  {
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_pg_upmap_items[pgid] =
+      mempool::osdmap::vector<pair<int32_t,int32_t>>({{0, 1}});
+    osdmap.apply_incremental(inc);
+  }
+  ASSERT_TRUE(osdmap.have_pg_upmaps(pgid));
+
+  // an epoch that does not touch the upmaps shares them after dedup
+  OSDMap next;
+  next.deepish_copy_from(osdmap);
+  {
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_weight[1] = CEPH_OSD_OUT;
+    next.apply_incremental(inc);
+  }
+  OSDMap::dedup(&osdmap, &next);
+  ASSERT_TRUE(next.have_pg_upmaps(pgid));
+
+  // modifying the shared tables must not leak into the older epoch
+  {
+    OSDMap::Incremental inc(next.get_epoch() + 1);
+    inc.new_pg_upmap_items[pgid2] =
+      mempool::osdmap::vector<pair<int32_t,int32_t>>({{0, 2}});
+    inc.old_pg_upmap_items.insert(pgid);
+    next.apply_incremental(inc);
+  }
+  ASSERT_FALSE(next.have_pg_upmaps(pgid));
+  ASSERT_TRUE(next.have_pg_upmaps(pgid2));
+  ASSERT_TRUE(osdmap.have_pg_upmaps(pgid));
+  ASSERT_FALSE(osdmap.have_pg_upmaps(pgid2));
+}
+
+TEST_F(OSDMapTest, FanoutTree) {
+  set_up_map();
+  {
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_state[2] = CEPH_OSD_UP;  // mark down
+    osdmap.apply_incremental(inc);
+  }
+  vector<int> order;
+  osdmap.get_fanout_order(&order);
+  ASSERT_EQ((unsigned)get_num_osds() - 1, order.size());
+
+  for (unsigned fanout : {1u, 2u, 3u}) {
+    // walking the tree from the root reaches every up osd exactly once
+    map<int,int> seen;
+    vector<int> queue{osdmap.get_fanout_root(order)};
+    while (!queue.empty()) {
+      int osd = queue.back();
+      queue.pop_back();
+      ++seen[osd];
+      vector<int> children;
+      osdmap.get_fanout_children(order, osd, fanout, &children);
+      ASSERT_LE(children.size(), fanout);
+      queue.insert(queue.end(), children.begin(), children.end());
+    }
+    ASSERT_EQ(order.size(), seen.size());
+    for (auto& [osd, count] : seen) {
+      ASSERT_TRUE(osdmap.is_up(osd));
+      ASSERT_EQ(1, count);
+    }
+  }
+}
+
+TEST_F(OSDMapTest, SampleOsdsBySubtree) {
+  set_up_map();
+  // build_simple puts every osd on the same host
+  set<int> peers{1, 2, 3, 4, 5};
+  {
+    set<int> out;
+    osdmap.sample_osds_by_subtree(0, "host", 0, peers, {}, &out);
+    ASSERT_EQ(peers, out);
+  }
+  {
+    set<int> out;
+    osdmap.sample_osds_by_subtree(0, "osd", 2, peers, {}, &out);
+    ASSERT_EQ(peers, out);
+  }
+  {
+    // current peers are kept
+    set<int> out;
+    osdmap.sample_osds_by_subtree(0, "host", 2, peers, {4}, &out);
+    ASSERT_EQ(2u, out.size());
+    ASSERT_EQ(1u, out.count(4));
+  }
+  {
+    set<int> out;
+    osdmap.sample_osds_by_subtree(0, "host", 3, peers, {1, 2, 3, 4}, &out);
+    ASSERT_EQ(3u, out.size());
+  }
+  {
+    // different osds pick different samples
+    set<int> out0, out1;
+    osdmap.sample_osds_by_subtree(0, "host", 1, peers, {}, &out0);
+    osdmap.sample_osds_by_subtree(1, "host", 1, peers, {}, &out1);
+    ASSERT_EQ(1u, out0.size());
+    ASSERT_EQ(1u, out1.size());
+    ASSERT_NE(out0, out1);
+  }
+}
+
 /** This test must be removed or modified appropriately when we allow
  * other ways to specify a primary. */
 TEST_F(OSDMapTest, PrimaryIsFirst) {
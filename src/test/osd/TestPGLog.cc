@@ -2912,6 +2912,47 @@ TEST_F(PGLogTrimTest, TestGetRequest) {
   EXPECT_FALSE(result);
 }
 
+TEST_F(PGLogTrimTest, TestLazyIndexes) {
+  SetUp(20);
+  entity_name_t client = entity_name_t::CLIENT(777);
+  pg_log_t plog;
+  plog.head = mk_evt(21, 167);
+  plog.tail = mk_evt(15, 150);
+  plog.log.push_back(mk_ple_mod(mk_obj(1), mk_evt(20, 160), mk_evt(15, 150),
+				osd_reqid_t(client, 8, 4)));
+  plog.log.push_back(mk_ple_mod(mk_obj(4), mk_evt(21, 165), mk_evt(20, 160),
+				osd_reqid_t(client, 8, 5)));
+  plog.dups.push_back(pg_log_dup_t(mk_evt(15, 150), 150,
+				   osd_reqid_t(client, 8, 2), 0));
+  plog.dups.push_back(pg_log_dup_t(mk_evt(15, 155), 155,
+				   osd_reqid_t(client, 8, 3), 0));
+
+  // only the object index is built up front
+  PGLog::IndexedLog log(plog);
+  EXPECT_EQ(2u, log.objects.size());
+  EXPECT_EQ(0u, log.caller_ops.size());
+  EXPECT_EQ(0u, log.dup_index.size());
+
+  eversion_t version;
+  version_t user_version;
+  int return_code;
+  vector<pg_log_op_return_item_t> op_returns;
+  EXPECT_TRUE(log.get_request(osd_reqid_t(client, 8, 3), &version,
+			      &user_version, &return_code, &op_returns));
+  EXPECT_EQ(mk_evt(15, 155), version);
+  EXPECT_EQ(2u, log.caller_ops.size());
+  EXPECT_EQ(2u, log.dup_index.size());
+
+  // and dropped again on demand
+  log.unindex_lazy();
+  EXPECT_EQ(2u, log.objects.size());
+  EXPECT_EQ(0u, log.caller_ops.size());
+  EXPECT_EQ(0u, log.dup_index.size());
+  EXPECT_TRUE(log.get_request(osd_reqid_t(client, 8, 4), &version,
+			      &user_version, &return_code, &op_returns));
+  EXPECT_EQ(mk_evt(20, 160), version);
+}
+
 TEST_F(PGLogTest, _merge_object_divergent_entries) {
   {
     // Test for issue 20843
@@ -0,0 +1,114 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ */
+
+#include "gtest/gtest.h"
+#include "messages/MOSDRepOp.h"
+#include "messages/MOSDRepOpBatch.h"
+#include "messages/MOSDRepOpReply.h"
+
+namespace {
+
+ceph::ref_t<MOSDRepOp> make_repop(int pool, const std::string& name,
+                                  ceph_tid_t tid, eversion_t v)
+{
+  hobject_t poid(object_t(name), "", CEPH_NOSNAP, 0, pool, "");
+  return ceph::make_message<MOSDRepOp>(
+    osd_reqid_t(entity_name_t::CLIENT(4100), 0, tid),
+    pg_shard_t(1), spg_t(pg_t(0, pool)), poid,
+    CEPH_OSD_FLAG_ACK | CEPH_OSD_FLAG_ONDISK, 20, 18, tid, v);
+}
+
+ceph::ref_t<MOSDRepOpBatch> round_trip(MOSDRepOpBatch *batch)
+{
+  ceph::bufferlist bl;
+  encode_message(batch, CEPH_FEATURES_ALL, bl);
+  auto p = bl.cbegin();
+  Message *m = decode_message(nullptr, 0, p);
+  EXPECT_TRUE(p.end());
+  if (!m) {
+    return nullptr;
+  }
+  EXPECT_EQ(MSG_OSD_REPOP_BATCH, m->get_type());
+  return ceph::ref_t<MOSDRepOpBatch>(static_cast<MOSDRepOpBatch*>(m), false);
+}
+
+} // anonymous namespace
+
+TEST(MOSDRepOpBatch, Empty)
+{
+  auto batch = ceph::make_message<MOSDRepOpBatch>();
+  auto decoded = round_trip(batch.get());
+  ASSERT_TRUE(decoded);
+  ASSERT_TRUE(decoded->msgs.empty());
+}
+
+TEST(MOSDRepOpBatch, RoundTrip)
+{
+  // ops and replies of different PGs, in the order they were queued
+  auto op1 = make_repop(1, "foo", 10, eversion_t(20, 5));
+  auto op2 = make_repop(2, "bar", 11, eversion_t(20, 7));
+  auto reply = ceph::make_message<MOSDRepOpReply>(
+    op1.get(), pg_shard_t(2), 0, 20, 18, CEPH_OSD_FLAG_ONDISK);
+  reply->set_last_complete_ondisk(eversion_t(20, 4));
+
+  std::vector<MessageRef> msgs{op1, reply, op2};
+  auto batch = ceph::make_message<MOSDRepOpBatch>(std::move(msgs));
+  auto decoded = round_trip(batch.get());
+  ASSERT_TRUE(decoded);
+  ASSERT_EQ(3u, decoded->msgs.size());
+
+  ASSERT_EQ(MSG_OSD_REPOP, decoded->msgs[0]->get_type());
+  ASSERT_EQ(MSG_OSD_REPOPREPLY, decoded->msgs[1]->get_type());
+  ASSERT_EQ(MSG_OSD_REPOP, decoded->msgs[2]->get_type());
+
+  for (auto [i, op] : {std::pair{0, op1}, std::pair{2, op2}}) {
+    auto m = static_cast<MOSDRepOp*>(decoded->msgs[i].get());
+    m->finish_decode();
+    EXPECT_EQ(op->get_tid(), m->get_tid());
+    EXPECT_EQ(op->reqid, m->reqid);
+    EXPECT_EQ(op->pgid, m->pgid);
+    EXPECT_EQ(op->poid, m->poid);
+    EXPECT_EQ(op->version, m->version);
+    EXPECT_EQ(op->from, m->from);
+    EXPECT_EQ(op->get_map_epoch(), m->get_map_epoch());
+    EXPECT_EQ(op->get_min_epoch(), m->get_min_epoch());
+  }
+
+  auto r = static_cast<MOSDRepOpReply*>(decoded->msgs[1].get());
+  r->finish_decode();
+  EXPECT_EQ(reply->get_tid(), r->get_tid());
+  EXPECT_EQ(reply->reqid, r->reqid);
+  EXPECT_EQ(reply->pgid, r->pgid);
+  EXPECT_EQ(reply->from, r->from);
+  EXPECT_TRUE(r->is_ondisk());
+  EXPECT_EQ(0, r->get_result());
+  EXPECT_EQ(eversion_t(20, 4), r->get_last_complete_ondisk());
+}
+
+TEST(MOSDRepOpBatch, Malformed)
+{
+  auto batch = ceph::make_message<MOSDRepOpBatch>(
+    std::vector<MessageRef>{make_repop(1, "foo", 10, eversion_t(20, 5))});
+  batch->encode(CEPH_FEATURES_ALL, 0);
+
+  // a batch claiming more messages than it holds is refused
+  ceph::bufferlist payload;
+  encode((uint32_t)2, payload);
+  auto p = batch->get_payload().cbegin();
+  uint32_t n;
+  decode(n, p);
+  ASSERT_EQ(1u, n);
+  p.copy(p.get_remaining(), payload);
+
+  auto bad = ceph::make_message<MOSDRepOpBatch>();
+  bad->set_payload(payload);
+  ASSERT_THROW(bad->decode_payload(), ceph::buffer::error);
+}
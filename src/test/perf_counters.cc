@@ -18,6 +18,7 @@
 
 #include "common/perf_counters_key.h"
 #include "common/perf_counters_collection.h"
+#include "common/perf_counters_stream.h"
 #include "common/admin_socket_client.h"
 #include "common/ceph_context.h"
 #include "common/config.h"
@@ -260,6 +261,53 @@ TEST(PerfCounters, read_avg) {
   t1.join();
 }
 
+enum {
+  TEST_PERFCOUNTERS5_ELEMENT_FIRST = 500,
+  TEST_PERFCOUNTERS5_ELEMENT_OPS,
+  TEST_PERFCOUNTERS5_ELEMENT_LAT,
+  TEST_PERFCOUNTERS5_ELEMENT_LAST,
+};
+
+TEST(PerfCounters, Sharded) {
+  PerfCountersBuilder bld(g_ceph_context, "test_perfcounter_5",
+      TEST_PERFCOUNTERS5_ELEMENT_FIRST, TEST_PERFCOUNTERS5_ELEMENT_LAST);
+  bld.set_sharded_default(true);
+  bld.add_u64_counter(TEST_PERFCOUNTERS5_ELEMENT_OPS, "ops");
+  bld.add_time_avg(TEST_PERFCOUNTERS5_ELEMENT_LAT, "lat");
+  std::shared_ptr<PerfCounters> fake_pf(bld.create_perf_counters());
+
+  utime_t t;
+  t.set_from_double(0.000000001);
+  std::vector<std::thread> threads;
+  for (int n = 0; n < 8; ++n) {
+    threads.emplace_back([fake_pf, t] {
+      for (int i = 0; i < 10000; ++i) {
+	fake_pf->inc(TEST_PERFCOUNTERS5_ELEMENT_OPS);
+	fake_pf->tinc(TEST_PERFCOUNTERS5_ELEMENT_LAT, t);
+      }
+    });
+  }
+  threads.emplace_back([fake_pf] {
+    for (int i = 0; i < 10000; ++i) {
+      auto dat = fake_pf->get_tavg_ns(TEST_PERFCOUNTERS5_ELEMENT_LAT);
+      ASSERT_EQ(dat.first, dat.second);
+    }
+  });
+  for (auto& th : threads) {
+    th.join();
+  }
+  ASSERT_EQ(80000u, fake_pf->get(TEST_PERFCOUNTERS5_ELEMENT_OPS));
+  ASSERT_EQ(std::make_pair(80000ul, 80000ul),
+	    fake_pf->get_tavg_ns(TEST_PERFCOUNTERS5_ELEMENT_LAT));
+
+  fake_pf->set(TEST_PERFCOUNTERS5_ELEMENT_OPS, 5);
+  ASSERT_EQ(5u, fake_pf->get(TEST_PERFCOUNTERS5_ELEMENT_OPS));
+  fake_pf->reset();
+  ASSERT_EQ(0u, fake_pf->get(TEST_PERFCOUNTERS5_ELEMENT_OPS));
+  ASSERT_EQ(std::make_pair(0ul, 0ul),
+	    fake_pf->get_tavg_ns(TEST_PERFCOUNTERS5_ELEMENT_LAT));
+}
+
 static PerfCounters* setup_test_perfcounter4(std::string name, CephContext *cct)
 {
   PerfCountersBuilder bld(cct, name,
@@ -690,3 +738,72 @@ TEST(PerfCounters, TestLabelStrings) {
 
   g_ceph_context->get_perfcounters_collection()->clear();
 }
+
+static ceph::perf_counters::stream_reply_t
+stream_request(AdminSocketClient& client, uint64_t seq)
+{
+  std::string message;
+  EXPECT_EQ("", client.do_request(
+    R"({ "prefix": "counter stream", "subscriber": "test", "seq": )" +
+    std::to_string(seq) + " }", &message));
+  bufferlist bl;
+  bl.append(message);
+  auto p = bl.cbegin();
+  ceph::perf_counters::stream_reply_t reply;
+  decode(reply, p);
+  return reply;
+}
+
+TEST(PerfCounters, CounterStream) {
+  PerfCountersCollection *coll = g_ceph_context->get_perfcounters_collection();
+  coll->clear();
+  PerfCounters* fake_pf1 = setup_test_perfcounters1(g_ceph_context);
+  coll->add(fake_pf1);
+  AdminSocketClient client(get_rand_socket_path());
+  ceph::perf_counters::StreamReader reader;
+
+  // the schema and every value first: element3 is a sum and a count
+  auto reply = stream_request(client, reader.seq);
+  ASSERT_TRUE(reply.full);
+  ASSERT_EQ(1u, reply.schema.size());
+  ASSERT_EQ("test_perfcounter_1", reply.schema[0].key);
+  ASSERT_EQ(3u, reply.schema[0].counters.size());
+  ASSERT_EQ("element3", reply.schema[0].counters[2].name);
+  ASSERT_EQ(4u, reply.values.size());
+  ASSERT_TRUE(reader.apply(reply));
+
+  // then only what changed
+  fake_pf1->inc(TEST_PERFCOUNTERS1_ELEMENT_1, 5);
+  fake_pf1->tinc(TEST_PERFCOUNTERS1_ELEMENT_3, utime_t(2, 0));
+  reply = stream_request(client, reader.seq);
+  ASSERT_FALSE(reply.full);
+  ASSERT_TRUE(reply.schema.empty());
+  ASSERT_EQ(3u, reply.values.size());
+  ASSERT_TRUE(reader.apply(reply));
+  ASSERT_EQ(5u, reader.values[0]);
+  ASSERT_EQ(0u, reader.values[1]);
+  ASSERT_EQ(2000000000u, reader.values[2]);
+  ASSERT_EQ(1u, reader.values[3]);
+
+  reply = stream_request(client, reader.seq);
+  ASSERT_FALSE(reply.full);
+  ASSERT_TRUE(reply.values.empty());
+  ASSERT_TRUE(reader.apply(reply));
+
+  // a subscriber that lost track starts over
+  reply = stream_request(client, 0);
+  ASSERT_TRUE(reply.full);
+  ASSERT_EQ(4u, reply.values.size());
+  ASSERT_TRUE(reader.apply(reply));
+
+  // and so does everyone once the counters change shape
+  coll->add(setup_test_perfcounter2(g_ceph_context));
+  reply = stream_request(client, reader.seq);
+  ASSERT_TRUE(reply.full);
+  ASSERT_EQ(2u, reply.schema.size());
+  ASSERT_EQ(6u, reply.values.size());
+  ASSERT_TRUE(reader.apply(reply));
+  ASSERT_EQ(5u, reader.values[0]);
+
+  coll->clear();
+}
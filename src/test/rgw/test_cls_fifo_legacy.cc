@@ -12,9 +12,12 @@
  *
  */
 
+#include <atomic>
 #include <cerrno>
 #include <iostream>
+#include <set>
 #include <string_view>
+#include <thread>
 
 #include "include/scope_guard.h"
 #include "include/types.h"
@@ -419,6 +422,66 @@ TEST_F(LegacyFIFO, TestTwoPushers)
   }
 }
 
+TEST_F(LegacyFIFO, TestConcurrentPushers)
+{
+  static constexpr auto max_part_size = 2048ull;
+  static constexpr auto max_entry_size = 128ull;
+
+  std::unique_ptr<RCf::FIFO> f;
+  auto r = RCf::FIFO::create(&dp, ioctx, fifo_id, &f, null_yield, std::nullopt,
+			     std::nullopt, false, max_part_size,
+			     max_entry_size);
+  ASSERT_EQ(0, r);
+
+  auto [part_header_size, part_entry_overhead] = f->get_part_layout_info();
+  const auto entries_per_part = ((max_part_size - part_header_size) /
+				 (max_entry_size + part_entry_overhead));
+  static constexpr auto nthreads = 8u;
+  const auto per_thread = entries_per_part * 2;
+
+  /* pushes of one FIFO by many threads are combined, and span parts */
+  std::vector<std::thread> threads;
+  std::atomic<int> failures = 0;
+  for (auto t = 0u; t < nthreads; ++t) {
+    threads.emplace_back([&, t] {
+      char buf[max_entry_size];
+      memset(buf, 0, sizeof(buf));
+      for (auto i = 0u; i < per_thread; ++i) {
+	cb::list bl;
+	*(int *)buf = t * per_thread + i;
+	bl.append(buf, sizeof(buf));
+	if (f->push(&dp, bl, null_yield) < 0) {
+	  ++failures;
+	}
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(0, failures);
+
+  std::vector<RCf::list_entry> result;
+  bool more = false;
+  const auto max_entries = nthreads * per_thread;
+  r = f->list(&dp, max_entries * 2, std::nullopt, &result, &more, null_yield);
+  ASSERT_EQ(0, r);
+  ASSERT_FALSE(more);
+  ASSERT_EQ(max_entries, result.size());
+
+  /* every entry exactly once, and each thread's in its order */
+  std::set<int> seen;
+  std::vector<int> last(nthreads, -1);
+  for (auto& e : result) {
+    auto v = *(int *)e.data.c_str();
+    ASSERT_TRUE(seen.insert(v).second);
+    auto t = v / per_thread;
+    ASSERT_LT(last[t], v);
+    last[t] = v;
+  }
+  ASSERT_GT(f->meta().head_part_num, 0);
+}
+
 TEST_F(LegacyFIFO, TestTwoPushersTrim)
 {
   static constexpr auto max_part_size = 2048ull;
@@ -56,6 +56,8 @@ protected:
   {
     std::string name;
   public:
+    int fill_count{0};
+
     MockSalBucket(const std::string& name)
       : name(name)
       {}
@@ -66,6 +68,7 @@ protected:
     using fill_cache_cb_t = file::listing::fill_cache_cb_t;
 
     int fill_cache(const DoutPrefixProvider* dpp, optional_yield y, fill_cache_cb_t cb) {
+      ++fill_count;
       sf::path rp{bucket_root};
       sf::path bp{rp / name};
       if (! (sf::exists(rp) && sf::is_directory(rp))) {
@@ -433,6 +436,75 @@ TEST_F(BucketCacheFixtureInotify1, List2Inotify1)
   }
 } /* List2Inotify1 */
 
+class BucketCacheFixturePersist1 : public testing::Test, protected BucketCacheFixtureBase {
+protected:
+  static void SetUpTestSuite() {
+    int nfiles = 20;
+    std::string bucket{"persist1"};
+
+    sf::path tp{sf::path{bucket_root} / bucket};
+    sf::remove_all(tp);
+    sf::create_directory(tp);
+
+    std::string fbase{"file_"};
+    for (int ix = 0; ix < nfiles; ++ix) {
+      sf::path ttp{tp / fmt::format("{}{}", fbase, ix)};
+      std::ofstream ofs(ttp);
+      ofs << "data for " << ttp << std::endl;
+      ofs.close();
+    }
+    /* age the directory, so its stamp isn't too recent to persist */
+    sf::last_write_time(tp, sf::file_time_type::clock::now() - 1h);
+    bucket_cache = new BucketCache{&sal_driver, bucket_root, database_root,
+				   100, 3, 3, 3, true /* persist */};
+  }
+
+  static void TearDownTestSuite() {
+    delete bucket_cache;
+    bucket_cache = nullptr;
+  }
+};
+
+TEST_F(BucketCacheFixturePersist1, RestartPersist1)
+{
+  std::string bucket{"persist1"};
+  std::string marker{""};
+  std::vector<std::string> names;
+
+  auto f = [&](const rgw_bucket_dir_entry& bde) -> int {
+    names.push_back(bde.key.name);
+    return true;
+  };
+
+  MockSalBucket sb{bucket};
+
+  (void) bucket_cache->list_bucket(dpp, null_yield, &sb, marker, f);
+  ASSERT_EQ(names.size(), 20);
+  ASSERT_EQ(sb.fill_count, 1);
+
+  /* the listing survives a restart */
+  delete bucket_cache;
+  bucket_cache = new BucketCache{&sal_driver, bucket_root, database_root,
+				 100, 3, 3, 3, true /* persist */};
+  names.clear();
+  (void) bucket_cache->list_bucket(dpp, null_yield, &sb, marker, f);
+  ASSERT_EQ(names.size(), 20);
+  ASSERT_EQ(sb.fill_count, 1);
+
+  /* but not a change to the directory while it wasn't watched */
+  delete bucket_cache;
+  sf::path ttp{sf::path{bucket_root} / bucket / "newfile_0"};
+  std::ofstream ofs(ttp);
+  ofs << "data for " << ttp << std::endl;
+  ofs.close();
+  bucket_cache = new BucketCache{&sal_driver, bucket_root, database_root,
+				 100, 3, 3, 3, true /* persist */};
+  names.clear();
+  (void) bucket_cache->list_bucket(dpp, null_yield, &sb, marker, f);
+  ASSERT_EQ(names.size(), 21);
+  ASSERT_EQ(sb.fill_count, 2);
+} /* RestartPersist1 */
+
 int main (int argc, char *argv[])
 {
 
@@ -0,0 +1,133 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab ft=cpp
+
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ */
+
+#include "rgw_cache.h"
+#include "common/dout.h"
+#include "global/global_context.h"
+#include <gtest/gtest.h>
+
+#define dout_subsys ceph_subsys_rgw
+
+namespace {
+
+// records what the object cache tells its chained caches
+struct TestChainedCache : RGWChainedCache {
+  std::set<std::string> chained;
+  std::set<std::string> invalidated;
+  int invalidated_all = 0;
+
+  void chain_cb(const std::string& key, void *data) override {
+    chained.insert(key);
+  }
+  void invalidate(const std::string& key) override {
+    invalidated.insert(key);
+  }
+  void invalidate_all() override {
+    ++invalidated_all;
+  }
+};
+
+// enough entries that they spread over several shards
+constexpr int num_entries = 32;
+
+class ObjectCacheTest : public ::testing::Test {
+protected:
+  NoDoutPrefix dpp{g_ceph_context, dout_subsys};
+  ObjectCache cache;
+  TestChainedCache chained;
+  std::vector<std::string> names;
+  std::vector<rgw_cache_entry_info> infos;
+
+  void SetUp() override {
+    g_ceph_context->_conf.set_val("rgw_cache_shards", "8");
+    cache.set_ctx(g_ceph_context);
+    cache.set_enabled(true);
+    cache.chain_cache(&chained);
+    infos.resize(num_entries);
+    for (int i = 0; i < num_entries; ++i) {
+      names.push_back("obj" + std::to_string(i));
+      ObjectCacheInfo info;
+      info.flags = CACHE_FLAG_DATA;
+      cache.put(&dpp, names[i], info, &infos[i]);
+    }
+  }
+  void TearDown() override {
+    cache.unchain_cache(&chained);
+    g_ceph_context->_conf.rm_val("rgw_cache_shards");
+  }
+
+  bool chain(const std::string& key, int n) {
+    std::string data;
+    RGWChainedCache::Entry entry(&chained, key, &data);
+    switch (n) {
+    case 2:
+      return cache.chain_cache_entry(&dpp, {&infos[0], &infos[1]}, &entry);
+    default:
+      return cache.chain_cache_entry(&dpp, {&infos[0], &infos[1], &infos[2],
+                                            &infos[3], &infos[4], &infos[5],
+                                            &infos[6], &infos[7]}, &entry);
+    }
+  }
+};
+
+} // anonymous namespace
+
+TEST_F(ObjectCacheTest, ChainAcrossShards)
+{
+  EXPECT_TRUE(chain("chained", 8));
+  EXPECT_EQ(1u, chained.chained.count("chained"));
+
+  // invalidating any one of the underlying entries invalidates the chain
+  EXPECT_TRUE(cache.invalidate_remove(&dpp, names[5]));
+  EXPECT_EQ(1u, chained.invalidated.count("chained"));
+  EXPECT_FALSE(cache.get(&dpp, names[5]));
+  EXPECT_TRUE(cache.get(&dpp, names[4]));
+}
+
+TEST_F(ObjectCacheTest, ChainStaleGen)
+{
+  // an entry rewritten after the lookup must not be chained
+  ObjectCacheInfo info;
+  info.flags = CACHE_FLAG_DATA;
+  cache.put(&dpp, names[1], info, nullptr);
+  EXPECT_FALSE(chain("stale", 2));
+  EXPECT_EQ(0u, chained.chained.count("stale"));
+}
+
+TEST_F(ObjectCacheTest, PutInvalidatesChain)
+{
+  EXPECT_TRUE(chain("chained", 2));
+  ObjectCacheInfo info;
+  info.flags = CACHE_FLAG_DATA;
+  cache.put(&dpp, names[1], info, nullptr);
+  EXPECT_EQ(1u, chained.invalidated.count("chained"));
+}
+
+TEST_F(ObjectCacheTest, InvalidateAll)
+{
+  EXPECT_TRUE(chain("chained", 8));
+  cache.invalidate_all();
+  EXPECT_EQ(1, chained.invalidated_all);
+  for (const auto& name : names) {
+    EXPECT_FALSE(cache.get(&dpp, name));
+  }
+  // the old gens are gone with the entries
+  EXPECT_FALSE(chain("again", 2));
+}
+
+TEST_F(ObjectCacheTest, Disable)
+{
+  cache.set_enabled(false);
+  EXPECT_EQ(1, chained.invalidated_all);
+  EXPECT_FALSE(cache.get(&dpp, names[0]));
+  EXPECT_FALSE(chain("disabled", 8));
+}
@@ -419,3 +419,97 @@ TEST_F(LCWorkTimeTests, ScheduleNextStartTime)
 
    run_schedule_next_start_time_test(test_values_to_expectations);
 }
+
+struct LCTimeIndexTests : ::testing::Test
+{
+   boost::intrusive_ptr<CephContext> cct;
+   RGWLifecycleConfiguration config;
+
+   // 2023-01-15 00:00:00 UTC
+   static constexpr time_t day_start = 1673740800;
+   static constexpr time_t day = 24 * 60 * 60;
+
+   void add_rule(const std::string& id, const std::string& prefix,
+                 int days, bool enabled = true) {
+      LCRule rule;
+      rule.init_simple_days_rule(id, prefix, days);
+      rule.set_enabled(enabled);
+      ASSERT_EQ(0, config.check_and_add_rule(rule));
+   }
+
+protected:
+
+   void SetUp() override {
+      cct.reset(new CephContext(CEPH_ENTITY_TYPE_ANY), false);
+      config = RGWLifecycleConfiguration(cct.get());
+   }
+
+   void TearDown() override {
+      cct.reset();
+   }
+};
+
+TEST_F(LCTimeIndexTests, DueTimeRoundsUpToDay)
+{
+   // lifecycle processing compares the object age against the current day
+   auto mtime = ceph::real_clock::from_time_t(day_start + 10 * 60 * 60);
+   ASSERT_EQ(ceph::real_clock::from_time_t(day_start + 3 * day),
+             rgw::lc::time_index_due(cct.get(), mtime, 2));
+
+   mtime = ceph::real_clock::from_time_t(day_start);
+   ASSERT_EQ(ceph::real_clock::from_time_t(day_start + 2 * day),
+             rgw::lc::time_index_due(cct.get(), mtime, 2));
+}
+
+TEST_F(LCTimeIndexTests, DueTimeDebugInterval)
+{
+   cct->_conf->rgw_lc_debug_interval = 10;
+   auto mtime = ceph::real_clock::from_time_t(day_start + 7);
+   ASSERT_EQ(ceph::real_clock::from_time_t(day_start + 7 + 30),
+             rgw::lc::time_index_due(cct.get(), mtime, 3));
+}
+
+TEST_F(LCTimeIndexTests, EntriesFollowRules)
+{
+   add_rule("logs", "logs/", 2);
+   add_rule("tmp", "tmp/", 1);
+   add_rule("off", "off/", 1, false);
+   auto mtime = ceph::real_clock::from_time_t(day_start);
+
+   std::vector<rgw::sal::Lifecycle::LCTimeIndexEntry> entries;
+   rgw::lc::time_index_entries(cct.get(), config, "logs/a", mtime, entries);
+   ASSERT_EQ(1u, entries.size());
+   ASSERT_EQ("logs/a", entries[0].key);
+   ASSERT_EQ(ceph::real_clock::from_time_t(day_start + 2 * day), entries[0].due);
+
+   // no matching prefix, or a disabled rule, indexes nothing
+   entries.clear();
+   rgw::lc::time_index_entries(cct.get(), config, "other/a", mtime, entries);
+   ASSERT_TRUE(entries.empty());
+   rgw::lc::time_index_entries(cct.get(), config, "off/a", mtime, entries);
+   ASSERT_TRUE(entries.empty());
+}
+
+TEST_F(LCTimeIndexTests, EntriesOfOverlappingRules)
+{
+   add_rule("all", "", 5);
+   add_rule("logs", "logs/", 2);
+   auto mtime = ceph::real_clock::from_time_t(day_start);
+
+   std::vector<rgw::sal::Lifecycle::LCTimeIndexEntry> entries;
+   rgw::lc::time_index_entries(cct.get(), config, "logs/a", mtime, entries);
+   ASSERT_EQ(2u, entries.size());
+   std::set<ceph::real_time> due;
+   for (const auto& e : entries) {
+      due.insert(e.due);
+   }
+   ASSERT_EQ(1u, due.count(ceph::real_clock::from_time_t(day_start + 2 * day)));
+   ASSERT_EQ(1u, due.count(ceph::real_clock::from_time_t(day_start + 5 * day)));
+
+   // the index follows the mtime it is given, not the time of the write
+   entries.clear();
+   mtime = ceph::real_clock::from_time_t(day_start - 10 * day);
+   rgw::lc::time_index_entries(cct.get(), config, "x", mtime, entries);
+   ASSERT_EQ(1u, entries.size());
+   ASSERT_EQ(ceph::real_clock::from_time_t(day_start - 5 * day), entries[0].due);
+}
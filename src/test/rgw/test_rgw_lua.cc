@@ -300,6 +300,33 @@ TEST(TestRGWLua, SetResponse)
   ASSERT_EQ(rc, 0);
 }
 
+TEST(TestRGWLua, CachedScript)
+{
+  const std::string script = R"(
+    assert(Request.Response.Message == "this is a bad request")
+    Request.Response.Message = "this is a good request"
+  )";
+
+  // the second run of each script uses the cached bytecode
+  for (auto i = 0; i < 2; ++i) {
+    DEFINE_REQ_STATE;
+    s.err.message = "this is a bad request";
+
+    const auto rc = lua::request::execute(nullptr, nullptr, nullptr, &s, nullptr, script);
+    ASSERT_EQ(rc, 0);
+    ASSERT_EQ(s.err.message, "this is a good request");
+  }
+
+  // a changed script is compiled anew
+  const std::string changed_script = R"(
+    Request.Response.Message = "this is a changed request"
+  )";
+  DEFINE_REQ_STATE;
+  const auto rc = lua::request::execute(nullptr, nullptr, nullptr, &s, nullptr, changed_script);
+  ASSERT_EQ(rc, 0);
+  ASSERT_EQ(s.err.message, "this is a changed request");
+}
+
 TEST(TestRGWLua, RGWIdNotWriteable)
 {
   const std::string script = R"(
@@ -0,0 +1,83 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab ft=cpp
+
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ */
+
+#include "rgw_quota.h"
+#include "common/ceph_context.h"
+#include "global/global_context.h"
+#include <gtest/gtest.h>
+
+class QuotaStaleStats : public ::testing::Test {
+protected:
+  ConfigProxy& conf = g_ceph_context->_conf;
+  const utime_t expiration{1000, 0};
+
+  void SetUp() override {
+    conf.set_val("rgw_bucket_quota_ttl", "600");
+    conf.set_val("rgw_bucket_quota_stale_ttl", "60");
+    conf.apply_changes(nullptr);
+  }
+  void TearDown() override {
+    conf.rm_val("rgw_bucket_quota_ttl");
+    conf.rm_val("rgw_bucket_quota_stale_ttl");
+    conf.apply_changes(nullptr);
+  }
+  utime_t after_expiration(int secs) const {
+    utime_t t = expiration;
+    t += secs;
+    return t;
+  }
+};
+
+TEST_F(QuotaStaleStats, WhileRefreshing)
+{
+  EXPECT_TRUE(rgw_quota_stale_stats_usable(conf, expiration, true,
+                                           after_expiration(1)));
+  EXPECT_TRUE(rgw_quota_stale_stats_usable(conf, expiration, true,
+                                           after_expiration(59)));
+}
+
+TEST_F(QuotaStaleStats, PastStaleTTL)
+{
+  EXPECT_FALSE(rgw_quota_stale_stats_usable(conf, expiration, true,
+                                            after_expiration(60)));
+  EXPECT_FALSE(rgw_quota_stale_stats_usable(conf, expiration, true,
+                                            after_expiration(3600)));
+}
+
+TEST_F(QuotaStaleStats, NoRefreshInFlight)
+{
+  // e.g. the refresh could not be started, or it failed
+  EXPECT_FALSE(rgw_quota_stale_stats_usable(conf, expiration, false,
+                                            after_expiration(1)));
+}
+
+TEST_F(QuotaStaleStats, Disabled)
+{
+  conf.set_val("rgw_bucket_quota_stale_ttl", "0");
+  conf.apply_changes(nullptr);
+  EXPECT_FALSE(rgw_quota_stale_stats_usable(conf, expiration, true,
+                                            after_expiration(1)));
+}
+
+TEST_F(QuotaStaleStats, DisabledWithoutCacheTTL)
+{
+  // stats are not cached at all
+  conf.set_val("rgw_bucket_quota_ttl", "0");
+  conf.apply_changes(nullptr);
+  EXPECT_FALSE(rgw_quota_stale_stats_usable(conf, expiration, true,
+                                            after_expiration(1)));
+}
+
+TEST(QuotaStaleStatsDefault, Off)
+{
+  EXPECT_EQ(0, g_ceph_context->_conf->rgw_bucket_quota_stale_ttl);
+}
@@ -138,6 +138,88 @@ TEST(Aio_Throttle, ThrottleOverMax)
   EXPECT_EQ(window, max_outstanding);
 }
 
+TEST(Aio_Throttle, AdaptiveWindowGrows)
+{
+  constexpr uint64_t window = 4;
+  constexpr uint64_t max_window = 16;
+  AioWindowBudget budget(64);
+
+  auto obj = make_obj(__PRETTY_FUNCTION__);
+
+  constexpr uint64_t total = 64;
+  uint64_t max_outstanding = 0;
+  uint64_t outstanding = 0;
+
+  // timer thread
+  boost::asio::io_context context;
+  using Executor = boost::asio::io_context::executor_type;
+  using Work = boost::asio::executor_work_guard<Executor>;
+  std::optional<Work> work(context.get_executor());
+  std::thread worker([&context] { context.run(); });
+  auto g = make_scope_guard([&work, &worker] {
+      work.reset();
+      worker.join();
+    });
+  {
+    BlockingAioThrottle throttle(window, max_window, &budget);
+    for (uint64_t i = 0; i < total; i++) {
+      using namespace std::chrono_literals;
+      auto c = throttle.get(obj, wait_for(context, 10ms), 1, 0);
+      outstanding++;
+      outstanding -= c.size();
+      if (max_outstanding < outstanding) {
+        max_outstanding = outstanding;
+      }
+    }
+    auto c = throttle.drain();
+    outstanding -= c.size();
+    EXPECT_EQ(0u, outstanding);
+    EXPECT_LT(window, max_outstanding);
+    EXPECT_GE(max_window, max_outstanding);
+  }
+  // the borrowed window is returned on destruction
+  EXPECT_EQ(0u, budget.get_reserved());
+}
+
+TEST(Aio_Throttle, AdaptiveWindowBudget)
+{
+  constexpr uint64_t window = 4;
+  AioWindowBudget budget(0);
+  BlockingAioThrottle throttle(window, 16, &budget);
+
+  auto obj = make_obj(__PRETTY_FUNCTION__);
+
+  constexpr uint64_t total = 32;
+  uint64_t max_outstanding = 0;
+  uint64_t outstanding = 0;
+
+  // timer thread
+  boost::asio::io_context context;
+  using Executor = boost::asio::io_context::executor_type;
+  using Work = boost::asio::executor_work_guard<Executor>;
+  std::optional<Work> work(context.get_executor());
+  std::thread worker([&context] { context.run(); });
+  auto g = make_scope_guard([&work, &worker] {
+      work.reset();
+      worker.join();
+    });
+
+  for (uint64_t i = 0; i < total; i++) {
+    using namespace std::chrono_literals;
+    auto c = throttle.get(obj, wait_for(context, 10ms), 1, 0);
+    outstanding++;
+    outstanding -= c.size();
+    if (max_outstanding < outstanding) {
+      max_outstanding = outstanding;
+    }
+  }
+  auto c = throttle.drain();
+  outstanding -= c.size();
+  EXPECT_EQ(0u, outstanding);
+  // an exhausted budget pins the window to its base size
+  EXPECT_EQ(window, max_outstanding);
+}
+
 TEST(Aio_Throttle, YieldCostOverWindow)
 {
   auto obj = make_obj(__PRETTY_FUNCTION__);
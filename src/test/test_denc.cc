@@ -269,6 +269,98 @@ TEST(denc, vector)
   }
 }
 
+// a memcpy safe type whose per element denc must never be called
+struct denc_counter_memcpy_t {
+  uint8_t v = 0;
+  void bound_encode(size_t& p) const {
+    ++counts.num_bound_encode;
+    ++p;
+  }
+  void encode(buffer::list::contiguous_appender& p) const {
+    denc(v, p);
+    ++counts.num_encode;
+  }
+  void decode(buffer::ptr::const_iterator &p) {
+    denc(v, p);
+    ++counts.num_decode;
+  }
+};
+WRITE_CLASS_DENC_BOUNDED(denc_counter_memcpy_t)
+template<>
+struct denc_memcpy_safe<denc_counter_memcpy_t> : std::true_type {};
+
+template<typename T>
+void test_memcpy_vector(const std::vector<T>& v)
+{
+  // the bulk encoding must match the element by element one
+  bufferlist expected;
+  encode(std::list<T>(v.begin(), v.end()), expected);
+  bufferlist bl;
+  encode(v, bl);
+  ASSERT_TRUE(bl.contents_equal(expected));
+  {
+    std::vector<T> v2;
+    auto p = bl.cbegin();
+    decode(v2, p);
+    ASSERT_EQ(v, v2);
+  }
+  {
+    // segmented
+    bufferlist seg;
+    const char* data = bl.c_str();
+    for (unsigned i = 0; i < bl.length(); i += 7) {
+      seg.append(buffer::copy(data + i, std::min(7u, bl.length() - i)));
+    }
+    std::vector<T> v2;
+    auto p = seg.cbegin();
+    decode(v2, p);
+    ASSERT_EQ(v, v2);
+  }
+  {
+    // truncated input fails without resizing to the bogus count
+    bufferlist bad;
+    bad.substr_of(bl, 0, bl.length() - 1);
+    std::vector<T> v2;
+    auto p = bad.cbegin();
+    ASSERT_THROW(decode(v2, p), buffer::end_of_buffer);
+  }
+}
+
+TEST(denc, vector_memcpy)
+{
+  static_assert(denc_memcpy_safe_v<uint32_t>);
+  static_assert(denc_memcpy_safe_v<ceph_le64>);
+  static_assert(!denc_memcpy_safe_v<bool>);
+  static_assert(!denc_memcpy_safe_v<std::string>);
+
+  std::vector<uint32_t> u32(1000);
+  std::iota(u32.begin(), u32.end(), 0xfffff000u);
+  test_memcpy_vector(u32);
+  std::vector<int64_t> s64(333);
+  std::iota(s64.begin(), s64.end(), -100);
+  test_memcpy_vector(s64);
+  std::vector<uint16_t> u16(7, 0xabcd);
+  test_memcpy_vector(u16);
+  test_memcpy_vector(std::vector<uint64_t>{});
+
+  counts.reset();
+  std::vector<denc_counter_memcpy_t> c(100), c2;
+  for (unsigned i = 0; i < c.size(); ++i) {
+    c[i].v = i;
+  }
+  {
+    bufferlist bl;
+    encode(c, bl);
+    ASSERT_EQ(4u + 100u, bl.length());
+    decode(c2, bl);
+  }
+  ASSERT_EQ(counts.num_bound_encode, 0);
+  ASSERT_EQ(counts.num_encode, 0);
+  ASSERT_EQ(counts.num_decode, 0);
+  ASSERT_EQ(c2.size(), 100u);
+  ASSERT_EQ(c2[42].v, 42);
+}
+
 template<typename T>
 using default_list = std::list<T>;
 
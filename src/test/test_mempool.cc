@@ -404,6 +404,30 @@ TEST(mempool, btree_map_test)
   ASSERT_EQ(0, mempool::osd::allocated_bytes());
 }
 
+TEST(mempool, sampling)
+{
+  // sample (nearly) every allocation
+  mempool::set_sample_rate(1);
+  {
+    mempool::unittest_2::vector<int> v;
+    v.reserve(1000);
+    ASSERT_LT(0u, mempool::live_samples.load());
+
+    std::ostringstream ss;
+    mempool::dump_samples_pprof(ss);
+    ASSERT_EQ(0u, ss.str().find("heap profile: "));
+    ASSERT_NE(std::string::npos, ss.str().find("MAPPED_LIBRARIES:"));
+  }
+  ASSERT_EQ(0u, mempool::live_samples.load());
+
+  JSONFormatter f;
+  mempool::dump_samples(&f);
+  std::ostringstream ss;
+  f.flush(ss);
+  ASSERT_NE(std::string::npos, ss.str().find("\"unittest_2\""));
+  mempool::set_sample_rate(0);
+}
+
 #if !defined(__arm__) && !defined(__aarch64__)
 TEST(mempool, check_shard_select)
 {
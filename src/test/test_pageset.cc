@@ -281,3 +281,30 @@ TEST(PageSet, FreeHoles)
   pages.get_range(0, 8, range);
   ASSERT_EQ(0u, range.size());
 }
+
+TEST(PageSet, Arena)
+{
+  PageSet pages(64, true);
+  PageSet::page_vector range;
+
+  pages.alloc_range(0, 256, range);
+  ASSERT_EQ(4u, range.size());
+  for (auto& page : range) {
+    ASSERT_TRUE(is_aligned(page.get()));
+    ASSERT_NE(0u, page->arena_size);
+  }
+  const size_t size = range[0]->arena_size;
+  char *data = range[3]->data;
+  range.clear();
+
+  // freed pages go back to the arena, and are handed out again
+  const size_t num_free = PageArena::instance().num_free(size);
+  pages.free_pages_after(192);
+  ASSERT_EQ(3u, pages.size());
+  ASSERT_EQ(num_free + 1, PageArena::instance().num_free(size));
+
+  pages.alloc_range(192, 64, range);
+  ASSERT_EQ(1u, range.size());
+  ASSERT_EQ(data, range[0]->data);
+  ASSERT_EQ(num_free, PageArena::instance().num_free(size));
+}
@@ -17,12 +17,15 @@
 
 #include <filesystem>
 #include <iomanip>
+#include <set>
 
 #include "ceph_ver.h"
 #include "include/types.h"
 #include "common/Formatter.h"
 #include "common/ceph_argparse.h"
 #include "common/errno.h"
+#include "common/strtol.h"
+#include "denc_bench.h"
 #include "denc_plugin.h"
 #include "denc_registry.h"
 
@@ -60,6 +63,19 @@ void usage(ostream &out)
   out << "  count_tests         print number of generated test objects (to stdout)\n";
   out << "  select_test <n>     select generated test object as in-memory object\n";
   out << "  is_deterministic    exit w/ success if type encodes deterministically\n";
+  out << "\n";
+  out << "  bench               time encoding and decoding the in-memory object, or\n";
+  out << "                      the imported data\n";
+  out << "  bench_generated     time every generated test object of the selected\n";
+  out << "                      type, or of every type\n";
+  out << "  bench_corpus <dir>  time every object under <dir>/<type>/, as in\n";
+  out << "                      ceph-object-corpus/archive/<version>/objects\n";
+  out << "  bench_time <secs>   time each operation for <secs> (default 0.1)\n";
+  out << "  bench_baseline <file>\n";
+  out << "                      compare with the output of an earlier run, and exit\n";
+  out << "                      w/ failure on a regression\n";
+  out << "  bench_threshold <pct>\n";
+  out << "                      slowdown counted as a regression (default 10)\n";
 }
 
 vector<DencoderPlugin> load_plugins()
@@ -109,6 +125,10 @@ int main(int argc, const char **argv)
   uint64_t features = CEPH_FEATURES_SUPPORTED_DEFAULT;
   bufferlist encbl;
   uint64_t skip = 0;
+  string import_name;
+  DencoderBench bench;
+  bool bench_started = false;
+  std::set<Dencoder*> generated;
 
   if (args.empty()) {
     cerr << "-h for help" << std::endl;
@@ -139,7 +159,9 @@ int main(int argc, const char **argv)
 	return 1;
       }
       den = dencoders[cname];
-      den->generate();
+      if (generated.insert(den).second) {
+	den->generate();
+      }
     } else if (*i == string("skip")) {
       ++i;
       if (i == args.end()) {
@@ -213,6 +235,7 @@ int main(int argc, const char **argv)
       } else {
 	r = encbl.read_file(*i, &err);
       }
+      import_name = *i;
       if (r < 0) {
         cerr << "error reading " << *i << ": " << err << std::endl;
         return 1;
@@ -263,6 +286,103 @@ int main(int argc, const char **argv)
 	return 0;
       else
 	return 1;
+    } else if (*i == string("bench_time")) {
+      ++i;
+      if (i == args.end()) {
+	cerr << "expecting seconds" << std::endl;
+	return 1;
+      }
+      bench.min_time = strict_strtod(*i, &err);
+    } else if (*i == string("bench_threshold")) {
+      ++i;
+      if (i == args.end()) {
+	cerr << "expecting percent" << std::endl;
+	return 1;
+      }
+      bench.threshold = strict_strtod(*i, &err);
+    } else if (*i == string("bench_baseline")) {
+      ++i;
+      if (i == args.end()) {
+	cerr << "expecting filename" << std::endl;
+	return 1;
+      }
+      if (bench_started) {
+	cerr << "bench_baseline must come before the bench commands" << std::endl;
+	return 1;
+      }
+      bench.load_baseline(*i, &err);
+    } else if (*i == string("bench")) {
+      if (!den) {
+	cerr << "must first select type with 'type <name>'" << std::endl;
+	return 1;
+      }
+      if (!bench_started) {
+	bench.print_header(cout);
+	bench_started = true;
+      }
+      string type;
+      for (auto& [name, d] : dencoders) {
+	if (d == den) {
+	  type = name;
+	}
+      }
+      err = bench.run(type, import_name.empty() ? "-" : import_name, den,
+		      encbl, features | CEPH_FEATURE_RESERVED, cout);
+    } else if (*i == string("bench_generated")) {
+      if (!bench_started) {
+	bench.print_header(cout);
+	bench_started = true;
+      }
+      for (auto& [name, d] : dencoders) {
+	if (den && d != den) {
+	  continue;
+	}
+	if (generated.insert(d).second) {
+	  d->generate();
+	}
+	for (int n = 1; n <= d->num_generated(); ++n) {
+	  d->select_generated(n);
+	  string e = bench.run(name, "generated:" + std::to_string(n), d, {},
+			       features | CEPH_FEATURE_RESERVED, cout);
+	  if (e.length()) {
+	    cerr << name << " " << n << ": " << e << std::endl;
+	  }
+	}
+      }
+    } else if (*i == string("bench_corpus")) {
+      ++i;
+      if (i == args.end()) {
+	cerr << "expecting directory" << std::endl;
+	return 1;
+      }
+      if (!fs::is_directory(*i)) {
+	cerr << *i << " is not a directory" << std::endl;
+	return 1;
+      }
+      if (!bench_started) {
+	bench.print_header(cout);
+	bench_started = true;
+      }
+      for (auto& [name, d] : dencoders) {
+	if (den && d != den) {
+	  continue;
+	}
+	fs::path dir = fs::path(*i) / name;
+	if (!fs::is_directory(dir)) {
+	  continue;
+	}
+	for (auto& entry : fs::directory_iterator(dir)) {
+	  bufferlist bl;
+	  string e;
+	  if (bl.read_file(entry.path().c_str(), &e) >= 0) {
+	    e = bench.run(name, entry.path().filename(), d, std::move(bl),
+			  features | CEPH_FEATURE_RESERVED, cout);
+	  }
+	  if (e.length()) {
+	    cerr << entry.path() << ": " << e << std::endl;
+	  }
+	}
+      }
     } else {
       cerr << "unknown option '" << *i << "'" << std::endl;
       return 1;
@@ -272,5 +392,10 @@ int main(int argc, const char **argv)
       return 1;
     }
   }
+  if (bench.get_regressions()) {
+    cerr << bench.get_regressions() << " regressions from the baseline"
+	 << std::endl;
+    return 1;
+  }
   return 0;
 }
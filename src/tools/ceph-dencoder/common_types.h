@@ -148,6 +148,8 @@ TYPE(cls_2pc_queue_expire_op)
 TYPE_NONDETERMINISTIC(cls_2pc_queue_reservations_ret)
 TYPE(cls_2pc_queue_reserve_op)
 TYPE(cls_2pc_queue_reserve_ret)
+TYPE(cls_2pc_queue_reserve_batch_op)
+TYPE(cls_2pc_queue_reserve_batch_ret)
 TYPE(cls_queue_init_op)
 
 #include "cls/2pc_queue/cls_2pc_queue_types.h"
@@ -586,6 +588,9 @@ MESSAGE(MOSDRepOp)
 #include "messages/MOSDRepOpReply.h"
 MESSAGE(MOSDRepOpReply)
 
+#include "messages/MOSDRepOpBatch.h"
+MESSAGE(MOSDRepOpBatch)
+
 #include "messages/MRecoveryReserve.h"
 MESSAGE(MRecoveryReserve)
 
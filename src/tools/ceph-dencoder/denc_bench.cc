@@ -0,0 +1,210 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "denc_bench.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+#include "common/strtol.h"
+#include "include/str_list.h"
+#include "denc_registry.h"
+
+using std::string;
+
+static std::atomic<uint64_t> alloc_count;
+static std::atomic<uint64_t> alloc_bytes;
+
+static void *counted_alloc(size_t size)
+{
+  alloc_count.fetch_add(1, std::memory_order_relaxed);
+  alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+  return std::malloc(size ? size : 1);
+}
+
+void *operator new(size_t size)
+{
+  if (void *p = counted_alloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t&) noexcept
+{
+  return counted_alloc(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+  return counted_alloc(size);
+}
+
+void operator delete(void *p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+  std::free(p);
+}
+
+namespace {
+
+struct measure_t {
+  double ns = 0;
+  double allocs = 0;
+  double alloc_bytes = 0;
+};
+
+// repeat f for at least min_time seconds, doubling the iterations
+template<typename F>
+measure_t measure(double min_time, F&& f)
+{
+  using clock = std::chrono::steady_clock;
+  f();
+  for (uint64_t n = 1; ; n *= 2) {
+    uint64_t count = alloc_count.load(std::memory_order_relaxed);
+    uint64_t bytes = alloc_bytes.load(std::memory_order_relaxed);
+    auto start = clock::now();
+    for (uint64_t i = 0; i < n; ++i) {
+      f();
+    }
+    std::chrono::duration<double> elapsed = clock::now() - start;
+    if (elapsed.count() >= min_time || n >= (1ull << 30)) {
+      measure_t m;
+      m.ns = elapsed.count() * 1e9 / n;
+      m.allocs = double(alloc_count.load(std::memory_order_relaxed) - count) / n;
+      m.alloc_bytes =
+	double(alloc_bytes.load(std::memory_order_relaxed) - bytes) / n;
+      return m;
+    }
+  }
+}
+
+string key_of(std::string_view type, const string& sample)
+{
+  return string(type) + "\t" + sample;
+}
+
+}
+
+int DencoderBench::load_baseline(const string& path, string *err)
+{
+  std::ifstream in(path);
+  if (!in) {
+    *err = "unable to open " + path;
+    return -ENOENT;
+  }
+  string line;
+  while (std::getline(in, line)) {
+    auto v = get_str_vec(line, "\t");
+    if (v.size() < 10 || v[0] == "type") {
+      continue;
+    }
+    result_t r;
+    string e;
+    r.encode_ns = strict_strtod(v[4].c_str(), &e);
+    r.encode_allocs = strict_strtod(v[5].c_str(), &e);
+    r.decode_ns = strict_strtod(v[7].c_str(), &e);
+    r.decode_allocs = strict_strtod(v[8].c_str(), &e);
+    if (!e.empty()) {
+      *err = "bad line in " + path + ": " + line;
+      return -EINVAL;
+    }
+    baseline[key_of(v[0], v[1])] = r;
+  }
+  return 0;
+}
+
+void DencoderBench::print_header(std::ostream& out) const
+{
+  out << "type\tsample\tbytes\tbuffers"
+      << "\tencode_ns\tencode_allocs\tencode_alloc_bytes"
+      << "\tdecode_ns\tdecode_allocs\tdecode_alloc_bytes";
+  if (!baseline.empty()) {
+    out << "\tencode_change\tdecode_change";
+  }
+  out << std::endl;
+}
+
+void DencoderBench::compare(double base_ns, double base_allocs,
+			    double ns, double allocs, std::ostream& out)
+{
+  double change = base_ns ? (ns / base_ns - 1) * 100 : 0;
+  out << "\t" << std::showpos << std::fixed << std::setprecision(1)
+      << change << "%" << std::noshowpos << std::defaultfloat;
+  // allocation counts do not vary between runs, so any rise is one
+  if (change > threshold || allocs > base_allocs + 0.5) {
+    out << "!";
+    ++regressions;
+  }
+}
+
+string DencoderBench::run(std::string_view type, const string& sample,
+			  Dencoder *den, ceph::buffer::list bl,
+			  uint64_t features, std::ostream& out)
+{
+  string err;
+  if (bl.length()) {
+    // the object as we would encode it is the one in bl
+    err = den->decode(bl, 0);
+    if (!err.empty()) {
+      return err;
+    }
+  }
+  ceph::buffer::list enc;
+  auto e = measure(min_time, [&] {
+    den->encode(enc, features);
+  });
+  if (bl.length() == 0) {
+    bl = enc;
+  }
+  // every decode gets a copy of bl, as the command does; make it one
+  // buffer so that copying it costs a single allocation
+  bl.rebuild();
+  auto d = measure(min_time, [&] {
+    err = den->decode(bl, 0);
+  });
+  if (!err.empty()) {
+    return err;
+  }
+
+  out << type << "\t" << sample << "\t" << bl.length()
+      << "\t" << enc.get_num_buffers()
+      << "\t" << e.ns << "\t" << e.allocs << "\t" << e.alloc_bytes
+      << "\t" << d.ns << "\t" << d.allocs << "\t" << d.alloc_bytes;
+  if (!baseline.empty()) {
+    if (auto p = baseline.find(key_of(type, sample)); p != baseline.end()) {
+      auto& base = p->second;
+      compare(base.encode_ns, base.encode_allocs, e.ns, e.allocs, out);
+      compare(base.decode_ns, base.decode_allocs, d.ns, d.allocs, out);
+    } else {
+      out << "\tnew\tnew";
+    }
+  }
+  out << std::endl;
+  return {};
+}
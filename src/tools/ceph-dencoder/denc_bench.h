@@ -0,0 +1,54 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <string_view>
+
+#include "include/buffer.h"
+
+struct Dencoder;
+
+/// Times the encoding and decoding of objects, counts the allocations
+/// they make, and compares the results with those of an earlier run.
+///
+/// Allocations are counted by replacing the global operator new, so the
+/// buffers encoded into (allocated with posix_memalign) are not counted;
+/// the number of them is reported instead.
+class DencoderBench {
+public:
+  /// seconds to repeat each operation for
+  double min_time = 0.1;
+  /// percent slower than the baseline we call a regression
+  double threshold = 10;
+
+  /// results of an earlier run, as printed by run()
+  int load_baseline(const std::string& path, std::string *err);
+  void print_header(std::ostream& out) const;
+
+  /// time den encoding its object and decoding bl, or the encoding of its
+  /// object if bl is empty, and print a line of results to out
+  std::string run(std::string_view type, const std::string& sample,
+		  Dencoder *den, ceph::buffer::list bl, uint64_t features,
+		  std::ostream& out);
+
+  unsigned get_regressions() const {
+    return regressions;
+  }
+
+private:
+  struct result_t {
+    double encode_ns = 0;
+    double encode_allocs = 0;
+    double decode_ns = 0;
+    double decode_allocs = 0;
+  };
+  std::map<std::string, result_t> baseline;
+  unsigned regressions = 0;
+
+  void compare(double base_ns, double base_allocs, double ns, double allocs,
+	       std::ostream& out);
+};
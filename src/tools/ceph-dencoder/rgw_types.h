@@ -63,6 +63,8 @@ TYPE(rgw_zone_set)
 TYPE(cls_rgw_lc_get_entry_ret)
 TYPE(rgw_cls_obj_prepare_op)
 TYPE(rgw_cls_obj_complete_op)
+TYPE(rgw_cls_obj_prepare_ops_op)
+TYPE(rgw_cls_obj_complete_ops_op)
 TYPE(rgw_cls_list_op)
 TYPE(rgw_cls_list_ret)
 TYPE(cls_rgw_gc_defer_entry_op)
@@ -84,6 +86,8 @@ TYPE(rgw_cls_read_olh_log_ret)
 TYPE(rgw_cls_trim_olh_log_op)
 TYPE(rgw_cls_bucket_clear_olh_op)
 TYPE(rgw_cls_check_index_ret)
+TYPE(rgw_cls_bucket_prefix_stats_op)
+TYPE(rgw_cls_bucket_prefix_stats_ret)
 TYPE(cls_rgw_reshard_add_op)
 TYPE(cls_rgw_reshard_list_op)
 TYPE(cls_rgw_reshard_list_ret)
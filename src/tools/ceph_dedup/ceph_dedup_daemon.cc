@@ -290,9 +290,11 @@ private:
     ObjectCursor end,
     size_t max_object_count);
   std::vector<size_t> sample_object(size_t count);
-  void try_dedup_and_accumulate_result(ObjectItem &object, snap_t snap = 0);
-  int do_chunk_dedup(chunk_t &chunk, snap_t snap);
-  bufferlist read_object(ObjectItem &object);
+  void try_dedup_and_accumulate_result(
+    ObjectItem &object, snap_t snap = 0, bufferlist *head = nullptr);
+  int do_chunk_dedup(std::list<chunk_t> &chunks, snap_t snap);
+  AioCompRef start_read(const std::string &oid, bufferlist *bl);
+  bufferlist read_object(ObjectItem &object, bufferlist *head = nullptr);
   std::vector<std::tuple<bufferlist, pair<uint64_t, uint64_t>>> do_cdc(
     ObjectItem &object,
     bufferlist &data);
@@ -328,8 +330,19 @@ void SampleDedupWorkerThread::crawl()
     // objects to pick. Lower sampling ratio makes crawler have lower crawling
     // overhead but find less duplication.
     auto sampled_indexes = sample_object(objects.size());
-    for (size_t index : sampled_indexes) {
-      ObjectItem target = objects[index];
+    // Without snaps, the head of the next sampled object is read while
+    // this one is chunked, fingerprinted and deduplicated.
+    AioCompRef reads[2];
+    bufferlist heads[2];
+    auto wait_reads = [&reads] {
+      for (auto &r : reads) {
+	if (r) {
+	  r->wait_for_complete();
+	}
+      }
+    };
+    for (size_t i = 0; i < sampled_indexes.size(); i++) {
+      ObjectItem target = objects[sampled_indexes[i]];
       if (snap) {
 	io_ctx.snap_set_read(librados::SNAP_DIR);
 	snap_set_t snap_set;
@@ -345,10 +358,32 @@ void SampleDedupWorkerThread::crawl()
 	  try_dedup_and_accumulate_result(target, r->cloneid);
 	}
       } else {
-	try_dedup_and_accumulate_result(target);
+	auto &cur = reads[i % 2];
+	auto &head = heads[i % 2];
+	if (!cur) {
+	  cur = start_read(target.oid, &head);
+	}
+	if (i + 1 < sampled_indexes.size()) {
+	  auto &next = objects[sampled_indexes[i + 1]];
+	  heads[(i + 1) % 2].clear();
+	  reads[(i + 1) % 2] = start_read(next.oid, &heads[(i + 1) % 2]);
+	}
+	cur->wait_for_complete();
+	int r = cur->get_return_value();
+	cur.reset();
+	if (r < 0) {
+	  derr << "read object error " << target.oid << " offset 0 size "
+	       << default_op_size << " error(" << cpp_strerror(r) << dendl;
+	} else {
+	  try_dedup_and_accumulate_result(target, 0, &head);
+	}
+	head.clear();
       }
       l.lock();
       if (all_stop) {
+	l.unlock();
+	wait_reads();
+	l.lock();
 	oid_for_evict.clear();
 	break;
       }
@@ -422,9 +457,9 @@ std::vector<size_t> SampleDedupWorkerThread::sample_object(size_t count)
 }
 
 void SampleDedupWorkerThread::try_dedup_and_accumulate_result(
-  ObjectItem &object, snap_t snap)
+  ObjectItem &object, snap_t snap, bufferlist *head)
 {
-  bufferlist data = read_object(object);
+  bufferlist data = read_object(object, head);
   if (data.length() == 0) {
     derr << __func__ << " skip object " << object.oid
 	 << " read returned size 0" << dendl;
@@ -476,18 +511,36 @@ void SampleDedupWorkerThread::try_dedup_and_accumulate_result(
   size_t object_size = data.length();
 
   // perform chunk-dedup
-  for (auto &p : redundant_chunks) {
-    do_chunk_dedup(p, snap);
+  if (!redundant_chunks.empty()) {
+    do_chunk_dedup(redundant_chunks, snap);
   }
   total_duplicated_size += duplicated_size;
   total_object_size += object_size;
 }
 
-bufferlist SampleDedupWorkerThread::read_object(ObjectItem &object)
+AioCompRef SampleDedupWorkerThread::start_read(
+  const std::string &oid, bufferlist *bl)
+{
+  AioCompRef completion(Rados::aio_create_completion());
+  io_ctx.aio_read(oid, completion.get(), bl, default_op_size, 0);
+  return completion;
+}
+
+bufferlist SampleDedupWorkerThread::read_object(
+  ObjectItem &object, bufferlist *head)
 {
   bufferlist whole_data;
   size_t offset = 0;
   int ret = -1;
+  if (head) {
+    // the first default_op_size bytes were read already; a short read
+    // means that was all of it
+    offset = head->length();
+    whole_data.claim_append(*head);
+    if (offset < default_op_size) {
+      ret = 0;
+    }
+  }
   while (ret != 0) {
     bufferlist partial_data;
     ret = io_ctx.read(object.oid, partial_data, default_op_size, offset);
@@ -546,33 +599,71 @@ std::string SampleDedupWorkerThread::generate_fingerprint(bufferlist chunk_data)
   return ret;
 }
 
-int SampleDedupWorkerThread::do_chunk_dedup(chunk_t &chunk, snap_t snap)
+int SampleDedupWorkerThread::do_chunk_dedup(
+  std::list<chunk_t> &chunks, snap_t snap)
 {
-  uint64_t size;
-  time_t mtime;
-
-  int ret = chunk_io_ctx.stat(chunk.fingerprint, &size, &mtime);
-
-  if (ret == -ENOENT) {
-    bufferlist bl;
-    bl.append(chunk.data);
+  // Each step is issued for all the chunks at once and then waited for,
+  // rather than a round trip at a time per chunk: stat the chunk objects,
+  // write the missing ones, then point the object at them.
+  struct op_t {
+    explicit op_t(chunk_t &chunk) : chunk(chunk) {}
+    chunk_t &chunk;
+    uint64_t size = 0;
+    time_t mtime = 0;
+    AioCompRef completion;
     ObjectWriteOperation wop;
-    wop.write_full(bl);
-    chunk_io_ctx.operate(chunk.fingerprint, &wop);
-  } else {
-    ceph_assert(ret == 0);
+    ObjectReadOperation rop;
+  };
+  std::list<op_t> ops;
+  for (auto &chunk : chunks) {
+    auto &op = ops.emplace_back(chunk);
+    op.completion.reset(Rados::aio_create_completion());
+    chunk_io_ctx.aio_stat(chunk.fingerprint, op.completion.get(),
+			  &op.size, &op.mtime);
+  }
+
+  for (auto &op : ops) {
+    op.completion->wait_for_complete();
+    int ret = op.completion->get_return_value();
+    op.completion.reset();
+    if (ret == -ENOENT) {
+      bufferlist bl;
+      bl.append(op.chunk.data);
+      op.wop.write_full(bl);
+      op.completion.reset(Rados::aio_create_completion());
+      chunk_io_ctx.aio_operate(op.chunk.fingerprint, op.completion.get(),
+			       &op.wop);
+    } else {
+      ceph_assert(ret == 0);
+    }
+  }
+  for (auto &op : ops) {
+    if (op.completion) {
+      op.completion->wait_for_complete();
+      op.completion.reset();
+    }
   }
 
-  ObjectReadOperation op;
-  op.set_chunk(
-      chunk.start,
-      chunk.size,
+  for (auto &op : ops) {
+    op.rop.set_chunk(
+      op.chunk.start,
+      op.chunk.size,
       chunk_io_ctx,
-      chunk.fingerprint,
+      op.chunk.fingerprint,
       0,
       CEPH_OSD_OP_FLAG_WITH_REFERENCE);
-  ret = io_ctx.operate(chunk.oid, &op, nullptr);
-  oid_for_evict.insert(make_pair(chunk.oid, snap));
+    op.completion.reset(Rados::aio_create_completion());
+    io_ctx.aio_operate(op.chunk.oid, op.completion.get(), &op.rop, nullptr);
+    oid_for_evict.insert(make_pair(op.chunk.oid, snap));
+  }
+  int ret = 0;
+  for (auto &op : ops) {
+    op.completion->wait_for_complete();
+    int r = op.completion->get_return_value();
+    if (r < 0 && ret == 0) {
+      ret = r;
+    }
+  }
   return ret;
 }
 
@@ -0,0 +1,361 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Replay a trace taken with the OSD "trace_transactions" admin socket
+ * command against an object store.
+ *
+ * The store is either a copy of the traced OSD's store, so that every
+ * object the trace touches exists, or (with --mkfs) a new one, where
+ * collections are created as they are first referenced and objects are
+ * touched before the ops that need them to exist.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "common/ceph_argparse.h"
+#include "common/errno.h"
+#include "common/strtol.h"
+#include "global/global_init.h"
+#include "os/ObjectStore.h"
+#include "os/TransactionTracer.h"
+
+using namespace std;
+using ceph::bufferlist;
+using Transaction = ObjectStore::Transaction;
+using event_t = TransactionTracer::event_t;
+using steady = std::chrono::steady_clock;
+
+static void usage()
+{
+  cout << "usage: ceph_replay_transactions [flags] <trace>\n"
+    "  --mkfs               create a new store to replay into\n"
+    "  --speed X            replay X times as fast as traced, 0 for as\n"
+    "                       fast as possible (1)\n"
+    "  --queue-depth N      transactions in flight at most (64)\n"
+    "  --read-threads N     threads issuing the traced reads (4), 0 to\n"
+    "                       skip reads\n"
+    "the store is given by --osd-objectstore and --osd-data\n"
+       << std::endl;
+  generic_server_usage();
+}
+
+struct latencies {
+  std::mutex lock;
+  std::vector<double> v;
+
+  void add(steady::time_point start) {
+    std::chrono::duration<double> d = steady::now() - start;
+    std::lock_guard l{lock};
+    v.push_back(d.count());
+  }
+  void print(const char *what) {
+    if (v.empty()) {
+      return;
+    }
+    std::sort(v.begin(), v.end());
+    double sum = 0;
+    for (auto x : v) {
+      sum += x;
+    }
+    auto at = [this](double q) {
+      return v[std::min<size_t>(q * v.size(), v.size() - 1)] * 1000;
+    };
+    cout << what << ": " << v.size() << ", avg " << sum / v.size() * 1000
+	 << "ms, p50 " << at(0.5) << "ms, p99 " << at(0.99)
+	 << "ms, p99.9 " << at(0.999) << "ms, max " << v.back() * 1000
+	 << "ms" << std::endl;
+  }
+};
+
+class C_Done : public Context {
+  std::function<void()> f;
+public:
+  explicit C_Done(std::function<void()>&& f) : f(std::move(f)) {}
+  void finish(int) override {
+    f();
+  }
+};
+
+/// what a new store lacks for the ops of a traced transaction to succeed
+class FreshStoreFixer {
+  std::set<ghobject_t> known;
+
+public:
+  static bool creates(Transaction& t, const coll_t& cid) {
+    for (auto i = t.begin(); i.have_op(); ) {
+      auto op = i.decode_op();
+      if (op->op == Transaction::OP_MKCOLL && i.get_cid(op->cid) == cid) {
+	return true;
+      }
+    }
+    return false;
+  }
+
+  /// touch the objects t modifies without creating them, unless earlier
+  /// ops did; creations and removals since are tracked
+  void fix(Transaction& t, Transaction *pre) {
+    auto i = t.begin();
+    while (i.have_op()) {
+      auto op = i.decode_op();
+      auto need = [&](uint32_t c, uint32_t o) {
+	const auto& oid = i.get_oid(o);
+	if (known.insert(oid).second) {
+	  pre->touch(i.get_cid(c), oid);
+	}
+      };
+      switch (op->op) {
+      case Transaction::OP_CLONE:
+      case Transaction::OP_CLONERANGE2:
+	need(op->cid, op->oid);
+	known.insert(i.get_oid(op->dest_oid));
+	break;
+      case Transaction::OP_SETATTR:
+      case Transaction::OP_SETATTRS:
+      case Transaction::OP_RMATTR:
+      case Transaction::OP_OMAP_SETKEYS:
+      case Transaction::OP_OMAP_RMKEYS:
+      case Transaction::OP_OMAP_RMKEYRANGE:
+      case Transaction::OP_OMAP_SETHEADER:
+	need(op->cid, op->oid);
+	break;
+      case Transaction::OP_COLL_MOVE_RENAME:
+      case Transaction::OP_TRY_RENAME:
+	known.erase(i.get_oid(op->oid));
+	known.insert(i.get_oid(op->dest_oid));
+	break;
+      case Transaction::OP_REMOVE:
+	known.erase(i.get_oid(op->oid));
+	break;
+      case Transaction::OP_CREATE:
+      case Transaction::OP_TOUCH:
+      case Transaction::OP_WRITE:
+      case Transaction::OP_ZERO:
+      case Transaction::OP_TRUNCATE:
+	known.insert(i.get_oid(op->oid));
+	break;
+      }
+    }
+  }
+};
+
+int main(int argc, const char **argv)
+{
+  auto args = argv_to_vec(argc, argv);
+  if (args.empty()) {
+    cerr << argv[0] << ": -h or --help for usage" << std::endl;
+    exit(1);
+  }
+  if (ceph_argparse_need_usage(args)) {
+    usage();
+    exit(0);
+  }
+
+  auto cct = global_init(nullptr, args, CEPH_ENTITY_TYPE_OSD,
+			 CODE_ENVIRONMENT_UTILITY,
+			 CINIT_FLAG_NO_DEFAULT_CONFIG_FILE);
+
+  bool mkfs = false;
+  double speed = 1;
+  int queue_depth = 64;
+  int read_threads = 4;
+  std::string val, err;
+  for (auto i = args.begin(); i != args.end(); ) {
+    if (ceph_argparse_double_dash(args, i)) {
+      break;
+    } else if (ceph_argparse_flag(args, i, "--mkfs", (char*)nullptr)) {
+      mkfs = true;
+    } else if (ceph_argparse_witharg(args, i, &val, "--speed", (char*)nullptr)) {
+      speed = strict_strtod(val.c_str(), &err);
+      if (!err.empty() || speed < 0) {
+	cerr << "bad --speed " << val << std::endl;
+	exit(1);
+      }
+    } else if (ceph_argparse_witharg(args, i, &queue_depth, cerr,
+				     "--queue-depth", (char*)nullptr)) {
+    } else if (ceph_argparse_witharg(args, i, &read_threads, cerr,
+				     "--read-threads", (char*)nullptr)) {
+    } else {
+      ++i;
+    }
+  }
+  if (args.size() != 1 || queue_depth < 1 || read_threads < 0) {
+    usage();
+    exit(1);
+  }
+
+  bufferlist trace;
+  if (int r = trace.read_file(args[0], &err); r < 0) {
+    cerr << "failed to read " << args[0] << ": " << err << std::endl;
+    exit(1);
+  }
+  auto p = trace.cbegin();
+  if (TransactionTracer::decode_header(p) < 0) {
+    cerr << args[0] << " is not a transaction trace" << std::endl;
+    exit(1);
+  }
+
+  common_init_finish(g_ceph_context);
+
+  auto os = ObjectStore::create(g_ceph_context,
+				g_conf()->osd_objectstore,
+				g_conf()->osd_data,
+				g_conf()->osd_journal);
+  if (!os) {
+    cerr << "bad objectstore type " << g_conf()->osd_objectstore << std::endl;
+    exit(1);
+  }
+  if (mkfs) {
+    if (int r = os->mkfs(); r < 0) {
+      cerr << "mkfs failed: " << cpp_strerror(r) << std::endl;
+      exit(1);
+    }
+  }
+  if (int r = os->mount(); r < 0) {
+    cerr << "mount failed: " << cpp_strerror(r) << std::endl;
+    exit(1);
+  }
+
+  // a transaction may create its collection, or (with --mkfs) get it
+  // created by pre; reads of collections we do not have are skipped
+  std::map<coll_t, ObjectStore::CollectionHandle> colls;
+  auto get_coll = [&](const coll_t& cid, Transaction *t, Transaction *pre) {
+    auto& ch = colls[cid];
+    if (!ch) {
+      ch = os->open_collection(cid);
+    }
+    if (!ch && t) {
+      ch = os->create_new_collection(cid);
+      if (mkfs && !FreshStoreFixer::creates(*t, cid)) {
+	pre->create_collection(cid, 0);
+      }
+    }
+    return ch;
+  };
+
+  // reads go to a few threads, as the OSD's op threads would issue them
+  std::mutex read_lock;
+  std::condition_variable read_cond;
+  std::deque<std::pair<event_t, steady::time_point>> read_queue;
+  bool reads_done = false;
+  latencies read_lat, txn_lat;
+  std::vector<std::thread> readers;
+  for (int n = 0; n < read_threads; ++n) {
+    readers.emplace_back([&] {
+      std::unique_lock l{read_lock};
+      while (true) {
+	read_cond.wait(l, [&] { return reads_done || !read_queue.empty(); });
+	if (read_queue.empty()) {
+	  break;
+	}
+	auto [e, start] = std::move(read_queue.front());
+	read_queue.pop_front();
+	auto ch = get_coll(e.cid, nullptr, nullptr);
+	l.unlock();
+	if (ch) {
+	  bufferlist bl;
+	  os->read(ch, e.oid, e.off, e.len, bl);
+	  read_lat.add(start);
+	}
+	l.lock();
+      }
+    });
+  }
+
+  std::mutex lock;
+  std::condition_variable cond;
+  int in_flight = 0;
+  uint64_t txns = 0, reads = 0;
+  double max_lag = 0;
+  FreshStoreFixer fixer;
+
+  const auto start = steady::now();
+  while (!p.end()) {
+    event_t e;
+    decode(e, p);
+    if (speed > 0) {
+      auto due = start + std::chrono::duration_cast<steady::duration>(
+	std::chrono::nanoseconds(uint64_t(e.stamp_ns / speed)));
+      auto now = steady::now();
+      if (now < due) {
+	std::this_thread::sleep_until(due);
+      } else {
+	max_lag = std::max(max_lag,
+			   std::chrono::duration<double>(now - due).count());
+      }
+    }
+
+    if (e.type == event_t::READ) {
+      if (read_threads) {
+	std::lock_guard l{read_lock};
+	read_queue.emplace_back(std::move(e), steady::now());
+	read_cond.notify_one();
+	++reads;
+      }
+      continue;
+    }
+
+    Transaction t = e.restore();
+    Transaction pre;
+    ObjectStore::CollectionHandle ch;
+    {
+      std::lock_guard l{read_lock};
+      ch = get_coll(e.cid, &t, &pre);
+    }
+    if (mkfs) {
+      fixer.fix(t, &pre);
+      if (!pre.empty()) {
+	os->queue_transaction(ch, std::move(pre));
+      }
+    }
+    {
+      std::unique_lock l{lock};
+      cond.wait(l, [&] { return in_flight < queue_depth; });
+      ++in_flight;
+    }
+    auto queued = steady::now();
+    t.register_on_commit(new C_Done([&, queued] {
+      txn_lat.add(queued);
+      std::lock_guard l{lock};
+      --in_flight;
+      cond.notify_all();
+    }));
+    os->queue_transaction(ch, std::move(t));
+    ++txns;
+  }
+
+  {
+    std::unique_lock l{lock};
+    cond.wait(l, [&] { return in_flight == 0; });
+  }
+  {
+    std::lock_guard l{read_lock};
+    reads_done = true;
+    read_cond.notify_all();
+  }
+  for (auto& r : readers) {
+    r.join();
+  }
+  std::chrono::duration<double> elapsed = steady::now() - start;
+
+  cout << "replayed " << txns << " transactions and " << reads
+       << " reads in " << elapsed.count() << "s";
+  if (speed > 0) {
+    cout << ", at most " << max_lag * 1000 << "ms behind the trace";
+  }
+  cout << std::endl;
+  txn_lat.print("transaction commit");
+  read_lat.print("read");
+
+  colls.clear();
+  os->umount();
+  return 0;
+}
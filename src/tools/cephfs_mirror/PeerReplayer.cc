@@ -736,6 +736,165 @@ close_local_fd:
   return r == 0 ? 0 : r;
 }
 
+#define DELTA_BLOCK_SIZE (1024 * 1024) // comparison unit for delta sync
+
+static int read_full(MountRef mnt, int fd, char *buf, uint64_t len, uint64_t off) {
+  uint64_t done = 0;
+  while (done < len) {
+    int r = ceph_read(mnt, fd, buf + done, len - done, off + done);
+    if (r < 0) {
+      return r;
+    }
+    if (r == 0) {
+      break;
+    }
+    done += r;
+  }
+  return done;
+}
+
+int PeerReplayer::copy_delta_to_remote(const std::string &dir_root, const std::string &epath,
+                                       const struct ceph_statx &stx, const FHandles &fh,
+                                       bool *copied, uint64_t *bytes) {
+  dout(10) << ": dir_root=" << dir_root << ", epath=" << epath << dendl;
+  *copied = false;
+  *bytes = 0;
+
+  // the remote file must still be what the last sync left there, i.e. the
+  // file in the previous snapshot -- a sync interrupted half way through a
+  // copy leaves it with a newer mtime.
+  struct ceph_statx pstx;
+  struct ceph_statx rstx;
+  int r = ceph_statxat(fh.p_mnt, fh.p_fd, epath.c_str(), &pstx,
+                       CEPH_STATX_MODE | CEPH_STATX_SIZE | CEPH_STATX_MTIME,
+                       AT_STATX_DONT_SYNC | AT_SYMLINK_NOFOLLOW);
+  if (r < 0 || !S_ISREG(pstx.stx_mode)) {
+    return 0;
+  }
+  r = ceph_statxat(m_remote_mount, fh.r_fd_dir_root, epath.c_str(), &rstx,
+                   CEPH_STATX_MODE | CEPH_STATX_SIZE | CEPH_STATX_MTIME,
+                   AT_STATX_SYNC_AS_STAT | AT_SYMLINK_NOFOLLOW);
+  if (r < 0 || !S_ISREG(rstx.stx_mode) || rstx.stx_size != pstx.stx_size ||
+      rstx.stx_mtime != pstx.stx_mtime) {
+    dout(10) << ": remote file path=" << epath << " does not match previous snapshot,"
+             << " copying in full" << dendl;
+    return 0;
+  }
+
+  int l_fd = ceph_openat(m_local_mount, fh.c_fd, epath.c_str(), O_RDONLY | O_NOFOLLOW, 0);
+  if (l_fd < 0) {
+    derr << ": failed to open local file path=" << epath << ": "
+         << cpp_strerror(l_fd) << dendl;
+    return l_fd;
+  }
+  int p_fd = ceph_openat(fh.p_mnt, fh.p_fd, epath.c_str(), O_RDONLY | O_NOFOLLOW, 0);
+  if (p_fd < 0) {
+    derr << ": failed to open previous file path=" << epath << ": "
+         << cpp_strerror(p_fd) << dendl;
+    ceph_close(m_local_mount, l_fd);
+    return p_fd;
+  }
+  int r_fd = ceph_openat(m_remote_mount, fh.r_fd_dir_root, epath.c_str(),
+                         O_WRONLY | O_NOFOLLOW, 0);
+  if (r_fd < 0) {
+    derr << ": failed to open remote file path=" << epath << ": "
+         << cpp_strerror(r_fd) << dendl;
+    ceph_close(fh.p_mnt, p_fd);
+    ceph_close(m_local_mount, l_fd);
+    return r_fd;
+  }
+
+  std::vector<char> cbuf(IOVEC_SIZE);
+  std::vector<char> pbuf(IOVEC_SIZE);
+  // write out [start, end) of the current chunk at off
+  auto write_run = [&](uint64_t off, uint64_t start, uint64_t end) {
+    int r = ceph_write(m_remote_mount, r_fd, cbuf.data() + start, end - start, off + start);
+    if (r < 0) {
+      derr << ": failed to write remote file path=" << epath << ": "
+           << cpp_strerror(r) << dendl;
+      return r;
+    }
+    *bytes += end - start;
+    return 0;
+  };
+
+  r = 0;
+  for (uint64_t off = 0; off < stx.stx_size; off += IOVEC_SIZE) {
+    if (should_backoff(dir_root, &r)) {
+      dout(0) << ": backing off r=" << r << dendl;
+      break;
+    }
+
+    uint64_t len = std::min<uint64_t>(IOVEC_SIZE, stx.stx_size - off);
+    r = read_full(m_local_mount, l_fd, cbuf.data(), len, off);
+    if (r >= 0 && (uint64_t)r != len) {
+      r = -EIO;
+    }
+    if (r < 0) {
+      derr << ": failed to read local file path=" << epath << ": "
+           << cpp_strerror(r) << dendl;
+      break;
+    }
+    uint64_t plen = 0;
+    if (off < pstx.stx_size) {
+      r = read_full(fh.p_mnt, p_fd, pbuf.data(),
+                    std::min<uint64_t>(len, pstx.stx_size - off), off);
+      if (r < 0) {
+        derr << ": failed to read previous file path=" << epath << ": "
+             << cpp_strerror(r) << dendl;
+        break;
+      }
+      plen = r;
+    }
+
+    // coalesce adjacent changed blocks into a single write
+    std::optional<uint64_t> run;
+    r = 0;
+    for (uint64_t b = 0; b < len && r == 0; b += DELTA_BLOCK_SIZE) {
+      uint64_t blen = std::min<uint64_t>(DELTA_BLOCK_SIZE, len - b);
+      bool same = b + blen <= plen &&
+                  memcmp(cbuf.data() + b, pbuf.data() + b, blen) == 0;
+      if (!same && !run) {
+        run = b;
+      } else if (same && run) {
+        r = write_run(off, *run, b);
+        run.reset();
+      }
+    }
+    if (r == 0 && run) {
+      r = write_run(off, *run, len);
+    }
+    if (r < 0) {
+      break;
+    }
+  }
+
+  if (r == 0 && stx.stx_size < pstx.stx_size) {
+    r = ceph_ftruncate(m_remote_mount, r_fd, stx.stx_size);
+    if (r < 0) {
+      derr << ": failed to truncate remote file path=" << epath << ": "
+           << cpp_strerror(r) << dendl;
+    }
+  }
+  if (r == 0) {
+    r = ceph_fsync(m_remote_mount, r_fd, 0);
+    if (r < 0) {
+      derr << ": failed to sync data for file path=" << epath << ": "
+           << cpp_strerror(r) << dendl;
+    }
+  }
+
+  ceph_close(m_remote_mount, r_fd);
+  ceph_close(fh.p_mnt, p_fd);
+  ceph_close(m_local_mount, l_fd);
+  if (r == 0) {
+    dout(10) << ": path=" << epath << " transferred " << *bytes << " of "
+             << stx.stx_size << " bytes" << dendl;
+    *copied = true;
+  }
+  return r;
+}
+
 int PeerReplayer::remote_file_op(const std::string &dir_root, const std::string &epath,
                                  const struct ceph_statx &stx, const FHandles &fh,
                                  bool need_data_sync, bool need_attr_sync) {
@@ -745,13 +904,28 @@ int PeerReplayer::remote_file_op(const std::string &dir_root, const std::string
   int r;
   if (need_data_sync) {
     if (S_ISREG(stx.stx_mode)) {
-      r = copy_to_remote(dir_root, epath, stx, fh);
-      if (r < 0) {
-        derr << ": failed to copy path=" << epath << ": " << cpp_strerror(r) << dendl;
-        return r;
+      bool copied = false;
+      uint64_t bytes = stx.stx_size;
+      auto delta_min = g_ceph_context->_conf.get_val<Option::size_t>(
+        "cephfs_mirror_delta_sync_min_size");
+      if (fh.p_mnt == m_local_mount && delta_min && stx.stx_size >= delta_min) {
+        r = copy_delta_to_remote(dir_root, epath, stx, fh, &copied, &bytes);
+        if (r < 0) {
+          derr << ": failed to copy changed blocks of path=" << epath << ": "
+               << cpp_strerror(r) << dendl;
+          return r;
+        }
+      }
+      if (!copied) {
+        bytes = stx.stx_size;
+        r = copy_to_remote(dir_root, epath, stx, fh);
+        if (r < 0) {
+          derr << ": failed to copy path=" << epath << ": " << cpp_strerror(r) << dendl;
+          return r;
+        }
       }
       if (m_perf_counters) {
-	m_perf_counters->inc(l_cephfs_mirror_peer_replayer_sync_bytes, stx.stx_size);
+	m_perf_counters->inc(l_cephfs_mirror_peer_replayer_sync_bytes, bytes);
       }
     } else if (S_ISLNK(stx.stx_mode)) {
       // free the remote link before relinking
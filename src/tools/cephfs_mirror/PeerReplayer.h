@@ -312,6 +312,11 @@ private:
                      const FHandles &fh, bool need_data_sync, bool need_attr_sync);
   int copy_to_remote(const std::string &dir_root, const std::string &epath, const struct ceph_statx &stx,
                      const FHandles &fh);
+  // write only the blocks of a file that changed since the previous (local)
+  // snapshot; *copied is left false if the file has to be copied in full
+  int copy_delta_to_remote(const std::string &dir_root, const std::string &epath,
+                           const struct ceph_statx &stx, const FHandles &fh,
+                           bool *copied, uint64_t *bytes);
   int sync_perms(const std::string& path);
 };
 
@@ -30,6 +30,8 @@
 
 #include "common/ceph_argparse.h"
 #include "include/stringify.h"
+#include "include/str_list.h"
+#include "common/strtol.h"
 #include "global/global_context.h"
 #include "global/global_init.h"
 #include "osd/OSDMap.h"
@@ -220,6 +222,10 @@ void usage()
   cout << "      [--simulate]       simulate placements using a random\n";
   cout << "                         number generator in place of the CRUSH\n";
   cout << "                         algorithm\n";
+  cout << "   -i mapfn --bench      time the mappings --test would compute,\n";
+  cout << "                         with the --test parameters\n";
+  cout << "      [--bench-threads n[,n...]]\n";
+  cout << "                         with each of these numbers of threads\n";
   cout << "   --show-utilization    show OSD usage\n";
   cout << "   --show-utilization-all\n";
   cout << "                         include zero weight items\n";
@@ -396,6 +402,8 @@ int main(int argc, const char **argv)
   bool check = false;
   int max_id = -1;
   bool test = false;
+  bool bench = false;
+  std::vector<int> bench_threads = {1};
   bool display = false;
   bool tree = false;
   bool bucket_tree = false;
@@ -545,6 +553,19 @@ int main(int argc, const char **argv)
       check = true;
     } else if (ceph_argparse_flag(args, i, "-t", "--test", (char*)NULL)) {
       test = true;
+    } else if (ceph_argparse_flag(args, i, "--bench", (char*)NULL)) {
+      bench = true;
+    } else if (ceph_argparse_witharg(args, i, &val, "--bench-threads", (char*)NULL)) {
+      bench_threads.clear();
+      for (auto& n : get_str_vec(val, ",")) {
+	std::string e;
+	int t = strict_strtol(n.c_str(), 10, &e);
+	if (!e.empty() || t < 1) {
+	  cerr << "bad --bench-threads " << val << std::endl;
+	  return EXIT_FAILURE;
+	}
+	bench_threads.push_back(t);
+      }
     } else if (ceph_argparse_witharg(args, i, &full_location, err, "--show-location", (char*)NULL)) {
     } else if (ceph_argparse_flag(args, i, "-s", "--simulate", (char*)NULL)) {
       tester.set_random_placement();
@@ -851,7 +872,7 @@ int main(int argc, const char **argv)
     cerr << "cannot specify more than one of compile, decompile, and build" << std::endl;
     return EXIT_FAILURE;
   }
-  if (!check && !compile && !decompile && !build && !test && !reweight && !adjust && !tree && !dump &&
+  if (!check && !compile && !decompile && !build && !test && !bench && !reweight && !adjust && !tree && !dump &&
       add_item < 0 && !add_bucket && !move_item && !add_rule && !del_rule && full_location < 0 &&
       !bucket_tree &&
       !reclassify && !rebuild_class_roots &&
@@ -1294,6 +1315,12 @@ int main(int argc, const char **argv)
       return EXIT_FAILURE;
   }
 
+  if (bench) {
+    int r = tester.bench(cct->get(), bench_threads);
+    if (r < 0)
+      return EXIT_FAILURE;
+  }
+
   if (compare.size()) {
     CrushWrapper crush2;
     bufferlist in;
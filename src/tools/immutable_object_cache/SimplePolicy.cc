@@ -60,23 +60,54 @@ cache_status_t SimplePolicy::alloc_entry(std::string file_name) {
   return OBJ_CACHE_SKIP;
 }
 
+void SimplePolicy::hit_entry(Entry* entry) {
+  ceph_assert(ceph_mutex_is_wlocked(m_cache_map_lock));
+  if (entry->is_protected) {
+    m_protected_lru.lru_touch(entry);
+    return;
+  }
+
+  // second hit: protect it, demoting the coldest protected entries
+  m_probation_lru.lru_remove(entry);
+  m_protected_lru.lru_insert_top(entry);
+  entry->is_protected = true;
+  m_protected_size += entry->size;
+  while (m_protected_size > m_max_cache_size * PROTECTED_RATIO) {
+    Entry* cold = static_cast<Entry*>(m_protected_lru.lru_expire());
+    if (cold == nullptr) {
+      break;
+    }
+    cold->is_protected = false;
+    m_protected_size -= cold->size;
+    m_probation_lru.lru_insert_top(cold);
+  }
+}
+
+SimplePolicy::Entry* SimplePolicy::get_next_evict_entry() {
+  auto entry = m_probation_lru.lru_get_next_expire();
+  if (entry == nullptr) {
+    entry = m_protected_lru.lru_get_next_expire();
+  }
+  return static_cast<Entry*>(entry);
+}
+
 cache_status_t SimplePolicy::lookup_object(std::string file_name) {
   ldout(cct, 20) << "lookup: " << file_name << dendl;
 
-  std::shared_lock rlocker{m_cache_map_lock};
+  // exclusive: a hit moves the entry within the lru
+  std::unique_lock locker{m_cache_map_lock};
 
   auto entry_it = m_cache_map.find(file_name);
   // simply promote on first lookup
   if (entry_it == m_cache_map.end()) {
-      rlocker.unlock();
+      locker.unlock();
       return alloc_entry(file_name);
   }
 
   Entry* entry = entry_it->second;
 
   if (entry->status == OBJ_CACHE_PROMOTED || entry->status == OBJ_CACHE_DNE) {
-    // bump pos in lru on hit
-    m_promoted_lru.lru_touch(entry);
+    hit_entry(entry);
   }
 
   return entry->status;
@@ -108,7 +139,7 @@ void SimplePolicy::update_status(std::string file_name,
   // promoting done
   if (entry->status == OBJ_CACHE_SKIP && (new_status== OBJ_CACHE_PROMOTED ||
                                           new_status== OBJ_CACHE_DNE)) {
-    m_promoted_lru.lru_insert_top(entry);
+    m_probation_lru.lru_insert_top(entry);
     entry->status = new_status;
     entry->size = size;
     m_cache_size += entry->size;
@@ -137,7 +168,12 @@ void SimplePolicy::update_status(std::string file_name,
     entry->size = 0;
     entry->status = new_status;
 
-    m_promoted_lru.lru_remove(entry);
+    if (entry->is_protected) {
+      m_protected_lru.lru_remove(entry);
+      m_protected_size -= size;
+    } else {
+      m_probation_lru.lru_remove(entry);
+    }
     m_cache_map.erase(entry_it);
     m_cache_size -= size;
     delete entry;
@@ -174,9 +210,15 @@ void SimplePolicy::get_evict_list(std::list<std::string>* obj_list) {
     // TODO(dehao): make this configurable
     int evict_num = m_cache_map.size() * 0.1;
     for (int i = 0; i < evict_num; i++) {
-      Entry* entry = reinterpret_cast<Entry*>(m_promoted_lru.lru_expire());
+      Entry* entry = get_next_evict_entry();
       if (entry == nullptr) {
-        continue;
+        break;
+      }
+      // it stays accounted in its segment until it is evicted
+      if (entry->is_protected) {
+        m_protected_lru.lru_remove(entry);
+      } else {
+        m_probation_lru.lru_remove(entry);
       }
       std::string file_name = entry->file_name;
       obj_list->push_back(file_name);
@@ -201,11 +243,13 @@ uint64_t SimplePolicy::get_promoting_entry_num() {
 }
 
 uint64_t SimplePolicy::get_promoted_entry_num() {
-  return m_promoted_lru.lru_get_size();
+  std::shared_lock rlocker{m_cache_map_lock};
+  return m_probation_lru.lru_get_size() + m_protected_lru.lru_get_size();
 }
 
 std::string SimplePolicy::get_evict_entry() {
-  Entry* entry = reinterpret_cast<Entry*>(m_promoted_lru.lru_get_next_expire());
+  std::unique_lock locker{m_cache_map_lock};
+  Entry* entry = get_next_evict_entry();
   if (entry == nullptr) {
     return "";
   }
@@ -15,6 +15,15 @@
 namespace ceph {
 namespace immutable_obj_cache {
 
+/*
+ * Promoted objects are kept in a segmented LRU.  They start out in the
+ * probation segment and move to the protected one when they are looked
+ * up again.  Eviction drains probation first, so a one-off scan over many
+ * objects (e.g. a single clone being read through) cannot push out the
+ * objects that many clones keep reading (e.g. the boot blocks of a
+ * golden image).  The protected segment holds at most PROTECTED_RATIO of
+ * the cache; its coldest entries are demoted back to probation.
+ */
 class SimplePolicy : public Policy {
  public:
   SimplePolicy(CephContext *cct, uint64_t block_num, uint64_t max_inflight,
@@ -38,6 +47,8 @@ class SimplePolicy : public Policy {
   std::string get_evict_entry();
 
  private:
+  static constexpr double PROTECTED_RATIO = 0.8;
+
   cache_status_t alloc_entry(std::string file_name);
 
   class Entry : public LRUObject {
@@ -46,8 +57,12 @@ class SimplePolicy : public Policy {
     Entry() : status(OBJ_CACHE_NONE) {}
     std::string file_name;
     uint64_t size;
+    bool is_protected = false;
   };
 
+  void hit_entry(Entry* entry);
+  Entry* get_next_evict_entry();
+
   CephContext* cct;
   double m_watermark;
   uint64_t m_max_inflight_ops;
@@ -59,8 +74,10 @@ class SimplePolicy : public Policy {
     ceph::make_shared_mutex("rbd::cache::SimplePolicy::m_cache_map_lock");
 
   std::atomic<uint64_t> m_cache_size;
+  uint64_t m_protected_size = 0;
 
-  LRU m_promoted_lru;
+  LRU m_probation_lru;
+  LRU m_protected_lru;
 };
 
 }  // namespace immutable_obj_cache
@@ -18,10 +18,13 @@
 #include "common/ceph_argparse.h"
 #include "common/errno.h"
 #include "common/safe_io.h"
+#include "common/strtol.h"
+#include "include/str_list.h"
 #include "include/random.h"
 #include "mon/health_check.h"
 #include <time.h>
 #include <algorithm>
+#include <thread>
 
 #include "global/global_init.h"
 #include "osd/OSDMap.h"
@@ -42,6 +45,7 @@ void usage()
   cout << "   --test-map-pgs [--pool <poolid>] [--pg_num <pg_num>] [--range-first <first> --range-last <last>] map all pgs" << std::endl;
   cout << "   --test-map-pgs-dump [--pool <poolid>] [--range-first <first> --range-last <last>] map all pgs" << std::endl;
   cout << "   --test-map-pgs-dump-all [--pool <poolid>] [--range-first <first> --range-last <last>] map all pgs to osds" << std::endl;
+  cout << "   --bench-map-pgs [--pool <poolid>] [--bench-threads <n>[,<n>...]] time the mapping of all pgs to up and acting osds" << std::endl;
   cout << "   --mark-up-in            mark osds up and in (but do not persist)" << std::endl;
   cout << "   --mark-out <osdid>      mark an osd as out (but do not persist)" << std::endl;
   cout << "   --mark-up <osdid>       mark an osd as up (but do not persist)" << std::endl;
@@ -164,6 +168,8 @@ int main(int argc, const char **argv)
   bool clean_temps = false;
   bool test_map_pgs = false;
   bool test_map_pgs_dump = false;
+  bool bench_map_pgs = false;
+  std::vector<int> bench_threads = {1};
   bool test_random = false;
   bool upmap_cleanup = false;
   bool upmap = false;
@@ -250,6 +256,19 @@ int main(int argc, const char **argv)
       test_map_pgs_dump = true;
     } else if (ceph_argparse_flag(args, i, "--test-map-pgs-dump-all", (char*)NULL)) {
       test_map_pgs_dump_all = true;
+    } else if (ceph_argparse_flag(args, i, "--bench-map-pgs", (char*)NULL)) {
+      bench_map_pgs = true;
+    } else if (ceph_argparse_witharg(args, i, &val, "--bench-threads", (char*)NULL)) {
+      bench_threads.clear();
+      for (auto& n : get_str_vec(val, ",")) {
+	std::string e;
+	int t = strict_strtol(n.c_str(), 10, &e);
+	if (!e.empty() || t < 1) {
+	  cerr << "bad --bench-threads " << val << std::endl;
+	  exit(EXIT_FAILURE);
+	}
+	bench_threads.push_back(t);
+      }
     } else if (ceph_argparse_flag(args, i, "--test-random", (char*)NULL)) {
       test_random = true;
     } else if (ceph_argparse_flag(args, i, "--clobber", (char*)NULL)) {
@@ -777,6 +796,25 @@ skip_upmap:
       
       cout << "pool " << p->first
 	   << " pg_num " << p->second.get_pg_num() << std::endl;
+      // map the whole pool in one go
+      vector<vector<int>> pool_up, pool_acting;
+      vector<int> pool_up_primary, pool_acting_primary;
+      if (!test_random) {
+	unsigned pgs = p->second.get_pg_num();
+	pool_up.resize(pgs);
+	pool_acting.resize(pgs);
+	pool_up_primary.resize(pgs);
+	pool_acting_primary.resize(pgs);
+	osdmap.pg_range_to_up_acting_osds(
+	  p->first, 0, pgs,
+	  [&](pg_t pgid, vector<int>&& up, int up_primary,
+	      vector<int>&& acting, int acting_primary) {
+	    pool_up[pgid.ps()] = std::move(up);
+	    pool_up_primary[pgid.ps()] = up_primary;
+	    pool_acting[pgid.ps()] = std::move(acting);
+	    pool_acting_primary[pgid.ps()] = acting_primary;
+	  });
+      }
       for (unsigned i = 0; i < p->second.get_pg_num(); ++i) {
 	pg_t pgid = pg_t(i, p->first);
 
@@ -790,12 +828,15 @@ skip_upmap:
 	  primary = osds[0];
 	} else if (test_map_pgs_dump_all) {
           osdmap.pg_to_raw_osds(pgid, &raw, &calced_primary);
-          osdmap.pg_to_up_acting_osds(pgid, &up, &up_primary,
-                                      &acting, &acting_primary);
+	  up.swap(pool_up[i]);
+	  up_primary = pool_up_primary[i];
+	  acting.swap(pool_acting[i]);
+	  acting_primary = pool_acting_primary[i];
 	  osds = acting;
 	  primary = acting_primary;
         } else {
-	  osdmap.pg_to_acting_osds(pgid, &osds, &primary);
+	  osds.swap(pool_acting[i]);
+	  primary = pool_acting_primary[i];
 	}
 	size[osds.size()]++;
 	if ((unsigned)max_size < osds.size())
@@ -882,6 +923,71 @@ skip_upmap:
         cout << "size " << i << "\t" << size[i] << std::endl;
     }
   }
+  if (bench_map_pgs) {
+    if (pool != -1 && !osdmap.have_pg_pool(pool)) {
+      cerr << "There is no pool " << pool << std::endl;
+      exit(1);
+    }
+    // every pg of the pools, mapped as the OSDs and clients would, with
+    // weight-sets, upmaps and temps applied
+    vector<pg_t> pgs;
+    unsigned upmapped = 0;
+    for (auto& [id, p] : osdmap.get_pools()) {
+      if (pool != -1 && id != pool)
+	continue;
+      for (ps_t ps = 0; ps < p.get_pg_num(); ps++) {
+	pgs.push_back(pg_t(ps, id));
+	upmapped += osdmap.have_pg_upmaps(pgs.back());
+      }
+    }
+    if (pgs.empty()) {
+      cerr << "no pgs to map" << std::endl;
+      exit(1);
+    }
+    cout << "pgs " << pgs.size() << " upmapped " << upmapped << std::endl;
+    cout << "threads\tmappings/s\tper thread\tp50 ns\tp99 ns\tp99.9 ns"
+	 << "\tmax ns" << std::endl;
+    for (int nthreads : bench_threads) {
+      vector<vector<uint32_t>> lat(nthreads);
+      vector<std::thread> workers;
+      auto start = ceph::mono_clock::now();
+      for (int t = 0; t < nthreads; ++t) {
+	workers.emplace_back([&, t] {
+	  auto& l = lat[t];
+	  l.reserve(pgs.size() / nthreads + 1);
+	  vector<int> up, acting;
+	  int up_primary, acting_primary;
+	  for (size_t i = t; i < pgs.size(); i += nthreads) {
+	    auto s = ceph::mono_clock::now();
+	    osdmap.pg_to_up_acting_osds(pgs[i], &up, &up_primary,
+					&acting, &acting_primary);
+	    l.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			  ceph::mono_clock::now() - s).count());
+	  }
+	});
+      }
+      for (auto& w : workers) {
+	w.join();
+      }
+      double elapsed = std::chrono::duration<double>(
+	ceph::mono_clock::now() - start).count();
+
+      vector<uint32_t> all;
+      all.reserve(pgs.size());
+      for (auto& l : lat) {
+	all.insert(all.end(), l.begin(), l.end());
+      }
+      std::sort(all.begin(), all.end());
+      auto at = [&all](double q) {
+	return all[std::min<size_t>(q * all.size(), all.size() - 1)];
+      };
+      double rate = elapsed > 0 ? pgs.size() / elapsed : 0;
+      cout << nthreads << "\t" << (uint64_t)rate << "\t"
+	   << (uint64_t)(rate / nthreads) << "\t" << at(0.5) << "\t"
+	   << at(0.99) << "\t" << at(0.999) << "\t" << all.back()
+	   << std::endl;
+    }
+  }
   if (test_crush) {
     int pass = 0;
     while (1) {
@@ -917,6 +1023,7 @@ skip_upmap:
       export_crush.empty() && import_crush.empty() && 
       test_map_pg.empty() && test_map_object.empty() &&
       !test_map_pgs && !test_map_pgs_dump && !test_map_pgs_dump_all &&
+      !bench_map_pgs &&
       adjust_crush_weight.empty() && !upmap && !upmap_cleanup && !read) {
     cerr << me << ": no action specified?" << std::endl;
     usage();
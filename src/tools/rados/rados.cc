@@ -242,6 +242,11 @@ void usage(ostream& out)
 "        prefix output with date/time\n"
 "   --no-verify\n"
 "        do not verify contents of read objects\n"
+"   --target-ops=N\n"
+"        start N ops per second regardless of how many complete (open\n"
+"        loop), and measure latency from when each op was due\n"
+"   --poisson\n"
+"        with --target-ops, space ops out randomly (exponentially)\n"
 "   --write-object\n"
 "        write contents to the objects\n"
 "   --write-omap\n"
@@ -1886,6 +1891,8 @@ static int rados_tool_common(const std::map < std::string, std::string > &opts,
   bool hints = true; // for rados bench
   bool reuse_bench = false;
   bool no_verify = false;
+  double target_ops = 0;
+  bool poisson = false;
   bool use_striper = false;
   bool with_clones = false;
   const char *snapname = NULL;
@@ -2098,6 +2105,19 @@ static int rados_tool_common(const std::map < std::string, std::string > &opts,
   if (i != opts.end()) {
     no_verify = true;
   }
+  i = opts.find("target-ops");
+  if (i != opts.end()) {
+    std::string err;
+    target_ops = strict_strtod(i->second.c_str(), &err);
+    if (!err.empty() || target_ops < 0) {
+      cerr << "invalid --target-ops " << i->second << std::endl;
+      return -EINVAL;
+    }
+  }
+  i = opts.find("poisson");
+  if (i != opts.end()) {
+    poisson = true;
+  }
   i = opts.find("output");
   if (i != opts.end()) {
     output = i->second.c_str();
@@ -3314,6 +3334,7 @@ static int rados_tool_common(const std::map < std::string, std::string > &opts,
     }
     RadosBencher bencher(g_ceph_context, rados, io_ctx);
     bencher.set_show_time(show_time);
+    bencher.set_target_ops(target_ops, poisson);
     bencher.set_write_destination(static_cast<OpWriteDest>(bench_write_dest));
 
     ostream *outstream = NULL;
@@ -4123,6 +4144,10 @@ int main(int argc, const char **argv)
       opts["reuse-bench"] = "true";
     } else if (ceph_argparse_flag(args, i, "--no-verify", (char*)NULL)) {
       opts["no-verify"] = "true";
+    } else if (ceph_argparse_witharg(args, i, &val, "--target-ops", (char*)NULL)) {
+      opts["target-ops"] = val;
+    } else if (ceph_argparse_flag(args, i, "--poisson", (char*)NULL)) {
+      opts["poisson"] = "true";
     } else if (ceph_argparse_witharg(args, i, &val, "--run-name", (char*)NULL)) {
       opts["run-name"] = val;
     } else if (ceph_argparse_witharg(args, i, &val, "--prefix", (char*)NULL)) {
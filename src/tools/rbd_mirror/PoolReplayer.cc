@@ -562,6 +562,16 @@ int PoolReplayer<I>::init_rados(const std::string &cluster_name,
     }
   }
 
+  if (strip_cluster_overrides) {
+    auto compress_mode = g_ceph_context->_conf.get_val<std::string>(
+      "rbd_mirror_remote_compress_mode");
+    if (compress_mode != "none") {
+      dout(10) << "enabling " << compress_mode << " compression for "
+               << description << dendl;
+      cct->_conf.set_val_or_die("ms_osd_compress_mode", compress_mode);
+    }
+  }
+
   // disable unnecessary librbd cache
   cct->_conf.set_val_or_die("rbd_cache", "false");
   cct->_conf.apply_changes(nullptr);
@@ -46,6 +46,7 @@
 
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <regex>
@@ -100,6 +101,7 @@ struct Config {
   int max_part = 255;
   int io_timeout = -1;
   int reattach_timeout = 30;
+  int num_connections = 1;
 
   bool exclusive = false;
   bool notrim = false;
@@ -156,6 +158,9 @@ static void usage()
             << "  --encryption-passphrase-file  Path of file containing passphrase for unlocking image encryption\n"
             << "  --exclusive                   Forbid writes by other clients\n"
             << "  --notrim                      Turn off trim/discard\n"
+            << "  --num-connections <num>       Number of connections (and I/O threads)\n"
+            << "                                to serve the device over (default: 1,\n"
+            << "                                requires the netlink interface if > 1)\n"
             << "  --io-timeout <sec>            Set nbd IO timeout\n"
             << "  --max_part <limit>            Override for module param max_part\n"
             << "  --nbds_max <limit>            Override for module param nbds_max\n"
@@ -207,19 +212,19 @@ public:
   uint64_t quiesce_watch_handle = 0;
 
 private:
-  int fd;
   librbd::Image &image;
   Config *cfg;
 
 public:
-  NBDServer(int fd, librbd::Image& image, Config *cfg)
-    : fd(fd)
-    , image(image)
+  NBDServer(const std::vector<int>& fds, librbd::Image& image, Config *cfg)
+    : image(image)
     , cfg(cfg)
-    , reader_thread(*this, &NBDServer::reader_entry)
-    , writer_thread(*this, &NBDServer::writer_entry)
-    , quiesce_thread(*this, &NBDServer::quiesce_entry)
+    , quiesce_thread([this] { quiesce_entry(); })
   {
+    for (auto fd : fds) {
+      connections.emplace_back(new Connection(this, fd));
+    }
+
     std::vector<librbd::config_option_t> options;
     image.config_list(&options);
     for (auto &option : options) {
@@ -244,10 +249,12 @@ private:
   std::atomic<bool> terminated = { false };
   std::atomic<bool> allow_internal_flush = { false };
 
+  struct Connection;
+
   struct IOContext
   {
     xlist<IOContext*>::item item;
-    NBDServer *server = nullptr;
+    Connection *conn = nullptr;
     struct nbd_request request;
     struct nbd_reply reply;
     bufferlist data;
@@ -260,63 +267,104 @@ private:
 
   friend std::ostream &operator<<(std::ostream &os, const IOContext &ctx);
 
-  ceph::mutex lock = ceph::make_mutex("NBDServer::Locker");
-  ceph::condition_variable cond;
-  xlist<IOContext*> io_pending;
-  xlist<IOContext*> io_finished;
-
-  void io_start(IOContext *ctx)
-  {
-    std::lock_guard l{lock};
-    io_pending.push_back(&ctx->item);
-  }
-
-  void io_finish(IOContext *ctx)
+  class ThreadHelper : public Thread
   {
-    std::lock_guard l{lock};
-    ceph_assert(ctx->item.is_on_list());
-    ctx->item.remove_myself();
-    io_finished.push_back(&ctx->item);
-    cond.notify_all();
-  }
+  private:
+    std::function<void()> func;
+  public:
+    explicit ThreadHelper(std::function<void()>&& _func)
+      : func(std::move(_func))
+    {}
+  protected:
+    void* entry() override
+    {
+      func();
+      return NULL;
+    }
+  };
 
-  IOContext *wait_io_finish()
+  // each nbd connection (socket) is served by its own reader and writer
+  // threads, so the kernel can spread the requests of a multi-queue
+  // device over them
+  struct Connection
   {
-    std::unique_lock l{lock};
-    cond.wait(l, [this] {
-                   return !io_finished.empty() ||
-                          (io_pending.empty() && terminated);
-                 });
+    NBDServer *server;
+    int fd;
+
+    ceph::mutex lock = ceph::make_mutex("NBDServer::Connection::Locker");
+    ceph::condition_variable cond;
+    xlist<IOContext*> io_pending;
+    xlist<IOContext*> io_finished;
+    bool terminated = false;
+
+    ThreadHelper reader_thread;
+    ThreadHelper writer_thread;
+
+    Connection(NBDServer *server, int fd)
+      : server(server)
+      , fd(fd)
+      , reader_thread([this] { this->server->reader_entry(*this); })
+      , writer_thread([this] { this->server->writer_entry(*this); })
+    {}
 
-    if (io_finished.empty())
-      return NULL;
+    void io_start(IOContext *ctx)
+    {
+      std::lock_guard l{lock};
+      io_pending.push_back(&ctx->item);
+    }
 
-    IOContext *ret = io_finished.front();
-    io_finished.pop_front();
+    void io_finish(IOContext *ctx)
+    {
+      std::lock_guard l{lock};
+      ceph_assert(ctx->item.is_on_list());
+      ctx->item.remove_myself();
+      io_finished.push_back(&ctx->item);
+      cond.notify_all();
+    }
 
-    return ret;
-  }
+    IOContext *wait_io_finish()
+    {
+      std::unique_lock l{lock};
+      cond.wait(l, [this] {
+                     return !io_finished.empty() ||
+                            (io_pending.empty() && terminated);
+                   });
 
-  void wait_clean()
-  {
-    std::unique_lock l{lock};
-    cond.wait(l, [this] { return io_pending.empty(); });
+      if (io_finished.empty())
+        return NULL;
 
-    while(!io_finished.empty()) {
-      std::unique_ptr<IOContext> free_ctx(io_finished.front());
+      IOContext *ret = io_finished.front();
       io_finished.pop_front();
+
+      return ret;
     }
-  }
 
-  void assert_clean()
-  {
-    std::unique_lock l{lock};
+    void wait_clean()
+    {
+      std::unique_lock l{lock};
+      cond.wait(l, [this] { return io_pending.empty(); });
 
-    ceph_assert(!reader_thread.is_started());
-    ceph_assert(!writer_thread.is_started());
-    ceph_assert(io_pending.empty());
-    ceph_assert(io_finished.empty());
-  }
+      while(!io_finished.empty()) {
+        std::unique_ptr<IOContext> free_ctx(io_finished.front());
+        io_finished.pop_front();
+      }
+    }
+
+    void assert_clean()
+    {
+      std::unique_lock l{lock};
+
+      ceph_assert(!reader_thread.is_started());
+      ceph_assert(!writer_thread.is_started());
+      ceph_assert(io_pending.empty());
+      ceph_assert(io_finished.empty());
+    }
+  };
+
+  std::vector<std::unique_ptr<Connection>> connections;
+
+  ceph::mutex lock = ceph::make_mutex("NBDServer::Locker");
+  ceph::condition_variable cond;
 
   static void aio_callback(librbd::completion_t cb, void *arg)
   {
@@ -348,13 +396,14 @@ private:
     } else {
       ctx->reply.error = native_to_big<uint32_t>(0);
     }
-    ctx->server->io_finish(ctx);
+    ctx->conn->io_finish(ctx);
 
     aio_completion->release();
   }
 
-  void reader_entry()
+  void reader_entry(Connection &conn)
   {
+    int fd = conn.fd;
     struct pollfd poll_fds[2];
     memset(poll_fds, 0, sizeof(struct pollfd) * 2);
     poll_fds[0].fd = fd;
@@ -364,7 +413,7 @@ private:
 
     while (true) {
       std::unique_ptr<IOContext> ctx(new IOContext());
-      ctx->server = this;
+      ctx->conn = &conn;
 
       dout(20) << __func__ << ": waiting for nbd request" << dendl;
 
@@ -430,7 +479,7 @@ private:
       }
 
       IOContext *pctx = ctx.release();
-      io_start(pctx);
+      conn.io_start(pctx);
       librbd::RBD::AioCompletion *c = new librbd::RBD::AioCompletion(pctx, aio_callback);
       switch (pctx->command)
       {
@@ -461,9 +510,16 @@ error:
       }
     }
 signal:
-    std::lock_guard l{lock};
-    terminated = true;
-    cond.notify_all();
+    {
+      std::lock_guard l{conn.lock};
+      conn.terminated = true;
+      conn.cond.notify_all();
+    }
+    {
+      std::lock_guard l{lock};
+      terminated = true;
+      cond.notify_all();
+    }
 
     std::lock_guard disconnect_l{disconnect_lock};
     disconnect_cond.notify_all();
@@ -471,11 +527,12 @@ signal:
     dout(20) << __func__ << ": terminated" << dendl;
   }
 
-  void writer_entry()
+  void writer_entry(Connection &conn)
   {
+    int fd = conn.fd;
     while (true) {
       dout(20) << __func__ << ": waiting for io request" << dendl;
-      std::unique_ptr<IOContext> ctx(wait_io_finish());
+      std::unique_ptr<IOContext> ctx(conn.wait_io_finish());
       if (!ctx) {
 	dout(20) << __func__ << ": no io requests, terminating" << dendl;
         goto done;
@@ -500,7 +557,7 @@ signal:
       dout(20) << *ctx << ": finish" << dendl;
     }
   error:
-    wait_clean();
+    conn.wait_clean();
   done:
     ::shutdown(fd, SHUT_RDWR);
 
@@ -582,25 +639,7 @@ signal:
     dout(20) << __func__ << ": terminated" << dendl;
   }
 
-  class ThreadHelper : public Thread
-  {
-  public:
-    typedef void (NBDServer::*entry_func)();
-  private:
-    NBDServer &server;
-    entry_func func;
-  public:
-    ThreadHelper(NBDServer &_server, entry_func _func)
-      :server(_server)
-      ,func(_func)
-    {}
-  protected:
-    void* entry() override
-    {
-      (server.*func)();
-      return NULL;
-    }
-  } reader_thread, writer_thread, quiesce_thread;
+  ThreadHelper quiesce_thread;
 
   bool started = false;
   bool quiesce = false;
@@ -619,8 +658,10 @@ public:
                                         EVENT_SOCKET_TYPE_EVENTFD);
       ceph_assert(r >= 0);
 
-      reader_thread.create("rbd_reader");
-      writer_thread.create("rbd_writer");
+      for (auto& conn : connections) {
+        conn->reader_thread.create("rbd_reader");
+        conn->writer_thread.create("rbd_writer");
+      }
       if (cfg->quiesce) {
         quiesce_thread.create("rbd_quiesce");
       }
@@ -633,7 +674,7 @@ public:
       return;
 
     std::unique_lock l{disconnect_lock};
-    disconnect_cond.wait(l);
+    disconnect_cond.wait(l, [this] { return terminated.load(); });
   }
 
   void notify_quiesce() {
@@ -665,13 +706,17 @@ public:
 
       terminate_event_sock.notify();
 
-      reader_thread.join();
-      writer_thread.join();
+      for (auto& conn : connections) {
+        conn->reader_thread.join();
+        conn->writer_thread.join();
+      }
       if (cfg->quiesce) {
         quiesce_thread.join();
       }
 
-      assert_clean();
+      for (auto& conn : connections) {
+        conn->assert_clean();
+      }
 
       close(terminate_event_fd);
       started = false;
@@ -1399,8 +1444,9 @@ static int netlink_connect_cb(struct nl_msg *msg, void *arg)
   return NL_OK;
 }
 
-static int netlink_connect(Config *cfg, struct nl_sock *sock, int nl_id, int fd,
-                           uint64_t size, uint64_t flags, bool reconnect)
+static int netlink_connect(Config *cfg, struct nl_sock *sock, int nl_id,
+                           const std::vector<int>& fds, uint64_t size,
+                           uint64_t flags, bool reconnect)
 {
   struct nlattr *sock_attr;
   struct nlattr *sock_opt;
@@ -1455,14 +1501,16 @@ static int netlink_connect(Config *cfg, struct nl_sock *sock, int nl_id, int fd,
     goto free_msg;
   }
 
-  sock_opt = nla_nest_start(msg, NBD_SOCK_ITEM);
-  if (!sock_opt) {
-    cerr << "rbd-nbd: Could not init sock in netlink message." << std::endl;
-    goto free_msg;
-  }
+  for (auto fd : fds) {
+    sock_opt = nla_nest_start(msg, NBD_SOCK_ITEM);
+    if (!sock_opt) {
+      cerr << "rbd-nbd: Could not init sock in netlink message." << std::endl;
+      goto free_msg;
+    }
 
-  NLA_PUT_U32(msg, NBD_SOCK_FD, fd);
-  nla_nest_end(msg, sock_opt);
+    NLA_PUT_U32(msg, NBD_SOCK_FD, fd);
+    nla_nest_end(msg, sock_opt);
+  }
   nla_nest_end(msg, sock_attr);
 
   ret = nl_send_sync(sock, msg);
@@ -1481,8 +1529,8 @@ free_msg:
   return -EIO;
 }
 
-static int try_netlink_setup(Config *cfg, int fd, uint64_t size, uint64_t flags,
-                             bool reconnect)
+static int try_netlink_setup(Config *cfg, const std::vector<int>& fds,
+                             uint64_t size, uint64_t flags, bool reconnect)
 {
   struct nl_sock *sock;
   int nl_id, ret;
@@ -1496,7 +1544,7 @@ static int try_netlink_setup(Config *cfg, int fd, uint64_t size, uint64_t flags,
 
   dout(10) << "netlink interface supported." << dendl;
 
-  ret = netlink_connect(cfg, sock, nl_id, fd, size, flags, reconnect);
+  ret = netlink_connect(cfg, sock, nl_id, fds, size, flags, reconnect);
   netlink_cleanup(sock);
 
   if (ret != 0)
@@ -1552,11 +1600,12 @@ static void handle_signal(int signum)
   terminate_event_sock.notify();
 }
 
-static NBDServer *start_server(int fd, librbd::Image& image, Config *cfg)
+static NBDServer *start_server(const std::vector<int>& fds,
+                                librbd::Image& image, Config *cfg)
 {
   NBDServer *server;
 
-  server = new NBDServer(fd, image, cfg);
+  server = new NBDServer(fds, image, cfg);
   server->start();
 
   init_async_signal_handler();
@@ -1682,7 +1731,9 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   unsigned long blksize = RBD_NBD_BLKSIZE;
   bool use_netlink = true;
 
-  int fd[2];
+  // kernel and server side ends of each connection
+  std::vector<int> kernel_fds;
+  std::vector<int> server_fds;
 
   librbd::image_info_t info;
 
@@ -1723,9 +1774,14 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   common_init_finish(g_ceph_context);
   global_init_chdir(g_ceph_context);
 
-  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fd) == -1) {
-    r = -errno;
-    goto close_ret;
+  for (int i = 0; i < cfg->num_connections; ++i) {
+    int fd[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fd) == -1) {
+      r = -errno;
+      goto close_fd;
+    }
+    kernel_fds.push_back(fd[0]);
+    server_fds.push_back(fd[1]);
   }
 
   r = rados.init_with_context(g_ceph_context);
@@ -1855,7 +1911,7 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   if (r < 0)
     goto close_fd;
 
-  server = start_server(fd[1], image, cfg);
+  server = start_server(server_fds, image, cfg);
 
   // generate when the cookie is not supplied at CLI
   if (!reconnect && cfg->cookie.empty()) {
@@ -1863,7 +1919,7 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
     uuid_gen.generate_random();
     cfg->cookie = uuid_gen.to_string();
   }
-  r = try_netlink_setup(cfg, fd[0], size, flags, reconnect);
+  r = try_netlink_setup(cfg, kernel_fds, size, flags, reconnect);
   if (r < 0) {
     goto free_server;
   } else if (r == 1) {
@@ -1871,7 +1927,13 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   }
 
   if (!use_netlink) {
-    r = try_ioctl_setup(cfg, fd[0], size, blksize, flags);
+    if (cfg->num_connections > 1) {
+      cerr << "rbd-nbd: multiple connections require the netlink interface"
+           << std::endl;
+      r = -EOPNOTSUPP;
+      goto free_server;
+    }
+    r = try_ioctl_setup(cfg, kernel_fds[0], size, blksize, flags);
     if (r < 0)
       goto free_server;
   }
@@ -1940,9 +2002,13 @@ close_nbd:
 free_server:
   delete server;
 close_fd:
-  close(fd[0]);
-  close(fd[1]);
-close_ret:
+  for (auto fd : kernel_fds) {
+    close(fd);
+  }
+  for (auto fd : server_fds) {
+    close(fd);
+  }
+
   image.close();
   io_ctx.close();
   rados.shutdown();
@@ -2195,6 +2261,16 @@ static int parse_args(vector<const char*>& args, std::ostream *err_msg,
       cfg->exclusive = true;
     } else if (ceph_argparse_flag(args, i, "--notrim", (char *)NULL)) {
       cfg->notrim = true;
+    } else if (ceph_argparse_witharg(args, i, &cfg->num_connections, err,
+                                     "--num-connections", (char *)NULL)) {
+      if (!err.str().empty()) {
+        *err_msg << "rbd-nbd: " << err.str();
+        return -EINVAL;
+      }
+      if (cfg->num_connections < 1) {
+        *err_msg << "rbd-nbd: Invalid argument for num-connections!";
+        return -EINVAL;
+      }
     } else if (ceph_argparse_witharg(args, i, &cfg->io_timeout, err,
                                      "--timeout", (char *)NULL)) {
       if (!err.str().empty()) {